@@ -781,64 +781,71 @@ class LocationDict(TypedDict, total=False): \n\
         fprintf(fout, "// This file is auto generated. More info: https://github.com/Daivuk/apdoom\n");
         fprintf(fout, "#pragma once\n\n");
         fprintf(fout, "#include \"apdoom.h\"\n");
-        fprintf(fout, "#include \"apdoom_def_types.h\"\n");
-        fprintf(fout, "#include <map>\n");
-        fprintf(fout, "#include <string>\n");
-        fprintf(fout, "#include <vector>\n\n\n");
+        fprintf(fout, "#include \"apdoom_def_types.h\"\n\n\n");
 
+        // Everything is emitted as plain arrays so nothing gets constructed at startup. Lookup tables
+        // are sorted constexpr arrays that the game binary searches.
         std::map<int /* ep */, std::map<int /* map */, std::map<int /* index */, int64_t /* loc id */>>> location_table;
         for (const auto& loc : ap_locations)
         {
             location_table[loc.idx.ep + 1][loc.idx.map + 1][loc.doom_thing_index] = loc.id;
         }
 
-        // locations
-        fprintf(fout, "const std::map<int /* ep */, std::map<int /* map */, std::map<int /* index */, int64_t /* loc id */>>> ap_%s_location_table = {\n", game->codename.c_str());
-        for (const auto& kv1 : location_table)
+        struct loc_entry_t
         {
-            fprintf(fout, "    {%i, {\n", kv1.first);
+            int64_t loc_id;
+            int ep;
+            int map;
+            int index;
+        };
+        std::vector<loc_entry_t> location_entries;
+        for (const auto& kv1 : location_table)
             for (const auto& kv2 : kv1.second)
-            {
-                fprintf(fout, "        {%i, {\n", kv2.first);
                 for (const auto& kv3 : kv2.second)
-                {
-                    fprintf(fout, "            {%i, %lli},\n", kv3.first, kv3.second);
-                }
-                fprintf(fout, "        }},\n");
-            }
-            fprintf(fout, "    }},\n");
+                    location_entries.push_back({kv3.second, kv1.first, kv2.first, kv3.first});
+
+        // locations
+        fprintf(fout, "// Ep/map/index -> loc id. Sorted by ep, map, then index\n");
+        fprintf(fout, "constexpr ap_location_t ap_%s_location_table[] = {\n", game->codename.c_str());
+        for (const auto& loc : location_entries)
+        {
+            fprintf(fout, "    {%lli, %i, %i, %i},\n", loc.loc_id, loc.ep, loc.map, loc.index);
+        }
+        fprintf(fout, "};\n\n\n");
+
+        // Reverse location lookup
+        std::sort(location_entries.begin(), location_entries.end(), [](const loc_entry_t& a, const loc_entry_t& b) { return a.loc_id < b.loc_id; });
+        fprintf(fout, "// Loc id -> ep/map/index. Sorted by loc id\n");
+        fprintf(fout, "constexpr ap_location_t ap_%s_location_index[] = {\n", game->codename.c_str());
+        for (const auto& loc : location_entries)
+        {
+            fprintf(fout, "    {%lli, %i, %i, %i},\n", loc.loc_id, loc.ep, loc.map, loc.index);
         }
         fprintf(fout, "};\n\n\n");
 
         // items
-        fprintf(fout, "// Map item id\n");
-        fprintf(fout, "const std::map<int64_t, ap_item_t> ap_%s_item_table = {\n", game->codename.c_str());
+        std::map<int64_t, const ap_item_t*> item_table;
         for (const auto& item : ap_items)
+            item_table.insert({item.id, &item});
+
+        fprintf(fout, "// Map item id. Sorted by item id\n");
+        fprintf(fout, "constexpr ap_item_t ap_%s_item_table[] = {\n", game->codename.c_str());
+        for (const auto& kv : item_table)
         {
-            fprintf(fout, "    {%llu, {%i, %i, %i}},\n", item.id, item.doom_type, item.idx.ep + 1, item.idx.map + 1);
+            fprintf(fout, "    {%llu, %i, %i, %i},\n", kv.first, kv.second->doom_type, kv.second->idx.ep + 1, kv.second->idx.map + 1);
         }
         fprintf(fout, "};\n\n\n");
 
-        // Level infos
-        fprintf(fout, "std::vector<std::vector<ap_level_info_t>> ap_%s_level_infos = \n", game->codename.c_str());
-        fprintf(fout, "{\n");
+        // Level infos. Plain aggregates, not const: sanity_check_count is filled in at init.
+        // Each level's things go in their own array, so levels aren't capped or padded to a max thing count.
         for (int ep = 0; ep < game->ep_count; ++ep)
         {
-            fprintf(fout, "    {\n");
             int map = 0;
             for (const auto& meta : game->episodes[ep])
             {
                 auto level = get_level({game->name, ep, map});
-                fprintf(fout, "        {\"%s\", {%s, %s, %s}, {%i, %i, %i}, %i, %i, {\n", 
-                        level->name.c_str(),
-                        level->keys[0] ? "true" : "false", 
-                        level->keys[1] ? "true" : "false", 
-                        level->keys[2] ? "true" : "false", 
-                        level->use_skull[0] ? 1 : 0, 
-                        level->use_skull[1] ? 1 : 0, 
-                        level->use_skull[2] ? 1 : 0, 
-                        level->location_count,
-                        (int)level->map->things.size());
+                fprintf(fout, "static const ap_thing_info_t ap_%s_thing_infos_e%im%i[] = \n", game->codename.c_str(), ep + 1, map + 1);
+                fprintf(fout, "{\n");
                 int idx = 0;
                 for (const auto& thing : level->map->things)
                 {
@@ -854,30 +861,63 @@ class LocationDict(TypedDict, total=False): \n\
                             break;
                         }
                     }
-                    fprintf(fout, "            {%i, %i, %i, %i},\n", thing.type, idx, check_sanity ? 1 : 0, unreachable ? 1 : 0);
+                    fprintf(fout, "    {%i, %i, %i, %i},\n", thing.type, idx, check_sanity ? 1 : 0, unreachable ? 1 : 0);
                     ++idx;
                 }
-                fprintf(fout, "        }},\n");
+                fprintf(fout, "};\n\n\n");
+                ++map;
+            }
+
+            fprintf(fout, "ap_level_info_t ap_%s_level_infos_ep%i[] = \n", game->codename.c_str(), ep + 1);
+            fprintf(fout, "{\n");
+            map = 0;
+            for (const auto& meta : game->episodes[ep])
+            {
+                auto level = get_level({game->name, ep, map});
+                fprintf(fout, "    {\"%s\", {%s, %s, %s}, {%i, %i, %i}, %i, %i, ap_%s_thing_infos_e%im%i},\n", 
+                        level->name.c_str(),
+                        level->keys[0] ? "true" : "false", 
+                        level->keys[1] ? "true" : "false", 
+                        level->keys[2] ? "true" : "false", 
+                        level->use_skull[0] ? 1 : 0, 
+                        level->use_skull[1] ? 1 : 0, 
+                        level->use_skull[2] ? 1 : 0, 
+                        level->location_count,
+                        (int)level->map->things.size(),
+                        game->codename.c_str(), ep + 1, map + 1);
                 ++map;
             }
-            fprintf(fout, "    },\n");
+            fprintf(fout, "};\n\n\n");
+        }
+
+        fprintf(fout, "// Episode -> levels\n");
+        fprintf(fout, "const ap_episode_info_t ap_%s_level_infos[] = \n", game->codename.c_str());
+        fprintf(fout, "{\n");
+        for (int ep = 0; ep < game->ep_count; ++ep)
+        {
+            fprintf(fout, "    {ap_%s_level_infos_ep%i, %i},\n", game->codename.c_str(), ep + 1, (int)game->episodes[ep].size());
         }
         fprintf(fout, "};\n\n\n");
 
-        // Item sprites (Used by notification icons)
-        fprintf(fout, "const std::map<int, std::string> ap_%s_type_sprites = {\n", game->codename.c_str());
+        // Item sprites (Used by notification icons). First one listed wins for a doom type
+        std::map<int, std::string> type_sprites;
         for (const auto& item : game->progressions)
-            fprintf(fout, "    {%i, \"%s\"},\n", item.doom_type, item.sprite.c_str());
+            type_sprites.insert({item.doom_type, item.sprite});
         for (const auto& item : game->fillers)
-            fprintf(fout, "    {%i, \"%s\"},\n", item.doom_type, item.sprite.c_str());
+            type_sprites.insert({item.doom_type, item.sprite});
         for (const auto& item : game->unique_progressions)
-            fprintf(fout, "    {%i, \"%s\"},\n", item.doom_type, item.sprite.c_str());
+            type_sprites.insert({item.doom_type, item.sprite});
         for (const auto& item : game->unique_fillers)
-            fprintf(fout, "    {%i, \"%s\"},\n", item.doom_type, item.sprite.c_str());
+            type_sprites.insert({item.doom_type, item.sprite});
         for (const auto& item : game->capacity_upgrades)
-            fprintf(fout, "    {%i, \"%s\"},\n", item.doom_type, item.sprite.c_str());
+            type_sprites.insert({item.doom_type, item.sprite});
         for (const auto& item : game->keys)
-            fprintf(fout, "    {%i, \"%s\"},\n", item.item.doom_type, item.item.sprite.c_str());
+            type_sprites.insert({item.item.doom_type, item.item.sprite});
+
+        fprintf(fout, "// Doom type -> sprite. Sorted by doom type\n");
+        fprintf(fout, "constexpr ap_type_sprite_t ap_%s_type_sprites[] = {\n", game->codename.c_str());
+        for (const auto& kv : type_sprites)
+            fprintf(fout, "    {%i, \"%s\"},\n", kv.first, kv.second.c_str());
         fprintf(fout, "};\n");
 
         fclose(fout);
@@ -0,0 +1,217 @@
+//
+// Copyright(C) 2026 APDoom contributors
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// DESCRIPTION:
+//     Checks that OPL3_GenerateStream, which generates samples in
+//     blocks, gives the same output as calling OPL3_GenerateResampled
+//     once per sample, and times both.
+//
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "opl3.h"
+
+#define CHUNKS_PER_SECOND 20
+#define DEFAULT_SECONDS 10
+
+static const Bit32u rates[] = { 11025, 22050, 44100, 48000, 49716, 96000 };
+static const unsigned int seeds[] = { 1, 1234, 99991 };
+
+static unsigned int rand_state;
+
+static unsigned int Random(void)
+{
+    rand_state = rand_state * 1103515245 + 12345;
+    return rand_state >> 16;
+}
+
+// Random instrument and note changes, as a busy song would make between
+// two music callbacks. With rhythm set, the percussion mode register is
+// changed from time to time too.
+
+static void WriteRandomRegisters(opl3_chip *chip, int chunk, int rhythm)
+{
+    Bit16u base;
+    int ch, op;
+    int i;
+
+    for (i = 0; i < 12; ++i)
+    {
+        base = (Random() & 1) ? 0x100 : 0;
+        ch = Random() % 9;
+        op = ch % 3 + (ch / 3) * 8;
+
+        OPL3_WriteRegBuffered(chip, base | (0x20 + op), Random() & 0xff);
+        OPL3_WriteRegBuffered(chip, base | (0x23 + op), Random() & 0xff);
+        OPL3_WriteRegBuffered(chip, base | (0x40 + op), Random() & 0x3f);
+        OPL3_WriteRegBuffered(chip, base | (0x43 + op), Random() & 0x1f);
+        OPL3_WriteRegBuffered(chip, base | (0x60 + op), Random() & 0xff);
+        OPL3_WriteRegBuffered(chip, base | (0x63 + op), Random() & 0xff);
+        OPL3_WriteRegBuffered(chip, base | (0x80 + op), Random() & 0xff);
+        OPL3_WriteRegBuffered(chip, base | (0x83 + op), Random() & 0xff);
+        OPL3_WriteRegBuffered(chip, base | (0xe0 + op), Random() & 7);
+        OPL3_WriteRegBuffered(chip, base | (0xe3 + op), Random() & 7);
+        OPL3_WriteRegBuffered(chip, base | (0xc0 + ch), 0x30 | (Random() & 0xf));
+        OPL3_WriteRegBuffered(chip, base | (0xa0 + ch), Random() & 0xff);
+        OPL3_WriteRegBuffered(chip, base | (0xb0 + ch),
+                              (Random() & 0x1f) | ((Random() & 1) << 5));
+    }
+
+    if (rhythm && chunk % 10 == 0)
+    {
+        OPL3_WriteRegBuffered(chip, 0xbd, 0x20 | (Random() & 0xdf));
+    }
+}
+
+// Render the same song twice, once per sample and once in blocks.
+// Returns the number of samples that differ.
+
+static int RenderAndCompare(Bit32u rate, unsigned int seed, int rhythm,
+                            int seconds, double *per_sample_time,
+                            double *block_time)
+{
+    static opl3_chip chip;
+    Bit32u chunk_samples = rate / CHUNKS_PER_SECOND;
+    Bit32u total = chunk_samples * CHUNKS_PER_SECOND * seconds;
+    Bit16s *expected, *actual;
+    clock_t start;
+    int mismatches = 0;
+    int pass, chunk;
+    Bit32u i;
+
+    expected = malloc(total * 2 * sizeof(Bit16s));
+    actual = malloc(total * 2 * sizeof(Bit16s));
+
+    if (expected == NULL || actual == NULL)
+    {
+        fprintf(stderr, "Out of memory\n");
+        exit(-1);
+    }
+
+    for (pass = 0; pass < 2; ++pass)
+    {
+        Bit16s *out = pass == 0 ? expected : actual;
+        double time = 0;
+
+        rand_state = seed;
+        OPL3_Reset(&chip, rate);
+        OPL3_WriteReg(&chip, 0x105, 0x01);
+        OPL3_WriteReg(&chip, 0x104, 0x03);
+
+        for (chunk = 0; chunk < CHUNKS_PER_SECOND * seconds; ++chunk)
+        {
+            WriteRandomRegisters(&chip, chunk, rhythm);
+
+            start = clock();
+
+            if (pass == 0)
+            {
+                for (i = 0; i < chunk_samples; ++i)
+                {
+                    OPL3_GenerateResampled(&chip, out + i * 2);
+                }
+            }
+            else
+            {
+                OPL3_GenerateStream(&chip, out, chunk_samples);
+            }
+
+            time += (double) (clock() - start) / CLOCKS_PER_SEC;
+            out += chunk_samples * 2;
+        }
+
+        if (pass == 0)
+        {
+            *per_sample_time = time;
+        }
+        else
+        {
+            *block_time = time;
+        }
+    }
+
+    for (i = 0; i < total * 2; ++i)
+    {
+        if (expected[i] != actual[i])
+        {
+            ++mismatches;
+        }
+    }
+
+    free(expected);
+    free(actual);
+
+    return mismatches;
+}
+
+int main(int argc, char *argv[])
+{
+    double per_sample_time = 0, block_time = 0;
+    double per_sample_total = 0, block_total = 0;
+    int seconds = DEFAULT_SECONDS;
+    int failures = 0;
+    int mismatches;
+    unsigned int rate, seed;
+    int rhythm;
+
+    if (argc > 1)
+    {
+        seconds = atoi(argv[1]);
+
+        if (seconds <= 0)
+        {
+            printf("Usage: %s [seconds of audio per run]\n", argv[0]);
+            exit(-1);
+        }
+    }
+
+    for (rate = 0; rate < sizeof(rates) / sizeof(*rates); ++rate)
+    {
+        for (seed = 0; seed < sizeof(seeds) / sizeof(*seeds); ++seed)
+        {
+            for (rhythm = 0; rhythm < 2; ++rhythm)
+            {
+                mismatches = RenderAndCompare(rates[rate], seeds[seed],
+                                              rhythm, seconds,
+                                              &per_sample_time,
+                                              &block_time);
+
+                printf("%6u Hz, seed %5u, rhythm %-3s: "
+                       "per sample %.3f s, block %.3f s, %s\n",
+                       rates[rate], seeds[seed], rhythm ? "on" : "off",
+                       per_sample_time, block_time,
+                       mismatches == 0 ? "identical" : "MISMATCH");
+
+                if (mismatches != 0)
+                {
+                    printf("    %i samples differ\n", mismatches);
+                    ++failures;
+                }
+
+                per_sample_total += per_sample_time;
+                block_total += block_time;
+            }
+        }
+    }
+
+    printf("Total: per sample %.3f s, block %.3f s, %i of %i runs differ\n",
+           per_sample_total, block_total, failures,
+           (int) (sizeof(rates) / sizeof(*rates)
+                * sizeof(seeds) / sizeof(*seeds) * 2));
+
+    return failures == 0 ? 0 : 1;
+}
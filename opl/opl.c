@@ -514,3 +514,19 @@ void OPL_AdjustCallbacks(float value)
     }
 }
 
+void OPL_SetCapture(opl_capture_t capture)
+{
+    if (driver != NULL && driver->set_capture_func != NULL)
+    {
+        driver->set_capture_func(capture);
+    }
+}
+
+void OPL_SetBypass(int bypass)
+{
+    if (driver != NULL && driver->set_bypass_func != NULL)
+    {
+        driver->set_bypass_func(bypass);
+    }
+}
+
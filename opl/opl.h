@@ -23,6 +23,9 @@
 
 typedef void (*opl_callback_t)(void *data);
 
+// Receives emulated output, nsamples stereo 16-bit samples at a time.
+typedef void (*opl_capture_t)(const int16_t *samples, unsigned int nsamples);
+
 // Result from OPL_Init(), indicating what type of OPL chip was detected,
 // if any.
 typedef enum
@@ -149,5 +152,20 @@ void OPL_Delay(uint64_t us);
 
 void OPL_SetPaused(int paused);
 
+//
+// Software emulation output.
+//
+
+// Set a function to receive the output as it is generated, or NULL.
+// This is invoked from the same thread as the timer callbacks. Only
+// emulated chips produce output.
+
+void OPL_SetCapture(opl_capture_t capture);
+
+// If non-zero, stop emulating the chip altogether, while nothing plays
+// on it. Callbacks are not invoked while bypassed.
+
+void OPL_SetBypass(int bypass);
+
 #endif
 
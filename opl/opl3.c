@@ -1043,70 +1043,43 @@ static Bit16s OPL3_ClipSample(Bit32s sample)
     return (Bit16s)sample;
 }
 
-void OPL3_Generate(opl3_chip *chip, Bit16s *buf)
+// Chip-wide state that is stepped once per sample. Envelopes and phases
+// read it, so OPL3_GenerateBlock replays it for each sample of a block.
+typedef struct {
+    Bit16u timer;
+    Bit8u eg_add;
+    Bit8u eg_state;
+    Bit8u tremolo;
+    Bit8u vibpos;
+} opl3_clock;
+
+// Envelope and phase outputs of every slot over a block
+typedef struct {
+    Bit16s eg_out[36][OPL3_BLOCK_SIZE];
+    Bit16u phase_out[36][OPL3_BLOCK_SIZE];
+} opl3_block;
+
+static void OPL3_ClockSave(const opl3_chip *chip, opl3_clock *clock)
 {
-    Bit8u ii;
-    Bit8u jj;
-    Bit16s accm;
-    Bit8u shift = 0;
-
-    buf[1] = OPL3_ClipSample(chip->mixbuff[1]);
-
-    for (ii = 0; ii < 15; ii++)
-    {
-        OPL3_SlotCalcFB(&chip->slot[ii]);
-        OPL3_EnvelopeCalc(&chip->slot[ii]);
-        OPL3_PhaseGenerate(&chip->slot[ii]);
-        OPL3_SlotGenerate(&chip->slot[ii]);
-    }
-
-    chip->mixbuff[0] = 0;
-    for (ii = 0; ii < 18; ii++)
-    {
-        accm = 0;
-        for (jj = 0; jj < 4; jj++)
-        {
-            accm += *chip->channel[ii].out[jj];
-        }
-        chip->mixbuff[0] += (Bit16s)(accm & chip->channel[ii].cha);
-    }
-
-    for (ii = 15; ii < 18; ii++)
-    {
-        OPL3_SlotCalcFB(&chip->slot[ii]);
-        OPL3_EnvelopeCalc(&chip->slot[ii]);
-        OPL3_PhaseGenerate(&chip->slot[ii]);
-        OPL3_SlotGenerate(&chip->slot[ii]);
-    }
-
-    buf[0] = OPL3_ClipSample(chip->mixbuff[0]);
-
-    for (ii = 18; ii < 33; ii++)
-    {
-        OPL3_SlotCalcFB(&chip->slot[ii]);
-        OPL3_EnvelopeCalc(&chip->slot[ii]);
-        OPL3_PhaseGenerate(&chip->slot[ii]);
-        OPL3_SlotGenerate(&chip->slot[ii]);
-    }
+    clock->timer = chip->timer;
+    clock->eg_add = chip->eg_add;
+    clock->eg_state = chip->eg_state;
+    clock->tremolo = chip->tremolo;
+    clock->vibpos = chip->vibpos;
+}
 
-    chip->mixbuff[1] = 0;
-    for (ii = 0; ii < 18; ii++)
-    {
-        accm = 0;
-        for (jj = 0; jj < 4; jj++)
-        {
-            accm += *chip->channel[ii].out[jj];
-        }
-        chip->mixbuff[1] += (Bit16s)(accm & chip->channel[ii].chb);
-    }
+static void OPL3_ClockRestore(opl3_chip *chip, const opl3_clock *clock)
+{
+    chip->timer = clock->timer;
+    chip->eg_add = clock->eg_add;
+    chip->eg_state = clock->eg_state;
+    chip->tremolo = clock->tremolo;
+    chip->vibpos = clock->vibpos;
+}
 
-    for (ii = 33; ii < 36; ii++)
-    {
-        OPL3_SlotCalcFB(&chip->slot[ii]);
-        OPL3_EnvelopeCalc(&chip->slot[ii]);
-        OPL3_PhaseGenerate(&chip->slot[ii]);
-        OPL3_SlotGenerate(&chip->slot[ii]);
-    }
+static void OPL3_ClockAdvance(opl3_chip *chip)
+{
+    Bit8u shift = 0;
 
     if ((chip->timer & 0x3f) == 0x3f)
     {
@@ -1160,7 +1133,10 @@ void OPL3_Generate(opl3_chip *chip, Bit16s *buf)
     }
 
     chip->eg_state ^= 1;
+}
 
+static void OPL3_ProcessWriteBuf(opl3_chip *chip)
+{
     while (chip->writebuf[chip->writebuf_cur].time <= chip->writebuf_samplecnt)
     {
         if (!(chip->writebuf[chip->writebuf_cur].reg & 0x200))
@@ -1175,6 +1151,263 @@ void OPL3_Generate(opl3_chip *chip, Bit16s *buf)
     chip->writebuf_samplecnt++;
 }
 
+static Bit32s OPL3_MixChannels(opl3_chip *chip, Bit8u right)
+{
+    Bit32s mix = 0;
+    Bit16s accm;
+    Bit8u ii;
+    Bit8u jj;
+
+    for (ii = 0; ii < 18; ii++)
+    {
+        accm = 0;
+        for (jj = 0; jj < 4; jj++)
+        {
+            accm += *chip->channel[ii].out[jj];
+        }
+        mix += (Bit16s)(accm & (right ? chip->channel[ii].chb
+                                      : chip->channel[ii].cha));
+    }
+
+    return mix;
+}
+
+static void OPL3_SlotProcess(opl3_slot *slot)
+{
+    OPL3_SlotCalcFB(slot);
+    OPL3_EnvelopeCalc(slot);
+    OPL3_PhaseGenerate(slot);
+    OPL3_SlotGenerate(slot);
+}
+
+void OPL3_Generate(opl3_chip *chip, Bit16s *buf)
+{
+    Bit8u ii;
+
+    buf[1] = OPL3_ClipSample(chip->mixbuff[1]);
+
+    for (ii = 0; ii < 15; ii++)
+    {
+        OPL3_SlotProcess(&chip->slot[ii]);
+    }
+
+    chip->mixbuff[0] = OPL3_MixChannels(chip, 0);
+
+    for (ii = 15; ii < 18; ii++)
+    {
+        OPL3_SlotProcess(&chip->slot[ii]);
+    }
+
+    buf[0] = OPL3_ClipSample(chip->mixbuff[0]);
+
+    for (ii = 18; ii < 33; ii++)
+    {
+        OPL3_SlotProcess(&chip->slot[ii]);
+    }
+
+    chip->mixbuff[1] = OPL3_MixChannels(chip, 1);
+
+    for (ii = 33; ii < 36; ii++)
+    {
+        OPL3_SlotProcess(&chip->slot[ii]);
+    }
+
+    OPL3_ClockAdvance(chip);
+    OPL3_ProcessWriteBuf(chip);
+}
+
+// A keyed off slot whose envelope has run out stays silent until the
+// next write, and only needs its attenuation and phase stepped.
+static void OPL3_BlockCalcSilent(opl3_slot *slot, Bit16s *eg_out,
+                                 Bit16u *phase_out, const opl3_clock *clocks,
+                                 Bit32u count)
+{
+    opl3_chip *chip;
+    Bit16s base;
+    Bit32u i;
+
+    chip = slot->chip;
+    base = 0x1ff + (slot->reg_tl << 2)
+         + (slot->eg_ksl >> kslshift[slot->reg_ksl]);
+    slot->pg_reset = 0;
+
+    if (slot->trem == &chip->tremolo)
+    {
+        for (i = 0; i < count; i++)
+        {
+            eg_out[i] = base + clocks[i].tremolo;
+        }
+    }
+    else
+    {
+        for (i = 0; i < count; i++)
+        {
+            eg_out[i] = base;
+        }
+    }
+    slot->eg_out = eg_out[count - 1];
+
+    if (slot->reg_vib)
+    {
+        for (i = 0; i < count; i++)
+        {
+            chip->vibpos = clocks[i].vibpos;
+            OPL3_PhaseGenerate(slot);
+            phase_out[i] = slot->pg_phase_out;
+        }
+    }
+    else
+    {
+        Bit32u basefreq = (slot->channel->f_num << slot->channel->block) >> 1;
+        Bit32u inc = (basefreq * mt[slot->reg_mult]) >> 1;
+
+        for (i = 0; i < count; i++)
+        {
+            phase_out[i] = (Bit16u)(slot->pg_phase >> 9);
+            slot->pg_phase += inc;
+        }
+        slot->pg_phase_out = phase_out[count - 1];
+    }
+}
+
+// Envelopes and phases only depend on their own slot and the clock, so
+// each slot runs through the whole block in one go. The rhythm slots
+// 13-17 share the noise and the hi-hat and top cymbal phase bits, so
+// they step together, with the noise each would see in OPL3_Generate.
+static void OPL3_BlockCalcSlots(opl3_chip *chip, opl3_block *block,
+                                const opl3_clock *clocks,
+                                const Bit32u *rhythm_noise, Bit32u count)
+{
+    opl3_slot *slot;
+    Bit32u i;
+    Bit8u ii;
+    Bit8u jj;
+
+    for (ii = 0; ii < 36; ii++)
+    {
+        if (ii == 13)
+        {
+            for (i = 0; i < count; i++)
+            {
+                OPL3_ClockRestore(chip, &clocks[i]);
+                chip->noise = rhythm_noise[i];
+                for (jj = 13; jj < 18; jj++)
+                {
+                    slot = &chip->slot[jj];
+                    OPL3_EnvelopeCalc(slot);
+                    OPL3_PhaseGenerate(slot);
+                    block->eg_out[jj][i] = slot->eg_out;
+                    block->phase_out[jj][i] = slot->pg_phase_out;
+                }
+            }
+            ii = 17;
+            continue;
+        }
+
+        slot = &chip->slot[ii];
+        if (!slot->key && slot->eg_gen == envelope_gen_num_release
+         && slot->eg_rout == 0x1ff)
+        {
+            OPL3_BlockCalcSilent(slot, block->eg_out[ii], block->phase_out[ii],
+                                 clocks, count);
+            continue;
+        }
+        for (i = 0; i < count; i++)
+        {
+            OPL3_ClockRestore(chip, &clocks[i]);
+            OPL3_EnvelopeCalc(slot);
+            OPL3_PhaseGenerate(slot);
+            block->eg_out[ii][i] = slot->eg_out;
+            block->phase_out[ii][i] = slot->pg_phase_out;
+        }
+    }
+}
+
+static void OPL3_BlockSlotGenerate(opl3_chip *chip, const opl3_block *block,
+                                   Bit32u i, Bit8u first, Bit8u last)
+{
+    opl3_slot *slot;
+    Bit8u ii;
+
+    for (ii = first; ii < last; ii++)
+    {
+        slot = &chip->slot[ii];
+        OPL3_SlotCalcFB(slot);
+        slot->eg_out = block->eg_out[ii][i];
+        slot->pg_phase_out = block->phase_out[ii][i];
+        OPL3_SlotGenerate(slot);
+    }
+}
+
+// Generate count samples, with no buffered write due before the last one
+static void OPL3_GenerateBlockPart(opl3_chip *chip, Bit16s *buf, Bit32u count)
+{
+    opl3_clock clocks[OPL3_BLOCK_SIZE];
+    opl3_clock end;
+    Bit32u rhythm_noise[OPL3_BLOCK_SIZE];
+    opl3_block block;
+    Bit32u noise;
+    Bit32u i;
+    Bit8u ii;
+
+    noise = chip->noise;
+    for (i = 0; i < count; i++)
+    {
+        OPL3_ClockSave(chip, &clocks[i]);
+        OPL3_ClockAdvance(chip);
+        for (ii = 0; ii < 36; ii++)
+        {
+            if (ii == 13)
+            {
+                rhythm_noise[i] = noise;
+            }
+            noise = (noise >> 1) | ((((noise >> 14) ^ noise) & 0x01) << 22);
+        }
+    }
+    OPL3_ClockSave(chip, &end);
+
+    OPL3_BlockCalcSlots(chip, &block, clocks, rhythm_noise, count);
+    OPL3_ClockRestore(chip, &end);
+    chip->noise = noise;
+
+    for (i = 0; i < count; i++)
+    {
+        buf[1] = OPL3_ClipSample(chip->mixbuff[1]);
+        OPL3_BlockSlotGenerate(chip, &block, i, 0, 15);
+        chip->mixbuff[0] = OPL3_MixChannels(chip, 0);
+        OPL3_BlockSlotGenerate(chip, &block, i, 15, 18);
+        buf[0] = OPL3_ClipSample(chip->mixbuff[0]);
+        OPL3_BlockSlotGenerate(chip, &block, i, 18, 33);
+        chip->mixbuff[1] = OPL3_MixChannels(chip, 1);
+        OPL3_BlockSlotGenerate(chip, &block, i, 33, 36);
+        OPL3_ProcessWriteBuf(chip);
+        buf += 2;
+    }
+}
+
+void OPL3_GenerateBlock(opl3_chip *chip, Bit16s *buf, Bit32u numsamples)
+{
+    opl3_writebuf *next;
+    Bit32u count;
+
+    while (numsamples > 0)
+    {
+        count = numsamples < OPL3_BLOCK_SIZE ? numsamples : OPL3_BLOCK_SIZE;
+
+        // A buffered write changes the registers after its sample
+        next = &chip->writebuf[chip->writebuf_cur];
+        if ((next->reg & 0x200) && next->time < chip->writebuf_samplecnt + count)
+        {
+            count = next->time > chip->writebuf_samplecnt
+                  ? (Bit32u)(next->time - chip->writebuf_samplecnt) + 1 : 1;
+        }
+
+        OPL3_GenerateBlockPart(chip, buf, count);
+        buf += count * 2;
+        numsamples -= count;
+    }
+}
+
 void OPL3_GenerateResampled(opl3_chip *chip, Bit16s *buf)
 {
     while (chip->samplecnt >= chip->rateratio)
@@ -1367,11 +1600,61 @@ void OPL3_WriteRegBuffered(opl3_chip *chip, Bit16u reg, Bit8u v)
 
 void OPL3_GenerateStream(opl3_chip *chip, Bit16s *sndptr, Bit32u numsamples)
 {
-    Bit32u i;
+    Bit16s native[OPL3_BLOCK_SIZE * 2];
+    Bit32u count, needed, outputs, i, j;
+    Bit32s samplecnt;
+
+    while (numsamples > 0)
+    {
+        // Count the chip samples that OPL3_GenerateResampled would
+        // generate for as many outputs as fit in a block. Generating
+        // ahead of that would move the buffered writes.
+        samplecnt = chip->samplecnt;
+        needed = 0;
+        for (outputs = 0; outputs < numsamples; outputs++)
+        {
+            for (count = 0; samplecnt >= chip->rateratio; count++)
+            {
+                samplecnt -= chip->rateratio;
+            }
+            if (needed + count > OPL3_BLOCK_SIZE)
+            {
+                break;
+            }
+            needed += count;
+            samplecnt += 1 << RSM_FRAC;
+        }
 
-    for(i = 0; i < numsamples; i++)
-    {
-        OPL3_GenerateResampled(chip, sndptr);
-        sndptr += 2;
+        if (outputs == 0)
+        {
+            // Below 777 Hz, not worth batching
+            OPL3_GenerateResampled(chip, sndptr);
+            sndptr += 2;
+            numsamples--;
+            continue;
+        }
+
+        OPL3_GenerateBlock(chip, native, needed);
+
+        for (i = 0, j = 0; i < outputs; i++)
+        {
+            while (chip->samplecnt >= chip->rateratio)
+            {
+                chip->oldsamples[0] = chip->samples[0];
+                chip->oldsamples[1] = chip->samples[1];
+                chip->samples[0] = native[j * 2];
+                chip->samples[1] = native[j * 2 + 1];
+                j++;
+                chip->samplecnt -= chip->rateratio;
+            }
+            sndptr[0] = (Bit16s)((chip->oldsamples[0] * (chip->rateratio - chip->samplecnt)
+                                + chip->samples[0] * chip->samplecnt) / chip->rateratio);
+            sndptr[1] = (Bit16s)((chip->oldsamples[1] * (chip->rateratio - chip->samplecnt)
+                                + chip->samples[1] * chip->samplecnt) / chip->rateratio);
+            chip->samplecnt += 1 << RSM_FRAC;
+            sndptr += 2;
+        }
+
+        numsamples -= outputs;
     }
 }
@@ -33,6 +33,7 @@
 
 #define OPL_WRITEBUF_SIZE   1024
 #define OPL_WRITEBUF_DELAY  2
+#define OPL3_BLOCK_SIZE     64
 
 typedef uintptr_t       Bitu;
 typedef intptr_t        Bits;
@@ -147,4 +148,5 @@ void OPL3_Reset(opl3_chip *chip, Bit32u samplerate);
 void OPL3_WriteReg(opl3_chip *chip, Bit16u reg, Bit8u v);
 void OPL3_WriteRegBuffered(opl3_chip *chip, Bit16u reg, Bit8u v);
 void OPL3_GenerateStream(opl3_chip *chip, Bit16s *sndptr, Bit32u numsamples);
+void OPL3_GenerateBlock(opl3_chip *chip, Bit16s *buf, Bit32u numsamples);
 #endif
@@ -33,6 +33,8 @@ typedef void (*opl_lock_func)(void);
 typedef void (*opl_unlock_func)(void);
 typedef void (*opl_set_paused_func)(int paused);
 typedef void (*opl_adjust_callbacks_func)(float value);
+typedef void (*opl_set_capture_func)(opl_capture_t capture);
+typedef void (*opl_set_bypass_func)(int bypass);
 
 typedef struct
 {
@@ -48,6 +50,10 @@ typedef struct
     opl_unlock_func unlock_func;
     opl_set_paused_func set_paused_func;
     opl_adjust_callbacks_func adjust_callbacks_func;
+
+    // Only set by emulating drivers.
+    opl_set_capture_func set_capture_func;
+    opl_set_bypass_func set_bypass_func;
 } opl_driver_t;
 
 // Sample rate to use when doing software emulation.
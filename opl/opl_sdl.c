@@ -73,6 +73,14 @@ static int opl_sdl_paused;
 
 static uint64_t pause_offset;
 
+// If non-zero, the chip is not emulated at all.
+
+static int opl_sdl_bypass;
+
+// Function receiving the emulator output, if any.
+
+static opl_capture_t capture_callback = NULL;
+
 // OPL software emulator structure.
 
 static opl3_chip opl_chip;
@@ -170,6 +178,12 @@ static void FillBuffer(uint8_t *buffer, unsigned int nsamples)
     // OPL output is generated into temporary buffer and then mixed
     // (to avoid overflows etc.)
     OPL3_GenerateStream(&opl_chip, (Bit16s *) mix_buffer, nsamples);
+
+    if (capture_callback != NULL)
+    {
+        capture_callback((const int16_t *) mix_buffer, nsamples);
+    }
+
     SDL_MixAudioFormat(buffer, mix_buffer, AUDIO_S16SYS, nsamples * 4,
                        SDL_MIX_MAXVOLUME);
 }
@@ -181,6 +195,11 @@ static void OPL_Mix_Callback(int chan, void *stream, int len, void *udata)
     unsigned int filled, buffer_samples;
     Uint8 *buffer = (Uint8*)stream;
 
+    if (opl_sdl_bypass)
+    {
+        return;
+    }
+
     // Repeatedly call the OPL emulator update function until the buffer is
     // full.
     filled = 0;
@@ -319,6 +338,7 @@ static int OPL_SDL_Init(unsigned int port_base)
     }
 
     opl_sdl_paused = 0;
+    opl_sdl_bypass = 0;
     pause_offset = 0;
 
     // Queue structure of callbacks to invoke.
@@ -500,6 +520,16 @@ static void OPL_SDL_AdjustCallbacks(float factor)
     SDL_UnlockMutex(callback_queue_mutex);
 }
 
+static void OPL_SDL_SetCapture(opl_capture_t capture)
+{
+    capture_callback = capture;
+}
+
+static void OPL_SDL_SetBypass(int bypass)
+{
+    opl_sdl_bypass = bypass;
+}
+
 opl_driver_t opl_sdl_driver =
 {
     "SDL",
@@ -513,6 +543,8 @@ opl_driver_t opl_sdl_driver =
     OPL_SDL_Unlock,
     OPL_SDL_SetPaused,
     OPL_SDL_AdjustCallbacks,
+    OPL_SDL_SetCapture,
+    OPL_SDL_SetBypass,
 };
 
 
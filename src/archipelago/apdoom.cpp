@@ -26,6 +26,7 @@
 #else
 #include <sys/types.h>
 #include <sys/stat.h>
+#include <unistd.h>
 
 #define strnicmp strncasecmp
 #endif
@@ -34,6 +35,7 @@
 #include "apdoom_def.h"
 #include "apdoom2_def.h"
 #include "apheretic_def.h"
+#include "apdoom_random.h"
 #include "Archipelago.h"
 #include <json/json.h>
 #include <memory.h>
@@ -43,6 +45,11 @@
 #include <fstream>
 #include <sstream>
 #include <set>
+#include <map>
+#include <string>
+#include <algorithm>
+#include <mutex>
+#include <atomic>
 
 
 #if defined(_WIN32)
@@ -167,11 +174,114 @@ static int AP_FileExists(const char *filename)
 }
 
 
-enum class ap_game_t
+static int AP_RenameFile(const char *from, const char *to)
 {
-	doom,
-	doom2,
-	heretic
+#ifdef _WIN32
+    wchar_t *wfrom = NULL;
+    wchar_t *wto = NULL;
+    BOOL result;
+
+    wfrom = AP_ConvertUtf8ToWide(from);
+
+    if (!wfrom)
+    {
+        return -1;
+    }
+
+    wto = AP_ConvertUtf8ToWide(to);
+
+    if (!wto)
+    {
+        free(wfrom);
+        return -1;
+    }
+
+    // Unlike rename(), this replaces the destination if it exists
+    result = MoveFileExW(wfrom, wto, MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH);
+
+    free(wfrom);
+    free(wto);
+
+    return result ? 0 : -1;
+#else
+    return rename(from, to);
+#endif
+}
+
+
+//
+// Flush a file all the way to the disk
+//
+
+static void AP_SyncFile(FILE *file)
+{
+    fflush(file);
+#ifdef _WIN32
+    _commit(_fileno(file));
+#else
+    fsync(fileno(file));
+#endif
+}
+
+
+//
+// Write a whole file through a temporary file that is renamed over it. That
+// way a crash mid-write leaves the previous version intact.
+//
+
+bool AP_WriteFileAtomic(const std::string& filename, const std::string& data)
+{
+    std::string tmp_filename = filename + ".tmp";
+    bool saved = false;
+    FILE* f = AP_fopen(tmp_filename.c_str(), "wb");
+    if (f)
+    {
+        saved = fwrite(data.data(), 1, data.size(), f) == data.size();
+        AP_SyncFile(f);
+        saved = (fclose(f) == 0) && saved;
+        saved = saved && AP_RenameFile(tmp_filename.c_str(), filename.c_str()) == 0;
+    }
+    return saved;
+}
+
+
+// Growable FIFO
+template <typename T>
+class ap_ring_t
+{
+public:
+	bool empty() const { return m_count == 0; }
+	size_t size() const { return m_count; }
+	const T& front() const { return m_data[m_head]; }
+	const T& operator[](size_t i) const { return m_data[(m_head + i) & (m_data.size() - 1)]; }
+
+	void push_back(const T& value)
+	{
+		if (m_count == m_data.size())
+			grow();
+		m_data[(m_head + m_count) & (m_data.size() - 1)] = value;
+		++m_count;
+	}
+
+	void pop_front()
+	{
+		m_head = (m_head + 1) & (m_data.size() - 1);
+		--m_count;
+	}
+
+private:
+	void grow()
+	{
+		std::vector<T> data(m_data.empty() ? 64 : m_data.size() * 2); // Stays a power of two
+		for (size_t i = 0; i < m_count; ++i)
+			data[i] = (*this)[i];
+		m_data.swap(data);
+		m_head = 0;
+	}
+
+	std::vector<T> m_data;
+	size_t m_head = 0;
+	size_t m_count = 0;
 };
 
 
@@ -187,13 +297,56 @@ static int ap_inventory_count = -1;
 static int max_map_count = -1;
 static ap_settings_t ap_settings;
 static AP_RoomInfo ap_room_info;
-static std::vector<int64_t> ap_item_queue; // We queue when we're in the menu.
+static ap_ring_t<int64_t> ap_item_queue; // Received items, given to the player a few per tic when in game
+static std::mutex ap_item_queue_mutex; // Items are received on the network thread
+static std::vector<int64_t> ap_item_given; // Given since the last level exit, not in the saved player state yet
 static bool ap_was_connected = false; // Got connected at least once. That means the state is valid
 static std::set<int64_t> ap_progressive_locations;
 static bool ap_initialized = false;
-static std::vector<std::string> ap_cached_messages;
 static std::string ap_save_dir_name;
-static std::vector<ap_notification_icon_t> ap_notification_icons;
+static ap_notification_icon_t ap_notification_icons[AP_NOTIF_MAX]; // Pool, icons don't move once added
+static int ap_notification_icon_first = 0; // Oldest icon in the pool
+static int ap_notification_icon_count = 0; // Used slots, removed icons are only reclaimed from the front
+static int ap_notification_icon_live = 0; // Icons not removed yet
+
+//
+// State journal
+//
+// apstate.json is a full snapshot that is only rewritten on level exit.
+// Changes in between are appended to apstate.journal as they happen and
+// replayed over the snapshot on load. Each snapshot starts a new journal
+// generation, so a journal that was already folded into the snapshot is
+// ignored.
+//
+
+#define AP_JOURNAL_MAGIC 0x4A445041 // "APDJ"
+#define AP_JOURNAL_COMPACT_RECORDS 1024
+
+enum
+{
+	AP_JOURNAL_ITEM = 1, // item id, queued
+	// 2 was a dequeued item, no longer written
+	AP_JOURNAL_LOCATION = 3, // ep, map, index
+	AP_JOURNAL_LEVEL = 4, // ep, map, completed, keys0, keys1, keys2, has_map, unlocked, special
+};
+
+static FILE* ap_journal = nullptr; // Changes since apstate.json was last written
+static std::mutex ap_journal_mutex; // AP callbacks can come from the network thread
+static int ap_journal_generation = 0;
+static int ap_journal_record_count = 0;
+static bool ap_journal_carrying = false; // A snapshot is being written, see journal_begin_carry
+static std::vector<uint8_t> ap_journal_carry; // Records for the journal that follows that snapshot
+static int ap_journal_carry_count = 0;
+
+#define AP_MESSAGE_QUEUE_SIZE 1024 // Must be a power of two
+#define AP_MESSAGES_PER_TIC 8
+#define AP_DEFAULT_ITEMS_PER_TIC 4
+
+static std::string ap_message_queue[AP_MESSAGE_QUEUE_SIZE]; // Formatted messages, network thread -> game thread
+static std::atomic<unsigned int> ap_message_queue_head(0); // Next message to show, written by the game thread
+static std::atomic<unsigned int> ap_message_queue_tail(0); // Next free slot, written by the network thread
+static std::thread* ap_network_thread = nullptr; // Joined and deleted in apdoom_shutdown
+static std::atomic<bool> ap_network_thread_running(false);
 
 #define SLOT_DATA_CALLBACK(func_name, output, condition) void func_name (int result) { if (condition) output = result; }
 
@@ -232,8 +385,17 @@ void f_itemrecv(int64_t item_id, int player_id, bool notify_player);
 void f_locrecv(int64_t loc_id);
 void f_locinfo(std::vector<AP_NetworkItem> loc_infos);
 void load_state();
-void save_state();
+void save_state(bool level_exit = false);
+static void journal_load(int generation);
+static void journal_reset(int generation);
+static void journal_begin_carry();
+static void journal_end_carry();
+static void journal_write(int type, std::initializer_list<int64_t> values);
+static void journal_level(ap_level_index_t idx);
+static void apply_item_unlocks(const ap_item_t& item);
 void APSend(std::string msg);
+static void start_network_thread();
+static void stop_network_thread();
 
 
 static int get_original_music_for_level(int ep, int map)
@@ -274,14 +436,30 @@ static int get_original_music_for_level(int ep, int map)
 }
 
 
-static std::vector<std::vector<ap_level_info_t>>& get_level_info_table()
+// Generated tables are plain arrays, lookup ones are sorted. These are views over them.
+template <typename T>
+struct ap_table_t
+{
+	const T* begin;
+	const T* end;
+};
+
+
+template <typename T, size_t N>
+static ap_table_t<T> make_table(const T (&arr)[N])
+{
+	return {arr, arr + N};
+}
+
+
+static ap_table_t<ap_episode_info_t> get_level_info_table()
 {
 	switch (ap_game)
 	{
 		default: // Indeterminate state? Default to Doom 1
-		case ap_game_t::doom: return ap_doom_level_infos;
-		case ap_game_t::doom2: return ap_doom2_level_infos;
-		case ap_game_t::heretic: return ap_heretic_level_infos;
+		case ap_game_t::doom: return make_table(ap_doom_level_infos);
+		case ap_game_t::doom2: return make_table(ap_doom2_level_infos);
+		case ap_game_t::heretic: return make_table(ap_heretic_level_infos);
 	}
 }
 
@@ -289,9 +467,9 @@ static std::vector<std::vector<ap_level_info_t>>& get_level_info_table()
 int ap_get_map_count(int ep)
 {
 	--ep;
-	auto& level_info_table = get_level_info_table();
-	if (ep < 0 || ep >= (int)level_info_table.size()) return -1;
-	return (int)level_info_table[ep].size();
+	auto level_info_table = get_level_info_table();
+	if (ep < 0 || ep >= (int)(level_info_table.end - level_info_table.begin)) return -1;
+	return level_info_table.begin[ep].level_count;
 }
 
 
@@ -303,10 +481,11 @@ int ap_total_check_count(ap_level_info_t *level_info)
 
 ap_level_info_t* ap_get_level_info(ap_level_index_t idx)
 {
-	auto& level_info_table = get_level_info_table();
-	if (idx.ep < 0 || idx.ep >= (int)level_info_table.size()) return nullptr;
-	if (idx.map < 0 || idx.map >= (int)level_info_table[idx.ep].size()) return nullptr;
-	return &level_info_table[idx.ep][idx.map];
+	auto level_info_table = get_level_info_table();
+	if (idx.ep < 0 || idx.ep >= (int)(level_info_table.end - level_info_table.begin)) return nullptr;
+	const auto& episode_info = level_info_table.begin[idx.ep];
+	if (idx.map < 0 || idx.map >= episode_info.level_count) return nullptr;
+	return &episode_info.levels[idx.map];
 }
 
 
@@ -316,30 +495,72 @@ ap_level_state_t* ap_get_level_state(ap_level_index_t idx)
 }
 
 
-static const std::map<int64_t, ap_item_t>& get_item_type_table()
+static ap_table_t<ap_item_t> get_item_type_table()
 {
 	switch (ap_game)
 	{
 		default: // Indeterminate state? Default to Doom 1
-		case ap_game_t::doom: return ap_doom_item_table;
-		case ap_game_t::doom2: return ap_doom2_item_table;
-		case ap_game_t::heretic: return ap_heretic_item_table;
+		case ap_game_t::doom: return make_table(ap_doom_item_table);
+		case ap_game_t::doom2: return make_table(ap_doom2_item_table);
+		case ap_game_t::heretic: return make_table(ap_heretic_item_table);
 	}
 }
 
 
-static const std::map<int /* ep */, std::map<int /* map */, std::map<int /* index */, int64_t /* loc id */>>>& get_location_table()
+static ap_table_t<ap_location_t> get_location_table()
 {
 	switch (ap_game)
 	{
 		default: // Indeterminate state? Default to Doom 1
-		case ap_game_t::doom: return ap_doom_location_table;
-		case ap_game_t::doom2: return ap_doom2_location_table;
-		case ap_game_t::heretic: return ap_heretic_location_table;
+		case ap_game_t::doom: return make_table(ap_doom_location_table);
+		case ap_game_t::doom2: return make_table(ap_doom2_location_table);
+		case ap_game_t::heretic: return make_table(ap_heretic_location_table);
 	}
 }
 
 
+static ap_table_t<ap_location_t> get_location_index()
+{
+	switch (ap_game)
+	{
+		default: // Indeterminate state? Default to Doom 1
+		case ap_game_t::doom: return make_table(ap_doom_location_index);
+		case ap_game_t::doom2: return make_table(ap_doom2_location_index);
+		case ap_game_t::heretic: return make_table(ap_heretic_location_index);
+	}
+}
+
+
+static const ap_item_t* find_item(int64_t item_id)
+{
+	auto item_table = get_item_type_table();
+	auto it = std::lower_bound(item_table.begin, item_table.end, item_id,
+		[](const ap_item_t& item, int64_t id) { return item.item_id < id; });
+	if (it == item_table.end || it->item_id != item_id)
+		return nullptr;
+	return it;
+}
+
+
+static bool get_location_id(ap_level_index_t idx, int index, int64_t& loc_id)
+{
+	ap_location_t key = {0, idx.ep + 1, idx.map + 1, index};
+	auto loc_table = get_location_table();
+	auto it = std::lower_bound(loc_table.begin, loc_table.end, key,
+		[](const ap_location_t& a, const ap_location_t& b)
+		{
+			if (a.ep != b.ep) return a.ep < b.ep;
+			if (a.map != b.map) return a.map < b.map;
+			return a.index < b.index;
+		});
+	if (it == loc_table.end || it->ep != key.ep || it->map != key.map || it->index != key.index)
+		return false;
+
+	loc_id = it->loc_id;
+	return true;
+}
+
+
 std::string string_to_hex(const char* str)
 {
     static const char hex_digits[] = "0123456789ABCDEF";
@@ -410,7 +631,6 @@ int apdoom_init(ap_settings_t* settings)
 {
 	printf("%s\n", APDOOM_VERSION_FULL_TEXT);
 
-	ap_notification_icons.reserve(4096); // 1MB. A bit exessive, but I got a crash with invalid strings and I cannot figure out why. Let's not take any chances...
 	memset(&ap_state, 0, sizeof(ap_state));
 
 	if (strcmp(settings->game, "DOOM 1993") == 0)
@@ -443,12 +663,12 @@ int apdoom_init(ap_settings_t* settings)
 		return 0;
 	}
 
-	const auto& level_info_table = get_level_info_table();
-	ap_episode_count = (int)level_info_table.size();
+	auto level_info_table = get_level_info_table();
+	ap_episode_count = (int)(level_info_table.end - level_info_table.begin);
 	max_map_count = 0; // That's really the map count
-	for (const auto& episode_level_info : level_info_table)
+	for (auto episode_info = level_info_table.begin; episode_info != level_info_table.end; ++episode_info)
 	{
-		max_map_count = std::max(max_map_count, (int)episode_level_info.size());
+		max_map_count = std::max(max_map_count, episode_info->level_count);
 	}
 
 	printf("APDOOM: Initializing Game: \"%s\", Server: %s, Slot: %s\n", settings->game, settings->ip, settings->player_name);
@@ -495,11 +715,16 @@ int apdoom_init(ap_settings_t* settings)
 		int map_count = ap_get_map_count(ep + 1);
 		for (int map = 0; map < map_count; ++map)
 		{
-			for (int k = 0; k < AP_CHECK_MAX; ++k)
+			auto level_state = &ap_state.level_states[ep * max_map_count + map];
+			auto level_info = ap_get_level_info(ap_level_index_t{ep, map});
+			level_state->checks = new int[level_info->thing_count]; // A level can't have more checks than things
+			for (int k = 0; k < level_info->thing_count; ++k)
 			{
-				ap_state.level_states[ep * max_map_count + map].checks[k] = -1;
+				level_state->checks[k] = -1;
 			}
-			auto level_info = ap_get_level_info(ap_level_index_t{ep, map});
+			int checked_words = (level_info->thing_count + 31) / 32;
+			level_state->checked_bits = new unsigned int[checked_words];
+			memset(level_state->checked_bits, 0, sizeof(unsigned int) * checked_words);
 			level_info->sanity_check_count = 0;
 			for (int k = 0; k < level_info->thing_count; ++k)
 			{
@@ -559,6 +784,7 @@ int apdoom_init(ap_settings_t* settings)
 	AP_RegisterSlotDataIntCallback("ammo6add", f_ammo6add);
 	AP_RegisterSlotDataIntCallback("two_ways_keydoors", f_two_ways_keydoors);
     AP_Start();
+	start_network_thread();
 
 	// Block DOOM until connection succeeded or failed
 	auto start_time = std::chrono::steady_clock::now();
@@ -604,6 +830,7 @@ int apdoom_init(ap_settings_t* settings)
 				recalc_max_ammo();
 
 				load_state();
+				ap_random_init(ap_game, ap_save_dir_name, hash_seed(ap_save_dir_name.c_str()));
 				should_break = true;
 				break;
 			}
@@ -719,28 +946,15 @@ int apdoom_init(ap_settings_t* settings)
 	{
 		std::vector<int64_t> location_scouts;
 
-		const auto& loc_table = get_location_table();
-		for (const auto& kv1 : loc_table)
+		auto loc_table = get_location_table();
+		for (auto loc = loc_table.begin; loc != loc_table.end; ++loc)
 		{
-			if (!ap_state.episodes[kv1.first - 1])
+			if (!ap_state.episodes[loc->ep - 1])
 				continue;
-			for (const auto& kv2 : kv1.second)
+			if (loc->index == -1) continue;
+			if (validate_doom_location({loc->ep - 1, loc->map - 1}, loc->index))
 			{
-				for (const auto& kv3 : kv2.second)
-				{
-					if (kv3.first == -1) continue;
-#if 0 // Was this used to debug something in the past? Either way, it does nothing anymore
-					if (kv3.second == 371349)
-					{
-						int tmp;
-						tmp = 5;
-					}
-#endif
-					if (validate_doom_location({kv1.first - 1, kv2.first - 1}, kv3.first))
-					{
-						location_scouts.push_back(kv3.second);
-					}
-				}
+				location_scouts.push_back(loc->loc_id);
 			}
 		}
 		
@@ -772,28 +986,47 @@ int apdoom_init(ap_settings_t* settings)
 }
 
 
-static bool is_loc_checked(ap_level_index_t idx, int index)
+static bool is_valid_thing_index(ap_level_index_t idx, int index)
+{
+	ap_level_info_t* level_info = ap_get_level_info(idx);
+	return level_info && index >= 0 && index < level_info->thing_count;
+}
+
+
+int ap_is_location_checked(ap_level_index_t idx, int index)
 {
+	if (!is_valid_thing_index(idx, index)) return 0;
 	auto level_state = ap_get_level_state(idx);
-	for (int i = 0; i < level_state->check_count; ++i)
-	{
-		if (level_state->checks[i] == index) return true;
-	}
-	return false;
+	return (level_state->checked_bits[index / 32] >> (index % 32)) & 1;
+}
+
+
+static void set_loc_checked(ap_level_index_t idx, int index)
+{
+	auto level_state = ap_get_level_state(idx);
+	level_state->checked_bits[index / 32] |= 1u << (index % 32);
+	level_state->checks[level_state->check_count] = index;
+	level_state->check_count++;
 }
 
 
 void apdoom_shutdown()
 {
+	stop_network_thread();
 	if (ap_was_connected)
 		save_state();
+	if (ap_journal)
+	{
+		fclose(ap_journal);
+		ap_journal = nullptr;
+	}
 }
 
 
 void apdoom_save_state()
 {
 	if (ap_was_connected)
-		save_state();
+		save_state(true);
 }
 
 
@@ -866,6 +1099,7 @@ void load_state()
 	if (!f.is_open())
 	{
 		printf("  None found.\n");
+		journal_load(0); // Could still have changes from before the first save
 		return; // Could be no state yet, that's fine
 	}
 	Json::Value json;
@@ -946,9 +1180,12 @@ void load_state()
 	}
 
 	// Item queue
-	for (const auto& item_id_json : json["item_queue"])
 	{
-		ap_item_queue.push_back(item_id_json.asInt64());
+		std::lock_guard<std::mutex> lock(ap_item_queue_mutex);
+		for (const auto& item_id_json : json["item_queue"])
+		{
+			ap_item_queue.push_back(item_id_json.asInt64());
+		}
 	}
 
 	json_get_int(json["ep"], ap_state.ep);
@@ -976,6 +1213,11 @@ void load_state()
 	
 	json_get_bool_or(json["victory"], ap_state.victory);
 	printf("  Victory state: %s\n", ap_state.victory ? "true" : "false");
+
+	// Changes made after this snapshot was written
+	int journal_generation = 0;
+	json_get_int(json["journal_generation"], journal_generation);
+	journal_load(journal_generation);
 }
 
 
@@ -995,10 +1237,8 @@ static Json::Value serialize_level(int ep, int map)
 	json_level["special"] = level_state->special;
 
 	Json::Value json_checks(Json::arrayValue);
-	for (int k = 0; k < AP_CHECK_MAX; ++k)
+	for (int k = 0; k < level_state->check_count; ++k)
 	{
-		if (level_state->checks[k] == -1)
-			continue;
 		json_checks.append(level_state->checks[k]);
 	}
 	json_level["checks"] = json_checks;
@@ -1024,17 +1264,28 @@ std::vector<ap_level_index_t> get_level_indices()
 }
 
 
-void save_state()
+// level_exit is set when the game just stored the player state on level exit.
+// Other snapshots keep the items given since then queued, so a crash before
+// the next level exit gives them again instead of losing them.
+void save_state(bool level_exit)
 {
-	std::string filename = ap_save_dir_name + "/apstate.json";
-	std::ofstream f(filename);
-	if (!f.is_open())
+	// Item queue. The network thread keeps receiving while we write the snapshot,
+	// so from here on records also go to the journal that will follow it.
+	Json::Value json_item_queue(Json::arrayValue);
 	{
-		printf("Failed to save AP state.\n");
-#if WIN32
-		MessageBoxA(nullptr, "Failed to save player state. That's bad.", "Error", MB_OK);
-#endif
-		return; // Ok that's bad. we won't save player state
+		std::lock_guard<std::mutex> lock(ap_item_queue_mutex);
+		if (!level_exit)
+		{
+			for (int64_t item_id : ap_item_given)
+			{
+				json_item_queue.append(item_id);
+			}
+		}
+		for (size_t i = 0; i < ap_item_queue.size(); ++i)
+		{
+			json_item_queue.append(ap_item_queue[i]);
+		}
+		journal_begin_carry();
 	}
 
 	// Player state
@@ -1096,12 +1347,6 @@ void save_state()
 	}
 	json["episodes"] = json_episodes;
 
-	// Item queue
-	Json::Value json_item_queue(Json::arrayValue);
-	for (auto item_id : ap_item_queue)
-	{
-		json_item_queue.append(item_id);
-	}
 	json["item_queue"] = json_item_queue;
 
 	json["ep"] = ap_state.ep;
@@ -1119,7 +1364,29 @@ void save_state()
 
 	json["version"] = APDOOM_VERSION_FULL_TEXT;
 
-	f << json;
+	// The journal that follows this snapshot
+	json["journal_generation"] = ap_journal_generation + 1;
+
+	std::ostringstream ss;
+	ss << json;
+	if (!AP_WriteFileAtomic(ap_save_dir_name + "/apstate.json", ss.str()))
+	{
+		printf("Failed to save AP state.\n");
+#if WIN32
+		MessageBoxA(nullptr, "Failed to save player state. That's bad.", "Error", MB_OK);
+#endif
+		journal_end_carry(); // The old journal still has everything
+		return; // Ok that's bad. we won't save player state
+	}
+
+	if (level_exit)
+	{
+		std::lock_guard<std::mutex> lock(ap_item_queue_mutex);
+		ap_item_given.clear();
+	}
+
+	// Everything journaled before the queue copy is in the snapshot now, the rest is carried
+	journal_reset(ap_journal_generation + 1);
 }
 
 
@@ -1178,18 +1445,48 @@ const std::map<int, int>& get_weapons_map()
 }
 
 
-const std::map<int, std::string>& get_sprites()
+static ap_table_t<ap_type_sprite_t> get_sprites()
 {
 	switch (ap_game)
 	{
 		default: // Indeterminate state? Default to Doom 1
-		case ap_game_t::doom: return ap_doom_type_sprites;
-		case ap_game_t::doom2: return ap_doom2_type_sprites;
-		case ap_game_t::heretic: return ap_heretic_type_sprites;
+		case ap_game_t::doom: return make_table(ap_doom_type_sprites);
+		case ap_game_t::doom2: return make_table(ap_doom2_type_sprites);
+		case ap_game_t::heretic: return make_table(ap_heretic_type_sprites);
 	}
 }
 
 
+// Index for ap_get_notification_sprite(), -1 when the type has no sprite
+static int find_sprite(int doom_type)
+{
+	auto sprites = get_sprites();
+	auto it = std::lower_bound(sprites.begin, sprites.end, doom_type,
+		[](const ap_type_sprite_t& sprite, int type) { return sprite.doom_type < type; });
+	if (it == sprites.end || it->doom_type != doom_type)
+		return -1;
+	return (int)(it - sprites.begin);
+}
+
+
+// When the pool is full the oldest icon makes room. The item queue waits for
+// a free slot before giving items, so this only happens if something else adds icons.
+static ap_notification_icon_t* add_notification_icon()
+{
+	if (ap_notification_icon_count == AP_NOTIF_MAX)
+	{
+		if (ap_notification_icons[ap_notification_icon_first].state != AP_NOTIF_STATE_REMOVED)
+			--ap_notification_icon_live;
+		ap_notification_icon_first = (ap_notification_icon_first + 1) & (AP_NOTIF_MAX - 1);
+		--ap_notification_icon_count;
+	}
+	++ap_notification_icon_live;
+	auto icon = &ap_notification_icons[(ap_notification_icon_first + ap_notification_icon_count) & (AP_NOTIF_MAX - 1)];
+	++ap_notification_icon_count;
+	return icon;
+}
+
+
 std::string get_exmx_name(const std::string& name)
 {
 	auto pos = name.find_first_of('(');
@@ -1200,14 +1497,15 @@ std::string get_exmx_name(const std::string& name)
 
 // Split from f_itemrecv so that the item queue can call it without side-effects
 // This handles everything that requires us be in game, notification icons included
-static void process_received_item(int64_t item_id)
+// count > 1 when the same item was queued several times in a row. It's given
+// that many times but only gets one notification.
+static void process_received_item(int64_t item_id, int count)
 {
-	const auto& item_type_table = get_item_type_table();
-	auto it = item_type_table.find(item_id);
-	if (it == item_type_table.end())
+	const ap_item_t* it = find_item(item_id);
+	if (!it)
 		return; // Skip -- This is probably redundant, but whatever
 
-	ap_item_t item = it->second;
+	ap_item_t item = *it;
 	std::string notif_text;
 
 	// If the item has an associated episode/map, note that
@@ -1219,43 +1517,42 @@ static void process_received_item(int64_t item_id)
 		notif_text = get_exmx_name(level_info->name);
 	}
 
+	if (count > 1)
+		notif_text = "x" + std::to_string(count);
+
 	// Give item to in-game player
-	ap_settings.give_item_callback(item.doom_type, item.ep, item.map);
+	for (int i = 0; i < count; ++i)
+		ap_settings.give_item_callback(item.doom_type, item.ep, item.map);
 
 	// Add notification icon
-	const auto& sprite_map = get_sprites();
-	auto sprite_it = sprite_map.find(item.doom_type);
-	if (sprite_it != sprite_map.end())
-	{
-		ap_notification_icon_t notif;
-		snprintf(notif.sprite, 9, "%s", sprite_it->second.c_str());
-		notif.t = 0;
-		notif.text[0] = '\0'; // For now
+	int sprite = find_sprite(item.doom_type);
+	if (sprite >= 0)
+	{
+		ap_notification_icon_t* notif = add_notification_icon();
+		snprintf(notif->sprite, 9, "%s", ap_get_notification_sprite(sprite));
+		notif->sprite_index = sprite;
+		notif->t = 0;
+		notif->text[0] = '\0'; // For now
 		if (notif_text != "")
 		{
-			snprintf(notif.text, 260, "%s", notif_text.c_str());
+			snprintf(notif->text, 260, "%s", notif_text.c_str());
 		}
-		notif.xf = AP_NOTIF_SIZE / 2 + AP_NOTIF_PADDING;
-		notif.yf = -200.0f + AP_NOTIF_SIZE / 2;
-		notif.state = AP_NOTIF_STATE_PENDING;
-		notif.velx = 0.0f;
-		notif.vely = 0.0f;
-		notif.x = (int)notif.xf;
-		notif.y = (int)notif.yf;
-		ap_notification_icons.push_back(notif);
+		notif->xf = AP_NOTIF_SIZE / 2 + AP_NOTIF_PADDING;
+		notif->yf = -200.0f + AP_NOTIF_SIZE / 2;
+		notif->state = AP_NOTIF_STATE_PENDING;
+		notif->velx = 0.0f;
+		notif->vely = 0.0f;
+		notif->x = (int)notif->xf;
+		notif->y = (int)notif->yf;
 	}
 }
 
-void f_itemrecv(int64_t item_id, int player_id, bool notify_player)
+void f_itemrecv(int64_t item_id, int /*player_id*/, bool notify_player)
 {
-	const auto& item_type_table = get_item_type_table();
-	auto it = item_type_table.find(item_id);
-	if (it == item_type_table.end())
+	const ap_item_t* it = find_item(item_id);
+	if (!it)
 		return; // Skip
-	ap_item_t item = it->second;
-
-	ap_level_index_t idx = {item.ep - 1, item.map - 1};
-	auto level_state = ap_get_level_state(idx);
+	ap_item_t item = *it;
 
 	// Backpack?
 	if (item.doom_type == 8)
@@ -1274,6 +1571,28 @@ void f_itemrecv(int64_t item_id, int player_id, bool notify_player)
 		recalc_max_ammo();
 	}
 
+	apply_item_unlocks(item);
+
+	// Ignore inventory items, the game will add them up
+
+	if (!notify_player) return;
+
+	// Always queued, this is called from the network thread. Journaled under the
+	// same lock, so a snapshot's queue copy has either both or neither.
+	std::lock_guard<std::mutex> lock(ap_item_queue_mutex);
+
+	// Only new items are journaled, the server sends the others again on every connect
+	journal_write(AP_JOURNAL_ITEM, {item_id, 1});
+	ap_item_queue.push_back(item_id);
+}
+
+
+// Things an item permanently unlocks. Safe to apply more than once
+static void apply_item_unlocks(const ap_item_t& item)
+{
+	ap_level_index_t idx = {item.ep - 1, item.map - 1};
+	auto level_state = ap_get_level_state(idx);
+
 	// Key?
 	const auto& keys_map = get_keys_map();
 	auto key_it = keys_map.find(item.doom_type);
@@ -1297,15 +1616,6 @@ void f_itemrecv(int64_t item_id, int player_id, bool notify_player)
 	// Level complete?
 	if (item.doom_type == -2)
 		level_state->completed = 1;
-
-	// Ignore inventory items, the game will add them up
-
-	if (!notify_player) return;
-
-	if (!ap_is_in_game)
-		ap_item_queue.push_back(item_id);
-	else
-		process_received_item(item_id);
 }
 
 
@@ -1315,25 +1625,16 @@ bool find_location(int64_t loc_id, int &ep, int &map, int &index)
 	map = -1;
 	index = -1;
 
-	const auto& loc_table = get_location_table();
-	for (const auto& loc_map_table : loc_table)
-	{
-		for (const auto& loc_index_table : loc_map_table.second)
-		{
-			for (const auto& loc_index : loc_index_table.second)
-			{
-				if (loc_index.second == loc_id)
-				{
-					ep = loc_map_table.first;
-					map = loc_index_table.first;
-					index = loc_index.first;
-					break;
-				}
-			}
-			if (ep != -1) break;
-		}
-		if (ep != -1) break;
-	}
+	// Binary search the reverse index. This gets called for every location on (re)connect.
+	auto loc_index = get_location_index();
+	auto it = std::lower_bound(loc_index.begin, loc_index.end, loc_id,
+		[](const ap_location_t& loc, int64_t id) { return loc.loc_id < id; });
+	if (it == loc_index.end || it->loc_id != loc_id)
+		return false;
+
+	ep = it->ep;
+	map = it->map;
+	index = it->index;
 	return (ep > 0);
 }
 
@@ -1353,12 +1654,11 @@ void f_locrecv(int64_t loc_id)
 	ap_level_index_t idx = {ep - 1, map - 1};
 
 	// Make sure we didn't already check it
-	if (is_loc_checked(idx, index)) return;
-	if (index < 0) return;
+	if (!is_valid_thing_index(idx, index)) return;
+	if (ap_is_location_checked(idx, index)) return;
 
-	auto level_state = ap_get_level_state(idx);
-	level_state->checks[level_state->check_count] = index;
-	level_state->check_count++;
+	set_loc_checked(idx, index);
+	journal_write(AP_JOURNAL_LOCATION, {idx.ep, idx.map, index});
 }
 
 
@@ -1372,31 +1672,234 @@ void f_locinfo(std::vector<AP_NetworkItem> loc_infos)
 }
 
 
-const char* apdoom_get_seed()
+static std::string get_journal_filename()
 {
-	return ap_save_dir_name.c_str();
+	return ap_save_dir_name + "/apstate.journal";
 }
 
 
-void apdoom_check_location(ap_level_index_t idx, int index)
+// FNV-1a, catches records torn by a crash
+static uint32_t journal_checksum(const uint8_t* head, const int64_t* values, int count)
 {
-	int64_t id = 0;
-	const auto& loc_table = get_location_table();
+	uint32_t hash = 2166136261u;
+	auto add_bytes = [&hash](const uint8_t* bytes, size_t size)
+	{
+		for (size_t i = 0; i < size; ++i)
+			hash = (hash ^ bytes[i]) * 16777619u;
+	};
+	add_bytes(head, 2);
+	add_bytes((const uint8_t*)values, sizeof(int64_t) * count);
+	return hash;
+}
+
+
+static void journal_reset(int generation)
+{
+	std::lock_guard<std::mutex> lock(ap_journal_mutex);
+
+	if (ap_journal)
+		fclose(ap_journal);
+
+	// Records the last snapshot missed start the new journal
+	std::vector<uint8_t> carry;
+	int carry_count = 0;
+	if (ap_journal_carrying)
+	{
+		carry.swap(ap_journal_carry);
+		carry_count = ap_journal_carry_count;
+		ap_journal_carrying = false;
+		ap_journal_carry_count = 0;
+	}
+
+	ap_journal_generation = generation;
+	ap_journal_record_count = 0;
+	ap_journal = AP_fopen(get_journal_filename().c_str(), "wb");
+	if (!ap_journal)
+	{
+		printf("APDOOM: Failed to open state journal\n");
+		return;
+	}
+
+	uint32_t header[2] = {AP_JOURNAL_MAGIC, (uint32_t)generation};
+	fwrite(header, sizeof(header), 1, ap_journal);
+	fwrite(carry.data(), 1, carry.size(), ap_journal);
+	ap_journal_record_count = carry_count;
+	AP_SyncFile(ap_journal);
+}
+
+
+// Called with the item queue locked, after save_state copied it. Records written
+// until the next journal_reset are what that snapshot misses, so they are kept
+// and start the new journal.
+static void journal_begin_carry()
+{
+	std::lock_guard<std::mutex> lock(ap_journal_mutex);
+	ap_journal_carrying = true;
+	ap_journal_carry.clear();
+	ap_journal_carry_count = 0;
+}
+
+
+static void journal_end_carry()
+{
+	std::lock_guard<std::mutex> lock(ap_journal_mutex);
+	ap_journal_carrying = false;
+	ap_journal_carry.clear();
+	ap_journal_carry_count = 0;
+}
+
+
+// Records are flushed one at a time so they survive the game crashing. They are
+// not synced to the disk, that would stall every pickup, so a system crash can
+// still lose the last few.
+static void journal_write(int type, std::initializer_list<int64_t> values)
+{
+	std::lock_guard<std::mutex> lock(ap_journal_mutex);
+
+	if (!ap_journal) return;
+
+	uint8_t head[2] = {(uint8_t)type, (uint8_t)values.size()};
+	uint32_t checksum = journal_checksum(head, values.begin(), (int)values.size());
+	fwrite(head, sizeof(head), 1, ap_journal);
+	fwrite(values.begin(), sizeof(int64_t), values.size(), ap_journal);
+	fwrite(&checksum, sizeof(checksum), 1, ap_journal);
+	fflush(ap_journal);
+	ap_journal_record_count++;
+
+	if (ap_journal_carrying)
+	{
+		const uint8_t* bytes = (const uint8_t*)values.begin();
+		ap_journal_carry.insert(ap_journal_carry.end(), head, head + sizeof(head));
+		ap_journal_carry.insert(ap_journal_carry.end(), bytes, bytes + sizeof(int64_t) * values.size());
+		ap_journal_carry.insert(ap_journal_carry.end(), (const uint8_t*)&checksum, (const uint8_t*)(&checksum + 1));
+		ap_journal_carry_count++;
+	}
+}
 
-	auto it1 = loc_table.find(idx.ep + 1);
-	if (it1 == loc_table.end()) return;
 
-	auto it2 = it1->second.find(idx.map + 1);
-	if (it2 == it1->second.end()) return;
+static void journal_level(ap_level_index_t idx)
+{
+	auto level_state = ap_get_level_state(idx);
+	journal_write(AP_JOURNAL_LEVEL, {
+		idx.ep, idx.map,
+		level_state->completed,
+		level_state->keys[0], level_state->keys[1], level_state->keys[2],
+		level_state->has_map,
+		level_state->unlocked,
+		level_state->special});
+}
 
-	auto it3 = it2->second.find(index);
-	if (it3 == it2->second.end()) return;
 
-	id = it3->second;
+static void journal_replay_record(int type, const int64_t* values, int count)
+{
+	switch (type)
+	{
+		case AP_JOURNAL_ITEM:
+		{
+			if (count < 2) break;
+			const ap_item_t* item = find_item(values[0]);
+			if (!item) break;
+			apply_item_unlocks(*item);
+			if (values[1])
+			{
+				std::lock_guard<std::mutex> lock(ap_item_queue_mutex);
+				ap_item_queue.push_back(values[0]);
+			}
+			break;
+		}
+		case AP_JOURNAL_LOCATION:
+		{
+			if (count < 3) break;
+			ap_level_index_t idx = {(int)values[0], (int)values[1]};
+			int index = (int)values[2];
+			if (is_valid_thing_index(idx, index) && !ap_is_location_checked(idx, index))
+				set_loc_checked(idx, index);
+			break;
+		}
+		case AP_JOURNAL_LEVEL:
+		{
+			if (count < 9) break;
+			ap_level_index_t idx = {(int)values[0], (int)values[1]};
+			if (!ap_get_level_info(idx)) break;
+			auto level_state = ap_get_level_state(idx);
+			level_state->completed |= (int)values[2];
+			level_state->keys[0] |= (int)values[3];
+			level_state->keys[1] |= (int)values[4];
+			level_state->keys[2] |= (int)values[5];
+			level_state->has_map |= (int)values[6];
+			level_state->unlocked |= (int)values[7];
+			level_state->special |= (int)values[8];
+			break;
+		}
+	}
+}
+
+
+// Replay the journal if it follows the snapshot we loaded, then keep appending to it
+static void journal_load(int generation)
+{
+	std::string filename = get_journal_filename();
+	FILE* f = AP_fopen(filename.c_str(), "r+b");
+	if (f)
+	{
+		uint32_t header[2];
+		if (fread(header, sizeof(header), 1, f) != 1 ||
+			header[0] != AP_JOURNAL_MAGIC ||
+			(int)header[1] != generation)
+		{
+			fclose(f);
+			f = nullptr;
+		}
+	}
+	if (!f)
+	{
+		journal_reset(generation);
+		return;
+	}
+
+	int record_count = 0;
+	long end_of_records = ftell(f);
+	while (true)
+	{
+		uint8_t head[2];
+		int64_t values[255];
+		uint32_t checksum;
+		if (fread(head, sizeof(head), 1, f) != 1) break;
+		if (fread(values, sizeof(int64_t), head[1], f) != head[1]) break;
+		if (fread(&checksum, sizeof(checksum), 1, f) != 1) break;
+		if (checksum != journal_checksum(head, values, head[1])) break;
+		journal_replay_record(head[0], values, head[1]);
+		end_of_records = ftell(f);
+		record_count++;
+	}
+	printf("  Replayed %i journal records\n", record_count);
+
+	// Anything after the last good record was torn by a crash, write over it
+	fseek(f, end_of_records, SEEK_SET);
+
+	std::lock_guard<std::mutex> lock(ap_journal_mutex);
+	if (ap_journal)
+		fclose(ap_journal);
+	ap_journal = f;
+	ap_journal_generation = generation;
+	ap_journal_record_count = record_count;
+}
+
+
+const char* apdoom_get_seed()
+{
+	return ap_save_dir_name.c_str();
+}
+
+
+void apdoom_check_location(ap_level_index_t idx, int index)
+{
+	int64_t id = 0;
+	if (!get_location_id(idx, index, id)) return;
 
 	if (index >= 0)
 	{
-		if (is_loc_checked(idx, index))
+		if (ap_is_location_checked(idx, index))
 		{
 			printf("APDOOM: Location already checked\n");
 		}
@@ -1413,18 +1916,8 @@ void apdoom_check_location(ap_level_index_t idx, int index)
 
 int apdoom_is_location_progression(ap_level_index_t idx, int index)
 {
-	const auto& loc_table = get_location_table();
-
-	auto it1 = loc_table.find(idx.ep + 1);
-	if (it1 == loc_table.end()) return 0;
-
-	auto it2 = it1->second.find(idx.map + 1);
-	if (it2 == it1->second.end()) return 0;
-
-	auto it3 = it2->second.find(index);
-	if (it3 == it2->second.end()) return 0;
-
-	int64_t id = it3->second;
+	int64_t id = 0;
+	if (!get_location_id(idx, index, id)) return 0;
 
 	return (ap_progressive_locations.find(id) != ap_progressive_locations.end()) ? 1 : 0;
 }
@@ -1433,6 +1926,7 @@ void apdoom_complete_level(ap_level_index_t idx)
 {
 	//if (ap_state.level_states[ep - 1][map - 1].completed) return; // Already completed
     ap_get_level_state(idx)->completed = 1;
+	journal_level(idx);
 	apdoom_check_location(idx, -1); // -1 is complete location
 }
 
@@ -1443,10 +1937,10 @@ ap_level_index_t ap_make_level_index(int ep /* 1-based */, int map /* 1-based */
 
 	// In Doom2, every map is ep = 1
 	ap_level_index_t ret = { 0, map - 1 };
-	const auto& table = get_level_info_table();
-	while (ret.map >= (int)table[ret.ep].size())
+	auto table = get_level_info_table();
+	while (ret.map >= table.begin[ret.ep].level_count)
 	{
-		ret.map -= (int)table[ret.ep].size();
+		ret.map -= table.begin[ret.ep].level_count;
 		ret.ep++;
 	}
 
@@ -1465,10 +1959,10 @@ int ap_index_to_map(ap_level_index_t idx)
 {
 	if (ap_game != ap_game_t::doom2) return idx.map + 1;
 
-	const auto& table = get_level_info_table();
+	auto table = get_level_info_table();
 	for (int ep = 0; ep < idx.ep; ++ep)
 	{
-		idx.map += (int)table[ep].size();
+		idx.map += table.begin[ep].level_count;
 	}
 	return idx.map + 1;
 }
@@ -1647,10 +2141,20 @@ int apdoom_should_die()
 }
 
 
-const ap_notification_icon_t* ap_get_notification_icons(int* count)
+const ap_notification_icon_t* ap_get_notification_icons(int* first, int* count)
+{
+	*first = ap_notification_icon_first;
+	*count = ap_notification_icon_count;
+	return ap_notification_icons;
+}
+
+
+const char* ap_get_notification_sprite(int i)
 {
-	*count = (int)ap_notification_icons.size();
-	return ap_notification_icons.data();
+	auto sprites = get_sprites();
+	if (i < 0 || i >= (int)(sprites.end - sprites.begin))
+		return nullptr;
+	return sprites.begin[i].sprite;
 }
 
 
@@ -1674,6 +2178,133 @@ int ap_validate_doom_location(ap_level_index_t idx, int doom_type, int index)
 }
 
 
+// Gives queued items to the player. Floods of items (e.g. on a late join) are
+// spread over several tics.
+static void process_item_queue()
+{
+	std::lock_guard<std::mutex> lock(ap_item_queue_mutex);
+
+	int budget = ap_settings.items_per_tic > 0 ? ap_settings.items_per_tic : AP_DEFAULT_ITEMS_PER_TIC;
+	while (budget-- > 0 && !ap_item_queue.empty())
+	{
+		if (ap_notification_icon_count == AP_NOTIF_MAX)
+			break; // Wait for icons to go away rather than drop the oldest
+
+		int64_t item_id = ap_item_queue.front();
+
+		// Runs of the same filler item (No level attached, like ammo or health) share a notification
+		size_t count = 1;
+		const ap_item_t* item = find_item(item_id);
+		if (item && item->ep == -1)
+			while (count < ap_item_queue.size() && ap_item_queue[count] == item_id)
+				++count;
+
+		// Not journaled. The player state only reaches apstate.json on level exit,
+		// so until then the item stays in the snapshot's queue.
+		for (size_t i = 0; i < count; ++i)
+		{
+			ap_item_queue.pop_front();
+			ap_item_given.push_back(item_id);
+		}
+		process_received_item(item_id, (int)count);
+	}
+}
+
+
+//
+// Network thread
+//
+// Drains and formats AP messages so a burst of them (e.g. after a release)
+// doesn't stall the game. Formatted messages go through a single producer,
+// single consumer ring that the game thread reads a few at a time.
+//
+
+static std::string format_message(const AP_Message* msg)
+{
+	std::string colored_msg;
+	colored_msg.reserve(128);
+
+	switch (msg->type)
+	{
+		case AP_MessageType::ItemSend:
+		{
+			auto o_msg = static_cast<const AP_ItemSendMessage*>(msg);
+			colored_msg.append("~9").append(o_msg->item);
+			colored_msg.append("~2 was sent to ~4").append(o_msg->recvPlayer);
+			break;
+		}
+		case AP_MessageType::ItemRecv:
+		{
+			auto o_msg = static_cast<const AP_ItemRecvMessage*>(msg);
+			colored_msg.append("~2Received ~9").append(o_msg->item);
+			colored_msg.append("~2 from ~4").append(o_msg->sendPlayer);
+			break;
+		}
+		case AP_MessageType::Hint:
+		{
+			auto o_msg = static_cast<const AP_HintMessage*>(msg);
+			colored_msg.append("~9").append(o_msg->item);
+			colored_msg.append("~2 from ~4").append(o_msg->sendPlayer);
+			colored_msg.append("~2 to ~4").append(o_msg->recvPlayer);
+			colored_msg.append("~2 at ~3").append(o_msg->location);
+			colored_msg.append(o_msg->checked ? " (Checked)" : " (Unchecked)");
+			break;
+		}
+		default:
+		{
+			colored_msg.append("~2").append(msg->text);
+			break;
+		}
+	}
+
+	return colored_msg;
+}
+
+
+static void network_thread_main()
+{
+	while (ap_network_thread_running.load(std::memory_order_relaxed))
+	{
+		int pushed = 0;
+		while (AP_IsMessagePending())
+		{
+			unsigned int tail = ap_message_queue_tail.load(std::memory_order_relaxed);
+			if (tail - ap_message_queue_head.load(std::memory_order_acquire) >= AP_MESSAGE_QUEUE_SIZE)
+				break; // Full, leave the rest with APCpp until the game catches up
+
+			AP_Message* msg = AP_GetLatestMessage();
+			printf("APDOOM: %s\n", msg->text.c_str());
+			ap_message_queue[tail & (AP_MESSAGE_QUEUE_SIZE - 1)] = format_message(msg);
+			AP_ClearLatestMessage();
+
+			ap_message_queue_tail.store(tail + 1, std::memory_order_release);
+			pushed++;
+		}
+
+		if (!pushed)
+			std::this_thread::sleep_for(std::chrono::milliseconds(5));
+	}
+}
+
+
+static void start_network_thread()
+{
+	if (ap_network_thread) return;
+	ap_network_thread_running = true;
+	ap_network_thread = new std::thread(network_thread_main);
+}
+
+
+static void stop_network_thread()
+{
+	if (!ap_network_thread) return;
+	ap_network_thread_running = false;
+	ap_network_thread->join();
+	delete ap_network_thread;
+	ap_network_thread = nullptr;
+}
+
+
 /*
     black: "000000"
     red: "EE0000"
@@ -1699,97 +2330,55 @@ int ap_validate_doom_location(ap_level_index_t idx, int doom_type, int index)
 */
 void apdoom_update()
 {
+	// Messages wait in the queue until the game can show them
 	if (ap_initialized)
 	{
-		if (!ap_cached_messages.empty())
+		unsigned int head = ap_message_queue_head.load(std::memory_order_relaxed);
+		unsigned int tail = ap_message_queue_tail.load(std::memory_order_acquire);
+		for (int i = 0; i < AP_MESSAGES_PER_TIC && head != tail; ++i, ++head)
 		{
-			for (const auto& cached_msg : ap_cached_messages)
-				ap_settings.message_callback(cached_msg.c_str());
-			ap_cached_messages.clear();
+			auto& msg = ap_message_queue[head & (AP_MESSAGE_QUEUE_SIZE - 1)];
+			ap_settings.message_callback(msg.c_str());
+			msg.clear();
 		}
+		ap_message_queue_head.store(head, std::memory_order_release);
 	}
 
-	while (AP_IsMessagePending())
-	{
-		AP_Message* msg = AP_GetLatestMessage();
-
-		std::string colored_msg;
-
-		switch (msg->type)
-		{
-			case AP_MessageType::ItemSend:
-			{
-				AP_ItemSendMessage* o_msg = static_cast<AP_ItemSendMessage*>(msg);
-				colored_msg = "~9" + o_msg->item + "~2 was sent to ~4" + o_msg->recvPlayer;
-				break;
-			}
-			case AP_MessageType::ItemRecv:
-			{
-				AP_ItemRecvMessage* o_msg = static_cast<AP_ItemRecvMessage*>(msg);
-				colored_msg = "~2Received ~9" + o_msg->item + "~2 from ~4" + o_msg->sendPlayer;
-				break;
-			}
-			case AP_MessageType::Hint:
-			{
-				AP_HintMessage* o_msg = static_cast<AP_HintMessage*>(msg);
-				colored_msg = "~9" + o_msg->item + "~2 from ~4" + o_msg->sendPlayer + "~2 to ~4" + o_msg->recvPlayer + "~2 at ~3" + o_msg->location + (o_msg->checked ? " (Checked)" : " (Unchecked)");
-				break;
-			}
-			default:
-			{
-				colored_msg = "~2" + msg->text;
-				break;
-			}
-		}
-
-		printf("APDOOM: %s\n", msg->text.c_str());
-
-		if (ap_initialized)
-			ap_settings.message_callback(colored_msg.c_str());
-		else
-			ap_cached_messages.push_back(colored_msg);
-
-		AP_ClearLatestMessage();
-	}
+	// Fold the journal into a new snapshot before it grows too big
+	if (ap_was_connected && ap_journal_record_count >= AP_JOURNAL_COMPACT_RECORDS)
+		save_state();
 
 	// Check if we're in game, then dequeue the items
 	if (ap_is_in_game)
-	{
-		while (!ap_item_queue.empty())
-		{
-			auto item_id = ap_item_queue.front();
-			ap_item_queue.erase(ap_item_queue.begin());
-			process_received_item(item_id);
-		}
-	}
+		process_item_queue();
 
 	// Update notification icons
 	float previous_y = 2.0f;
-	for (auto it = ap_notification_icons.begin(); it != ap_notification_icons.end();)
+	int queued_screens = ap_notification_icon_live / 4; // Faster the more we have queued (4 can display on screen)
+	for (int i = 0; i < ap_notification_icon_count; ++i)
 	{
-		auto& notification_icon = *it;
+		auto& notification_icon = ap_notification_icons[(ap_notification_icon_first + i) & (AP_NOTIF_MAX - 1)];
 
+		if (notification_icon.state == AP_NOTIF_STATE_REMOVED)
+			continue;
 		if (notification_icon.state == AP_NOTIF_STATE_PENDING && previous_y > -100.0f)
 		{
 			notification_icon.state = AP_NOTIF_STATE_DROPPING;
 		}
 		if (notification_icon.state == AP_NOTIF_STATE_PENDING)
-		{
-			++it;
 			continue;
-		}
 
 		if (notification_icon.state == AP_NOTIF_STATE_DROPPING)
 		{
-			notification_icon.vely += 0.15f + (float)(ap_notification_icons.size() / 4) * 0.25f;
+			notification_icon.vely += 0.15f + (float)queued_screens * 0.25f;
 			if (notification_icon.vely > 8.0f) notification_icon.vely = 8.0f;
 			notification_icon.yf += notification_icon.vely;
 			if (notification_icon.yf >= previous_y - AP_NOTIF_SIZE - AP_NOTIF_PADDING)
 			{
 				notification_icon.yf = previous_y - AP_NOTIF_SIZE - AP_NOTIF_PADDING;
-				notification_icon.vely *= -0.3f / ((float)(ap_notification_icons.size() / 4) * 0.05f + 1.0f);
+				notification_icon.vely *= -0.3f / ((float)queued_screens * 0.05f + 1.0f);
 
-				notification_icon.t += ap_notification_icons.size() / 4 + 1; // Faster the more we have queued (4 can display on screen)
+				notification_icon.t += queued_screens + 1;
 				if (notification_icon.t > 350 * 3 / 4) // ~7.5sec
 				{
 					notification_icon.state = AP_NOTIF_STATE_HIDING;
@@ -1799,11 +2388,12 @@ void apdoom_update()
 
 		if (notification_icon.state == AP_NOTIF_STATE_HIDING)
 		{
-			notification_icon.velx -= 0.14f + (float)(ap_notification_icons.size() / 4) * 0.1f;
+			notification_icon.velx -= 0.14f + (float)queued_screens * 0.1f;
 			notification_icon.xf += notification_icon.velx;
 			if (notification_icon.xf < -AP_NOTIF_SIZE / 2)
 			{
-				it = ap_notification_icons.erase(it);
+				notification_icon.state = AP_NOTIF_STATE_REMOVED;
+				--ap_notification_icon_live;
 				continue;
 			}
 		}
@@ -1811,8 +2401,14 @@ void apdoom_update()
 		notification_icon.x = (int)notification_icon.xf;
 		notification_icon.y = (int)notification_icon.yf;
 		previous_y = notification_icon.yf;
+	}
 
-		++it;
+	// Give back the slots of removed icons
+	while (ap_notification_icon_count > 0 &&
+		   ap_notification_icons[ap_notification_icon_first].state == AP_NOTIF_STATE_REMOVED)
+	{
+		ap_notification_icon_first = (ap_notification_icon_first + 1) & (AP_NOTIF_MAX - 1);
+		--ap_notification_icon_count;
 	}
 }
 
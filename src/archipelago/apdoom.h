@@ -36,10 +36,6 @@ extern "C"
 #define APDOOM_VERSION_FULL_TEXT "APDOOM " APDOOM_VERSION_TEXT
 
 
-#define AP_CHECK_MAX 64 // Arbitrary number
-#define AP_MAX_THING 1024 // Twice more than current max for every level
-
-
 typedef struct
 {
     int doom_type;
@@ -56,7 +52,7 @@ typedef struct
     int use_skull[3];
     int check_count;
     int thing_count;
-    ap_thing_info_t thing_infos[AP_MAX_THING];
+    const ap_thing_info_t* thing_infos; // thing_count of them
     int sanity_check_count;
 
 } ap_level_info_t;
@@ -69,7 +65,8 @@ typedef struct
     int check_count;
     int has_map;
     int unlocked;
-    int checks[AP_CHECK_MAX];
+    int* checks; // In the order they were checked, sized from the level's thing_count. Only kept for saves, use ap_is_location_checked()
+    unsigned int* checked_bits; // Bitset indexed by thing index, sized from the level's thing_count
     int special; // Berzerk or Wings
     int flipped;
     int music;
@@ -143,19 +140,23 @@ typedef struct
     int override_flip_levels; int flip_levels;
     int force_deathlink_off;
     int override_reset_level_on_death; int reset_level_on_death;
+    int items_per_tic; // Received items given per tic, 0 for default
 } ap_settings_t;
 
 
 #define AP_NOTIF_STATE_PENDING 0
 #define AP_NOTIF_STATE_DROPPING 1
 #define AP_NOTIF_STATE_HIDING 2
+#define AP_NOTIF_STATE_REMOVED 3
 #define AP_NOTIF_SIZE 30
 #define AP_NOTIF_PADDING 2
+#define AP_NOTIF_MAX 256 // Icon pool size, must be a power of two
 
 
 typedef struct
 {
     char sprite[9];
+    int sprite_index; // For ap_get_notification_sprite(), so the game can look its icon up once
     int x, y;
     float xf, yf;
     float velx, vely;
@@ -173,6 +174,21 @@ typedef struct
 } ap_level_index_t;
 
 
+// Map thing as stored in the THINGS lump
+typedef struct
+{
+    short x;
+    short y;
+    short angle;
+    short type;
+    short options;
+} ap_mapthing_t;
+
+
+// Largest radius and height that fit at a map position (fixed point)
+typedef void (*ap_fit_probe_t)(int x, int y, int* fit_radius, int* fit_height);
+
+
 extern ap_state_t ap_state;
 extern int ap_is_in_game; // Don't give items when in menu (Or when dead on the ground).
 extern int ap_episode_count;
@@ -182,6 +198,7 @@ int apdoom_init(ap_settings_t* settings);
 void apdoom_shutdown();
 void apdoom_save_state();
 void apdoom_check_location(ap_level_index_t idx, int index);
+int ap_is_location_checked(ap_level_index_t idx, int index);
 int apdoom_is_location_progression(ap_level_index_t idx, int index);
 void apdoom_check_victory();
 void apdoom_update();
@@ -190,12 +207,17 @@ void apdoom_send_message(const char* msg);
 void apdoom_complete_level(ap_level_index_t idx);
 ap_level_state_t* ap_get_level_state(ap_level_index_t idx); // 1-based
 ap_level_info_t* ap_get_level_info(ap_level_index_t idx); // 1-based
-const ap_notification_icon_t* ap_get_notification_icons(int* count);
+const ap_notification_icon_t* ap_get_notification_icons(int* first, int* count); // Pool of AP_NOTIF_MAX, icons go from first to first + count, wrapping around
+const char* ap_get_notification_sprite(int i); // Sprites icons can use, NULL past the last one
 int ap_get_highest_episode();
 int ap_validate_doom_location(ap_level_index_t idx, int doom_type, int index);
 int ap_get_map_count(int ep);
 int ap_total_check_count(ap_level_info_t *level_info);
 
+// Randomized thing types of a level, one per thing. Planned on first entry with
+// the fit probe, then kept for the seed so later loads only apply it.
+const int* ap_get_thing_remap(ap_level_index_t idx, const ap_mapthing_t* things, int count, int skill, ap_fit_probe_t fit_probe);
+
 // Deathlink stuff
 void apdoom_on_death();
 void apdoom_clear_death();
@@ -3,9504 +3,10060 @@
 
 #include "apdoom.h"
 #include "apdoom_def_types.h"
-#include <map>
-#include <string>
-#include <vector>
 
 
-const std::map<int /* ep */, std::map<int /* map */, std::map<int /* index */, int64_t /* loc id */>>> ap_doom2_location_table = {
-    {1, {
-        {1, {
-            {-1, 361004},
-            {17, 361000},
-            {37, 361001},
-            {52, 361002},
-            {68, 361003},
-        }},
-        {2, {
-            {-1, 361009},
-            {31, 361005},
-            {44, 361006},
-            {116, 361007},
-            {127, 361008},
-        }},
-        {3, {
-            {-1, 361020},
-            {5, 361010},
-            {6, 361011},
-            {85, 361012},
-            {86, 361013},
-            {96, 361014},
-            {97, 361015},
-            {98, 361016},
-            {104, 361017},
-            {122, 361018},
-            {146, 361019},
-        }},
-        {4, {
-            {-1, 361025},
-            {4, 361021},
-            {21, 361022},
-            {32, 361023},
-            {59, 361024},
-        }},
-        {5, {
-            {-1, 361038},
-            {45, 361026},
-            {46, 361027},
-            {50, 361028},
-            {53, 361029},
-            {55, 361030},
-            {56, 361031},
-            {57, 361032},
-            {78, 361033},
-            {151, 361034},
-            {170, 361035},
-            {202, 361036},
-            {215, 361037},
-        }},
-        {6, {
-            {-1, 361053},
-            {0, 361039},
-            {1, 361040},
-            {36, 361041},
-            {55, 361042},
-            {59, 361043},
-            {74, 361044},
-            {75, 361045},
-            {94, 361046},
-            {130, 361047},
-            {134, 361048},
-            {222, 361049},
-            {223, 361050},
-            {225, 361051},
-            {246, 361052},
-        }},
-        {7, {
-            {-1, 361065},
-            {4, 361054},
-            {5, 361055},
-            {7, 361056},
-            {8, 361057},
-            {9, 361058},
-            {10, 361059},
-            {43, 361060},
-            {44, 361061},
-            {60, 361062},
-            {73, 361063},
-            {74, 361064},
-        }},
-        {8, {
-            {-1, 361089},
-            {14, 361066},
-            {17, 361067},
-            {36, 361068},
-            {48, 361069},
-            {87, 361070},
-            {119, 361071},
-            {120, 361072},
-            {122, 361073},
-            {123, 361074},
-            {133, 361075},
-            {134, 361076},
-            {135, 361077},
-            {136, 361078},
-            {161, 361079},
-            {162, 361080},
-            {163, 361081},
-            {164, 361082},
-            {168, 361083},
-            {176, 361084},
-            {202, 361085},
-            {220, 361086},
-            {226, 361087},
-            {235, 361088},
-        }},
-        {9, {
-            {-1, 361105},
-            {5, 361090},
-            {21, 361091},
-            {26, 361092},
-            {78, 361093},
-            {90, 361094},
-            {92, 361095},
-            {184, 361096},
-            {185, 361097},
-            {226, 361098},
-            {244, 361099},
-            {245, 361100},
-            {250, 361101},
-            {251, 361102},
-            {309, 361103},
-            {348, 361104},
-        }},
-        {10, {
-            {-1, 361126},
-            {17, 361106},
-            {28, 361107},
-            {29, 361108},
-            {50, 361109},
-            {99, 361110},
-            {158, 361111},
-            {172, 361112},
-            {291, 361113},
-            {359, 361114},
-            {368, 361115},
-            {392, 361116},
-            {395, 361117},
-            {396, 361118},
-            {398, 361119},
-            {400, 361120},
-            {441, 361121},
-            {470, 361122},
-            {472, 361123},
-            {473, 361124},
-            {507, 361125},
-        }},
-        {11, {
-            {-1, 361141},
-            {1, 361127},
-            {14, 361128},
-            {23, 361129},
-            {30, 361130},
-            {40, 361131},
-            {42, 361132},
-            {50, 361133},
-            {58, 361134},
-            {70, 361135},
-            {83, 361136},
-            {86, 361137},
-            {88, 361138},
-            {108, 361139},
-            {110, 361140},
-        }},
-    }},
-    {2, {
-        {1, {
-            {-1, 361157},
-            {14, 361142},
-            {35, 361143},
-            {38, 361144},
-            {52, 361145},
-            {54, 361146},
-            {63, 361147},
-            {70, 361148},
-            {83, 361149},
-            {92, 361150},
-            {93, 361151},
-            {107, 361152},
-            {123, 361153},
-            {135, 361154},
-            {189, 361155},
-            {192, 361156},
-        }},
-        {2, {
-            {-1, 361179},
-            {4, 361158},
-            {42, 361159},
-            {73, 361160},
-            {131, 361161},
-            {158, 361162},
-            {183, 361163},
-            {195, 361164},
-            {201, 361165},
-            {207, 361166},
-            {231, 361167},
-            {249, 361168},
-            {250, 361169},
-            {257, 361170},
-            {258, 361171},
-            {269, 361172},
-            {280, 361173},
-            {281, 361174},
-            {282, 361175},
-            {283, 361176},
-            {296, 361177},
-            {298, 361178},
-        }},
-        {3, {
-            {-1, 361190},
-            {13, 361180},
-            {16, 361181},
-            {22, 361182},
-            {78, 361183},
-            {80, 361184},
-            {81, 361185},
-            {119, 361186},
-            {123, 361187},
-            {130, 361188},
-            {138, 361189},
-        }},
-        {4, {
-            {-1, 361213},
-            {4, 361191},
-            {11, 361192},
-            {13, 361193},
-            {14, 361194},
-            {24, 361195},
-            {48, 361196},
-            {56, 361197},
-            {57, 361198},
-            {59, 361199},
-            {71, 361200},
-            {74, 361201},
-            {86, 361202},
-            {91, 361203},
-            {93, 361204},
-            {94, 361205},
-            {100, 361206},
-            {103, 361207},
-            {113, 361208},
-            {125, 361209},
-            {178, 361210},
-            {337, 361211},
-            {361, 361212},
-        }},
-        {5, {
-            {-1, 361231},
-            {7, 361214},
-            {11, 361215},
-            {15, 361216},
-            {53, 361217},
-            {59, 361218},
-            {60, 361219},
-            {62, 361220},
-            {63, 361221},
-            {64, 361222},
-            {65, 361223},
-            {169, 361224},
-            {182, 361225},
-            {185, 361226},
-            {186, 361227},
-            {221, 361228},
-            {231, 361229},
-            {236, 361230},
-        }},
-        {6, {
-            {-1, 361249},
-            {1, 361232},
-            {7, 361233},
-            {18, 361234},
-            {34, 361235},
-            {69, 361236},
-            {75, 361237},
-            {76, 361238},
-            {77, 361239},
-            {81, 361240},
-            {92, 361241},
-            {102, 361242},
-            {114, 361243},
-            {168, 361244},
-            {179, 361245},
-            {218, 361246},
-            {261, 361247},
-            {419, 361248},
-        }},
-        {7, {
-            {-1, 361267},
-            {12, 361250},
-            {36, 361251},
-            {48, 361252},
-            {52, 361253},
-            {95, 361254},
-            {130, 361255},
-            {170, 361256},
-            {171, 361257},
-            {198, 361258},
-            {218, 361259},
-            {228, 361260},
-            {229, 361261},
-            {254, 361262},
-            {268, 361263},
-            {400, 361264},
-            {458, 361265},
-            {461, 361266},
-        }},
-        {8, {
-            {-1, 361283},
-            {64, 361268},
-            {99, 361269},
-            {116, 361270},
-            {127, 361271},
-            {174, 361272},
-            {223, 361273},
-            {232, 361274},
-            {315, 361275},
-            {370, 361276},
-            {403, 361277},
-            {404, 361278},
-            {405, 361279},
-            {415, 361280},
-            {416, 361281},
-            {431, 361282},
-        }},
-        {9, {
-            {-1, 361298},
-            {9, 361284},
-            {10, 361285},
-            {12, 361286},
-            {33, 361287},
-            {43, 361288},
-            {47, 361289},
-            {54, 361290},
-            {70, 361291},
-            {96, 361292},
-            {109, 361293},
-            {119, 361294},
-            {122, 361295},
-            {142, 361296},
-            {145, 361297},
-        }},
-    }},
-    {3, {
-        {1, {
-            {-1, 361307},
-            {70, 361299},
-            {76, 361300},
-            {108, 361301},
-            {109, 361302},
-            {112, 361303},
-            {194, 361304},
-            {199, 361305},
-            {215, 361306},
-        }},
-        {2, {
-            {-1, 361316},
-            {4, 361308},
-            {5, 361309},
-            {12, 361310},
-            {28, 361311},
-            {45, 361312},
-            {83, 361313},
-            {118, 361314},
-            {119, 361315},
-        }},
-        {3, {
-            {-1, 361328},
-            {136, 361317},
-            {222, 361318},
-            {223, 361319},
-            {224, 361320},
-            {249, 361321},
-            {264, 361322},
-            {266, 361323},
-            {277, 361324},
-            {301, 361325},
-            {307, 361326},
-            {342, 361327},
-        }},
-        {4, {
-            {-1, 361343},
-            {5, 361329},
-            {6, 361330},
-            {12, 361331},
-            {22, 361332},
-            {23, 361333},
-            {31, 361334},
-            {79, 361335},
-            {155, 361336},
-            {169, 361337},
-            {261, 361338},
-            {295, 361339},
-            {353, 361340},
-            {355, 361341},
-            {362, 361342},
-        }},
-        {5, {
-            {-1, 361355},
-            {6, 361344},
-            {7, 361345},
-            {23, 361346},
-            {34, 361347},
-            {103, 361348},
-            {104, 361349},
-            {106, 361350},
-            {150, 361351},
-            {169, 361352},
-            {186, 361353},
-            {236, 361354},
-        }},
-        {6, {
-            {-1, 361368},
-            {20, 361356},
-            {21, 361357},
-            {49, 361358},
-            {95, 361359},
-            {107, 361360},
-            {154, 361361},
-            {155, 361362},
-            {159, 361363},
-            {170, 361364},
-            {182, 361365},
-            {229, 361366},
-            {254, 361367},
-        }},
-        {7, {
-            {-1, 361399},
-            {4, 361369},
-            {51, 361370},
-            {58, 361371},
-            {60, 361372},
-            {86, 361373},
-            {105, 361374},
-            {107, 361375},
-            {122, 361376},
-            {236, 361377},
-            {239, 361378},
-            {251, 361379},
-            {279, 361380},
-            {285, 361381},
-            {286, 361382},
-            {287, 361383},
-            {310, 361384},
-            {364, 361385},
-            {365, 361386},
-            {382, 361387},
-            {392, 361388},
-            {393, 361389},
-            {394, 361390},
-            {414, 361391},
-            {424, 361392},
-            {425, 361393},
-            {426, 361394},
-            {454, 361395},
-            {455, 361396},
-            {460, 361397},
-            {470, 361398},
-        }},
-        {8, {
-            {-1, 361422},
-            {19, 361400},
-            {66, 361401},
-            {76, 361402},
-            {87, 361403},
-            {95, 361404},
-            {96, 361405},
-            {124, 361406},
-            {155, 361407},
-            {156, 361408},
-            {157, 361409},
-            {158, 361410},
-            {159, 361411},
-            {163, 361412},
-            {179, 361413},
-            {180, 361414},
-            {181, 361415},
-            {183, 361416},
-            {185, 361417},
-            {186, 361418},
-            {195, 361419},
-            {214, 361420},
-            {216, 361421},
-        }},
-        {9, {
-            {-1, 361433},
-            {85, 361423},
-            {124, 361424},
-            {179, 361425},
-            {195, 361426},
-            {216, 361427},
-            {224, 361428},
-            {235, 361429},
-            {237, 361430},
-            {241, 361431},
-            {263, 361432},
-        }},
-        {10, {
-            {-1, 361452},
-            {25, 361434},
-            {26, 361435},
-            {28, 361436},
-            {29, 361437},
-            {30, 361438},
-            {31, 361439},
-            {32, 361440},
-            {40, 361441},
-            {41, 361442},
-            {42, 361443},
-            {43, 361444},
-            {44, 361445},
-            {45, 361446},
-            {46, 361447},
-            {47, 361448},
-            {64, 361449},
-            {85, 361450},
-            {94, 361451},
-        }},
-    }},
-    {4, {
-        {1, {
-            {-1, 361467},
-            {110, 361453},
-            {139, 361454},
-            {263, 361455},
-            {278, 361456},
-            {305, 361457},
-            {308, 361458},
-            {309, 361459},
-            {310, 361460},
-            {311, 361461},
-            {312, 361462},
-            {313, 361463},
-            {314, 361464},
-            {315, 361465},
-            {316, 361466},
-        }},
-        {2, {
-            {-1, 361478},
-            {33, 361468},
-            {57, 361469},
-            {70, 361470},
-            {74, 361471},
-            {75, 361472},
-            {78, 361473},
-            {79, 361474},
-            {80, 361475},
-            {81, 361476},
-            {82, 361477},
-        }},
-    }},
+// Ep/map/index -> loc id. Sorted by ep, map, then index
+constexpr ap_location_t ap_doom2_location_table[] = {
+    {361004, 1, 1, -1},
+    {361000, 1, 1, 17},
+    {361001, 1, 1, 37},
+    {361002, 1, 1, 52},
+    {361003, 1, 1, 68},
+    {361009, 1, 2, -1},
+    {361005, 1, 2, 31},
+    {361006, 1, 2, 44},
+    {361007, 1, 2, 116},
+    {361008, 1, 2, 127},
+    {361020, 1, 3, -1},
+    {361010, 1, 3, 5},
+    {361011, 1, 3, 6},
+    {361012, 1, 3, 85},
+    {361013, 1, 3, 86},
+    {361014, 1, 3, 96},
+    {361015, 1, 3, 97},
+    {361016, 1, 3, 98},
+    {361017, 1, 3, 104},
+    {361018, 1, 3, 122},
+    {361019, 1, 3, 146},
+    {361025, 1, 4, -1},
+    {361021, 1, 4, 4},
+    {361022, 1, 4, 21},
+    {361023, 1, 4, 32},
+    {361024, 1, 4, 59},
+    {361038, 1, 5, -1},
+    {361026, 1, 5, 45},
+    {361027, 1, 5, 46},
+    {361028, 1, 5, 50},
+    {361029, 1, 5, 53},
+    {361030, 1, 5, 55},
+    {361031, 1, 5, 56},
+    {361032, 1, 5, 57},
+    {361033, 1, 5, 78},
+    {361034, 1, 5, 151},
+    {361035, 1, 5, 170},
+    {361036, 1, 5, 202},
+    {361037, 1, 5, 215},
+    {361053, 1, 6, -1},
+    {361039, 1, 6, 0},
+    {361040, 1, 6, 1},
+    {361041, 1, 6, 36},
+    {361042, 1, 6, 55},
+    {361043, 1, 6, 59},
+    {361044, 1, 6, 74},
+    {361045, 1, 6, 75},
+    {361046, 1, 6, 94},
+    {361047, 1, 6, 130},
+    {361048, 1, 6, 134},
+    {361049, 1, 6, 222},
+    {361050, 1, 6, 223},
+    {361051, 1, 6, 225},
+    {361052, 1, 6, 246},
+    {361065, 1, 7, -1},
+    {361054, 1, 7, 4},
+    {361055, 1, 7, 5},
+    {361056, 1, 7, 7},
+    {361057, 1, 7, 8},
+    {361058, 1, 7, 9},
+    {361059, 1, 7, 10},
+    {361060, 1, 7, 43},
+    {361061, 1, 7, 44},
+    {361062, 1, 7, 60},
+    {361063, 1, 7, 73},
+    {361064, 1, 7, 74},
+    {361089, 1, 8, -1},
+    {361066, 1, 8, 14},
+    {361067, 1, 8, 17},
+    {361068, 1, 8, 36},
+    {361069, 1, 8, 48},
+    {361070, 1, 8, 87},
+    {361071, 1, 8, 119},
+    {361072, 1, 8, 120},
+    {361073, 1, 8, 122},
+    {361074, 1, 8, 123},
+    {361075, 1, 8, 133},
+    {361076, 1, 8, 134},
+    {361077, 1, 8, 135},
+    {361078, 1, 8, 136},
+    {361079, 1, 8, 161},
+    {361080, 1, 8, 162},
+    {361081, 1, 8, 163},
+    {361082, 1, 8, 164},
+    {361083, 1, 8, 168},
+    {361084, 1, 8, 176},
+    {361085, 1, 8, 202},
+    {361086, 1, 8, 220},
+    {361087, 1, 8, 226},
+    {361088, 1, 8, 235},
+    {361105, 1, 9, -1},
+    {361090, 1, 9, 5},
+    {361091, 1, 9, 21},
+    {361092, 1, 9, 26},
+    {361093, 1, 9, 78},
+    {361094, 1, 9, 90},
+    {361095, 1, 9, 92},
+    {361096, 1, 9, 184},
+    {361097, 1, 9, 185},
+    {361098, 1, 9, 226},
+    {361099, 1, 9, 244},
+    {361100, 1, 9, 245},
+    {361101, 1, 9, 250},
+    {361102, 1, 9, 251},
+    {361103, 1, 9, 309},
+    {361104, 1, 9, 348},
+    {361126, 1, 10, -1},
+    {361106, 1, 10, 17},
+    {361107, 1, 10, 28},
+    {361108, 1, 10, 29},
+    {361109, 1, 10, 50},
+    {361110, 1, 10, 99},
+    {361111, 1, 10, 158},
+    {361112, 1, 10, 172},
+    {361113, 1, 10, 291},
+    {361114, 1, 10, 359},
+    {361115, 1, 10, 368},
+    {361116, 1, 10, 392},
+    {361117, 1, 10, 395},
+    {361118, 1, 10, 396},
+    {361119, 1, 10, 398},
+    {361120, 1, 10, 400},
+    {361121, 1, 10, 441},
+    {361122, 1, 10, 470},
+    {361123, 1, 10, 472},
+    {361124, 1, 10, 473},
+    {361125, 1, 10, 507},
+    {361141, 1, 11, -1},
+    {361127, 1, 11, 1},
+    {361128, 1, 11, 14},
+    {361129, 1, 11, 23},
+    {361130, 1, 11, 30},
+    {361131, 1, 11, 40},
+    {361132, 1, 11, 42},
+    {361133, 1, 11, 50},
+    {361134, 1, 11, 58},
+    {361135, 1, 11, 70},
+    {361136, 1, 11, 83},
+    {361137, 1, 11, 86},
+    {361138, 1, 11, 88},
+    {361139, 1, 11, 108},
+    {361140, 1, 11, 110},
+    {361157, 2, 1, -1},
+    {361142, 2, 1, 14},
+    {361143, 2, 1, 35},
+    {361144, 2, 1, 38},
+    {361145, 2, 1, 52},
+    {361146, 2, 1, 54},
+    {361147, 2, 1, 63},
+    {361148, 2, 1, 70},
+    {361149, 2, 1, 83},
+    {361150, 2, 1, 92},
+    {361151, 2, 1, 93},
+    {361152, 2, 1, 107},
+    {361153, 2, 1, 123},
+    {361154, 2, 1, 135},
+    {361155, 2, 1, 189},
+    {361156, 2, 1, 192},
+    {361179, 2, 2, -1},
+    {361158, 2, 2, 4},
+    {361159, 2, 2, 42},
+    {361160, 2, 2, 73},
+    {361161, 2, 2, 131},
+    {361162, 2, 2, 158},
+    {361163, 2, 2, 183},
+    {361164, 2, 2, 195},
+    {361165, 2, 2, 201},
+    {361166, 2, 2, 207},
+    {361167, 2, 2, 231},
+    {361168, 2, 2, 249},
+    {361169, 2, 2, 250},
+    {361170, 2, 2, 257},
+    {361171, 2, 2, 258},
+    {361172, 2, 2, 269},
+    {361173, 2, 2, 280},
+    {361174, 2, 2, 281},
+    {361175, 2, 2, 282},
+    {361176, 2, 2, 283},
+    {361177, 2, 2, 296},
+    {361178, 2, 2, 298},
+    {361190, 2, 3, -1},
+    {361180, 2, 3, 13},
+    {361181, 2, 3, 16},
+    {361182, 2, 3, 22},
+    {361183, 2, 3, 78},
+    {361184, 2, 3, 80},
+    {361185, 2, 3, 81},
+    {361186, 2, 3, 119},
+    {361187, 2, 3, 123},
+    {361188, 2, 3, 130},
+    {361189, 2, 3, 138},
+    {361213, 2, 4, -1},
+    {361191, 2, 4, 4},
+    {361192, 2, 4, 11},
+    {361193, 2, 4, 13},
+    {361194, 2, 4, 14},
+    {361195, 2, 4, 24},
+    {361196, 2, 4, 48},
+    {361197, 2, 4, 56},
+    {361198, 2, 4, 57},
+    {361199, 2, 4, 59},
+    {361200, 2, 4, 71},
+    {361201, 2, 4, 74},
+    {361202, 2, 4, 86},
+    {361203, 2, 4, 91},
+    {361204, 2, 4, 93},
+    {361205, 2, 4, 94},
+    {361206, 2, 4, 100},
+    {361207, 2, 4, 103},
+    {361208, 2, 4, 113},
+    {361209, 2, 4, 125},
+    {361210, 2, 4, 178},
+    {361211, 2, 4, 337},
+    {361212, 2, 4, 361},
+    {361231, 2, 5, -1},
+    {361214, 2, 5, 7},
+    {361215, 2, 5, 11},
+    {361216, 2, 5, 15},
+    {361217, 2, 5, 53},
+    {361218, 2, 5, 59},
+    {361219, 2, 5, 60},
+    {361220, 2, 5, 62},
+    {361221, 2, 5, 63},
+    {361222, 2, 5, 64},
+    {361223, 2, 5, 65},
+    {361224, 2, 5, 169},
+    {361225, 2, 5, 182},
+    {361226, 2, 5, 185},
+    {361227, 2, 5, 186},
+    {361228, 2, 5, 221},
+    {361229, 2, 5, 231},
+    {361230, 2, 5, 236},
+    {361249, 2, 6, -1},
+    {361232, 2, 6, 1},
+    {361233, 2, 6, 7},
+    {361234, 2, 6, 18},
+    {361235, 2, 6, 34},
+    {361236, 2, 6, 69},
+    {361237, 2, 6, 75},
+    {361238, 2, 6, 76},
+    {361239, 2, 6, 77},
+    {361240, 2, 6, 81},
+    {361241, 2, 6, 92},
+    {361242, 2, 6, 102},
+    {361243, 2, 6, 114},
+    {361244, 2, 6, 168},
+    {361245, 2, 6, 179},
+    {361246, 2, 6, 218},
+    {361247, 2, 6, 261},
+    {361248, 2, 6, 419},
+    {361267, 2, 7, -1},
+    {361250, 2, 7, 12},
+    {361251, 2, 7, 36},
+    {361252, 2, 7, 48},
+    {361253, 2, 7, 52},
+    {361254, 2, 7, 95},
+    {361255, 2, 7, 130},
+    {361256, 2, 7, 170},
+    {361257, 2, 7, 171},
+    {361258, 2, 7, 198},
+    {361259, 2, 7, 218},
+    {361260, 2, 7, 228},
+    {361261, 2, 7, 229},
+    {361262, 2, 7, 254},
+    {361263, 2, 7, 268},
+    {361264, 2, 7, 400},
+    {361265, 2, 7, 458},
+    {361266, 2, 7, 461},
+    {361283, 2, 8, -1},
+    {361268, 2, 8, 64},
+    {361269, 2, 8, 99},
+    {361270, 2, 8, 116},
+    {361271, 2, 8, 127},
+    {361272, 2, 8, 174},
+    {361273, 2, 8, 223},
+    {361274, 2, 8, 232},
+    {361275, 2, 8, 315},
+    {361276, 2, 8, 370},
+    {361277, 2, 8, 403},
+    {361278, 2, 8, 404},
+    {361279, 2, 8, 405},
+    {361280, 2, 8, 415},
+    {361281, 2, 8, 416},
+    {361282, 2, 8, 431},
+    {361298, 2, 9, -1},
+    {361284, 2, 9, 9},
+    {361285, 2, 9, 10},
+    {361286, 2, 9, 12},
+    {361287, 2, 9, 33},
+    {361288, 2, 9, 43},
+    {361289, 2, 9, 47},
+    {361290, 2, 9, 54},
+    {361291, 2, 9, 70},
+    {361292, 2, 9, 96},
+    {361293, 2, 9, 109},
+    {361294, 2, 9, 119},
+    {361295, 2, 9, 122},
+    {361296, 2, 9, 142},
+    {361297, 2, 9, 145},
+    {361307, 3, 1, -1},
+    {361299, 3, 1, 70},
+    {361300, 3, 1, 76},
+    {361301, 3, 1, 108},
+    {361302, 3, 1, 109},
+    {361303, 3, 1, 112},
+    {361304, 3, 1, 194},
+    {361305, 3, 1, 199},
+    {361306, 3, 1, 215},
+    {361316, 3, 2, -1},
+    {361308, 3, 2, 4},
+    {361309, 3, 2, 5},
+    {361310, 3, 2, 12},
+    {361311, 3, 2, 28},
+    {361312, 3, 2, 45},
+    {361313, 3, 2, 83},
+    {361314, 3, 2, 118},
+    {361315, 3, 2, 119},
+    {361328, 3, 3, -1},
+    {361317, 3, 3, 136},
+    {361318, 3, 3, 222},
+    {361319, 3, 3, 223},
+    {361320, 3, 3, 224},
+    {361321, 3, 3, 249},
+    {361322, 3, 3, 264},
+    {361323, 3, 3, 266},
+    {361324, 3, 3, 277},
+    {361325, 3, 3, 301},
+    {361326, 3, 3, 307},
+    {361327, 3, 3, 342},
+    {361343, 3, 4, -1},
+    {361329, 3, 4, 5},
+    {361330, 3, 4, 6},
+    {361331, 3, 4, 12},
+    {361332, 3, 4, 22},
+    {361333, 3, 4, 23},
+    {361334, 3, 4, 31},
+    {361335, 3, 4, 79},
+    {361336, 3, 4, 155},
+    {361337, 3, 4, 169},
+    {361338, 3, 4, 261},
+    {361339, 3, 4, 295},
+    {361340, 3, 4, 353},
+    {361341, 3, 4, 355},
+    {361342, 3, 4, 362},
+    {361355, 3, 5, -1},
+    {361344, 3, 5, 6},
+    {361345, 3, 5, 7},
+    {361346, 3, 5, 23},
+    {361347, 3, 5, 34},
+    {361348, 3, 5, 103},
+    {361349, 3, 5, 104},
+    {361350, 3, 5, 106},
+    {361351, 3, 5, 150},
+    {361352, 3, 5, 169},
+    {361353, 3, 5, 186},
+    {361354, 3, 5, 236},
+    {361368, 3, 6, -1},
+    {361356, 3, 6, 20},
+    {361357, 3, 6, 21},
+    {361358, 3, 6, 49},
+    {361359, 3, 6, 95},
+    {361360, 3, 6, 107},
+    {361361, 3, 6, 154},
+    {361362, 3, 6, 155},
+    {361363, 3, 6, 159},
+    {361364, 3, 6, 170},
+    {361365, 3, 6, 182},
+    {361366, 3, 6, 229},
+    {361367, 3, 6, 254},
+    {361399, 3, 7, -1},
+    {361369, 3, 7, 4},
+    {361370, 3, 7, 51},
+    {361371, 3, 7, 58},
+    {361372, 3, 7, 60},
+    {361373, 3, 7, 86},
+    {361374, 3, 7, 105},
+    {361375, 3, 7, 107},
+    {361376, 3, 7, 122},
+    {361377, 3, 7, 236},
+    {361378, 3, 7, 239},
+    {361379, 3, 7, 251},
+    {361380, 3, 7, 279},
+    {361381, 3, 7, 285},
+    {361382, 3, 7, 286},
+    {361383, 3, 7, 287},
+    {361384, 3, 7, 310},
+    {361385, 3, 7, 364},
+    {361386, 3, 7, 365},
+    {361387, 3, 7, 382},
+    {361388, 3, 7, 392},
+    {361389, 3, 7, 393},
+    {361390, 3, 7, 394},
+    {361391, 3, 7, 414},
+    {361392, 3, 7, 424},
+    {361393, 3, 7, 425},
+    {361394, 3, 7, 426},
+    {361395, 3, 7, 454},
+    {361396, 3, 7, 455},
+    {361397, 3, 7, 460},
+    {361398, 3, 7, 470},
+    {361422, 3, 8, -1},
+    {361400, 3, 8, 19},
+    {361401, 3, 8, 66},
+    {361402, 3, 8, 76},
+    {361403, 3, 8, 87},
+    {361404, 3, 8, 95},
+    {361405, 3, 8, 96},
+    {361406, 3, 8, 124},
+    {361407, 3, 8, 155},
+    {361408, 3, 8, 156},
+    {361409, 3, 8, 157},
+    {361410, 3, 8, 158},
+    {361411, 3, 8, 159},
+    {361412, 3, 8, 163},
+    {361413, 3, 8, 179},
+    {361414, 3, 8, 180},
+    {361415, 3, 8, 181},
+    {361416, 3, 8, 183},
+    {361417, 3, 8, 185},
+    {361418, 3, 8, 186},
+    {361419, 3, 8, 195},
+    {361420, 3, 8, 214},
+    {361421, 3, 8, 216},
+    {361433, 3, 9, -1},
+    {361423, 3, 9, 85},
+    {361424, 3, 9, 124},
+    {361425, 3, 9, 179},
+    {361426, 3, 9, 195},
+    {361427, 3, 9, 216},
+    {361428, 3, 9, 224},
+    {361429, 3, 9, 235},
+    {361430, 3, 9, 237},
+    {361431, 3, 9, 241},
+    {361432, 3, 9, 263},
+    {361452, 3, 10, -1},
+    {361434, 3, 10, 25},
+    {361435, 3, 10, 26},
+    {361436, 3, 10, 28},
+    {361437, 3, 10, 29},
+    {361438, 3, 10, 30},
+    {361439, 3, 10, 31},
+    {361440, 3, 10, 32},
+    {361441, 3, 10, 40},
+    {361442, 3, 10, 41},
+    {361443, 3, 10, 42},
+    {361444, 3, 10, 43},
+    {361445, 3, 10, 44},
+    {361446, 3, 10, 45},
+    {361447, 3, 10, 46},
+    {361448, 3, 10, 47},
+    {361449, 3, 10, 64},
+    {361450, 3, 10, 85},
+    {361451, 3, 10, 94},
+    {361467, 4, 1, -1},
+    {361453, 4, 1, 110},
+    {361454, 4, 1, 139},
+    {361455, 4, 1, 263},
+    {361456, 4, 1, 278},
+    {361457, 4, 1, 305},
+    {361458, 4, 1, 308},
+    {361459, 4, 1, 309},
+    {361460, 4, 1, 310},
+    {361461, 4, 1, 311},
+    {361462, 4, 1, 312},
+    {361463, 4, 1, 313},
+    {361464, 4, 1, 314},
+    {361465, 4, 1, 315},
+    {361466, 4, 1, 316},
+    {361478, 4, 2, -1},
+    {361468, 4, 2, 33},
+    {361469, 4, 2, 57},
+    {361470, 4, 2, 70},
+    {361471, 4, 2, 74},
+    {361472, 4, 2, 75},
+    {361473, 4, 2, 78},
+    {361474, 4, 2, 79},
+    {361475, 4, 2, 80},
+    {361476, 4, 2, 81},
+    {361477, 4, 2, 82},
 };
 
 
-// Map item id
-const std::map<int64_t, ap_item_t> ap_doom2_item_table = {
-    {360000, {2001, -1, -1}},
-    {360001, {2003, -1, -1}},
-    {360002, {2004, -1, -1}},
-    {360003, {2005, -1, -1}},
-    {360004, {2002, -1, -1}},
-    {360005, {2006, -1, -1}},
-    {360006, {82, -1, -1}},
-    {360007, {8, -1, -1}},
-    {360008, {2018, -1, -1}},
-    {360009, {2019, -1, -1}},
-    {360010, {2023, -1, -1}},
-    {360011, {2022, -1, -1}},
-    {360012, {2024, -1, -1}},
-    {360013, {2013, -1, -1}},
-    {360014, {83, -1, -1}},
-    {360015, {2012, -1, -1}},
-    {360016, {2048, -1, -1}},
-    {360017, {2046, -1, -1}},
-    {360018, {2049, -1, -1}},
-    {360019, {17, -1, -1}},
-    {360200, {13, 1, 2}},
-    {360201, {5, 1, 2}},
-    {360202, {5, 1, 3}},
-    {360203, {13, 1, 3}},
-    {360204, {5, 1, 4}},
-    {360205, {13, 1, 4}},
-    {360206, {6, 1, 4}},
-    {360207, {5, 1, 5}},
-    {360208, {13, 1, 5}},
-    {360209, {6, 1, 5}},
-    {360210, {13, 1, 6}},
-    {360211, {6, 1, 6}},
-    {360212, {5, 1, 6}},
-    {360213, {39, 1, 8}},
-    {360214, {38, 1, 8}},
-    {360215, {5, 1, 9}},
-    {360216, {6, 1, 9}},
-    {360217, {5, 1, 10}},
-    {360218, {6, 1, 10}},
-    {360219, {13, 1, 11}},
-    {360220, {5, 1, 11}},
-    {360221, {5, 2, 1}},
-    {360222, {6, 2, 1}},
-    {360223, {5, 2, 2}},
-    {360224, {6, 2, 2}},
-    {360225, {13, 2, 2}},
-    {360226, {38, 2, 3}},
-    {360227, {40, 2, 3}},
-    {360228, {6, 2, 4}},
-    {360229, {13, 2, 4}},
-    {360230, {5, 2, 4}},
-    {360231, {40, 2, 5}},
-    {360232, {38, 2, 5}},
-    {360233, {13, 2, 6}},
-    {360234, {5, 2, 6}},
-    {360235, {39, 2, 6}},
-    {360236, {39, 2, 7}},
-    {360237, {40, 2, 7}},
-    {360238, {40, 2, 8}},
-    {360239, {38, 2, 8}},
-    {360240, {39, 2, 8}},
-    {360241, {39, 3, 1}},
-    {360242, {40, 3, 1}},
-    {360243, {38, 3, 1}},
-    {360244, {40, 3, 2}},
-    {360245, {38, 3, 2}},
-    {360246, {39, 3, 3}},
-    {360247, {5, 3, 4}},
-    {360248, {13, 3, 4}},
-    {360249, {40, 3, 5}},
-    {360250, {5, 3, 6}},
-    {360251, {13, 3, 6}},
-    {360252, {6, 3, 6}},
-    {360253, {39, 3, 7}},
-    {360254, {38, 3, 7}},
-    {360255, {40, 3, 7}},
-    {360256, {39, 3, 8}},
-    {360257, {38, 3, 8}},
-    {360400, {-1, 1, 1}},
-    {360401, {-2, 1, 1}},
-    {360402, {2026, 1, 1}},
-    {360403, {-1, 1, 2}},
-    {360404, {-2, 1, 2}},
-    {360405, {2026, 1, 2}},
-    {360406, {-1, 1, 3}},
-    {360407, {-2, 1, 3}},
-    {360408, {2026, 1, 3}},
-    {360409, {-1, 1, 4}},
-    {360410, {-2, 1, 4}},
-    {360411, {2026, 1, 4}},
-    {360412, {-1, 1, 5}},
-    {360413, {-2, 1, 5}},
-    {360414, {2026, 1, 5}},
-    {360415, {-1, 1, 6}},
-    {360416, {-2, 1, 6}},
-    {360417, {2026, 1, 6}},
-    {360418, {-1, 1, 7}},
-    {360419, {-2, 1, 7}},
-    {360420, {2026, 1, 7}},
-    {360421, {-1, 1, 8}},
-    {360422, {-2, 1, 8}},
-    {360423, {2026, 1, 8}},
-    {360424, {-1, 1, 9}},
-    {360425, {-2, 1, 9}},
-    {360426, {2026, 1, 9}},
-    {360427, {-1, 1, 10}},
-    {360428, {-2, 1, 10}},
-    {360429, {2026, 1, 10}},
-    {360430, {-1, 1, 11}},
-    {360431, {-2, 1, 11}},
-    {360432, {2026, 1, 11}},
-    {360433, {-1, 2, 1}},
-    {360434, {-2, 2, 1}},
-    {360435, {2026, 2, 1}},
-    {360436, {-1, 2, 2}},
-    {360437, {-2, 2, 2}},
-    {360438, {2026, 2, 2}},
-    {360439, {-1, 2, 3}},
-    {360440, {-2, 2, 3}},
-    {360441, {2026, 2, 3}},
-    {360442, {-1, 2, 4}},
-    {360443, {-2, 2, 4}},
-    {360444, {2026, 2, 4}},
-    {360445, {-1, 2, 5}},
-    {360446, {-2, 2, 5}},
-    {360447, {2026, 2, 5}},
-    {360448, {-1, 2, 6}},
-    {360449, {-2, 2, 6}},
-    {360450, {2026, 2, 6}},
-    {360451, {-1, 2, 7}},
-    {360452, {-2, 2, 7}},
-    {360453, {2026, 2, 7}},
-    {360454, {-1, 2, 8}},
-    {360455, {-2, 2, 8}},
-    {360456, {2026, 2, 8}},
-    {360457, {-1, 2, 9}},
-    {360458, {-2, 2, 9}},
-    {360459, {2026, 2, 9}},
-    {360460, {-1, 3, 1}},
-    {360461, {-2, 3, 1}},
-    {360462, {2026, 3, 1}},
-    {360463, {-1, 3, 2}},
-    {360464, {-2, 3, 2}},
-    {360465, {2026, 3, 2}},
-    {360466, {-1, 3, 3}},
-    {360467, {-2, 3, 3}},
-    {360468, {2026, 3, 3}},
-    {360469, {-1, 3, 4}},
-    {360470, {-2, 3, 4}},
-    {360471, {2026, 3, 4}},
-    {360472, {-1, 3, 5}},
-    {360473, {-2, 3, 5}},
-    {360474, {2026, 3, 5}},
-    {360475, {-1, 3, 6}},
-    {360476, {-2, 3, 6}},
-    {360477, {2026, 3, 6}},
-    {360478, {-1, 3, 7}},
-    {360479, {-2, 3, 7}},
-    {360480, {2026, 3, 7}},
-    {360481, {-1, 3, 8}},
-    {360482, {-2, 3, 8}},
-    {360483, {2026, 3, 8}},
-    {360484, {-1, 3, 9}},
-    {360485, {-2, 3, 9}},
-    {360486, {2026, 3, 9}},
-    {360487, {-1, 3, 10}},
-    {360488, {-2, 3, 10}},
-    {360489, {2026, 3, 10}},
-    {360490, {-1, 4, 1}},
-    {360491, {-2, 4, 1}},
-    {360492, {2026, 4, 1}},
-    {360493, {-1, 4, 2}},
-    {360494, {-2, 4, 2}},
-    {360495, {2026, 4, 2}},
-    {360600, {65001, -1, -1}},
-    {360601, {65002, -1, -1}},
-    {360602, {65003, -1, -1}},
-    {360603, {65004, -1, -1}},
+// Loc id -> ep/map/index. Sorted by loc id
+constexpr ap_location_t ap_doom2_location_index[] = {
+    {361000, 1, 1, 17},
+    {361001, 1, 1, 37},
+    {361002, 1, 1, 52},
+    {361003, 1, 1, 68},
+    {361004, 1, 1, -1},
+    {361005, 1, 2, 31},
+    {361006, 1, 2, 44},
+    {361007, 1, 2, 116},
+    {361008, 1, 2, 127},
+    {361009, 1, 2, -1},
+    {361010, 1, 3, 5},
+    {361011, 1, 3, 6},
+    {361012, 1, 3, 85},
+    {361013, 1, 3, 86},
+    {361014, 1, 3, 96},
+    {361015, 1, 3, 97},
+    {361016, 1, 3, 98},
+    {361017, 1, 3, 104},
+    {361018, 1, 3, 122},
+    {361019, 1, 3, 146},
+    {361020, 1, 3, -1},
+    {361021, 1, 4, 4},
+    {361022, 1, 4, 21},
+    {361023, 1, 4, 32},
+    {361024, 1, 4, 59},
+    {361025, 1, 4, -1},
+    {361026, 1, 5, 45},
+    {361027, 1, 5, 46},
+    {361028, 1, 5, 50},
+    {361029, 1, 5, 53},
+    {361030, 1, 5, 55},
+    {361031, 1, 5, 56},
+    {361032, 1, 5, 57},
+    {361033, 1, 5, 78},
+    {361034, 1, 5, 151},
+    {361035, 1, 5, 170},
+    {361036, 1, 5, 202},
+    {361037, 1, 5, 215},
+    {361038, 1, 5, -1},
+    {361039, 1, 6, 0},
+    {361040, 1, 6, 1},
+    {361041, 1, 6, 36},
+    {361042, 1, 6, 55},
+    {361043, 1, 6, 59},
+    {361044, 1, 6, 74},
+    {361045, 1, 6, 75},
+    {361046, 1, 6, 94},
+    {361047, 1, 6, 130},
+    {361048, 1, 6, 134},
+    {361049, 1, 6, 222},
+    {361050, 1, 6, 223},
+    {361051, 1, 6, 225},
+    {361052, 1, 6, 246},
+    {361053, 1, 6, -1},
+    {361054, 1, 7, 4},
+    {361055, 1, 7, 5},
+    {361056, 1, 7, 7},
+    {361057, 1, 7, 8},
+    {361058, 1, 7, 9},
+    {361059, 1, 7, 10},
+    {361060, 1, 7, 43},
+    {361061, 1, 7, 44},
+    {361062, 1, 7, 60},
+    {361063, 1, 7, 73},
+    {361064, 1, 7, 74},
+    {361065, 1, 7, -1},
+    {361066, 1, 8, 14},
+    {361067, 1, 8, 17},
+    {361068, 1, 8, 36},
+    {361069, 1, 8, 48},
+    {361070, 1, 8, 87},
+    {361071, 1, 8, 119},
+    {361072, 1, 8, 120},
+    {361073, 1, 8, 122},
+    {361074, 1, 8, 123},
+    {361075, 1, 8, 133},
+    {361076, 1, 8, 134},
+    {361077, 1, 8, 135},
+    {361078, 1, 8, 136},
+    {361079, 1, 8, 161},
+    {361080, 1, 8, 162},
+    {361081, 1, 8, 163},
+    {361082, 1, 8, 164},
+    {361083, 1, 8, 168},
+    {361084, 1, 8, 176},
+    {361085, 1, 8, 202},
+    {361086, 1, 8, 220},
+    {361087, 1, 8, 226},
+    {361088, 1, 8, 235},
+    {361089, 1, 8, -1},
+    {361090, 1, 9, 5},
+    {361091, 1, 9, 21},
+    {361092, 1, 9, 26},
+    {361093, 1, 9, 78},
+    {361094, 1, 9, 90},
+    {361095, 1, 9, 92},
+    {361096, 1, 9, 184},
+    {361097, 1, 9, 185},
+    {361098, 1, 9, 226},
+    {361099, 1, 9, 244},
+    {361100, 1, 9, 245},
+    {361101, 1, 9, 250},
+    {361102, 1, 9, 251},
+    {361103, 1, 9, 309},
+    {361104, 1, 9, 348},
+    {361105, 1, 9, -1},
+    {361106, 1, 10, 17},
+    {361107, 1, 10, 28},
+    {361108, 1, 10, 29},
+    {361109, 1, 10, 50},
+    {361110, 1, 10, 99},
+    {361111, 1, 10, 158},
+    {361112, 1, 10, 172},
+    {361113, 1, 10, 291},
+    {361114, 1, 10, 359},
+    {361115, 1, 10, 368},
+    {361116, 1, 10, 392},
+    {361117, 1, 10, 395},
+    {361118, 1, 10, 396},
+    {361119, 1, 10, 398},
+    {361120, 1, 10, 400},
+    {361121, 1, 10, 441},
+    {361122, 1, 10, 470},
+    {361123, 1, 10, 472},
+    {361124, 1, 10, 473},
+    {361125, 1, 10, 507},
+    {361126, 1, 10, -1},
+    {361127, 1, 11, 1},
+    {361128, 1, 11, 14},
+    {361129, 1, 11, 23},
+    {361130, 1, 11, 30},
+    {361131, 1, 11, 40},
+    {361132, 1, 11, 42},
+    {361133, 1, 11, 50},
+    {361134, 1, 11, 58},
+    {361135, 1, 11, 70},
+    {361136, 1, 11, 83},
+    {361137, 1, 11, 86},
+    {361138, 1, 11, 88},
+    {361139, 1, 11, 108},
+    {361140, 1, 11, 110},
+    {361141, 1, 11, -1},
+    {361142, 2, 1, 14},
+    {361143, 2, 1, 35},
+    {361144, 2, 1, 38},
+    {361145, 2, 1, 52},
+    {361146, 2, 1, 54},
+    {361147, 2, 1, 63},
+    {361148, 2, 1, 70},
+    {361149, 2, 1, 83},
+    {361150, 2, 1, 92},
+    {361151, 2, 1, 93},
+    {361152, 2, 1, 107},
+    {361153, 2, 1, 123},
+    {361154, 2, 1, 135},
+    {361155, 2, 1, 189},
+    {361156, 2, 1, 192},
+    {361157, 2, 1, -1},
+    {361158, 2, 2, 4},
+    {361159, 2, 2, 42},
+    {361160, 2, 2, 73},
+    {361161, 2, 2, 131},
+    {361162, 2, 2, 158},
+    {361163, 2, 2, 183},
+    {361164, 2, 2, 195},
+    {361165, 2, 2, 201},
+    {361166, 2, 2, 207},
+    {361167, 2, 2, 231},
+    {361168, 2, 2, 249},
+    {361169, 2, 2, 250},
+    {361170, 2, 2, 257},
+    {361171, 2, 2, 258},
+    {361172, 2, 2, 269},
+    {361173, 2, 2, 280},
+    {361174, 2, 2, 281},
+    {361175, 2, 2, 282},
+    {361176, 2, 2, 283},
+    {361177, 2, 2, 296},
+    {361178, 2, 2, 298},
+    {361179, 2, 2, -1},
+    {361180, 2, 3, 13},
+    {361181, 2, 3, 16},
+    {361182, 2, 3, 22},
+    {361183, 2, 3, 78},
+    {361184, 2, 3, 80},
+    {361185, 2, 3, 81},
+    {361186, 2, 3, 119},
+    {361187, 2, 3, 123},
+    {361188, 2, 3, 130},
+    {361189, 2, 3, 138},
+    {361190, 2, 3, -1},
+    {361191, 2, 4, 4},
+    {361192, 2, 4, 11},
+    {361193, 2, 4, 13},
+    {361194, 2, 4, 14},
+    {361195, 2, 4, 24},
+    {361196, 2, 4, 48},
+    {361197, 2, 4, 56},
+    {361198, 2, 4, 57},
+    {361199, 2, 4, 59},
+    {361200, 2, 4, 71},
+    {361201, 2, 4, 74},
+    {361202, 2, 4, 86},
+    {361203, 2, 4, 91},
+    {361204, 2, 4, 93},
+    {361205, 2, 4, 94},
+    {361206, 2, 4, 100},
+    {361207, 2, 4, 103},
+    {361208, 2, 4, 113},
+    {361209, 2, 4, 125},
+    {361210, 2, 4, 178},
+    {361211, 2, 4, 337},
+    {361212, 2, 4, 361},
+    {361213, 2, 4, -1},
+    {361214, 2, 5, 7},
+    {361215, 2, 5, 11},
+    {361216, 2, 5, 15},
+    {361217, 2, 5, 53},
+    {361218, 2, 5, 59},
+    {361219, 2, 5, 60},
+    {361220, 2, 5, 62},
+    {361221, 2, 5, 63},
+    {361222, 2, 5, 64},
+    {361223, 2, 5, 65},
+    {361224, 2, 5, 169},
+    {361225, 2, 5, 182},
+    {361226, 2, 5, 185},
+    {361227, 2, 5, 186},
+    {361228, 2, 5, 221},
+    {361229, 2, 5, 231},
+    {361230, 2, 5, 236},
+    {361231, 2, 5, -1},
+    {361232, 2, 6, 1},
+    {361233, 2, 6, 7},
+    {361234, 2, 6, 18},
+    {361235, 2, 6, 34},
+    {361236, 2, 6, 69},
+    {361237, 2, 6, 75},
+    {361238, 2, 6, 76},
+    {361239, 2, 6, 77},
+    {361240, 2, 6, 81},
+    {361241, 2, 6, 92},
+    {361242, 2, 6, 102},
+    {361243, 2, 6, 114},
+    {361244, 2, 6, 168},
+    {361245, 2, 6, 179},
+    {361246, 2, 6, 218},
+    {361247, 2, 6, 261},
+    {361248, 2, 6, 419},
+    {361249, 2, 6, -1},
+    {361250, 2, 7, 12},
+    {361251, 2, 7, 36},
+    {361252, 2, 7, 48},
+    {361253, 2, 7, 52},
+    {361254, 2, 7, 95},
+    {361255, 2, 7, 130},
+    {361256, 2, 7, 170},
+    {361257, 2, 7, 171},
+    {361258, 2, 7, 198},
+    {361259, 2, 7, 218},
+    {361260, 2, 7, 228},
+    {361261, 2, 7, 229},
+    {361262, 2, 7, 254},
+    {361263, 2, 7, 268},
+    {361264, 2, 7, 400},
+    {361265, 2, 7, 458},
+    {361266, 2, 7, 461},
+    {361267, 2, 7, -1},
+    {361268, 2, 8, 64},
+    {361269, 2, 8, 99},
+    {361270, 2, 8, 116},
+    {361271, 2, 8, 127},
+    {361272, 2, 8, 174},
+    {361273, 2, 8, 223},
+    {361274, 2, 8, 232},
+    {361275, 2, 8, 315},
+    {361276, 2, 8, 370},
+    {361277, 2, 8, 403},
+    {361278, 2, 8, 404},
+    {361279, 2, 8, 405},
+    {361280, 2, 8, 415},
+    {361281, 2, 8, 416},
+    {361282, 2, 8, 431},
+    {361283, 2, 8, -1},
+    {361284, 2, 9, 9},
+    {361285, 2, 9, 10},
+    {361286, 2, 9, 12},
+    {361287, 2, 9, 33},
+    {361288, 2, 9, 43},
+    {361289, 2, 9, 47},
+    {361290, 2, 9, 54},
+    {361291, 2, 9, 70},
+    {361292, 2, 9, 96},
+    {361293, 2, 9, 109},
+    {361294, 2, 9, 119},
+    {361295, 2, 9, 122},
+    {361296, 2, 9, 142},
+    {361297, 2, 9, 145},
+    {361298, 2, 9, -1},
+    {361299, 3, 1, 70},
+    {361300, 3, 1, 76},
+    {361301, 3, 1, 108},
+    {361302, 3, 1, 109},
+    {361303, 3, 1, 112},
+    {361304, 3, 1, 194},
+    {361305, 3, 1, 199},
+    {361306, 3, 1, 215},
+    {361307, 3, 1, -1},
+    {361308, 3, 2, 4},
+    {361309, 3, 2, 5},
+    {361310, 3, 2, 12},
+    {361311, 3, 2, 28},
+    {361312, 3, 2, 45},
+    {361313, 3, 2, 83},
+    {361314, 3, 2, 118},
+    {361315, 3, 2, 119},
+    {361316, 3, 2, -1},
+    {361317, 3, 3, 136},
+    {361318, 3, 3, 222},
+    {361319, 3, 3, 223},
+    {361320, 3, 3, 224},
+    {361321, 3, 3, 249},
+    {361322, 3, 3, 264},
+    {361323, 3, 3, 266},
+    {361324, 3, 3, 277},
+    {361325, 3, 3, 301},
+    {361326, 3, 3, 307},
+    {361327, 3, 3, 342},
+    {361328, 3, 3, -1},
+    {361329, 3, 4, 5},
+    {361330, 3, 4, 6},
+    {361331, 3, 4, 12},
+    {361332, 3, 4, 22},
+    {361333, 3, 4, 23},
+    {361334, 3, 4, 31},
+    {361335, 3, 4, 79},
+    {361336, 3, 4, 155},
+    {361337, 3, 4, 169},
+    {361338, 3, 4, 261},
+    {361339, 3, 4, 295},
+    {361340, 3, 4, 353},
+    {361341, 3, 4, 355},
+    {361342, 3, 4, 362},
+    {361343, 3, 4, -1},
+    {361344, 3, 5, 6},
+    {361345, 3, 5, 7},
+    {361346, 3, 5, 23},
+    {361347, 3, 5, 34},
+    {361348, 3, 5, 103},
+    {361349, 3, 5, 104},
+    {361350, 3, 5, 106},
+    {361351, 3, 5, 150},
+    {361352, 3, 5, 169},
+    {361353, 3, 5, 186},
+    {361354, 3, 5, 236},
+    {361355, 3, 5, -1},
+    {361356, 3, 6, 20},
+    {361357, 3, 6, 21},
+    {361358, 3, 6, 49},
+    {361359, 3, 6, 95},
+    {361360, 3, 6, 107},
+    {361361, 3, 6, 154},
+    {361362, 3, 6, 155},
+    {361363, 3, 6, 159},
+    {361364, 3, 6, 170},
+    {361365, 3, 6, 182},
+    {361366, 3, 6, 229},
+    {361367, 3, 6, 254},
+    {361368, 3, 6, -1},
+    {361369, 3, 7, 4},
+    {361370, 3, 7, 51},
+    {361371, 3, 7, 58},
+    {361372, 3, 7, 60},
+    {361373, 3, 7, 86},
+    {361374, 3, 7, 105},
+    {361375, 3, 7, 107},
+    {361376, 3, 7, 122},
+    {361377, 3, 7, 236},
+    {361378, 3, 7, 239},
+    {361379, 3, 7, 251},
+    {361380, 3, 7, 279},
+    {361381, 3, 7, 285},
+    {361382, 3, 7, 286},
+    {361383, 3, 7, 287},
+    {361384, 3, 7, 310},
+    {361385, 3, 7, 364},
+    {361386, 3, 7, 365},
+    {361387, 3, 7, 382},
+    {361388, 3, 7, 392},
+    {361389, 3, 7, 393},
+    {361390, 3, 7, 394},
+    {361391, 3, 7, 414},
+    {361392, 3, 7, 424},
+    {361393, 3, 7, 425},
+    {361394, 3, 7, 426},
+    {361395, 3, 7, 454},
+    {361396, 3, 7, 455},
+    {361397, 3, 7, 460},
+    {361398, 3, 7, 470},
+    {361399, 3, 7, -1},
+    {361400, 3, 8, 19},
+    {361401, 3, 8, 66},
+    {361402, 3, 8, 76},
+    {361403, 3, 8, 87},
+    {361404, 3, 8, 95},
+    {361405, 3, 8, 96},
+    {361406, 3, 8, 124},
+    {361407, 3, 8, 155},
+    {361408, 3, 8, 156},
+    {361409, 3, 8, 157},
+    {361410, 3, 8, 158},
+    {361411, 3, 8, 159},
+    {361412, 3, 8, 163},
+    {361413, 3, 8, 179},
+    {361414, 3, 8, 180},
+    {361415, 3, 8, 181},
+    {361416, 3, 8, 183},
+    {361417, 3, 8, 185},
+    {361418, 3, 8, 186},
+    {361419, 3, 8, 195},
+    {361420, 3, 8, 214},
+    {361421, 3, 8, 216},
+    {361422, 3, 8, -1},
+    {361423, 3, 9, 85},
+    {361424, 3, 9, 124},
+    {361425, 3, 9, 179},
+    {361426, 3, 9, 195},
+    {361427, 3, 9, 216},
+    {361428, 3, 9, 224},
+    {361429, 3, 9, 235},
+    {361430, 3, 9, 237},
+    {361431, 3, 9, 241},
+    {361432, 3, 9, 263},
+    {361433, 3, 9, -1},
+    {361434, 3, 10, 25},
+    {361435, 3, 10, 26},
+    {361436, 3, 10, 28},
+    {361437, 3, 10, 29},
+    {361438, 3, 10, 30},
+    {361439, 3, 10, 31},
+    {361440, 3, 10, 32},
+    {361441, 3, 10, 40},
+    {361442, 3, 10, 41},
+    {361443, 3, 10, 42},
+    {361444, 3, 10, 43},
+    {361445, 3, 10, 44},
+    {361446, 3, 10, 45},
+    {361447, 3, 10, 46},
+    {361448, 3, 10, 47},
+    {361449, 3, 10, 64},
+    {361450, 3, 10, 85},
+    {361451, 3, 10, 94},
+    {361452, 3, 10, -1},
+    {361453, 4, 1, 110},
+    {361454, 4, 1, 139},
+    {361455, 4, 1, 263},
+    {361456, 4, 1, 278},
+    {361457, 4, 1, 305},
+    {361458, 4, 1, 308},
+    {361459, 4, 1, 309},
+    {361460, 4, 1, 310},
+    {361461, 4, 1, 311},
+    {361462, 4, 1, 312},
+    {361463, 4, 1, 313},
+    {361464, 4, 1, 314},
+    {361465, 4, 1, 315},
+    {361466, 4, 1, 316},
+    {361467, 4, 1, -1},
+    {361468, 4, 2, 33},
+    {361469, 4, 2, 57},
+    {361470, 4, 2, 70},
+    {361471, 4, 2, 74},
+    {361472, 4, 2, 75},
+    {361473, 4, 2, 78},
+    {361474, 4, 2, 79},
+    {361475, 4, 2, 80},
+    {361476, 4, 2, 81},
+    {361477, 4, 2, 82},
+    {361478, 4, 2, -1},
 };
 
 
-std::vector<std::vector<ap_level_info_t>> ap_doom2_level_infos = 
+// Map item id. Sorted by item id
+constexpr ap_item_t ap_doom2_item_table[] = {
+    {360000, 2001, -1, -1},
+    {360001, 2003, -1, -1},
+    {360002, 2004, -1, -1},
+    {360003, 2005, -1, -1},
+    {360004, 2002, -1, -1},
+    {360005, 2006, -1, -1},
+    {360006, 82, -1, -1},
+    {360007, 8, -1, -1},
+    {360008, 2018, -1, -1},
+    {360009, 2019, -1, -1},
+    {360010, 2023, -1, -1},
+    {360011, 2022, -1, -1},
+    {360012, 2024, -1, -1},
+    {360013, 2013, -1, -1},
+    {360014, 83, -1, -1},
+    {360015, 2012, -1, -1},
+    {360016, 2048, -1, -1},
+    {360017, 2046, -1, -1},
+    {360018, 2049, -1, -1},
+    {360019, 17, -1, -1},
+    {360200, 13, 1, 2},
+    {360201, 5, 1, 2},
+    {360202, 5, 1, 3},
+    {360203, 13, 1, 3},
+    {360204, 5, 1, 4},
+    {360205, 13, 1, 4},
+    {360206, 6, 1, 4},
+    {360207, 5, 1, 5},
+    {360208, 13, 1, 5},
+    {360209, 6, 1, 5},
+    {360210, 13, 1, 6},
+    {360211, 6, 1, 6},
+    {360212, 5, 1, 6},
+    {360213, 39, 1, 8},
+    {360214, 38, 1, 8},
+    {360215, 5, 1, 9},
+    {360216, 6, 1, 9},
+    {360217, 5, 1, 10},
+    {360218, 6, 1, 10},
+    {360219, 13, 1, 11},
+    {360220, 5, 1, 11},
+    {360221, 5, 2, 1},
+    {360222, 6, 2, 1},
+    {360223, 5, 2, 2},
+    {360224, 6, 2, 2},
+    {360225, 13, 2, 2},
+    {360226, 38, 2, 3},
+    {360227, 40, 2, 3},
+    {360228, 6, 2, 4},
+    {360229, 13, 2, 4},
+    {360230, 5, 2, 4},
+    {360231, 40, 2, 5},
+    {360232, 38, 2, 5},
+    {360233, 13, 2, 6},
+    {360234, 5, 2, 6},
+    {360235, 39, 2, 6},
+    {360236, 39, 2, 7},
+    {360237, 40, 2, 7},
+    {360238, 40, 2, 8},
+    {360239, 38, 2, 8},
+    {360240, 39, 2, 8},
+    {360241, 39, 3, 1},
+    {360242, 40, 3, 1},
+    {360243, 38, 3, 1},
+    {360244, 40, 3, 2},
+    {360245, 38, 3, 2},
+    {360246, 39, 3, 3},
+    {360247, 5, 3, 4},
+    {360248, 13, 3, 4},
+    {360249, 40, 3, 5},
+    {360250, 5, 3, 6},
+    {360251, 13, 3, 6},
+    {360252, 6, 3, 6},
+    {360253, 39, 3, 7},
+    {360254, 38, 3, 7},
+    {360255, 40, 3, 7},
+    {360256, 39, 3, 8},
+    {360257, 38, 3, 8},
+    {360400, -1, 1, 1},
+    {360401, -2, 1, 1},
+    {360402, 2026, 1, 1},
+    {360403, -1, 1, 2},
+    {360404, -2, 1, 2},
+    {360405, 2026, 1, 2},
+    {360406, -1, 1, 3},
+    {360407, -2, 1, 3},
+    {360408, 2026, 1, 3},
+    {360409, -1, 1, 4},
+    {360410, -2, 1, 4},
+    {360411, 2026, 1, 4},
+    {360412, -1, 1, 5},
+    {360413, -2, 1, 5},
+    {360414, 2026, 1, 5},
+    {360415, -1, 1, 6},
+    {360416, -2, 1, 6},
+    {360417, 2026, 1, 6},
+    {360418, -1, 1, 7},
+    {360419, -2, 1, 7},
+    {360420, 2026, 1, 7},
+    {360421, -1, 1, 8},
+    {360422, -2, 1, 8},
+    {360423, 2026, 1, 8},
+    {360424, -1, 1, 9},
+    {360425, -2, 1, 9},
+    {360426, 2026, 1, 9},
+    {360427, -1, 1, 10},
+    {360428, -2, 1, 10},
+    {360429, 2026, 1, 10},
+    {360430, -1, 1, 11},
+    {360431, -2, 1, 11},
+    {360432, 2026, 1, 11},
+    {360433, -1, 2, 1},
+    {360434, -2, 2, 1},
+    {360435, 2026, 2, 1},
+    {360436, -1, 2, 2},
+    {360437, -2, 2, 2},
+    {360438, 2026, 2, 2},
+    {360439, -1, 2, 3},
+    {360440, -2, 2, 3},
+    {360441, 2026, 2, 3},
+    {360442, -1, 2, 4},
+    {360443, -2, 2, 4},
+    {360444, 2026, 2, 4},
+    {360445, -1, 2, 5},
+    {360446, -2, 2, 5},
+    {360447, 2026, 2, 5},
+    {360448, -1, 2, 6},
+    {360449, -2, 2, 6},
+    {360450, 2026, 2, 6},
+    {360451, -1, 2, 7},
+    {360452, -2, 2, 7},
+    {360453, 2026, 2, 7},
+    {360454, -1, 2, 8},
+    {360455, -2, 2, 8},
+    {360456, 2026, 2, 8},
+    {360457, -1, 2, 9},
+    {360458, -2, 2, 9},
+    {360459, 2026, 2, 9},
+    {360460, -1, 3, 1},
+    {360461, -2, 3, 1},
+    {360462, 2026, 3, 1},
+    {360463, -1, 3, 2},
+    {360464, -2, 3, 2},
+    {360465, 2026, 3, 2},
+    {360466, -1, 3, 3},
+    {360467, -2, 3, 3},
+    {360468, 2026, 3, 3},
+    {360469, -1, 3, 4},
+    {360470, -2, 3, 4},
+    {360471, 2026, 3, 4},
+    {360472, -1, 3, 5},
+    {360473, -2, 3, 5},
+    {360474, 2026, 3, 5},
+    {360475, -1, 3, 6},
+    {360476, -2, 3, 6},
+    {360477, 2026, 3, 6},
+    {360478, -1, 3, 7},
+    {360479, -2, 3, 7},
+    {360480, 2026, 3, 7},
+    {360481, -1, 3, 8},
+    {360482, -2, 3, 8},
+    {360483, 2026, 3, 8},
+    {360484, -1, 3, 9},
+    {360485, -2, 3, 9},
+    {360486, 2026, 3, 9},
+    {360487, -1, 3, 10},
+    {360488, -2, 3, 10},
+    {360489, 2026, 3, 10},
+    {360490, -1, 4, 1},
+    {360491, -2, 4, 1},
+    {360492, 2026, 4, 1},
+    {360493, -1, 4, 2},
+    {360494, -2, 4, 2},
+    {360495, 2026, 4, 2},
+    {360600, 65001, -1, -1},
+    {360601, 65002, -1, -1},
+    {360602, 65003, -1, -1},
+    {360603, 65004, -1, -1},
+};
+
+
+static const ap_thing_info_t ap_doom2_thing_infos_e1m1[] = 
+{
+    {1, 0, 0, 1},
+    {2, 1, 0, 1},
+    {3, 2, 0, 1},
+    {4, 3, 0, 1},
+    {3001, 4, 0, 1},
+    {3001, 5, 0, 1},
+    {3004, 6, 0, 1},
+    {3004, 7, 0, 1},
+    {2007, 8, 0, 1},
+    {2015, 9, 0, 1},
+    {2011, 10, 0, 1},
+    {3004, 11, 0, 1},
+    {3004, 12, 0, 1},
+    {3004, 13, 0, 1},
+    {3004, 14, 0, 1},
+    {2011, 15, 0, 1},
+    {2011, 16, 0, 1},
+    {2018, 17, 0, 0},
+    {3004, 18, 0, 1},
+    {3004, 19, 0, 1},
+    {3004, 20, 0, 1},
+    {3004, 21, 0, 1},
+    {3004, 22, 0, 1},
+    {2014, 23, 0, 1},
+    {2014, 24, 0, 1},
+    {2014, 25, 0, 1},
+    {2014, 26, 0, 1},
+    {2014, 27, 0, 1},
+    {2014, 28, 0, 1},
+    {2014, 29, 0, 1},
+    {2014, 30, 0, 1},
+    {3001, 31, 0, 1},
+    {3001, 32, 0, 1},
+    {3001, 33, 0, 1},
+    {3004, 34, 0, 1},
+    {2011, 35, 0, 1},
+    {2011, 36, 0, 1},
+    {2001, 37, 0, 0},
+    {2008, 38, 0, 1},
+    {3001, 39, 0, 1},
+    {3001, 40, 0, 1},
+    {3001, 41, 0, 1},
+    {2012, 42, 0, 1},
+    {2012, 43, 0, 1},
+    {2012, 44, 0, 1},
+    {2007, 45, 0, 1},
+    {3001, 46, 0, 1},
+    {3001, 47, 0, 1},
+    {3001, 48, 0, 1},
+    {3001, 49, 0, 1},
+    {3001, 50, 0, 1},
+    {3001, 51, 0, 1},
+    {2003, 52, 0, 0},
+    {3001, 53, 0, 1},
+    {3001, 54, 0, 1},
+    {82, 55, 0, 1},
+    {2004, 56, 0, 1},
+    {2006, 57, 0, 1},
+    {2002, 58, 0, 1},
+    {11, 59, 0, 1},
+    {11, 60, 0, 1},
+    {11, 61, 0, 1},
+    {11, 62, 0, 1},
+    {3001, 63, 0, 1},
+    {2046, 64, 0, 1},
+    {2003, 65, 0, 1},
+    {2006, 66, 0, 1},
+    {82, 67, 0, 1},
+    {2005, 68, 0, 0},
+};
+
+
+static const ap_thing_info_t ap_doom2_thing_infos_e1m2[] = 
+{
+    {1, 0, 0, 1},
+    {2, 1, 0, 1},
+    {3, 2, 0, 1},
+    {4, 3, 0, 1},
+    {3004, 4, 0, 1},
+    {3004, 5, 0, 1},
+    {3004, 6, 0, 1},
+    {3004, 7, 0, 1},
+    {9, 8, 0, 1},
+    {9, 9, 0, 1},
+    {3004, 10, 0, 1},
+    {3004, 11, 0, 1},
+    {3004, 12, 0, 1},
+    {9, 13, 0, 1},
+    {9, 14, 0, 1},
+    {9, 15, 0, 1},
+    {9, 16, 0, 1},
+    {9, 17, 0, 1},
+    {9, 18, 0, 1},
+    {9, 19, 0, 1},
+    {9, 20, 0, 1},
+    {3002, 21, 0, 1},
+    {9, 22, 0, 1},
+    {9, 23, 0, 1},
+    {9, 24, 0, 1},
+    {3001, 25, 0, 1},
+    {3001, 26, 0, 1},
+    {3001, 27, 0, 1},
+    {3001, 28, 0, 1},
+    {3001, 29, 0, 1},
+    {3001, 30, 0, 1},
+    {13, 31, 0, 0},
+    {9, 32, 0, 1},
+    {9, 33, 0, 1},
+    {9, 34, 0, 1},
+    {9, 35, 0, 1},
+    {2012, 36, 0, 1},
+    {2012, 37, 0, 1},
+    {2012, 38, 0, 1},
+    {2012, 39, 0, 1},
+    {2012, 40, 0, 1},
+    {9, 41, 0, 1},
+    {9, 42, 0, 1},
+    {3004, 43, 0, 1},
+    {5, 44, 0, 0},
+    {14, 45, 0, 1},
+    {3001, 46, 0, 1},
+    {3001, 47, 0, 1},
+    {3002, 48, 0, 1},
+    {9, 49, 0, 1},
+    {9, 50, 0, 1},
+    {9, 51, 0, 1},
+    {9, 52, 0, 1},
+    {9, 53, 0, 1},
+    {9, 54, 0, 1},
+    {9, 55, 0, 1},
+    {9, 56, 0, 1},
+    {9, 57, 0, 1},
+    {9, 58, 0, 1},
+    {3001, 59, 0, 1},
+    {3001, 60, 0, 1},
+    {3001, 61, 0, 1},
+    {3001, 62, 0, 1},
+    {3001, 63, 0, 1},
+    {3001, 64, 0, 1},
+    {3001, 65, 0, 1},
+    {3001, 66, 0, 1},
+    {2035, 67, 0, 1},
+    {2035, 68, 0, 1},
+    {2035, 69, 0, 1},
+    {2035, 70, 0, 1},
+    {2035, 71, 0, 1},
+    {2035, 72, 0, 1},
+    {2035, 73, 0, 1},
+    {2035, 74, 0, 1},
+    {2035, 75, 0, 1},
+    {2035, 76, 0, 1},
+    {2035, 77, 0, 1},
+    {2035, 78, 0, 1},
+    {2035, 79, 0, 1},
+    {2035, 80, 0, 1},
+    {2035, 81, 0, 1},
+    {2035, 82, 0, 1},
+    {2035, 83, 0, 1},
+    {2035, 84, 0, 1},
+    {9, 85, 0, 1},
+    {9, 86, 0, 1},
+    {9, 87, 0, 1},
+    {9, 88, 0, 1},
+    {9, 89, 0, 1},
+    {9, 90, 0, 1},
+    {9, 91, 0, 1},
+    {3004, 92, 0, 1},
+    {3004, 93, 0, 1},
+    {3004, 94, 0, 1},
+    {3004, 95, 0, 1},
+    {3004, 96, 0, 1},
+    {9, 97, 0, 1},
+    {9, 98, 0, 1},
+    {9, 99, 0, 1},
+    {9, 100, 0, 1},
+    {2011, 101, 0, 1},
+    {2011, 102, 0, 1},
+    {2011, 103, 0, 1},
+    {2011, 104, 0, 1},
+    {2011, 105, 0, 1},
+    {11, 106, 0, 1},
+    {11, 107, 0, 1},
+    {11, 108, 0, 1},
+    {11, 109, 0, 1},
+    {11, 110, 0, 1},
+    {2003, 111, 0, 1},
+    {2002, 112, 0, 1},
+    {2001, 113, 0, 1},
+    {2049, 114, 0, 1},
+    {2013, 115, 0, 1},
+    {2019, 116, 0, 0},
+    {2004, 117, 0, 1},
+    {2046, 118, 0, 1},
+    {17, 119, 0, 1},
+    {2010, 120, 0, 1},
+    {2010, 121, 0, 1},
+    {2010, 122, 0, 1},
+    {2010, 123, 0, 1},
+    {9, 124, 0, 1},
+    {3004, 125, 0, 1},
+    {11, 126, 0, 1},
+    {82, 127, 0, 0},
+    {3004, 128, 0, 1},
+    {3004, 129, 0, 1},
+    {3004, 130, 0, 1},
+    {3004, 131, 0, 1},
+    {3004, 132, 0, 1},
+    {3004, 133, 0, 1},
+    {3004, 134, 0, 1},
+    {3004, 135, 0, 1},
+    {9, 136, 0, 1},
+    {9, 137, 0, 1},
+    {9, 138, 0, 1},
+    {2011, 139, 0, 1},
+    {2011, 140, 0, 1},
+    {2011, 141, 0, 1},
+    {2011, 142, 0, 1},
+    {2011, 143, 0, 1},
+    {2011, 144, 0, 1},
+    {9, 145, 0, 1},
+    {9, 146, 0, 1},
+    {2008, 147, 0, 1},
+    {9, 148, 0, 1},
+    {9, 149, 0, 1},
+    {9, 150, 0, 1},
+    {9, 151, 0, 1},
+    {9, 152, 0, 1},
+    {2014, 153, 0, 1},
+    {2014, 154, 0, 1},
+    {2014, 155, 0, 1},
+    {2014, 156, 0, 1},
+    {2014, 157, 0, 1},
+    {2014, 158, 0, 1},
+    {2015, 159, 0, 1},
+    {2015, 160, 0, 1},
+    {2015, 161, 0, 1},
+    {2015, 162, 0, 1},
+    {2015, 163, 0, 1},
+    {2015, 164, 0, 1},
+    {2015, 165, 0, 1},
+    {2014, 166, 0, 1},
+    {2014, 167, 0, 1},
+    {2014, 168, 0, 1},
+    {2014, 169, 0, 1},
+    {2014, 170, 0, 1},
+    {2014, 171, 0, 1},
+    {2014, 172, 0, 1},
+};
+
+
+static const ap_thing_info_t ap_doom2_thing_infos_e1m3[] = 
+{
+    {1, 0, 0, 1},
+    {45, 1, 0, 1},
+    {45, 2, 0, 1},
+    {44, 3, 0, 1},
+    {44, 4, 0, 1},
+    {2019, 5, 0, 0},
+    {2001, 6, 0, 0},
+    {2049, 7, 0, 1},
+    {2, 8, 0, 1},
+    {3, 9, 0, 1},
+    {4, 10, 0, 1},
+    {11, 11, 0, 1},
+    {3001, 12, 0, 1},
+    {3001, 13, 0, 1},
+    {3001, 14, 0, 1},
+    {3001, 15, 0, 1},
+    {9, 16, 0, 1},
+    {3004, 17, 0, 1},
+    {3004, 18, 0, 1},
+    {3004, 19, 0, 1},
+    {3004, 20, 0, 1},
+    {3004, 21, 0, 1},
+    {3004, 22, 0, 1},
+    {3004, 23, 0, 1},
+    {3004, 24, 0, 1},
+    {9, 25, 0, 1},
+    {9, 26, 0, 1},
+    {9, 27, 0, 1},
+    {3001, 28, 0, 1},
+    {3001, 29, 0, 1},
+    {3001, 30, 0, 1},
+    {3001, 31, 0, 1},
+    {3001, 32, 0, 1},
+    {3001, 33, 0, 1},
+    {3001, 34, 0, 1},
+    {3001, 35, 0, 1},
+    {3001, 36, 0, 1},
+    {3001, 37, 0, 1},
+    {65, 38, 0, 1},
+    {65, 39, 0, 1},
+    {65, 40, 0, 1},
+    {65, 41, 0, 1},
+    {58, 42, 0, 1},
+    {58, 43, 0, 1},
+    {65, 44, 0, 1},
+    {65, 45, 0, 1},
+    {58, 46, 0, 1},
+    {58, 47, 0, 1},
+    {9, 48, 0, 1},
+    {9, 49, 0, 1},
+    {3004, 50, 0, 1},
+    {3004, 51, 0, 1},
+    {9, 52, 0, 1},
+    {9, 53, 0, 1},
+    {65, 54, 0, 1},
+    {65, 55, 0, 1},
+    {9, 56, 0, 1},
+    {9, 57, 0, 1},
+    {9, 58, 0, 1},
+    {3004, 59, 0, 1},
+    {3004, 60, 0, 1},
+    {3004, 61, 0, 1},
+    {3004, 62, 0, 1},
+    {9, 63, 0, 1},
+    {9, 64, 0, 1},
+    {2012, 65, 0, 1},
+    {9, 66, 0, 1},
+    {9, 67, 0, 1},
+    {9, 68, 0, 1},
+    {9, 69, 0, 1},
+    {9, 70, 0, 1},
+    {3004, 71, 0, 1},
+    {2012, 72, 0, 1},
+    {79, 73, 0, 1},
+    {79, 74, 0, 1},
+    {79, 75, 0, 1},
+    {80, 76, 0, 1},
+    {80, 77, 0, 1},
+    {80, 78, 0, 1},
+    {2012, 79, 0, 1},
+    {2012, 80, 0, 1},
+    {2012, 81, 0, 1},
+    {2004, 82, 0, 1},
+    {9, 83, 0, 1},
+    {9, 84, 0, 1},
+    {5, 85, 0, 0},
+    {2003, 86, 0, 0},
+    {17, 87, 0, 1},
+    {11, 88, 0, 1},
+    {11, 89, 0, 1},
+    {11, 90, 0, 1},
+    {14, 91, 0, 1},
+    {65, 92, 0, 1},
+    {2006, 93, 0, 1},
+    {17, 94, 0, 1},
+    {17, 95, 0, 1},
+    {2024, 96, 0, 0},
+    {2013, 97, 0, 0},
+    {2019, 98, 0, 0},
+    {14, 99, 0, 1},
+    {14, 100, 0, 1},
+    {2012, 101, 0, 1},
+    {2012, 102, 0, 1},
+    {3002, 103, 0, 1},
+    {13, 104, 0, 0},
+    {17, 105, 0, 1},
+    {2048, 106, 0, 1},
+    {3002, 107, 0, 1},
+    {3002, 108, 0, 1},
+    {3002, 109, 0, 1},
+    {58, 110, 0, 1},
+    {58, 111, 0, 1},
+    {3001, 112, 0, 1},
+    {3001, 113, 0, 1},
+    {3001, 114, 0, 1},
+    {3001, 115, 0, 1},
+    {3001, 116, 0, 1},
+    {3001, 117, 0, 1},
+    {3001, 118, 0, 1},
+    {3001, 119, 0, 1},
+    {14, 120, 0, 1},
+    {3002, 121, 0, 1},
+    {2002, 122, 0, 0},
+    {2008, 123, 0, 1},
+    {2008, 124, 0, 1},
+    {2048, 125, 0, 1},
+    {2046, 126, 0, 1},
+    {2010, 127, 0, 1},
+    {2010, 128, 0, 1},
+    {2010, 129, 0, 1},
+    {2010, 130, 0, 1},
+    {2010, 131, 0, 1},
+    {2010, 132, 0, 1},
+    {82, 133, 0, 1},
+    {2013, 134, 0, 1},
+    {2015, 135, 0, 1},
+    {2015, 136, 0, 1},
+    {2015, 137, 0, 1},
+    {2015, 138, 0, 1},
+    {2015, 139, 0, 1},
+    {2015, 140, 0, 1},
+    {2015, 141, 0, 1},
+    {3002, 142, 0, 1},
+    {3002, 143, 0, 1},
+    {3002, 144, 0, 1},
+    {82, 145, 0, 1},
+    {8, 146, 0, 0},
+    {14, 147, 0, 1},
+};
+
+
+static const ap_thing_info_t ap_doom2_thing_infos_e1m4[] = 
+{
+    {1, 0, 0, 1},
+    {2, 1, 0, 1},
+    {3, 2, 0, 1},
+    {4, 3, 0, 1},
+    {82, 4, 0, 0},
+    {2049, 5, 0, 1},
+    {2035, 6, 0, 1},
+    {2035, 7, 0, 1},
+    {2035, 8, 0, 1},
+    {2035, 9, 0, 1},
+    {9, 10, 0, 1},
+    {9, 11, 0, 1},
+    {9, 12, 0, 1},
+    {9, 13, 0, 1},
+    {9, 14, 0, 1},
+    {9, 15, 0, 1},
+    {9, 16, 0, 1},
+    {9, 17, 0, 1},
+    {9, 18, 0, 1},
+    {9, 19, 0, 1},
+    {9, 20, 0, 1},
+    {5, 21, 0, 0},
+    {3001, 22, 0, 1},
+    {3001, 23, 0, 1},
+    {3001, 24, 0, 1},
+    {11, 25, 0, 1},
+    {11, 26, 0, 1},
+    {11, 27, 0, 1},
+    {11, 28, 0, 1},
+    {2003, 29, 0, 1},
+    {2001, 30, 0, 1},
+    {2013, 31, 0, 1},
+    {13, 32, 0, 0},
+    {2006, 33, 0, 1},
+    {2019, 34, 0, 1},
+    {11, 35, 0, 1},
+    {3001, 36, 0, 1},
+    {3001, 37, 0, 1},
+    {3001, 38, 0, 1},
+    {3001, 39, 0, 1},
+    {3001, 40, 0, 1},
+    {3001, 41, 0, 1},
+    {14, 42, 0, 1},
+    {86, 43, 0, 1},
+    {86, 44, 0, 1},
+    {9, 45, 0, 1},
+    {65, 46, 0, 1},
+    {65, 47, 0, 1},
+    {65, 48, 0, 1},
+    {65, 49, 0, 1},
+    {9, 50, 0, 1},
+    {9, 51, 0, 1},
+    {9, 52, 0, 1},
+    {9, 53, 0, 1},
+    {58, 54, 0, 1},
+    {58, 55, 0, 1},
+    {65, 56, 0, 1},
+    {14, 57, 0, 1},
+    {14, 58, 0, 1},
+    {6, 59, 0, 0},
+    {14, 60, 0, 1},
+    {9, 61, 0, 1},
+    {9, 62, 0, 1},
+    {9, 63, 0, 1},
+    {58, 64, 0, 1},
+    {3002, 65, 0, 1},
+    {3001, 66, 0, 1},
+    {3001, 67, 0, 1},
+    {3001, 68, 0, 1},
+    {3001, 69, 0, 1},
+    {3001, 70, 0, 1},
+    {3001, 71, 0, 1},
+    {3001, 72, 0, 1},
+    {3001, 73, 0, 1},
+    {3004, 74, 0, 1},
+    {3004, 75, 0, 1},
+    {3004, 76, 0, 1},
+    {3004, 77, 0, 1},
+    {65, 78, 0, 1},
+    {3004, 79, 0, 1},
+    {3004, 80, 0, 1},
+    {65, 81, 0, 1},
+    {65, 82, 0, 1},
+    {65, 83, 0, 1},
+    {65, 84, 0, 1},
+    {2012, 85, 0, 1},
+    {2012, 86, 0, 1},
+    {2011, 87, 0, 1},
+    {2011, 88, 0, 1},
+    {2011, 89, 0, 1},
+    {2011, 90, 0, 1},
+    {2011, 91, 0, 1},
+    {2011, 92, 0, 1},
+    {2011, 93, 0, 1},
+    {2011, 94, 0, 1},
+    {2015, 95, 0, 1},
+    {2015, 96, 0, 1},
+    {2015, 97, 0, 1},
+    {2015, 98, 0, 1},
+    {2015, 99, 0, 1},
+    {2015, 100, 0, 1},
+    {2015, 101, 0, 1},
+    {2014, 102, 0, 1},
+    {2014, 103, 0, 1},
+    {2014, 104, 0, 1},
+    {2014, 105, 0, 1},
+    {2014, 106, 0, 1},
+    {2014, 107, 0, 1},
+    {2014, 108, 0, 1},
+    {2014, 109, 0, 1},
+    {2014, 110, 0, 1},
+    {2014, 111, 0, 1},
+    {2014, 112, 0, 1},
+    {2015, 113, 0, 1},
+    {2015, 114, 0, 1},
+    {2015, 115, 0, 1},
+    {2015, 116, 0, 1},
+    {2015, 117, 0, 1},
+    {2015, 118, 0, 1},
+    {2015, 119, 0, 1},
+    {2015, 120, 0, 1},
+    {2015, 121, 0, 1},
+    {2015, 122, 0, 1},
+    {2015, 123, 0, 1},
+    {2015, 124, 0, 1},
+    {2015, 125, 0, 1},
+    {2015, 126, 0, 1},
+    {2015, 127, 0, 1},
+    {2015, 128, 0, 1},
+    {3001, 129, 0, 1},
+    {3001, 130, 0, 1},
+    {3001, 131, 0, 1},
+    {3002, 132, 0, 1},
+    {2008, 133, 0, 1},
+    {2008, 134, 0, 1},
+    {2008, 135, 0, 1},
+    {86, 136, 0, 1},
+    {86, 137, 0, 1},
+};
+
+
+static const ap_thing_info_t ap_doom2_thing_infos_e1m5[] = 
+{
+    {1, 0, 0, 1},
+    {2, 1, 0, 1},
+    {3, 2, 0, 1},
+    {4, 3, 0, 1},
+    {3001, 4, 0, 1},
+    {3001, 5, 0, 1},
+    {3001, 6, 0, 1},
+    {3001, 7, 0, 1},
+    {3001, 8, 0, 1},
+    {3001, 9, 0, 1},
+    {3001, 10, 0, 1},
+    {3001, 11, 0, 1},
+    {3001, 12, 0, 1},
+    {3001, 13, 0, 1},
+    {3001, 14, 0, 1},
+    {3001, 15, 0, 1},
+    {3001, 16, 0, 1},
+    {3001, 17, 0, 1},
+    {3001, 18, 0, 1},
+    {3001, 19, 0, 1},
+    {3001, 20, 0, 1},
+    {3001, 21, 0, 1},
+    {3001, 22, 0, 1},
+    {3001, 23, 0, 1},
+    {3001, 24, 0, 1},
+    {3001, 25, 0, 1},
+    {79, 26, 0, 1},
+    {75, 27, 0, 1},
+    {80, 28, 0, 1},
+    {27, 29, 0, 1},
+    {27, 30, 0, 1},
+    {26, 31, 0, 1},
+    {46, 32, 0, 1},
+    {46, 33, 0, 1},
+    {46, 34, 0, 1},
+    {46, 35, 0, 1},
+    {46, 36, 0, 1},
+    {46, 37, 0, 1},
+    {45, 38, 0, 1},
+    {45, 39, 0, 1},
+    {11, 40, 0, 1},
+    {11, 41, 0, 1},
+    {11, 42, 0, 1},
+    {11, 43, 0, 1},
+    {11, 44, 0, 1},
+    {2003, 45, 0, 0},
+    {82, 46, 0, 0},
+    {2049, 47, 0, 1},
+    {24, 48, 0, 1},
+    {24, 49, 0, 1},
+    {5, 50, 0, 0},
+    {56, 51, 0, 1},
+    {56, 52, 0, 1},
+    {2004, 53, 0, 0},
+    {2046, 54, 0, 1},
+    {13, 55, 0, 0},
+    {2013, 56, 0, 0},
+    {2019, 57, 0, 0},
+    {2045, 58, 0, 1},
+    {58, 59, 0, 1},
+    {9, 60, 0, 1},
+    {65, 61, 0, 1},
+    {9, 62, 0, 1},
+    {3001, 63, 0, 1},
+    {3001, 64, 0, 1},
+    {3001, 65, 0, 1},
+    {3001, 66, 0, 1},
+    {3001, 67, 0, 1},
+    {3001, 68, 0, 1},
+    {3001, 69, 0, 1},
+    {3001, 70, 0, 1},
+    {3001, 71, 0, 1},
+    {2008, 72, 0, 1},
+    {2022, 73, 0, 1},
+    {2024, 74, 0, 1},
+    {2024, 75, 0, 1},
+    {2046, 76, 0, 1},
+    {2049, 77, 0, 1},
+    {6, 78, 0, 0},
+    {14, 79, 0, 1},
+    {2006, 80, 0, 1},
+    {2049, 81, 0, 1},
+    {2046, 82, 0, 1},
+    {17, 83, 0, 1},
+    {9, 84, 0, 1},
+    {9, 85, 0, 1},
+    {65, 86, 0, 1},
+    {65, 87, 0, 1},
+    {65, 88, 0, 1},
+    {65, 89, 0, 1},
+    {9, 90, 0, 1},
+    {9, 91, 0, 1},
+    {9, 92, 0, 1},
+    {9, 93, 0, 1},
+    {9, 94, 0, 1},
+    {3001, 95, 0, 1},
+    {3001, 96, 0, 1},
+    {65, 97, 0, 1},
+    {3004, 98, 0, 1},
+    {3004, 99, 0, 1},
+    {3004, 100, 0, 1},
+    {3004, 101, 0, 1},
+    {9, 102, 0, 1},
+    {9, 103, 0, 1},
+    {3006, 104, 0, 1},
+    {3006, 105, 0, 1},
+    {3006, 106, 0, 1},
+    {3006, 107, 0, 1},
+    {3006, 108, 0, 1},
+    {3006, 109, 0, 1},
+    {3001, 110, 0, 1},
+    {3001, 111, 0, 1},
+    {3001, 112, 0, 1},
+    {3004, 113, 0, 1},
+    {3004, 114, 0, 1},
+    {3004, 115, 0, 1},
+    {3004, 116, 0, 1},
+    {3004, 117, 0, 1},
+    {3004, 118, 0, 1},
+    {3004, 119, 0, 1},
+    {3004, 120, 0, 1},
+    {3004, 121, 0, 1},
+    {3004, 122, 0, 1},
+    {3004, 123, 0, 1},
+    {3004, 124, 0, 1},
+    {65, 125, 0, 1},
+    {65, 126, 0, 1},
+    {9, 127, 0, 1},
+    {9, 128, 0, 1},
+    {9, 129, 0, 1},
+    {3005, 130, 0, 1},
+    {3005, 131, 0, 1},
+    {3005, 132, 0, 1},
+    {3001, 133, 0, 1},
+    {3001, 134, 0, 1},
+    {3004, 135, 0, 1},
+    {3004, 136, 0, 1},
+    {3001, 137, 0, 1},
+    {3001, 138, 0, 1},
+    {3001, 139, 0, 1},
+    {3001, 140, 0, 1},
+    {58, 141, 0, 1},
+    {58, 142, 0, 1},
+    {9, 143, 0, 1},
+    {9, 144, 0, 1},
+    {3001, 145, 0, 1},
+    {3001, 146, 0, 1},
+    {3001, 147, 0, 1},
+    {3001, 148, 0, 1},
+    {3001, 149, 0, 1},
+    {3001, 150, 0, 1},
+    {2018, 151, 0, 0},
+    {2011, 152, 0, 1},
+    {2011, 153, 0, 1},
+    {2011, 154, 0, 1},
+    {2011, 155, 0, 1},
+    {2011, 156, 0, 1},
+    {9, 157, 0, 1},
+    {2011, 158, 0, 1},
+    {2011, 159, 0, 1},
+    {2011, 160, 0, 1},
+    {2048, 161, 0, 1},
+    {2008, 162, 0, 1},
+    {2008, 163, 0, 1},
+    {2011, 164, 0, 1},
+    {2011, 165, 0, 1},
+    {2011, 166, 0, 1},
+    {9, 167, 0, 1},
+    {9, 168, 0, 1},
+    {9, 169, 0, 1},
+    {2013, 170, 0, 0},
+    {9, 171, 0, 1},
+    {9, 172, 0, 1},
+    {9, 173, 0, 1},
+    {9, 174, 0, 1},
+    {9, 175, 0, 1},
+    {9, 176, 0, 1},
+    {9, 177, 0, 1},
+    {65, 178, 0, 1},
+    {65, 179, 0, 1},
+    {3001, 180, 0, 1},
+    {3001, 181, 0, 1},
+    {3001, 182, 0, 1},
+    {3001, 183, 0, 1},
+    {58, 184, 0, 1},
+    {58, 185, 0, 1},
+    {69, 186, 0, 1},
+    {2049, 187, 0, 1},
+    {2012, 188, 0, 1},
+    {2012, 189, 0, 1},
+    {2012, 190, 0, 1},
+    {2011, 191, 0, 1},
+    {2011, 192, 0, 1},
+    {2048, 193, 0, 1},
+    {65, 194, 0, 1},
+    {2008, 195, 0, 1},
+    {2008, 196, 0, 1},
+    {3001, 197, 0, 1},
+    {3001, 198, 0, 1},
+    {56, 199, 0, 1},
+    {56, 200, 0, 1},
+    {2011, 201, 0, 1},
+    {2001, 202, 0, 0},
+    {2001, 203, 0, 1},
+    {3002, 204, 0, 1},
+    {58, 205, 0, 1},
+    {58, 206, 0, 1},
+    {3002, 207, 0, 1},
+    {3002, 208, 0, 1},
+    {2008, 209, 0, 1},
+    {2008, 210, 0, 1},
+    {2008, 211, 0, 1},
+    {2008, 212, 0, 1},
+    {53, 213, 0, 1},
+    {78, 214, 0, 1},
+    {2023, 215, 0, 0},
+    {2012, 216, 0, 1},
+};
+
+
+static const ap_thing_info_t ap_doom2_thing_infos_e1m6[] = 
+{
+    {13, 0, 0, 0},
+    {6, 1, 0, 0},
+    {2002, 2, 0, 1},
+    {11, 3, 0, 1},
+    {11, 4, 0, 1},
+    {11, 5, 0, 1},
+    {3001, 6, 0, 1},
+    {3001, 7, 0, 1},
+    {3001, 8, 0, 1},
+    {9, 9, 0, 1},
+    {3001, 10, 0, 1},
+    {3001, 11, 0, 1},
+    {3001, 12, 0, 1},
+    {3001, 13, 0, 1},
+    {3001, 14, 0, 1},
+    {3001, 15, 0, 1},
+    {3001, 16, 0, 1},
+    {3001, 17, 0, 1},
+    {3001, 18, 0, 1},
+    {9, 19, 0, 1},
+    {9, 20, 0, 1},
+    {58, 21, 0, 1},
+    {2008, 22, 0, 1},
+    {3006, 23, 0, 1},
+    {58, 24, 0, 1},
+    {58, 25, 0, 1},
+    {2008, 26, 0, 1},
+    {2008, 27, 0, 1},
+    {69, 28, 0, 1},
+    {9, 29, 0, 1},
+    {9, 30, 0, 1},
+    {65, 31, 0, 1},
+    {2012, 32, 0, 1},
+    {2008, 33, 0, 1},
+    {3006, 34, 0, 1},
+    {3001, 35, 0, 1},
+    {5, 36, 0, 0},
+    {3001, 37, 0, 1},
+    {3001, 38, 0, 1},
+    {3001, 39, 0, 1},
+    {3001, 40, 0, 1},
+    {3001, 41, 0, 1},
+    {3001, 42, 0, 1},
+    {3001, 43, 0, 1},
+    {3001, 44, 0, 1},
+    {3001, 45, 0, 1},
+    {7, 46, 0, 1},
+    {3001, 47, 0, 1},
+    {3001, 48, 0, 1},
+    {3001, 49, 0, 1},
+    {3001, 50, 0, 1},
+    {3001, 51, 0, 1},
+    {3001, 52, 0, 1},
+    {3001, 53, 0, 1},
+    {2006, 54, 0, 1},
+    {2013, 55, 0, 0},
+    {2011, 56, 0, 1},
+    {2011, 57, 0, 1},
+    {2011, 58, 0, 1},
+    {2004, 59, 0, 0},
+    {2047, 60, 0, 1},
+    {2047, 61, 0, 1},
+    {2047, 62, 0, 1},
+    {2046, 63, 0, 1},
+    {2046, 64, 0, 1},
+    {14, 65, 0, 1},
+    {14, 66, 0, 1},
+    {2012, 67, 0, 1},
+    {2012, 68, 0, 1},
+    {2012, 69, 0, 1},
+    {69, 70, 0, 1},
+    {69, 71, 0, 1},
+    {69, 72, 0, 1},
+    {69, 73, 0, 1},
+    {5, 74, 0, 0},
+    {5, 75, 0, 0},
+    {2008, 76, 0, 1},
+    {2008, 77, 0, 1},
+    {2012, 78, 0, 1},
+    {2012, 79, 0, 1},
+    {58, 80, 0, 1},
+    {2049, 81, 0, 1},
+    {17, 82, 0, 1},
+    {1, 83, 0, 1},
+    {2, 84, 0, 1},
+    {3, 85, 0, 1},
+    {4, 86, 0, 1},
+    {3002, 87, 0, 1},
+    {3002, 88, 0, 1},
+    {3002, 89, 0, 1},
+    {3002, 90, 0, 1},
+    {85, 91, 0, 1},
+    {85, 92, 0, 1},
+    {85, 93, 0, 1},
+    {83, 94, 0, 0},
+    {85, 95, 0, 1},
+    {85, 96, 0, 1},
+    {85, 97, 0, 1},
+    {58, 98, 0, 1},
+    {58, 99, 0, 1},
+    {9, 100, 0, 1},
+    {9, 101, 0, 1},
+    {9, 102, 0, 1},
+    {65, 103, 0, 1},
+    {65, 104, 0, 1},
+    {65, 105, 0, 1},
+    {9, 106, 0, 1},
+    {9, 107, 0, 1},
+    {9, 108, 0, 1},
+    {9, 109, 0, 1},
+    {9, 110, 0, 1},
+    {9, 111, 0, 1},
+    {3001, 112, 0, 1},
+    {3001, 113, 0, 1},
+    {66, 114, 0, 1},
+    {2008, 115, 0, 1},
+    {2008, 116, 0, 1},
+    {2008, 117, 0, 1},
+    {2007, 118, 0, 1},
+    {2012, 119, 0, 1},
+    {2012, 120, 0, 1},
+    {2011, 121, 0, 1},
+    {2011, 122, 0, 1},
+    {2011, 123, 0, 1},
+    {2011, 124, 0, 1},
+    {2014, 125, 0, 1},
+    {2014, 126, 0, 1},
+    {2014, 127, 0, 1},
+    {2014, 128, 0, 1},
+    {2014, 129, 0, 1},
+    {2018, 130, 0, 0},
+    {86, 131, 0, 1},
+    {86, 132, 0, 1},
+    {2001, 133, 0, 1},
+    {82, 134, 0, 0},
+    {66, 135, 0, 1},
+    {65, 136, 0, 1},
+    {65, 137, 0, 1},
+    {9, 138, 0, 1},
+    {14, 139, 0, 1},
+    {14, 140, 0, 1},
+    {14, 141, 0, 1},
+    {14, 142, 0, 1},
+    {14, 143, 0, 1},
+    {14, 144, 0, 1},
+    {14, 145, 0, 1},
+    {14, 146, 0, 1},
+    {58, 147, 0, 1},
+    {58, 148, 0, 1},
+    {58, 149, 0, 1},
+    {58, 150, 0, 1},
+    {58, 151, 0, 1},
+    {58, 152, 0, 1},
+    {3001, 153, 0, 1},
+    {3001, 154, 0, 1},
+    {3001, 155, 0, 1},
+    {3001, 156, 0, 1},
+    {9, 157, 0, 1},
+    {9, 158, 0, 1},
+    {9, 159, 0, 1},
+    {9, 160, 0, 1},
+    {3002, 161, 0, 1},
+    {3002, 162, 0, 1},
+    {65, 163, 0, 1},
+    {65, 164, 0, 1},
+    {65, 165, 0, 1},
+    {65, 166, 0, 1},
+    {69, 167, 0, 1},
+    {85, 168, 0, 1},
+    {85, 169, 0, 1},
+    {85, 170, 0, 1},
+    {85, 171, 0, 1},
+    {86, 172, 0, 1},
+    {86, 173, 0, 1},
+    {86, 174, 0, 1},
+    {86, 175, 0, 1},
+    {86, 176, 0, 1},
+    {86, 177, 0, 1},
+    {66, 178, 0, 1},
+    {66, 179, 0, 1},
+    {9, 180, 0, 1},
+    {9, 181, 0, 1},
+    {9, 182, 0, 1},
+    {3001, 183, 0, 1},
+    {3001, 184, 0, 1},
+    {3001, 185, 0, 1},
+    {3001, 186, 0, 1},
+    {3001, 187, 0, 1},
+    {3001, 188, 0, 1},
+    {3001, 189, 0, 1},
+    {3001, 190, 0, 1},
+    {9, 191, 0, 1},
+    {9, 192, 0, 1},
+    {9, 193, 0, 1},
+    {9, 194, 0, 1},
+    {9, 195, 0, 1},
+    {9, 196, 0, 1},
+    {9, 197, 0, 1},
+    {2011, 198, 0, 1},
+    {2011, 199, 0, 1},
+    {86, 200, 0, 1},
+    {86, 201, 0, 1},
+    {86, 202, 0, 1},
+    {86, 203, 0, 1},
+    {86, 204, 0, 1},
+    {2015, 205, 0, 1},
+    {2015, 206, 0, 1},
+    {2015, 207, 0, 1},
+    {2015, 208, 0, 1},
+    {2015, 209, 0, 1},
+    {2015, 210, 0, 1},
+    {2015, 211, 0, 1},
+    {2015, 212, 0, 1},
+    {2015, 213, 0, 1},
+    {86, 214, 0, 1},
+    {86, 215, 0, 1},
+    {80, 216, 0, 1},
+    {80, 217, 0, 1},
+    {79, 218, 0, 1},
+    {79, 219, 0, 1},
+    {3004, 220, 0, 1},
+    {3004, 221, 0, 1},
+    {2019, 222, 0, 0},
+    {2003, 223, 0, 0},
+    {2046, 224, 0, 1},
+    {8, 225, 0, 0},
+    {65, 226, 0, 1},
+    {9, 227, 0, 1},
+    {3001, 228, 0, 1},
+    {2035, 229, 0, 1},
+    {2035, 230, 0, 1},
+    {2035, 231, 0, 1},
+    {2035, 232, 0, 1},
+    {2035, 233, 0, 1},
+    {2035, 234, 0, 1},
+    {2035, 235, 0, 1},
+    {2035, 236, 0, 1},
+    {2035, 237, 0, 1},
+    {11, 238, 0, 1},
+    {11, 239, 0, 1},
+    {11, 240, 0, 1},
+    {17, 241, 0, 1},
+    {17, 242, 0, 1},
+    {86, 243, 0, 1},
+    {86, 244, 0, 1},
+    {3002, 245, 0, 1},
+    {83, 246, 0, 0},
+};
+
+
+static const ap_thing_info_t ap_doom2_thing_infos_e1m7[] = 
+{
+    {1, 0, 0, 1},
+    {2, 1, 0, 1},
+    {3, 2, 0, 1},
+    {4, 3, 0, 1},
+    {83, 4, 0, 0},
+    {2003, 5, 0, 0},
+    {2010, 6, 0, 1},
+    {2024, 7, 0, 0},
+    {82, 8, 0, 0},
+    {2002, 9, 0, 0},
+    {2004, 10, 0, 0},
+    {68, 11, 0, 1},
+    {68, 12, 0, 1},
+    {68, 13, 0, 1},
+    {68, 14, 0, 1},
+    {68, 15, 0, 1},
+    {68, 16, 0, 1},
+    {68, 17, 0, 1},
+    {68, 18, 0, 1},
+    {68, 19, 0, 1},
+    {68, 20, 0, 1},
+    {68, 21, 0, 1},
+    {68, 22, 0, 1},
+    {67, 23, 0, 1},
+    {67, 24, 0, 1},
+    {67, 25, 0, 1},
+    {67, 26, 0, 1},
+    {67, 27, 0, 1},
+    {67, 28, 0, 1},
+    {2010, 29, 0, 1},
+    {2010, 30, 0, 1},
+    {2010, 31, 0, 1},
+    {2010, 32, 0, 1},
+    {2049, 33, 0, 1},
+    {2049, 34, 0, 1},
+    {2049, 35, 0, 1},
+    {2049, 36, 0, 1},
+    {2049, 37, 0, 1},
+    {2049, 38, 0, 1},
+    {2010, 39, 0, 1},
+    {2010, 40, 0, 1},
+    {2047, 41, 0, 1},
+    {2047, 42, 0, 1},
+    {8, 43, 0, 0},
+    {2023, 44, 0, 0},
+    {2012, 45, 0, 1},
+    {2012, 46, 0, 1},
+    {2012, 47, 0, 1},
+    {2012, 48, 0, 1},
+    {11, 49, 0, 1},
+    {11, 50, 0, 1},
+    {11, 51, 0, 1},
+    {11, 52, 0, 1},
+    {11, 53, 0, 1},
+    {83, 54, 0, 1},
+    {2010, 55, 0, 1},
+    {2047, 56, 0, 1},
+    {8, 57, 0, 1},
+    {8, 58, 0, 1},
+    {8, 59, 0, 1},
+    {2024, 60, 0, 0},
+    {2010, 61, 0, 1},
+    {2048, 62, 0, 1},
+    {2048, 63, 0, 1},
+    {2048, 64, 0, 1},
+    {2048, 65, 0, 1},
+    {2049, 66, 0, 1},
+    {2049, 67, 0, 1},
+    {2007, 68, 0, 1},
+    {2007, 69, 0, 1},
+    {2047, 70, 0, 1},
+    {2047, 71, 0, 1},
+    {8, 72, 0, 1},
+    {2024, 73, 0, 0},
+    {2024, 74, 0, 0},
+    {2010, 75, 0, 1},
+    {2010, 76, 0, 1},
+    {2010, 77, 0, 1},
+    {2010, 78, 0, 1},
+    {2010, 79, 0, 1},
+    {67, 80, 0, 1},
+    {2046, 81, 0, 1},
+    {2046, 82, 0, 1},
+    {2047, 83, 0, 1},
+    {2047, 84, 0, 1},
+    {2047, 85, 0, 1},
+    {11, 86, 0, 1},
+    {2006, 87, 0, 1},
+    {17, 88, 0, 1},
+    {2004, 89, 0, 1},
+    {2002, 90, 0, 1},
+    {82, 91, 0, 1},
+    {2003, 92, 0, 1},
+    {8, 93, 0, 1},
+    {8, 94, 0, 1},
+    {8, 95, 0, 1},
+    {8, 96, 0, 1},
+    {8, 97, 0, 1},
+};
+
+
+static const ap_thing_info_t ap_doom2_thing_infos_e1m8[] = 
+{
+    {1, 0, 0, 1},
+    {2, 1, 0, 1},
+    {3, 2, 0, 1},
+    {4, 3, 0, 1},
+    {11, 4, 0, 1},
+    {3005, 5, 0, 1},
+    {3005, 6, 0, 1},
+    {3005, 7, 0, 1},
+    {3005, 8, 0, 1},
+    {3005, 9, 0, 1},
+    {3005, 10, 0, 1},
+    {3005, 11, 0, 1},
+    {3005, 12, 0, 1},
+    {17, 13, 0, 1},
+    {2004, 14, 0, 0},
+    {2046, 15, 0, 1},
+    {2046, 16, 0, 1},
+    {2003, 17, 0, 0},
+    {3002, 18, 0, 1},
+    {3002, 19, 0, 1},
+    {3002, 20, 0, 1},
+    {3002, 21, 0, 1},
+    {3002, 22, 0, 1},
+    {3002, 23, 0, 1},
+    {3002, 24, 0, 1},
+    {3002, 25, 0, 1},
+    {3002, 26, 0, 1},
+    {3002, 27, 0, 1},
+    {3002, 28, 0, 1},
+    {3002, 29, 0, 1},
+    {3002, 30, 0, 1},
+    {3002, 31, 0, 1},
+    {3002, 32, 0, 1},
+    {3002, 33, 0, 1},
+    {3002, 34, 0, 1},
+    {3002, 35, 0, 1},
+    {2018, 36, 0, 0},
+    {2012, 37, 0, 1},
+    {2011, 38, 0, 1},
+    {2011, 39, 0, 1},
+    {2011, 40, 0, 1},
+    {2011, 41, 0, 1},
+    {9, 42, 0, 1},
+    {14, 43, 0, 1},
+    {14, 44, 0, 1},
+    {14, 45, 0, 1},
+    {14, 46, 0, 1},
+    {14, 47, 0, 1},
+    {2002, 48, 0, 0},
+    {2048, 49, 0, 1},
+    {2048, 50, 0, 1},
+    {2012, 51, 0, 1},
+    {27, 52, 0, 1},
+    {27, 53, 0, 1},
+    {2025, 54, 0, 1},
+    {2025, 55, 0, 1},
+    {2046, 56, 0, 1},
+    {2047, 57, 0, 1},
+    {3005, 58, 0, 1},
+    {58, 59, 0, 1},
+    {58, 60, 0, 1},
+    {14, 61, 0, 1},
+    {3001, 62, 0, 1},
+    {3001, 63, 0, 1},
+    {3001, 64, 0, 1},
+    {3001, 65, 0, 1},
+    {3001, 66, 0, 1},
+    {3001, 67, 0, 1},
+    {3001, 68, 0, 1},
+    {3001, 69, 0, 1},
+    {3001, 70, 0, 1},
+    {3001, 71, 0, 1},
+    {3001, 72, 0, 1},
+    {3001, 73, 0, 1},
+    {3001, 74, 0, 1},
+    {3001, 75, 0, 1},
+    {3001, 76, 0, 1},
+    {3001, 77, 0, 1},
+    {3001, 78, 0, 1},
+    {3001, 79, 0, 1},
+    {3001, 80, 0, 1},
+    {3001, 81, 0, 1},
+    {3001, 82, 0, 1},
+    {3001, 83, 0, 1},
+    {3001, 84, 0, 1},
+    {3001, 85, 0, 1},
+    {3001, 86, 0, 1},
+    {2001, 87, 0, 0},
+    {2049, 88, 0, 1},
+    {2049, 89, 0, 1},
+    {2008, 90, 0, 1},
+    {2008, 91, 0, 1},
+    {3001, 92, 0, 1},
+    {3001, 93, 0, 1},
+    {3001, 94, 0, 1},
+    {3001, 95, 0, 1},
+    {3001, 96, 0, 1},
+    {3001, 97, 0, 1},
+    {58, 98, 0, 1},
+    {3005, 99, 0, 1},
+    {16, 100, 0, 1},
+    {3003, 101, 0, 1},
+    {3003, 102, 0, 1},
+    {3003, 103, 0, 1},
+    {3003, 104, 0, 1},
+    {3003, 105, 0, 1},
+    {3003, 106, 0, 1},
+    {3003, 107, 0, 1},
+    {3003, 108, 0, 1},
+    {3003, 109, 0, 1},
+    {3003, 110, 0, 1},
+    {3003, 111, 0, 1},
+    {3003, 112, 0, 1},
+    {3003, 113, 0, 1},
+    {3003, 114, 0, 1},
+    {3003, 115, 0, 1},
+    {3003, 116, 0, 1},
+    {3003, 117, 0, 1},
+    {2046, 118, 0, 1},
+    {2013, 119, 0, 0},
+    {2022, 120, 0, 0},
+    {34, 121, 0, 1},
+    {2022, 122, 0, 0},
+    {39, 123, 0, 0},
+    {71, 124, 0, 1},
+    {71, 125, 0, 1},
+    {71, 126, 0, 1},
+    {71, 127, 0, 1},
+    {3006, 128, 0, 1},
+    {3006, 129, 0, 1},
+    {2048, 130, 0, 1},
+    {2012, 131, 0, 1},
+    {14, 132, 0, 1},
+    {8, 133, 0, 0},
+    {8, 134, 0, 0},
+    {2022, 135, 0, 0},
+    {2022, 136, 0, 0},
+    {3002, 137, 0, 1},
+    {3002, 138, 0, 1},
+    {3002, 139, 0, 1},
+    {3002, 140, 0, 1},
+    {3002, 141, 0, 1},
+    {3002, 142, 0, 1},
+    {3002, 143, 0, 1},
+    {3002, 144, 0, 1},
+    {3002, 145, 0, 1},
+    {3002, 146, 0, 1},
+    {3002, 147, 0, 1},
+    {3002, 148, 0, 1},
+    {3002, 149, 0, 1},
+    {3002, 150, 0, 1},
+    {3002, 151, 0, 1},
+    {3002, 152, 0, 1},
+    {3002, 153, 0, 1},
+    {3002, 154, 0, 1},
+    {3002, 155, 0, 1},
+    {3002, 156, 0, 1},
+    {3002, 157, 0, 1},
+    {3002, 158, 0, 1},
+    {3002, 159, 0, 1},
+    {3002, 160, 0, 1},
+    {2006, 161, 0, 0},
+    {2013, 162, 0, 0},
+    {8, 163, 0, 0},
+    {8, 164, 0, 0},
+    {9, 165, 0, 1},
+    {34, 166, 0, 1},
+    {34, 167, 0, 1},
+    {2005, 168, 0, 0},
+    {3003, 169, 0, 1},
+    {3005, 170, 0, 1},
+    {3005, 171, 0, 1},
+    {2048, 172, 0, 1},
+    {2010, 173, 0, 1},
+    {2047, 174, 0, 1},
+    {14, 175, 0, 1},
+    {38, 176, 0, 0},
+    {2046, 177, 0, 1},
+    {3001, 178, 0, 1},
+    {3001, 179, 0, 1},
+    {3001, 180, 0, 1},
+    {3001, 181, 0, 1},
+    {3001, 182, 0, 1},
+    {3001, 183, 0, 1},
+    {3001, 184, 0, 1},
+    {3001, 185, 0, 1},
+    {3001, 186, 0, 1},
+    {3001, 187, 0, 1},
+    {3001, 188, 0, 1},
+    {3001, 189, 0, 1},
+    {3001, 190, 0, 1},
+    {3001, 191, 0, 1},
+    {3001, 192, 0, 1},
+    {3001, 193, 0, 1},
+    {3001, 194, 0, 1},
+    {3001, 195, 0, 1},
+    {3001, 196, 0, 1},
+    {3001, 197, 0, 1},
+    {3001, 198, 0, 1},
+    {3001, 199, 0, 1},
+    {3001, 200, 0, 1},
+    {3001, 201, 0, 1},
+    {2022, 202, 0, 0},
+    {3002, 203, 0, 1},
+    {2011, 204, 0, 1},
+    {2011, 205, 0, 1},
+    {2011, 206, 0, 1},
+    {2011, 207, 0, 1},
+    {2011, 208, 0, 1},
+    {2011, 209, 0, 1},
+    {2049, 210, 0, 1},
+    {2048, 211, 0, 1},
+    {2047, 212, 0, 1},
+    {2010, 213, 0, 1},
+    {2010, 214, 0, 1},
+    {2010, 215, 0, 1},
+    {2010, 216, 0, 1},
+    {3003, 217, 0, 1},
+    {3003, 218, 0, 1},
+    {2047, 219, 0, 1},
+    {2018, 220, 0, 0},
+    {2049, 221, 0, 1},
+    {2048, 222, 0, 1},
+    {2010, 223, 0, 1},
+    {2012, 224, 0, 1},
+    {2012, 225, 0, 1},
+    {8, 226, 0, 0},
+    {9, 227, 0, 1},
+    {9, 228, 0, 1},
+    {9, 229, 0, 1},
+    {11, 230, 0, 1},
+    {11, 231, 0, 1},
+    {11, 232, 0, 1},
+    {11, 233, 0, 1},
+    {11, 234, 0, 1},
+    {2024, 235, 0, 0},
+    {34, 236, 0, 1},
+    {14, 237, 0, 1},
+    {14, 238, 0, 1},
+    {2007, 239, 0, 1},
+    {2007, 240, 0, 1},
+    {2008, 241, 0, 1},
+};
+
+
+static const ap_thing_info_t ap_doom2_thing_infos_e1m9[] = 
+{
+    {1, 0, 0, 1},
+    {2, 1, 0, 1},
+    {3, 2, 0, 1},
+    {4, 3, 0, 1},
+    {67, 4, 0, 1},
+    {2023, 5, 0, 0},
+    {2046, 6, 0, 1},
+    {3001, 7, 0, 1},
+    {3001, 8, 0, 1},
+    {71, 9, 0, 1},
+    {3005, 10, 0, 1},
+    {71, 11, 0, 1},
+    {3001, 12, 0, 1},
+    {3001, 13, 0, 1},
+    {3001, 14, 0, 1},
+    {3001, 15, 0, 1},
+    {58, 16, 0, 1},
+    {3001, 17, 0, 1},
+    {3001, 18, 0, 1},
+    {3001, 19, 0, 1},
+    {3001, 20, 0, 1},
+    {2001, 21, 0, 0},
+    {11, 22, 0, 1},
+    {11, 23, 0, 1},
+    {11, 24, 0, 1},
+    {11, 25, 0, 1},
+    {2019, 26, 0, 0},
+    {44, 27, 0, 1},
+    {3001, 28, 0, 1},
+    {3001, 29, 0, 1},
+    {3001, 30, 0, 1},
+    {3001, 31, 0, 1},
+    {3001, 32, 0, 1},
+    {9, 33, 0, 1},
+    {9, 34, 0, 1},
+    {9, 35, 0, 1},
+    {9, 36, 0, 1},
+    {9, 37, 0, 1},
+    {9, 38, 0, 1},
+    {9, 39, 0, 1},
+    {9, 40, 0, 1},
+    {3004, 41, 0, 1},
+    {3004, 42, 0, 1},
+    {3001, 43, 0, 1},
+    {3001, 44, 0, 1},
+    {3004, 45, 0, 1},
+    {3004, 46, 0, 1},
+    {3004, 47, 0, 1},
+    {3004, 48, 0, 1},
+    {3001, 49, 0, 1},
+    {3001, 50, 0, 1},
+    {3004, 51, 0, 1},
+    {3004, 52, 0, 1},
+    {3001, 53, 0, 1},
+    {3001, 54, 0, 1},
+    {3001, 55, 0, 1},
+    {3001, 56, 0, 1},
+    {3001, 57, 0, 1},
+    {3001, 58, 0, 1},
+    {3001, 59, 0, 1},
+    {3001, 60, 0, 1},
+    {2049, 61, 0, 1},
+    {2011, 62, 0, 1},
+    {2011, 63, 0, 1},
+    {2002, 64, 0, 1},
+    {2048, 65, 0, 1},
+    {2048, 66, 0, 1},
+    {69, 67, 0, 1},
+    {3001, 68, 0, 1},
+    {3001, 69, 0, 1},
+    {3001, 70, 0, 1},
+    {3001, 71, 0, 1},
+    {3001, 72, 0, 1},
+    {3001, 73, 0, 1},
+    {3001, 74, 0, 1},
+    {3001, 75, 0, 1},
+    {3001, 76, 0, 1},
+    {2010, 77, 0, 1},
+    {2013, 78, 0, 0},
+    {3006, 79, 0, 1},
+    {3006, 80, 0, 1},
+    {3006, 81, 0, 1},
+    {3006, 82, 0, 1},
+    {3006, 83, 0, 1},
+    {71, 84, 0, 1},
+    {2012, 85, 0, 1},
+    {2012, 86, 0, 1},
+    {2012, 87, 0, 1},
+    {2012, 88, 0, 1},
+    {2012, 89, 0, 1},
+    {2023, 90, 0, 0},
+    {2046, 91, 0, 1},
+    {2003, 92, 0, 0},
+    {3001, 93, 0, 1},
+    {3001, 94, 0, 1},
+    {3001, 95, 0, 1},
+    {3001, 96, 0, 1},
+    {3001, 97, 0, 1},
+    {3001, 98, 0, 1},
+    {3001, 99, 0, 1},
+    {3001, 100, 0, 1},
+    {3001, 101, 0, 1},
+    {3001, 102, 0, 1},
+    {3006, 103, 0, 1},
+    {3006, 104, 0, 1},
+    {3006, 105, 0, 1},
+    {3006, 106, 0, 1},
+    {3006, 107, 0, 1},
+    {3006, 108, 0, 1},
+    {3006, 109, 0, 1},
+    {3006, 110, 0, 1},
+    {3006, 111, 0, 1},
+    {2011, 112, 0, 1},
+    {2011, 113, 0, 1},
+    {2047, 114, 0, 1},
+    {2047, 115, 0, 1},
+    {2047, 116, 0, 1},
+    {2047, 117, 0, 1},
+    {3001, 118, 0, 1},
+    {3001, 119, 0, 1},
+    {3001, 120, 0, 1},
+    {69, 121, 0, 1},
+    {69, 122, 0, 1},
+    {3005, 123, 0, 1},
+    {3005, 124, 0, 1},
+    {3005, 125, 0, 1},
+    {3005, 126, 0, 1},
+    {3001, 127, 0, 1},
+    {3001, 128, 0, 1},
+    {3001, 129, 0, 1},
+    {3001, 130, 0, 1},
+    {3001, 131, 0, 1},
+    {3001, 132, 0, 1},
+    {9, 133, 0, 1},
+    {9, 134, 0, 1},
+    {9, 135, 0, 1},
+    {9, 136, 0, 1},
+    {9, 137, 0, 1},
+    {9, 138, 0, 1},
+    {9, 139, 0, 1},
+    {9, 140, 0, 1},
+    {9, 141, 0, 1},
+    {3006, 142, 0, 1},
+    {3001, 143, 0, 1},
+    {67, 144, 0, 1},
+    {67, 145, 0, 1},
+    {2011, 146, 0, 1},
+    {2011, 147, 0, 1},
+    {2011, 148, 0, 1},
+    {2011, 149, 0, 1},
+    {2011, 150, 0, 1},
+    {2011, 151, 0, 1},
+    {2011, 152, 0, 1},
+    {2011, 153, 0, 1},
+    {2046, 154, 0, 1},
+    {2046, 155, 0, 1},
+    {2010, 156, 0, 1},
+    {9, 157, 0, 1},
+    {9, 158, 0, 1},
+    {9, 159, 0, 1},
+    {9, 160, 0, 1},
+    {9, 161, 0, 1},
+    {9, 162, 0, 1},
+    {9, 163, 0, 1},
+    {9, 164, 0, 1},
+    {65, 165, 0, 1},
+    {65, 166, 0, 1},
+    {65, 167, 0, 1},
+    {65, 168, 0, 1},
+    {3006, 169, 0, 1},
+    {65, 170, 0, 1},
+    {65, 171, 0, 1},
+    {3006, 172, 0, 1},
+    {65, 173, 0, 1},
+    {65, 174, 0, 1},
+    {65, 175, 0, 1},
+    {3006, 176, 0, 1},
+    {65, 177, 0, 1},
+    {65, 178, 0, 1},
+    {65, 179, 0, 1},
+    {3006, 180, 0, 1},
+    {65, 181, 0, 1},
+    {3006, 182, 0, 1},
+    {71, 183, 0, 1},
+    {2006, 184, 0, 0},
+    {5, 185, 0, 0},
+    {2014, 186, 0, 1},
+    {2014, 187, 0, 1},
+    {2014, 188, 0, 1},
+    {2014, 189, 0, 1},
+    {2014, 190, 0, 1},
+    {2014, 191, 0, 1},
+    {3001, 192, 0, 1},
+    {3001, 193, 0, 1},
+    {3001, 194, 0, 1},
+    {3001, 195, 0, 1},
+    {3001, 196, 0, 1},
+    {3001, 197, 0, 1},
+    {3001, 198, 0, 1},
+    {71, 199, 0, 1},
+    {71, 200, 0, 1},
+    {3001, 201, 0, 1},
+    {3001, 202, 0, 1},
+    {3001, 203, 0, 1},
+    {3001, 204, 0, 1},
+    {3001, 205, 0, 1},
+    {3001, 206, 0, 1},
+    {3001, 207, 0, 1},
+    {3001, 208, 0, 1},
+    {3001, 209, 0, 1},
+    {3001, 210, 0, 1},
+    {3001, 211, 0, 1},
+    {3001, 212, 0, 1},
+    {3001, 213, 0, 1},
+    {3001, 214, 0, 1},
+    {3001, 215, 0, 1},
+    {3002, 216, 0, 1},
+    {3002, 217, 0, 1},
+    {3002, 218, 0, 1},
+    {2025, 219, 0, 1},
+    {3002, 220, 0, 1},
+    {3002, 221, 0, 1},
+    {3002, 222, 0, 1},
+    {3002, 223, 0, 1},
+    {3002, 224, 0, 1},
+    {3002, 225, 0, 1},
+    {6, 226, 0, 0},
+    {2014, 227, 0, 1},
+    {2014, 228, 0, 1},
+    {2014, 229, 0, 1},
+    {2014, 230, 0, 1},
+    {2014, 231, 0, 1},
+    {2014, 232, 0, 1},
+    {2014, 233, 0, 1},
+    {2014, 234, 0, 1},
+    {2014, 235, 0, 1},
+    {2014, 236, 0, 1},
+    {2007, 237, 0, 1},
+    {2007, 238, 0, 1},
+    {2007, 239, 0, 1},
+    {2010, 240, 0, 1},
+    {2012, 241, 0, 1},
+    {2012, 242, 0, 1},
+    {2012, 243, 0, 1},
+    {8, 244, 0, 0},
+    {2026, 245, 0, 0},
+    {2047, 246, 0, 1},
+    {71, 247, 0, 1},
+    {71, 248, 0, 1},
+    {14, 249, 0, 1},
+    {2013, 250, 0, 0},
+    {2019, 251, 0, 0},
+    {14, 252, 0, 1},
+    {9, 253, 0, 1},
+    {9, 254, 0, 1},
+    {9, 255, 0, 1},
+    {9, 256, 0, 1},
+    {9, 257, 0, 1},
+    {9, 258, 0, 1},
+    {9, 259, 0, 1},
+    {9, 260, 0, 1},
+    {9, 261, 0, 1},
+    {9, 262, 0, 1},
+    {3001, 263, 0, 1},
+    {3001, 264, 0, 1},
+    {3001, 265, 0, 1},
+    {3001, 266, 0, 1},
+    {3001, 267, 0, 1},
+    {3001, 268, 0, 1},
+    {3001, 269, 0, 1},
+    {3001, 270, 0, 1},
+    {3001, 271, 0, 1},
+    {3001, 272, 0, 1},
+    {3001, 273, 0, 1},
+    {3001, 274, 0, 1},
+    {3001, 275, 0, 1},
+    {3001, 276, 0, 1},
+    {3001, 277, 0, 1},
+    {3001, 278, 0, 1},
+    {3001, 279, 0, 1},
+    {3001, 280, 0, 1},
+    {3001, 281, 0, 1},
+    {3001, 282, 0, 1},
+    {3006, 283, 0, 1},
+    {3006, 284, 0, 1},
+    {3006, 285, 0, 1},
+    {3006, 286, 0, 1},
+    {3006, 287, 0, 1},
+    {3006, 288, 0, 1},
+    {3006, 289, 0, 1},
+    {3006, 290, 0, 1},
+    {3006, 291, 0, 1},
+    {3006, 292, 0, 1},
+    {3006, 293, 0, 1},
+    {3006, 294, 0, 1},
+    {2011, 295, 0, 1},
+    {2011, 296, 0, 1},
+    {2011, 297, 0, 1},
+    {2007, 298, 0, 1},
+    {2008, 299, 0, 1},
+    {2014, 300, 0, 1},
+    {2014, 301, 0, 1},
+    {2014, 302, 0, 1},
+    {2014, 303, 0, 1},
+    {2014, 304, 0, 1},
+    {2014, 305, 0, 1},
+    {2014, 306, 0, 1},
+    {2014, 307, 0, 1},
+    {2004, 308, 0, 1},
+    {2023, 309, 0, 0},
+    {2047, 310, 0, 1},
+    {2047, 311, 0, 1},
+    {2046, 312, 0, 1},
+    {2005, 313, 0, 1},
+    {11, 314, 0, 1},
+    {11, 315, 0, 1},
+    {11, 316, 0, 1},
+    {65, 317, 0, 1},
+    {65, 318, 0, 1},
+    {65, 319, 0, 1},
+    {65, 320, 0, 1},
+    {9, 321, 0, 1},
+    {9, 322, 0, 1},
+    {9, 323, 0, 1},
+    {3001, 324, 0, 1},
+    {3001, 325, 0, 1},
+    {3001, 326, 0, 1},
+    {3001, 327, 0, 1},
+    {3001, 328, 0, 1},
+    {3001, 329, 0, 1},
+    {3001, 330, 0, 1},
+    {2047, 331, 0, 1},
+    {2012, 332, 0, 1},
+    {2011, 333, 0, 1},
+    {2011, 334, 0, 1},
+    {2011, 335, 0, 1},
+    {2011, 336, 0, 1},
+    {2011, 337, 0, 1},
+    {2007, 338, 0, 1},
+    {2007, 339, 0, 1},
+    {2007, 340, 0, 1},
+    {2007, 341, 0, 1},
+    {2008, 342, 0, 1},
+    {2008, 343, 0, 1},
+    {2007, 344, 0, 1},
+    {2007, 345, 0, 1},
+    {2007, 346, 0, 1},
+    {2012, 347, 0, 1},
+    {2018, 348, 0, 0},
+    {31, 349, 0, 1},
+    {31, 350, 0, 1},
+    {31, 351, 0, 1},
+    {31, 352, 0, 1},
+    {2012, 353, 0, 1},
+    {71, 354, 0, 1},
+    {3001, 355, 0, 1},
+    {3001, 356, 0, 1},
+    {3005, 357, 0, 1},
+    {67, 358, 0, 1},
+    {67, 359, 0, 1},
+    {71, 360, 0, 1},
+    {58, 361, 0, 1},
+    {58, 362, 0, 1},
+    {58, 363, 0, 1},
+    {58, 364, 0, 1},
+    {69, 365, 0, 1},
+    {2008, 366, 0, 1},
+    {2008, 367, 0, 1},
+    {2008, 368, 0, 1},
+    {2008, 369, 0, 1},
+    {82, 370, 0, 1},
+    {3001, 371, 0, 1},
+    {3001, 372, 0, 1},
+    {58, 373, 0, 1},
+    {3006, 374, 0, 1},
+    {2014, 375, 0, 1},
+    {2014, 376, 0, 1},
+    {2014, 377, 0, 1},
+    {2014, 378, 0, 1},
+    {2014, 379, 0, 1},
+    {2014, 380, 0, 1},
+    {2014, 381, 0, 1},
+    {2014, 382, 0, 1},
+    {2014, 383, 0, 1},
+    {2014, 384, 0, 1},
+    {2014, 385, 0, 1},
+    {2014, 386, 0, 1},
+    {2014, 387, 0, 1},
+    {2014, 388, 0, 1},
+    {2014, 389, 0, 1},
+    {2014, 390, 0, 1},
+    {2014, 391, 0, 1},
+};
+
+
+static const ap_thing_info_t ap_doom2_thing_infos_e1m10[] = 
+{
+    {2, 0, 0, 1},
+    {3, 1, 0, 1},
+    {4, 2, 0, 1},
+    {1, 3, 0, 1},
+    {3001, 4, 0, 1},
+    {3001, 5, 0, 1},
+    {3001, 6, 0, 1},
+    {3001, 7, 0, 1},
+    {3001, 8, 0, 1},
+    {3001, 9, 0, 1},
+    {3001, 10, 0, 1},
+    {3002, 11, 0, 1},
+    {3002, 12, 0, 1},
+    {3002, 13, 0, 1},
+    {3002, 14, 0, 1},
+    {3002, 15, 0, 1},
+    {3001, 16, 0, 1},
+    {2006, 17, 0, 0},
+    {2046, 18, 0, 1},
+    {2012, 19, 0, 1},
+    {2048, 20, 0, 1},
+    {3002, 21, 0, 1},
+    {3002, 22, 0, 1},
+    {3002, 23, 0, 1},
+    {3002, 24, 0, 1},
+    {66, 25, 0, 1},
+    {68, 26, 0, 1},
+    {66, 27, 0, 1},
+    {2013, 28, 0, 0},
+    {2004, 29, 0, 0},
+    {2047, 30, 0, 1},
+    {3001, 31, 0, 1},
+    {3001, 32, 0, 1},
+    {3001, 33, 0, 1},
+    {2014, 34, 0, 1},
+    {2014, 35, 0, 1},
+    {2014, 36, 0, 1},
+    {2008, 37, 0, 1},
+    {3001, 38, 0, 1},
+    {3001, 39, 0, 1},
+    {3001, 40, 0, 1},
+    {2007, 41, 0, 1},
+    {2014, 42, 0, 1},
+    {3001, 43, 0, 1},
+    {3001, 44, 0, 1},
+    {3001, 45, 0, 1},
+    {3001, 46, 0, 1},
+    {3001, 47, 0, 1},
+    {3001, 48, 0, 1},
+    {3001, 49, 0, 1},
+    {5, 50, 0, 0},
+    {2014, 51, 0, 1},
+    {2014, 52, 0, 1},
+    {2014, 53, 0, 1},
+    {2014, 54, 0, 1},
+    {2014, 55, 0, 1},
+    {2015, 56, 0, 1},
+    {2007, 57, 0, 1},
+    {2012, 58, 0, 1},
+    {3002, 59, 0, 1},
+    {3002, 60, 0, 1},
+    {3002, 61, 0, 1},
+    {3002, 62, 0, 1},
+    {3004, 63, 0, 1},
+    {9, 64, 0, 1},
+    {3004, 65, 0, 1},
+    {3004, 66, 0, 1},
+    {9, 67, 0, 1},
+    {3004, 68, 0, 1},
+    {9, 69, 0, 1},
+    {3004, 70, 0, 1},
+    {3004, 71, 0, 1},
+    {3004, 72, 0, 1},
+    {9, 73, 0, 1},
+    {3004, 74, 0, 1},
+    {3004, 75, 0, 1},
+    {3004, 76, 0, 1},
+    {3004, 77, 0, 1},
+    {3004, 78, 0, 1},
+    {3004, 79, 0, 1},
+    {3004, 80, 0, 1},
+    {3004, 81, 0, 1},
+    {3004, 82, 0, 1},
+    {3006, 83, 0, 1},
+    {3006, 84, 0, 1},
+    {3001, 85, 0, 1},
+    {3001, 86, 0, 1},
+    {3001, 87, 0, 1},
+    {3001, 88, 0, 1},
+    {3001, 89, 0, 1},
+    {3001, 90, 0, 1},
+    {3004, 91, 0, 1},
+    {9, 92, 0, 1},
+    {3004, 93, 0, 1},
+    {3004, 94, 0, 1},
+    {9, 95, 0, 1},
+    {3004, 96, 0, 1},
+    {9, 97, 0, 1},
+    {3004, 98, 0, 1},
+    {2001, 99, 0, 0},
+    {2008, 100, 0, 1},
+    {2008, 101, 0, 1},
+    {2008, 102, 0, 1},
+    {2008, 103, 0, 1},
+    {2008, 104, 0, 1},
+    {2008, 105, 0, 1},
+    {2012, 106, 0, 1},
+    {2007, 107, 0, 1},
+    {2048, 108, 0, 1},
+    {2048, 109, 0, 1},
+    {2049, 110, 0, 1},
+    {2007, 111, 0, 1},
+    {2011, 112, 0, 1},
+    {2011, 113, 0, 1},
+    {2011, 114, 0, 1},
+    {2011, 115, 0, 1},
+    {2011, 116, 0, 1},
+    {2008, 117, 0, 1},
+    {3001, 118, 0, 1},
+    {3001, 119, 0, 1},
+    {3001, 120, 0, 1},
+    {3001, 121, 0, 1},
+    {3001, 122, 0, 1},
+    {3001, 123, 0, 1},
+    {3001, 124, 0, 1},
+    {3001, 125, 0, 1},
+    {3001, 126, 0, 1},
+    {3001, 127, 0, 1},
+    {3001, 128, 0, 1},
+    {3001, 129, 0, 1},
+    {3001, 130, 0, 1},
+    {3004, 131, 0, 1},
+    {3004, 132, 0, 1},
+    {3004, 133, 0, 1},
+    {3004, 134, 0, 1},
+    {3004, 135, 0, 1},
+    {9, 136, 0, 1},
+    {9, 137, 0, 1},
+    {3001, 138, 0, 1},
+    {3001, 139, 0, 1},
+    {3004, 140, 0, 1},
+    {3004, 141, 0, 1},
+    {3004, 142, 0, 1},
+    {3004, 143, 0, 1},
+    {3004, 144, 0, 1},
+    {3004, 145, 0, 1},
+    {3002, 146, 0, 1},
+    {3002, 147, 0, 1},
+    {3002, 148, 0, 1},
+    {3002, 149, 0, 1},
+    {3001, 150, 0, 1},
+    {3001, 151, 0, 1},
+    {3001, 152, 0, 1},
+    {71, 153, 0, 1},
+    {58, 154, 0, 1},
+    {58, 155, 0, 1},
+    {58, 156, 0, 1},
+    {58, 157, 0, 1},
+    {2002, 158, 0, 0},
+    {2011, 159, 0, 1},
+    {2011, 160, 0, 1},
+    {2011, 161, 0, 1},
+    {2011, 162, 0, 1},
+    {2011, 163, 0, 1},
+    {2011, 164, 0, 1},
+    {2011, 165, 0, 1},
+    {2011, 166, 0, 1},
+    {2011, 167, 0, 1},
+    {2011, 168, 0, 1},
+    {2011, 169, 0, 1},
+    {2012, 170, 0, 1},
+    {2011, 171, 0, 1},
+    {2018, 172, 0, 0},
+    {2014, 173, 0, 1},
+    {2014, 174, 0, 1},
+    {2014, 175, 0, 1},
+    {2014, 176, 0, 1},
+    {2014, 177, 0, 1},
+    {2015, 178, 0, 1},
+    {2015, 179, 0, 1},
+    {2014, 180, 0, 1},
+    {2014, 181, 0, 1},
+    {2014, 182, 0, 1},
+    {2014, 183, 0, 1},
+    {2014, 184, 0, 1},
+    {2014, 185, 0, 1},
+    {2015, 186, 0, 1},
+    {2015, 187, 0, 1},
+    {2015, 188, 0, 1},
+    {3001, 189, 0, 1},
+    {3001, 190, 0, 1},
+    {66, 191, 0, 1},
+    {66, 192, 0, 1},
+    {71, 193, 0, 1},
+    {71, 194, 0, 1},
+    {2010, 195, 0, 1},
+    {9, 196, 0, 1},
+    {9, 197, 0, 1},
+    {9, 198, 0, 1},
+    {3001, 199, 0, 1},
+    {3001, 200, 0, 1},
+    {3001, 201, 0, 1},
+    {3001, 202, 0, 1},
+    {2047, 203, 0, 1},
+    {2047, 204, 0, 1},
+    {2047, 205, 0, 1},
+    {2047, 206, 0, 1},
+    {2047, 207, 0, 1},
+    {2047, 208, 0, 1},
+    {2047, 209, 0, 1},
+    {2047, 210, 0, 1},
+    {16, 211, 0, 1},
+    {14, 212, 0, 1},
+    {14, 213, 0, 1},
+    {14, 214, 0, 1},
+    {71, 215, 0, 1},
+    {71, 216, 0, 1},
+    {3006, 217, 0, 1},
+    {3001, 218, 0, 1},
+    {3001, 219, 0, 1},
+    {3001, 220, 0, 1},
+    {3001, 221, 0, 1},
+    {71, 222, 0, 1},
+    {71, 223, 0, 1},
+    {3001, 224, 0, 1},
+    {3001, 225, 0, 1},
+    {3001, 226, 0, 1},
+    {3001, 227, 0, 1},
+    {3001, 228, 0, 1},
+    {9, 229, 0, 1},
+    {9, 230, 0, 1},
+    {3004, 231, 0, 1},
+    {3004, 232, 0, 1},
+    {3004, 233, 0, 1},
+    {3004, 234, 0, 1},
+    {3004, 235, 0, 1},
+    {3004, 236, 0, 1},
+    {3001, 237, 0, 1},
+    {3001, 238, 0, 1},
+    {3004, 239, 0, 1},
+    {3004, 240, 0, 1},
+    {3004, 241, 0, 1},
+    {3004, 242, 0, 1},
+    {3004, 243, 0, 1},
+    {9, 244, 0, 1},
+    {9, 245, 0, 1},
+    {3004, 246, 0, 1},
+    {3001, 247, 0, 1},
+    {3001, 248, 0, 1},
+    {2025, 249, 0, 1},
+    {2014, 250, 0, 1},
+    {2014, 251, 0, 1},
+    {2014, 252, 0, 1},
+    {2014, 253, 0, 1},
+    {2014, 254, 0, 1},
+    {2014, 255, 0, 1},
+    {2014, 256, 0, 1},
+    {2014, 257, 0, 1},
+    {2014, 258, 0, 1},
+    {2014, 259, 0, 1},
+    {2014, 260, 0, 1},
+    {2014, 261, 0, 1},
+    {2048, 262, 0, 1},
+    {2048, 263, 0, 1},
+    {2048, 264, 0, 1},
+    {2048, 265, 0, 1},
+    {2008, 266, 0, 1},
+    {2008, 267, 0, 1},
+    {2008, 268, 0, 1},
+    {2008, 269, 0, 1},
+    {2011, 270, 0, 1},
+    {2011, 271, 0, 1},
+    {2011, 272, 0, 1},
+    {2011, 273, 0, 1},
+    {2011, 274, 0, 1},
+    {2011, 275, 0, 1},
+    {3001, 276, 0, 1},
+    {3001, 277, 0, 1},
+    {3001, 278, 0, 1},
+    {3001, 279, 0, 1},
+    {3006, 280, 0, 1},
+    {3006, 281, 0, 1},
+    {3006, 282, 0, 1},
+    {3006, 283, 0, 1},
+    {3006, 284, 0, 1},
+    {3006, 285, 0, 1},
+    {3006, 286, 0, 1},
+    {3006, 287, 0, 1},
+    {3001, 288, 0, 1},
+    {3001, 289, 0, 1},
+    {3001, 290, 0, 1},
+    {2003, 291, 0, 0},
+    {2025, 292, 0, 1},
+    {2025, 293, 0, 1},
+    {2025, 294, 0, 1},
+    {2046, 295, 0, 1},
+    {2046, 296, 0, 1},
+    {2012, 297, 0, 1},
+    {2012, 298, 0, 1},
+    {3004, 299, 0, 1},
+    {3004, 300, 0, 1},
+    {3004, 301, 0, 1},
+    {3004, 302, 0, 1},
+    {3004, 303, 0, 1},
+    {3004, 304, 0, 1},
+    {3004, 305, 0, 1},
+    {3004, 306, 0, 1},
+    {3004, 307, 0, 1},
+    {68, 308, 0, 1},
+    {3001, 309, 0, 1},
+    {3001, 310, 0, 1},
+    {3001, 311, 0, 1},
+    {3001, 312, 0, 1},
+    {3001, 313, 0, 1},
+    {3001, 314, 0, 1},
+    {3001, 315, 0, 1},
+    {3001, 316, 0, 1},
+    {3001, 317, 0, 1},
+    {3001, 318, 0, 1},
+    {3001, 319, 0, 1},
+    {68, 320, 0, 1},
+    {9, 321, 0, 1},
+    {9, 322, 0, 1},
+    {3004, 323, 0, 1},
+    {3004, 324, 0, 1},
+    {3004, 325, 0, 1},
+    {3004, 326, 0, 1},
+    {3004, 327, 0, 1},
+    {3004, 328, 0, 1},
+    {3004, 329, 0, 1},
+    {3004, 330, 0, 1},
+    {3004, 331, 0, 1},
+    {9, 332, 0, 1},
+    {3004, 333, 0, 1},
+    {9, 334, 0, 1},
+    {9, 335, 0, 1},
+    {9, 336, 0, 1},
+    {9, 337, 0, 1},
+    {9, 338, 0, 1},
+    {9, 339, 0, 1},
+    {9, 340, 0, 1},
+    {3004, 341, 0, 1},
+    {3004, 342, 0, 1},
+    {3004, 343, 0, 1},
+    {3004, 344, 0, 1},
+    {3004, 345, 0, 1},
+    {3004, 346, 0, 1},
+    {3004, 347, 0, 1},
+    {3004, 348, 0, 1},
+    {9, 349, 0, 1},
+    {9, 350, 0, 1},
+    {9, 351, 0, 1},
+    {9, 352, 0, 1},
+    {9, 353, 0, 1},
+    {9, 354, 0, 1},
+    {2011, 355, 0, 1},
+    {2011, 356, 0, 1},
+    {2011, 357, 0, 1},
+    {2011, 358, 0, 1},
+    {2013, 359, 0, 0},
+    {3002, 360, 0, 1},
+    {3002, 361, 0, 1},
+    {3002, 362, 0, 1},
+    {3002, 363, 0, 1},
+    {3002, 364, 0, 1},
+    {3002, 365, 0, 1},
+    {3002, 366, 0, 1},
+    {3002, 367, 0, 1},
+    {8, 368, 0, 0},
+    {2014, 369, 0, 1},
+    {2014, 370, 0, 1},
+    {2014, 371, 0, 1},
+    {2015, 372, 0, 1},
+    {2015, 373, 0, 1},
+    {2015, 374, 0, 1},
+    {17, 375, 0, 1},
+    {65, 376, 0, 1},
+    {65, 377, 0, 1},
+    {65, 378, 0, 1},
+    {65, 379, 0, 1},
+    {58, 380, 0, 1},
+    {58, 381, 0, 1},
+    {58, 382, 0, 1},
+    {58, 383, 0, 1},
+    {58, 384, 0, 1},
+    {58, 385, 0, 1},
+    {2010, 386, 0, 1},
+    {2010, 387, 0, 1},
+    {2015, 388, 0, 1},
+    {2015, 389, 0, 1},
+    {2015, 390, 0, 1},
+    {2015, 391, 0, 1},
+    {2023, 392, 0, 0},
+    {2045, 393, 0, 1},
+    {2045, 394, 0, 1},
+    {2019, 395, 0, 0},
+    {2022, 396, 0, 0},
+    {14, 397, 0, 1},
+    {2022, 398, 0, 0},
+    {2048, 399, 0, 1},
+    {2018, 400, 0, 0},
+    {3001, 401, 0, 1},
+    {3001, 402, 0, 1},
+    {3001, 403, 0, 1},
+    {3001, 404, 0, 1},
+    {3001, 405, 0, 1},
+    {3001, 406, 0, 1},
+    {3001, 407, 0, 1},
+    {68, 408, 0, 1},
+    {68, 409, 0, 1},
+    {68, 410, 0, 1},
+    {68, 411, 0, 1},
+    {2015, 412, 0, 1},
+    {2015, 413, 0, 1},
+    {2015, 414, 0, 1},
+    {2015, 415, 0, 1},
+    {2015, 416, 0, 1},
+    {2015, 417, 0, 1},
+    {2015, 418, 0, 1},
+    {2015, 419, 0, 1},
+    {2015, 420, 0, 1},
+    {2015, 421, 0, 1},
+    {2015, 422, 0, 1},
+    {2015, 423, 0, 1},
+    {2015, 424, 0, 1},
+    {2015, 425, 0, 1},
+    {2015, 426, 0, 1},
+    {2015, 427, 0, 1},
+    {2015, 428, 0, 1},
+    {2015, 429, 0, 1},
+    {2015, 430, 0, 1},
+    {2015, 431, 0, 1},
+    {2015, 432, 0, 1},
+    {2010, 433, 0, 1},
+    {2047, 434, 0, 1},
+    {30, 435, 0, 1},
+    {30, 436, 0, 1},
+    {30, 437, 0, 1},
+    {30, 438, 0, 1},
+    {2047, 439, 0, 1},
+    {2046, 440, 0, 1},
+    {2023, 441, 0, 0},
+    {2015, 442, 0, 1},
+    {2015, 443, 0, 1},
+    {2015, 444, 0, 1},
+    {2015, 445, 0, 1},
+    {2015, 446, 0, 1},
+    {2015, 447, 0, 1},
+    {2015, 448, 0, 1},
+    {2015, 449, 0, 1},
+    {2015, 450, 0, 1},
+    {2015, 451, 0, 1},
+    {2015, 452, 0, 1},
+    {2015, 453, 0, 1},
+    {2015, 454, 0, 1},
+    {2015, 455, 0, 1},
+    {2015, 456, 0, 1},
+    {2015, 457, 0, 1},
+    {2015, 458, 0, 1},
+    {2015, 459, 0, 1},
+    {2015, 460, 0, 1},
+    {2015, 461, 0, 1},
+    {3001, 462, 0, 1},
+    {3001, 463, 0, 1},
+    {3001, 464, 0, 1},
+    {3001, 465, 0, 1},
+    {3001, 466, 0, 1},
+    {3001, 467, 0, 1},
+    {2010, 468, 0, 1},
+    {2010, 469, 0, 1},
+    {2024, 470, 0, 0},
+    {2045, 471, 0, 1},
+    {2005, 472, 0, 0},
+    {6, 473, 0, 0},
+    {3002, 474, 0, 1},
+    {3002, 475, 0, 1},
+    {3002, 476, 0, 1},
+    {3002, 477, 0, 1},
+    {3002, 478, 0, 1},
+    {3002, 479, 0, 1},
+    {3006, 480, 0, 1},
+    {3006, 481, 0, 1},
+    {3006, 482, 0, 1},
+    {3006, 483, 0, 1},
+    {3006, 484, 0, 1},
+    {3006, 485, 0, 1},
+    {3006, 486, 0, 1},
+    {3006, 487, 0, 1},
+    {11, 488, 0, 1},
+    {11, 489, 0, 1},
+    {11, 490, 0, 1},
+    {11, 491, 0, 1},
+    {11, 492, 0, 1},
+    {11, 493, 0, 1},
+    {11, 494, 0, 1},
+    {11, 495, 0, 1},
+    {11, 496, 0, 1},
+    {2049, 497, 0, 1},
+    {2008, 498, 0, 1},
+    {2008, 499, 0, 1},
+    {3006, 500, 0, 1},
+    {3006, 501, 0, 1},
+    {82, 502, 0, 1},
+    {8, 503, 0, 1},
+    {8, 504, 0, 1},
+    {8, 505, 0, 1},
+    {8, 506, 0, 1},
+    {83, 507, 0, 0},
+    {3003, 508, 0, 1},
+};
+
+
+static const ap_thing_info_t ap_doom2_thing_infos_e1m11[] = 
+{
+    {1, 0, 0, 1},
+    {13, 1, 0, 0},
+    {2012, 2, 0, 1},
+    {2012, 3, 0, 1},
+    {82, 4, 0, 1},
+    {17, 5, 0, 1},
+    {45, 6, 0, 1},
+    {45, 7, 0, 1},
+    {45, 8, 0, 1},
+    {45, 9, 0, 1},
+    {56, 10, 0, 1},
+    {56, 11, 0, 1},
+    {56, 12, 0, 1},
+    {56, 13, 0, 1},
+    {2002, 14, 0, 0},
+    {2015, 15, 0, 1},
+    {2015, 16, 0, 1},
+    {2015, 17, 0, 1},
+    {2015, 18, 0, 1},
+    {2015, 19, 0, 1},
+    {2015, 20, 0, 1},
+    {2011, 21, 0, 1},
+    {80, 22, 0, 1},
+    {2013, 23, 0, 0},
+    {3001, 24, 0, 1},
+    {57, 25, 0, 1},
+    {57, 26, 0, 1},
+    {70, 27, 0, 1},
+    {70, 28, 0, 1},
+    {64, 29, 0, 1},
+    {2004, 30, 0, 0},
+    {2048, 31, 0, 1},
+    {2048, 32, 0, 1},
+    {2049, 33, 0, 1},
+    {43, 34, 0, 1},
+    {43, 35, 0, 1},
+    {54, 36, 0, 1},
+    {54, 37, 0, 1},
+    {2012, 38, 0, 1},
+    {2012, 39, 0, 1},
+    {5, 40, 0, 0},
+    {2047, 41, 0, 1},
+    {2018, 42, 0, 0},
+    {44, 43, 0, 1},
+    {44, 44, 0, 1},
+    {2046, 45, 0, 1},
+    {2046, 46, 0, 1},
+    {2046, 47, 0, 1},
+    {2046, 48, 0, 1},
+    {2046, 49, 0, 1},
+    {2001, 50, 0, 0},
+    {2008, 51, 0, 1},
+    {2008, 52, 0, 1},
+    {2008, 53, 0, 1},
+    {2008, 54, 0, 1},
+    {2008, 55, 0, 1},
+    {57, 56, 0, 1},
+    {57, 57, 0, 1},
+    {2019, 58, 0, 0},
+    {2014, 59, 0, 1},
+    {2014, 60, 0, 1},
+    {2014, 61, 0, 1},
+    {2014, 62, 0, 1},
+    {2014, 63, 0, 1},
+    {2014, 64, 0, 1},
+    {2014, 65, 0, 1},
+    {2014, 66, 0, 1},
+    {2014, 67, 0, 1},
+    {2014, 68, 0, 1},
+    {2014, 69, 0, 1},
+    {2024, 70, 0, 0},
+    {46, 71, 0, 1},
+    {25, 72, 0, 1},
+    {26, 73, 0, 1},
+    {80, 74, 0, 1},
+    {80, 75, 0, 1},
+    {2025, 76, 0, 1},
+    {17, 77, 0, 1},
+    {14, 78, 0, 1},
+    {17, 79, 0, 1},
+    {17, 80, 0, 1},
+    {46, 81, 0, 1},
+    {46, 82, 0, 1},
+    {2022, 83, 0, 0},
+    {55, 84, 0, 1},
+    {55, 85, 0, 1},
+    {2003, 86, 0, 0},
+    {14, 87, 0, 1},
+    {8, 88, 0, 0},
+    {71, 89, 0, 1},
+    {71, 90, 0, 1},
+    {46, 91, 0, 1},
+    {46, 92, 0, 1},
+    {46, 93, 0, 1},
+    {46, 94, 0, 1},
+    {3001, 95, 0, 1},
+    {3001, 96, 0, 1},
+    {54, 97, 0, 1},
+    {54, 98, 0, 1},
+    {43, 99, 0, 1},
+    {43, 100, 0, 1},
+    {47, 101, 0, 1},
+    {47, 102, 0, 1},
+    {47, 103, 0, 1},
+    {47, 104, 0, 1},
+    {47, 105, 0, 1},
+    {26, 106, 0, 1},
+    {27, 107, 0, 1},
+    {2013, 108, 0, 0},
+    {14, 109, 0, 1},
+    {2006, 110, 0, 0},
+    {2, 111, 0, 1},
+    {3, 112, 0, 1},
+    {4, 113, 0, 1},
+    {3004, 114, 0, 1},
+    {3004, 115, 0, 1},
+    {3004, 116, 0, 1},
+    {3004, 117, 0, 1},
+    {9, 118, 0, 1},
+    {9, 119, 0, 1},
+    {9, 120, 0, 1},
+    {65, 121, 0, 1},
+    {65, 122, 0, 1},
+    {9, 123, 0, 1},
+    {65, 124, 0, 1},
+    {9, 125, 0, 1},
+    {9, 126, 0, 1},
+    {3005, 127, 0, 1},
+    {11, 128, 0, 1},
+    {11, 129, 0, 1},
+    {11, 130, 0, 1},
+    {11, 131, 0, 1},
+    {11, 132, 0, 1},
+    {11, 133, 0, 1},
+    {11, 134, 0, 1},
+    {3001, 135, 0, 1},
+    {3001, 136, 0, 1},
+    {3001, 137, 0, 1},
+    {9, 138, 0, 1},
+    {9, 139, 0, 1},
+    {9, 140, 0, 1},
+    {68, 141, 0, 1},
+    {68, 142, 0, 1},
+    {3005, 143, 0, 1},
+    {3005, 144, 0, 1},
+    {3001, 145, 0, 1},
+    {3001, 146, 0, 1},
+    {3001, 147, 0, 1},
+    {3004, 148, 0, 1},
+    {3004, 149, 0, 1},
+    {3004, 150, 0, 1},
+    {3004, 151, 0, 1},
+    {2048, 152, 0, 1},
+    {2048, 153, 0, 1},
+    {2008, 154, 0, 1},
+    {2008, 155, 0, 1},
+    {3001, 156, 0, 1},
+    {69, 157, 0, 1},
+    {2048, 158, 0, 1},
+    {2048, 159, 0, 1},
+    {2047, 160, 0, 1},
+    {2047, 161, 0, 1},
+    {9, 162, 0, 1},
+    {71, 163, 0, 1},
+    {58, 164, 0, 1},
+    {58, 165, 0, 1},
+    {58, 166, 0, 1},
+    {58, 167, 0, 1},
+    {58, 168, 0, 1},
+    {58, 169, 0, 1},
+    {58, 170, 0, 1},
+    {3001, 171, 0, 1},
+    {2049, 172, 0, 1},
+    {2049, 173, 0, 1},
+    {2011, 174, 0, 1},
+    {2011, 175, 0, 1},
+    {2011, 176, 0, 1},
+    {2011, 177, 0, 1},
+    {2011, 178, 0, 1},
+    {2011, 179, 0, 1},
+    {2011, 180, 0, 1},
+    {2011, 181, 0, 1},
+    {2012, 182, 0, 1},
+    {2012, 183, 0, 1},
+    {2012, 184, 0, 1},
+    {69, 185, 0, 1},
+    {3001, 186, 0, 1},
+    {65, 187, 0, 1},
+    {9, 188, 0, 1},
+    {9, 189, 0, 1},
+    {58, 190, 0, 1},
+    {58, 191, 0, 1},
+    {58, 192, 0, 1},
+    {66, 193, 0, 1},
+    {3002, 194, 0, 1},
+    {3006, 195, 0, 1},
+    {3006, 196, 0, 1},
+    {3006, 197, 0, 1},
+    {3006, 198, 0, 1},
+    {3006, 199, 0, 1},
+    {3006, 200, 0, 1},
+    {3006, 201, 0, 1},
+    {3006, 202, 0, 1},
+    {3006, 203, 0, 1},
+    {71, 204, 0, 1},
+    {3005, 205, 0, 1},
+    {3005, 206, 0, 1},
+    {3005, 207, 0, 1},
+    {3005, 208, 0, 1},
+    {3005, 209, 0, 1},
+    {9, 210, 0, 1},
+    {3001, 211, 0, 1},
+    {3001, 212, 0, 1},
+    {58, 213, 0, 1},
+    {58, 214, 0, 1},
+    {68, 215, 0, 1},
+    {2012, 216, 0, 1},
+    {2012, 217, 0, 1},
+    {2012, 218, 0, 1},
+    {2012, 219, 0, 1},
+    {2012, 220, 0, 1},
+    {2012, 221, 0, 1},
+    {2012, 222, 0, 1},
+    {2025, 223, 0, 1},
+    {3005, 224, 0, 1},
+    {3005, 225, 0, 1},
+    {2012, 226, 0, 1},
+    {2012, 227, 0, 1},
+    {2012, 228, 0, 1},
+    {2012, 229, 0, 1},
+    {2011, 230, 0, 1},
+    {2011, 231, 0, 1},
+    {2011, 232, 0, 1},
+    {2011, 233, 0, 1},
+    {2011, 234, 0, 1},
+    {2023, 235, 0, 1},
+    {17, 236, 0, 1},
+    {16, 237, 0, 1},
+};
+
+
+ap_level_info_t ap_doom2_level_infos_ep1[] = 
+{
+    {"Entryway (MAP01)", {false, false, false}, {0, 0, 0}, 4, 69, ap_doom2_thing_infos_e1m1},
+    {"Underhalls (MAP02)", {true, false, true}, {0, 0, 0}, 4, 173, ap_doom2_thing_infos_e1m2},
+    {"The Gantlet (MAP03)", {true, false, true}, {0, 0, 0}, 10, 148, ap_doom2_thing_infos_e1m3},
+    {"The Focus (MAP04)", {true, true, true}, {0, 0, 0}, 4, 138, ap_doom2_thing_infos_e1m4},
+    {"The Waste Tunnels (MAP05)", {true, true, true}, {0, 0, 0}, 12, 217, ap_doom2_thing_infos_e1m5},
+    {"The Crusher (MAP06)", {true, true, true}, {0, 0, 0}, 14, 247, ap_doom2_thing_infos_e1m6},
+    {"Dead Simple (MAP07)", {false, false, false}, {0, 0, 0}, 11, 98, ap_doom2_thing_infos_e1m7},
+    {"Tricks and Traps (MAP08)", {false, true, true}, {0, 1, 1}, 23, 242, ap_doom2_thing_infos_e1m8},
+    {"The Pit (MAP09)", {true, true, false}, {0, 0, 0}, 15, 392, ap_doom2_thing_infos_e1m9},
+    {"Refueling Base (MAP10)", {true, true, false}, {0, 0, 0}, 20, 509, ap_doom2_thing_infos_e1m10},
+    {"Circle of Death (MAP11)", {true, false, true}, {0, 0, 0}, 14, 238, ap_doom2_thing_infos_e1m11},
+};
+
+
+static const ap_thing_info_t ap_doom2_thing_infos_e2m1[] = 
 {
-    {
-        {"Entryway (MAP01)", {false, false, false}, {0, 0, 0}, 4, 69, {
-            {1, 0, 0, 1},
-            {2, 1, 0, 1},
-            {3, 2, 0, 1},
-            {4, 3, 0, 1},
-            {3001, 4, 0, 1},
-            {3001, 5, 0, 1},
-            {3004, 6, 0, 1},
-            {3004, 7, 0, 1},
-            {2007, 8, 0, 1},
-            {2015, 9, 0, 1},
-            {2011, 10, 0, 1},
-            {3004, 11, 0, 1},
-            {3004, 12, 0, 1},
-            {3004, 13, 0, 1},
-            {3004, 14, 0, 1},
-            {2011, 15, 0, 1},
-            {2011, 16, 0, 1},
-            {2018, 17, 0, 0},
-            {3004, 18, 0, 1},
-            {3004, 19, 0, 1},
-            {3004, 20, 0, 1},
-            {3004, 21, 0, 1},
-            {3004, 22, 0, 1},
-            {2014, 23, 0, 1},
-            {2014, 24, 0, 1},
-            {2014, 25, 0, 1},
-            {2014, 26, 0, 1},
-            {2014, 27, 0, 1},
-            {2014, 28, 0, 1},
-            {2014, 29, 0, 1},
-            {2014, 30, 0, 1},
-            {3001, 31, 0, 1},
-            {3001, 32, 0, 1},
-            {3001, 33, 0, 1},
-            {3004, 34, 0, 1},
-            {2011, 35, 0, 1},
-            {2011, 36, 0, 1},
-            {2001, 37, 0, 0},
-            {2008, 38, 0, 1},
-            {3001, 39, 0, 1},
-            {3001, 40, 0, 1},
-            {3001, 41, 0, 1},
-            {2012, 42, 0, 1},
-            {2012, 43, 0, 1},
-            {2012, 44, 0, 1},
-            {2007, 45, 0, 1},
-            {3001, 46, 0, 1},
-            {3001, 47, 0, 1},
-            {3001, 48, 0, 1},
-            {3001, 49, 0, 1},
-            {3001, 50, 0, 1},
-            {3001, 51, 0, 1},
-            {2003, 52, 0, 0},
-            {3001, 53, 0, 1},
-            {3001, 54, 0, 1},
-            {82, 55, 0, 1},
-            {2004, 56, 0, 1},
-            {2006, 57, 0, 1},
-            {2002, 58, 0, 1},
-            {11, 59, 0, 1},
-            {11, 60, 0, 1},
-            {11, 61, 0, 1},
-            {11, 62, 0, 1},
-            {3001, 63, 0, 1},
-            {2046, 64, 0, 1},
-            {2003, 65, 0, 1},
-            {2006, 66, 0, 1},
-            {82, 67, 0, 1},
-            {2005, 68, 0, 0},
-        }},
-        {"Underhalls (MAP02)", {true, false, true}, {0, 0, 0}, 4, 173, {
-            {1, 0, 0, 1},
-            {2, 1, 0, 1},
-            {3, 2, 0, 1},
-            {4, 3, 0, 1},
-            {3004, 4, 0, 1},
-            {3004, 5, 0, 1},
-            {3004, 6, 0, 1},
-            {3004, 7, 0, 1},
-            {9, 8, 0, 1},
-            {9, 9, 0, 1},
-            {3004, 10, 0, 1},
-            {3004, 11, 0, 1},
-            {3004, 12, 0, 1},
-            {9, 13, 0, 1},
-            {9, 14, 0, 1},
-            {9, 15, 0, 1},
-            {9, 16, 0, 1},
-            {9, 17, 0, 1},
-            {9, 18, 0, 1},
-            {9, 19, 0, 1},
-            {9, 20, 0, 1},
-            {3002, 21, 0, 1},
-            {9, 22, 0, 1},
-            {9, 23, 0, 1},
-            {9, 24, 0, 1},
-            {3001, 25, 0, 1},
-            {3001, 26, 0, 1},
-            {3001, 27, 0, 1},
-            {3001, 28, 0, 1},
-            {3001, 29, 0, 1},
-            {3001, 30, 0, 1},
-            {13, 31, 0, 0},
-            {9, 32, 0, 1},
-            {9, 33, 0, 1},
-            {9, 34, 0, 1},
-            {9, 35, 0, 1},
-            {2012, 36, 0, 1},
-            {2012, 37, 0, 1},
-            {2012, 38, 0, 1},
-            {2012, 39, 0, 1},
-            {2012, 40, 0, 1},
-            {9, 41, 0, 1},
-            {9, 42, 0, 1},
-            {3004, 43, 0, 1},
-            {5, 44, 0, 0},
-            {14, 45, 0, 1},
-            {3001, 46, 0, 1},
-            {3001, 47, 0, 1},
-            {3002, 48, 0, 1},
-            {9, 49, 0, 1},
-            {9, 50, 0, 1},
-            {9, 51, 0, 1},
-            {9, 52, 0, 1},
-            {9, 53, 0, 1},
-            {9, 54, 0, 1},
-            {9, 55, 0, 1},
-            {9, 56, 0, 1},
-            {9, 57, 0, 1},
-            {9, 58, 0, 1},
-            {3001, 59, 0, 1},
-            {3001, 60, 0, 1},
-            {3001, 61, 0, 1},
-            {3001, 62, 0, 1},
-            {3001, 63, 0, 1},
-            {3001, 64, 0, 1},
-            {3001, 65, 0, 1},
-            {3001, 66, 0, 1},
-            {2035, 67, 0, 1},
-            {2035, 68, 0, 1},
-            {2035, 69, 0, 1},
-            {2035, 70, 0, 1},
-            {2035, 71, 0, 1},
-            {2035, 72, 0, 1},
-            {2035, 73, 0, 1},
-            {2035, 74, 0, 1},
-            {2035, 75, 0, 1},
-            {2035, 76, 0, 1},
-            {2035, 77, 0, 1},
-            {2035, 78, 0, 1},
-            {2035, 79, 0, 1},
-            {2035, 80, 0, 1},
-            {2035, 81, 0, 1},
-            {2035, 82, 0, 1},
-            {2035, 83, 0, 1},
-            {2035, 84, 0, 1},
-            {9, 85, 0, 1},
-            {9, 86, 0, 1},
-            {9, 87, 0, 1},
-            {9, 88, 0, 1},
-            {9, 89, 0, 1},
-            {9, 90, 0, 1},
-            {9, 91, 0, 1},
-            {3004, 92, 0, 1},
-            {3004, 93, 0, 1},
-            {3004, 94, 0, 1},
-            {3004, 95, 0, 1},
-            {3004, 96, 0, 1},
-            {9, 97, 0, 1},
-            {9, 98, 0, 1},
-            {9, 99, 0, 1},
-            {9, 100, 0, 1},
-            {2011, 101, 0, 1},
-            {2011, 102, 0, 1},
-            {2011, 103, 0, 1},
-            {2011, 104, 0, 1},
-            {2011, 105, 0, 1},
-            {11, 106, 0, 1},
-            {11, 107, 0, 1},
-            {11, 108, 0, 1},
-            {11, 109, 0, 1},
-            {11, 110, 0, 1},
-            {2003, 111, 0, 1},
-            {2002, 112, 0, 1},
-            {2001, 113, 0, 1},
-            {2049, 114, 0, 1},
-            {2013, 115, 0, 1},
-            {2019, 116, 0, 0},
-            {2004, 117, 0, 1},
-            {2046, 118, 0, 1},
-            {17, 119, 0, 1},
-            {2010, 120, 0, 1},
-            {2010, 121, 0, 1},
-            {2010, 122, 0, 1},
-            {2010, 123, 0, 1},
-            {9, 124, 0, 1},
-            {3004, 125, 0, 1},
-            {11, 126, 0, 1},
-            {82, 127, 0, 0},
-            {3004, 128, 0, 1},
-            {3004, 129, 0, 1},
-            {3004, 130, 0, 1},
-            {3004, 131, 0, 1},
-            {3004, 132, 0, 1},
-            {3004, 133, 0, 1},
-            {3004, 134, 0, 1},
-            {3004, 135, 0, 1},
-            {9, 136, 0, 1},
-            {9, 137, 0, 1},
-            {9, 138, 0, 1},
-            {2011, 139, 0, 1},
-            {2011, 140, 0, 1},
-            {2011, 141, 0, 1},
-            {2011, 142, 0, 1},
-            {2011, 143, 0, 1},
-            {2011, 144, 0, 1},
-            {9, 145, 0, 1},
-            {9, 146, 0, 1},
-            {2008, 147, 0, 1},
-            {9, 148, 0, 1},
-            {9, 149, 0, 1},
-            {9, 150, 0, 1},
-            {9, 151, 0, 1},
-            {9, 152, 0, 1},
-            {2014, 153, 0, 1},
-            {2014, 154, 0, 1},
-            {2014, 155, 0, 1},
-            {2014, 156, 0, 1},
-            {2014, 157, 0, 1},
-            {2014, 158, 0, 1},
-            {2015, 159, 0, 1},
-            {2015, 160, 0, 1},
-            {2015, 161, 0, 1},
-            {2015, 162, 0, 1},
-            {2015, 163, 0, 1},
-            {2015, 164, 0, 1},
-            {2015, 165, 0, 1},
-            {2014, 166, 0, 1},
-            {2014, 167, 0, 1},
-            {2014, 168, 0, 1},
-            {2014, 169, 0, 1},
-            {2014, 170, 0, 1},
-            {2014, 171, 0, 1},
-            {2014, 172, 0, 1},
-        }},
-        {"The Gantlet (MAP03)", {true, false, true}, {0, 0, 0}, 10, 148, {
-            {1, 0, 0, 1},
-            {45, 1, 0, 1},
-            {45, 2, 0, 1},
-            {44, 3, 0, 1},
-            {44, 4, 0, 1},
-            {2019, 5, 0, 0},
-            {2001, 6, 0, 0},
-            {2049, 7, 0, 1},
-            {2, 8, 0, 1},
-            {3, 9, 0, 1},
-            {4, 10, 0, 1},
-            {11, 11, 0, 1},
-            {3001, 12, 0, 1},
-            {3001, 13, 0, 1},
-            {3001, 14, 0, 1},
-            {3001, 15, 0, 1},
-            {9, 16, 0, 1},
-            {3004, 17, 0, 1},
-            {3004, 18, 0, 1},
-            {3004, 19, 0, 1},
-            {3004, 20, 0, 1},
-            {3004, 21, 0, 1},
-            {3004, 22, 0, 1},
-            {3004, 23, 0, 1},
-            {3004, 24, 0, 1},
-            {9, 25, 0, 1},
-            {9, 26, 0, 1},
-            {9, 27, 0, 1},
-            {3001, 28, 0, 1},
-            {3001, 29, 0, 1},
-            {3001, 30, 0, 1},
-            {3001, 31, 0, 1},
-            {3001, 32, 0, 1},
-            {3001, 33, 0, 1},
-            {3001, 34, 0, 1},
-            {3001, 35, 0, 1},
-            {3001, 36, 0, 1},
-            {3001, 37, 0, 1},
-            {65, 38, 0, 1},
-            {65, 39, 0, 1},
-            {65, 40, 0, 1},
-            {65, 41, 0, 1},
-            {58, 42, 0, 1},
-            {58, 43, 0, 1},
-            {65, 44, 0, 1},
-            {65, 45, 0, 1},
-            {58, 46, 0, 1},
-            {58, 47, 0, 1},
-            {9, 48, 0, 1},
-            {9, 49, 0, 1},
-            {3004, 50, 0, 1},
-            {3004, 51, 0, 1},
-            {9, 52, 0, 1},
-            {9, 53, 0, 1},
-            {65, 54, 0, 1},
-            {65, 55, 0, 1},
-            {9, 56, 0, 1},
-            {9, 57, 0, 1},
-            {9, 58, 0, 1},
-            {3004, 59, 0, 1},
-            {3004, 60, 0, 1},
-            {3004, 61, 0, 1},
-            {3004, 62, 0, 1},
-            {9, 63, 0, 1},
-            {9, 64, 0, 1},
-            {2012, 65, 0, 1},
-            {9, 66, 0, 1},
-            {9, 67, 0, 1},
-            {9, 68, 0, 1},
-            {9, 69, 0, 1},
-            {9, 70, 0, 1},
-            {3004, 71, 0, 1},
-            {2012, 72, 0, 1},
-            {79, 73, 0, 1},
-            {79, 74, 0, 1},
-            {79, 75, 0, 1},
-            {80, 76, 0, 1},
-            {80, 77, 0, 1},
-            {80, 78, 0, 1},
-            {2012, 79, 0, 1},
-            {2012, 80, 0, 1},
-            {2012, 81, 0, 1},
-            {2004, 82, 0, 1},
-            {9, 83, 0, 1},
-            {9, 84, 0, 1},
-            {5, 85, 0, 0},
-            {2003, 86, 0, 0},
-            {17, 87, 0, 1},
-            {11, 88, 0, 1},
-            {11, 89, 0, 1},
-            {11, 90, 0, 1},
-            {14, 91, 0, 1},
-            {65, 92, 0, 1},
-            {2006, 93, 0, 1},
-            {17, 94, 0, 1},
-            {17, 95, 0, 1},
-            {2024, 96, 0, 0},
-            {2013, 97, 0, 0},
-            {2019, 98, 0, 0},
-            {14, 99, 0, 1},
-            {14, 100, 0, 1},
-            {2012, 101, 0, 1},
-            {2012, 102, 0, 1},
-            {3002, 103, 0, 1},
-            {13, 104, 0, 0},
-            {17, 105, 0, 1},
-            {2048, 106, 0, 1},
-            {3002, 107, 0, 1},
-            {3002, 108, 0, 1},
-            {3002, 109, 0, 1},
-            {58, 110, 0, 1},
-            {58, 111, 0, 1},
-            {3001, 112, 0, 1},
-            {3001, 113, 0, 1},
-            {3001, 114, 0, 1},
-            {3001, 115, 0, 1},
-            {3001, 116, 0, 1},
-            {3001, 117, 0, 1},
-            {3001, 118, 0, 1},
-            {3001, 119, 0, 1},
-            {14, 120, 0, 1},
-            {3002, 121, 0, 1},
-            {2002, 122, 0, 0},
-            {2008, 123, 0, 1},
-            {2008, 124, 0, 1},
-            {2048, 125, 0, 1},
-            {2046, 126, 0, 1},
-            {2010, 127, 0, 1},
-            {2010, 128, 0, 1},
-            {2010, 129, 0, 1},
-            {2010, 130, 0, 1},
-            {2010, 131, 0, 1},
-            {2010, 132, 0, 1},
-            {82, 133, 0, 1},
-            {2013, 134, 0, 1},
-            {2015, 135, 0, 1},
-            {2015, 136, 0, 1},
-            {2015, 137, 0, 1},
-            {2015, 138, 0, 1},
-            {2015, 139, 0, 1},
-            {2015, 140, 0, 1},
-            {2015, 141, 0, 1},
-            {3002, 142, 0, 1},
-            {3002, 143, 0, 1},
-            {3002, 144, 0, 1},
-            {82, 145, 0, 1},
-            {8, 146, 0, 0},
-            {14, 147, 0, 1},
-        }},
-        {"The Focus (MAP04)", {true, true, true}, {0, 0, 0}, 4, 138, {
-            {1, 0, 0, 1},
-            {2, 1, 0, 1},
-            {3, 2, 0, 1},
-            {4, 3, 0, 1},
-            {82, 4, 0, 0},
-            {2049, 5, 0, 1},
-            {2035, 6, 0, 1},
-            {2035, 7, 0, 1},
-            {2035, 8, 0, 1},
-            {2035, 9, 0, 1},
-            {9, 10, 0, 1},
-            {9, 11, 0, 1},
-            {9, 12, 0, 1},
-            {9, 13, 0, 1},
-            {9, 14, 0, 1},
-            {9, 15, 0, 1},
-            {9, 16, 0, 1},
-            {9, 17, 0, 1},
-            {9, 18, 0, 1},
-            {9, 19, 0, 1},
-            {9, 20, 0, 1},
-            {5, 21, 0, 0},
-            {3001, 22, 0, 1},
-            {3001, 23, 0, 1},
-            {3001, 24, 0, 1},
-            {11, 25, 0, 1},
-            {11, 26, 0, 1},
-            {11, 27, 0, 1},
-            {11, 28, 0, 1},
-            {2003, 29, 0, 1},
-            {2001, 30, 0, 1},
-            {2013, 31, 0, 1},
-            {13, 32, 0, 0},
-            {2006, 33, 0, 1},
-            {2019, 34, 0, 1},
-            {11, 35, 0, 1},
-            {3001, 36, 0, 1},
-            {3001, 37, 0, 1},
-            {3001, 38, 0, 1},
-            {3001, 39, 0, 1},
-            {3001, 40, 0, 1},
-            {3001, 41, 0, 1},
-            {14, 42, 0, 1},
-            {86, 43, 0, 1},
-            {86, 44, 0, 1},
-            {9, 45, 0, 1},
-            {65, 46, 0, 1},
-            {65, 47, 0, 1},
-            {65, 48, 0, 1},
-            {65, 49, 0, 1},
-            {9, 50, 0, 1},
-            {9, 51, 0, 1},
-            {9, 52, 0, 1},
-            {9, 53, 0, 1},
-            {58, 54, 0, 1},
-            {58, 55, 0, 1},
-            {65, 56, 0, 1},
-            {14, 57, 0, 1},
-            {14, 58, 0, 1},
-            {6, 59, 0, 0},
-            {14, 60, 0, 1},
-            {9, 61, 0, 1},
-            {9, 62, 0, 1},
-            {9, 63, 0, 1},
-            {58, 64, 0, 1},
-            {3002, 65, 0, 1},
-            {3001, 66, 0, 1},
-            {3001, 67, 0, 1},
-            {3001, 68, 0, 1},
-            {3001, 69, 0, 1},
-            {3001, 70, 0, 1},
-            {3001, 71, 0, 1},
-            {3001, 72, 0, 1},
-            {3001, 73, 0, 1},
-            {3004, 74, 0, 1},
-            {3004, 75, 0, 1},
-            {3004, 76, 0, 1},
-            {3004, 77, 0, 1},
-            {65, 78, 0, 1},
-            {3004, 79, 0, 1},
-            {3004, 80, 0, 1},
-            {65, 81, 0, 1},
-            {65, 82, 0, 1},
-            {65, 83, 0, 1},
-            {65, 84, 0, 1},
-            {2012, 85, 0, 1},
-            {2012, 86, 0, 1},
-            {2011, 87, 0, 1},
-            {2011, 88, 0, 1},
-            {2011, 89, 0, 1},
-            {2011, 90, 0, 1},
-            {2011, 91, 0, 1},
-            {2011, 92, 0, 1},
-            {2011, 93, 0, 1},
-            {2011, 94, 0, 1},
-            {2015, 95, 0, 1},
-            {2015, 96, 0, 1},
-            {2015, 97, 0, 1},
-            {2015, 98, 0, 1},
-            {2015, 99, 0, 1},
-            {2015, 100, 0, 1},
-            {2015, 101, 0, 1},
-            {2014, 102, 0, 1},
-            {2014, 103, 0, 1},
-            {2014, 104, 0, 1},
-            {2014, 105, 0, 1},
-            {2014, 106, 0, 1},
-            {2014, 107, 0, 1},
-            {2014, 108, 0, 1},
-            {2014, 109, 0, 1},
-            {2014, 110, 0, 1},
-            {2014, 111, 0, 1},
-            {2014, 112, 0, 1},
-            {2015, 113, 0, 1},
-            {2015, 114, 0, 1},
-            {2015, 115, 0, 1},
-            {2015, 116, 0, 1},
-            {2015, 117, 0, 1},
-            {2015, 118, 0, 1},
-            {2015, 119, 0, 1},
-            {2015, 120, 0, 1},
-            {2015, 121, 0, 1},
-            {2015, 122, 0, 1},
-            {2015, 123, 0, 1},
-            {2015, 124, 0, 1},
-            {2015, 125, 0, 1},
-            {2015, 126, 0, 1},
-            {2015, 127, 0, 1},
-            {2015, 128, 0, 1},
-            {3001, 129, 0, 1},
-            {3001, 130, 0, 1},
-            {3001, 131, 0, 1},
-            {3002, 132, 0, 1},
-            {2008, 133, 0, 1},
-            {2008, 134, 0, 1},
-            {2008, 135, 0, 1},
-            {86, 136, 0, 1},
-            {86, 137, 0, 1},
-        }},
-        {"The Waste Tunnels (MAP05)", {true, true, true}, {0, 0, 0}, 12, 217, {
-            {1, 0, 0, 1},
-            {2, 1, 0, 1},
-            {3, 2, 0, 1},
-            {4, 3, 0, 1},
-            {3001, 4, 0, 1},
-            {3001, 5, 0, 1},
-            {3001, 6, 0, 1},
-            {3001, 7, 0, 1},
-            {3001, 8, 0, 1},
-            {3001, 9, 0, 1},
-            {3001, 10, 0, 1},
-            {3001, 11, 0, 1},
-            {3001, 12, 0, 1},
-            {3001, 13, 0, 1},
-            {3001, 14, 0, 1},
-            {3001, 15, 0, 1},
-            {3001, 16, 0, 1},
-            {3001, 17, 0, 1},
-            {3001, 18, 0, 1},
-            {3001, 19, 0, 1},
-            {3001, 20, 0, 1},
-            {3001, 21, 0, 1},
-            {3001, 22, 0, 1},
-            {3001, 23, 0, 1},
-            {3001, 24, 0, 1},
-            {3001, 25, 0, 1},
-            {79, 26, 0, 1},
-            {75, 27, 0, 1},
-            {80, 28, 0, 1},
-            {27, 29, 0, 1},
-            {27, 30, 0, 1},
-            {26, 31, 0, 1},
-            {46, 32, 0, 1},
-            {46, 33, 0, 1},
-            {46, 34, 0, 1},
-            {46, 35, 0, 1},
-            {46, 36, 0, 1},
-            {46, 37, 0, 1},
-            {45, 38, 0, 1},
-            {45, 39, 0, 1},
-            {11, 40, 0, 1},
-            {11, 41, 0, 1},
-            {11, 42, 0, 1},
-            {11, 43, 0, 1},
-            {11, 44, 0, 1},
-            {2003, 45, 0, 0},
-            {82, 46, 0, 0},
-            {2049, 47, 0, 1},
-            {24, 48, 0, 1},
-            {24, 49, 0, 1},
-            {5, 50, 0, 0},
-            {56, 51, 0, 1},
-            {56, 52, 0, 1},
-            {2004, 53, 0, 0},
-            {2046, 54, 0, 1},
-            {13, 55, 0, 0},
-            {2013, 56, 0, 0},
-            {2019, 57, 0, 0},
-            {2045, 58, 0, 1},
-            {58, 59, 0, 1},
-            {9, 60, 0, 1},
-            {65, 61, 0, 1},
-            {9, 62, 0, 1},
-            {3001, 63, 0, 1},
-            {3001, 64, 0, 1},
-            {3001, 65, 0, 1},
-            {3001, 66, 0, 1},
-            {3001, 67, 0, 1},
-            {3001, 68, 0, 1},
-            {3001, 69, 0, 1},
-            {3001, 70, 0, 1},
-            {3001, 71, 0, 1},
-            {2008, 72, 0, 1},
-            {2022, 73, 0, 1},
-            {2024, 74, 0, 1},
-            {2024, 75, 0, 1},
-            {2046, 76, 0, 1},
-            {2049, 77, 0, 1},
-            {6, 78, 0, 0},
-            {14, 79, 0, 1},
-            {2006, 80, 0, 1},
-            {2049, 81, 0, 1},
-            {2046, 82, 0, 1},
-            {17, 83, 0, 1},
-            {9, 84, 0, 1},
-            {9, 85, 0, 1},
-            {65, 86, 0, 1},
-            {65, 87, 0, 1},
-            {65, 88, 0, 1},
-            {65, 89, 0, 1},
-            {9, 90, 0, 1},
-            {9, 91, 0, 1},
-            {9, 92, 0, 1},
-            {9, 93, 0, 1},
-            {9, 94, 0, 1},
-            {3001, 95, 0, 1},
-            {3001, 96, 0, 1},
-            {65, 97, 0, 1},
-            {3004, 98, 0, 1},
-            {3004, 99, 0, 1},
-            {3004, 100, 0, 1},
-            {3004, 101, 0, 1},
-            {9, 102, 0, 1},
-            {9, 103, 0, 1},
-            {3006, 104, 0, 1},
-            {3006, 105, 0, 1},
-            {3006, 106, 0, 1},
-            {3006, 107, 0, 1},
-            {3006, 108, 0, 1},
-            {3006, 109, 0, 1},
-            {3001, 110, 0, 1},
-            {3001, 111, 0, 1},
-            {3001, 112, 0, 1},
-            {3004, 113, 0, 1},
-            {3004, 114, 0, 1},
-            {3004, 115, 0, 1},
-            {3004, 116, 0, 1},
-            {3004, 117, 0, 1},
-            {3004, 118, 0, 1},
-            {3004, 119, 0, 1},
-            {3004, 120, 0, 1},
-            {3004, 121, 0, 1},
-            {3004, 122, 0, 1},
-            {3004, 123, 0, 1},
-            {3004, 124, 0, 1},
-            {65, 125, 0, 1},
-            {65, 126, 0, 1},
-            {9, 127, 0, 1},
-            {9, 128, 0, 1},
-            {9, 129, 0, 1},
-            {3005, 130, 0, 1},
-            {3005, 131, 0, 1},
-            {3005, 132, 0, 1},
-            {3001, 133, 0, 1},
-            {3001, 134, 0, 1},
-            {3004, 135, 0, 1},
-            {3004, 136, 0, 1},
-            {3001, 137, 0, 1},
-            {3001, 138, 0, 1},
-            {3001, 139, 0, 1},
-            {3001, 140, 0, 1},
-            {58, 141, 0, 1},
-            {58, 142, 0, 1},
-            {9, 143, 0, 1},
-            {9, 144, 0, 1},
-            {3001, 145, 0, 1},
-            {3001, 146, 0, 1},
-            {3001, 147, 0, 1},
-            {3001, 148, 0, 1},
-            {3001, 149, 0, 1},
-            {3001, 150, 0, 1},
-            {2018, 151, 0, 0},
-            {2011, 152, 0, 1},
-            {2011, 153, 0, 1},
-            {2011, 154, 0, 1},
-            {2011, 155, 0, 1},
-            {2011, 156, 0, 1},
-            {9, 157, 0, 1},
-            {2011, 158, 0, 1},
-            {2011, 159, 0, 1},
-            {2011, 160, 0, 1},
-            {2048, 161, 0, 1},
-            {2008, 162, 0, 1},
-            {2008, 163, 0, 1},
-            {2011, 164, 0, 1},
-            {2011, 165, 0, 1},
-            {2011, 166, 0, 1},
-            {9, 167, 0, 1},
-            {9, 168, 0, 1},
-            {9, 169, 0, 1},
-            {2013, 170, 0, 0},
-            {9, 171, 0, 1},
-            {9, 172, 0, 1},
-            {9, 173, 0, 1},
-            {9, 174, 0, 1},
-            {9, 175, 0, 1},
-            {9, 176, 0, 1},
-            {9, 177, 0, 1},
-            {65, 178, 0, 1},
-            {65, 179, 0, 1},
-            {3001, 180, 0, 1},
-            {3001, 181, 0, 1},
-            {3001, 182, 0, 1},
-            {3001, 183, 0, 1},
-            {58, 184, 0, 1},
-            {58, 185, 0, 1},
-            {69, 186, 0, 1},
-            {2049, 187, 0, 1},
-            {2012, 188, 0, 1},
-            {2012, 189, 0, 1},
-            {2012, 190, 0, 1},
-            {2011, 191, 0, 1},
-            {2011, 192, 0, 1},
-            {2048, 193, 0, 1},
-            {65, 194, 0, 1},
-            {2008, 195, 0, 1},
-            {2008, 196, 0, 1},
-            {3001, 197, 0, 1},
-            {3001, 198, 0, 1},
-            {56, 199, 0, 1},
-            {56, 200, 0, 1},
-            {2011, 201, 0, 1},
-            {2001, 202, 0, 0},
-            {2001, 203, 0, 1},
-            {3002, 204, 0, 1},
-            {58, 205, 0, 1},
-            {58, 206, 0, 1},
-            {3002, 207, 0, 1},
-            {3002, 208, 0, 1},
-            {2008, 209, 0, 1},
-            {2008, 210, 0, 1},
-            {2008, 211, 0, 1},
-            {2008, 212, 0, 1},
-            {53, 213, 0, 1},
-            {78, 214, 0, 1},
-            {2023, 215, 0, 0},
-            {2012, 216, 0, 1},
-        }},
-        {"The Crusher (MAP06)", {true, true, true}, {0, 0, 0}, 14, 247, {
-            {13, 0, 0, 0},
-            {6, 1, 0, 0},
-            {2002, 2, 0, 1},
-            {11, 3, 0, 1},
-            {11, 4, 0, 1},
-            {11, 5, 0, 1},
-            {3001, 6, 0, 1},
-            {3001, 7, 0, 1},
-            {3001, 8, 0, 1},
-            {9, 9, 0, 1},
-            {3001, 10, 0, 1},
-            {3001, 11, 0, 1},
-            {3001, 12, 0, 1},
-            {3001, 13, 0, 1},
-            {3001, 14, 0, 1},
-            {3001, 15, 0, 1},
-            {3001, 16, 0, 1},
-            {3001, 17, 0, 1},
-            {3001, 18, 0, 1},
-            {9, 19, 0, 1},
-            {9, 20, 0, 1},
-            {58, 21, 0, 1},
-            {2008, 22, 0, 1},
-            {3006, 23, 0, 1},
-            {58, 24, 0, 1},
-            {58, 25, 0, 1},
-            {2008, 26, 0, 1},
-            {2008, 27, 0, 1},
-            {69, 28, 0, 1},
-            {9, 29, 0, 1},
-            {9, 30, 0, 1},
-            {65, 31, 0, 1},
-            {2012, 32, 0, 1},
-            {2008, 33, 0, 1},
-            {3006, 34, 0, 1},
-            {3001, 35, 0, 1},
-            {5, 36, 0, 0},
-            {3001, 37, 0, 1},
-            {3001, 38, 0, 1},
-            {3001, 39, 0, 1},
-            {3001, 40, 0, 1},
-            {3001, 41, 0, 1},
-            {3001, 42, 0, 1},
-            {3001, 43, 0, 1},
-            {3001, 44, 0, 1},
-            {3001, 45, 0, 1},
-            {7, 46, 0, 1},
-            {3001, 47, 0, 1},
-            {3001, 48, 0, 1},
-            {3001, 49, 0, 1},
-            {3001, 50, 0, 1},
-            {3001, 51, 0, 1},
-            {3001, 52, 0, 1},
-            {3001, 53, 0, 1},
-            {2006, 54, 0, 1},
-            {2013, 55, 0, 0},
-            {2011, 56, 0, 1},
-            {2011, 57, 0, 1},
-            {2011, 58, 0, 1},
-            {2004, 59, 0, 0},
-            {2047, 60, 0, 1},
-            {2047, 61, 0, 1},
-            {2047, 62, 0, 1},
-            {2046, 63, 0, 1},
-            {2046, 64, 0, 1},
-            {14, 65, 0, 1},
-            {14, 66, 0, 1},
-            {2012, 67, 0, 1},
-            {2012, 68, 0, 1},
-            {2012, 69, 0, 1},
-            {69, 70, 0, 1},
-            {69, 71, 0, 1},
-            {69, 72, 0, 1},
-            {69, 73, 0, 1},
-            {5, 74, 0, 0},
-            {5, 75, 0, 0},
-            {2008, 76, 0, 1},
-            {2008, 77, 0, 1},
-            {2012, 78, 0, 1},
-            {2012, 79, 0, 1},
-            {58, 80, 0, 1},
-            {2049, 81, 0, 1},
-            {17, 82, 0, 1},
-            {1, 83, 0, 1},
-            {2, 84, 0, 1},
-            {3, 85, 0, 1},
-            {4, 86, 0, 1},
-            {3002, 87, 0, 1},
-            {3002, 88, 0, 1},
-            {3002, 89, 0, 1},
-            {3002, 90, 0, 1},
-            {85, 91, 0, 1},
-            {85, 92, 0, 1},
-            {85, 93, 0, 1},
-            {83, 94, 0, 0},
-            {85, 95, 0, 1},
-            {85, 96, 0, 1},
-            {85, 97, 0, 1},
-            {58, 98, 0, 1},
-            {58, 99, 0, 1},
-            {9, 100, 0, 1},
-            {9, 101, 0, 1},
-            {9, 102, 0, 1},
-            {65, 103, 0, 1},
-            {65, 104, 0, 1},
-            {65, 105, 0, 1},
-            {9, 106, 0, 1},
-            {9, 107, 0, 1},
-            {9, 108, 0, 1},
-            {9, 109, 0, 1},
-            {9, 110, 0, 1},
-            {9, 111, 0, 1},
-            {3001, 112, 0, 1},
-            {3001, 113, 0, 1},
-            {66, 114, 0, 1},
-            {2008, 115, 0, 1},
-            {2008, 116, 0, 1},
-            {2008, 117, 0, 1},
-            {2007, 118, 0, 1},
-            {2012, 119, 0, 1},
-            {2012, 120, 0, 1},
-            {2011, 121, 0, 1},
-            {2011, 122, 0, 1},
-            {2011, 123, 0, 1},
-            {2011, 124, 0, 1},
-            {2014, 125, 0, 1},
-            {2014, 126, 0, 1},
-            {2014, 127, 0, 1},
-            {2014, 128, 0, 1},
-            {2014, 129, 0, 1},
-            {2018, 130, 0, 0},
-            {86, 131, 0, 1},
-            {86, 132, 0, 1},
-            {2001, 133, 0, 1},
-            {82, 134, 0, 0},
-            {66, 135, 0, 1},
-            {65, 136, 0, 1},
-            {65, 137, 0, 1},
-            {9, 138, 0, 1},
-            {14, 139, 0, 1},
-            {14, 140, 0, 1},
-            {14, 141, 0, 1},
-            {14, 142, 0, 1},
-            {14, 143, 0, 1},
-            {14, 144, 0, 1},
-            {14, 145, 0, 1},
-            {14, 146, 0, 1},
-            {58, 147, 0, 1},
-            {58, 148, 0, 1},
-            {58, 149, 0, 1},
-            {58, 150, 0, 1},
-            {58, 151, 0, 1},
-            {58, 152, 0, 1},
-            {3001, 153, 0, 1},
-            {3001, 154, 0, 1},
-            {3001, 155, 0, 1},
-            {3001, 156, 0, 1},
-            {9, 157, 0, 1},
-            {9, 158, 0, 1},
-            {9, 159, 0, 1},
-            {9, 160, 0, 1},
-            {3002, 161, 0, 1},
-            {3002, 162, 0, 1},
-            {65, 163, 0, 1},
-            {65, 164, 0, 1},
-            {65, 165, 0, 1},
-            {65, 166, 0, 1},
-            {69, 167, 0, 1},
-            {85, 168, 0, 1},
-            {85, 169, 0, 1},
-            {85, 170, 0, 1},
-            {85, 171, 0, 1},
-            {86, 172, 0, 1},
-            {86, 173, 0, 1},
-            {86, 174, 0, 1},
-            {86, 175, 0, 1},
-            {86, 176, 0, 1},
-            {86, 177, 0, 1},
-            {66, 178, 0, 1},
-            {66, 179, 0, 1},
-            {9, 180, 0, 1},
-            {9, 181, 0, 1},
-            {9, 182, 0, 1},
-            {3001, 183, 0, 1},
-            {3001, 184, 0, 1},
-            {3001, 185, 0, 1},
-            {3001, 186, 0, 1},
-            {3001, 187, 0, 1},
-            {3001, 188, 0, 1},
-            {3001, 189, 0, 1},
-            {3001, 190, 0, 1},
-            {9, 191, 0, 1},
-            {9, 192, 0, 1},
-            {9, 193, 0, 1},
-            {9, 194, 0, 1},
-            {9, 195, 0, 1},
-            {9, 196, 0, 1},
-            {9, 197, 0, 1},
-            {2011, 198, 0, 1},
-            {2011, 199, 0, 1},
-            {86, 200, 0, 1},
-            {86, 201, 0, 1},
-            {86, 202, 0, 1},
-            {86, 203, 0, 1},
-            {86, 204, 0, 1},
-            {2015, 205, 0, 1},
-            {2015, 206, 0, 1},
-            {2015, 207, 0, 1},
-            {2015, 208, 0, 1},
-            {2015, 209, 0, 1},
-            {2015, 210, 0, 1},
-            {2015, 211, 0, 1},
-            {2015, 212, 0, 1},
-            {2015, 213, 0, 1},
-            {86, 214, 0, 1},
-            {86, 215, 0, 1},
-            {80, 216, 0, 1},
-            {80, 217, 0, 1},
-            {79, 218, 0, 1},
-            {79, 219, 0, 1},
-            {3004, 220, 0, 1},
-            {3004, 221, 0, 1},
-            {2019, 222, 0, 0},
-            {2003, 223, 0, 0},
-            {2046, 224, 0, 1},
-            {8, 225, 0, 0},
-            {65, 226, 0, 1},
-            {9, 227, 0, 1},
-            {3001, 228, 0, 1},
-            {2035, 229, 0, 1},
-            {2035, 230, 0, 1},
-            {2035, 231, 0, 1},
-            {2035, 232, 0, 1},
-            {2035, 233, 0, 1},
-            {2035, 234, 0, 1},
-            {2035, 235, 0, 1},
-            {2035, 236, 0, 1},
-            {2035, 237, 0, 1},
-            {11, 238, 0, 1},
-            {11, 239, 0, 1},
-            {11, 240, 0, 1},
-            {17, 241, 0, 1},
-            {17, 242, 0, 1},
-            {86, 243, 0, 1},
-            {86, 244, 0, 1},
-            {3002, 245, 0, 1},
-            {83, 246, 0, 0},
-        }},
-        {"Dead Simple (MAP07)", {false, false, false}, {0, 0, 0}, 11, 98, {
-            {1, 0, 0, 1},
-            {2, 1, 0, 1},
-            {3, 2, 0, 1},
-            {4, 3, 0, 1},
-            {83, 4, 0, 0},
-            {2003, 5, 0, 0},
-            {2010, 6, 0, 1},
-            {2024, 7, 0, 0},
-            {82, 8, 0, 0},
-            {2002, 9, 0, 0},
-            {2004, 10, 0, 0},
-            {68, 11, 0, 1},
-            {68, 12, 0, 1},
-            {68, 13, 0, 1},
-            {68, 14, 0, 1},
-            {68, 15, 0, 1},
-            {68, 16, 0, 1},
-            {68, 17, 0, 1},
-            {68, 18, 0, 1},
-            {68, 19, 0, 1},
-            {68, 20, 0, 1},
-            {68, 21, 0, 1},
-            {68, 22, 0, 1},
-            {67, 23, 0, 1},
-            {67, 24, 0, 1},
-            {67, 25, 0, 1},
-            {67, 26, 0, 1},
-            {67, 27, 0, 1},
-            {67, 28, 0, 1},
-            {2010, 29, 0, 1},
-            {2010, 30, 0, 1},
-            {2010, 31, 0, 1},
-            {2010, 32, 0, 1},
-            {2049, 33, 0, 1},
-            {2049, 34, 0, 1},
-            {2049, 35, 0, 1},
-            {2049, 36, 0, 1},
-            {2049, 37, 0, 1},
-            {2049, 38, 0, 1},
-            {2010, 39, 0, 1},
-            {2010, 40, 0, 1},
-            {2047, 41, 0, 1},
-            {2047, 42, 0, 1},
-            {8, 43, 0, 0},
-            {2023, 44, 0, 0},
-            {2012, 45, 0, 1},
-            {2012, 46, 0, 1},
-            {2012, 47, 0, 1},
-            {2012, 48, 0, 1},
-            {11, 49, 0, 1},
-            {11, 50, 0, 1},
-            {11, 51, 0, 1},
-            {11, 52, 0, 1},
-            {11, 53, 0, 1},
-            {83, 54, 0, 1},
-            {2010, 55, 0, 1},
-            {2047, 56, 0, 1},
-            {8, 57, 0, 1},
-            {8, 58, 0, 1},
-            {8, 59, 0, 1},
-            {2024, 60, 0, 0},
-            {2010, 61, 0, 1},
-            {2048, 62, 0, 1},
-            {2048, 63, 0, 1},
-            {2048, 64, 0, 1},
-            {2048, 65, 0, 1},
-            {2049, 66, 0, 1},
-            {2049, 67, 0, 1},
-            {2007, 68, 0, 1},
-            {2007, 69, 0, 1},
-            {2047, 70, 0, 1},
-            {2047, 71, 0, 1},
-            {8, 72, 0, 1},
-            {2024, 73, 0, 0},
-            {2024, 74, 0, 0},
-            {2010, 75, 0, 1},
-            {2010, 76, 0, 1},
-            {2010, 77, 0, 1},
-            {2010, 78, 0, 1},
-            {2010, 79, 0, 1},
-            {67, 80, 0, 1},
-            {2046, 81, 0, 1},
-            {2046, 82, 0, 1},
-            {2047, 83, 0, 1},
-            {2047, 84, 0, 1},
-            {2047, 85, 0, 1},
-            {11, 86, 0, 1},
-            {2006, 87, 0, 1},
-            {17, 88, 0, 1},
-            {2004, 89, 0, 1},
-            {2002, 90, 0, 1},
-            {82, 91, 0, 1},
-            {2003, 92, 0, 1},
-            {8, 93, 0, 1},
-            {8, 94, 0, 1},
-            {8, 95, 0, 1},
-            {8, 96, 0, 1},
-            {8, 97, 0, 1},
-        }},
-        {"Tricks and Traps (MAP08)", {false, true, true}, {0, 1, 1}, 23, 242, {
-            {1, 0, 0, 1},
-            {2, 1, 0, 1},
-            {3, 2, 0, 1},
-            {4, 3, 0, 1},
-            {11, 4, 0, 1},
-            {3005, 5, 0, 1},
-            {3005, 6, 0, 1},
-            {3005, 7, 0, 1},
-            {3005, 8, 0, 1},
-            {3005, 9, 0, 1},
-            {3005, 10, 0, 1},
-            {3005, 11, 0, 1},
-            {3005, 12, 0, 1},
-            {17, 13, 0, 1},
-            {2004, 14, 0, 0},
-            {2046, 15, 0, 1},
-            {2046, 16, 0, 1},
-            {2003, 17, 0, 0},
-            {3002, 18, 0, 1},
-            {3002, 19, 0, 1},
-            {3002, 20, 0, 1},
-            {3002, 21, 0, 1},
-            {3002, 22, 0, 1},
-            {3002, 23, 0, 1},
-            {3002, 24, 0, 1},
-            {3002, 25, 0, 1},
-            {3002, 26, 0, 1},
-            {3002, 27, 0, 1},
-            {3002, 28, 0, 1},
-            {3002, 29, 0, 1},
-            {3002, 30, 0, 1},
-            {3002, 31, 0, 1},
-            {3002, 32, 0, 1},
-            {3002, 33, 0, 1},
-            {3002, 34, 0, 1},
-            {3002, 35, 0, 1},
-            {2018, 36, 0, 0},
-            {2012, 37, 0, 1},
-            {2011, 38, 0, 1},
-            {2011, 39, 0, 1},
-            {2011, 40, 0, 1},
-            {2011, 41, 0, 1},
-            {9, 42, 0, 1},
-            {14, 43, 0, 1},
-            {14, 44, 0, 1},
-            {14, 45, 0, 1},
-            {14, 46, 0, 1},
-            {14, 47, 0, 1},
-            {2002, 48, 0, 0},
-            {2048, 49, 0, 1},
-            {2048, 50, 0, 1},
-            {2012, 51, 0, 1},
-            {27, 52, 0, 1},
-            {27, 53, 0, 1},
-            {2025, 54, 0, 1},
-            {2025, 55, 0, 1},
-            {2046, 56, 0, 1},
-            {2047, 57, 0, 1},
-            {3005, 58, 0, 1},
-            {58, 59, 0, 1},
-            {58, 60, 0, 1},
-            {14, 61, 0, 1},
-            {3001, 62, 0, 1},
-            {3001, 63, 0, 1},
-            {3001, 64, 0, 1},
-            {3001, 65, 0, 1},
-            {3001, 66, 0, 1},
-            {3001, 67, 0, 1},
-            {3001, 68, 0, 1},
-            {3001, 69, 0, 1},
-            {3001, 70, 0, 1},
-            {3001, 71, 0, 1},
-            {3001, 72, 0, 1},
-            {3001, 73, 0, 1},
-            {3001, 74, 0, 1},
-            {3001, 75, 0, 1},
-            {3001, 76, 0, 1},
-            {3001, 77, 0, 1},
-            {3001, 78, 0, 1},
-            {3001, 79, 0, 1},
-            {3001, 80, 0, 1},
-            {3001, 81, 0, 1},
-            {3001, 82, 0, 1},
-            {3001, 83, 0, 1},
-            {3001, 84, 0, 1},
-            {3001, 85, 0, 1},
-            {3001, 86, 0, 1},
-            {2001, 87, 0, 0},
-            {2049, 88, 0, 1},
-            {2049, 89, 0, 1},
-            {2008, 90, 0, 1},
-            {2008, 91, 0, 1},
-            {3001, 92, 0, 1},
-            {3001, 93, 0, 1},
-            {3001, 94, 0, 1},
-            {3001, 95, 0, 1},
-            {3001, 96, 0, 1},
-            {3001, 97, 0, 1},
-            {58, 98, 0, 1},
-            {3005, 99, 0, 1},
-            {16, 100, 0, 1},
-            {3003, 101, 0, 1},
-            {3003, 102, 0, 1},
-            {3003, 103, 0, 1},
-            {3003, 104, 0, 1},
-            {3003, 105, 0, 1},
-            {3003, 106, 0, 1},
-            {3003, 107, 0, 1},
-            {3003, 108, 0, 1},
-            {3003, 109, 0, 1},
-            {3003, 110, 0, 1},
-            {3003, 111, 0, 1},
-            {3003, 112, 0, 1},
-            {3003, 113, 0, 1},
-            {3003, 114, 0, 1},
-            {3003, 115, 0, 1},
-            {3003, 116, 0, 1},
-            {3003, 117, 0, 1},
-            {2046, 118, 0, 1},
-            {2013, 119, 0, 0},
-            {2022, 120, 0, 0},
-            {34, 121, 0, 1},
-            {2022, 122, 0, 0},
-            {39, 123, 0, 0},
-            {71, 124, 0, 1},
-            {71, 125, 0, 1},
-            {71, 126, 0, 1},
-            {71, 127, 0, 1},
-            {3006, 128, 0, 1},
-            {3006, 129, 0, 1},
-            {2048, 130, 0, 1},
-            {2012, 131, 0, 1},
-            {14, 132, 0, 1},
-            {8, 133, 0, 0},
-            {8, 134, 0, 0},
-            {2022, 135, 0, 0},
-            {2022, 136, 0, 0},
-            {3002, 137, 0, 1},
-            {3002, 138, 0, 1},
-            {3002, 139, 0, 1},
-            {3002, 140, 0, 1},
-            {3002, 141, 0, 1},
-            {3002, 142, 0, 1},
-            {3002, 143, 0, 1},
-            {3002, 144, 0, 1},
-            {3002, 145, 0, 1},
-            {3002, 146, 0, 1},
-            {3002, 147, 0, 1},
-            {3002, 148, 0, 1},
-            {3002, 149, 0, 1},
-            {3002, 150, 0, 1},
-            {3002, 151, 0, 1},
-            {3002, 152, 0, 1},
-            {3002, 153, 0, 1},
-            {3002, 154, 0, 1},
-            {3002, 155, 0, 1},
-            {3002, 156, 0, 1},
-            {3002, 157, 0, 1},
-            {3002, 158, 0, 1},
-            {3002, 159, 0, 1},
-            {3002, 160, 0, 1},
-            {2006, 161, 0, 0},
-            {2013, 162, 0, 0},
-            {8, 163, 0, 0},
-            {8, 164, 0, 0},
-            {9, 165, 0, 1},
-            {34, 166, 0, 1},
-            {34, 167, 0, 1},
-            {2005, 168, 0, 0},
-            {3003, 169, 0, 1},
-            {3005, 170, 0, 1},
-            {3005, 171, 0, 1},
-            {2048, 172, 0, 1},
-            {2010, 173, 0, 1},
-            {2047, 174, 0, 1},
-            {14, 175, 0, 1},
-            {38, 176, 0, 0},
-            {2046, 177, 0, 1},
-            {3001, 178, 0, 1},
-            {3001, 179, 0, 1},
-            {3001, 180, 0, 1},
-            {3001, 181, 0, 1},
-            {3001, 182, 0, 1},
-            {3001, 183, 0, 1},
-            {3001, 184, 0, 1},
-            {3001, 185, 0, 1},
-            {3001, 186, 0, 1},
-            {3001, 187, 0, 1},
-            {3001, 188, 0, 1},
-            {3001, 189, 0, 1},
-            {3001, 190, 0, 1},
-            {3001, 191, 0, 1},
-            {3001, 192, 0, 1},
-            {3001, 193, 0, 1},
-            {3001, 194, 0, 1},
-            {3001, 195, 0, 1},
-            {3001, 196, 0, 1},
-            {3001, 197, 0, 1},
-            {3001, 198, 0, 1},
-            {3001, 199, 0, 1},
-            {3001, 200, 0, 1},
-            {3001, 201, 0, 1},
-            {2022, 202, 0, 0},
-            {3002, 203, 0, 1},
-            {2011, 204, 0, 1},
-            {2011, 205, 0, 1},
-            {2011, 206, 0, 1},
-            {2011, 207, 0, 1},
-            {2011, 208, 0, 1},
-            {2011, 209, 0, 1},
-            {2049, 210, 0, 1},
-            {2048, 211, 0, 1},
-            {2047, 212, 0, 1},
-            {2010, 213, 0, 1},
-            {2010, 214, 0, 1},
-            {2010, 215, 0, 1},
-            {2010, 216, 0, 1},
-            {3003, 217, 0, 1},
-            {3003, 218, 0, 1},
-            {2047, 219, 0, 1},
-            {2018, 220, 0, 0},
-            {2049, 221, 0, 1},
-            {2048, 222, 0, 1},
-            {2010, 223, 0, 1},
-            {2012, 224, 0, 1},
-            {2012, 225, 0, 1},
-            {8, 226, 0, 0},
-            {9, 227, 0, 1},
-            {9, 228, 0, 1},
-            {9, 229, 0, 1},
-            {11, 230, 0, 1},
-            {11, 231, 0, 1},
-            {11, 232, 0, 1},
-            {11, 233, 0, 1},
-            {11, 234, 0, 1},
-            {2024, 235, 0, 0},
-            {34, 236, 0, 1},
-            {14, 237, 0, 1},
-            {14, 238, 0, 1},
-            {2007, 239, 0, 1},
-            {2007, 240, 0, 1},
-            {2008, 241, 0, 1},
-        }},
-        {"The Pit (MAP09)", {true, true, false}, {0, 0, 0}, 15, 392, {
-            {1, 0, 0, 1},
-            {2, 1, 0, 1},
-            {3, 2, 0, 1},
-            {4, 3, 0, 1},
-            {67, 4, 0, 1},
-            {2023, 5, 0, 0},
-            {2046, 6, 0, 1},
-            {3001, 7, 0, 1},
-            {3001, 8, 0, 1},
-            {71, 9, 0, 1},
-            {3005, 10, 0, 1},
-            {71, 11, 0, 1},
-            {3001, 12, 0, 1},
-            {3001, 13, 0, 1},
-            {3001, 14, 0, 1},
-            {3001, 15, 0, 1},
-            {58, 16, 0, 1},
-            {3001, 17, 0, 1},
-            {3001, 18, 0, 1},
-            {3001, 19, 0, 1},
-            {3001, 20, 0, 1},
-            {2001, 21, 0, 0},
-            {11, 22, 0, 1},
-            {11, 23, 0, 1},
-            {11, 24, 0, 1},
-            {11, 25, 0, 1},
-            {2019, 26, 0, 0},
-            {44, 27, 0, 1},
-            {3001, 28, 0, 1},
-            {3001, 29, 0, 1},
-            {3001, 30, 0, 1},
-            {3001, 31, 0, 1},
-            {3001, 32, 0, 1},
-            {9, 33, 0, 1},
-            {9, 34, 0, 1},
-            {9, 35, 0, 1},
-            {9, 36, 0, 1},
-            {9, 37, 0, 1},
-            {9, 38, 0, 1},
-            {9, 39, 0, 1},
-            {9, 40, 0, 1},
-            {3004, 41, 0, 1},
-            {3004, 42, 0, 1},
-            {3001, 43, 0, 1},
-            {3001, 44, 0, 1},
-            {3004, 45, 0, 1},
-            {3004, 46, 0, 1},
-            {3004, 47, 0, 1},
-            {3004, 48, 0, 1},
-            {3001, 49, 0, 1},
-            {3001, 50, 0, 1},
-            {3004, 51, 0, 1},
-            {3004, 52, 0, 1},
-            {3001, 53, 0, 1},
-            {3001, 54, 0, 1},
-            {3001, 55, 0, 1},
-            {3001, 56, 0, 1},
-            {3001, 57, 0, 1},
-            {3001, 58, 0, 1},
-            {3001, 59, 0, 1},
-            {3001, 60, 0, 1},
-            {2049, 61, 0, 1},
-            {2011, 62, 0, 1},
-            {2011, 63, 0, 1},
-            {2002, 64, 0, 1},
-            {2048, 65, 0, 1},
-            {2048, 66, 0, 1},
-            {69, 67, 0, 1},
-            {3001, 68, 0, 1},
-            {3001, 69, 0, 1},
-            {3001, 70, 0, 1},
-            {3001, 71, 0, 1},
-            {3001, 72, 0, 1},
-            {3001, 73, 0, 1},
-            {3001, 74, 0, 1},
-            {3001, 75, 0, 1},
-            {3001, 76, 0, 1},
-            {2010, 77, 0, 1},
-            {2013, 78, 0, 0},
-            {3006, 79, 0, 1},
-            {3006, 80, 0, 1},
-            {3006, 81, 0, 1},
-            {3006, 82, 0, 1},
-            {3006, 83, 0, 1},
-            {71, 84, 0, 1},
-            {2012, 85, 0, 1},
-            {2012, 86, 0, 1},
-            {2012, 87, 0, 1},
-            {2012, 88, 0, 1},
-            {2012, 89, 0, 1},
-            {2023, 90, 0, 0},
-            {2046, 91, 0, 1},
-            {2003, 92, 0, 0},
-            {3001, 93, 0, 1},
-            {3001, 94, 0, 1},
-            {3001, 95, 0, 1},
-            {3001, 96, 0, 1},
-            {3001, 97, 0, 1},
-            {3001, 98, 0, 1},
-            {3001, 99, 0, 1},
-            {3001, 100, 0, 1},
-            {3001, 101, 0, 1},
-            {3001, 102, 0, 1},
-            {3006, 103, 0, 1},
-            {3006, 104, 0, 1},
-            {3006, 105, 0, 1},
-            {3006, 106, 0, 1},
-            {3006, 107, 0, 1},
-            {3006, 108, 0, 1},
-            {3006, 109, 0, 1},
-            {3006, 110, 0, 1},
-            {3006, 111, 0, 1},
-            {2011, 112, 0, 1},
-            {2011, 113, 0, 1},
-            {2047, 114, 0, 1},
-            {2047, 115, 0, 1},
-            {2047, 116, 0, 1},
-            {2047, 117, 0, 1},
-            {3001, 118, 0, 1},
-            {3001, 119, 0, 1},
-            {3001, 120, 0, 1},
-            {69, 121, 0, 1},
-            {69, 122, 0, 1},
-            {3005, 123, 0, 1},
-            {3005, 124, 0, 1},
-            {3005, 125, 0, 1},
-            {3005, 126, 0, 1},
-            {3001, 127, 0, 1},
-            {3001, 128, 0, 1},
-            {3001, 129, 0, 1},
-            {3001, 130, 0, 1},
-            {3001, 131, 0, 1},
-            {3001, 132, 0, 1},
-            {9, 133, 0, 1},
-            {9, 134, 0, 1},
-            {9, 135, 0, 1},
-            {9, 136, 0, 1},
-            {9, 137, 0, 1},
-            {9, 138, 0, 1},
-            {9, 139, 0, 1},
-            {9, 140, 0, 1},
-            {9, 141, 0, 1},
-            {3006, 142, 0, 1},
-            {3001, 143, 0, 1},
-            {67, 144, 0, 1},
-            {67, 145, 0, 1},
-            {2011, 146, 0, 1},
-            {2011, 147, 0, 1},
-            {2011, 148, 0, 1},
-            {2011, 149, 0, 1},
-            {2011, 150, 0, 1},
-            {2011, 151, 0, 1},
-            {2011, 152, 0, 1},
-            {2011, 153, 0, 1},
-            {2046, 154, 0, 1},
-            {2046, 155, 0, 1},
-            {2010, 156, 0, 1},
-            {9, 157, 0, 1},
-            {9, 158, 0, 1},
-            {9, 159, 0, 1},
-            {9, 160, 0, 1},
-            {9, 161, 0, 1},
-            {9, 162, 0, 1},
-            {9, 163, 0, 1},
-            {9, 164, 0, 1},
-            {65, 165, 0, 1},
-            {65, 166, 0, 1},
-            {65, 167, 0, 1},
-            {65, 168, 0, 1},
-            {3006, 169, 0, 1},
-            {65, 170, 0, 1},
-            {65, 171, 0, 1},
-            {3006, 172, 0, 1},
-            {65, 173, 0, 1},
-            {65, 174, 0, 1},
-            {65, 175, 0, 1},
-            {3006, 176, 0, 1},
-            {65, 177, 0, 1},
-            {65, 178, 0, 1},
-            {65, 179, 0, 1},
-            {3006, 180, 0, 1},
-            {65, 181, 0, 1},
-            {3006, 182, 0, 1},
-            {71, 183, 0, 1},
-            {2006, 184, 0, 0},
-            {5, 185, 0, 0},
-            {2014, 186, 0, 1},
-            {2014, 187, 0, 1},
-            {2014, 188, 0, 1},
-            {2014, 189, 0, 1},
-            {2014, 190, 0, 1},
-            {2014, 191, 0, 1},
-            {3001, 192, 0, 1},
-            {3001, 193, 0, 1},
-            {3001, 194, 0, 1},
-            {3001, 195, 0, 1},
-            {3001, 196, 0, 1},
-            {3001, 197, 0, 1},
-            {3001, 198, 0, 1},
-            {71, 199, 0, 1},
-            {71, 200, 0, 1},
-            {3001, 201, 0, 1},
-            {3001, 202, 0, 1},
-            {3001, 203, 0, 1},
-            {3001, 204, 0, 1},
-            {3001, 205, 0, 1},
-            {3001, 206, 0, 1},
-            {3001, 207, 0, 1},
-            {3001, 208, 0, 1},
-            {3001, 209, 0, 1},
-            {3001, 210, 0, 1},
-            {3001, 211, 0, 1},
-            {3001, 212, 0, 1},
-            {3001, 213, 0, 1},
-            {3001, 214, 0, 1},
-            {3001, 215, 0, 1},
-            {3002, 216, 0, 1},
-            {3002, 217, 0, 1},
-            {3002, 218, 0, 1},
-            {2025, 219, 0, 1},
-            {3002, 220, 0, 1},
-            {3002, 221, 0, 1},
-            {3002, 222, 0, 1},
-            {3002, 223, 0, 1},
-            {3002, 224, 0, 1},
-            {3002, 225, 0, 1},
-            {6, 226, 0, 0},
-            {2014, 227, 0, 1},
-            {2014, 228, 0, 1},
-            {2014, 229, 0, 1},
-            {2014, 230, 0, 1},
-            {2014, 231, 0, 1},
-            {2014, 232, 0, 1},
-            {2014, 233, 0, 1},
-            {2014, 234, 0, 1},
-            {2014, 235, 0, 1},
-            {2014, 236, 0, 1},
-            {2007, 237, 0, 1},
-            {2007, 238, 0, 1},
-            {2007, 239, 0, 1},
-            {2010, 240, 0, 1},
-            {2012, 241, 0, 1},
-            {2012, 242, 0, 1},
-            {2012, 243, 0, 1},
-            {8, 244, 0, 0},
-            {2026, 245, 0, 0},
-            {2047, 246, 0, 1},
-            {71, 247, 0, 1},
-            {71, 248, 0, 1},
-            {14, 249, 0, 1},
-            {2013, 250, 0, 0},
-            {2019, 251, 0, 0},
-            {14, 252, 0, 1},
-            {9, 253, 0, 1},
-            {9, 254, 0, 1},
-            {9, 255, 0, 1},
-            {9, 256, 0, 1},
-            {9, 257, 0, 1},
-            {9, 258, 0, 1},
-            {9, 259, 0, 1},
-            {9, 260, 0, 1},
-            {9, 261, 0, 1},
-            {9, 262, 0, 1},
-            {3001, 263, 0, 1},
-            {3001, 264, 0, 1},
-            {3001, 265, 0, 1},
-            {3001, 266, 0, 1},
-            {3001, 267, 0, 1},
-            {3001, 268, 0, 1},
-            {3001, 269, 0, 1},
-            {3001, 270, 0, 1},
-            {3001, 271, 0, 1},
-            {3001, 272, 0, 1},
-            {3001, 273, 0, 1},
-            {3001, 274, 0, 1},
-            {3001, 275, 0, 1},
-            {3001, 276, 0, 1},
-            {3001, 277, 0, 1},
-            {3001, 278, 0, 1},
-            {3001, 279, 0, 1},
-            {3001, 280, 0, 1},
-            {3001, 281, 0, 1},
-            {3001, 282, 0, 1},
-            {3006, 283, 0, 1},
-            {3006, 284, 0, 1},
-            {3006, 285, 0, 1},
-            {3006, 286, 0, 1},
-            {3006, 287, 0, 1},
-            {3006, 288, 0, 1},
-            {3006, 289, 0, 1},
-            {3006, 290, 0, 1},
-            {3006, 291, 0, 1},
-            {3006, 292, 0, 1},
-            {3006, 293, 0, 1},
-            {3006, 294, 0, 1},
-            {2011, 295, 0, 1},
-            {2011, 296, 0, 1},
-            {2011, 297, 0, 1},
-            {2007, 298, 0, 1},
-            {2008, 299, 0, 1},
-            {2014, 300, 0, 1},
-            {2014, 301, 0, 1},
-            {2014, 302, 0, 1},
-            {2014, 303, 0, 1},
-            {2014, 304, 0, 1},
-            {2014, 305, 0, 1},
-            {2014, 306, 0, 1},
-            {2014, 307, 0, 1},
-            {2004, 308, 0, 1},
-            {2023, 309, 0, 0},
-            {2047, 310, 0, 1},
-            {2047, 311, 0, 1},
-            {2046, 312, 0, 1},
-            {2005, 313, 0, 1},
-            {11, 314, 0, 1},
-            {11, 315, 0, 1},
-            {11, 316, 0, 1},
-            {65, 317, 0, 1},
-            {65, 318, 0, 1},
-            {65, 319, 0, 1},
-            {65, 320, 0, 1},
-            {9, 321, 0, 1},
-            {9, 322, 0, 1},
-            {9, 323, 0, 1},
-            {3001, 324, 0, 1},
-            {3001, 325, 0, 1},
-            {3001, 326, 0, 1},
-            {3001, 327, 0, 1},
-            {3001, 328, 0, 1},
-            {3001, 329, 0, 1},
-            {3001, 330, 0, 1},
-            {2047, 331, 0, 1},
-            {2012, 332, 0, 1},
-            {2011, 333, 0, 1},
-            {2011, 334, 0, 1},
-            {2011, 335, 0, 1},
-            {2011, 336, 0, 1},
-            {2011, 337, 0, 1},
-            {2007, 338, 0, 1},
-            {2007, 339, 0, 1},
-            {2007, 340, 0, 1},
-            {2007, 341, 0, 1},
-            {2008, 342, 0, 1},
-            {2008, 343, 0, 1},
-            {2007, 344, 0, 1},
-            {2007, 345, 0, 1},
-            {2007, 346, 0, 1},
-            {2012, 347, 0, 1},
-            {2018, 348, 0, 0},
-            {31, 349, 0, 1},
-            {31, 350, 0, 1},
-            {31, 351, 0, 1},
-            {31, 352, 0, 1},
-            {2012, 353, 0, 1},
-            {71, 354, 0, 1},
-            {3001, 355, 0, 1},
-            {3001, 356, 0, 1},
-            {3005, 357, 0, 1},
-            {67, 358, 0, 1},
-            {67, 359, 0, 1},
-            {71, 360, 0, 1},
-            {58, 361, 0, 1},
-            {58, 362, 0, 1},
-            {58, 363, 0, 1},
-            {58, 364, 0, 1},
-            {69, 365, 0, 1},
-            {2008, 366, 0, 1},
-            {2008, 367, 0, 1},
-            {2008, 368, 0, 1},
-            {2008, 369, 0, 1},
-            {82, 370, 0, 1},
-            {3001, 371, 0, 1},
-            {3001, 372, 0, 1},
-            {58, 373, 0, 1},
-            {3006, 374, 0, 1},
-            {2014, 375, 0, 1},
-            {2014, 376, 0, 1},
-            {2014, 377, 0, 1},
-            {2014, 378, 0, 1},
-            {2014, 379, 0, 1},
-            {2014, 380, 0, 1},
-            {2014, 381, 0, 1},
-            {2014, 382, 0, 1},
-            {2014, 383, 0, 1},
-            {2014, 384, 0, 1},
-            {2014, 385, 0, 1},
-            {2014, 386, 0, 1},
-            {2014, 387, 0, 1},
-            {2014, 388, 0, 1},
-            {2014, 389, 0, 1},
-            {2014, 390, 0, 1},
-            {2014, 391, 0, 1},
-        }},
-        {"Refueling Base (MAP10)", {true, true, false}, {0, 0, 0}, 20, 509, {
-            {2, 0, 0, 1},
-            {3, 1, 0, 1},
-            {4, 2, 0, 1},
-            {1, 3, 0, 1},
-            {3001, 4, 0, 1},
-            {3001, 5, 0, 1},
-            {3001, 6, 0, 1},
-            {3001, 7, 0, 1},
-            {3001, 8, 0, 1},
-            {3001, 9, 0, 1},
-            {3001, 10, 0, 1},
-            {3002, 11, 0, 1},
-            {3002, 12, 0, 1},
-            {3002, 13, 0, 1},
-            {3002, 14, 0, 1},
-            {3002, 15, 0, 1},
-            {3001, 16, 0, 1},
-            {2006, 17, 0, 0},
-            {2046, 18, 0, 1},
-            {2012, 19, 0, 1},
-            {2048, 20, 0, 1},
-            {3002, 21, 0, 1},
-            {3002, 22, 0, 1},
-            {3002, 23, 0, 1},
-            {3002, 24, 0, 1},
-            {66, 25, 0, 1},
-            {68, 26, 0, 1},
-            {66, 27, 0, 1},
-            {2013, 28, 0, 0},
-            {2004, 29, 0, 0},
-            {2047, 30, 0, 1},
-            {3001, 31, 0, 1},
-            {3001, 32, 0, 1},
-            {3001, 33, 0, 1},
-            {2014, 34, 0, 1},
-            {2014, 35, 0, 1},
-            {2014, 36, 0, 1},
-            {2008, 37, 0, 1},
-            {3001, 38, 0, 1},
-            {3001, 39, 0, 1},
-            {3001, 40, 0, 1},
-            {2007, 41, 0, 1},
-            {2014, 42, 0, 1},
-            {3001, 43, 0, 1},
-            {3001, 44, 0, 1},
-            {3001, 45, 0, 1},
-            {3001, 46, 0, 1},
-            {3001, 47, 0, 1},
-            {3001, 48, 0, 1},
-            {3001, 49, 0, 1},
-            {5, 50, 0, 0},
-            {2014, 51, 0, 1},
-            {2014, 52, 0, 1},
-            {2014, 53, 0, 1},
-            {2014, 54, 0, 1},
-            {2014, 55, 0, 1},
-            {2015, 56, 0, 1},
-            {2007, 57, 0, 1},
-            {2012, 58, 0, 1},
-            {3002, 59, 0, 1},
-            {3002, 60, 0, 1},
-            {3002, 61, 0, 1},
-            {3002, 62, 0, 1},
-            {3004, 63, 0, 1},
-            {9, 64, 0, 1},
-            {3004, 65, 0, 1},
-            {3004, 66, 0, 1},
-            {9, 67, 0, 1},
-            {3004, 68, 0, 1},
-            {9, 69, 0, 1},
-            {3004, 70, 0, 1},
-            {3004, 71, 0, 1},
-            {3004, 72, 0, 1},
-            {9, 73, 0, 1},
-            {3004, 74, 0, 1},
-            {3004, 75, 0, 1},
-            {3004, 76, 0, 1},
-            {3004, 77, 0, 1},
-            {3004, 78, 0, 1},
-            {3004, 79, 0, 1},
-            {3004, 80, 0, 1},
-            {3004, 81, 0, 1},
-            {3004, 82, 0, 1},
-            {3006, 83, 0, 1},
-            {3006, 84, 0, 1},
-            {3001, 85, 0, 1},
-            {3001, 86, 0, 1},
-            {3001, 87, 0, 1},
-            {3001, 88, 0, 1},
-            {3001, 89, 0, 1},
-            {3001, 90, 0, 1},
-            {3004, 91, 0, 1},
-            {9, 92, 0, 1},
-            {3004, 93, 0, 1},
-            {3004, 94, 0, 1},
-            {9, 95, 0, 1},
-            {3004, 96, 0, 1},
-            {9, 97, 0, 1},
-            {3004, 98, 0, 1},
-            {2001, 99, 0, 0},
-            {2008, 100, 0, 1},
-            {2008, 101, 0, 1},
-            {2008, 102, 0, 1},
-            {2008, 103, 0, 1},
-            {2008, 104, 0, 1},
-            {2008, 105, 0, 1},
-            {2012, 106, 0, 1},
-            {2007, 107, 0, 1},
-            {2048, 108, 0, 1},
-            {2048, 109, 0, 1},
-            {2049, 110, 0, 1},
-            {2007, 111, 0, 1},
-            {2011, 112, 0, 1},
-            {2011, 113, 0, 1},
-            {2011, 114, 0, 1},
-            {2011, 115, 0, 1},
-            {2011, 116, 0, 1},
-            {2008, 117, 0, 1},
-            {3001, 118, 0, 1},
-            {3001, 119, 0, 1},
-            {3001, 120, 0, 1},
-            {3001, 121, 0, 1},
-            {3001, 122, 0, 1},
-            {3001, 123, 0, 1},
-            {3001, 124, 0, 1},
-            {3001, 125, 0, 1},
-            {3001, 126, 0, 1},
-            {3001, 127, 0, 1},
-            {3001, 128, 0, 1},
-            {3001, 129, 0, 1},
-            {3001, 130, 0, 1},
-            {3004, 131, 0, 1},
-            {3004, 132, 0, 1},
-            {3004, 133, 0, 1},
-            {3004, 134, 0, 1},
-            {3004, 135, 0, 1},
-            {9, 136, 0, 1},
-            {9, 137, 0, 1},
-            {3001, 138, 0, 1},
-            {3001, 139, 0, 1},
-            {3004, 140, 0, 1},
-            {3004, 141, 0, 1},
-            {3004, 142, 0, 1},
-            {3004, 143, 0, 1},
-            {3004, 144, 0, 1},
-            {3004, 145, 0, 1},
-            {3002, 146, 0, 1},
-            {3002, 147, 0, 1},
-            {3002, 148, 0, 1},
-            {3002, 149, 0, 1},
-            {3001, 150, 0, 1},
-            {3001, 151, 0, 1},
-            {3001, 152, 0, 1},
-            {71, 153, 0, 1},
-            {58, 154, 0, 1},
-            {58, 155, 0, 1},
-            {58, 156, 0, 1},
-            {58, 157, 0, 1},
-            {2002, 158, 0, 0},
-            {2011, 159, 0, 1},
-            {2011, 160, 0, 1},
-            {2011, 161, 0, 1},
-            {2011, 162, 0, 1},
-            {2011, 163, 0, 1},
-            {2011, 164, 0, 1},
-            {2011, 165, 0, 1},
-            {2011, 166, 0, 1},
-            {2011, 167, 0, 1},
-            {2011, 168, 0, 1},
-            {2011, 169, 0, 1},
-            {2012, 170, 0, 1},
-            {2011, 171, 0, 1},
-            {2018, 172, 0, 0},
-            {2014, 173, 0, 1},
-            {2014, 174, 0, 1},
-            {2014, 175, 0, 1},
-            {2014, 176, 0, 1},
-            {2014, 177, 0, 1},
-            {2015, 178, 0, 1},
-            {2015, 179, 0, 1},
-            {2014, 180, 0, 1},
-            {2014, 181, 0, 1},
-            {2014, 182, 0, 1},
-            {2014, 183, 0, 1},
-            {2014, 184, 0, 1},
-            {2014, 185, 0, 1},
-            {2015, 186, 0, 1},
-            {2015, 187, 0, 1},
-            {2015, 188, 0, 1},
-            {3001, 189, 0, 1},
-            {3001, 190, 0, 1},
-            {66, 191, 0, 1},
-            {66, 192, 0, 1},
-            {71, 193, 0, 1},
-            {71, 194, 0, 1},
-            {2010, 195, 0, 1},
-            {9, 196, 0, 1},
-            {9, 197, 0, 1},
-            {9, 198, 0, 1},
-            {3001, 199, 0, 1},
-            {3001, 200, 0, 1},
-            {3001, 201, 0, 1},
-            {3001, 202, 0, 1},
-            {2047, 203, 0, 1},
-            {2047, 204, 0, 1},
-            {2047, 205, 0, 1},
-            {2047, 206, 0, 1},
-            {2047, 207, 0, 1},
-            {2047, 208, 0, 1},
-            {2047, 209, 0, 1},
-            {2047, 210, 0, 1},
-            {16, 211, 0, 1},
-            {14, 212, 0, 1},
-            {14, 213, 0, 1},
-            {14, 214, 0, 1},
-            {71, 215, 0, 1},
-            {71, 216, 0, 1},
-            {3006, 217, 0, 1},
-            {3001, 218, 0, 1},
-            {3001, 219, 0, 1},
-            {3001, 220, 0, 1},
-            {3001, 221, 0, 1},
-            {71, 222, 0, 1},
-            {71, 223, 0, 1},
-            {3001, 224, 0, 1},
-            {3001, 225, 0, 1},
-            {3001, 226, 0, 1},
-            {3001, 227, 0, 1},
-            {3001, 228, 0, 1},
-            {9, 229, 0, 1},
-            {9, 230, 0, 1},
-            {3004, 231, 0, 1},
-            {3004, 232, 0, 1},
-            {3004, 233, 0, 1},
-            {3004, 234, 0, 1},
-            {3004, 235, 0, 1},
-            {3004, 236, 0, 1},
-            {3001, 237, 0, 1},
-            {3001, 238, 0, 1},
-            {3004, 239, 0, 1},
-            {3004, 240, 0, 1},
-            {3004, 241, 0, 1},
-            {3004, 242, 0, 1},
-            {3004, 243, 0, 1},
-            {9, 244, 0, 1},
-            {9, 245, 0, 1},
-            {3004, 246, 0, 1},
-            {3001, 247, 0, 1},
-            {3001, 248, 0, 1},
-            {2025, 249, 0, 1},
-            {2014, 250, 0, 1},
-            {2014, 251, 0, 1},
-            {2014, 252, 0, 1},
-            {2014, 253, 0, 1},
-            {2014, 254, 0, 1},
-            {2014, 255, 0, 1},
-            {2014, 256, 0, 1},
-            {2014, 257, 0, 1},
-            {2014, 258, 0, 1},
-            {2014, 259, 0, 1},
-            {2014, 260, 0, 1},
-            {2014, 261, 0, 1},
-            {2048, 262, 0, 1},
-            {2048, 263, 0, 1},
-            {2048, 264, 0, 1},
-            {2048, 265, 0, 1},
-            {2008, 266, 0, 1},
-            {2008, 267, 0, 1},
-            {2008, 268, 0, 1},
-            {2008, 269, 0, 1},
-            {2011, 270, 0, 1},
-            {2011, 271, 0, 1},
-            {2011, 272, 0, 1},
-            {2011, 273, 0, 1},
-            {2011, 274, 0, 1},
-            {2011, 275, 0, 1},
-            {3001, 276, 0, 1},
-            {3001, 277, 0, 1},
-            {3001, 278, 0, 1},
-            {3001, 279, 0, 1},
-            {3006, 280, 0, 1},
-            {3006, 281, 0, 1},
-            {3006, 282, 0, 1},
-            {3006, 283, 0, 1},
-            {3006, 284, 0, 1},
-            {3006, 285, 0, 1},
-            {3006, 286, 0, 1},
-            {3006, 287, 0, 1},
-            {3001, 288, 0, 1},
-            {3001, 289, 0, 1},
-            {3001, 290, 0, 1},
-            {2003, 291, 0, 0},
-            {2025, 292, 0, 1},
-            {2025, 293, 0, 1},
-            {2025, 294, 0, 1},
-            {2046, 295, 0, 1},
-            {2046, 296, 0, 1},
-            {2012, 297, 0, 1},
-            {2012, 298, 0, 1},
-            {3004, 299, 0, 1},
-            {3004, 300, 0, 1},
-            {3004, 301, 0, 1},
-            {3004, 302, 0, 1},
-            {3004, 303, 0, 1},
-            {3004, 304, 0, 1},
-            {3004, 305, 0, 1},
-            {3004, 306, 0, 1},
-            {3004, 307, 0, 1},
-            {68, 308, 0, 1},
-            {3001, 309, 0, 1},
-            {3001, 310, 0, 1},
-            {3001, 311, 0, 1},
-            {3001, 312, 0, 1},
-            {3001, 313, 0, 1},
-            {3001, 314, 0, 1},
-            {3001, 315, 0, 1},
-            {3001, 316, 0, 1},
-            {3001, 317, 0, 1},
-            {3001, 318, 0, 1},
-            {3001, 319, 0, 1},
-            {68, 320, 0, 1},
-            {9, 321, 0, 1},
-            {9, 322, 0, 1},
-            {3004, 323, 0, 1},
-            {3004, 324, 0, 1},
-            {3004, 325, 0, 1},
-            {3004, 326, 0, 1},
-            {3004, 327, 0, 1},
-            {3004, 328, 0, 1},
-            {3004, 329, 0, 1},
-            {3004, 330, 0, 1},
-            {3004, 331, 0, 1},
-            {9, 332, 0, 1},
-            {3004, 333, 0, 1},
-            {9, 334, 0, 1},
-            {9, 335, 0, 1},
-            {9, 336, 0, 1},
-            {9, 337, 0, 1},
-            {9, 338, 0, 1},
-            {9, 339, 0, 1},
-            {9, 340, 0, 1},
-            {3004, 341, 0, 1},
-            {3004, 342, 0, 1},
-            {3004, 343, 0, 1},
-            {3004, 344, 0, 1},
-            {3004, 345, 0, 1},
-            {3004, 346, 0, 1},
-            {3004, 347, 0, 1},
-            {3004, 348, 0, 1},
-            {9, 349, 0, 1},
-            {9, 350, 0, 1},
-            {9, 351, 0, 1},
-            {9, 352, 0, 1},
-            {9, 353, 0, 1},
-            {9, 354, 0, 1},
-            {2011, 355, 0, 1},
-            {2011, 356, 0, 1},
-            {2011, 357, 0, 1},
-            {2011, 358, 0, 1},
-            {2013, 359, 0, 0},
-            {3002, 360, 0, 1},
-            {3002, 361, 0, 1},
-            {3002, 362, 0, 1},
-            {3002, 363, 0, 1},
-            {3002, 364, 0, 1},
-            {3002, 365, 0, 1},
-            {3002, 366, 0, 1},
-            {3002, 367, 0, 1},
-            {8, 368, 0, 0},
-            {2014, 369, 0, 1},
-            {2014, 370, 0, 1},
-            {2014, 371, 0, 1},
-            {2015, 372, 0, 1},
-            {2015, 373, 0, 1},
-            {2015, 374, 0, 1},
-            {17, 375, 0, 1},
-            {65, 376, 0, 1},
-            {65, 377, 0, 1},
-            {65, 378, 0, 1},
-            {65, 379, 0, 1},
-            {58, 380, 0, 1},
-            {58, 381, 0, 1},
-            {58, 382, 0, 1},
-            {58, 383, 0, 1},
-            {58, 384, 0, 1},
-            {58, 385, 0, 1},
-            {2010, 386, 0, 1},
-            {2010, 387, 0, 1},
-            {2015, 388, 0, 1},
-            {2015, 389, 0, 1},
-            {2015, 390, 0, 1},
-            {2015, 391, 0, 1},
-            {2023, 392, 0, 0},
-            {2045, 393, 0, 1},
-            {2045, 394, 0, 1},
-            {2019, 395, 0, 0},
-            {2022, 396, 0, 0},
-            {14, 397, 0, 1},
-            {2022, 398, 0, 0},
-            {2048, 399, 0, 1},
-            {2018, 400, 0, 0},
-            {3001, 401, 0, 1},
-            {3001, 402, 0, 1},
-            {3001, 403, 0, 1},
-            {3001, 404, 0, 1},
-            {3001, 405, 0, 1},
-            {3001, 406, 0, 1},
-            {3001, 407, 0, 1},
-            {68, 408, 0, 1},
-            {68, 409, 0, 1},
-            {68, 410, 0, 1},
-            {68, 411, 0, 1},
-            {2015, 412, 0, 1},
-            {2015, 413, 0, 1},
-            {2015, 414, 0, 1},
-            {2015, 415, 0, 1},
-            {2015, 416, 0, 1},
-            {2015, 417, 0, 1},
-            {2015, 418, 0, 1},
-            {2015, 419, 0, 1},
-            {2015, 420, 0, 1},
-            {2015, 421, 0, 1},
-            {2015, 422, 0, 1},
-            {2015, 423, 0, 1},
-            {2015, 424, 0, 1},
-            {2015, 425, 0, 1},
-            {2015, 426, 0, 1},
-            {2015, 427, 0, 1},
-            {2015, 428, 0, 1},
-            {2015, 429, 0, 1},
-            {2015, 430, 0, 1},
-            {2015, 431, 0, 1},
-            {2015, 432, 0, 1},
-            {2010, 433, 0, 1},
-            {2047, 434, 0, 1},
-            {30, 435, 0, 1},
-            {30, 436, 0, 1},
-            {30, 437, 0, 1},
-            {30, 438, 0, 1},
-            {2047, 439, 0, 1},
-            {2046, 440, 0, 1},
-            {2023, 441, 0, 0},
-            {2015, 442, 0, 1},
-            {2015, 443, 0, 1},
-            {2015, 444, 0, 1},
-            {2015, 445, 0, 1},
-            {2015, 446, 0, 1},
-            {2015, 447, 0, 1},
-            {2015, 448, 0, 1},
-            {2015, 449, 0, 1},
-            {2015, 450, 0, 1},
-            {2015, 451, 0, 1},
-            {2015, 452, 0, 1},
-            {2015, 453, 0, 1},
-            {2015, 454, 0, 1},
-            {2015, 455, 0, 1},
-            {2015, 456, 0, 1},
-            {2015, 457, 0, 1},
-            {2015, 458, 0, 1},
-            {2015, 459, 0, 1},
-            {2015, 460, 0, 1},
-            {2015, 461, 0, 1},
-            {3001, 462, 0, 1},
-            {3001, 463, 0, 1},
-            {3001, 464, 0, 1},
-            {3001, 465, 0, 1},
-            {3001, 466, 0, 1},
-            {3001, 467, 0, 1},
-            {2010, 468, 0, 1},
-            {2010, 469, 0, 1},
-            {2024, 470, 0, 0},
-            {2045, 471, 0, 1},
-            {2005, 472, 0, 0},
-            {6, 473, 0, 0},
-            {3002, 474, 0, 1},
-            {3002, 475, 0, 1},
-            {3002, 476, 0, 1},
-            {3002, 477, 0, 1},
-            {3002, 478, 0, 1},
-            {3002, 479, 0, 1},
-            {3006, 480, 0, 1},
-            {3006, 481, 0, 1},
-            {3006, 482, 0, 1},
-            {3006, 483, 0, 1},
-            {3006, 484, 0, 1},
-            {3006, 485, 0, 1},
-            {3006, 486, 0, 1},
-            {3006, 487, 0, 1},
-            {11, 488, 0, 1},
-            {11, 489, 0, 1},
-            {11, 490, 0, 1},
-            {11, 491, 0, 1},
-            {11, 492, 0, 1},
-            {11, 493, 0, 1},
-            {11, 494, 0, 1},
-            {11, 495, 0, 1},
-            {11, 496, 0, 1},
-            {2049, 497, 0, 1},
-            {2008, 498, 0, 1},
-            {2008, 499, 0, 1},
-            {3006, 500, 0, 1},
-            {3006, 501, 0, 1},
-            {82, 502, 0, 1},
-            {8, 503, 0, 1},
-            {8, 504, 0, 1},
-            {8, 505, 0, 1},
-            {8, 506, 0, 1},
-            {83, 507, 0, 0},
-            {3003, 508, 0, 1},
-        }},
-        {"Circle of Death (MAP11)", {true, false, true}, {0, 0, 0}, 14, 238, {
-            {1, 0, 0, 1},
-            {13, 1, 0, 0},
-            {2012, 2, 0, 1},
-            {2012, 3, 0, 1},
-            {82, 4, 0, 1},
-            {17, 5, 0, 1},
-            {45, 6, 0, 1},
-            {45, 7, 0, 1},
-            {45, 8, 0, 1},
-            {45, 9, 0, 1},
-            {56, 10, 0, 1},
-            {56, 11, 0, 1},
-            {56, 12, 0, 1},
-            {56, 13, 0, 1},
-            {2002, 14, 0, 0},
-            {2015, 15, 0, 1},
-            {2015, 16, 0, 1},
-            {2015, 17, 0, 1},
-            {2015, 18, 0, 1},
-            {2015, 19, 0, 1},
-            {2015, 20, 0, 1},
-            {2011, 21, 0, 1},
-            {80, 22, 0, 1},
-            {2013, 23, 0, 0},
-            {3001, 24, 0, 1},
-            {57, 25, 0, 1},
-            {57, 26, 0, 1},
-            {70, 27, 0, 1},
-            {70, 28, 0, 1},
-            {64, 29, 0, 1},
-            {2004, 30, 0, 0},
-            {2048, 31, 0, 1},
-            {2048, 32, 0, 1},
-            {2049, 33, 0, 1},
-            {43, 34, 0, 1},
-            {43, 35, 0, 1},
-            {54, 36, 0, 1},
-            {54, 37, 0, 1},
-            {2012, 38, 0, 1},
-            {2012, 39, 0, 1},
-            {5, 40, 0, 0},
-            {2047, 41, 0, 1},
-            {2018, 42, 0, 0},
-            {44, 43, 0, 1},
-            {44, 44, 0, 1},
-            {2046, 45, 0, 1},
-            {2046, 46, 0, 1},
-            {2046, 47, 0, 1},
-            {2046, 48, 0, 1},
-            {2046, 49, 0, 1},
-            {2001, 50, 0, 0},
-            {2008, 51, 0, 1},
-            {2008, 52, 0, 1},
-            {2008, 53, 0, 1},
-            {2008, 54, 0, 1},
-            {2008, 55, 0, 1},
-            {57, 56, 0, 1},
-            {57, 57, 0, 1},
-            {2019, 58, 0, 0},
-            {2014, 59, 0, 1},
-            {2014, 60, 0, 1},
-            {2014, 61, 0, 1},
-            {2014, 62, 0, 1},
-            {2014, 63, 0, 1},
-            {2014, 64, 0, 1},
-            {2014, 65, 0, 1},
-            {2014, 66, 0, 1},
-            {2014, 67, 0, 1},
-            {2014, 68, 0, 1},
-            {2014, 69, 0, 1},
-            {2024, 70, 0, 0},
-            {46, 71, 0, 1},
-            {25, 72, 0, 1},
-            {26, 73, 0, 1},
-            {80, 74, 0, 1},
-            {80, 75, 0, 1},
-            {2025, 76, 0, 1},
-            {17, 77, 0, 1},
-            {14, 78, 0, 1},
-            {17, 79, 0, 1},
-            {17, 80, 0, 1},
-            {46, 81, 0, 1},
-            {46, 82, 0, 1},
-            {2022, 83, 0, 0},
-            {55, 84, 0, 1},
-            {55, 85, 0, 1},
-            {2003, 86, 0, 0},
-            {14, 87, 0, 1},
-            {8, 88, 0, 0},
-            {71, 89, 0, 1},
-            {71, 90, 0, 1},
-            {46, 91, 0, 1},
-            {46, 92, 0, 1},
-            {46, 93, 0, 1},
-            {46, 94, 0, 1},
-            {3001, 95, 0, 1},
-            {3001, 96, 0, 1},
-            {54, 97, 0, 1},
-            {54, 98, 0, 1},
-            {43, 99, 0, 1},
-            {43, 100, 0, 1},
-            {47, 101, 0, 1},
-            {47, 102, 0, 1},
-            {47, 103, 0, 1},
-            {47, 104, 0, 1},
-            {47, 105, 0, 1},
-            {26, 106, 0, 1},
-            {27, 107, 0, 1},
-            {2013, 108, 0, 0},
-            {14, 109, 0, 1},
-            {2006, 110, 0, 0},
-            {2, 111, 0, 1},
-            {3, 112, 0, 1},
-            {4, 113, 0, 1},
-            {3004, 114, 0, 1},
-            {3004, 115, 0, 1},
-            {3004, 116, 0, 1},
-            {3004, 117, 0, 1},
-            {9, 118, 0, 1},
-            {9, 119, 0, 1},
-            {9, 120, 0, 1},
-            {65, 121, 0, 1},
-            {65, 122, 0, 1},
-            {9, 123, 0, 1},
-            {65, 124, 0, 1},
-            {9, 125, 0, 1},
-            {9, 126, 0, 1},
-            {3005, 127, 0, 1},
-            {11, 128, 0, 1},
-            {11, 129, 0, 1},
-            {11, 130, 0, 1},
-            {11, 131, 0, 1},
-            {11, 132, 0, 1},
-            {11, 133, 0, 1},
-            {11, 134, 0, 1},
-            {3001, 135, 0, 1},
-            {3001, 136, 0, 1},
-            {3001, 137, 0, 1},
-            {9, 138, 0, 1},
-            {9, 139, 0, 1},
-            {9, 140, 0, 1},
-            {68, 141, 0, 1},
-            {68, 142, 0, 1},
-            {3005, 143, 0, 1},
-            {3005, 144, 0, 1},
-            {3001, 145, 0, 1},
-            {3001, 146, 0, 1},
-            {3001, 147, 0, 1},
-            {3004, 148, 0, 1},
-            {3004, 149, 0, 1},
-            {3004, 150, 0, 1},
-            {3004, 151, 0, 1},
-            {2048, 152, 0, 1},
-            {2048, 153, 0, 1},
-            {2008, 154, 0, 1},
-            {2008, 155, 0, 1},
-            {3001, 156, 0, 1},
-            {69, 157, 0, 1},
-            {2048, 158, 0, 1},
-            {2048, 159, 0, 1},
-            {2047, 160, 0, 1},
-            {2047, 161, 0, 1},
-            {9, 162, 0, 1},
-            {71, 163, 0, 1},
-            {58, 164, 0, 1},
-            {58, 165, 0, 1},
-            {58, 166, 0, 1},
-            {58, 167, 0, 1},
-            {58, 168, 0, 1},
-            {58, 169, 0, 1},
-            {58, 170, 0, 1},
-            {3001, 171, 0, 1},
-            {2049, 172, 0, 1},
-            {2049, 173, 0, 1},
-            {2011, 174, 0, 1},
-            {2011, 175, 0, 1},
-            {2011, 176, 0, 1},
-            {2011, 177, 0, 1},
-            {2011, 178, 0, 1},
-            {2011, 179, 0, 1},
-            {2011, 180, 0, 1},
-            {2011, 181, 0, 1},
-            {2012, 182, 0, 1},
-            {2012, 183, 0, 1},
-            {2012, 184, 0, 1},
-            {69, 185, 0, 1},
-            {3001, 186, 0, 1},
-            {65, 187, 0, 1},
-            {9, 188, 0, 1},
-            {9, 189, 0, 1},
-            {58, 190, 0, 1},
-            {58, 191, 0, 1},
-            {58, 192, 0, 1},
-            {66, 193, 0, 1},
-            {3002, 194, 0, 1},
-            {3006, 195, 0, 1},
-            {3006, 196, 0, 1},
-            {3006, 197, 0, 1},
-            {3006, 198, 0, 1},
-            {3006, 199, 0, 1},
-            {3006, 200, 0, 1},
-            {3006, 201, 0, 1},
-            {3006, 202, 0, 1},
-            {3006, 203, 0, 1},
-            {71, 204, 0, 1},
-            {3005, 205, 0, 1},
-            {3005, 206, 0, 1},
-            {3005, 207, 0, 1},
-            {3005, 208, 0, 1},
-            {3005, 209, 0, 1},
-            {9, 210, 0, 1},
-            {3001, 211, 0, 1},
-            {3001, 212, 0, 1},
-            {58, 213, 0, 1},
-            {58, 214, 0, 1},
-            {68, 215, 0, 1},
-            {2012, 216, 0, 1},
-            {2012, 217, 0, 1},
-            {2012, 218, 0, 1},
-            {2012, 219, 0, 1},
-            {2012, 220, 0, 1},
-            {2012, 221, 0, 1},
-            {2012, 222, 0, 1},
-            {2025, 223, 0, 1},
-            {3005, 224, 0, 1},
-            {3005, 225, 0, 1},
-            {2012, 226, 0, 1},
-            {2012, 227, 0, 1},
-            {2012, 228, 0, 1},
-            {2012, 229, 0, 1},
-            {2011, 230, 0, 1},
-            {2011, 231, 0, 1},
-            {2011, 232, 0, 1},
-            {2011, 233, 0, 1},
-            {2011, 234, 0, 1},
-            {2023, 235, 0, 1},
-            {17, 236, 0, 1},
-            {16, 237, 0, 1},
-        }},
-    },
-    {
-        {"The Factory (MAP12)", {true, true, false}, {0, 0, 0}, 15, 195, {
-            {1, 0, 0, 1},
-            {2, 1, 0, 1},
-            {3, 2, 0, 1},
-            {4, 3, 0, 1},
-            {3001, 4, 0, 1},
-            {3001, 5, 0, 1},
-            {3001, 6, 0, 1},
-            {3001, 7, 0, 1},
-            {3001, 8, 0, 1},
-            {3001, 9, 0, 1},
-            {3001, 10, 0, 1},
-            {3001, 11, 0, 1},
-            {3001, 12, 0, 1},
-            {3001, 13, 0, 1},
-            {2001, 14, 0, 0},
-            {2049, 15, 0, 1},
-            {3001, 16, 0, 1},
-            {3001, 17, 0, 1},
-            {3001, 18, 0, 1},
-            {3001, 19, 0, 1},
-            {3001, 20, 0, 1},
-            {3001, 21, 0, 1},
-            {3001, 22, 0, 1},
-            {3001, 23, 0, 1},
-            {3001, 24, 0, 1},
-            {3001, 25, 0, 1},
-            {3001, 26, 0, 1},
-            {3001, 27, 0, 1},
-            {3001, 28, 0, 1},
-            {3001, 29, 0, 1},
-            {3001, 30, 0, 1},
-            {3001, 31, 0, 1},
-            {3001, 32, 0, 1},
-            {2012, 33, 0, 1},
-            {2049, 34, 0, 1},
-            {2023, 35, 0, 0},
-            {2049, 36, 0, 1},
-            {2012, 37, 0, 1},
-            {2002, 38, 0, 0},
-            {2007, 39, 0, 1},
-            {3001, 40, 0, 1},
-            {3001, 41, 0, 1},
-            {3001, 42, 0, 1},
-            {3005, 43, 0, 1},
-            {3003, 44, 0, 1},
-            {3001, 45, 0, 1},
-            {3001, 46, 0, 1},
-            {68, 47, 0, 1},
-            {3001, 48, 0, 1},
-            {3001, 49, 0, 1},
-            {3001, 50, 0, 1},
-            {3001, 51, 0, 1},
-            {2013, 52, 0, 0},
-            {14, 53, 0, 1},
-            {5, 54, 0, 0},
-            {67, 55, 0, 1},
-            {9, 56, 0, 1},
-            {9, 57, 0, 1},
-            {9, 58, 0, 1},
-            {9, 59, 0, 1},
-            {9, 60, 0, 1},
-            {9, 61, 0, 1},
-            {9, 62, 0, 1},
-            {2018, 63, 0, 0},
-            {2048, 64, 0, 1},
-            {68, 65, 0, 1},
-            {68, 66, 0, 1},
-            {68, 67, 0, 1},
-            {68, 68, 0, 1},
-            {68, 69, 0, 1},
-            {8, 70, 0, 0},
-            {2012, 71, 0, 1},
-            {9, 72, 0, 1},
-            {9, 73, 0, 1},
-            {9, 74, 0, 1},
-            {9, 75, 0, 1},
-            {2011, 76, 0, 1},
-            {2011, 77, 0, 1},
-            {2011, 78, 0, 1},
-            {2011, 79, 0, 1},
-            {2048, 80, 0, 1},
-            {2007, 81, 0, 1},
-            {2007, 82, 0, 1},
-            {2013, 83, 0, 0},
-            {67, 84, 0, 1},
-            {14, 85, 0, 1},
-            {2012, 86, 0, 1},
-            {2012, 87, 0, 1},
-            {2012, 88, 0, 1},
-            {2012, 89, 0, 1},
-            {2012, 90, 0, 1},
-            {9, 91, 0, 1},
-            {2018, 92, 0, 0},
-            {2024, 93, 0, 0},
-            {9, 94, 0, 1},
-            {9, 95, 0, 1},
-            {9, 96, 0, 1},
-            {17, 97, 0, 1},
-            {3006, 98, 0, 1},
-            {3006, 99, 0, 1},
-            {3006, 100, 0, 1},
-            {3006, 101, 0, 1},
-            {3006, 102, 0, 1},
-            {3006, 103, 0, 1},
-            {3006, 104, 0, 1},
-            {3006, 105, 0, 1},
-            {3006, 106, 0, 1},
-            {2023, 107, 0, 0},
-            {2048, 108, 0, 1},
-            {2047, 109, 0, 1},
-            {2012, 110, 0, 1},
-            {2048, 111, 0, 1},
-            {67, 112, 0, 1},
-            {2007, 113, 0, 1},
-            {2008, 114, 0, 1},
-            {67, 115, 0, 1},
-            {2049, 116, 0, 1},
-            {67, 117, 0, 1},
-            {67, 118, 0, 1},
-            {67, 119, 0, 1},
-            {67, 120, 0, 1},
-            {67, 121, 0, 1},
-            {65, 122, 0, 1},
-            {6, 123, 0, 0},
-            {2025, 124, 0, 1},
-            {3005, 125, 0, 1},
-            {3005, 126, 0, 1},
-            {3005, 127, 0, 1},
-            {65, 128, 0, 1},
-            {65, 129, 0, 1},
-            {65, 130, 0, 1},
-            {65, 131, 0, 1},
-            {65, 132, 0, 1},
-            {65, 133, 0, 1},
-            {65, 134, 0, 1},
-            {2006, 135, 0, 0},
-            {65, 136, 0, 1},
-            {3001, 137, 0, 1},
-            {3001, 138, 0, 1},
-            {3001, 139, 0, 1},
-            {3001, 140, 0, 1},
-            {3001, 141, 0, 1},
-            {3001, 142, 0, 1},
-            {2007, 143, 0, 1},
-            {3001, 144, 0, 1},
-            {3001, 145, 0, 1},
-            {2048, 146, 0, 1},
-            {45, 147, 0, 1},
-            {45, 148, 0, 1},
-            {3005, 149, 0, 1},
-            {3005, 150, 0, 1},
-            {3005, 151, 0, 1},
-            {3005, 152, 0, 1},
-            {3005, 153, 0, 1},
-            {3005, 154, 0, 1},
-            {3005, 155, 0, 1},
-            {3005, 156, 0, 1},
-            {3005, 157, 0, 1},
-            {3005, 158, 0, 1},
-            {3005, 159, 0, 1},
-            {3005, 160, 0, 1},
-            {2003, 161, 0, 1},
-            {2004, 162, 0, 1},
-            {2007, 163, 0, 1},
-            {2007, 164, 0, 1},
-            {2007, 165, 0, 1},
-            {2007, 166, 0, 1},
-            {2008, 167, 0, 1},
-            {2008, 168, 0, 1},
-            {2049, 169, 0, 1},
-            {2012, 170, 0, 1},
-            {2025, 171, 0, 1},
-            {2048, 172, 0, 1},
-            {2049, 173, 0, 1},
-            {2047, 174, 0, 1},
-            {2047, 175, 0, 1},
-            {2047, 176, 0, 1},
-            {2047, 177, 0, 1},
-            {2047, 178, 0, 1},
-            {2047, 179, 0, 1},
-            {2047, 180, 0, 1},
-            {2047, 181, 0, 1},
-            {2047, 182, 0, 1},
-            {11, 183, 0, 1},
-            {11, 184, 0, 1},
-            {11, 185, 0, 1},
-            {11, 186, 0, 1},
-            {11, 187, 0, 1},
-            {11, 188, 0, 1},
-            {2023, 189, 0, 0},
-            {2049, 190, 0, 1},
-            {17, 191, 0, 1},
-            {82, 192, 0, 0},
-            {17, 193, 0, 1},
-            {7, 194, 0, 1},
-        }},
-        {"Downtown (MAP13)", {true, true, true}, {0, 0, 0}, 21, 312, {
-            {1, 0, 0, 1},
-            {2, 1, 0, 1},
-            {3, 2, 0, 1},
-            {4, 3, 0, 1},
-            {2003, 4, 0, 0},
-            {2010, 5, 0, 1},
-            {2010, 6, 0, 1},
-            {2010, 7, 0, 1},
-            {2010, 8, 0, 1},
-            {2010, 9, 0, 1},
-            {2010, 10, 0, 1},
-            {3002, 11, 0, 1},
-            {3002, 12, 0, 1},
-            {3002, 13, 0, 1},
-            {3002, 14, 0, 1},
-            {3002, 15, 0, 1},
-            {3002, 16, 0, 1},
-            {3002, 17, 0, 1},
-            {3002, 18, 0, 1},
-            {14, 19, 0, 1},
-            {14, 20, 0, 1},
-            {14, 21, 0, 1},
-            {14, 22, 0, 1},
-            {14, 23, 0, 1},
-            {14, 24, 0, 1},
-            {14, 25, 0, 1},
-            {14, 26, 0, 1},
-            {3005, 27, 0, 1},
-            {3002, 28, 0, 1},
-            {3001, 29, 0, 1},
-            {3001, 30, 0, 1},
-            {3001, 31, 0, 1},
-            {3001, 32, 0, 1},
-            {3001, 33, 0, 1},
-            {3002, 34, 0, 1},
-            {3001, 35, 0, 1},
-            {3002, 36, 0, 1},
-            {3001, 37, 0, 1},
-            {3001, 38, 0, 1},
-            {3001, 39, 0, 1},
-            {3001, 40, 0, 1},
-            {3001, 41, 0, 1},
-            {2001, 42, 0, 0},
-            {2008, 43, 0, 1},
-            {2008, 44, 0, 1},
-            {2008, 45, 0, 1},
-            {2008, 46, 0, 1},
-            {2011, 47, 0, 1},
-            {2014, 48, 0, 1},
-            {2015, 49, 0, 1},
-            {2015, 50, 0, 1},
-            {2015, 51, 0, 1},
-            {2014, 52, 0, 1},
-            {2014, 53, 0, 1},
-            {2014, 54, 0, 1},
-            {2014, 55, 0, 1},
-            {2014, 56, 0, 1},
-            {2015, 57, 0, 1},
-            {2011, 58, 0, 1},
-            {2011, 59, 0, 1},
-            {2012, 60, 0, 1},
-            {2008, 61, 0, 1},
-            {3001, 62, 0, 1},
-            {3001, 63, 0, 1},
-            {3001, 64, 0, 1},
-            {3001, 65, 0, 1},
-            {3001, 66, 0, 1},
-            {2049, 67, 0, 1},
-            {3001, 68, 0, 1},
-            {3001, 69, 0, 1},
-            {3001, 70, 0, 1},
-            {3001, 71, 0, 1},
-            {14, 72, 0, 1},
-            {2013, 73, 0, 0},
-            {3001, 74, 0, 1},
-            {3001, 75, 0, 1},
-            {3001, 76, 0, 1},
-            {3001, 77, 0, 1},
-            {2007, 78, 0, 1},
-            {3001, 79, 0, 1},
-            {3001, 80, 0, 1},
-            {2049, 81, 0, 1},
-            {3001, 82, 0, 1},
-            {2011, 83, 0, 1},
-            {2011, 84, 0, 1},
-            {2011, 85, 0, 1},
-            {2011, 86, 0, 1},
-            {2007, 87, 0, 1},
-            {2007, 88, 0, 1},
-            {2007, 89, 0, 1},
-            {2007, 90, 0, 1},
-            {2007, 91, 0, 1},
-            {2008, 92, 0, 1},
-            {2008, 93, 0, 1},
-            {2008, 94, 0, 1},
-            {2008, 95, 0, 1},
-            {2008, 96, 0, 1},
-            {2010, 97, 0, 1},
-            {2010, 98, 0, 1},
-            {2014, 99, 0, 1},
-            {2014, 100, 0, 1},
-            {2014, 101, 0, 1},
-            {2014, 102, 0, 1},
-            {2014, 103, 0, 1},
-            {2014, 104, 0, 1},
-            {2014, 105, 0, 1},
-            {2014, 106, 0, 1},
-            {2014, 107, 0, 1},
-            {2015, 108, 0, 1},
-            {2015, 109, 0, 1},
-            {2014, 110, 0, 1},
-            {2014, 111, 0, 1},
-            {2015, 112, 0, 1},
-            {2015, 113, 0, 1},
-            {2015, 114, 0, 1},
-            {2015, 115, 0, 1},
-            {2015, 116, 0, 1},
-            {2015, 117, 0, 1},
-            {2015, 118, 0, 1},
-            {14, 119, 0, 1},
-            {3005, 120, 0, 1},
-            {3001, 121, 0, 1},
-            {3001, 122, 0, 1},
-            {3001, 123, 0, 1},
-            {3001, 124, 0, 1},
-            {2049, 125, 0, 1},
-            {67, 126, 0, 1},
-            {3005, 127, 0, 1},
-            {3005, 128, 0, 1},
-            {3005, 129, 0, 1},
-            {3005, 130, 0, 1},
-            {2023, 131, 0, 0},
-            {3006, 132, 0, 1},
-            {3006, 133, 0, 1},
-            {3006, 134, 0, 1},
-            {3006, 135, 0, 1},
-            {3006, 136, 0, 1},
-            {3006, 137, 0, 1},
-            {2014, 138, 0, 1},
-            {2014, 139, 0, 1},
-            {2007, 140, 0, 1},
-            {2015, 141, 0, 1},
-            {2014, 142, 0, 1},
-            {2014, 143, 0, 1},
-            {2014, 144, 0, 1},
-            {2014, 145, 0, 1},
-            {2014, 146, 0, 1},
-            {2014, 147, 0, 1},
-            {2015, 148, 0, 1},
-            {2015, 149, 0, 1},
-            {2015, 150, 0, 1},
-            {2015, 151, 0, 1},
-            {2015, 152, 0, 1},
-            {2015, 153, 0, 1},
-            {2008, 154, 0, 1},
-            {2007, 155, 0, 1},
-            {2010, 156, 0, 1},
-            {2047, 157, 0, 1},
-            {2019, 158, 0, 0},
-            {3002, 159, 0, 1},
-            {3001, 160, 0, 1},
-            {3001, 161, 0, 1},
-            {3001, 162, 0, 1},
-            {3001, 163, 0, 1},
-            {3001, 164, 0, 1},
-            {3001, 165, 0, 1},
-            {3002, 166, 0, 1},
-            {3002, 167, 0, 1},
-            {2012, 168, 0, 1},
-            {2012, 169, 0, 1},
-            {2008, 170, 0, 1},
-            {2008, 171, 0, 1},
-            {2007, 172, 0, 1},
-            {2008, 173, 0, 1},
-            {45, 174, 0, 1},
-            {45, 175, 0, 1},
-            {3001, 176, 0, 1},
-            {3001, 177, 0, 1},
-            {3001, 178, 0, 1},
-            {3001, 179, 0, 1},
-            {3001, 180, 0, 1},
-            {3001, 181, 0, 1},
-            {3001, 182, 0, 1},
-            {2002, 183, 0, 0},
-            {2048, 184, 0, 1},
-            {3001, 185, 0, 1},
-            {3001, 186, 0, 1},
-            {3001, 187, 0, 1},
-            {3001, 188, 0, 1},
-            {3001, 189, 0, 1},
-            {3001, 190, 0, 1},
-            {3001, 191, 0, 1},
-            {3001, 192, 0, 1},
-            {3001, 193, 0, 1},
-            {3001, 194, 0, 1},
-            {5, 195, 0, 0},
-            {14, 196, 0, 1},
-            {2046, 197, 0, 1},
-            {2048, 198, 0, 1},
-            {3001, 199, 0, 1},
-            {3001, 200, 0, 1},
-            {6, 201, 0, 0},
-            {2046, 202, 0, 1},
-            {2049, 203, 0, 1},
-            {2049, 204, 0, 1},
-            {2047, 205, 0, 1},
-            {2047, 206, 0, 1},
-            {2023, 207, 0, 0},
-            {3001, 208, 0, 1},
-            {3001, 209, 0, 1},
-            {3001, 210, 0, 1},
-            {3001, 211, 0, 1},
-            {3001, 212, 0, 1},
-            {3001, 213, 0, 1},
-            {3001, 214, 0, 1},
-            {3001, 215, 0, 1},
-            {3001, 216, 0, 1},
-            {3001, 217, 0, 1},
-            {3001, 218, 0, 1},
-            {3001, 219, 0, 1},
-            {3001, 220, 0, 1},
-            {3001, 221, 0, 1},
-            {3001, 222, 0, 1},
-            {3001, 223, 0, 1},
-            {58, 224, 0, 1},
-            {58, 225, 0, 1},
-            {2046, 226, 0, 1},
-            {2046, 227, 0, 1},
-            {2048, 228, 0, 1},
-            {2049, 229, 0, 1},
-            {3005, 230, 0, 1},
-            {2004, 231, 0, 0},
-            {2014, 232, 0, 1},
-            {2015, 233, 0, 1},
-            {2015, 234, 0, 1},
-            {2015, 235, 0, 1},
-            {2014, 236, 0, 1},
-            {2014, 237, 0, 1},
-            {2011, 238, 0, 1},
-            {2011, 239, 0, 1},
-            {3006, 240, 0, 1},
-            {3006, 241, 0, 1},
-            {3006, 242, 0, 1},
-            {3006, 243, 0, 1},
-            {3006, 244, 0, 1},
-            {66, 245, 0, 1},
-            {66, 246, 0, 1},
-            {66, 247, 0, 1},
-            {66, 248, 0, 1},
-            {2024, 249, 0, 0},
-            {8, 250, 0, 0},
-            {3006, 251, 0, 1},
-            {3006, 252, 0, 1},
-            {3006, 253, 0, 1},
-            {3006, 254, 0, 1},
-            {3006, 255, 0, 1},
-            {14, 256, 0, 1},
-            {2005, 257, 0, 0},
-            {2006, 258, 0, 0},
-            {2049, 259, 0, 1},
-            {2049, 260, 0, 1},
-            {2049, 261, 0, 1},
-            {2049, 262, 0, 1},
-            {2049, 263, 0, 1},
-            {2048, 264, 0, 1},
-            {2048, 265, 0, 1},
-            {2048, 266, 0, 1},
-            {2048, 267, 0, 1},
-            {2048, 268, 0, 1},
-            {2022, 269, 0, 0},
-            {14, 270, 0, 1},
-            {3005, 271, 0, 1},
-            {3005, 272, 0, 1},
-            {3002, 273, 0, 1},
-            {2011, 274, 0, 1},
-            {2011, 275, 0, 1},
-            {2011, 276, 0, 1},
-            {2008, 277, 0, 1},
-            {2007, 278, 0, 1},
-            {2007, 279, 0, 1},
-            {2022, 280, 0, 0},
-            {2024, 281, 0, 0},
-            {2024, 282, 0, 0},
-            {13, 283, 0, 0},
-            {11, 284, 0, 1},
-            {11, 285, 0, 1},
-            {11, 286, 0, 1},
-            {11, 287, 0, 1},
-            {11, 288, 0, 1},
-            {11, 289, 0, 1},
-            {11, 290, 0, 1},
-            {11, 291, 0, 1},
-            {14, 292, 0, 1},
-            {2012, 293, 0, 1},
-            {2007, 294, 0, 1},
-            {2008, 295, 0, 1},
-            {2023, 296, 0, 0},
-            {14, 297, 0, 1},
-            {2026, 298, 0, 0},
-            {3005, 299, 0, 1},
-            {82, 300, 0, 1},
-            {2049, 301, 0, 1},
-            {2046, 302, 0, 1},
-            {17, 303, 0, 1},
-            {68, 304, 0, 1},
-            {68, 305, 0, 1},
-            {68, 306, 0, 1},
-            {68, 307, 0, 1},
-            {68, 308, 0, 1},
-            {68, 309, 0, 1},
-            {2048, 310, 0, 1},
-            {16, 311, 0, 1},
-        }},
-        {"The Inmost Dens (MAP14)", {true, false, true}, {1, 0, 1}, 10, 173, {
-            {1, 0, 0, 1},
-            {2, 1, 0, 1},
-            {3, 2, 0, 1},
-            {4, 3, 0, 1},
-            {57, 4, 0, 1},
-            {57, 5, 0, 1},
-            {57, 6, 0, 1},
-            {2046, 7, 0, 1},
-            {11, 8, 0, 1},
-            {11, 9, 0, 1},
-            {11, 10, 0, 1},
-            {11, 11, 0, 1},
-            {2049, 12, 0, 1},
-            {2001, 13, 0, 0},
-            {2046, 14, 0, 1},
-            {11, 15, 0, 1},
-            {2013, 16, 0, 0},
-            {45, 17, 0, 1},
-            {45, 18, 0, 1},
-            {45, 19, 0, 1},
-            {45, 20, 0, 1},
-            {11, 21, 0, 1},
-            {2019, 22, 0, 0},
-            {17, 23, 0, 1},
-            {45, 24, 0, 1},
-            {45, 25, 0, 1},
-            {45, 26, 0, 1},
-            {45, 27, 0, 1},
-            {45, 28, 0, 1},
-            {45, 29, 0, 1},
-            {45, 30, 0, 1},
-            {45, 31, 0, 1},
-            {46, 32, 0, 1},
-            {46, 33, 0, 1},
-            {46, 34, 0, 1},
-            {46, 35, 0, 1},
-            {45, 36, 0, 1},
-            {45, 37, 0, 1},
-            {58, 38, 0, 1},
-            {65, 39, 0, 1},
-            {9, 40, 0, 1},
-            {9, 41, 0, 1},
-            {3004, 42, 0, 1},
-            {3004, 43, 0, 1},
-            {3004, 44, 0, 1},
-            {3004, 45, 0, 1},
-            {3001, 46, 0, 1},
-            {3001, 47, 0, 1},
-            {3001, 48, 0, 1},
-            {3001, 49, 0, 1},
-            {9, 50, 0, 1},
-            {9, 51, 0, 1},
-            {9, 52, 0, 1},
-            {9, 53, 0, 1},
-            {9, 54, 0, 1},
-            {3001, 55, 0, 1},
-            {3001, 56, 0, 1},
-            {65, 57, 0, 1},
-            {9, 58, 0, 1},
-            {9, 59, 0, 1},
-            {65, 60, 0, 1},
-            {65, 61, 0, 1},
-            {9, 62, 0, 1},
-            {3001, 63, 0, 1},
-            {3001, 64, 0, 1},
-            {3001, 65, 0, 1},
-            {3001, 66, 0, 1},
-            {3001, 67, 0, 1},
-            {3001, 68, 0, 1},
-            {3001, 69, 0, 1},
-            {9, 70, 0, 1},
-            {65, 71, 0, 1},
-            {65, 72, 0, 1},
-            {3001, 73, 0, 1},
-            {3001, 74, 0, 1},
-            {3004, 75, 0, 1},
-            {3004, 76, 0, 1},
-            {65, 77, 0, 1},
-            {2023, 78, 0, 0},
-            {2012, 79, 0, 1},
-            {2002, 80, 0, 0},
-            {2004, 81, 0, 0},
-            {9, 82, 0, 1},
-            {9, 83, 0, 1},
-            {9, 84, 0, 1},
-            {9, 85, 0, 1},
-            {9, 86, 0, 1},
-            {65, 87, 0, 1},
-            {65, 88, 0, 1},
-            {9, 89, 0, 1},
-            {9, 90, 0, 1},
-            {68, 91, 0, 1},
-            {58, 92, 0, 1},
-            {2012, 93, 0, 1},
-            {2012, 94, 0, 1},
-            {2012, 95, 0, 1},
-            {2012, 96, 0, 1},
-            {2048, 97, 0, 1},
-            {3006, 98, 0, 1},
-            {3006, 99, 0, 1},
-            {3006, 100, 0, 1},
-            {3006, 101, 0, 1},
-            {3006, 102, 0, 1},
-            {3006, 103, 0, 1},
-            {9, 104, 0, 1},
-            {9, 105, 0, 1},
-            {9, 106, 0, 1},
-            {3001, 107, 0, 1},
-            {3001, 108, 0, 1},
-            {3001, 109, 0, 1},
-            {3001, 110, 0, 1},
-            {3001, 111, 0, 1},
-            {58, 112, 0, 1},
-            {9, 113, 0, 1},
-            {9, 114, 0, 1},
-            {9, 115, 0, 1},
-            {2012, 116, 0, 1},
-            {58, 117, 0, 1},
-            {2011, 118, 0, 1},
-            {38, 119, 0, 0},
-            {9, 120, 0, 1},
-            {9, 121, 0, 1},
-            {2046, 122, 0, 1},
-            {2003, 123, 0, 0},
-            {2006, 124, 0, 1},
-            {2012, 125, 0, 1},
-            {66, 126, 0, 1},
-            {65, 127, 0, 1},
-            {44, 128, 0, 1},
-            {44, 129, 0, 1},
-            {40, 130, 0, 0},
-            {2012, 131, 0, 1},
-            {2011, 132, 0, 1},
-            {2011, 133, 0, 1},
-            {2011, 134, 0, 1},
-            {11, 135, 0, 1},
-            {2001, 136, 0, 1},
-            {2019, 137, 0, 1},
-            {2024, 138, 0, 0},
-            {65, 139, 0, 1},
-            {65, 140, 0, 1},
-            {64, 141, 0, 1},
-            {19, 142, 0, 1},
-            {19, 143, 0, 1},
-            {19, 144, 0, 1},
-            {19, 145, 0, 1},
-            {65, 146, 0, 1},
-            {65, 147, 0, 1},
-            {65, 148, 0, 1},
-            {65, 149, 0, 1},
-            {3004, 150, 0, 1},
-            {3004, 151, 0, 1},
-            {3004, 152, 0, 1},
-            {3004, 153, 0, 1},
-            {3004, 154, 0, 1},
-            {3004, 155, 0, 1},
-            {9, 156, 0, 1},
-            {9, 157, 0, 1},
-            {9, 158, 0, 1},
-            {2012, 159, 0, 1},
-            {3001, 160, 0, 1},
-            {3001, 161, 0, 1},
-            {3001, 162, 0, 1},
-            {3001, 163, 0, 1},
-            {3001, 164, 0, 1},
-            {3001, 165, 0, 1},
-            {2012, 166, 0, 1},
-            {2011, 167, 0, 1},
-            {2011, 168, 0, 1},
-            {2011, 169, 0, 1},
-            {65, 170, 0, 1},
-            {9, 171, 0, 1},
-            {65, 172, 0, 1},
-        }},
-        {"Industrial Zone (MAP15)", {true, true, true}, {0, 0, 0}, 22, 376, {
-            {1, 0, 0, 1},
-            {2, 1, 0, 1},
-            {3, 2, 0, 1},
-            {4, 3, 0, 1},
-            {2023, 4, 0, 0},
-            {46, 5, 0, 1},
-            {46, 6, 0, 1},
-            {46, 7, 0, 1},
-            {46, 8, 0, 1},
-            {45, 9, 0, 1},
-            {45, 10, 0, 1},
-            {2003, 11, 0, 0},
-            {2046, 12, 0, 1},
-            {2001, 13, 0, 0},
-            {2024, 14, 0, 0},
-            {3001, 15, 0, 1},
-            {3001, 16, 0, 1},
-            {3001, 17, 0, 1},
-            {3001, 18, 0, 1},
-            {3001, 19, 0, 1},
-            {3001, 20, 0, 1},
-            {3001, 21, 0, 1},
-            {3001, 22, 0, 1},
-            {44, 23, 0, 1},
-            {8, 24, 0, 0},
-            {2046, 25, 0, 1},
-            {2008, 26, 0, 1},
-            {2008, 27, 0, 1},
-            {2008, 28, 0, 1},
-            {57, 29, 0, 1},
-            {57, 30, 0, 1},
-            {57, 31, 0, 1},
-            {46, 32, 0, 1},
-            {2012, 33, 0, 1},
-            {35, 34, 0, 1},
-            {35, 35, 0, 1},
-            {35, 36, 0, 1},
-            {35, 37, 0, 1},
-            {35, 38, 0, 1},
-            {35, 39, 0, 1},
-            {35, 40, 0, 1},
-            {35, 41, 0, 1},
-            {45, 42, 0, 1},
-            {45, 43, 0, 1},
-            {34, 44, 0, 1},
-            {34, 45, 0, 1},
-            {34, 46, 0, 1},
-            {34, 47, 0, 1},
-            {2006, 48, 0, 0},
-            {3003, 49, 0, 1},
-            {71, 50, 0, 1},
-            {71, 51, 0, 1},
-            {71, 52, 0, 1},
-            {3005, 53, 0, 1},
-            {3005, 54, 0, 1},
-            {2012, 55, 0, 1},
-            {2013, 56, 0, 0},
-            {2019, 57, 0, 0},
-            {2012, 58, 0, 1},
-            {2018, 59, 0, 0},
-            {2012, 60, 0, 1},
-            {2047, 61, 0, 1},
-            {2049, 62, 0, 1},
-            {2010, 63, 0, 1},
-            {11, 64, 0, 1},
-            {11, 65, 0, 1},
-            {11, 66, 0, 1},
-            {11, 67, 0, 1},
-            {11, 68, 0, 1},
-            {11, 69, 0, 1},
-            {11, 70, 0, 1},
-            {6, 71, 0, 0},
-            {14, 72, 0, 1},
-            {14, 73, 0, 1},
-            {2002, 74, 0, 0},
-            {2048, 75, 0, 1},
-            {14, 76, 0, 1},
-            {14, 77, 0, 1},
-            {69, 78, 0, 1},
-            {46, 79, 0, 1},
-            {46, 80, 0, 1},
-            {46, 81, 0, 1},
-            {46, 82, 0, 1},
-            {46, 83, 0, 1},
-            {46, 84, 0, 1},
-            {46, 85, 0, 1},
-            {2004, 86, 0, 0},
-            {2047, 87, 0, 1},
-            {2025, 88, 0, 1},
-            {17, 89, 0, 1},
-            {17, 90, 0, 1},
-            {2024, 91, 0, 0},
-            {69, 92, 0, 1},
-            {2026, 93, 0, 0},
-            {2022, 94, 0, 0},
-            {46, 95, 0, 1},
-            {46, 96, 0, 1},
-            {14, 97, 0, 1},
-            {14, 98, 0, 1},
-            {14, 99, 0, 1},
-            {13, 100, 0, 0},
-            {2012, 101, 0, 1},
-            {2049, 102, 0, 1},
-            {8, 103, 0, 0},
-            {55, 104, 0, 1},
-            {44, 105, 0, 1},
-            {44, 106, 0, 1},
-            {44, 107, 0, 1},
-            {24, 108, 0, 1},
-            {15, 109, 0, 1},
-            {19, 110, 0, 1},
-            {10, 111, 0, 1},
-            {14, 112, 0, 1},
-            {2005, 113, 0, 0},
-            {56, 114, 0, 1},
-            {56, 115, 0, 1},
-            {46, 116, 0, 1},
-            {46, 117, 0, 1},
-            {46, 118, 0, 1},
-            {46, 119, 0, 1},
-            {2012, 120, 0, 1},
-            {2012, 121, 0, 1},
-            {2012, 122, 0, 1},
-            {2046, 123, 0, 1},
-            {2049, 124, 0, 1},
-            {83, 125, 0, 0},
-            {3003, 126, 0, 1},
-            {3001, 127, 0, 1},
-            {3001, 128, 0, 1},
-            {3001, 129, 0, 1},
-            {3001, 130, 0, 1},
-            {3001, 131, 0, 1},
-            {3001, 132, 0, 1},
-            {3001, 133, 0, 1},
-            {3001, 134, 0, 1},
-            {3001, 135, 0, 1},
-            {3001, 136, 0, 1},
-            {3001, 137, 0, 1},
-            {3001, 138, 0, 1},
-            {3001, 139, 0, 1},
-            {3001, 140, 0, 1},
-            {3001, 141, 0, 1},
-            {69, 142, 0, 1},
-            {44, 143, 0, 1},
-            {44, 144, 0, 1},
-            {55, 145, 0, 1},
-            {3005, 146, 0, 1},
-            {3005, 147, 0, 1},
-            {3005, 148, 0, 1},
-            {3001, 149, 0, 1},
-            {3001, 150, 0, 1},
-            {3001, 151, 0, 1},
-            {3001, 152, 0, 1},
-            {3001, 153, 0, 1},
-            {3001, 154, 0, 1},
-            {65, 155, 0, 1},
-            {65, 156, 0, 1},
-            {3006, 157, 0, 1},
-            {3006, 158, 0, 1},
-            {3006, 159, 0, 1},
-            {3006, 160, 0, 1},
-            {3006, 161, 0, 1},
-            {3006, 162, 0, 1},
-            {3006, 163, 0, 1},
-            {9, 164, 0, 1},
-            {9, 165, 0, 1},
-            {9, 166, 0, 1},
-            {9, 167, 0, 1},
-            {9, 168, 0, 1},
-            {9, 169, 0, 1},
-            {65, 170, 0, 1},
-            {65, 171, 0, 1},
-            {65, 172, 0, 1},
-            {65, 173, 0, 1},
-            {65, 174, 0, 1},
-            {65, 175, 0, 1},
-            {2008, 176, 0, 1},
-            {2008, 177, 0, 1},
-            {2023, 178, 0, 0},
-            {3006, 179, 0, 1},
-            {3006, 180, 0, 1},
-            {65, 181, 0, 1},
-            {71, 182, 0, 1},
-            {9, 183, 0, 1},
-            {65, 184, 0, 1},
-            {3001, 185, 0, 1},
-            {3001, 186, 0, 1},
-            {3001, 187, 0, 1},
-            {3001, 188, 0, 1},
-            {2047, 189, 0, 1},
-            {2047, 190, 0, 1},
-            {2047, 191, 0, 1},
-            {2047, 192, 0, 1},
-            {2047, 193, 0, 1},
-            {2010, 194, 0, 1},
-            {2010, 195, 0, 1},
-            {2011, 196, 0, 1},
-            {2011, 197, 0, 1},
-            {2011, 198, 0, 1},
-            {2011, 199, 0, 1},
-            {2011, 200, 0, 1},
-            {2011, 201, 0, 1},
-            {2008, 202, 0, 1},
-            {2007, 203, 0, 1},
-            {2007, 204, 0, 1},
-            {68, 205, 0, 1},
-            {71, 206, 0, 1},
-            {2046, 207, 0, 1},
-            {2046, 208, 0, 1},
-            {46, 209, 0, 1},
-            {46, 210, 0, 1},
-            {46, 211, 0, 1},
-            {46, 212, 0, 1},
-            {2049, 213, 0, 1},
-            {3004, 214, 0, 1},
-            {3004, 215, 0, 1},
-            {3004, 216, 0, 1},
-            {3004, 217, 0, 1},
-            {3004, 218, 0, 1},
-            {3004, 219, 0, 1},
-            {3004, 220, 0, 1},
-            {3004, 221, 0, 1},
-            {3004, 222, 0, 1},
-            {3004, 223, 0, 1},
-            {3004, 224, 0, 1},
-            {3004, 225, 0, 1},
-            {3004, 226, 0, 1},
-            {3004, 227, 0, 1},
-            {3004, 228, 0, 1},
-            {3004, 229, 0, 1},
-            {3004, 230, 0, 1},
-            {3004, 231, 0, 1},
-            {3004, 232, 0, 1},
-            {3004, 233, 0, 1},
-            {3004, 234, 0, 1},
-            {3004, 235, 0, 1},
-            {3004, 236, 0, 1},
-            {3004, 237, 0, 1},
-            {3004, 238, 0, 1},
-            {3004, 239, 0, 1},
-            {3004, 240, 0, 1},
-            {3004, 241, 0, 1},
-            {3004, 242, 0, 1},
-            {3004, 243, 0, 1},
-            {3004, 244, 0, 1},
-            {3004, 245, 0, 1},
-            {3004, 246, 0, 1},
-            {3004, 247, 0, 1},
-            {3004, 248, 0, 1},
-            {3004, 249, 0, 1},
-            {3004, 250, 0, 1},
-            {3004, 251, 0, 1},
-            {3004, 252, 0, 1},
-            {3004, 253, 0, 1},
-            {3004, 254, 0, 1},
-            {3004, 255, 0, 1},
-            {3004, 256, 0, 1},
-            {9, 257, 0, 1},
-            {9, 258, 0, 1},
-            {9, 259, 0, 1},
-            {9, 260, 0, 1},
-            {9, 261, 0, 1},
-            {9, 262, 0, 1},
-            {9, 263, 0, 1},
-            {9, 264, 0, 1},
-            {9, 265, 0, 1},
-            {9, 266, 0, 1},
-            {9, 267, 0, 1},
-            {9, 268, 0, 1},
-            {9, 269, 0, 1},
-            {9, 270, 0, 1},
-            {9, 271, 0, 1},
-            {9, 272, 0, 1},
-            {9, 273, 0, 1},
-            {9, 274, 0, 1},
-            {9, 275, 0, 1},
-            {9, 276, 0, 1},
-            {9, 277, 0, 1},
-            {9, 278, 0, 1},
-            {9, 279, 0, 1},
-            {9, 280, 0, 1},
-            {9, 281, 0, 1},
-            {9, 282, 0, 1},
-            {9, 283, 0, 1},
-            {9, 284, 0, 1},
-            {9, 285, 0, 1},
-            {9, 286, 0, 1},
-            {9, 287, 0, 1},
-            {9, 288, 0, 1},
-            {9, 289, 0, 1},
-            {3001, 290, 0, 1},
-            {3001, 291, 0, 1},
-            {3001, 292, 0, 1},
-            {71, 293, 0, 1},
-            {9, 294, 0, 1},
-            {9, 295, 0, 1},
-            {3005, 296, 0, 1},
-            {65, 297, 0, 1},
-            {65, 298, 0, 1},
-            {65, 299, 0, 1},
-            {65, 300, 0, 1},
-            {65, 301, 0, 1},
-            {65, 302, 0, 1},
-            {3001, 303, 0, 1},
-            {3001, 304, 0, 1},
-            {3001, 305, 0, 1},
-            {3001, 306, 0, 1},
-            {9, 307, 0, 1},
-            {3005, 308, 0, 1},
-            {3005, 309, 0, 1},
-            {65, 310, 0, 1},
-            {2011, 311, 0, 1},
-            {2011, 312, 0, 1},
-            {2011, 313, 0, 1},
-            {2011, 314, 0, 1},
-            {2011, 315, 0, 1},
-            {2011, 316, 0, 1},
-            {2011, 317, 0, 1},
-            {2012, 318, 0, 1},
-            {2012, 319, 0, 1},
-            {2011, 320, 0, 1},
-            {2011, 321, 0, 1},
-            {2011, 322, 0, 1},
-            {2011, 323, 0, 1},
-            {2011, 324, 0, 1},
-            {2011, 325, 0, 1},
-            {2011, 326, 0, 1},
-            {2011, 327, 0, 1},
-            {2011, 328, 0, 1},
-            {2011, 329, 0, 1},
-            {2011, 330, 0, 1},
-            {2011, 331, 0, 1},
-            {2011, 332, 0, 1},
-            {2012, 333, 0, 1},
-            {2012, 334, 0, 1},
-            {2012, 335, 0, 1},
-            {2012, 336, 0, 1},
-            {5, 337, 0, 0},
-            {3001, 338, 0, 1},
-            {3001, 339, 0, 1},
-            {3005, 340, 0, 1},
-            {3005, 341, 0, 1},
-            {3005, 342, 0, 1},
-            {2012, 343, 0, 1},
-            {2012, 344, 0, 1},
-            {2012, 345, 0, 1},
-            {2008, 346, 0, 1},
-            {2008, 347, 0, 1},
-            {2008, 348, 0, 1},
-            {2008, 349, 0, 1},
-            {2008, 350, 0, 1},
-            {2008, 351, 0, 1},
-            {2008, 352, 0, 1},
-            {2008, 353, 0, 1},
-            {2008, 354, 0, 1},
-            {2008, 355, 0, 1},
-            {2045, 356, 0, 1},
-            {2012, 357, 0, 1},
-            {2012, 358, 0, 1},
-            {2012, 359, 0, 1},
-            {2025, 360, 0, 1},
-            {2019, 361, 0, 0},
-            {16, 362, 0, 1},
-            {11, 363, 0, 1},
-            {46, 364, 0, 1},
-            {2011, 365, 0, 1},
-            {2011, 366, 0, 1},
-            {2011, 367, 0, 1},
-            {2011, 368, 0, 1},
-            {2011, 369, 0, 1},
-            {2012, 370, 0, 1},
-            {2012, 371, 0, 1},
-            {2012, 372, 0, 1},
-            {2025, 373, 0, 1},
-            {14, 374, 0, 1},
-            {82, 375, 0, 1},
-        }},
-        {"Suburbs (MAP16)", {true, false, true}, {1, 0, 1}, 17, 249, {
-            {56, 0, 0, 1},
-            {56, 1, 0, 1},
-            {1, 2, 0, 1},
-            {2, 3, 0, 1},
-            {3, 4, 0, 1},
-            {4, 5, 0, 1},
-            {11, 6, 0, 1},
-            {83, 7, 0, 0},
-            {41, 8, 0, 1},
-            {42, 9, 0, 1},
-            {57, 10, 0, 1},
-            {82, 11, 0, 0},
-            {2008, 12, 0, 1},
-            {2008, 13, 0, 1},
-            {2008, 14, 0, 1},
-            {2002, 15, 0, 0},
-            {2011, 16, 0, 1},
-            {2012, 17, 0, 1},
-            {2049, 18, 0, 1},
-            {3001, 19, 0, 1},
-            {3001, 20, 0, 1},
-            {3001, 21, 0, 1},
-            {3001, 22, 0, 1},
-            {3001, 23, 0, 1},
-            {3001, 24, 0, 1},
-            {3001, 25, 0, 1},
-            {3001, 26, 0, 1},
-            {3001, 27, 0, 1},
-            {3001, 28, 0, 1},
-            {3001, 29, 0, 1},
-            {3001, 30, 0, 1},
-            {3001, 31, 0, 1},
-            {3001, 32, 0, 1},
-            {3001, 33, 0, 1},
-            {3001, 34, 0, 1},
-            {3001, 35, 0, 1},
-            {3001, 36, 0, 1},
-            {3001, 37, 0, 1},
-            {3001, 38, 0, 1},
-            {3001, 39, 0, 1},
-            {3001, 40, 0, 1},
-            {3001, 41, 0, 1},
-            {3001, 42, 0, 1},
-            {3001, 43, 0, 1},
-            {3001, 44, 0, 1},
-            {3001, 45, 0, 1},
-            {3001, 46, 0, 1},
-            {3001, 47, 0, 1},
-            {3001, 48, 0, 1},
-            {3001, 49, 0, 1},
-            {3005, 50, 0, 1},
-            {2049, 51, 0, 1},
-            {2049, 52, 0, 1},
-            {8, 53, 0, 0},
-            {66, 54, 0, 1},
-            {64, 55, 0, 1},
-            {66, 56, 0, 1},
-            {2011, 57, 0, 1},
-            {2011, 58, 0, 1},
-            {2003, 59, 0, 0},
-            {2023, 60, 0, 0},
-            {66, 61, 0, 1},
-            {2004, 62, 0, 0},
-            {2004, 63, 0, 0},
-            {2004, 64, 0, 0},
-            {2004, 65, 0, 0},
-            {14, 66, 0, 1},
-            {14, 67, 0, 1},
-            {14, 68, 0, 1},
-            {14, 69, 0, 1},
-            {14, 70, 0, 1},
-            {3002, 71, 0, 1},
-            {3002, 72, 0, 1},
-            {3002, 73, 0, 1},
-            {3002, 74, 0, 1},
-            {58, 75, 0, 1},
-            {66, 76, 0, 1},
-            {2049, 77, 0, 1},
-            {2046, 78, 0, 1},
-            {2012, 79, 0, 1},
-            {2012, 80, 0, 1},
-            {2012, 81, 0, 1},
-            {2008, 82, 0, 1},
-            {2008, 83, 0, 1},
-            {2008, 84, 0, 1},
-            {2012, 85, 0, 1},
-            {2008, 86, 0, 1},
-            {3001, 87, 0, 1},
-            {3001, 88, 0, 1},
-            {3001, 89, 0, 1},
-            {3001, 90, 0, 1},
-            {3001, 91, 0, 1},
-            {3001, 92, 0, 1},
-            {3001, 93, 0, 1},
-            {3001, 94, 0, 1},
-            {3001, 95, 0, 1},
-            {3001, 96, 0, 1},
-            {3001, 97, 0, 1},
-            {3001, 98, 0, 1},
-            {3001, 99, 0, 1},
-            {3001, 100, 0, 1},
-            {3001, 101, 0, 1},
-            {3001, 102, 0, 1},
-            {3001, 103, 0, 1},
-            {3001, 104, 0, 1},
-            {3001, 105, 0, 1},
-            {3001, 106, 0, 1},
-            {3001, 107, 0, 1},
-            {3001, 108, 0, 1},
-            {3001, 109, 0, 1},
-            {3001, 110, 0, 1},
-            {3001, 111, 0, 1},
-            {3001, 112, 0, 1},
-            {3001, 113, 0, 1},
-            {3001, 114, 0, 1},
-            {3001, 115, 0, 1},
-            {3001, 116, 0, 1},
-            {3001, 117, 0, 1},
-            {3001, 118, 0, 1},
-            {3001, 119, 0, 1},
-            {3001, 120, 0, 1},
-            {3001, 121, 0, 1},
-            {3001, 122, 0, 1},
-            {3001, 123, 0, 1},
-            {3001, 124, 0, 1},
-            {3001, 125, 0, 1},
-            {3001, 126, 0, 1},
-            {3001, 127, 0, 1},
-            {3001, 128, 0, 1},
-            {3005, 129, 0, 1},
-            {3005, 130, 0, 1},
-            {3005, 131, 0, 1},
-            {3005, 132, 0, 1},
-            {3005, 133, 0, 1},
-            {3005, 134, 0, 1},
-            {3005, 135, 0, 1},
-            {3005, 136, 0, 1},
-            {3005, 137, 0, 1},
-            {3005, 138, 0, 1},
-            {3005, 139, 0, 1},
-            {3005, 140, 0, 1},
-            {3005, 141, 0, 1},
-            {3005, 142, 0, 1},
-            {3005, 143, 0, 1},
-            {3005, 144, 0, 1},
-            {3005, 145, 0, 1},
-            {3005, 146, 0, 1},
-            {67, 147, 0, 1},
-            {67, 148, 0, 1},
-            {67, 149, 0, 1},
-            {67, 150, 0, 1},
-            {67, 151, 0, 1},
-            {67, 152, 0, 1},
-            {67, 153, 0, 1},
-            {67, 154, 0, 1},
-            {67, 155, 0, 1},
-            {67, 156, 0, 1},
-            {67, 157, 0, 1},
-            {67, 158, 0, 1},
-            {2025, 159, 0, 1},
-            {14, 160, 0, 1},
-            {14, 161, 0, 1},
-            {14, 162, 0, 1},
-            {3001, 163, 0, 1},
-            {2046, 164, 0, 1},
-            {2046, 165, 0, 1},
-            {2046, 166, 0, 1},
-            {66, 167, 0, 1},
-            {66, 168, 0, 1},
-            {2006, 169, 0, 0},
-            {17, 170, 0, 1},
-            {17, 171, 0, 1},
-            {17, 172, 0, 1},
-            {66, 173, 0, 1},
-            {66, 174, 0, 1},
-            {3005, 175, 0, 1},
-            {3005, 176, 0, 1},
-            {3005, 177, 0, 1},
-            {66, 178, 0, 1},
-            {2049, 179, 0, 1},
-            {58, 180, 0, 1},
-            {67, 181, 0, 1},
-            {2001, 182, 0, 0},
-            {2049, 183, 0, 1},
-            {67, 184, 0, 1},
-            {2013, 185, 0, 0},
-            {40, 186, 0, 0},
-            {3001, 187, 0, 1},
-            {3001, 188, 0, 1},
-            {66, 189, 0, 1},
-            {66, 190, 0, 1},
-            {3001, 191, 0, 1},
-            {3001, 192, 0, 1},
-            {3001, 193, 0, 1},
-            {3001, 194, 0, 1},
-            {3001, 195, 0, 1},
-            {3001, 196, 0, 1},
-            {3001, 197, 0, 1},
-            {3001, 198, 0, 1},
-            {3001, 199, 0, 1},
-            {3001, 200, 0, 1},
-            {3001, 201, 0, 1},
-            {3001, 202, 0, 1},
-            {3001, 203, 0, 1},
-            {3001, 204, 0, 1},
-            {3001, 205, 0, 1},
-            {3001, 206, 0, 1},
-            {3001, 207, 0, 1},
-            {3001, 208, 0, 1},
-            {3001, 209, 0, 1},
-            {3001, 210, 0, 1},
-            {3001, 211, 0, 1},
-            {3001, 212, 0, 1},
-            {3001, 213, 0, 1},
-            {3001, 214, 0, 1},
-            {3005, 215, 0, 1},
-            {3005, 216, 0, 1},
-            {3005, 217, 0, 1},
-            {64, 218, 0, 1},
-            {58, 219, 0, 1},
-            {58, 220, 0, 1},
-            {2022, 221, 0, 0},
-            {2049, 222, 0, 1},
-            {2048, 223, 0, 1},
-            {2012, 224, 0, 1},
-            {66, 225, 0, 1},
-            {66, 226, 0, 1},
-            {66, 227, 0, 1},
-            {67, 228, 0, 1},
-            {2049, 229, 0, 1},
-            {2049, 230, 0, 1},
-            {2024, 231, 0, 0},
-            {2011, 232, 0, 1},
-            {2011, 233, 0, 1},
-            {2011, 234, 0, 1},
-            {2008, 235, 0, 1},
-            {38, 236, 0, 0},
-            {2008, 237, 0, 1},
-            {2007, 238, 0, 1},
-            {2007, 239, 0, 1},
-            {2011, 240, 0, 1},
-            {2011, 241, 0, 1},
-            {11, 242, 0, 1},
-            {11, 243, 0, 1},
-            {11, 244, 0, 1},
-            {11, 245, 0, 1},
-            {11, 246, 0, 1},
-            {11, 247, 0, 1},
-            {2012, 248, 0, 1},
-        }},
-        {"Tenements (MAP17)", {true, true, true}, {0, 1, 0}, 17, 421, {
-            {1, 0, 0, 1},
-            {2018, 1, 0, 0},
-            {2012, 2, 0, 1},
-            {2012, 3, 0, 1},
-            {2, 4, 0, 1},
-            {3, 5, 0, 1},
-            {4, 6, 0, 1},
-            {2013, 7, 0, 0},
-            {3001, 8, 0, 1},
-            {3001, 9, 0, 1},
-            {3001, 10, 0, 1},
-            {3001, 11, 0, 1},
-            {3001, 12, 0, 1},
-            {3001, 13, 0, 1},
-            {3001, 14, 0, 1},
-            {3001, 15, 0, 1},
-            {3001, 16, 0, 1},
-            {3001, 17, 0, 1},
-            {2001, 18, 0, 0},
-            {2008, 19, 0, 1},
-            {2008, 20, 0, 1},
-            {46, 21, 0, 1},
-            {46, 22, 0, 1},
-            {45, 23, 0, 1},
-            {45, 24, 0, 1},
-            {58, 25, 0, 1},
-            {58, 26, 0, 1},
-            {58, 27, 0, 1},
-            {58, 28, 0, 1},
-            {58, 29, 0, 1},
-            {69, 30, 0, 1},
-            {62, 31, 0, 1},
-            {2011, 32, 0, 1},
-            {2008, 33, 0, 1},
-            {13, 34, 0, 0},
-            {3004, 35, 0, 1},
-            {9, 36, 0, 1},
-            {9, 37, 0, 1},
-            {14, 38, 0, 1},
-            {9, 39, 0, 1},
-            {65, 40, 0, 1},
-            {3005, 41, 0, 1},
-            {3005, 42, 0, 1},
-            {3005, 43, 0, 1},
-            {9, 44, 0, 1},
-            {65, 45, 0, 1},
-            {3005, 46, 0, 1},
-            {3005, 47, 0, 1},
-            {3005, 48, 0, 1},
-            {3001, 49, 0, 1},
-            {3001, 50, 0, 1},
-            {3001, 51, 0, 1},
-            {3001, 52, 0, 1},
-            {3001, 53, 0, 1},
-            {14, 54, 0, 1},
-            {14, 55, 0, 1},
-            {46, 56, 0, 1},
-            {46, 57, 0, 1},
-            {2008, 58, 0, 1},
-            {2008, 59, 0, 1},
-            {2008, 60, 0, 1},
-            {2012, 61, 0, 1},
-            {2012, 62, 0, 1},
-            {2049, 63, 0, 1},
-            {44, 64, 0, 1},
-            {44, 65, 0, 1},
-            {44, 66, 0, 1},
-            {44, 67, 0, 1},
-            {46, 68, 0, 1},
-            {5, 69, 0, 0},
-            {2049, 70, 0, 1},
-            {2012, 71, 0, 1},
-            {2012, 72, 0, 1},
-            {2012, 73, 0, 1},
-            {2011, 74, 0, 1},
-            {2013, 75, 0, 0},
-            {39, 76, 0, 0},
-            {2003, 77, 0, 0},
-            {2046, 78, 0, 1},
-            {2010, 79, 0, 1},
-            {2010, 80, 0, 1},
-            {2024, 81, 0, 0},
-            {45, 82, 0, 1},
-            {45, 83, 0, 1},
-            {56, 84, 0, 1},
-            {56, 85, 0, 1},
-            {56, 86, 0, 1},
-            {57, 87, 0, 1},
-            {57, 88, 0, 1},
-            {57, 89, 0, 1},
-            {57, 90, 0, 1},
-            {36, 91, 0, 1},
-            {2002, 92, 0, 0},
-            {2005, 93, 0, 1},
-            {46, 94, 0, 1},
-            {30, 95, 0, 1},
-            {30, 96, 0, 1},
-            {46, 97, 0, 1},
-            {46, 98, 0, 1},
-            {30, 99, 0, 1},
-            {30, 100, 0, 1},
-            {46, 101, 0, 1},
-            {2006, 102, 0, 0},
-            {44, 103, 0, 1},
-            {46, 104, 0, 1},
-            {46, 105, 0, 1},
-            {46, 106, 0, 1},
-            {46, 107, 0, 1},
-            {46, 108, 0, 1},
-            {46, 109, 0, 1},
-            {46, 110, 0, 1},
-            {46, 111, 0, 1},
-            {45, 112, 0, 1},
-            {45, 113, 0, 1},
-            {2004, 114, 0, 0},
-            {19, 115, 0, 1},
-            {10, 116, 0, 1},
-            {2047, 117, 0, 1},
-            {2010, 118, 0, 1},
-            {2015, 119, 0, 1},
-            {2015, 120, 0, 1},
-            {2015, 121, 0, 1},
-            {2015, 122, 0, 1},
-            {2014, 123, 0, 1},
-            {2014, 124, 0, 1},
-            {2014, 125, 0, 1},
-            {2014, 126, 0, 1},
-            {58, 127, 0, 1},
-            {58, 128, 0, 1},
-            {58, 129, 0, 1},
-            {58, 130, 0, 1},
-            {58, 131, 0, 1},
-            {2012, 132, 0, 1},
-            {2012, 133, 0, 1},
-            {2012, 134, 0, 1},
-            {2012, 135, 0, 1},
-            {2025, 136, 0, 1},
-            {3005, 137, 0, 1},
-            {3005, 138, 0, 1},
-            {65, 139, 0, 1},
-            {65, 140, 0, 1},
-            {3005, 141, 0, 1},
-            {3005, 142, 0, 1},
-            {3001, 143, 0, 1},
-            {3001, 144, 0, 1},
-            {3001, 145, 0, 1},
-            {3001, 146, 0, 1},
-            {65, 147, 0, 1},
-            {9, 148, 0, 1},
-            {9, 149, 0, 1},
-            {9, 150, 0, 1},
-            {9, 151, 0, 1},
-            {9, 152, 0, 1},
-            {58, 153, 0, 1},
-            {71, 154, 0, 1},
-            {66, 155, 0, 1},
-            {2011, 156, 0, 1},
-            {2011, 157, 0, 1},
-            {2011, 158, 0, 1},
-            {2011, 159, 0, 1},
-            {2011, 160, 0, 1},
-            {2011, 161, 0, 1},
-            {2011, 162, 0, 1},
-            {2012, 163, 0, 1},
-            {2012, 164, 0, 1},
-            {2012, 165, 0, 1},
-            {2012, 166, 0, 1},
-            {2012, 167, 0, 1},
-            {2019, 168, 0, 0},
-            {9, 169, 0, 1},
-            {9, 170, 0, 1},
-            {9, 171, 0, 1},
-            {9, 172, 0, 1},
-            {9, 173, 0, 1},
-            {2035, 174, 0, 1},
-            {2035, 175, 0, 1},
-            {2035, 176, 0, 1},
-            {2035, 177, 0, 1},
-            {2035, 178, 0, 1},
-            {2018, 179, 0, 0},
-            {2048, 180, 0, 1},
-            {2008, 181, 0, 1},
-            {2008, 182, 0, 1},
-            {2008, 183, 0, 1},
-            {2048, 184, 0, 1},
-            {2048, 185, 0, 1},
-            {2048, 186, 0, 1},
-            {2015, 187, 0, 1},
-            {2015, 188, 0, 1},
-            {2015, 189, 0, 1},
-            {2015, 190, 0, 1},
-            {2014, 191, 0, 1},
-            {2014, 192, 0, 1},
-            {2014, 193, 0, 1},
-            {2014, 194, 0, 1},
-            {2014, 195, 0, 1},
-            {2014, 196, 0, 1},
-            {2014, 197, 0, 1},
-            {2014, 198, 0, 1},
-            {2015, 199, 0, 1},
-            {2015, 200, 0, 1},
-            {2015, 201, 0, 1},
-            {2015, 202, 0, 1},
-            {2015, 203, 0, 1},
-            {2015, 204, 0, 1},
-            {2015, 205, 0, 1},
-            {2015, 206, 0, 1},
-            {2015, 207, 0, 1},
-            {2015, 208, 0, 1},
-            {2015, 209, 0, 1},
-            {2015, 210, 0, 1},
-            {2015, 211, 0, 1},
-            {2014, 212, 0, 1},
-            {2014, 213, 0, 1},
-            {2014, 214, 0, 1},
-            {2035, 215, 0, 1},
-            {2035, 216, 0, 1},
-            {2035, 217, 0, 1},
-            {2023, 218, 0, 0},
-            {2012, 219, 0, 1},
-            {2012, 220, 0, 1},
-            {2012, 221, 0, 1},
-            {2035, 222, 0, 1},
-            {2035, 223, 0, 1},
-            {2035, 224, 0, 1},
-            {2035, 225, 0, 1},
-            {2035, 226, 0, 1},
-            {2035, 227, 0, 1},
-            {2035, 228, 0, 1},
-            {2035, 229, 0, 1},
-            {2049, 230, 0, 1},
-            {2049, 231, 0, 1},
-            {2049, 232, 0, 1},
-            {2048, 233, 0, 1},
-            {3001, 234, 0, 1},
-            {3001, 235, 0, 1},
-            {3001, 236, 0, 1},
-            {65, 237, 0, 1},
-            {68, 238, 0, 1},
-            {2049, 239, 0, 1},
-            {2048, 240, 0, 1},
-            {2048, 241, 0, 1},
-            {2015, 242, 0, 1},
-            {2015, 243, 0, 1},
-            {2015, 244, 0, 1},
-            {2015, 245, 0, 1},
-            {2015, 246, 0, 1},
-            {2015, 247, 0, 1},
-            {2015, 248, 0, 1},
-            {2015, 249, 0, 1},
-            {2015, 250, 0, 1},
-            {2015, 251, 0, 1},
-            {2015, 252, 0, 1},
-            {2015, 253, 0, 1},
-            {2015, 254, 0, 1},
-            {2015, 255, 0, 1},
-            {28, 256, 0, 1},
-            {2012, 257, 0, 1},
-            {2012, 258, 0, 1},
-            {2012, 259, 0, 1},
-            {2010, 260, 0, 1},
-            {8, 261, 0, 0},
-            {2011, 262, 0, 1},
-            {2014, 263, 0, 1},
-            {2014, 264, 0, 1},
-            {2014, 265, 0, 1},
-            {2014, 266, 0, 1},
-            {2014, 267, 0, 1},
-            {2014, 268, 0, 1},
-            {2014, 269, 0, 1},
-            {2014, 270, 0, 1},
-            {2014, 271, 0, 1},
-            {2014, 272, 0, 1},
-            {2014, 273, 0, 1},
-            {2014, 274, 0, 1},
-            {2014, 275, 0, 1},
-            {2014, 276, 0, 1},
-            {2014, 277, 0, 1},
-            {2014, 278, 0, 1},
-            {2014, 279, 0, 1},
-            {2014, 280, 0, 1},
-            {2014, 281, 0, 1},
-            {2014, 282, 0, 1},
-            {49, 283, 0, 1},
-            {52, 284, 0, 1},
-            {3005, 285, 0, 1},
-            {3004, 286, 0, 1},
-            {3004, 287, 0, 1},
-            {3004, 288, 0, 1},
-            {3004, 289, 0, 1},
-            {3004, 290, 0, 1},
-            {9, 291, 0, 1},
-            {3004, 292, 0, 1},
-            {3004, 293, 0, 1},
-            {3004, 294, 0, 1},
-            {65, 295, 0, 1},
-            {65, 296, 0, 1},
-            {65, 297, 0, 1},
-            {65, 298, 0, 1},
-            {9, 299, 0, 1},
-            {9, 300, 0, 1},
-            {9, 301, 0, 1},
-            {9, 302, 0, 1},
-            {2012, 303, 0, 1},
-            {2012, 304, 0, 1},
-            {2049, 305, 0, 1},
-            {71, 306, 0, 1},
-            {71, 307, 0, 1},
-            {65, 308, 0, 1},
-            {65, 309, 0, 1},
-            {65, 310, 0, 1},
-            {65, 311, 0, 1},
-            {3001, 312, 0, 1},
-            {3001, 313, 0, 1},
-            {3001, 314, 0, 1},
-            {3001, 315, 0, 1},
-            {3001, 316, 0, 1},
-            {3001, 317, 0, 1},
-            {66, 318, 0, 1},
-            {3005, 319, 0, 1},
-            {3005, 320, 0, 1},
-            {71, 321, 0, 1},
-            {2015, 322, 0, 1},
-            {2015, 323, 0, 1},
-            {2015, 324, 0, 1},
-            {2015, 325, 0, 1},
-            {2015, 326, 0, 1},
-            {2015, 327, 0, 1},
-            {2015, 328, 0, 1},
-            {2015, 329, 0, 1},
-            {2015, 330, 0, 1},
-            {2015, 331, 0, 1},
-            {2015, 332, 0, 1},
-            {2015, 333, 0, 1},
-            {2014, 334, 0, 1},
-            {2014, 335, 0, 1},
-            {2014, 336, 0, 1},
-            {2014, 337, 0, 1},
-            {2014, 338, 0, 1},
-            {2014, 339, 0, 1},
-            {2014, 340, 0, 1},
-            {2014, 341, 0, 1},
-            {2014, 342, 0, 1},
-            {2014, 343, 0, 1},
-            {2014, 344, 0, 1},
-            {2010, 345, 0, 1},
-            {2010, 346, 0, 1},
-            {2010, 347, 0, 1},
-            {2010, 348, 0, 1},
-            {2049, 349, 0, 1},
-            {2049, 350, 0, 1},
-            {3001, 351, 0, 1},
-            {3001, 352, 0, 1},
-            {3001, 353, 0, 1},
-            {3001, 354, 0, 1},
-            {3001, 355, 0, 1},
-            {64, 356, 0, 1},
-            {2012, 357, 0, 1},
-            {2012, 358, 0, 1},
-            {2012, 359, 0, 1},
-            {2012, 360, 0, 1},
-            {2012, 361, 0, 1},
-            {2012, 362, 0, 1},
-            {2012, 363, 0, 1},
-            {2012, 364, 0, 1},
-            {2049, 365, 0, 1},
-            {2015, 366, 0, 1},
-            {2015, 367, 0, 1},
-            {2015, 368, 0, 1},
-            {2015, 369, 0, 1},
-            {2015, 370, 0, 1},
-            {2015, 371, 0, 1},
-            {2015, 372, 0, 1},
-            {2015, 373, 0, 1},
-            {2015, 374, 0, 1},
-            {2015, 375, 0, 1},
-            {2015, 376, 0, 1},
-            {2015, 377, 0, 1},
-            {2015, 378, 0, 1},
-            {2015, 379, 0, 1},
-            {65, 380, 0, 1},
-            {65, 381, 0, 1},
-            {2046, 382, 0, 1},
-            {14, 383, 0, 1},
-            {44, 384, 0, 1},
-            {44, 385, 0, 1},
-            {44, 386, 0, 1},
-            {44, 387, 0, 1},
-            {17, 388, 0, 1},
-            {2047, 389, 0, 1},
-            {2047, 390, 0, 1},
-            {2047, 391, 0, 1},
-            {69, 392, 0, 1},
-            {68, 393, 0, 1},
-            {2047, 394, 0, 1},
-            {2047, 395, 0, 1},
-            {2047, 396, 0, 1},
-            {3001, 397, 0, 1},
-            {65, 398, 0, 1},
-            {65, 399, 0, 1},
-            {9, 400, 0, 1},
-            {9, 401, 0, 1},
-            {11, 402, 0, 1},
-            {11, 403, 0, 1},
-            {11, 404, 0, 1},
-            {11, 405, 0, 1},
-            {11, 406, 0, 1},
-            {11, 407, 0, 1},
-            {11, 408, 0, 1},
-            {14, 409, 0, 1},
-            {3001, 410, 0, 1},
-            {3001, 411, 0, 1},
-            {9, 412, 0, 1},
-            {9, 413, 0, 1},
-            {9, 414, 0, 1},
-            {65, 415, 0, 1},
-            {65, 416, 0, 1},
-            {65, 417, 0, 1},
-            {65, 418, 0, 1},
-            {83, 419, 0, 0},
-            {16, 420, 0, 1},
-        }},
-        {"The Courtyard (MAP18)", {true, true, false}, {1, 1, 0}, 17, 498, {
-            {1, 0, 0, 1},
-            {2, 1, 0, 1},
-            {3, 2, 0, 1},
-            {4, 3, 0, 1},
-            {11, 4, 0, 1},
-            {14, 5, 0, 1},
-            {3002, 6, 0, 1},
-            {3002, 7, 0, 1},
-            {3001, 8, 0, 1},
-            {3001, 9, 0, 1},
-            {3001, 10, 0, 1},
-            {69, 11, 0, 1},
-            {2001, 12, 0, 0},
-            {3001, 13, 0, 1},
-            {3001, 14, 0, 1},
-            {3001, 15, 0, 1},
-            {3001, 16, 0, 1},
-            {3001, 17, 0, 1},
-            {3001, 18, 0, 1},
-            {3001, 19, 0, 1},
-            {3001, 20, 0, 1},
-            {3001, 21, 0, 1},
-            {3001, 22, 0, 1},
-            {3004, 23, 0, 1},
-            {3001, 24, 0, 1},
-            {3001, 25, 0, 1},
-            {3001, 26, 0, 1},
-            {3001, 27, 0, 1},
-            {3001, 28, 0, 1},
-            {3002, 29, 0, 1},
-            {3002, 30, 0, 1},
-            {3002, 31, 0, 1},
-            {3001, 32, 0, 1},
-            {3001, 33, 0, 1},
-            {3001, 34, 0, 1},
-            {3001, 35, 0, 1},
-            {2004, 36, 0, 0},
-            {17, 37, 0, 1},
-            {17, 38, 0, 1},
-            {2008, 39, 0, 1},
-            {2008, 40, 0, 1},
-            {2008, 41, 0, 1},
-            {2008, 42, 0, 1},
-            {2008, 43, 0, 1},
-            {2008, 44, 0, 1},
-            {2008, 45, 0, 1},
-            {2008, 46, 0, 1},
-            {2008, 47, 0, 1},
-            {2018, 48, 0, 0},
-            {58, 49, 0, 1},
-            {58, 50, 0, 1},
-            {58, 51, 0, 1},
-            {2023, 52, 0, 0},
-            {9, 53, 0, 1},
-            {9, 54, 0, 1},
-            {9, 55, 0, 1},
-            {9, 56, 0, 1},
-            {9, 57, 0, 1},
-            {3002, 58, 0, 1},
-            {3002, 59, 0, 1},
-            {3002, 60, 0, 1},
-            {3002, 61, 0, 1},
-            {3002, 62, 0, 1},
-            {3002, 63, 0, 1},
-            {3002, 64, 0, 1},
-            {3002, 65, 0, 1},
-            {3002, 66, 0, 1},
-            {9, 67, 0, 1},
-            {9, 68, 0, 1},
-            {9, 69, 0, 1},
-            {9, 70, 0, 1},
-            {9, 71, 0, 1},
-            {9, 72, 0, 1},
-            {9, 73, 0, 1},
-            {9, 74, 0, 1},
-            {9, 75, 0, 1},
-            {9, 76, 0, 1},
-            {9, 77, 0, 1},
-            {9, 78, 0, 1},
-            {9, 79, 0, 1},
-            {9, 80, 0, 1},
-            {9, 81, 0, 1},
-            {14, 82, 0, 1},
-            {14, 83, 0, 1},
-            {58, 84, 0, 1},
-            {58, 85, 0, 1},
-            {58, 86, 0, 1},
-            {58, 87, 0, 1},
-            {58, 88, 0, 1},
-            {58, 89, 0, 1},
-            {58, 90, 0, 1},
-            {58, 91, 0, 1},
-            {2048, 92, 0, 1},
-            {2012, 93, 0, 1},
-            {2011, 94, 0, 1},
-            {2002, 95, 0, 0},
-            {2011, 96, 0, 1},
-            {2011, 97, 0, 1},
-            {2011, 98, 0, 1},
-            {2011, 99, 0, 1},
-            {2011, 100, 0, 1},
-            {9, 101, 0, 1},
-            {3002, 102, 0, 1},
-            {3002, 103, 0, 1},
-            {3002, 104, 0, 1},
-            {3002, 105, 0, 1},
-            {3002, 106, 0, 1},
-            {3002, 107, 0, 1},
-            {3002, 108, 0, 1},
-            {3002, 109, 0, 1},
-            {3002, 110, 0, 1},
-            {3002, 111, 0, 1},
-            {3002, 112, 0, 1},
-            {3002, 113, 0, 1},
-            {3002, 114, 0, 1},
-            {3002, 115, 0, 1},
-            {3002, 116, 0, 1},
-            {3002, 117, 0, 1},
-            {3002, 118, 0, 1},
-            {3002, 119, 0, 1},
-            {3002, 120, 0, 1},
-            {3002, 121, 0, 1},
-            {3001, 122, 0, 1},
-            {3001, 123, 0, 1},
-            {3001, 124, 0, 1},
-            {3001, 125, 0, 1},
-            {3001, 126, 0, 1},
-            {3001, 127, 0, 1},
-            {3001, 128, 0, 1},
-            {3001, 129, 0, 1},
-            {2003, 130, 0, 0},
-            {2011, 131, 0, 1},
-            {2011, 132, 0, 1},
-            {2011, 133, 0, 1},
-            {2011, 134, 0, 1},
-            {2011, 135, 0, 1},
-            {2011, 136, 0, 1},
-            {3001, 137, 0, 1},
-            {3001, 138, 0, 1},
-            {3001, 139, 0, 1},
-            {3001, 140, 0, 1},
-            {3001, 141, 0, 1},
-            {3001, 142, 0, 1},
-            {3001, 143, 0, 1},
-            {3001, 144, 0, 1},
-            {3001, 145, 0, 1},
-            {3001, 146, 0, 1},
-            {2010, 147, 0, 1},
-            {2010, 148, 0, 1},
-            {69, 149, 0, 1},
-            {2010, 150, 0, 1},
-            {2010, 151, 0, 1},
-            {2011, 152, 0, 1},
-            {2011, 153, 0, 1},
-            {2011, 154, 0, 1},
-            {2011, 155, 0, 1},
-            {2011, 156, 0, 1},
-            {2011, 157, 0, 1},
-            {66, 158, 0, 1},
-            {3001, 159, 0, 1},
-            {3001, 160, 0, 1},
-            {3001, 161, 0, 1},
-            {3001, 162, 0, 1},
-            {3001, 163, 0, 1},
-            {3001, 164, 0, 1},
-            {3001, 165, 0, 1},
-            {2010, 166, 0, 1},
-            {2010, 167, 0, 1},
-            {2011, 168, 0, 1},
-            {2011, 169, 0, 1},
-            {2024, 170, 0, 0},
-            {2024, 171, 0, 0},
-            {17, 172, 0, 1},
-            {69, 173, 0, 1},
-            {3005, 174, 0, 1},
-            {3005, 175, 0, 1},
-            {3005, 176, 0, 1},
-            {2048, 177, 0, 1},
-            {2049, 178, 0, 1},
-            {2046, 179, 0, 1},
-            {3005, 180, 0, 1},
-            {3005, 181, 0, 1},
-            {3005, 182, 0, 1},
-            {3005, 183, 0, 1},
-            {3005, 184, 0, 1},
-            {3005, 185, 0, 1},
-            {3005, 186, 0, 1},
-            {69, 187, 0, 1},
-            {2048, 188, 0, 1},
-            {2047, 189, 0, 1},
-            {58, 190, 0, 1},
-            {58, 191, 0, 1},
-            {58, 192, 0, 1},
-            {58, 193, 0, 1},
-            {58, 194, 0, 1},
-            {58, 195, 0, 1},
-            {3005, 196, 0, 1},
-            {3005, 197, 0, 1},
-            {8, 198, 0, 0},
-            {3001, 199, 0, 1},
-            {3001, 200, 0, 1},
-            {3001, 201, 0, 1},
-            {3001, 202, 0, 1},
-            {3001, 203, 0, 1},
-            {3001, 204, 0, 1},
-            {3001, 205, 0, 1},
-            {3001, 206, 0, 1},
-            {3002, 207, 0, 1},
-            {3002, 208, 0, 1},
-            {3002, 209, 0, 1},
-            {3002, 210, 0, 1},
-            {3002, 211, 0, 1},
-            {3002, 212, 0, 1},
-            {58, 213, 0, 1},
-            {58, 214, 0, 1},
-            {2012, 215, 0, 1},
-            {2012, 216, 0, 1},
-            {67, 217, 0, 1},
-            {2013, 218, 0, 0},
-            {3001, 219, 0, 1},
-            {3001, 220, 0, 1},
-            {3001, 221, 0, 1},
-            {3001, 222, 0, 1},
-            {3002, 223, 0, 1},
-            {3001, 224, 0, 1},
-            {3001, 225, 0, 1},
-            {3002, 226, 0, 1},
-            {2048, 227, 0, 1},
-            {2022, 228, 0, 0},
-            {2022, 229, 0, 0},
-            {2048, 230, 0, 1},
-            {2012, 231, 0, 1},
-            {2012, 232, 0, 1},
-            {2012, 233, 0, 1},
-            {2011, 234, 0, 1},
-            {2011, 235, 0, 1},
-            {2011, 236, 0, 1},
-            {2047, 237, 0, 1},
-            {2007, 238, 0, 1},
-            {2010, 239, 0, 1},
-            {2008, 240, 0, 1},
-            {2010, 241, 0, 1},
-            {2010, 242, 0, 1},
-            {2010, 243, 0, 1},
-            {9, 244, 0, 1},
-            {9, 245, 0, 1},
-            {9, 246, 0, 1},
-            {9, 247, 0, 1},
-            {9, 248, 0, 1},
-            {9, 249, 0, 1},
-            {9, 250, 0, 1},
-            {3002, 251, 0, 1},
-            {3001, 252, 0, 1},
-            {3001, 253, 0, 1},
-            {39, 254, 0, 0},
-            {3005, 255, 0, 1},
-            {3005, 256, 0, 1},
-            {3005, 257, 0, 1},
-            {3005, 258, 0, 1},
-            {3005, 259, 0, 1},
-            {3005, 260, 0, 1},
-            {3005, 261, 0, 1},
-            {58, 262, 0, 1},
-            {58, 263, 0, 1},
-            {58, 264, 0, 1},
-            {58, 265, 0, 1},
-            {14, 266, 0, 1},
-            {14, 267, 0, 1},
-            {40, 268, 0, 0},
-            {2048, 269, 0, 1},
-            {2048, 270, 0, 1},
-            {2011, 271, 0, 1},
-            {2011, 272, 0, 1},
-            {2011, 273, 0, 1},
-            {2015, 274, 0, 1},
-            {2015, 275, 0, 1},
-            {2015, 276, 0, 1},
-            {2015, 277, 0, 1},
-            {2015, 278, 0, 1},
-            {2015, 279, 0, 1},
-            {2015, 280, 0, 1},
-            {2015, 281, 0, 1},
-            {2015, 282, 0, 1},
-            {2015, 283, 0, 1},
-            {2015, 284, 0, 1},
-            {2014, 285, 0, 1},
-            {2014, 286, 0, 1},
-            {2014, 287, 0, 1},
-            {2014, 288, 0, 1},
-            {2014, 289, 0, 1},
-            {2014, 290, 0, 1},
-            {2014, 291, 0, 1},
-            {2014, 292, 0, 1},
-            {2014, 293, 0, 1},
-            {2014, 294, 0, 1},
-            {2014, 295, 0, 1},
-            {2014, 296, 0, 1},
-            {2015, 297, 0, 1},
-            {2015, 298, 0, 1},
-            {2015, 299, 0, 1},
-            {2015, 300, 0, 1},
-            {2015, 301, 0, 1},
-            {2015, 302, 0, 1},
-            {2015, 303, 0, 1},
-            {2015, 304, 0, 1},
-            {2015, 305, 0, 1},
-            {2015, 306, 0, 1},
-            {2015, 307, 0, 1},
-            {2015, 308, 0, 1},
-            {2015, 309, 0, 1},
-            {2014, 310, 0, 1},
-            {2014, 311, 0, 1},
-            {2014, 312, 0, 1},
-            {2014, 313, 0, 1},
-            {2014, 314, 0, 1},
-            {2014, 315, 0, 1},
-            {2014, 316, 0, 1},
-            {2014, 317, 0, 1},
-            {2014, 318, 0, 1},
-            {2014, 319, 0, 1},
-            {2014, 320, 0, 1},
-            {2014, 321, 0, 1},
-            {2014, 322, 0, 1},
-            {2014, 323, 0, 1},
-            {2014, 324, 0, 1},
-            {2014, 325, 0, 1},
-            {2014, 326, 0, 1},
-            {2014, 327, 0, 1},
-            {2014, 328, 0, 1},
-            {2014, 329, 0, 1},
-            {2014, 330, 0, 1},
-            {2014, 331, 0, 1},
-            {2014, 332, 0, 1},
-            {2014, 333, 0, 1},
-            {2014, 334, 0, 1},
-            {2014, 335, 0, 1},
-            {2014, 336, 0, 1},
-            {2014, 337, 0, 1},
-            {2014, 338, 0, 1},
-            {2014, 339, 0, 1},
-            {2014, 340, 0, 1},
-            {2014, 341, 0, 1},
-            {2014, 342, 0, 1},
-            {2014, 343, 0, 1},
-            {2014, 344, 0, 1},
-            {2014, 345, 0, 1},
-            {2014, 346, 0, 1},
-            {2014, 347, 0, 1},
-            {2014, 348, 0, 1},
-            {2014, 349, 0, 1},
-            {2014, 350, 0, 1},
-            {2014, 351, 0, 1},
-            {2014, 352, 0, 1},
-            {2014, 353, 0, 1},
-            {2014, 354, 0, 1},
-            {2014, 355, 0, 1},
-            {2014, 356, 0, 1},
-            {2014, 357, 0, 1},
-            {2014, 358, 0, 1},
-            {2014, 359, 0, 1},
-            {2014, 360, 0, 1},
-            {2014, 361, 0, 1},
-            {2014, 362, 0, 1},
-            {2014, 363, 0, 1},
-            {2014, 364, 0, 1},
-            {2014, 365, 0, 1},
-            {2014, 366, 0, 1},
-            {2014, 367, 0, 1},
-            {2014, 368, 0, 1},
-            {2014, 369, 0, 1},
-            {2014, 370, 0, 1},
-            {2014, 371, 0, 1},
-            {2014, 372, 0, 1},
-            {2014, 373, 0, 1},
-            {2014, 374, 0, 1},
-            {2014, 375, 0, 1},
-            {2014, 376, 0, 1},
-            {2014, 377, 0, 1},
-            {2014, 378, 0, 1},
-            {2014, 379, 0, 1},
-            {2014, 380, 0, 1},
-            {2014, 381, 0, 1},
-            {2014, 382, 0, 1},
-            {2014, 383, 0, 1},
-            {2014, 384, 0, 1},
-            {2014, 385, 0, 1},
-            {2014, 386, 0, 1},
-            {2014, 387, 0, 1},
-            {2014, 388, 0, 1},
-            {2014, 389, 0, 1},
-            {2014, 390, 0, 1},
-            {2014, 391, 0, 1},
-            {2014, 392, 0, 1},
-            {2014, 393, 0, 1},
-            {2014, 394, 0, 1},
-            {2014, 395, 0, 1},
-            {2014, 396, 0, 1},
-            {2014, 397, 0, 1},
-            {2014, 398, 0, 1},
-            {2014, 399, 0, 1},
-            {2006, 400, 0, 0},
-            {2046, 401, 0, 1},
-            {2046, 402, 0, 1},
-            {2015, 403, 0, 1},
-            {2015, 404, 0, 1},
-            {2015, 405, 0, 1},
-            {2015, 406, 0, 1},
-            {2015, 407, 0, 1},
-            {2015, 408, 0, 1},
-            {2015, 409, 0, 1},
-            {2015, 410, 0, 1},
-            {2015, 411, 0, 1},
-            {2015, 412, 0, 1},
-            {2015, 413, 0, 1},
-            {2015, 414, 0, 1},
-            {2015, 415, 0, 1},
-            {2015, 416, 0, 1},
-            {2015, 417, 0, 1},
-            {2015, 418, 0, 1},
-            {2015, 419, 0, 1},
-            {2015, 420, 0, 1},
-            {2015, 421, 0, 1},
-            {2015, 422, 0, 1},
-            {2015, 423, 0, 1},
-            {2015, 424, 0, 1},
-            {2015, 425, 0, 1},
-            {2015, 426, 0, 1},
-            {2014, 427, 0, 1},
-            {2014, 428, 0, 1},
-            {2014, 429, 0, 1},
-            {2014, 430, 0, 1},
-            {2014, 431, 0, 1},
-            {2014, 432, 0, 1},
-            {2014, 433, 0, 1},
-            {2014, 434, 0, 1},
-            {2014, 435, 0, 1},
-            {2014, 436, 0, 1},
-            {2014, 437, 0, 1},
-            {2014, 438, 0, 1},
-            {2014, 439, 0, 1},
-            {2014, 440, 0, 1},
-            {2014, 441, 0, 1},
-            {2014, 442, 0, 1},
-            {2014, 443, 0, 1},
-            {2014, 444, 0, 1},
-            {2014, 445, 0, 1},
-            {2014, 446, 0, 1},
-            {2014, 447, 0, 1},
-            {2014, 448, 0, 1},
-            {2014, 449, 0, 1},
-            {2014, 450, 0, 1},
-            {14, 451, 0, 1},
-            {14, 452, 0, 1},
-            {2046, 453, 0, 1},
-            {2046, 454, 0, 1},
-            {2012, 455, 0, 1},
-            {2012, 456, 0, 1},
-            {2012, 457, 0, 1},
-            {2026, 458, 0, 0},
-            {2012, 459, 0, 1},
-            {14, 460, 0, 1},
-            {82, 461, 0, 0},
-            {2008, 462, 0, 1},
-            {2008, 463, 0, 1},
-            {2008, 464, 0, 1},
-            {2008, 465, 0, 1},
-            {2008, 466, 0, 1},
-            {2008, 467, 0, 1},
-            {11, 468, 0, 1},
-            {11, 469, 0, 1},
-            {11, 470, 0, 1},
-            {11, 471, 0, 1},
-            {2019, 472, 0, 1},
-            {82, 473, 0, 1},
-            {2006, 474, 0, 1},
-            {2010, 475, 0, 1},
-            {2010, 476, 0, 1},
-            {2010, 477, 0, 1},
-            {2010, 478, 0, 1},
-            {2010, 479, 0, 1},
-            {2010, 480, 0, 1},
-            {2010, 481, 0, 1},
-            {2010, 482, 0, 1},
-            {2010, 483, 0, 1},
-            {2010, 484, 0, 1},
-            {2010, 485, 0, 1},
-            {17, 486, 0, 1},
-            {17, 487, 0, 1},
-            {83, 488, 0, 1},
-            {66, 489, 0, 1},
-            {69, 490, 0, 1},
-            {3001, 491, 0, 1},
-            {3001, 492, 0, 1},
-            {3001, 493, 0, 1},
-            {3001, 494, 0, 1},
-            {3001, 495, 0, 1},
-            {3001, 496, 0, 1},
-            {2014, 497, 0, 1},
-        }},
-        {"The Citadel (MAP19)", {true, true, true}, {1, 1, 1}, 15, 437, {
-            {1, 0, 0, 1},
-            {2, 1, 0, 1},
-            {3, 2, 0, 1},
-            {4, 3, 0, 1},
-            {3001, 4, 0, 1},
-            {3001, 5, 0, 1},
-            {3001, 6, 0, 1},
-            {3001, 7, 0, 1},
-            {3001, 8, 0, 1},
-            {3001, 9, 0, 1},
-            {3001, 10, 0, 1},
-            {2008, 11, 0, 1},
-            {2011, 12, 0, 1},
-            {2011, 13, 0, 1},
-            {3001, 14, 0, 1},
-            {3001, 15, 0, 1},
-            {3001, 16, 0, 1},
-            {3001, 17, 0, 1},
-            {3001, 18, 0, 1},
-            {3001, 19, 0, 1},
-            {3001, 20, 0, 1},
-            {2001, 21, 0, 1},
-            {9, 22, 0, 1},
-            {9, 23, 0, 1},
-            {9, 24, 0, 1},
-            {2008, 25, 0, 1},
-            {2008, 26, 0, 1},
-            {2011, 27, 0, 1},
-            {2011, 28, 0, 1},
-            {2011, 29, 0, 1},
-            {2011, 30, 0, 1},
-            {2011, 31, 0, 1},
-            {2011, 32, 0, 1},
-            {2011, 33, 0, 1},
-            {58, 34, 0, 1},
-            {2011, 35, 0, 1},
-            {2011, 36, 0, 1},
-            {2011, 37, 0, 1},
-            {2011, 38, 0, 1},
-            {2011, 39, 0, 1},
-            {2011, 40, 0, 1},
-            {2011, 41, 0, 1},
-            {2011, 42, 0, 1},
-            {2011, 43, 0, 1},
-            {2011, 44, 0, 1},
-            {2011, 45, 0, 1},
-            {2011, 46, 0, 1},
-            {2011, 47, 0, 1},
-            {2011, 48, 0, 1},
-            {2011, 49, 0, 1},
-            {2011, 50, 0, 1},
-            {2011, 51, 0, 1},
-            {2008, 52, 0, 1},
-            {2008, 53, 0, 1},
-            {2008, 54, 0, 1},
-            {2008, 55, 0, 1},
-            {58, 56, 0, 1},
-            {2008, 57, 0, 1},
-            {2008, 58, 0, 1},
-            {2008, 59, 0, 1},
-            {2007, 60, 0, 1},
-            {58, 61, 0, 1},
-            {58, 62, 0, 1},
-            {2007, 63, 0, 1},
-            {2018, 64, 0, 0},
-            {58, 65, 0, 1},
-            {58, 66, 0, 1},
-            {58, 67, 0, 1},
-            {58, 68, 0, 1},
-            {58, 69, 0, 1},
-            {58, 70, 0, 1},
-            {58, 71, 0, 1},
-            {58, 72, 0, 1},
-            {58, 73, 0, 1},
-            {58, 74, 0, 1},
-            {58, 75, 0, 1},
-            {2011, 76, 0, 1},
-            {58, 77, 0, 1},
-            {58, 78, 0, 1},
-            {58, 79, 0, 1},
-            {58, 80, 0, 1},
-            {58, 81, 0, 1},
-            {58, 82, 0, 1},
-            {58, 83, 0, 1},
-            {58, 84, 0, 1},
-            {58, 85, 0, 1},
-            {2011, 86, 0, 1},
-            {58, 87, 0, 1},
-            {2011, 88, 0, 1},
-            {2048, 89, 0, 1},
-            {2007, 90, 0, 1},
-            {3001, 91, 0, 1},
-            {3001, 92, 0, 1},
-            {3001, 93, 0, 1},
-            {3001, 94, 0, 1},
-            {3001, 95, 0, 1},
-            {3001, 96, 0, 1},
-            {3001, 97, 0, 1},
-            {3001, 98, 0, 1},
-            {2002, 99, 0, 0},
-            {3002, 100, 0, 1},
-            {3002, 101, 0, 1},
-            {9, 102, 0, 1},
-            {9, 103, 0, 1},
-            {2012, 104, 0, 1},
-            {2007, 105, 0, 1},
-            {2048, 106, 0, 1},
-            {2011, 107, 0, 1},
-            {14, 108, 0, 1},
-            {58, 109, 0, 1},
-            {58, 110, 0, 1},
-            {3001, 111, 0, 1},
-            {14, 112, 0, 1},
-            {3001, 113, 0, 1},
-            {3001, 114, 0, 1},
-            {3001, 115, 0, 1},
-            {2023, 116, 0, 0},
-            {3001, 117, 0, 1},
-            {3001, 118, 0, 1},
-            {3001, 119, 0, 1},
-            {3001, 120, 0, 1},
-            {3001, 121, 0, 1},
-            {2011, 122, 0, 1},
-            {2007, 123, 0, 1},
-            {2007, 124, 0, 1},
-            {2007, 125, 0, 1},
-            {2049, 126, 0, 1},
-            {2019, 127, 0, 0},
-            {3001, 128, 0, 1},
-            {3001, 129, 0, 1},
-            {3001, 130, 0, 1},
-            {3001, 131, 0, 1},
-            {3001, 132, 0, 1},
-            {3001, 133, 0, 1},
-            {3001, 134, 0, 1},
-            {3001, 135, 0, 1},
-            {3001, 136, 0, 1},
-            {3001, 137, 0, 1},
-            {3001, 138, 0, 1},
-            {3001, 139, 0, 1},
-            {3001, 140, 0, 1},
-            {2014, 141, 0, 1},
-            {2014, 142, 0, 1},
-            {2014, 143, 0, 1},
-            {2014, 144, 0, 1},
-            {2014, 145, 0, 1},
-            {2014, 146, 0, 1},
-            {2014, 147, 0, 1},
-            {2014, 148, 0, 1},
-            {2014, 149, 0, 1},
-            {2014, 150, 0, 1},
-            {2014, 151, 0, 1},
-            {2014, 152, 0, 1},
-            {2014, 153, 0, 1},
-            {2014, 154, 0, 1},
-            {2014, 155, 0, 1},
-            {2014, 156, 0, 1},
-            {2014, 157, 0, 1},
-            {2014, 158, 0, 1},
-            {2014, 159, 0, 1},
-            {2014, 160, 0, 1},
-            {2014, 161, 0, 1},
-            {2014, 162, 0, 1},
-            {2014, 163, 0, 1},
-            {2014, 164, 0, 1},
-            {2014, 165, 0, 1},
-            {2014, 166, 0, 1},
-            {2014, 167, 0, 1},
-            {2014, 168, 0, 1},
-            {2014, 169, 0, 1},
-            {2014, 170, 0, 1},
-            {2014, 171, 0, 1},
-            {2014, 172, 0, 1},
-            {2014, 173, 0, 1},
-            {2013, 174, 0, 0},
-            {14, 175, 0, 1},
-            {2049, 176, 0, 1},
-            {2011, 177, 0, 1},
-            {2015, 178, 0, 1},
-            {2015, 179, 0, 1},
-            {2015, 180, 0, 1},
-            {2015, 181, 0, 1},
-            {2015, 182, 0, 1},
-            {2015, 183, 0, 1},
-            {2015, 184, 0, 1},
-            {2015, 185, 0, 1},
-            {2015, 186, 0, 1},
-            {2015, 187, 0, 1},
-            {31, 188, 0, 1},
-            {41, 189, 0, 1},
-            {41, 190, 0, 1},
-            {2008, 191, 0, 1},
-            {2048, 192, 0, 1},
-            {46, 193, 0, 1},
-            {46, 194, 0, 1},
-            {2008, 195, 0, 1},
-            {2008, 196, 0, 1},
-            {57, 197, 0, 1},
-            {57, 198, 0, 1},
-            {57, 199, 0, 1},
-            {57, 200, 0, 1},
-            {3001, 201, 0, 1},
-            {3001, 202, 0, 1},
-            {3001, 203, 0, 1},
-            {3001, 204, 0, 1},
-            {3001, 205, 0, 1},
-            {3001, 206, 0, 1},
-            {3001, 207, 0, 1},
-            {3001, 208, 0, 1},
-            {3001, 209, 0, 1},
-            {3001, 210, 0, 1},
-            {2008, 211, 0, 1},
-            {3002, 212, 0, 1},
-            {3002, 213, 0, 1},
-            {3002, 214, 0, 1},
-            {3002, 215, 0, 1},
-            {3001, 216, 0, 1},
-            {3001, 217, 0, 1},
-            {3001, 218, 0, 1},
-            {55, 219, 0, 1},
-            {55, 220, 0, 1},
-            {55, 221, 0, 1},
-            {55, 222, 0, 1},
-            {2018, 223, 0, 0},
-            {55, 224, 0, 1},
-            {3005, 225, 0, 1},
-            {68, 226, 0, 1},
-            {3005, 227, 0, 1},
-            {3002, 228, 0, 1},
-            {3002, 229, 0, 1},
-            {3002, 230, 0, 1},
-            {3002, 231, 0, 1},
-            {8, 232, 0, 0},
-            {2004, 233, 0, 1},
-            {2005, 234, 0, 1},
-            {3004, 235, 0, 1},
-            {3004, 236, 0, 1},
-            {3004, 237, 0, 1},
-            {3004, 238, 0, 1},
-            {3004, 239, 0, 1},
-            {3004, 240, 0, 1},
-            {3004, 241, 0, 1},
-            {3004, 242, 0, 1},
-            {3004, 243, 0, 1},
-            {3004, 244, 0, 1},
-            {3004, 245, 0, 1},
-            {3004, 246, 0, 1},
-            {3004, 247, 0, 1},
-            {3004, 248, 0, 1},
-            {3004, 249, 0, 1},
-            {3004, 250, 0, 1},
-            {2011, 251, 0, 1},
-            {2011, 252, 0, 1},
-            {2048, 253, 0, 1},
-            {3002, 254, 0, 1},
-            {3002, 255, 0, 1},
-            {3002, 256, 0, 1},
-            {3002, 257, 0, 1},
-            {3002, 258, 0, 1},
-            {2046, 259, 0, 1},
-            {14, 260, 0, 1},
-            {9, 261, 0, 1},
-            {2048, 262, 0, 1},
-            {2010, 263, 0, 1},
-            {9, 264, 0, 1},
-            {9, 265, 0, 1},
-            {9, 266, 0, 1},
-            {9, 267, 0, 1},
-            {45, 268, 0, 1},
-            {3005, 269, 0, 1},
-            {3001, 270, 0, 1},
-            {3001, 271, 0, 1},
-            {3001, 272, 0, 1},
-            {3001, 273, 0, 1},
-            {3001, 274, 0, 1},
-            {3001, 275, 0, 1},
-            {3001, 276, 0, 1},
-            {3001, 277, 0, 1},
-            {3001, 278, 0, 1},
-            {3001, 279, 0, 1},
-            {3001, 280, 0, 1},
-            {3001, 281, 0, 1},
-            {3001, 282, 0, 1},
-            {3001, 283, 0, 1},
-            {3001, 284, 0, 1},
-            {3001, 285, 0, 1},
-            {3001, 286, 0, 1},
-            {3001, 287, 0, 1},
-            {3001, 288, 0, 1},
-            {3001, 289, 0, 1},
-            {3001, 290, 0, 1},
-            {3001, 291, 0, 1},
-            {3001, 292, 0, 1},
-            {3001, 293, 0, 1},
-            {3001, 294, 0, 1},
-            {3001, 295, 0, 1},
-            {3001, 296, 0, 1},
-            {3001, 297, 0, 1},
-            {3001, 298, 0, 1},
-            {3001, 299, 0, 1},
-            {3001, 300, 0, 1},
-            {3001, 301, 0, 1},
-            {3001, 302, 0, 1},
-            {3001, 303, 0, 1},
-            {3001, 304, 0, 1},
-            {3001, 305, 0, 1},
-            {3001, 306, 0, 1},
-            {3001, 307, 0, 1},
-            {3001, 308, 0, 1},
-            {3001, 309, 0, 1},
-            {2010, 310, 0, 1},
-            {2010, 311, 0, 1},
-            {2049, 312, 0, 1},
-            {2012, 313, 0, 1},
-            {2012, 314, 0, 1},
-            {2022, 315, 0, 0},
-            {14, 316, 0, 1},
-            {14, 317, 0, 1},
-            {46, 318, 0, 1},
-            {46, 319, 0, 1},
-            {46, 320, 0, 1},
-            {3001, 321, 0, 1},
-            {3001, 322, 0, 1},
-            {3001, 323, 0, 1},
-            {3001, 324, 0, 1},
-            {46, 325, 0, 1},
-            {2014, 326, 0, 1},
-            {2014, 327, 0, 1},
-            {2014, 328, 0, 1},
-            {2014, 329, 0, 1},
-            {2014, 330, 0, 1},
-            {2014, 331, 0, 1},
-            {2014, 332, 0, 1},
-            {2014, 333, 0, 1},
-            {2014, 334, 0, 1},
-            {2014, 335, 0, 1},
-            {3002, 336, 0, 1},
-            {3002, 337, 0, 1},
-            {3002, 338, 0, 1},
-            {3002, 339, 0, 1},
-            {3002, 340, 0, 1},
-            {3002, 341, 0, 1},
-            {3002, 342, 0, 1},
-            {3002, 343, 0, 1},
-            {3002, 344, 0, 1},
-            {2007, 345, 0, 1},
-            {2007, 346, 0, 1},
-            {2008, 347, 0, 1},
-            {2008, 348, 0, 1},
-            {35, 349, 0, 1},
-            {3006, 350, 0, 1},
-            {3006, 351, 0, 1},
-            {3006, 352, 0, 1},
-            {3006, 353, 0, 1},
-            {3006, 354, 0, 1},
-            {3006, 355, 0, 1},
-            {3006, 356, 0, 1},
-            {3006, 357, 0, 1},
-            {3005, 358, 0, 1},
-            {3005, 359, 0, 1},
-            {3005, 360, 0, 1},
-            {2049, 361, 0, 1},
-            {2048, 362, 0, 1},
-            {2012, 363, 0, 1},
-            {2012, 364, 0, 1},
-            {2012, 365, 0, 1},
-            {2012, 366, 0, 1},
-            {2046, 367, 0, 1},
-            {2010, 368, 0, 1},
-            {2010, 369, 0, 1},
-            {40, 370, 0, 0},
-            {3002, 371, 0, 1},
-            {3002, 372, 0, 1},
-            {3002, 373, 0, 1},
-            {3002, 374, 0, 1},
-            {3002, 375, 0, 1},
-            {3002, 376, 0, 1},
-            {3002, 377, 0, 1},
-            {3002, 378, 0, 1},
-            {3002, 379, 0, 1},
-            {3002, 380, 0, 1},
-            {3002, 381, 0, 1},
-            {3002, 382, 0, 1},
-            {43, 383, 0, 1},
-            {43, 384, 0, 1},
-            {43, 385, 0, 1},
-            {43, 386, 0, 1},
-            {43, 387, 0, 1},
-            {54, 388, 0, 1},
-            {12, 389, 0, 1},
-            {12, 390, 0, 1},
-            {10, 391, 0, 1},
-            {10, 392, 0, 1},
-            {24, 393, 0, 1},
-            {24, 394, 0, 1},
-            {3006, 395, 0, 1},
-            {3006, 396, 0, 1},
-            {2012, 397, 0, 1},
-            {2012, 398, 0, 1},
-            {2012, 399, 0, 1},
-            {2012, 400, 0, 1},
-            {2012, 401, 0, 1},
-            {2012, 402, 0, 1},
-            {2024, 403, 0, 0},
-            {38, 404, 0, 0},
-            {39, 405, 0, 0},
-            {55, 406, 0, 1},
-            {55, 407, 0, 1},
-            {55, 408, 0, 1},
-            {55, 409, 0, 1},
-            {55, 410, 0, 1},
-            {55, 411, 0, 1},
-            {55, 412, 0, 1},
-            {55, 413, 0, 1},
-            {55, 414, 0, 1},
-            {2026, 415, 0, 0},
-            {2003, 416, 0, 0},
-            {11, 417, 0, 1},
-            {11, 418, 0, 1},
-            {11, 419, 0, 1},
-            {11, 420, 0, 1},
-            {11, 421, 0, 1},
-            {11, 422, 0, 1},
-            {2049, 423, 0, 1},
-            {2007, 424, 0, 1},
-            {2007, 425, 0, 1},
-            {2007, 426, 0, 1},
-            {2007, 427, 0, 1},
-            {2007, 428, 0, 1},
-            {2007, 429, 0, 1},
-            {2048, 430, 0, 1},
-            {82, 431, 0, 0},
-            {2006, 432, 0, 1},
-            {68, 433, 0, 1},
-            {17, 434, 0, 1},
-            {17, 435, 0, 1},
-            {16, 436, 0, 1},
-        }},
-        {"Gotcha! (MAP20)", {false, false, false}, {0, 0, 0}, 14, 256, {
-            {1, 0, 0, 1},
-            {2, 1, 0, 1},
-            {3, 2, 0, 1},
-            {4, 3, 0, 1},
-            {16, 4, 0, 1},
-            {44, 5, 0, 1},
-            {44, 6, 0, 1},
-            {44, 7, 0, 1},
-            {44, 8, 0, 1},
-            {2019, 9, 0, 0},
-            {2003, 10, 0, 0},
-            {2046, 11, 0, 1},
-            {2013, 12, 0, 0},
-            {45, 13, 0, 1},
-            {45, 14, 0, 1},
-            {45, 15, 0, 1},
-            {45, 16, 0, 1},
-            {7, 17, 0, 1},
-            {3003, 18, 0, 1},
-            {2046, 19, 0, 1},
-            {2046, 20, 0, 1},
-            {2046, 21, 0, 1},
-            {46, 22, 0, 1},
-            {46, 23, 0, 1},
-            {2012, 24, 0, 1},
-            {2012, 25, 0, 1},
-            {3005, 26, 0, 1},
-            {71, 27, 0, 1},
-            {3005, 28, 0, 1},
-            {57, 29, 0, 1},
-            {57, 30, 0, 1},
-            {65, 31, 0, 1},
-            {14, 32, 0, 1},
-            {2018, 33, 0, 0},
-            {65, 34, 0, 1},
-            {65, 35, 0, 1},
-            {65, 36, 0, 1},
-            {65, 37, 0, 1},
-            {2008, 38, 0, 1},
-            {2008, 39, 0, 1},
-            {14, 40, 0, 1},
-            {14, 41, 0, 1},
-            {14, 42, 0, 1},
-            {83, 43, 0, 0},
-            {2025, 44, 0, 1},
-            {17, 45, 0, 1},
-            {14, 46, 0, 1},
-            {2018, 47, 0, 0},
-            {2014, 48, 0, 1},
-            {2012, 49, 0, 1},
-            {2014, 50, 0, 1},
-            {2012, 51, 0, 1},
-            {45, 52, 0, 1},
-            {45, 53, 0, 1},
-            {82, 54, 0, 0},
-            {2008, 55, 0, 1},
-            {2008, 56, 0, 1},
-            {36, 57, 0, 1},
-            {2015, 58, 0, 1},
-            {2012, 59, 0, 1},
-            {46, 60, 0, 1},
-            {46, 61, 0, 1},
-            {41, 62, 0, 1},
-            {41, 63, 0, 1},
-            {71, 64, 0, 1},
-            {3005, 65, 0, 1},
-            {3005, 66, 0, 1},
-            {3005, 67, 0, 1},
-            {3005, 68, 0, 1},
-            {14, 69, 0, 1},
-            {2004, 70, 0, 0},
-            {2047, 71, 0, 1},
-            {2047, 72, 0, 1},
-            {2014, 73, 0, 1},
-            {2014, 74, 0, 1},
-            {2014, 75, 0, 1},
-            {2015, 76, 0, 1},
-            {2015, 77, 0, 1},
-            {2015, 78, 0, 1},
-            {2011, 79, 0, 1},
-            {17, 80, 0, 1},
-            {14, 81, 0, 1},
-            {44, 82, 0, 1},
-            {44, 83, 0, 1},
-            {2012, 84, 0, 1},
-            {9, 85, 0, 1},
-            {9, 86, 0, 1},
-            {9, 87, 0, 1},
-            {65, 88, 0, 1},
-            {2015, 89, 0, 1},
-            {2015, 90, 0, 1},
-            {2015, 91, 0, 1},
-            {2015, 92, 0, 1},
-            {42, 93, 0, 1},
-            {14, 94, 0, 1},
-            {45, 95, 0, 1},
-            {2019, 96, 0, 0},
-            {49, 97, 0, 1},
-            {2014, 98, 0, 1},
-            {2014, 99, 0, 1},
-            {2014, 100, 0, 1},
-            {2014, 101, 0, 1},
-            {71, 102, 0, 1},
-            {3005, 103, 0, 1},
-            {65, 104, 0, 1},
-            {3001, 105, 0, 1},
-            {3001, 106, 0, 1},
-            {3001, 107, 0, 1},
-            {3001, 108, 0, 1},
-            {2023, 109, 0, 0},
-            {2014, 110, 0, 1},
-            {2014, 111, 0, 1},
-            {2014, 112, 0, 1},
-            {2014, 113, 0, 1},
-            {2015, 114, 0, 1},
-            {2015, 115, 0, 1},
-            {2015, 116, 0, 1},
-            {46, 117, 0, 1},
-            {46, 118, 0, 1},
-            {2013, 119, 0, 0},
-            {2025, 120, 0, 1},
-            {2012, 121, 0, 1},
-            {2013, 122, 0, 0},
-            {65, 123, 0, 1},
-            {3001, 124, 0, 1},
-            {3006, 125, 0, 1},
-            {3006, 126, 0, 1},
-            {3006, 127, 0, 1},
-            {65, 128, 0, 1},
-            {2008, 129, 0, 1},
-            {2008, 130, 0, 1},
-            {2008, 131, 0, 1},
-            {2008, 132, 0, 1},
-            {11, 133, 0, 1},
-            {11, 134, 0, 1},
-            {11, 135, 0, 1},
-            {11, 136, 0, 1},
-            {11, 137, 0, 1},
-            {11, 138, 0, 1},
-            {11, 139, 0, 1},
-            {14, 140, 0, 1},
-            {14, 141, 0, 1},
-            {2006, 142, 0, 0},
-            {2047, 143, 0, 1},
-            {2047, 144, 0, 1},
-            {2013, 145, 0, 0},
-            {64, 146, 0, 1},
-            {2047, 147, 0, 1},
-            {11, 148, 0, 1},
-            {3001, 149, 0, 1},
-            {3001, 150, 0, 1},
-            {3001, 151, 0, 1},
-            {9, 152, 0, 1},
-            {9, 153, 0, 1},
-            {3006, 154, 0, 1},
-            {3006, 155, 0, 1},
-            {3006, 156, 0, 1},
-            {2012, 157, 0, 1},
-            {2011, 158, 0, 1},
-            {2011, 159, 0, 1},
-            {2015, 160, 0, 1},
-            {2015, 161, 0, 1},
-            {2015, 162, 0, 1},
-            {2015, 163, 0, 1},
-            {3001, 164, 0, 1},
-            {3001, 165, 0, 1},
-            {9, 166, 0, 1},
-            {9, 167, 0, 1},
-            {3001, 168, 0, 1},
-            {3001, 169, 0, 1},
-            {9, 170, 0, 1},
-            {9, 171, 0, 1},
-            {9, 172, 0, 1},
-            {65, 173, 0, 1},
-            {69, 174, 0, 1},
-            {9, 175, 0, 1},
-            {2008, 176, 0, 1},
-            {2008, 177, 0, 1},
-            {2008, 178, 0, 1},
-            {2012, 179, 0, 1},
-            {3001, 180, 0, 1},
-            {65, 181, 0, 1},
-            {9, 182, 0, 1},
-            {14, 183, 0, 1},
-            {44, 184, 0, 1},
-            {44, 185, 0, 1},
-            {46, 186, 0, 1},
-            {46, 187, 0, 1},
-            {56, 188, 0, 1},
-            {56, 189, 0, 1},
-            {2008, 190, 0, 1},
-            {2010, 191, 0, 1},
-            {2047, 192, 0, 1},
-            {2008, 193, 0, 1},
-            {2011, 194, 0, 1},
-            {2011, 195, 0, 1},
-            {2011, 196, 0, 1},
-            {2011, 197, 0, 1},
-            {3005, 198, 0, 1},
-            {3001, 199, 0, 1},
-            {3001, 200, 0, 1},
-            {3001, 201, 0, 1},
-            {3006, 202, 0, 1},
-            {3006, 203, 0, 1},
-            {66, 204, 0, 1},
-            {65, 205, 0, 1},
-            {3006, 206, 0, 1},
-            {66, 207, 0, 1},
-            {71, 208, 0, 1},
-            {3005, 209, 0, 1},
-            {3005, 210, 0, 1},
-            {3005, 211, 0, 1},
-            {2015, 212, 0, 1},
-            {2015, 213, 0, 1},
-            {2015, 214, 0, 1},
-            {2015, 215, 0, 1},
-            {2015, 216, 0, 1},
-            {2015, 217, 0, 1},
-            {2015, 218, 0, 1},
-            {2015, 219, 0, 1},
-            {2015, 220, 0, 1},
-            {2015, 221, 0, 1},
-            {2015, 222, 0, 1},
-            {2014, 223, 0, 1},
-            {2014, 224, 0, 1},
-            {2014, 225, 0, 1},
-            {2014, 226, 0, 1},
-            {2014, 227, 0, 1},
-            {2014, 228, 0, 1},
-            {41, 229, 0, 1},
-            {41, 230, 0, 1},
-            {3001, 231, 0, 1},
-            {3001, 232, 0, 1},
-            {11, 233, 0, 1},
-            {14, 234, 0, 1},
-            {2002, 235, 0, 1},
-            {2048, 236, 0, 1},
-            {2048, 237, 0, 1},
-            {71, 238, 0, 1},
-            {3001, 239, 0, 1},
-            {3001, 240, 0, 1},
-            {3001, 241, 0, 1},
-            {3001, 242, 0, 1},
-            {2048, 243, 0, 1},
-            {2048, 244, 0, 1},
-            {2048, 245, 0, 1},
-            {9, 246, 0, 1},
-            {64, 247, 0, 1},
-            {16, 248, 0, 1},
-            {2046, 249, 0, 1},
-            {2046, 250, 0, 1},
-            {2046, 251, 0, 1},
-            {2046, 252, 0, 1},
-            {2046, 253, 0, 1},
-            {2046, 254, 0, 1},
-            {2046, 255, 0, 1},
-        }},
-    },
-    {
-        {"Nirvana (MAP21)", {true, true, true}, {1, 1, 1}, 8, 217, {
-            {11, 0, 0, 1},
-            {11, 1, 0, 1},
-            {11, 2, 0, 1},
-            {11, 3, 0, 1},
-            {1, 4, 0, 1},
-            {2, 5, 0, 1},
-            {3, 6, 0, 1},
-            {4, 7, 0, 1},
-            {11, 8, 0, 1},
-            {14, 9, 0, 1},
-            {14, 10, 0, 1},
-            {14, 11, 0, 1},
-            {14, 12, 0, 1},
-            {14, 13, 0, 1},
-            {14, 14, 0, 1},
-            {14, 15, 0, 1},
-            {14, 16, 0, 1},
-            {14, 17, 0, 1},
-            {14, 18, 0, 1},
-            {2001, 19, 0, 1},
-            {9, 20, 0, 1},
-            {9, 21, 0, 1},
-            {9, 22, 0, 1},
-            {9, 23, 0, 1},
-            {9, 24, 0, 1},
-            {9, 25, 0, 1},
-            {9, 26, 0, 1},
-            {9, 27, 0, 1},
-            {9, 28, 0, 1},
-            {9, 29, 0, 1},
-            {9, 30, 0, 1},
-            {9, 31, 0, 1},
-            {9, 32, 0, 1},
-            {58, 33, 0, 1},
-            {58, 34, 0, 1},
-            {58, 35, 0, 1},
-            {9, 36, 0, 1},
-            {9, 37, 0, 1},
-            {9, 38, 0, 1},
-            {9, 39, 0, 1},
-            {9, 40, 0, 1},
-            {9, 41, 0, 1},
-            {66, 42, 0, 1},
-            {66, 43, 0, 1},
-            {66, 44, 0, 1},
-            {66, 45, 0, 1},
-            {2049, 46, 0, 1},
-            {2049, 47, 0, 1},
-            {2049, 48, 0, 1},
-            {2049, 49, 0, 1},
-            {2012, 50, 0, 1},
-            {2012, 51, 0, 1},
-            {2012, 52, 0, 1},
-            {2012, 53, 0, 1},
-            {2012, 54, 0, 1},
-            {2012, 55, 0, 1},
-            {2012, 56, 0, 1},
-            {2012, 57, 0, 1},
-            {2012, 58, 0, 1},
-            {2012, 59, 0, 1},
-            {2012, 60, 0, 1},
-            {2012, 61, 0, 1},
-            {2012, 62, 0, 1},
-            {2012, 63, 0, 1},
-            {2012, 64, 0, 1},
-            {2012, 65, 0, 1},
-            {2012, 66, 0, 1},
-            {2012, 67, 0, 1},
-            {2012, 68, 0, 1},
-            {2012, 69, 0, 1},
-            {82, 70, 0, 0},
-            {3001, 71, 0, 1},
-            {3001, 72, 0, 1},
-            {3001, 73, 0, 1},
-            {73, 74, 0, 1},
-            {79, 75, 0, 1},
-            {2003, 76, 0, 0},
-            {3001, 77, 0, 1},
-            {3001, 78, 0, 1},
-            {3001, 79, 0, 1},
-            {3001, 80, 0, 1},
-            {3001, 81, 0, 1},
-            {3001, 82, 0, 1},
-            {3001, 83, 0, 1},
-            {3001, 84, 0, 1},
-            {3001, 85, 0, 1},
-            {67, 86, 0, 1},
-            {67, 87, 0, 1},
-            {3001, 88, 0, 1},
-            {3001, 89, 0, 1},
-            {3001, 90, 0, 1},
-            {3001, 91, 0, 1},
-            {3001, 92, 0, 1},
-            {3001, 93, 0, 1},
-            {3001, 94, 0, 1},
-            {3001, 95, 0, 1},
-            {3001, 96, 0, 1},
-            {3001, 97, 0, 1},
-            {3001, 98, 0, 1},
-            {3001, 99, 0, 1},
-            {3001, 100, 0, 1},
-            {3001, 101, 0, 1},
-            {3001, 102, 0, 1},
-            {3001, 103, 0, 1},
-            {3001, 104, 0, 1},
-            {3001, 105, 0, 1},
-            {3001, 106, 0, 1},
-            {3001, 107, 0, 1},
-            {39, 108, 0, 0},
-            {8, 109, 0, 0},
-            {71, 110, 0, 1},
-            {71, 111, 0, 1},
-            {83, 112, 0, 0},
-            {2014, 113, 0, 1},
-            {2014, 114, 0, 1},
-            {2014, 115, 0, 1},
-            {2014, 116, 0, 1},
-            {2014, 117, 0, 1},
-            {2014, 118, 0, 1},
-            {2014, 119, 0, 1},
-            {2014, 120, 0, 1},
-            {2014, 121, 0, 1},
-            {2014, 122, 0, 1},
-            {2014, 123, 0, 1},
-            {2014, 124, 0, 1},
-            {2014, 125, 0, 1},
-            {2014, 126, 0, 1},
-            {2014, 127, 0, 1},
-            {2014, 128, 0, 1},
-            {11, 129, 0, 1},
-            {3001, 130, 0, 1},
-            {3001, 131, 0, 1},
-            {3001, 132, 0, 1},
-            {3001, 133, 0, 1},
-            {3001, 134, 0, 1},
-            {3001, 135, 0, 1},
-            {3001, 136, 0, 1},
-            {3001, 137, 0, 1},
-            {3001, 138, 0, 1},
-            {3001, 139, 0, 1},
-            {3001, 140, 0, 1},
-            {69, 141, 0, 1},
-            {69, 142, 0, 1},
-            {69, 143, 0, 1},
-            {69, 144, 0, 1},
-            {3001, 145, 0, 1},
-            {3001, 146, 0, 1},
-            {3001, 147, 0, 1},
-            {3001, 148, 0, 1},
-            {3001, 149, 0, 1},
-            {3001, 150, 0, 1},
-            {3001, 151, 0, 1},
-            {67, 152, 0, 1},
-            {2035, 153, 0, 1},
-            {2035, 154, 0, 1},
-            {2035, 155, 0, 1},
-            {2035, 156, 0, 1},
-            {2035, 157, 0, 1},
-            {3001, 158, 0, 1},
-            {3001, 159, 0, 1},
-            {3001, 160, 0, 1},
-            {3001, 161, 0, 1},
-            {3001, 162, 0, 1},
-            {3001, 163, 0, 1},
-            {3001, 164, 0, 1},
-            {3001, 165, 0, 1},
-            {3001, 166, 0, 1},
-            {3001, 167, 0, 1},
-            {3001, 168, 0, 1},
-            {3001, 169, 0, 1},
-            {69, 170, 0, 1},
-            {3001, 171, 0, 1},
-            {3001, 172, 0, 1},
-            {3001, 173, 0, 1},
-            {3001, 174, 0, 1},
-            {3001, 175, 0, 1},
-            {69, 176, 0, 1},
-            {65, 177, 0, 1},
-            {65, 178, 0, 1},
-            {65, 179, 0, 1},
-            {65, 180, 0, 1},
-            {65, 181, 0, 1},
-            {65, 182, 0, 1},
-            {65, 183, 0, 1},
-            {65, 184, 0, 1},
-            {65, 185, 0, 1},
-            {65, 186, 0, 1},
-            {65, 187, 0, 1},
-            {2002, 188, 0, 1},
-            {2046, 189, 0, 1},
-            {2025, 190, 0, 1},
-            {2025, 191, 0, 1},
-            {2025, 192, 0, 1},
-            {2025, 193, 0, 1},
-            {2022, 194, 0, 0},
-            {2010, 195, 0, 1},
-            {2010, 196, 0, 1},
-            {2010, 197, 0, 1},
-            {2010, 198, 0, 1},
-            {40, 199, 0, 0},
-            {3001, 200, 0, 1},
-            {3001, 201, 0, 1},
-            {3001, 202, 0, 1},
-            {2035, 203, 0, 1},
-            {3001, 204, 0, 1},
-            {3001, 205, 0, 1},
-            {3001, 206, 0, 1},
-            {3001, 207, 0, 1},
-            {3001, 208, 0, 1},
-            {3001, 209, 0, 1},
-            {3001, 210, 0, 1},
-            {3001, 211, 0, 1},
-            {3001, 212, 0, 1},
-            {3001, 213, 0, 1},
-            {2010, 214, 0, 1},
-            {38, 215, 0, 0},
-            {2010, 216, 0, 1},
-        }},
-        {"The Catacombs (MAP22)", {true, false, true}, {1, 0, 1}, 8, 121, {
-            {2, 0, 0, 1},
-            {3, 1, 0, 1},
-            {4, 2, 0, 1},
-            {1, 3, 0, 1},
-            {2003, 4, 0, 0},
-            {40, 5, 0, 0},
-            {14, 6, 0, 1},
-            {46, 7, 0, 1},
-            {41, 8, 0, 1},
-            {65, 9, 0, 1},
-            {65, 10, 0, 1},
-            {3002, 11, 0, 1},
-            {38, 12, 0, 0},
-            {69, 13, 0, 1},
-            {2049, 14, 0, 1},
-            {2012, 15, 0, 1},
-            {3001, 16, 0, 1},
-            {3001, 17, 0, 1},
-            {3001, 18, 0, 1},
-            {3001, 19, 0, 1},
-            {3001, 20, 0, 1},
-            {3001, 21, 0, 1},
-            {65, 22, 0, 1},
-            {65, 23, 0, 1},
-            {2011, 24, 0, 1},
-            {2011, 25, 0, 1},
-            {65, 26, 0, 1},
-            {65, 27, 0, 1},
-            {2001, 28, 0, 0},
-            {32, 29, 0, 1},
-            {32, 30, 0, 1},
-            {2046, 31, 0, 1},
-            {2008, 32, 0, 1},
-            {3001, 33, 0, 1},
-            {2012, 34, 0, 1},
-            {14, 35, 0, 1},
-            {2012, 36, 0, 1},
-            {2012, 37, 0, 1},
-            {3001, 38, 0, 1},
-            {3001, 39, 0, 1},
-            {3001, 40, 0, 1},
-            {3001, 41, 0, 1},
-            {2048, 42, 0, 1},
-            {2008, 43, 0, 1},
-            {2008, 44, 0, 1},
-            {2023, 45, 0, 0},
-            {2025, 46, 0, 1},
-            {65, 47, 0, 1},
-            {65, 48, 0, 1},
-            {31, 49, 0, 1},
-            {2015, 50, 0, 1},
-            {2015, 51, 0, 1},
-            {2015, 52, 0, 1},
-            {2015, 53, 0, 1},
-            {2015, 54, 0, 1},
-            {32, 55, 0, 1},
-            {32, 56, 0, 1},
-            {46, 57, 0, 1},
-            {46, 58, 0, 1},
-            {45, 59, 0, 1},
-            {46, 60, 0, 1},
-            {46, 61, 0, 1},
-            {46, 62, 0, 1},
-            {46, 63, 0, 1},
-            {46, 64, 0, 1},
-            {46, 65, 0, 1},
-            {46, 66, 0, 1},
-            {46, 67, 0, 1},
-            {65, 68, 0, 1},
-            {65, 69, 0, 1},
-            {65, 70, 0, 1},
-            {65, 71, 0, 1},
-            {65, 72, 0, 1},
-            {14, 73, 0, 1},
-            {65, 74, 0, 1},
-            {65, 75, 0, 1},
-            {11, 76, 0, 1},
-            {11, 77, 0, 1},
-            {11, 78, 0, 1},
-            {11, 79, 0, 1},
-            {2003, 80, 0, 1},
-            {2013, 81, 0, 1},
-            {11, 82, 0, 1},
-            {2004, 83, 0, 0},
-            {3003, 84, 0, 1},
-            {3002, 85, 0, 1},
-            {3001, 86, 0, 1},
-            {3001, 87, 0, 1},
-            {3001, 88, 0, 1},
-            {3001, 89, 0, 1},
-            {2025, 90, 0, 1},
-            {65, 91, 0, 1},
-            {65, 92, 0, 1},
-            {65, 93, 0, 1},
-            {65, 94, 0, 1},
-            {3002, 95, 0, 1},
-            {65, 96, 0, 1},
-            {65, 97, 0, 1},
-            {3001, 98, 0, 1},
-            {65, 99, 0, 1},
-            {65, 100, 0, 1},
-            {65, 101, 0, 1},
-            {65, 102, 0, 1},
-            {3002, 103, 0, 1},
-            {58, 104, 0, 1},
-            {58, 105, 0, 1},
-            {58, 106, 0, 1},
-            {3001, 107, 0, 1},
-            {3001, 108, 0, 1},
-            {58, 109, 0, 1},
-            {58, 110, 0, 1},
-            {58, 111, 0, 1},
-            {58, 112, 0, 1},
-            {66, 113, 0, 1},
-            {66, 114, 0, 1},
-            {2049, 115, 0, 1},
-            {79, 116, 0, 1},
-            {79, 117, 0, 1},
-            {2013, 118, 0, 0},
-            {2018, 119, 0, 0},
-            {17, 120, 0, 1},
-        }},
-        {"Barrels o' Fun (MAP23)", {false, true, false}, {0, 1, 0}, 11, 431, {
-            {1, 0, 0, 1},
-            {2, 1, 0, 1},
-            {3, 2, 0, 1},
-            {4, 3, 0, 1},
-            {2035, 4, 0, 1},
-            {2035, 5, 0, 1},
-            {2035, 6, 0, 1},
-            {2035, 7, 0, 1},
-            {2035, 8, 0, 1},
-            {2035, 9, 0, 1},
-            {2035, 10, 0, 1},
-            {2035, 11, 0, 1},
-            {2035, 12, 0, 1},
-            {2035, 13, 0, 1},
-            {2035, 14, 0, 1},
-            {2035, 15, 0, 1},
-            {2035, 16, 0, 1},
-            {2035, 17, 0, 1},
-            {2035, 18, 0, 1},
-            {2035, 19, 0, 1},
-            {2035, 20, 0, 1},
-            {2035, 21, 0, 1},
-            {2035, 22, 0, 1},
-            {2035, 23, 0, 1},
-            {2035, 24, 0, 1},
-            {2035, 25, 0, 1},
-            {2035, 26, 0, 1},
-            {2035, 27, 0, 1},
-            {2035, 28, 0, 1},
-            {2035, 29, 0, 1},
-            {2035, 30, 0, 1},
-            {2035, 31, 0, 1},
-            {2035, 32, 0, 1},
-            {2035, 33, 0, 1},
-            {2035, 34, 0, 1},
-            {2035, 35, 0, 1},
-            {2035, 36, 0, 1},
-            {2035, 37, 0, 1},
-            {2035, 38, 0, 1},
-            {2035, 39, 0, 1},
-            {2035, 40, 0, 1},
-            {2035, 41, 0, 1},
-            {2035, 42, 0, 1},
-            {2035, 43, 0, 1},
-            {2035, 44, 0, 1},
-            {2035, 45, 0, 1},
-            {2035, 46, 0, 1},
-            {2035, 47, 0, 1},
-            {2035, 48, 0, 1},
-            {2035, 49, 0, 1},
-            {2035, 50, 0, 1},
-            {2035, 51, 0, 1},
-            {67, 52, 0, 1},
-            {2035, 53, 0, 1},
-            {2035, 54, 0, 1},
-            {2035, 55, 0, 1},
-            {2035, 56, 0, 1},
-            {2035, 57, 0, 1},
-            {2035, 58, 0, 1},
-            {2035, 59, 0, 1},
-            {2035, 60, 0, 1},
-            {2035, 61, 0, 1},
-            {2035, 62, 0, 1},
-            {2035, 63, 0, 1},
-            {2035, 64, 0, 1},
-            {2035, 65, 0, 1},
-            {2035, 66, 0, 1},
-            {2035, 67, 0, 1},
-            {2035, 68, 0, 1},
-            {2035, 69, 0, 1},
-            {2035, 70, 0, 1},
-            {2035, 71, 0, 1},
-            {2035, 72, 0, 1},
-            {2035, 73, 0, 1},
-            {2035, 74, 0, 1},
-            {2035, 75, 0, 1},
-            {2035, 76, 0, 1},
-            {2035, 77, 0, 1},
-            {70, 78, 0, 1},
-            {2035, 79, 0, 1},
-            {2035, 80, 0, 1},
-            {2035, 81, 0, 1},
-            {2035, 82, 0, 1},
-            {2035, 83, 0, 1},
-            {2035, 84, 0, 1},
-            {2035, 85, 0, 1},
-            {2035, 86, 0, 1},
-            {2035, 87, 0, 1},
-            {2035, 88, 0, 1},
-            {2035, 89, 0, 1},
-            {2035, 90, 0, 1},
-            {2035, 91, 0, 1},
-            {2035, 92, 0, 1},
-            {2035, 93, 0, 1},
-            {2035, 94, 0, 1},
-            {65, 95, 0, 1},
-            {65, 96, 0, 1},
-            {65, 97, 0, 1},
-            {65, 98, 0, 1},
-            {65, 99, 0, 1},
-            {65, 100, 0, 1},
-            {65, 101, 0, 1},
-            {65, 102, 0, 1},
-            {65, 103, 0, 1},
-            {65, 104, 0, 1},
-            {65, 105, 0, 1},
-            {65, 106, 0, 1},
-            {2035, 107, 0, 1},
-            {2035, 108, 0, 1},
-            {2035, 109, 0, 1},
-            {2035, 110, 0, 1},
-            {2035, 111, 0, 1},
-            {2035, 112, 0, 1},
-            {2035, 113, 0, 1},
-            {2035, 114, 0, 1},
-            {2035, 115, 0, 1},
-            {2035, 116, 0, 1},
-            {2035, 117, 0, 1},
-            {2035, 118, 0, 1},
-            {2035, 119, 0, 1},
-            {2035, 120, 0, 1},
-            {2035, 121, 0, 1},
-            {2035, 122, 0, 1},
-            {2035, 123, 0, 1},
-            {2035, 124, 0, 1},
-            {2035, 125, 0, 1},
-            {2035, 126, 0, 1},
-            {2035, 127, 0, 1},
-            {2035, 128, 0, 1},
-            {2035, 129, 0, 1},
-            {2035, 130, 0, 1},
-            {2035, 131, 0, 1},
-            {2035, 132, 0, 1},
-            {14, 133, 0, 1},
-            {2035, 134, 0, 1},
-            {2035, 135, 0, 1},
-            {2001, 136, 0, 0},
-            {2035, 137, 0, 1},
-            {2035, 138, 0, 1},
-            {2035, 139, 0, 1},
-            {2035, 140, 0, 1},
-            {2008, 141, 0, 1},
-            {2008, 142, 0, 1},
-            {2008, 143, 0, 1},
-            {2008, 144, 0, 1},
-            {2008, 145, 0, 1},
-            {2008, 146, 0, 1},
-            {2008, 147, 0, 1},
-            {2008, 148, 0, 1},
-            {14, 149, 0, 1},
-            {70, 150, 0, 1},
-            {70, 151, 0, 1},
-            {70, 152, 0, 1},
-            {70, 153, 0, 1},
-            {70, 154, 0, 1},
-            {70, 155, 0, 1},
-            {70, 156, 0, 1},
-            {70, 157, 0, 1},
-            {70, 158, 0, 1},
-            {70, 159, 0, 1},
-            {2035, 160, 0, 1},
-            {2035, 161, 0, 1},
-            {2035, 162, 0, 1},
-            {2035, 163, 0, 1},
-            {2035, 164, 0, 1},
-            {2035, 165, 0, 1},
-            {2035, 166, 0, 1},
-            {2035, 167, 0, 1},
-            {2035, 168, 0, 1},
-            {71, 169, 0, 1},
-            {71, 170, 0, 1},
-            {71, 171, 0, 1},
-            {71, 172, 0, 1},
-            {71, 173, 0, 1},
-            {2035, 174, 0, 1},
-            {2035, 175, 0, 1},
-            {2035, 176, 0, 1},
-            {2035, 177, 0, 1},
-            {2035, 178, 0, 1},
-            {2035, 179, 0, 1},
-            {3001, 180, 0, 1},
-            {3001, 181, 0, 1},
-            {3001, 182, 0, 1},
-            {3001, 183, 0, 1},
-            {3001, 184, 0, 1},
-            {3001, 185, 0, 1},
-            {3001, 186, 0, 1},
-            {3001, 187, 0, 1},
-            {3001, 188, 0, 1},
-            {3001, 189, 0, 1},
-            {3001, 190, 0, 1},
-            {3001, 191, 0, 1},
-            {3001, 192, 0, 1},
-            {3001, 193, 0, 1},
-            {71, 194, 0, 1},
-            {69, 195, 0, 1},
-            {69, 196, 0, 1},
-            {2035, 197, 0, 1},
-            {2035, 198, 0, 1},
-            {2035, 199, 0, 1},
-            {2035, 200, 0, 1},
-            {2035, 201, 0, 1},
-            {2035, 202, 0, 1},
-            {2035, 203, 0, 1},
-            {2035, 204, 0, 1},
-            {2035, 205, 0, 1},
-            {69, 206, 0, 1},
-            {69, 207, 0, 1},
-            {69, 208, 0, 1},
-            {69, 209, 0, 1},
-            {69, 210, 0, 1},
-            {69, 211, 0, 1},
-            {69, 212, 0, 1},
-            {2035, 213, 0, 1},
-            {2035, 214, 0, 1},
-            {2035, 215, 0, 1},
-            {2035, 216, 0, 1},
-            {2035, 217, 0, 1},
-            {2035, 218, 0, 1},
-            {2035, 219, 0, 1},
-            {2035, 220, 0, 1},
-            {2002, 221, 0, 1},
-            {2023, 222, 0, 0},
-            {8, 223, 0, 0},
-            {2026, 224, 0, 0},
-            {42, 225, 0, 1},
-            {42, 226, 0, 1},
-            {55, 227, 0, 1},
-            {55, 228, 0, 1},
-            {3002, 229, 0, 1},
-            {3002, 230, 0, 1},
-            {3002, 231, 0, 1},
-            {3002, 232, 0, 1},
-            {3002, 233, 0, 1},
-            {3002, 234, 0, 1},
-            {3002, 235, 0, 1},
-            {3002, 236, 0, 1},
-            {3002, 237, 0, 1},
-            {3002, 238, 0, 1},
-            {3002, 239, 0, 1},
-            {3002, 240, 0, 1},
-            {3002, 241, 0, 1},
-            {3002, 242, 0, 1},
-            {3002, 243, 0, 1},
-            {3002, 244, 0, 1},
-            {2048, 245, 0, 1},
-            {2048, 246, 0, 1},
-            {2049, 247, 0, 1},
-            {2049, 248, 0, 1},
-            {2018, 249, 0, 0},
-            {2012, 250, 0, 1},
-            {2012, 251, 0, 1},
-            {64, 252, 0, 1},
-            {3001, 253, 0, 1},
-            {65, 254, 0, 1},
-            {65, 255, 0, 1},
-            {65, 256, 0, 1},
-            {3001, 257, 0, 1},
-            {3001, 258, 0, 1},
-            {3001, 259, 0, 1},
-            {14, 260, 0, 1},
-            {14, 261, 0, 1},
-            {2046, 262, 0, 1},
-            {2046, 263, 0, 1},
-            {2003, 264, 0, 0},
-            {2010, 265, 0, 1},
-            {83, 266, 0, 0},
-            {2046, 267, 0, 1},
-            {2046, 268, 0, 1},
-            {2046, 269, 0, 1},
-            {2046, 270, 0, 1},
-            {2046, 271, 0, 1},
-            {2046, 272, 0, 1},
-            {2046, 273, 0, 1},
-            {2046, 274, 0, 1},
-            {2012, 275, 0, 1},
-            {2012, 276, 0, 1},
-            {2013, 277, 0, 0},
-            {3001, 278, 0, 1},
-            {3001, 279, 0, 1},
-            {3001, 280, 0, 1},
-            {3001, 281, 0, 1},
-            {3001, 282, 0, 1},
-            {3001, 283, 0, 1},
-            {3001, 284, 0, 1},
-            {3001, 285, 0, 1},
-            {3001, 286, 0, 1},
-            {3001, 287, 0, 1},
-            {3001, 288, 0, 1},
-            {3001, 289, 0, 1},
-            {3001, 290, 0, 1},
-            {3001, 291, 0, 1},
-            {3001, 292, 0, 1},
-            {3001, 293, 0, 1},
-            {3001, 294, 0, 1},
-            {7, 295, 0, 1},
-            {68, 296, 0, 1},
-            {68, 297, 0, 1},
-            {68, 298, 0, 1},
-            {68, 299, 0, 1},
-            {68, 300, 0, 1},
-            {8, 301, 0, 0},
-            {2046, 302, 0, 1},
-            {2046, 303, 0, 1},
-            {2046, 304, 0, 1},
-            {2046, 305, 0, 1},
-            {2046, 306, 0, 1},
-            {39, 307, 0, 0},
-            {2011, 308, 0, 1},
-            {2011, 309, 0, 1},
-            {2011, 310, 0, 1},
-            {2011, 311, 0, 1},
-            {2011, 312, 0, 1},
-            {2011, 313, 0, 1},
-            {2011, 314, 0, 1},
-            {2011, 315, 0, 1},
-            {2011, 316, 0, 1},
-            {2011, 317, 0, 1},
-            {2011, 318, 0, 1},
-            {2011, 319, 0, 1},
-            {2011, 320, 0, 1},
-            {2011, 321, 0, 1},
-            {2011, 322, 0, 1},
-            {66, 323, 0, 1},
-            {64, 324, 0, 1},
-            {66, 325, 0, 1},
-            {66, 326, 0, 1},
-            {66, 327, 0, 1},
-            {3002, 328, 0, 1},
-            {3002, 329, 0, 1},
-            {3002, 330, 0, 1},
-            {3002, 331, 0, 1},
-            {3002, 332, 0, 1},
-            {3002, 333, 0, 1},
-            {3002, 334, 0, 1},
-            {3002, 335, 0, 1},
-            {3002, 336, 0, 1},
-            {3002, 337, 0, 1},
-            {3002, 338, 0, 1},
-            {3002, 339, 0, 1},
-            {68, 340, 0, 1},
-            {68, 341, 0, 1},
-            {2006, 342, 0, 0},
-            {2012, 343, 0, 1},
-            {2014, 344, 0, 1},
-            {2014, 345, 0, 1},
-            {2014, 346, 0, 1},
-            {2014, 347, 0, 1},
-            {2014, 348, 0, 1},
-            {2014, 349, 0, 1},
-            {2014, 350, 0, 1},
-            {2014, 351, 0, 1},
-            {2014, 352, 0, 1},
-            {2014, 353, 0, 1},
-            {2014, 354, 0, 1},
-            {2014, 355, 0, 1},
-            {2014, 356, 0, 1},
-            {2014, 357, 0, 1},
-            {2014, 358, 0, 1},
-            {2014, 359, 0, 1},
-            {2014, 360, 0, 1},
-            {2014, 361, 0, 1},
-            {2047, 362, 0, 1},
-            {65, 363, 0, 1},
-            {65, 364, 0, 1},
-            {2035, 365, 0, 1},
-            {2035, 366, 0, 1},
-            {2035, 367, 0, 1},
-            {2035, 368, 0, 1},
-            {2035, 369, 0, 1},
-            {2035, 370, 0, 1},
-            {2035, 371, 0, 1},
-            {2035, 372, 0, 1},
-            {2035, 373, 0, 1},
-            {2035, 374, 0, 1},
-            {2035, 375, 0, 1},
-            {2035, 376, 0, 1},
-            {2035, 377, 0, 1},
-            {2035, 378, 0, 1},
-            {2035, 379, 0, 1},
-            {2035, 380, 0, 1},
-            {2035, 381, 0, 1},
-            {2035, 382, 0, 1},
-            {2035, 383, 0, 1},
-            {2035, 384, 0, 1},
-            {2035, 385, 0, 1},
-            {2035, 386, 0, 1},
-            {2035, 387, 0, 1},
-            {2035, 388, 0, 1},
-            {2035, 389, 0, 1},
-            {14, 390, 0, 1},
-            {14, 391, 0, 1},
-            {2035, 392, 0, 1},
-            {2035, 393, 0, 1},
-            {2035, 394, 0, 1},
-            {2035, 395, 0, 1},
-            {2035, 396, 0, 1},
-            {2035, 397, 0, 1},
-            {2035, 398, 0, 1},
-            {2035, 399, 0, 1},
-            {2035, 400, 0, 1},
-            {2035, 401, 0, 1},
-            {2035, 402, 0, 1},
-            {2035, 403, 0, 1},
-            {2035, 404, 0, 1},
-            {2035, 405, 0, 1},
-            {2035, 406, 0, 1},
-            {2035, 407, 0, 1},
-            {2035, 408, 0, 1},
-            {2035, 409, 0, 1},
-            {2035, 410, 0, 1},
-            {2035, 411, 0, 1},
-            {2035, 412, 0, 1},
-            {2035, 413, 0, 1},
-            {2035, 414, 0, 1},
-            {2035, 415, 0, 1},
-            {11, 416, 0, 1},
-            {11, 417, 0, 1},
-            {11, 418, 0, 1},
-            {11, 419, 0, 1},
-            {11, 420, 0, 1},
-            {11, 421, 0, 1},
-            {11, 422, 0, 1},
-            {2046, 423, 0, 1},
-            {2035, 424, 0, 1},
-            {2035, 425, 0, 1},
-            {2035, 426, 0, 1},
-            {2035, 427, 0, 1},
-            {2035, 428, 0, 1},
-            {2035, 429, 0, 1},
-            {14, 430, 0, 1},
-        }},
-        {"The Chasm (MAP24)", {true, false, true}, {0, 0, 0}, 14, 364, {
-            {1, 0, 0, 1},
-            {2, 1, 0, 1},
-            {3, 2, 0, 1},
-            {4, 3, 0, 1},
-            {11, 4, 0, 1},
-            {2004, 5, 0, 0},
-            {2001, 6, 0, 0},
-            {3005, 7, 0, 1},
-            {3005, 8, 0, 1},
-            {3005, 9, 0, 1},
-            {3005, 10, 0, 1},
-            {2010, 11, 0, 1},
-            {2022, 12, 0, 0},
-            {2012, 13, 0, 1},
-            {3001, 14, 0, 1},
-            {3001, 15, 0, 1},
-            {3001, 16, 0, 1},
-            {3001, 17, 0, 1},
-            {3001, 18, 0, 1},
-            {3001, 19, 0, 1},
-            {3001, 20, 0, 1},
-            {3001, 21, 0, 1},
-            {2003, 22, 0, 0},
-            {5, 23, 0, 0},
-            {2010, 24, 0, 1},
-            {2011, 25, 0, 1},
-            {2046, 26, 0, 1},
-            {2011, 27, 0, 1},
-            {2011, 28, 0, 1},
-            {2046, 29, 0, 1},
-            {2046, 30, 0, 1},
-            {8, 31, 0, 0},
-            {2012, 32, 0, 1},
-            {2012, 33, 0, 1},
-            {2046, 34, 0, 1},
-            {2010, 35, 0, 1},
-            {2010, 36, 0, 1},
-            {2010, 37, 0, 1},
-            {2010, 38, 0, 1},
-            {2010, 39, 0, 1},
-            {2007, 40, 0, 1},
-            {2011, 41, 0, 1},
-            {2011, 42, 0, 1},
-            {3001, 43, 0, 1},
-            {3001, 44, 0, 1},
-            {3005, 45, 0, 1},
-            {3001, 46, 0, 1},
-            {3001, 47, 0, 1},
-            {3001, 48, 0, 1},
-            {3001, 49, 0, 1},
-            {3001, 50, 0, 1},
-            {3001, 51, 0, 1},
-            {3001, 52, 0, 1},
-            {3001, 53, 0, 1},
-            {3001, 54, 0, 1},
-            {3001, 55, 0, 1},
-            {3001, 56, 0, 1},
-            {3001, 57, 0, 1},
-            {3001, 58, 0, 1},
-            {2008, 59, 0, 1},
-            {14, 60, 0, 1},
-            {2025, 61, 0, 1},
-            {69, 62, 0, 1},
-            {3005, 63, 0, 1},
-            {65, 64, 0, 1},
-            {65, 65, 0, 1},
-            {65, 66, 0, 1},
-            {65, 67, 0, 1},
-            {65, 68, 0, 1},
-            {65, 69, 0, 1},
-            {65, 70, 0, 1},
-            {65, 71, 0, 1},
-            {65, 72, 0, 1},
-            {65, 73, 0, 1},
-            {14, 74, 0, 1},
-            {14, 75, 0, 1},
-            {2011, 76, 0, 1},
-            {2010, 77, 0, 1},
-            {2049, 78, 0, 1},
-            {2023, 79, 0, 0},
-            {3002, 80, 0, 1},
-            {3002, 81, 0, 1},
-            {3002, 82, 0, 1},
-            {3002, 83, 0, 1},
-            {58, 84, 0, 1},
-            {3002, 85, 0, 1},
-            {3002, 86, 0, 1},
-            {58, 87, 0, 1},
-            {58, 88, 0, 1},
-            {58, 89, 0, 1},
-            {2011, 90, 0, 1},
-            {2011, 91, 0, 1},
-            {2011, 92, 0, 1},
-            {2011, 93, 0, 1},
-            {2011, 94, 0, 1},
-            {14, 95, 0, 1},
-            {3002, 96, 0, 1},
-            {3002, 97, 0, 1},
-            {3002, 98, 0, 1},
-            {3002, 99, 0, 1},
-            {3002, 100, 0, 1},
-            {3002, 101, 0, 1},
-            {3002, 102, 0, 1},
-            {3002, 103, 0, 1},
-            {3002, 104, 0, 1},
-            {3002, 105, 0, 1},
-            {3002, 106, 0, 1},
-            {3002, 107, 0, 1},
-            {3002, 108, 0, 1},
-            {2047, 109, 0, 1},
-            {2046, 110, 0, 1},
-            {2049, 111, 0, 1},
-            {2048, 112, 0, 1},
-            {2012, 113, 0, 1},
-            {2012, 114, 0, 1},
-            {2002, 115, 0, 1},
-            {51, 116, 0, 1},
-            {14, 117, 0, 1},
-            {2011, 118, 0, 1},
-            {3001, 119, 0, 1},
-            {3001, 120, 0, 1},
-            {3001, 121, 0, 1},
-            {3001, 122, 0, 1},
-            {3001, 123, 0, 1},
-            {3001, 124, 0, 1},
-            {3001, 125, 0, 1},
-            {3001, 126, 0, 1},
-            {3001, 127, 0, 1},
-            {3001, 128, 0, 1},
-            {3001, 129, 0, 1},
-            {3001, 130, 0, 1},
-            {3001, 131, 0, 1},
-            {3001, 132, 0, 1},
-            {3001, 133, 0, 1},
-            {3001, 134, 0, 1},
-            {3001, 135, 0, 1},
-            {3001, 136, 0, 1},
-            {3001, 137, 0, 1},
-            {3001, 138, 0, 1},
-            {3001, 139, 0, 1},
-            {3001, 140, 0, 1},
-            {3001, 141, 0, 1},
-            {65, 142, 0, 1},
-            {2002, 143, 0, 1},
-            {2048, 144, 0, 1},
-            {2046, 145, 0, 1},
-            {2046, 146, 0, 1},
-            {2008, 147, 0, 1},
-            {2008, 148, 0, 1},
-            {2012, 149, 0, 1},
-            {69, 150, 0, 1},
-            {69, 151, 0, 1},
-            {2049, 152, 0, 1},
-            {67, 153, 0, 1},
-            {67, 154, 0, 1},
-            {2023, 155, 0, 0},
-            {3002, 156, 0, 1},
-            {3002, 157, 0, 1},
-            {3002, 158, 0, 1},
-            {3002, 159, 0, 1},
-            {3002, 160, 0, 1},
-            {3002, 161, 0, 1},
-            {58, 162, 0, 1},
-            {58, 163, 0, 1},
-            {58, 164, 0, 1},
-            {58, 165, 0, 1},
-            {2010, 166, 0, 1},
-            {2010, 167, 0, 1},
-            {2010, 168, 0, 1},
-            {2018, 169, 0, 0},
-            {65, 170, 0, 1},
-            {65, 171, 0, 1},
-            {2014, 172, 0, 1},
-            {2014, 173, 0, 1},
-            {2014, 174, 0, 1},
-            {2014, 175, 0, 1},
-            {2014, 176, 0, 1},
-            {2014, 177, 0, 1},
-            {2014, 178, 0, 1},
-            {2014, 179, 0, 1},
-            {2014, 180, 0, 1},
-            {2014, 181, 0, 1},
-            {2014, 182, 0, 1},
-            {2014, 183, 0, 1},
-            {2015, 184, 0, 1},
-            {2015, 185, 0, 1},
-            {2015, 186, 0, 1},
-            {2015, 187, 0, 1},
-            {2015, 188, 0, 1},
-            {2015, 189, 0, 1},
-            {2012, 190, 0, 1},
-            {2012, 191, 0, 1},
-            {2012, 192, 0, 1},
-            {45, 193, 0, 1},
-            {45, 194, 0, 1},
-            {55, 195, 0, 1},
-            {2014, 196, 0, 1},
-            {2014, 197, 0, 1},
-            {2011, 198, 0, 1},
-            {2015, 199, 0, 1},
-            {2015, 200, 0, 1},
-            {2015, 201, 0, 1},
-            {2015, 202, 0, 1},
-            {2015, 203, 0, 1},
-            {2015, 204, 0, 1},
-            {2015, 205, 0, 1},
-            {2007, 206, 0, 1},
-            {2010, 207, 0, 1},
-            {2015, 208, 0, 1},
-            {2014, 209, 0, 1},
-            {65, 210, 0, 1},
-            {65, 211, 0, 1},
-            {65, 212, 0, 1},
-            {65, 213, 0, 1},
-            {65, 214, 0, 1},
-            {65, 215, 0, 1},
-            {2011, 216, 0, 1},
-            {2008, 217, 0, 1},
-            {2015, 218, 0, 1},
-            {2015, 219, 0, 1},
-            {65, 220, 0, 1},
-            {65, 221, 0, 1},
-            {2015, 222, 0, 1},
-            {65, 223, 0, 1},
-            {65, 224, 0, 1},
-            {2008, 225, 0, 1},
-            {65, 226, 0, 1},
-            {65, 227, 0, 1},
-            {2015, 228, 0, 1},
-            {69, 229, 0, 1},
-            {69, 230, 0, 1},
-            {2025, 231, 0, 1},
-            {2025, 232, 0, 1},
-            {2025, 233, 0, 1},
-            {3002, 234, 0, 1},
-            {3002, 235, 0, 1},
-            {3002, 236, 0, 1},
-            {3002, 237, 0, 1},
-            {3002, 238, 0, 1},
-            {3002, 239, 0, 1},
-            {69, 240, 0, 1},
-            {3005, 241, 0, 1},
-            {3005, 242, 0, 1},
-            {3005, 243, 0, 1},
-            {3006, 244, 0, 1},
-            {3006, 245, 0, 1},
-            {3006, 246, 0, 1},
-            {3006, 247, 0, 1},
-            {3006, 248, 0, 1},
-            {3006, 249, 0, 1},
-            {3006, 250, 0, 1},
-            {3006, 251, 0, 1},
-            {3006, 252, 0, 1},
-            {3006, 253, 0, 1},
-            {14, 254, 0, 1},
-            {3006, 255, 0, 1},
-            {3006, 256, 0, 1},
-            {3006, 257, 0, 1},
-            {3006, 258, 0, 1},
-            {3006, 259, 0, 1},
-            {3006, 260, 0, 1},
-            {13, 261, 0, 0},
-            {14, 262, 0, 1},
-            {14, 263, 0, 1},
-            {3002, 264, 0, 1},
-            {3002, 265, 0, 1},
-            {3002, 266, 0, 1},
-            {3002, 267, 0, 1},
-            {3002, 268, 0, 1},
-            {3002, 269, 0, 1},
-            {3002, 270, 0, 1},
-            {3002, 271, 0, 1},
-            {3002, 272, 0, 1},
-            {3002, 273, 0, 1},
-            {3002, 274, 0, 1},
-            {3002, 275, 0, 1},
-            {3002, 276, 0, 1},
-            {3002, 277, 0, 1},
-            {3002, 278, 0, 1},
-            {3002, 279, 0, 1},
-            {3002, 280, 0, 1},
-            {3002, 281, 0, 1},
-            {3002, 282, 0, 1},
-            {3002, 283, 0, 1},
-            {3002, 284, 0, 1},
-            {3002, 285, 0, 1},
-            {3002, 286, 0, 1},
-            {3002, 287, 0, 1},
-            {3002, 288, 0, 1},
-            {2007, 289, 0, 1},
-            {2012, 290, 0, 1},
-            {2012, 291, 0, 1},
-            {2008, 292, 0, 1},
-            {2048, 293, 0, 1},
-            {2049, 294, 0, 1},
-            {2006, 295, 0, 0},
-            {2049, 296, 0, 1},
-            {2046, 297, 0, 1},
-            {2014, 298, 0, 1},
-            {2014, 299, 0, 1},
-            {2014, 300, 0, 1},
-            {2014, 301, 0, 1},
-            {2014, 302, 0, 1},
-            {2014, 303, 0, 1},
-            {2014, 304, 0, 1},
-            {2014, 305, 0, 1},
-            {2014, 306, 0, 1},
-            {2014, 307, 0, 1},
-            {2010, 308, 0, 1},
-            {2007, 309, 0, 1},
-            {2007, 310, 0, 1},
-            {2046, 311, 0, 1},
-            {2047, 312, 0, 1},
-            {2008, 313, 0, 1},
-            {2010, 314, 0, 1},
-            {2008, 315, 0, 1},
-            {2008, 316, 0, 1},
-            {2008, 317, 0, 1},
-            {2008, 318, 0, 1},
-            {2008, 319, 0, 1},
-            {2010, 320, 0, 1},
-            {2010, 321, 0, 1},
-            {2007, 322, 0, 1},
-            {2010, 323, 0, 1},
-            {2010, 324, 0, 1},
-            {2008, 325, 0, 1},
-            {2011, 326, 0, 1},
-            {2011, 327, 0, 1},
-            {2011, 328, 0, 1},
-            {2007, 329, 0, 1},
-            {2008, 330, 0, 1},
-            {2010, 331, 0, 1},
-            {2010, 332, 0, 1},
-            {2011, 333, 0, 1},
-            {2007, 334, 0, 1},
-            {2007, 335, 0, 1},
-            {2010, 336, 0, 1},
-            {2025, 337, 0, 1},
-            {2011, 338, 0, 1},
-            {2007, 339, 0, 1},
-            {2025, 340, 0, 1},
-            {2047, 341, 0, 1},
-            {2010, 342, 0, 1},
-            {2010, 343, 0, 1},
-            {2008, 344, 0, 1},
-            {2010, 345, 0, 1},
-            {2025, 346, 0, 1},
-            {11, 347, 0, 1},
-            {11, 348, 0, 1},
-            {11, 349, 0, 1},
-            {11, 350, 0, 1},
-            {11, 351, 0, 1},
-            {2006, 352, 0, 1},
-            {82, 353, 0, 0},
-            {14, 354, 0, 1},
-            {83, 355, 0, 0},
-            {2010, 356, 0, 1},
-            {2010, 357, 0, 1},
-            {2010, 358, 0, 1},
-            {2010, 359, 0, 1},
-            {2048, 360, 0, 1},
-            {2048, 361, 0, 1},
-            {83, 362, 0, 0},
-            {2014, 363, 0, 1},
-        }},
-        {"Bloodfalls (MAP25)", {true, false, false}, {1, 0, 0}, 11, 276, {
-            {46, 0, 0, 1},
-            {46, 1, 0, 1},
-            {46, 2, 0, 1},
-            {46, 3, 0, 1},
-            {71, 4, 0, 1},
-            {71, 5, 0, 1},
-            {82, 6, 0, 0},
-            {2024, 7, 0, 0},
-            {64, 8, 0, 1},
-            {65, 9, 0, 1},
-            {65, 10, 0, 1},
-            {65, 11, 0, 1},
-            {65, 12, 0, 1},
-            {3001, 13, 0, 1},
-            {3001, 14, 0, 1},
-            {3001, 15, 0, 1},
-            {3001, 16, 0, 1},
-            {3001, 17, 0, 1},
-            {3001, 18, 0, 1},
-            {45, 19, 0, 1},
-            {45, 20, 0, 1},
-            {45, 21, 0, 1},
-            {45, 22, 0, 1},
-            {83, 23, 0, 0},
-            {14, 24, 0, 1},
-            {1, 25, 0, 1},
-            {46, 26, 0, 1},
-            {46, 27, 0, 1},
-            {46, 28, 0, 1},
-            {46, 29, 0, 1},
-            {46, 30, 0, 1},
-            {46, 31, 0, 1},
-            {46, 32, 0, 1},
-            {46, 33, 0, 1},
-            {2006, 34, 0, 0},
-            {66, 35, 0, 1},
-            {65, 36, 0, 1},
-            {65, 37, 0, 1},
-            {65, 38, 0, 1},
-            {65, 39, 0, 1},
-            {3001, 40, 0, 1},
-            {3001, 41, 0, 1},
-            {3001, 42, 0, 1},
-            {3001, 43, 0, 1},
-            {3001, 44, 0, 1},
-            {3001, 45, 0, 1},
-            {3001, 46, 0, 1},
-            {3001, 47, 0, 1},
-            {9, 48, 0, 1},
-            {9, 49, 0, 1},
-            {9, 50, 0, 1},
-            {9, 51, 0, 1},
-            {9, 52, 0, 1},
-            {9, 53, 0, 1},
-            {34, 54, 0, 1},
-            {34, 55, 0, 1},
-            {34, 56, 0, 1},
-            {34, 57, 0, 1},
-            {34, 58, 0, 1},
-            {34, 59, 0, 1},
-            {34, 60, 0, 1},
-            {34, 61, 0, 1},
-            {17, 62, 0, 1},
-            {2003, 63, 0, 1},
-            {14, 64, 0, 1},
-            {46, 65, 0, 1},
-            {34, 66, 0, 1},
-            {34, 67, 0, 1},
-            {34, 68, 0, 1},
-            {34, 69, 0, 1},
-            {34, 70, 0, 1},
-            {34, 71, 0, 1},
-            {34, 72, 0, 1},
-            {34, 73, 0, 1},
-            {34, 74, 0, 1},
-            {34, 75, 0, 1},
-            {34, 76, 0, 1},
-            {34, 77, 0, 1},
-            {17, 78, 0, 1},
-            {17, 79, 0, 1},
-            {2035, 80, 0, 1},
-            {2035, 81, 0, 1},
-            {2035, 82, 0, 1},
-            {2035, 83, 0, 1},
-            {9, 84, 0, 1},
-            {9, 85, 0, 1},
-            {9, 86, 0, 1},
-            {9, 87, 0, 1},
-            {9, 88, 0, 1},
-            {9, 89, 0, 1},
-            {9, 90, 0, 1},
-            {9, 91, 0, 1},
-            {58, 92, 0, 1},
-            {58, 93, 0, 1},
-            {58, 94, 0, 1},
-            {58, 95, 0, 1},
-            {58, 96, 0, 1},
-            {58, 97, 0, 1},
-            {3006, 98, 0, 1},
-            {3006, 99, 0, 1},
-            {3006, 100, 0, 1},
-            {3006, 101, 0, 1},
-            {68, 102, 0, 1},
-            {2019, 103, 0, 0},
-            {2018, 104, 0, 0},
-            {14, 105, 0, 1},
-            {40, 106, 0, 0},
-            {2049, 107, 0, 1},
-            {2012, 108, 0, 1},
-            {2049, 109, 0, 1},
-            {2012, 110, 0, 1},
-            {2012, 111, 0, 1},
-            {2049, 112, 0, 1},
-            {2049, 113, 0, 1},
-            {2012, 114, 0, 1},
-            {2049, 115, 0, 1},
-            {2049, 116, 0, 1},
-            {2048, 117, 0, 1},
-            {2048, 118, 0, 1},
-            {2048, 119, 0, 1},
-            {2048, 120, 0, 1},
-            {80, 121, 0, 1},
-            {80, 122, 0, 1},
-            {80, 123, 0, 1},
-            {80, 124, 0, 1},
-            {80, 125, 0, 1},
-            {80, 126, 0, 1},
-            {79, 127, 0, 1},
-            {79, 128, 0, 1},
-            {79, 129, 0, 1},
-            {79, 130, 0, 1},
-            {3004, 131, 0, 1},
-            {3004, 132, 0, 1},
-            {3004, 133, 0, 1},
-            {3004, 134, 0, 1},
-            {9, 135, 0, 1},
-            {2011, 136, 0, 1},
-            {9, 137, 0, 1},
-            {9, 138, 0, 1},
-            {9, 139, 0, 1},
-            {2011, 140, 0, 1},
-            {2011, 141, 0, 1},
-            {2011, 142, 0, 1},
-            {2035, 143, 0, 1},
-            {2035, 144, 0, 1},
-            {2035, 145, 0, 1},
-            {2011, 146, 0, 1},
-            {2035, 147, 0, 1},
-            {2035, 148, 0, 1},
-            {2035, 149, 0, 1},
-            {2002, 150, 0, 0},
-            {46, 151, 0, 1},
-            {46, 152, 0, 1},
-            {46, 153, 0, 1},
-            {46, 154, 0, 1},
-            {46, 155, 0, 1},
-            {46, 156, 0, 1},
-            {46, 157, 0, 1},
-            {46, 158, 0, 1},
-            {46, 159, 0, 1},
-            {46, 160, 0, 1},
-            {46, 161, 0, 1},
-            {46, 162, 0, 1},
-            {46, 163, 0, 1},
-            {46, 164, 0, 1},
-            {46, 165, 0, 1},
-            {46, 166, 0, 1},
-            {46, 167, 0, 1},
-            {46, 168, 0, 1},
-            {2004, 169, 0, 0},
-            {69, 170, 0, 1},
-            {3001, 171, 0, 1},
-            {3001, 172, 0, 1},
-            {3001, 173, 0, 1},
-            {9, 174, 0, 1},
-            {9, 175, 0, 1},
-            {9, 176, 0, 1},
-            {9, 177, 0, 1},
-            {9, 178, 0, 1},
-            {9, 179, 0, 1},
-            {9, 180, 0, 1},
-            {65, 181, 0, 1},
-            {17, 182, 0, 1},
-            {2012, 183, 0, 1},
-            {2012, 184, 0, 1},
-            {2012, 185, 0, 1},
-            {2006, 186, 0, 0},
-            {2006, 187, 0, 1},
-            {71, 188, 0, 1},
-            {68, 189, 0, 1},
-            {2011, 190, 0, 1},
-            {67, 191, 0, 1},
-            {9, 192, 0, 1},
-            {9, 193, 0, 1},
-            {9, 194, 0, 1},
-            {9, 195, 0, 1},
-            {9, 196, 0, 1},
-            {9, 197, 0, 1},
-            {9, 198, 0, 1},
-            {9, 199, 0, 1},
-            {65, 200, 0, 1},
-            {3001, 201, 0, 1},
-            {3001, 202, 0, 1},
-            {3001, 203, 0, 1},
-            {3001, 204, 0, 1},
-            {3001, 205, 0, 1},
-            {3001, 206, 0, 1},
-            {3001, 207, 0, 1},
-            {3004, 208, 0, 1},
-            {3004, 209, 0, 1},
-            {3004, 210, 0, 1},
-            {3004, 211, 0, 1},
-            {3004, 212, 0, 1},
-            {3004, 213, 0, 1},
-            {3004, 214, 0, 1},
-            {3004, 215, 0, 1},
-            {3004, 216, 0, 1},
-            {2011, 217, 0, 1},
-            {2011, 218, 0, 1},
-            {2011, 219, 0, 1},
-            {2011, 220, 0, 1},
-            {2011, 221, 0, 1},
-            {2011, 222, 0, 1},
-            {2011, 223, 0, 1},
-            {2011, 224, 0, 1},
-            {2011, 225, 0, 1},
-            {2011, 226, 0, 1},
-            {11, 227, 0, 1},
-            {11, 228, 0, 1},
-            {11, 229, 0, 1},
-            {11, 230, 0, 1},
-            {2, 231, 0, 1},
-            {3, 232, 0, 1},
-            {4, 233, 0, 1},
-            {11, 234, 0, 1},
-            {11, 235, 0, 1},
-            {2003, 236, 0, 0},
-            {3004, 237, 0, 1},
-            {3004, 238, 0, 1},
-            {3004, 239, 0, 1},
-            {9, 240, 0, 1},
-            {9, 241, 0, 1},
-            {3004, 242, 0, 1},
-            {67, 243, 0, 1},
-            {17, 244, 0, 1},
-            {17, 245, 0, 1},
-            {69, 246, 0, 1},
-            {2008, 247, 0, 1},
-            {2008, 248, 0, 1},
-            {2008, 249, 0, 1},
-            {2008, 250, 0, 1},
-            {2008, 251, 0, 1},
-            {2008, 252, 0, 1},
-            {2008, 253, 0, 1},
-            {2008, 254, 0, 1},
-            {2008, 255, 0, 1},
-            {2008, 256, 0, 1},
-            {2008, 257, 0, 1},
-            {2008, 258, 0, 1},
-            {2008, 259, 0, 1},
-            {2008, 260, 0, 1},
-            {2008, 261, 0, 1},
-            {2008, 262, 0, 1},
-            {2008, 263, 0, 1},
-            {2008, 264, 0, 1},
-            {2008, 265, 0, 1},
-            {2008, 266, 0, 1},
-            {2008, 267, 0, 1},
-            {2008, 268, 0, 1},
-            {2008, 269, 0, 1},
-            {2047, 270, 0, 1},
-            {2047, 271, 0, 1},
-            {2047, 272, 0, 1},
-            {2047, 273, 0, 1},
-            {2047, 274, 0, 1},
-            {2047, 275, 0, 1},
-        }},
-        {"The Abandoned Mines (MAP26)", {true, true, true}, {0, 0, 0}, 12, 296, {
-            {1, 0, 0, 1},
-            {2, 1, 0, 1},
-            {3, 2, 0, 1},
-            {4, 3, 0, 1},
-            {3001, 4, 0, 1},
-            {3001, 5, 0, 1},
-            {3001, 6, 0, 1},
-            {3001, 7, 0, 1},
-            {3001, 8, 0, 1},
-            {3006, 9, 0, 1},
-            {3006, 10, 0, 1},
-            {3006, 11, 0, 1},
-            {3006, 12, 0, 1},
-            {3005, 13, 0, 1},
-            {3005, 14, 0, 1},
-            {3005, 15, 0, 1},
-            {3005, 16, 0, 1},
-            {2012, 17, 0, 1},
-            {2012, 18, 0, 1},
-            {3003, 19, 0, 1},
-            {5, 20, 0, 0},
-            {82, 21, 0, 0},
-            {2008, 22, 0, 1},
-            {2049, 23, 0, 1},
-            {2049, 24, 0, 1},
-            {65, 25, 0, 1},
-            {65, 26, 0, 1},
-            {3001, 27, 0, 1},
-            {3001, 28, 0, 1},
-            {3006, 29, 0, 1},
-            {3006, 30, 0, 1},
-            {3006, 31, 0, 1},
-            {3006, 32, 0, 1},
-            {3006, 33, 0, 1},
-            {65, 34, 0, 1},
-            {65, 35, 0, 1},
-            {65, 36, 0, 1},
-            {65, 37, 0, 1},
-            {65, 38, 0, 1},
-            {65, 39, 0, 1},
-            {9, 40, 0, 1},
-            {65, 41, 0, 1},
-            {3001, 42, 0, 1},
-            {65, 43, 0, 1},
-            {14, 44, 0, 1},
-            {2012, 45, 0, 1},
-            {2012, 46, 0, 1},
-            {2012, 47, 0, 1},
-            {2012, 48, 0, 1},
-            {2003, 49, 0, 0},
-            {2010, 50, 0, 1},
-            {2010, 51, 0, 1},
-            {2010, 52, 0, 1},
-            {2046, 53, 0, 1},
-            {2049, 54, 0, 1},
-            {2008, 55, 0, 1},
-            {2014, 56, 0, 1},
-            {2014, 57, 0, 1},
-            {2014, 58, 0, 1},
-            {2015, 59, 0, 1},
-            {2015, 60, 0, 1},
-            {2015, 61, 0, 1},
-            {2014, 62, 0, 1},
-            {2014, 63, 0, 1},
-            {2014, 64, 0, 1},
-            {2014, 65, 0, 1},
-            {2014, 66, 0, 1},
-            {2015, 67, 0, 1},
-            {2015, 68, 0, 1},
-            {2015, 69, 0, 1},
-            {2015, 70, 0, 1},
-            {2015, 71, 0, 1},
-            {2015, 72, 0, 1},
-            {2014, 73, 0, 1},
-            {2014, 74, 0, 1},
-            {2014, 75, 0, 1},
-            {2014, 76, 0, 1},
-            {2014, 77, 0, 1},
-            {2014, 78, 0, 1},
-            {2015, 79, 0, 1},
-            {2014, 80, 0, 1},
-            {2014, 81, 0, 1},
-            {2014, 82, 0, 1},
-            {2014, 83, 0, 1},
-            {2035, 84, 0, 1},
-            {2035, 85, 0, 1},
-            {2035, 86, 0, 1},
-            {2035, 87, 0, 1},
-            {2035, 88, 0, 1},
-            {2035, 89, 0, 1},
-            {2035, 90, 0, 1},
-            {2035, 91, 0, 1},
-            {2008, 92, 0, 1},
-            {2008, 93, 0, 1},
-            {2008, 94, 0, 1},
-            {2019, 95, 0, 0},
-            {2011, 96, 0, 1},
-            {2011, 97, 0, 1},
-            {2011, 98, 0, 1},
-            {2011, 99, 0, 1},
-            {2011, 100, 0, 1},
-            {2011, 101, 0, 1},
-            {2025, 102, 0, 1},
-            {2008, 103, 0, 1},
-            {67, 104, 0, 1},
-            {14, 105, 0, 1},
-            {14, 106, 0, 1},
-            {2004, 107, 0, 0},
-            {17, 108, 0, 1},
-            {2047, 109, 0, 1},
-            {3006, 110, 0, 1},
-            {3006, 111, 0, 1},
-            {3006, 112, 0, 1},
-            {3006, 113, 0, 1},
-            {3006, 114, 0, 1},
-            {3006, 115, 0, 1},
-            {3006, 116, 0, 1},
-            {9, 117, 0, 1},
-            {65, 118, 0, 1},
-            {65, 119, 0, 1},
-            {65, 120, 0, 1},
-            {65, 121, 0, 1},
-            {58, 122, 0, 1},
-            {2035, 123, 0, 1},
-            {2035, 124, 0, 1},
-            {2035, 125, 0, 1},
-            {2014, 126, 0, 1},
-            {2014, 127, 0, 1},
-            {2014, 128, 0, 1},
-            {2014, 129, 0, 1},
-            {2015, 130, 0, 1},
-            {2015, 131, 0, 1},
-            {2015, 132, 0, 1},
-            {2015, 133, 0, 1},
-            {2014, 134, 0, 1},
-            {2014, 135, 0, 1},
-            {2014, 136, 0, 1},
-            {2025, 137, 0, 1},
-            {3005, 138, 0, 1},
-            {3005, 139, 0, 1},
-            {3005, 140, 0, 1},
-            {3005, 141, 0, 1},
-            {3005, 142, 0, 1},
-            {3005, 143, 0, 1},
-            {3006, 144, 0, 1},
-            {3006, 145, 0, 1},
-            {2012, 146, 0, 1},
-            {2012, 147, 0, 1},
-            {2012, 148, 0, 1},
-            {67, 149, 0, 1},
-            {3005, 150, 0, 1},
-            {3005, 151, 0, 1},
-            {3005, 152, 0, 1},
-            {14, 153, 0, 1},
-            {2013, 154, 0, 0},
-            {2002, 155, 0, 0},
-            {2048, 156, 0, 1},
-            {2048, 157, 0, 1},
-            {2048, 158, 0, 1},
-            {2024, 159, 0, 0},
-            {3001, 160, 0, 1},
-            {3001, 161, 0, 1},
-            {3001, 162, 0, 1},
-            {3001, 163, 0, 1},
-            {3001, 164, 0, 1},
-            {3001, 165, 0, 1},
-            {3001, 166, 0, 1},
-            {3001, 167, 0, 1},
-            {3001, 168, 0, 1},
-            {3001, 169, 0, 1},
-            {2018, 170, 0, 0},
-            {14, 171, 0, 1},
-            {2012, 172, 0, 1},
-            {2012, 173, 0, 1},
-            {2012, 174, 0, 1},
-            {2012, 175, 0, 1},
-            {2011, 176, 0, 1},
-            {2014, 177, 0, 1},
-            {2014, 178, 0, 1},
-            {2014, 179, 0, 1},
-            {2014, 180, 0, 1},
-            {2014, 181, 0, 1},
-            {13, 182, 0, 0},
-            {2008, 183, 0, 1},
-            {2014, 184, 0, 1},
-            {2014, 185, 0, 1},
-            {2014, 186, 0, 1},
-            {2014, 187, 0, 1},
-            {2014, 188, 0, 1},
-            {3001, 189, 0, 1},
-            {3001, 190, 0, 1},
-            {3001, 191, 0, 1},
-            {3001, 192, 0, 1},
-            {3001, 193, 0, 1},
-            {3001, 194, 0, 1},
-            {3001, 195, 0, 1},
-            {3001, 196, 0, 1},
-            {3001, 197, 0, 1},
-            {3006, 198, 0, 1},
-            {3006, 199, 0, 1},
-            {3006, 200, 0, 1},
-            {3006, 201, 0, 1},
-            {3006, 202, 0, 1},
-            {3005, 203, 0, 1},
-            {3005, 204, 0, 1},
-            {3005, 205, 0, 1},
-            {3005, 206, 0, 1},
-            {3005, 207, 0, 1},
-            {2011, 208, 0, 1},
-            {2011, 209, 0, 1},
-            {2011, 210, 0, 1},
-            {2008, 211, 0, 1},
-            {2008, 212, 0, 1},
-            {2049, 213, 0, 1},
-            {45, 214, 0, 1},
-            {45, 215, 0, 1},
-            {2012, 216, 0, 1},
-            {2012, 217, 0, 1},
-            {2049, 218, 0, 1},
-            {2049, 219, 0, 1},
-            {11, 220, 0, 1},
-            {11, 221, 0, 1},
-            {11, 222, 0, 1},
-            {11, 223, 0, 1},
-            {11, 224, 0, 1},
-            {11, 225, 0, 1},
-            {11, 226, 0, 1},
-            {2046, 227, 0, 1},
-            {67, 228, 0, 1},
-            {6, 229, 0, 0},
-            {2012, 230, 0, 1},
-            {2012, 231, 0, 1},
-            {2012, 232, 0, 1},
-            {2012, 233, 0, 1},
-            {3005, 234, 0, 1},
-            {3006, 235, 0, 1},
-            {3006, 236, 0, 1},
-            {3006, 237, 0, 1},
-            {3005, 238, 0, 1},
-            {3006, 239, 0, 1},
-            {3006, 240, 0, 1},
-            {3006, 241, 0, 1},
-            {2008, 242, 0, 1},
-            {2008, 243, 0, 1},
-            {2008, 244, 0, 1},
-            {2008, 245, 0, 1},
-            {2008, 246, 0, 1},
-            {2015, 247, 0, 1},
-            {2015, 248, 0, 1},
-            {2015, 249, 0, 1},
-            {2015, 250, 0, 1},
-            {2015, 251, 0, 1},
-            {2015, 252, 0, 1},
-            {2015, 253, 0, 1},
-            {8, 254, 0, 0},
-            {2049, 255, 0, 1},
-            {2008, 256, 0, 1},
-            {2008, 257, 0, 1},
-            {2008, 258, 0, 1},
-            {2008, 259, 0, 1},
-            {2008, 260, 0, 1},
-            {57, 261, 0, 1},
-            {57, 262, 0, 1},
-            {44, 263, 0, 1},
-            {44, 264, 0, 1},
-            {44, 265, 0, 1},
-            {44, 266, 0, 1},
-            {52, 267, 0, 1},
-            {51, 268, 0, 1},
-            {53, 269, 0, 1},
-            {61, 270, 0, 1},
-            {61, 271, 0, 1},
-            {62, 272, 0, 1},
-            {62, 273, 0, 1},
-            {59, 274, 0, 1},
-            {59, 275, 0, 1},
-            {61, 276, 0, 1},
-            {59, 277, 0, 1},
-            {62, 278, 0, 1},
-            {2006, 279, 0, 1},
-            {17, 280, 0, 1},
-            {2048, 281, 0, 1},
-            {2048, 282, 0, 1},
-            {2048, 283, 0, 1},
-            {2046, 284, 0, 1},
-            {2046, 285, 0, 1},
-            {3003, 286, 0, 1},
-            {3005, 287, 0, 1},
-            {3005, 288, 0, 1},
-            {3005, 289, 0, 1},
-            {3005, 290, 0, 1},
-            {3005, 291, 0, 1},
-            {2046, 292, 0, 1},
-            {2046, 293, 0, 1},
-            {14, 294, 0, 1},
-            {16, 295, 0, 1},
-        }},
-        {"Monster Condo (MAP27)", {true, true, true}, {1, 1, 1}, 30, 490, {
-            {1, 0, 0, 1},
-            {2, 1, 0, 1},
-            {3, 2, 0, 1},
-            {4, 3, 0, 1},
-            {2003, 4, 0, 0},
-            {31, 5, 0, 1},
-            {31, 6, 0, 1},
-            {44, 7, 0, 1},
-            {58, 8, 0, 1},
-            {58, 9, 0, 1},
-            {2048, 10, 0, 1},
-            {2048, 11, 0, 1},
-            {2011, 12, 0, 1},
-            {2002, 13, 0, 1},
-            {9, 14, 0, 1},
-            {9, 15, 0, 1},
-            {9, 16, 0, 1},
-            {9, 17, 0, 1},
-            {65, 18, 0, 1},
-            {65, 19, 0, 1},
-            {65, 20, 0, 1},
-            {2049, 21, 0, 1},
-            {9, 22, 0, 1},
-            {3004, 23, 0, 1},
-            {3004, 24, 0, 1},
-            {3004, 25, 0, 1},
-            {3004, 26, 0, 1},
-            {2012, 27, 0, 1},
-            {2012, 28, 0, 1},
-            {2011, 29, 0, 1},
-            {2011, 30, 0, 1},
-            {2010, 31, 0, 1},
-            {2008, 32, 0, 1},
-            {2011, 33, 0, 1},
-            {2008, 34, 0, 1},
-            {2007, 35, 0, 1},
-            {66, 36, 0, 1},
-            {69, 37, 0, 1},
-            {2049, 38, 0, 1},
-            {3002, 39, 0, 1},
-            {3001, 40, 0, 1},
-            {3001, 41, 0, 1},
-            {9, 42, 0, 1},
-            {65, 43, 0, 1},
-            {9, 44, 0, 1},
-            {3004, 45, 0, 1},
-            {3004, 46, 0, 1},
-            {3004, 47, 0, 1},
-            {3004, 48, 0, 1},
-            {2010, 49, 0, 1},
-            {2012, 50, 0, 1},
-            {2024, 51, 0, 0},
-            {2011, 52, 0, 1},
-            {69, 53, 0, 1},
-            {64, 54, 0, 1},
-            {69, 55, 0, 1},
-            {69, 56, 0, 1},
-            {69, 57, 0, 1},
-            {2004, 58, 0, 0},
-            {2046, 59, 0, 1},
-            {2022, 60, 0, 0},
-            {3002, 61, 0, 1},
-            {2010, 62, 0, 1},
-            {65, 63, 0, 1},
-            {58, 64, 0, 1},
-            {58, 65, 0, 1},
-            {2048, 66, 0, 1},
-            {2011, 67, 0, 1},
-            {3004, 68, 0, 1},
-            {3004, 69, 0, 1},
-            {3004, 70, 0, 1},
-            {3004, 71, 0, 1},
-            {3004, 72, 0, 1},
-            {3004, 73, 0, 1},
-            {3002, 74, 0, 1},
-            {3002, 75, 0, 1},
-            {3002, 76, 0, 1},
-            {3002, 77, 0, 1},
-            {9, 78, 0, 1},
-            {9, 79, 0, 1},
-            {9, 80, 0, 1},
-            {9, 81, 0, 1},
-            {2015, 82, 0, 1},
-            {2014, 83, 0, 1},
-            {2014, 84, 0, 1},
-            {2015, 85, 0, 1},
-            {2018, 86, 0, 0},
-            {2012, 87, 0, 1},
-            {69, 88, 0, 1},
-            {69, 89, 0, 1},
-            {69, 90, 0, 1},
-            {3001, 91, 0, 1},
-            {3001, 92, 0, 1},
-            {3001, 93, 0, 1},
-            {2047, 94, 0, 1},
-            {2047, 95, 0, 1},
-            {2014, 96, 0, 1},
-            {2014, 97, 0, 1},
-            {2014, 98, 0, 1},
-            {2046, 99, 0, 1},
-            {2047, 100, 0, 1},
-            {69, 101, 0, 1},
-            {2010, 102, 0, 1},
-            {2001, 103, 0, 1},
-            {2046, 104, 0, 1},
-            {8, 105, 0, 0},
-            {2045, 106, 0, 1},
-            {2022, 107, 0, 0},
-            {29, 108, 0, 1},
-            {29, 109, 0, 1},
-            {41, 110, 0, 1},
-            {9, 111, 0, 1},
-            {9, 112, 0, 1},
-            {9, 113, 0, 1},
-            {3002, 114, 0, 1},
-            {3002, 115, 0, 1},
-            {3002, 116, 0, 1},
-            {3004, 117, 0, 1},
-            {3004, 118, 0, 1},
-            {3004, 119, 0, 1},
-            {3004, 120, 0, 1},
-            {2045, 121, 0, 1},
-            {2024, 122, 0, 0},
-            {2047, 123, 0, 1},
-            {48, 124, 0, 1},
-            {42, 125, 0, 1},
-            {27, 126, 0, 1},
-            {59, 127, 0, 1},
-            {61, 128, 0, 1},
-            {59, 129, 0, 1},
-            {59, 130, 0, 1},
-            {59, 131, 0, 1},
-            {62, 132, 0, 1},
-            {59, 133, 0, 1},
-            {59, 134, 0, 1},
-            {63, 135, 0, 1},
-            {59, 136, 0, 1},
-            {59, 137, 0, 1},
-            {61, 138, 0, 1},
-            {25, 139, 0, 1},
-            {26, 140, 0, 1},
-            {59, 141, 0, 1},
-            {61, 142, 0, 1},
-            {25, 143, 0, 1},
-            {59, 144, 0, 1},
-            {62, 145, 0, 1},
-            {59, 146, 0, 1},
-            {59, 147, 0, 1},
-            {59, 148, 0, 1},
-            {25, 149, 0, 1},
-            {62, 150, 0, 1},
-            {59, 151, 0, 1},
-            {63, 152, 0, 1},
-            {59, 153, 0, 1},
-            {25, 154, 0, 1},
-            {59, 155, 0, 1},
-            {24, 156, 0, 1},
-            {24, 157, 0, 1},
-            {24, 158, 0, 1},
-            {24, 159, 0, 1},
-            {24, 160, 0, 1},
-            {24, 161, 0, 1},
-            {24, 162, 0, 1},
-            {24, 163, 0, 1},
-            {24, 164, 0, 1},
-            {2049, 165, 0, 1},
-            {68, 166, 0, 1},
-            {68, 167, 0, 1},
-            {68, 168, 0, 1},
-            {2012, 169, 0, 1},
-            {2015, 170, 0, 1},
-            {2015, 171, 0, 1},
-            {2015, 172, 0, 1},
-            {2015, 173, 0, 1},
-            {2015, 174, 0, 1},
-            {2015, 175, 0, 1},
-            {58, 176, 0, 1},
-            {58, 177, 0, 1},
-            {58, 178, 0, 1},
-            {58, 179, 0, 1},
-            {58, 180, 0, 1},
-            {2014, 181, 0, 1},
-            {2014, 182, 0, 1},
-            {2014, 183, 0, 1},
-            {2014, 184, 0, 1},
-            {2014, 185, 0, 1},
-            {2014, 186, 0, 1},
-            {2014, 187, 0, 1},
-            {2014, 188, 0, 1},
-            {68, 189, 0, 1},
-            {2007, 190, 0, 1},
-            {2012, 191, 0, 1},
-            {3001, 192, 0, 1},
-            {3001, 193, 0, 1},
-            {3001, 194, 0, 1},
-            {3001, 195, 0, 1},
-            {3001, 196, 0, 1},
-            {3001, 197, 0, 1},
-            {3001, 198, 0, 1},
-            {3001, 199, 0, 1},
-            {3001, 200, 0, 1},
-            {3001, 201, 0, 1},
-            {3001, 202, 0, 1},
-            {2048, 203, 0, 1},
-            {2010, 204, 0, 1},
-            {2010, 205, 0, 1},
-            {2049, 206, 0, 1},
-            {57, 207, 0, 1},
-            {57, 208, 0, 1},
-            {57, 209, 0, 1},
-            {2007, 210, 0, 1},
-            {57, 211, 0, 1},
-            {57, 212, 0, 1},
-            {57, 213, 0, 1},
-            {57, 214, 0, 1},
-            {25, 215, 0, 1},
-            {25, 216, 0, 1},
-            {62, 217, 0, 1},
-            {27, 218, 0, 1},
-            {60, 219, 0, 1},
-            {63, 220, 0, 1},
-            {69, 221, 0, 1},
-            {64, 222, 0, 1},
-            {3006, 223, 0, 1},
-            {3006, 224, 0, 1},
-            {3006, 225, 0, 1},
-            {3006, 226, 0, 1},
-            {3006, 227, 0, 1},
-            {3006, 228, 0, 1},
-            {3006, 229, 0, 1},
-            {2011, 230, 0, 1},
-            {2011, 231, 0, 1},
-            {2014, 232, 0, 1},
-            {2014, 233, 0, 1},
-            {2014, 234, 0, 1},
-            {2014, 235, 0, 1},
-            {2013, 236, 0, 0},
-            {2010, 237, 0, 1},
-            {2010, 238, 0, 1},
-            {2018, 239, 0, 0},
-            {2014, 240, 0, 1},
-            {2014, 241, 0, 1},
-            {2014, 242, 0, 1},
-            {24, 243, 0, 1},
-            {24, 244, 0, 1},
-            {24, 245, 0, 1},
-            {24, 246, 0, 1},
-            {24, 247, 0, 1},
-            {24, 248, 0, 1},
-            {57, 249, 0, 1},
-            {2049, 250, 0, 1},
-            {2002, 251, 0, 0},
-            {2010, 252, 0, 1},
-            {2010, 253, 0, 1},
-            {2008, 254, 0, 1},
-            {2008, 255, 0, 1},
-            {2007, 256, 0, 1},
-            {2007, 257, 0, 1},
-            {44, 258, 0, 1},
-            {44, 259, 0, 1},
-            {2014, 260, 0, 1},
-            {2014, 261, 0, 1},
-            {2014, 262, 0, 1},
-            {2014, 263, 0, 1},
-            {2014, 264, 0, 1},
-            {2014, 265, 0, 1},
-            {2014, 266, 0, 1},
-            {2014, 267, 0, 1},
-            {2015, 268, 0, 1},
-            {2015, 269, 0, 1},
-            {2015, 270, 0, 1},
-            {2015, 271, 0, 1},
-            {2015, 272, 0, 1},
-            {2015, 273, 0, 1},
-            {2015, 274, 0, 1},
-            {2015, 275, 0, 1},
-            {2015, 276, 0, 1},
-            {2015, 277, 0, 1},
-            {2015, 278, 0, 1},
-            {2006, 279, 0, 0},
-            {2048, 280, 0, 1},
-            {2049, 281, 0, 1},
-            {2010, 282, 0, 1},
-            {2010, 283, 0, 1},
-            {14, 284, 0, 1},
-            {8, 285, 0, 0},
-            {8, 286, 0, 0},
-            {8, 287, 0, 0},
-            {57, 288, 0, 1},
-            {2014, 289, 0, 1},
-            {2014, 290, 0, 1},
-            {2014, 291, 0, 1},
-            {2014, 292, 0, 1},
-            {2014, 293, 0, 1},
-            {2014, 294, 0, 1},
-            {2014, 295, 0, 1},
-            {2014, 296, 0, 1},
-            {2014, 297, 0, 1},
-            {2014, 298, 0, 1},
-            {2014, 299, 0, 1},
-            {2014, 300, 0, 1},
-            {2014, 301, 0, 1},
-            {2014, 302, 0, 1},
-            {2014, 303, 0, 1},
-            {2014, 304, 0, 1},
-            {2014, 305, 0, 1},
-            {2014, 306, 0, 1},
-            {2014, 307, 0, 1},
-            {2014, 308, 0, 1},
-            {2014, 309, 0, 1},
-            {39, 310, 0, 0},
-            {35, 311, 0, 1},
-            {35, 312, 0, 1},
-            {35, 313, 0, 1},
-            {35, 314, 0, 1},
-            {3002, 315, 0, 1},
-            {3002, 316, 0, 1},
-            {69, 317, 0, 1},
-            {69, 318, 0, 1},
-            {3001, 319, 0, 1},
-            {3001, 320, 0, 1},
-            {3001, 321, 0, 1},
-            {3001, 322, 0, 1},
-            {69, 323, 0, 1},
-            {3002, 324, 0, 1},
-            {3002, 325, 0, 1},
-            {2048, 326, 0, 1},
-            {2015, 327, 0, 1},
-            {2015, 328, 0, 1},
-            {2015, 329, 0, 1},
-            {2015, 330, 0, 1},
-            {2012, 331, 0, 1},
-            {2008, 332, 0, 1},
-            {2014, 333, 0, 1},
-            {2014, 334, 0, 1},
-            {2014, 335, 0, 1},
-            {2014, 336, 0, 1},
-            {2011, 337, 0, 1},
-            {2007, 338, 0, 1},
-            {3002, 339, 0, 1},
-            {3002, 340, 0, 1},
-            {3001, 341, 0, 1},
-            {3001, 342, 0, 1},
-            {3001, 343, 0, 1},
-            {3001, 344, 0, 1},
-            {2011, 345, 0, 1},
-            {2008, 346, 0, 1},
-            {2048, 347, 0, 1},
-            {2049, 348, 0, 1},
-            {2046, 349, 0, 1},
-            {2047, 350, 0, 1},
-            {2011, 351, 0, 1},
-            {2011, 352, 0, 1},
-            {2011, 353, 0, 1},
-            {2011, 354, 0, 1},
-            {69, 355, 0, 1},
-            {69, 356, 0, 1},
-            {69, 357, 0, 1},
-            {69, 358, 0, 1},
-            {69, 359, 0, 1},
-            {69, 360, 0, 1},
-            {69, 361, 0, 1},
-            {69, 362, 0, 1},
-            {3003, 363, 0, 1},
-            {38, 364, 0, 0},
-            {2013, 365, 0, 0},
-            {2048, 366, 0, 1},
-            {2046, 367, 0, 1},
-            {2008, 368, 0, 1},
-            {2008, 369, 0, 1},
-            {2008, 370, 0, 1},
-            {2008, 371, 0, 1},
-            {2010, 372, 0, 1},
-            {2047, 373, 0, 1},
-            {2007, 374, 0, 1},
-            {2007, 375, 0, 1},
-            {2007, 376, 0, 1},
-            {2008, 377, 0, 1},
-            {2008, 378, 0, 1},
-            {2010, 379, 0, 1},
-            {2010, 380, 0, 1},
-            {2047, 381, 0, 1},
-            {40, 382, 0, 0},
-            {67, 383, 0, 1},
-            {67, 384, 0, 1},
-            {67, 385, 0, 1},
-            {67, 386, 0, 1},
-            {67, 387, 0, 1},
-            {67, 388, 0, 1},
-            {66, 389, 0, 1},
-            {66, 390, 0, 1},
-            {66, 391, 0, 1},
-            {2013, 392, 0, 0},
-            {2026, 393, 0, 0},
-            {2023, 394, 0, 0},
-            {45, 395, 0, 1},
-            {45, 396, 0, 1},
-            {2047, 397, 0, 1},
-            {2047, 398, 0, 1},
-            {2047, 399, 0, 1},
-            {2047, 400, 0, 1},
-            {3002, 401, 0, 1},
-            {2047, 402, 0, 1},
-            {2046, 403, 0, 1},
-            {2048, 404, 0, 1},
-            {2012, 405, 0, 1},
-            {2007, 406, 0, 1},
-            {2007, 407, 0, 1},
-            {2007, 408, 0, 1},
-            {2008, 409, 0, 1},
-            {2008, 410, 0, 1},
-            {2010, 411, 0, 1},
-            {2010, 412, 0, 1},
-            {2047, 413, 0, 1},
-            {2013, 414, 0, 0},
-            {67, 415, 0, 1},
-            {67, 416, 0, 1},
-            {67, 417, 0, 1},
-            {67, 418, 0, 1},
-            {67, 419, 0, 1},
-            {67, 420, 0, 1},
-            {66, 421, 0, 1},
-            {66, 422, 0, 1},
-            {66, 423, 0, 1},
-            {2013, 424, 0, 0},
-            {2026, 425, 0, 0},
-            {2023, 426, 0, 0},
-            {2047, 427, 0, 1},
-            {2047, 428, 0, 1},
-            {2047, 429, 0, 1},
-            {2047, 430, 0, 1},
-            {14, 431, 0, 1},
-            {65, 432, 0, 1},
-            {65, 433, 0, 1},
-            {66, 434, 0, 1},
-            {67, 435, 0, 1},
-            {9, 436, 0, 1},
-            {9, 437, 0, 1},
-            {9, 438, 0, 1},
-            {9, 439, 0, 1},
-            {9, 440, 0, 1},
-            {9, 441, 0, 1},
-            {9, 442, 0, 1},
-            {9, 443, 0, 1},
-            {65, 444, 0, 1},
-            {66, 445, 0, 1},
-            {65, 446, 0, 1},
-            {65, 447, 0, 1},
-            {65, 448, 0, 1},
-            {2003, 449, 0, 1},
-            {2004, 450, 0, 1},
-            {2006, 451, 0, 1},
-            {2002, 452, 0, 1},
-            {2001, 453, 0, 1},
-            {2024, 454, 0, 0},
-            {2022, 455, 0, 0},
-            {17, 456, 0, 1},
-            {2048, 457, 0, 1},
-            {2046, 458, 0, 1},
-            {2049, 459, 0, 1},
-            {2005, 460, 0, 0},
-            {14, 461, 0, 1},
-            {11, 462, 0, 1},
-            {11, 463, 0, 1},
-            {11, 464, 0, 1},
-            {11, 465, 0, 1},
-            {11, 466, 0, 1},
-            {11, 467, 0, 1},
-            {11, 468, 0, 1},
-            {11, 469, 0, 1},
-            {82, 470, 0, 0},
-            {2048, 471, 0, 1},
-            {66, 472, 0, 1},
-            {66, 473, 0, 1},
-            {66, 474, 0, 1},
-            {66, 475, 0, 1},
-            {66, 476, 0, 1},
-            {66, 477, 0, 1},
-            {2010, 478, 0, 1},
-            {2010, 479, 0, 1},
-            {66, 480, 0, 1},
-            {66, 481, 0, 1},
-            {66, 482, 0, 1},
-            {66, 483, 0, 1},
-            {66, 484, 0, 1},
-            {66, 485, 0, 1},
-            {71, 486, 0, 1},
-            {71, 487, 0, 1},
-            {71, 488, 0, 1},
-            {71, 489, 0, 1},
-        }},
-        {"The Spirit World (MAP28)", {false, true, true}, {0, 1, 1}, 22, 266, {
-            {1, 0, 0, 1},
-            {2, 1, 0, 1},
-            {3, 2, 0, 1},
-            {4, 3, 0, 1},
-            {46, 4, 0, 1},
-            {46, 5, 0, 1},
-            {46, 6, 0, 1},
-            {46, 7, 0, 1},
-            {46, 8, 0, 1},
-            {46, 9, 0, 1},
-            {46, 10, 0, 1},
-            {46, 11, 0, 1},
-            {47, 12, 0, 1},
-            {47, 13, 0, 1},
-            {47, 14, 0, 1},
-            {47, 15, 0, 1},
-            {42, 16, 0, 1},
-            {47, 17, 0, 1},
-            {2048, 18, 0, 1},
-            {2018, 19, 0, 0},
-            {2049, 20, 0, 1},
-            {2012, 21, 0, 1},
-            {2011, 22, 0, 1},
-            {2011, 23, 0, 1},
-            {2007, 24, 0, 1},
-            {2007, 25, 0, 1},
-            {3002, 26, 0, 1},
-            {3002, 27, 0, 1},
-            {3002, 28, 0, 1},
-            {3002, 29, 0, 1},
-            {3001, 30, 0, 1},
-            {3001, 31, 0, 1},
-            {3001, 32, 0, 1},
-            {3002, 33, 0, 1},
-            {3002, 34, 0, 1},
-            {47, 35, 0, 1},
-            {47, 36, 0, 1},
-            {47, 37, 0, 1},
-            {47, 38, 0, 1},
-            {47, 39, 0, 1},
-            {56, 40, 0, 1},
-            {56, 41, 0, 1},
-            {56, 42, 0, 1},
-            {56, 43, 0, 1},
-            {56, 44, 0, 1},
-            {56, 45, 0, 1},
-            {3001, 46, 0, 1},
-            {3001, 47, 0, 1},
-            {3001, 48, 0, 1},
-            {3001, 49, 0, 1},
-            {3001, 50, 0, 1},
-            {3001, 51, 0, 1},
-            {3001, 52, 0, 1},
-            {58, 53, 0, 1},
-            {58, 54, 0, 1},
-            {58, 55, 0, 1},
-            {3001, 56, 0, 1},
-            {64, 57, 0, 1},
-            {3001, 58, 0, 1},
-            {3001, 59, 0, 1},
-            {3001, 60, 0, 1},
-            {3001, 61, 0, 1},
-            {3001, 62, 0, 1},
-            {2007, 63, 0, 1},
-            {2008, 64, 0, 1},
-            {2046, 65, 0, 1},
-            {2005, 66, 0, 0},
-            {2007, 67, 0, 1},
-            {2008, 68, 0, 1},
-            {2011, 69, 0, 1},
-            {2008, 70, 0, 1},
-            {69, 71, 0, 1},
-            {69, 72, 0, 1},
-            {69, 73, 0, 1},
-            {69, 74, 0, 1},
-            {64, 75, 0, 1},
-            {2022, 76, 0, 0},
-            {2010, 77, 0, 1},
-            {2010, 78, 0, 1},
-            {2010, 79, 0, 1},
-            {2010, 80, 0, 1},
-            {2046, 81, 0, 1},
-            {2047, 82, 0, 1},
-            {2049, 83, 0, 1},
-            {2047, 84, 0, 1},
-            {14, 85, 0, 1},
-            {11, 86, 0, 1},
-            {39, 87, 0, 0},
-            {3006, 88, 0, 1},
-            {3006, 89, 0, 1},
-            {66, 90, 0, 1},
-            {3001, 91, 0, 1},
-            {3001, 92, 0, 1},
-            {3006, 93, 0, 1},
-            {3001, 94, 0, 1},
-            {2013, 95, 0, 0},
-            {2002, 96, 0, 0},
-            {2048, 97, 0, 1},
-            {65, 98, 0, 1},
-            {9, 99, 0, 1},
-            {9, 100, 0, 1},
-            {9, 101, 0, 1},
-            {3005, 102, 0, 1},
-            {9, 103, 0, 1},
-            {3001, 104, 0, 1},
-            {3001, 105, 0, 1},
-            {3001, 106, 0, 1},
-            {3001, 107, 0, 1},
-            {3001, 108, 0, 1},
-            {66, 109, 0, 1},
-            {3006, 110, 0, 1},
-            {3006, 111, 0, 1},
-            {3006, 112, 0, 1},
-            {67, 113, 0, 1},
-            {2007, 114, 0, 1},
-            {2007, 115, 0, 1},
-            {67, 116, 0, 1},
-            {34, 117, 0, 1},
-            {34, 118, 0, 1},
-            {2003, 119, 0, 1},
-            {2035, 120, 0, 1},
-            {9, 121, 0, 1},
-            {69, 122, 0, 1},
-            {66, 123, 0, 1},
-            {2003, 124, 0, 0},
-            {2015, 125, 0, 1},
-            {2015, 126, 0, 1},
-            {2015, 127, 0, 1},
-            {2014, 128, 0, 1},
-            {2014, 129, 0, 1},
-            {2014, 130, 0, 1},
-            {2014, 131, 0, 1},
-            {66, 132, 0, 1},
-            {2047, 133, 0, 1},
-            {65, 134, 0, 1},
-            {65, 135, 0, 1},
-            {65, 136, 0, 1},
-            {65, 137, 0, 1},
-            {65, 138, 0, 1},
-            {3004, 139, 0, 1},
-            {3004, 140, 0, 1},
-            {3004, 141, 0, 1},
-            {2014, 142, 0, 1},
-            {2014, 143, 0, 1},
-            {2014, 144, 0, 1},
-            {2014, 145, 0, 1},
-            {11, 146, 0, 1},
-            {2008, 147, 0, 1},
-            {71, 148, 0, 1},
-            {71, 149, 0, 1},
-            {71, 150, 0, 1},
-            {3006, 151, 0, 1},
-            {3006, 152, 0, 1},
-            {3006, 153, 0, 1},
-            {66, 154, 0, 1},
-            {8, 155, 0, 0},
-            {8, 156, 0, 0},
-            {8, 157, 0, 0},
-            {8, 158, 0, 0},
-            {2023, 159, 0, 0},
-            {58, 160, 0, 1},
-            {58, 161, 0, 1},
-            {68, 162, 0, 1},
-            {2004, 163, 0, 0},
-            {2048, 164, 0, 1},
-            {2048, 165, 0, 1},
-            {68, 166, 0, 1},
-            {68, 167, 0, 1},
-            {68, 168, 0, 1},
-            {68, 169, 0, 1},
-            {68, 170, 0, 1},
-            {68, 171, 0, 1},
-            {68, 172, 0, 1},
-            {68, 173, 0, 1},
-            {68, 174, 0, 1},
-            {68, 175, 0, 1},
-            {68, 176, 0, 1},
-            {7, 177, 0, 1},
-            {7, 178, 0, 1},
-            {2022, 179, 0, 0},
-            {2022, 180, 0, 0},
-            {2006, 181, 0, 0},
-            {69, 182, 0, 1},
-            {83, 183, 0, 0},
-            {69, 184, 0, 1},
-            {83, 185, 0, 0},
-            {2022, 186, 0, 0},
-            {2011, 187, 0, 1},
-            {2011, 188, 0, 1},
-            {2011, 189, 0, 1},
-            {2011, 190, 0, 1},
-            {2011, 191, 0, 1},
-            {2011, 192, 0, 1},
-            {2011, 193, 0, 1},
-            {2011, 194, 0, 1},
-            {2022, 195, 0, 0},
-            {3006, 196, 0, 1},
-            {3006, 197, 0, 1},
-            {3006, 198, 0, 1},
-            {2002, 199, 0, 1},
-            {2007, 200, 0, 1},
-            {71, 201, 0, 1},
-            {71, 202, 0, 1},
-            {2007, 203, 0, 1},
-            {2008, 204, 0, 1},
-            {2008, 205, 0, 1},
-            {2008, 206, 0, 1},
-            {2012, 207, 0, 1},
-            {2012, 208, 0, 1},
-            {2012, 209, 0, 1},
-            {2011, 210, 0, 1},
-            {2011, 211, 0, 1},
-            {2011, 212, 0, 1},
-            {2012, 213, 0, 1},
-            {82, 214, 0, 0},
-            {66, 215, 0, 1},
-            {38, 216, 0, 0},
-            {66, 217, 0, 1},
-            {66, 218, 0, 1},
-            {58, 219, 0, 1},
-            {58, 220, 0, 1},
-            {58, 221, 0, 1},
-            {58, 222, 0, 1},
-            {58, 223, 0, 1},
-            {58, 224, 0, 1},
-            {58, 225, 0, 1},
-            {58, 226, 0, 1},
-            {58, 227, 0, 1},
-            {58, 228, 0, 1},
-            {58, 229, 0, 1},
-            {58, 230, 0, 1},
-            {66, 231, 0, 1},
-            {2049, 232, 0, 1},
-            {66, 233, 0, 1},
-            {66, 234, 0, 1},
-            {66, 235, 0, 1},
-            {66, 236, 0, 1},
-            {66, 237, 0, 1},
-            {66, 238, 0, 1},
-            {66, 239, 0, 1},
-            {66, 240, 0, 1},
-            {2012, 241, 0, 1},
-            {2012, 242, 0, 1},
-            {2004, 243, 0, 1},
-            {64, 244, 0, 1},
-            {64, 245, 0, 1},
-            {17, 246, 0, 1},
-            {2046, 247, 0, 1},
-            {2049, 248, 0, 1},
-            {2049, 249, 0, 1},
-            {2048, 250, 0, 1},
-            {2048, 251, 0, 1},
-            {2014, 252, 0, 1},
-            {2014, 253, 0, 1},
-            {2014, 254, 0, 1},
-            {2014, 255, 0, 1},
-            {2014, 256, 0, 1},
-            {17, 257, 0, 1},
-            {17, 258, 0, 1},
-            {17, 259, 0, 1},
-            {17, 260, 0, 1},
-            {17, 261, 0, 1},
-            {17, 262, 0, 1},
-            {11, 263, 0, 1},
-            {11, 264, 0, 1},
-            {11, 265, 0, 1},
-        }},
-        {"The Living End (MAP29)", {false, false, false}, {0, 0, 0}, 10, 276, {
-            {1, 0, 0, 1},
-            {2012, 1, 0, 1},
-            {57, 2, 0, 1},
-            {57, 3, 0, 1},
-            {57, 4, 0, 1},
-            {57, 5, 0, 1},
-            {46, 6, 0, 1},
-            {46, 7, 0, 1},
-            {46, 8, 0, 1},
-            {46, 9, 0, 1},
-            {56, 10, 0, 1},
-            {56, 11, 0, 1},
-            {46, 12, 0, 1},
-            {12, 13, 0, 1},
-            {15, 14, 0, 1},
-            {10, 15, 0, 1},
-            {18, 16, 0, 1},
-            {62, 17, 0, 1},
-            {59, 18, 0, 1},
-            {35, 19, 0, 1},
-            {35, 20, 0, 1},
-            {14, 21, 0, 1},
-            {14, 22, 0, 1},
-            {17, 23, 0, 1},
-            {17, 24, 0, 1},
-            {17, 25, 0, 1},
-            {17, 26, 0, 1},
-            {45, 27, 0, 1},
-            {45, 28, 0, 1},
-            {45, 29, 0, 1},
-            {45, 30, 0, 1},
-            {14, 31, 0, 1},
-            {56, 32, 0, 1},
-            {56, 33, 0, 1},
-            {56, 34, 0, 1},
-            {46, 35, 0, 1},
-            {46, 36, 0, 1},
-            {46, 37, 0, 1},
-            {46, 38, 0, 1},
-            {46, 39, 0, 1},
-            {46, 40, 0, 1},
-            {14, 41, 0, 1},
-            {57, 42, 0, 1},
-            {3001, 43, 0, 1},
-            {3001, 44, 0, 1},
-            {3005, 45, 0, 1},
-            {3005, 46, 0, 1},
-            {3005, 47, 0, 1},
-            {3005, 48, 0, 1},
-            {3005, 49, 0, 1},
-            {3005, 50, 0, 1},
-            {46, 51, 0, 1},
-            {46, 52, 0, 1},
-            {45, 53, 0, 1},
-            {45, 54, 0, 1},
-            {14, 55, 0, 1},
-            {14, 56, 0, 1},
-            {14, 57, 0, 1},
-            {3003, 58, 0, 1},
-            {46, 59, 0, 1},
-            {46, 60, 0, 1},
-            {46, 61, 0, 1},
-            {46, 62, 0, 1},
-            {44, 63, 0, 1},
-            {44, 64, 0, 1},
-            {45, 65, 0, 1},
-            {45, 66, 0, 1},
-            {46, 67, 0, 1},
-            {46, 68, 0, 1},
-            {46, 69, 0, 1},
-            {46, 70, 0, 1},
-            {46, 71, 0, 1},
-            {44, 72, 0, 1},
-            {44, 73, 0, 1},
-            {46, 74, 0, 1},
-            {46, 75, 0, 1},
-            {46, 76, 0, 1},
-            {46, 77, 0, 1},
-            {56, 78, 0, 1},
-            {56, 79, 0, 1},
-            {56, 80, 0, 1},
-            {56, 81, 0, 1},
-            {16, 82, 0, 1},
-            {14, 83, 0, 1},
-            {14, 84, 0, 1},
-            {2002, 85, 0, 0},
-            {2001, 86, 0, 1},
-            {3001, 87, 0, 1},
-            {9, 88, 0, 1},
-            {9, 89, 0, 1},
-            {65, 90, 0, 1},
-            {58, 91, 0, 1},
-            {9, 92, 0, 1},
-            {2012, 93, 0, 1},
-            {2049, 94, 0, 1},
-            {3001, 95, 0, 1},
-            {3001, 96, 0, 1},
-            {3001, 97, 0, 1},
-            {3001, 98, 0, 1},
-            {3001, 99, 0, 1},
-            {3001, 100, 0, 1},
-            {65, 101, 0, 1},
-            {65, 102, 0, 1},
-            {65, 103, 0, 1},
-            {65, 104, 0, 1},
-            {3001, 105, 0, 1},
-            {3005, 106, 0, 1},
-            {3005, 107, 0, 1},
-            {3005, 108, 0, 1},
-            {71, 109, 0, 1},
-            {71, 110, 0, 1},
-            {2049, 111, 0, 1},
-            {3001, 112, 0, 1},
-            {3001, 113, 0, 1},
-            {3001, 114, 0, 1},
-            {3005, 115, 0, 1},
-            {65, 116, 0, 1},
-            {65, 117, 0, 1},
-            {65, 118, 0, 1},
-            {65, 119, 0, 1},
-            {65, 120, 0, 1},
-            {65, 121, 0, 1},
-            {9, 122, 0, 1},
-            {9, 123, 0, 1},
-            {2004, 124, 0, 0},
-            {2048, 125, 0, 1},
-            {2014, 126, 0, 1},
-            {2014, 127, 0, 1},
-            {2014, 128, 0, 1},
-            {2015, 129, 0, 1},
-            {2015, 130, 0, 1},
-            {2015, 131, 0, 1},
-            {3001, 132, 0, 1},
-            {69, 133, 0, 1},
-            {69, 134, 0, 1},
-            {69, 135, 0, 1},
-            {66, 136, 0, 1},
-            {3001, 137, 0, 1},
-            {3001, 138, 0, 1},
-            {69, 139, 0, 1},
-            {64, 140, 0, 1},
-            {67, 141, 0, 1},
-            {66, 142, 0, 1},
-            {66, 143, 0, 1},
-            {66, 144, 0, 1},
-            {3003, 145, 0, 1},
-            {3003, 146, 0, 1},
-            {71, 147, 0, 1},
-            {9, 148, 0, 1},
-            {9, 149, 0, 1},
-            {9, 150, 0, 1},
-            {9, 151, 0, 1},
-            {9, 152, 0, 1},
-            {9, 153, 0, 1},
-            {9, 154, 0, 1},
-            {9, 155, 0, 1},
-            {9, 156, 0, 1},
-            {9, 157, 0, 1},
-            {2025, 158, 0, 1},
-            {67, 159, 0, 1},
-            {69, 160, 0, 1},
-            {3004, 161, 0, 1},
-            {3004, 162, 0, 1},
-            {3004, 163, 0, 1},
-            {3004, 164, 0, 1},
-            {3004, 165, 0, 1},
-            {3004, 166, 0, 1},
-            {3004, 167, 0, 1},
-            {3004, 168, 0, 1},
-            {3004, 169, 0, 1},
-            {3004, 170, 0, 1},
-            {3004, 171, 0, 1},
-            {3004, 172, 0, 1},
-            {3004, 173, 0, 1},
-            {2046, 174, 0, 1},
-            {17, 175, 0, 1},
-            {2049, 176, 0, 1},
-            {2049, 177, 0, 1},
-            {17, 178, 0, 1},
-            {8, 179, 0, 0},
-            {2048, 180, 0, 1},
-            {2008, 181, 0, 1},
-            {2008, 182, 0, 1},
-            {2008, 183, 0, 1},
-            {2008, 184, 0, 1},
-            {2012, 185, 0, 1},
-            {2012, 186, 0, 1},
-            {2012, 187, 0, 1},
-            {2012, 188, 0, 1},
-            {2012, 189, 0, 1},
-            {2011, 190, 0, 1},
-            {2011, 191, 0, 1},
-            {2012, 192, 0, 1},
-            {2011, 193, 0, 1},
-            {2011, 194, 0, 1},
-            {82, 195, 0, 0},
-            {2049, 196, 0, 1},
-            {2008, 197, 0, 1},
-            {2014, 198, 0, 1},
-            {2014, 199, 0, 1},
-            {2014, 200, 0, 1},
-            {2014, 201, 0, 1},
-            {2014, 202, 0, 1},
-            {2014, 203, 0, 1},
-            {2014, 204, 0, 1},
-            {2014, 205, 0, 1},
-            {2014, 206, 0, 1},
-            {2014, 207, 0, 1},
-            {2015, 208, 0, 1},
-            {2015, 209, 0, 1},
-            {2015, 210, 0, 1},
-            {2015, 211, 0, 1},
-            {2015, 212, 0, 1},
-            {2015, 213, 0, 1},
-            {2012, 214, 0, 1},
-            {2012, 215, 0, 1},
-            {2019, 216, 0, 0},
-            {3005, 217, 0, 1},
-            {3005, 218, 0, 1},
-            {3005, 219, 0, 1},
-            {3005, 220, 0, 1},
-            {3005, 221, 0, 1},
-            {71, 222, 0, 1},
-            {14, 223, 0, 1},
-            {2018, 224, 0, 0},
-            {2011, 225, 0, 1},
-            {2011, 226, 0, 1},
-            {2011, 227, 0, 1},
-            {2011, 228, 0, 1},
-            {2011, 229, 0, 1},
-            {2049, 230, 0, 1},
-            {2012, 231, 0, 1},
-            {2012, 232, 0, 1},
-            {2012, 233, 0, 1},
-            {2049, 234, 0, 1},
-            {8, 235, 0, 0},
-            {2048, 236, 0, 1},
-            {2013, 237, 0, 0},
-            {2025, 238, 0, 1},
-            {2048, 239, 0, 1},
-            {2049, 240, 0, 1},
-            {2023, 241, 0, 0},
-            {2048, 242, 0, 1},
-            {9, 243, 0, 1},
-            {9, 244, 0, 1},
-            {9, 245, 0, 1},
-            {9, 246, 0, 1},
-            {9, 247, 0, 1},
-            {66, 248, 0, 1},
-            {66, 249, 0, 1},
-            {67, 250, 0, 1},
-            {67, 251, 0, 1},
-            {2007, 252, 0, 1},
-            {2007, 253, 0, 1},
-            {2047, 254, 0, 1},
-            {2047, 255, 0, 1},
-            {3001, 256, 0, 1},
-            {3001, 257, 0, 1},
-            {3001, 258, 0, 1},
-            {3001, 259, 0, 1},
-            {3001, 260, 0, 1},
-            {9, 261, 0, 1},
-            {3001, 262, 0, 1},
-            {2023, 263, 0, 0},
-            {11, 264, 0, 1},
-            {11, 265, 0, 1},
-            {11, 266, 0, 1},
-            {11, 267, 0, 1},
-            {2012, 268, 0, 1},
-            {17, 269, 0, 1},
-            {2025, 270, 0, 1},
-            {2025, 271, 0, 1},
-            {67, 272, 0, 1},
-            {2, 273, 0, 1},
-            {3, 274, 0, 1},
-            {4, 275, 0, 1},
-        }},
-        {"Icon of Sin (MAP30)", {false, false, false}, {0, 0, 0}, 18, 95, {
-            {88, 0, 0, 1},
-            {89, 1, 0, 1},
-            {87, 2, 0, 1},
-            {87, 3, 0, 1},
-            {87, 4, 0, 1},
-            {87, 5, 0, 1},
-            {87, 6, 0, 1},
-            {87, 7, 0, 1},
-            {87, 8, 0, 1},
-            {87, 9, 0, 1},
-            {87, 10, 0, 1},
-            {87, 11, 0, 1},
-            {87, 12, 0, 1},
-            {87, 13, 0, 1},
-            {66, 14, 0, 1},
-            {2046, 15, 0, 1},
-            {2046, 16, 0, 1},
-            {2046, 17, 0, 1},
-            {2046, 18, 0, 1},
-            {2046, 19, 0, 1},
-            {2046, 20, 0, 1},
-            {2046, 21, 0, 1},
-            {2046, 22, 0, 1},
-            {2046, 23, 0, 1},
-            {2046, 24, 0, 1},
-            {2013, 25, 0, 0},
-            {2013, 26, 0, 0},
-            {87, 27, 0, 1},
-            {2013, 28, 0, 0},
-            {2022, 29, 0, 0},
-            {2022, 30, 0, 0},
-            {2022, 31, 0, 0},
-            {2022, 32, 0, 0},
-            {14, 33, 0, 1},
-            {73, 34, 0, 1},
-            {74, 35, 0, 1},
-            {1, 36, 0, 1},
-            {2, 37, 0, 1},
-            {3, 38, 0, 1},
-            {4, 39, 0, 1},
-            {2006, 40, 0, 0},
-            {2002, 41, 0, 0},
-            {2005, 42, 0, 0},
-            {2004, 43, 0, 0},
-            {2003, 44, 0, 0},
-            {2001, 45, 0, 0},
-            {82, 46, 0, 0},
-            {8, 47, 0, 0},
-            {17, 48, 0, 1},
-            {2048, 49, 0, 1},
-            {2048, 50, 0, 1},
-            {2048, 51, 0, 1},
-            {2048, 52, 0, 1},
-            {2046, 53, 0, 1},
-            {2046, 54, 0, 1},
-            {2046, 55, 0, 1},
-            {2046, 56, 0, 1},
-            {2046, 57, 0, 1},
-            {2046, 58, 0, 1},
-            {2046, 59, 0, 1},
-            {2046, 60, 0, 1},
-            {2049, 61, 0, 1},
-            {2049, 62, 0, 1},
-            {2049, 63, 0, 1},
-            {83, 64, 0, 0},
-            {83, 65, 0, 1},
-            {83, 66, 0, 1},
-            {83, 67, 0, 1},
-            {79, 68, 0, 1},
-            {81, 69, 0, 1},
-            {2049, 70, 0, 1},
-            {2048, 71, 0, 1},
-            {2048, 72, 0, 1},
-            {2048, 73, 0, 1},
-            {11, 74, 0, 1},
-            {11, 75, 0, 1},
-            {11, 76, 0, 1},
-            {11, 77, 0, 1},
-            {11, 78, 0, 1},
-            {2006, 79, 0, 1},
-            {2002, 80, 0, 1},
-            {2004, 81, 0, 1},
-            {2003, 82, 0, 1},
-            {2001, 83, 0, 1},
-            {82, 84, 0, 1},
-            {83, 85, 0, 0},
-            {8, 86, 0, 1},
-            {8, 87, 0, 1},
-            {17, 88, 0, 1},
-            {17, 89, 0, 1},
-            {17, 90, 0, 1},
-            {17, 91, 0, 1},
-            {2025, 92, 0, 1},
-            {2025, 93, 0, 1},
-            {2023, 94, 0, 0},
-        }},
-    },
-    {
-        {"Wolfenstein (MAP31)", {false, false, false}, {0, 0, 0}, 14, 317, {
-            {15, 0, 0, 1},
-            {12, 1, 0, 1},
-            {10, 2, 0, 1},
-            {22, 3, 0, 1},
-            {84, 4, 0, 1},
-            {2011, 5, 0, 1},
-            {2011, 6, 0, 1},
-            {2011, 7, 0, 1},
-            {24, 8, 0, 1},
-            {24, 9, 0, 1},
-            {19, 10, 0, 1},
-            {1, 11, 0, 1},
-            {2, 12, 0, 1},
-            {3, 13, 0, 1},
-            {4, 14, 0, 1},
-            {11, 15, 0, 1},
-            {24, 16, 0, 1},
-            {12, 17, 0, 1},
-            {84, 18, 0, 1},
-            {84, 19, 0, 1},
-            {84, 20, 0, 1},
-            {54, 21, 0, 1},
-            {54, 22, 0, 1},
-            {54, 23, 0, 1},
-            {54, 24, 0, 1},
-            {54, 25, 0, 1},
-            {54, 26, 0, 1},
-            {3002, 27, 0, 1},
-            {3002, 28, 0, 1},
-            {3002, 29, 0, 1},
-            {3002, 30, 0, 1},
-            {28, 31, 0, 1},
-            {2014, 32, 0, 1},
-            {2014, 33, 0, 1},
-            {2014, 34, 0, 1},
-            {2014, 35, 0, 1},
-            {3002, 36, 0, 1},
-            {3002, 37, 0, 1},
-            {3002, 38, 0, 1},
-            {3002, 39, 0, 1},
-            {3002, 40, 0, 1},
-            {3002, 41, 0, 1},
-            {3002, 42, 0, 1},
-            {3002, 43, 0, 1},
-            {3002, 44, 0, 1},
-            {84, 45, 0, 1},
-            {84, 46, 0, 1},
-            {84, 47, 0, 1},
-            {84, 48, 0, 1},
-            {84, 49, 0, 1},
-            {84, 50, 0, 1},
-            {84, 51, 0, 1},
-            {84, 52, 0, 1},
-            {3002, 53, 0, 1},
-            {3002, 54, 0, 1},
-            {3002, 55, 0, 1},
-            {3002, 56, 0, 1},
-            {3002, 57, 0, 1},
-            {3002, 58, 0, 1},
-            {3002, 59, 0, 1},
-            {3002, 60, 0, 1},
-            {2035, 61, 0, 1},
-            {2035, 62, 0, 1},
-            {2035, 63, 0, 1},
-            {2035, 64, 0, 1},
-            {24, 65, 0, 1},
-            {84, 66, 0, 1},
-            {84, 67, 0, 1},
-            {84, 68, 0, 1},
-            {84, 69, 0, 1},
-            {84, 70, 0, 1},
-            {84, 71, 0, 1},
-            {84, 72, 0, 1},
-            {84, 73, 0, 1},
-            {2011, 74, 0, 1},
-            {2011, 75, 0, 1},
-            {30, 76, 0, 1},
-            {30, 77, 0, 1},
-            {70, 78, 0, 1},
-            {70, 79, 0, 1},
-            {70, 80, 0, 1},
-            {2011, 81, 0, 1},
-            {84, 82, 0, 1},
-            {84, 83, 0, 1},
-            {84, 84, 0, 1},
-            {84, 85, 0, 1},
-            {84, 86, 0, 1},
-            {84, 87, 0, 1},
-            {84, 88, 0, 1},
-            {84, 89, 0, 1},
-            {84, 90, 0, 1},
-            {84, 91, 0, 1},
-            {84, 92, 0, 1},
-            {84, 93, 0, 1},
-            {84, 94, 0, 1},
-            {84, 95, 0, 1},
-            {84, 96, 0, 1},
-            {84, 97, 0, 1},
-            {25, 98, 0, 1},
-            {84, 99, 0, 1},
-            {84, 100, 0, 1},
-            {84, 101, 0, 1},
-            {84, 102, 0, 1},
-            {2012, 103, 0, 1},
-            {2012, 104, 0, 1},
-            {2010, 105, 0, 1},
-            {2010, 106, 0, 1},
-            {2048, 107, 0, 1},
-            {2010, 108, 0, 1},
-            {2010, 109, 0, 1},
-            {2003, 110, 0, 0},
-            {31, 111, 0, 1},
-            {31, 112, 0, 1},
-            {32, 113, 0, 1},
-            {32, 114, 0, 1},
-            {32, 115, 0, 1},
-            {32, 116, 0, 1},
-            {84, 117, 0, 1},
-            {84, 118, 0, 1},
-            {84, 119, 0, 1},
-            {84, 120, 0, 1},
-            {84, 121, 0, 1},
-            {84, 122, 0, 1},
-            {84, 123, 0, 1},
-            {84, 124, 0, 1},
-            {84, 125, 0, 1},
-            {84, 126, 0, 1},
-            {84, 127, 0, 1},
-            {84, 128, 0, 1},
-            {84, 129, 0, 1},
-            {84, 130, 0, 1},
-            {84, 131, 0, 1},
-            {84, 132, 0, 1},
-            {2008, 133, 0, 1},
-            {2008, 134, 0, 1},
-            {2008, 135, 0, 1},
-            {2008, 136, 0, 1},
-            {2008, 137, 0, 1},
-            {2008, 138, 0, 1},
-            {2001, 139, 0, 0},
-            {84, 140, 0, 1},
-            {84, 141, 0, 1},
-            {84, 142, 0, 1},
-            {84, 143, 0, 1},
-            {84, 144, 0, 1},
-            {84, 145, 0, 1},
-            {84, 146, 0, 1},
-            {84, 147, 0, 1},
-            {2007, 148, 0, 1},
-            {2007, 149, 0, 1},
-            {2007, 150, 0, 1},
-            {2007, 151, 0, 1},
-            {2007, 152, 0, 1},
-            {2007, 153, 0, 1},
-            {2007, 154, 0, 1},
-            {2007, 155, 0, 1},
-            {2015, 156, 0, 1},
-            {2015, 157, 0, 1},
-            {2015, 158, 0, 1},
-            {2015, 159, 0, 1},
-            {2015, 160, 0, 1},
-            {2015, 161, 0, 1},
-            {2015, 162, 0, 1},
-            {2015, 163, 0, 1},
-            {2015, 164, 0, 1},
-            {2015, 165, 0, 1},
-            {2015, 166, 0, 1},
-            {2015, 167, 0, 1},
-            {2015, 168, 0, 1},
-            {2015, 169, 0, 1},
-            {2015, 170, 0, 1},
-            {2015, 171, 0, 1},
-            {2015, 172, 0, 1},
-            {2015, 173, 0, 1},
-            {2015, 174, 0, 1},
-            {2015, 175, 0, 1},
-            {2015, 176, 0, 1},
-            {2015, 177, 0, 1},
-            {2015, 178, 0, 1},
-            {2015, 179, 0, 1},
-            {2015, 180, 0, 1},
-            {2015, 181, 0, 1},
-            {2015, 182, 0, 1},
-            {2015, 183, 0, 1},
-            {84, 184, 0, 1},
-            {84, 185, 0, 1},
-            {84, 186, 0, 1},
-            {84, 187, 0, 1},
-            {84, 188, 0, 1},
-            {84, 189, 0, 1},
-            {84, 190, 0, 1},
-            {84, 191, 0, 1},
-            {84, 192, 0, 1},
-            {84, 193, 0, 1},
-            {84, 194, 0, 1},
-            {84, 195, 0, 1},
-            {84, 196, 0, 1},
-            {84, 197, 0, 1},
-            {84, 198, 0, 1},
-            {84, 199, 0, 1},
-            {84, 200, 0, 1},
-            {84, 201, 0, 1},
-            {84, 202, 0, 1},
-            {84, 203, 0, 1},
-            {2015, 204, 0, 1},
-            {2015, 205, 0, 1},
-            {2015, 206, 0, 1},
-            {2015, 207, 0, 1},
-            {2015, 208, 0, 1},
-            {2015, 209, 0, 1},
-            {2015, 210, 0, 1},
-            {2015, 211, 0, 1},
-            {2015, 212, 0, 1},
-            {2015, 213, 0, 1},
-            {2015, 214, 0, 1},
-            {2015, 215, 0, 1},
-            {2015, 216, 0, 1},
-            {2015, 217, 0, 1},
-            {2015, 218, 0, 1},
-            {2015, 219, 0, 1},
-            {2015, 220, 0, 1},
-            {2015, 221, 0, 1},
-            {2015, 222, 0, 1},
-            {2015, 223, 0, 1},
-            {2015, 224, 0, 1},
-            {2015, 225, 0, 1},
-            {2015, 226, 0, 1},
-            {2015, 227, 0, 1},
-            {2015, 228, 0, 1},
-            {2015, 229, 0, 1},
-            {2015, 230, 0, 1},
-            {2015, 231, 0, 1},
-            {43, 232, 0, 1},
-            {43, 233, 0, 1},
-            {45, 234, 0, 1},
-            {45, 235, 0, 1},
-            {45, 236, 0, 1},
-            {45, 237, 0, 1},
-            {30, 238, 0, 1},
-            {36, 239, 0, 1},
-            {36, 240, 0, 1},
-            {84, 241, 0, 1},
-            {84, 242, 0, 1},
-            {84, 243, 0, 1},
-            {84, 244, 0, 1},
-            {54, 245, 0, 1},
-            {54, 246, 0, 1},
-            {54, 247, 0, 1},
-            {54, 248, 0, 1},
-            {54, 249, 0, 1},
-            {84, 250, 0, 1},
-            {84, 251, 0, 1},
-            {84, 252, 0, 1},
-            {84, 253, 0, 1},
-            {84, 254, 0, 1},
-            {84, 255, 0, 1},
-            {84, 256, 0, 1},
-            {84, 257, 0, 1},
-            {84, 258, 0, 1},
-            {84, 259, 0, 1},
-            {84, 260, 0, 1},
-            {84, 261, 0, 1},
-            {2011, 262, 0, 1},
-            {2023, 263, 0, 0},
-            {84, 264, 0, 1},
-            {84, 265, 0, 1},
-            {84, 266, 0, 1},
-            {84, 267, 0, 1},
-            {2011, 268, 0, 1},
-            {2010, 269, 0, 1},
-            {84, 270, 0, 1},
-            {84, 271, 0, 1},
-            {84, 272, 0, 1},
-            {84, 273, 0, 1},
-            {2011, 274, 0, 1},
-            {2035, 275, 0, 1},
-            {2012, 276, 0, 1},
-            {2012, 277, 0, 1},
-            {2013, 278, 0, 0},
-            {84, 279, 0, 1},
-            {84, 280, 0, 1},
-            {84, 281, 0, 1},
-            {84, 282, 0, 1},
-            {84, 283, 0, 1},
-            {84, 284, 0, 1},
-            {84, 285, 0, 1},
-            {84, 286, 0, 1},
-            {84, 287, 0, 1},
-            {84, 288, 0, 1},
-            {84, 289, 0, 1},
-            {84, 290, 0, 1},
-            {84, 291, 0, 1},
-            {84, 292, 0, 1},
-            {84, 293, 0, 1},
-            {84, 294, 0, 1},
-            {84, 295, 0, 1},
-            {84, 296, 0, 1},
-            {84, 297, 0, 1},
-            {84, 298, 0, 1},
-            {11, 299, 0, 1},
-            {11, 300, 0, 1},
-            {11, 301, 0, 1},
-            {11, 302, 0, 1},
-            {63, 303, 0, 1},
-            {37, 304, 0, 1},
-            {2002, 305, 0, 0},
-            {11, 306, 0, 1},
-            {11, 307, 0, 1},
-            {82, 308, 0, 0},
-            {2024, 309, 0, 0},
-            {83, 310, 0, 0},
-            {8, 311, 0, 0},
-            {8, 312, 0, 0},
-            {8, 313, 0, 0},
-            {8, 314, 0, 0},
-            {2006, 315, 0, 0},
-            {2004, 316, 0, 0},
-        }},
-        {"Grosse (MAP32)", {false, false, false}, {0, 0, 0}, 10, 111, {
-            {54, 0, 0, 1},
-            {54, 1, 0, 1},
-            {44, 2, 0, 1},
-            {45, 3, 0, 1},
-            {45, 4, 0, 1},
-            {45, 5, 0, 1},
-            {44, 6, 0, 1},
-            {44, 7, 0, 1},
-            {45, 8, 0, 1},
-            {45, 9, 0, 1},
-            {45, 10, 0, 1},
-            {44, 11, 0, 1},
-            {30, 12, 0, 1},
-            {30, 13, 0, 1},
-            {30, 14, 0, 1},
-            {30, 15, 0, 1},
-            {30, 16, 0, 1},
-            {30, 17, 0, 1},
-            {77, 18, 0, 1},
-            {74, 19, 0, 1},
-            {73, 20, 0, 1},
-            {77, 21, 0, 1},
-            {74, 22, 0, 1},
-            {75, 23, 0, 1},
-            {72, 24, 0, 1},
-            {50, 25, 0, 1},
-            {76, 26, 0, 1},
-            {2012, 27, 0, 1},
-            {2012, 28, 0, 1},
-            {2012, 29, 0, 1},
-            {2012, 30, 0, 1},
-            {2012, 31, 0, 1},
-            {2012, 32, 0, 1},
-            {2004, 33, 0, 0},
-            {2047, 34, 0, 1},
-            {2047, 35, 0, 1},
-            {2047, 36, 0, 1},
-            {2047, 37, 0, 1},
-            {2047, 38, 0, 1},
-            {2047, 39, 0, 1},
-            {2047, 40, 0, 1},
-            {2047, 41, 0, 1},
-            {2047, 42, 0, 1},
-            {2047, 43, 0, 1},
-            {2047, 44, 0, 1},
-            {2047, 45, 0, 1},
-            {2047, 46, 0, 1},
-            {2047, 47, 0, 1},
-            {2047, 48, 0, 1},
-            {2047, 49, 0, 1},
-            {2047, 50, 0, 1},
-            {2047, 51, 0, 1},
-            {2047, 52, 0, 1},
-            {2047, 53, 0, 1},
-            {2047, 54, 0, 1},
-            {2047, 55, 0, 1},
-            {2047, 56, 0, 1},
-            {2003, 57, 0, 0},
-            {2046, 58, 0, 1},
-            {2046, 59, 0, 1},
-            {16, 60, 0, 1},
-            {1, 61, 0, 1},
-            {2, 62, 0, 1},
-            {3, 63, 0, 1},
-            {4, 64, 0, 1},
-            {11, 65, 0, 1},
-            {11, 66, 0, 1},
-            {11, 67, 0, 1},
-            {11, 68, 0, 1},
-            {11, 69, 0, 1},
-            {2022, 70, 0, 0},
-            {72, 71, 0, 1},
-            {72, 72, 0, 1},
-            {72, 73, 0, 1},
-            {82, 74, 0, 0},
-            {2006, 75, 0, 0},
-            {2049, 76, 0, 1},
-            {2049, 77, 0, 1},
-            {83, 78, 0, 0},
-            {2002, 79, 0, 0},
-            {2002, 80, 0, 0},
-            {2002, 81, 0, 0},
-            {2023, 82, 0, 0},
-            {84, 83, 0, 1},
-            {84, 84, 0, 1},
-            {84, 85, 0, 1},
-            {84, 86, 0, 1},
-            {84, 87, 0, 1},
-            {84, 88, 0, 1},
-            {84, 89, 0, 1},
-            {84, 90, 0, 1},
-            {84, 91, 0, 1},
-            {84, 92, 0, 1},
-            {84, 93, 0, 1},
-            {84, 94, 0, 1},
-            {84, 95, 0, 1},
-            {84, 96, 0, 1},
-            {84, 97, 0, 1},
-            {84, 98, 0, 1},
-            {84, 99, 0, 1},
-            {84, 100, 0, 1},
-            {84, 101, 0, 1},
-            {84, 102, 0, 1},
-            {84, 103, 0, 1},
-            {84, 104, 0, 1},
-            {84, 105, 0, 1},
-            {84, 106, 0, 1},
-            {84, 107, 0, 1},
-            {84, 108, 0, 1},
-            {84, 109, 0, 1},
-            {84, 110, 0, 1},
-        }},
-    },
+    {1, 0, 0, 1},
+    {2, 1, 0, 1},
+    {3, 2, 0, 1},
+    {4, 3, 0, 1},
+    {3001, 4, 0, 1},
+    {3001, 5, 0, 1},
+    {3001, 6, 0, 1},
+    {3001, 7, 0, 1},
+    {3001, 8, 0, 1},
+    {3001, 9, 0, 1},
+    {3001, 10, 0, 1},
+    {3001, 11, 0, 1},
+    {3001, 12, 0, 1},
+    {3001, 13, 0, 1},
+    {2001, 14, 0, 0},
+    {2049, 15, 0, 1},
+    {3001, 16, 0, 1},
+    {3001, 17, 0, 1},
+    {3001, 18, 0, 1},
+    {3001, 19, 0, 1},
+    {3001, 20, 0, 1},
+    {3001, 21, 0, 1},
+    {3001, 22, 0, 1},
+    {3001, 23, 0, 1},
+    {3001, 24, 0, 1},
+    {3001, 25, 0, 1},
+    {3001, 26, 0, 1},
+    {3001, 27, 0, 1},
+    {3001, 28, 0, 1},
+    {3001, 29, 0, 1},
+    {3001, 30, 0, 1},
+    {3001, 31, 0, 1},
+    {3001, 32, 0, 1},
+    {2012, 33, 0, 1},
+    {2049, 34, 0, 1},
+    {2023, 35, 0, 0},
+    {2049, 36, 0, 1},
+    {2012, 37, 0, 1},
+    {2002, 38, 0, 0},
+    {2007, 39, 0, 1},
+    {3001, 40, 0, 1},
+    {3001, 41, 0, 1},
+    {3001, 42, 0, 1},
+    {3005, 43, 0, 1},
+    {3003, 44, 0, 1},
+    {3001, 45, 0, 1},
+    {3001, 46, 0, 1},
+    {68, 47, 0, 1},
+    {3001, 48, 0, 1},
+    {3001, 49, 0, 1},
+    {3001, 50, 0, 1},
+    {3001, 51, 0, 1},
+    {2013, 52, 0, 0},
+    {14, 53, 0, 1},
+    {5, 54, 0, 0},
+    {67, 55, 0, 1},
+    {9, 56, 0, 1},
+    {9, 57, 0, 1},
+    {9, 58, 0, 1},
+    {9, 59, 0, 1},
+    {9, 60, 0, 1},
+    {9, 61, 0, 1},
+    {9, 62, 0, 1},
+    {2018, 63, 0, 0},
+    {2048, 64, 0, 1},
+    {68, 65, 0, 1},
+    {68, 66, 0, 1},
+    {68, 67, 0, 1},
+    {68, 68, 0, 1},
+    {68, 69, 0, 1},
+    {8, 70, 0, 0},
+    {2012, 71, 0, 1},
+    {9, 72, 0, 1},
+    {9, 73, 0, 1},
+    {9, 74, 0, 1},
+    {9, 75, 0, 1},
+    {2011, 76, 0, 1},
+    {2011, 77, 0, 1},
+    {2011, 78, 0, 1},
+    {2011, 79, 0, 1},
+    {2048, 80, 0, 1},
+    {2007, 81, 0, 1},
+    {2007, 82, 0, 1},
+    {2013, 83, 0, 0},
+    {67, 84, 0, 1},
+    {14, 85, 0, 1},
+    {2012, 86, 0, 1},
+    {2012, 87, 0, 1},
+    {2012, 88, 0, 1},
+    {2012, 89, 0, 1},
+    {2012, 90, 0, 1},
+    {9, 91, 0, 1},
+    {2018, 92, 0, 0},
+    {2024, 93, 0, 0},
+    {9, 94, 0, 1},
+    {9, 95, 0, 1},
+    {9, 96, 0, 1},
+    {17, 97, 0, 1},
+    {3006, 98, 0, 1},
+    {3006, 99, 0, 1},
+    {3006, 100, 0, 1},
+    {3006, 101, 0, 1},
+    {3006, 102, 0, 1},
+    {3006, 103, 0, 1},
+    {3006, 104, 0, 1},
+    {3006, 105, 0, 1},
+    {3006, 106, 0, 1},
+    {2023, 107, 0, 0},
+    {2048, 108, 0, 1},
+    {2047, 109, 0, 1},
+    {2012, 110, 0, 1},
+    {2048, 111, 0, 1},
+    {67, 112, 0, 1},
+    {2007, 113, 0, 1},
+    {2008, 114, 0, 1},
+    {67, 115, 0, 1},
+    {2049, 116, 0, 1},
+    {67, 117, 0, 1},
+    {67, 118, 0, 1},
+    {67, 119, 0, 1},
+    {67, 120, 0, 1},
+    {67, 121, 0, 1},
+    {65, 122, 0, 1},
+    {6, 123, 0, 0},
+    {2025, 124, 0, 1},
+    {3005, 125, 0, 1},
+    {3005, 126, 0, 1},
+    {3005, 127, 0, 1},
+    {65, 128, 0, 1},
+    {65, 129, 0, 1},
+    {65, 130, 0, 1},
+    {65, 131, 0, 1},
+    {65, 132, 0, 1},
+    {65, 133, 0, 1},
+    {65, 134, 0, 1},
+    {2006, 135, 0, 0},
+    {65, 136, 0, 1},
+    {3001, 137, 0, 1},
+    {3001, 138, 0, 1},
+    {3001, 139, 0, 1},
+    {3001, 140, 0, 1},
+    {3001, 141, 0, 1},
+    {3001, 142, 0, 1},
+    {2007, 143, 0, 1},
+    {3001, 144, 0, 1},
+    {3001, 145, 0, 1},
+    {2048, 146, 0, 1},
+    {45, 147, 0, 1},
+    {45, 148, 0, 1},
+    {3005, 149, 0, 1},
+    {3005, 150, 0, 1},
+    {3005, 151, 0, 1},
+    {3005, 152, 0, 1},
+    {3005, 153, 0, 1},
+    {3005, 154, 0, 1},
+    {3005, 155, 0, 1},
+    {3005, 156, 0, 1},
+    {3005, 157, 0, 1},
+    {3005, 158, 0, 1},
+    {3005, 159, 0, 1},
+    {3005, 160, 0, 1},
+    {2003, 161, 0, 1},
+    {2004, 162, 0, 1},
+    {2007, 163, 0, 1},
+    {2007, 164, 0, 1},
+    {2007, 165, 0, 1},
+    {2007, 166, 0, 1},
+    {2008, 167, 0, 1},
+    {2008, 168, 0, 1},
+    {2049, 169, 0, 1},
+    {2012, 170, 0, 1},
+    {2025, 171, 0, 1},
+    {2048, 172, 0, 1},
+    {2049, 173, 0, 1},
+    {2047, 174, 0, 1},
+    {2047, 175, 0, 1},
+    {2047, 176, 0, 1},
+    {2047, 177, 0, 1},
+    {2047, 178, 0, 1},
+    {2047, 179, 0, 1},
+    {2047, 180, 0, 1},
+    {2047, 181, 0, 1},
+    {2047, 182, 0, 1},
+    {11, 183, 0, 1},
+    {11, 184, 0, 1},
+    {11, 185, 0, 1},
+    {11, 186, 0, 1},
+    {11, 187, 0, 1},
+    {11, 188, 0, 1},
+    {2023, 189, 0, 0},
+    {2049, 190, 0, 1},
+    {17, 191, 0, 1},
+    {82, 192, 0, 0},
+    {17, 193, 0, 1},
+    {7, 194, 0, 1},
 };
 
 
-const std::map<int, std::string> ap_doom2_type_sprites = {
+static const ap_thing_info_t ap_doom2_thing_infos_e2m2[] = 
+{
+    {1, 0, 0, 1},
+    {2, 1, 0, 1},
+    {3, 2, 0, 1},
+    {4, 3, 0, 1},
+    {2003, 4, 0, 0},
+    {2010, 5, 0, 1},
+    {2010, 6, 0, 1},
+    {2010, 7, 0, 1},
+    {2010, 8, 0, 1},
+    {2010, 9, 0, 1},
+    {2010, 10, 0, 1},
+    {3002, 11, 0, 1},
+    {3002, 12, 0, 1},
+    {3002, 13, 0, 1},
+    {3002, 14, 0, 1},
+    {3002, 15, 0, 1},
+    {3002, 16, 0, 1},
+    {3002, 17, 0, 1},
+    {3002, 18, 0, 1},
+    {14, 19, 0, 1},
+    {14, 20, 0, 1},
+    {14, 21, 0, 1},
+    {14, 22, 0, 1},
+    {14, 23, 0, 1},
+    {14, 24, 0, 1},
+    {14, 25, 0, 1},
+    {14, 26, 0, 1},
+    {3005, 27, 0, 1},
+    {3002, 28, 0, 1},
+    {3001, 29, 0, 1},
+    {3001, 30, 0, 1},
+    {3001, 31, 0, 1},
+    {3001, 32, 0, 1},
+    {3001, 33, 0, 1},
+    {3002, 34, 0, 1},
+    {3001, 35, 0, 1},
+    {3002, 36, 0, 1},
+    {3001, 37, 0, 1},
+    {3001, 38, 0, 1},
+    {3001, 39, 0, 1},
+    {3001, 40, 0, 1},
+    {3001, 41, 0, 1},
+    {2001, 42, 0, 0},
+    {2008, 43, 0, 1},
+    {2008, 44, 0, 1},
+    {2008, 45, 0, 1},
+    {2008, 46, 0, 1},
+    {2011, 47, 0, 1},
+    {2014, 48, 0, 1},
+    {2015, 49, 0, 1},
+    {2015, 50, 0, 1},
+    {2015, 51, 0, 1},
+    {2014, 52, 0, 1},
+    {2014, 53, 0, 1},
+    {2014, 54, 0, 1},
+    {2014, 55, 0, 1},
+    {2014, 56, 0, 1},
+    {2015, 57, 0, 1},
+    {2011, 58, 0, 1},
+    {2011, 59, 0, 1},
+    {2012, 60, 0, 1},
+    {2008, 61, 0, 1},
+    {3001, 62, 0, 1},
+    {3001, 63, 0, 1},
+    {3001, 64, 0, 1},
+    {3001, 65, 0, 1},
+    {3001, 66, 0, 1},
+    {2049, 67, 0, 1},
+    {3001, 68, 0, 1},
+    {3001, 69, 0, 1},
+    {3001, 70, 0, 1},
+    {3001, 71, 0, 1},
+    {14, 72, 0, 1},
+    {2013, 73, 0, 0},
+    {3001, 74, 0, 1},
+    {3001, 75, 0, 1},
+    {3001, 76, 0, 1},
+    {3001, 77, 0, 1},
+    {2007, 78, 0, 1},
+    {3001, 79, 0, 1},
+    {3001, 80, 0, 1},
+    {2049, 81, 0, 1},
+    {3001, 82, 0, 1},
+    {2011, 83, 0, 1},
+    {2011, 84, 0, 1},
+    {2011, 85, 0, 1},
+    {2011, 86, 0, 1},
+    {2007, 87, 0, 1},
+    {2007, 88, 0, 1},
+    {2007, 89, 0, 1},
+    {2007, 90, 0, 1},
+    {2007, 91, 0, 1},
+    {2008, 92, 0, 1},
+    {2008, 93, 0, 1},
+    {2008, 94, 0, 1},
+    {2008, 95, 0, 1},
+    {2008, 96, 0, 1},
+    {2010, 97, 0, 1},
+    {2010, 98, 0, 1},
+    {2014, 99, 0, 1},
+    {2014, 100, 0, 1},
+    {2014, 101, 0, 1},
+    {2014, 102, 0, 1},
+    {2014, 103, 0, 1},
+    {2014, 104, 0, 1},
+    {2014, 105, 0, 1},
+    {2014, 106, 0, 1},
+    {2014, 107, 0, 1},
+    {2015, 108, 0, 1},
+    {2015, 109, 0, 1},
+    {2014, 110, 0, 1},
+    {2014, 111, 0, 1},
+    {2015, 112, 0, 1},
+    {2015, 113, 0, 1},
+    {2015, 114, 0, 1},
+    {2015, 115, 0, 1},
+    {2015, 116, 0, 1},
+    {2015, 117, 0, 1},
+    {2015, 118, 0, 1},
+    {14, 119, 0, 1},
+    {3005, 120, 0, 1},
+    {3001, 121, 0, 1},
+    {3001, 122, 0, 1},
+    {3001, 123, 0, 1},
+    {3001, 124, 0, 1},
+    {2049, 125, 0, 1},
+    {67, 126, 0, 1},
+    {3005, 127, 0, 1},
+    {3005, 128, 0, 1},
+    {3005, 129, 0, 1},
+    {3005, 130, 0, 1},
+    {2023, 131, 0, 0},
+    {3006, 132, 0, 1},
+    {3006, 133, 0, 1},
+    {3006, 134, 0, 1},
+    {3006, 135, 0, 1},
+    {3006, 136, 0, 1},
+    {3006, 137, 0, 1},
+    {2014, 138, 0, 1},
+    {2014, 139, 0, 1},
+    {2007, 140, 0, 1},
+    {2015, 141, 0, 1},
+    {2014, 142, 0, 1},
+    {2014, 143, 0, 1},
+    {2014, 144, 0, 1},
+    {2014, 145, 0, 1},
+    {2014, 146, 0, 1},
+    {2014, 147, 0, 1},
+    {2015, 148, 0, 1},
+    {2015, 149, 0, 1},
+    {2015, 150, 0, 1},
+    {2015, 151, 0, 1},
+    {2015, 152, 0, 1},
+    {2015, 153, 0, 1},
+    {2008, 154, 0, 1},
+    {2007, 155, 0, 1},
+    {2010, 156, 0, 1},
+    {2047, 157, 0, 1},
+    {2019, 158, 0, 0},
+    {3002, 159, 0, 1},
+    {3001, 160, 0, 1},
+    {3001, 161, 0, 1},
+    {3001, 162, 0, 1},
+    {3001, 163, 0, 1},
+    {3001, 164, 0, 1},
+    {3001, 165, 0, 1},
+    {3002, 166, 0, 1},
+    {3002, 167, 0, 1},
+    {2012, 168, 0, 1},
+    {2012, 169, 0, 1},
+    {2008, 170, 0, 1},
+    {2008, 171, 0, 1},
+    {2007, 172, 0, 1},
+    {2008, 173, 0, 1},
+    {45, 174, 0, 1},
+    {45, 175, 0, 1},
+    {3001, 176, 0, 1},
+    {3001, 177, 0, 1},
+    {3001, 178, 0, 1},
+    {3001, 179, 0, 1},
+    {3001, 180, 0, 1},
+    {3001, 181, 0, 1},
+    {3001, 182, 0, 1},
+    {2002, 183, 0, 0},
+    {2048, 184, 0, 1},
+    {3001, 185, 0, 1},
+    {3001, 186, 0, 1},
+    {3001, 187, 0, 1},
+    {3001, 188, 0, 1},
+    {3001, 189, 0, 1},
+    {3001, 190, 0, 1},
+    {3001, 191, 0, 1},
+    {3001, 192, 0, 1},
+    {3001, 193, 0, 1},
+    {3001, 194, 0, 1},
+    {5, 195, 0, 0},
+    {14, 196, 0, 1},
+    {2046, 197, 0, 1},
+    {2048, 198, 0, 1},
+    {3001, 199, 0, 1},
+    {3001, 200, 0, 1},
+    {6, 201, 0, 0},
+    {2046, 202, 0, 1},
+    {2049, 203, 0, 1},
+    {2049, 204, 0, 1},
+    {2047, 205, 0, 1},
+    {2047, 206, 0, 1},
+    {2023, 207, 0, 0},
+    {3001, 208, 0, 1},
+    {3001, 209, 0, 1},
+    {3001, 210, 0, 1},
+    {3001, 211, 0, 1},
+    {3001, 212, 0, 1},
+    {3001, 213, 0, 1},
+    {3001, 214, 0, 1},
+    {3001, 215, 0, 1},
+    {3001, 216, 0, 1},
+    {3001, 217, 0, 1},
+    {3001, 218, 0, 1},
+    {3001, 219, 0, 1},
+    {3001, 220, 0, 1},
+    {3001, 221, 0, 1},
+    {3001, 222, 0, 1},
+    {3001, 223, 0, 1},
+    {58, 224, 0, 1},
+    {58, 225, 0, 1},
+    {2046, 226, 0, 1},
+    {2046, 227, 0, 1},
+    {2048, 228, 0, 1},
+    {2049, 229, 0, 1},
+    {3005, 230, 0, 1},
+    {2004, 231, 0, 0},
+    {2014, 232, 0, 1},
+    {2015, 233, 0, 1},
+    {2015, 234, 0, 1},
+    {2015, 235, 0, 1},
+    {2014, 236, 0, 1},
+    {2014, 237, 0, 1},
+    {2011, 238, 0, 1},
+    {2011, 239, 0, 1},
+    {3006, 240, 0, 1},
+    {3006, 241, 0, 1},
+    {3006, 242, 0, 1},
+    {3006, 243, 0, 1},
+    {3006, 244, 0, 1},
+    {66, 245, 0, 1},
+    {66, 246, 0, 1},
+    {66, 247, 0, 1},
+    {66, 248, 0, 1},
+    {2024, 249, 0, 0},
+    {8, 250, 0, 0},
+    {3006, 251, 0, 1},
+    {3006, 252, 0, 1},
+    {3006, 253, 0, 1},
+    {3006, 254, 0, 1},
+    {3006, 255, 0, 1},
+    {14, 256, 0, 1},
+    {2005, 257, 0, 0},
+    {2006, 258, 0, 0},
+    {2049, 259, 0, 1},
+    {2049, 260, 0, 1},
+    {2049, 261, 0, 1},
+    {2049, 262, 0, 1},
+    {2049, 263, 0, 1},
+    {2048, 264, 0, 1},
+    {2048, 265, 0, 1},
+    {2048, 266, 0, 1},
+    {2048, 267, 0, 1},
+    {2048, 268, 0, 1},
+    {2022, 269, 0, 0},
+    {14, 270, 0, 1},
+    {3005, 271, 0, 1},
+    {3005, 272, 0, 1},
+    {3002, 273, 0, 1},
+    {2011, 274, 0, 1},
+    {2011, 275, 0, 1},
+    {2011, 276, 0, 1},
+    {2008, 277, 0, 1},
+    {2007, 278, 0, 1},
+    {2007, 279, 0, 1},
+    {2022, 280, 0, 0},
+    {2024, 281, 0, 0},
+    {2024, 282, 0, 0},
+    {13, 283, 0, 0},
+    {11, 284, 0, 1},
+    {11, 285, 0, 1},
+    {11, 286, 0, 1},
+    {11, 287, 0, 1},
+    {11, 288, 0, 1},
+    {11, 289, 0, 1},
+    {11, 290, 0, 1},
+    {11, 291, 0, 1},
+    {14, 292, 0, 1},
+    {2012, 293, 0, 1},
+    {2007, 294, 0, 1},
+    {2008, 295, 0, 1},
+    {2023, 296, 0, 0},
+    {14, 297, 0, 1},
+    {2026, 298, 0, 0},
+    {3005, 299, 0, 1},
+    {82, 300, 0, 1},
+    {2049, 301, 0, 1},
+    {2046, 302, 0, 1},
+    {17, 303, 0, 1},
+    {68, 304, 0, 1},
+    {68, 305, 0, 1},
+    {68, 306, 0, 1},
+    {68, 307, 0, 1},
+    {68, 308, 0, 1},
+    {68, 309, 0, 1},
+    {2048, 310, 0, 1},
+    {16, 311, 0, 1},
+};
+
+
+static const ap_thing_info_t ap_doom2_thing_infos_e2m3[] = 
+{
+    {1, 0, 0, 1},
+    {2, 1, 0, 1},
+    {3, 2, 0, 1},
+    {4, 3, 0, 1},
+    {57, 4, 0, 1},
+    {57, 5, 0, 1},
+    {57, 6, 0, 1},
+    {2046, 7, 0, 1},
+    {11, 8, 0, 1},
+    {11, 9, 0, 1},
+    {11, 10, 0, 1},
+    {11, 11, 0, 1},
+    {2049, 12, 0, 1},
+    {2001, 13, 0, 0},
+    {2046, 14, 0, 1},
+    {11, 15, 0, 1},
+    {2013, 16, 0, 0},
+    {45, 17, 0, 1},
+    {45, 18, 0, 1},
+    {45, 19, 0, 1},
+    {45, 20, 0, 1},
+    {11, 21, 0, 1},
+    {2019, 22, 0, 0},
+    {17, 23, 0, 1},
+    {45, 24, 0, 1},
+    {45, 25, 0, 1},
+    {45, 26, 0, 1},
+    {45, 27, 0, 1},
+    {45, 28, 0, 1},
+    {45, 29, 0, 1},
+    {45, 30, 0, 1},
+    {45, 31, 0, 1},
+    {46, 32, 0, 1},
+    {46, 33, 0, 1},
+    {46, 34, 0, 1},
+    {46, 35, 0, 1},
+    {45, 36, 0, 1},
+    {45, 37, 0, 1},
+    {58, 38, 0, 1},
+    {65, 39, 0, 1},
+    {9, 40, 0, 1},
+    {9, 41, 0, 1},
+    {3004, 42, 0, 1},
+    {3004, 43, 0, 1},
+    {3004, 44, 0, 1},
+    {3004, 45, 0, 1},
+    {3001, 46, 0, 1},
+    {3001, 47, 0, 1},
+    {3001, 48, 0, 1},
+    {3001, 49, 0, 1},
+    {9, 50, 0, 1},
+    {9, 51, 0, 1},
+    {9, 52, 0, 1},
+    {9, 53, 0, 1},
+    {9, 54, 0, 1},
+    {3001, 55, 0, 1},
+    {3001, 56, 0, 1},
+    {65, 57, 0, 1},
+    {9, 58, 0, 1},
+    {9, 59, 0, 1},
+    {65, 60, 0, 1},
+    {65, 61, 0, 1},
+    {9, 62, 0, 1},
+    {3001, 63, 0, 1},
+    {3001, 64, 0, 1},
+    {3001, 65, 0, 1},
+    {3001, 66, 0, 1},
+    {3001, 67, 0, 1},
+    {3001, 68, 0, 1},
+    {3001, 69, 0, 1},
+    {9, 70, 0, 1},
+    {65, 71, 0, 1},
+    {65, 72, 0, 1},
+    {3001, 73, 0, 1},
+    {3001, 74, 0, 1},
+    {3004, 75, 0, 1},
+    {3004, 76, 0, 1},
+    {65, 77, 0, 1},
+    {2023, 78, 0, 0},
+    {2012, 79, 0, 1},
+    {2002, 80, 0, 0},
+    {2004, 81, 0, 0},
+    {9, 82, 0, 1},
+    {9, 83, 0, 1},
+    {9, 84, 0, 1},
+    {9, 85, 0, 1},
+    {9, 86, 0, 1},
+    {65, 87, 0, 1},
+    {65, 88, 0, 1},
+    {9, 89, 0, 1},
+    {9, 90, 0, 1},
+    {68, 91, 0, 1},
+    {58, 92, 0, 1},
+    {2012, 93, 0, 1},
+    {2012, 94, 0, 1},
+    {2012, 95, 0, 1},
+    {2012, 96, 0, 1},
+    {2048, 97, 0, 1},
+    {3006, 98, 0, 1},
+    {3006, 99, 0, 1},
+    {3006, 100, 0, 1},
+    {3006, 101, 0, 1},
+    {3006, 102, 0, 1},
+    {3006, 103, 0, 1},
+    {9, 104, 0, 1},
+    {9, 105, 0, 1},
+    {9, 106, 0, 1},
+    {3001, 107, 0, 1},
+    {3001, 108, 0, 1},
+    {3001, 109, 0, 1},
+    {3001, 110, 0, 1},
+    {3001, 111, 0, 1},
+    {58, 112, 0, 1},
+    {9, 113, 0, 1},
+    {9, 114, 0, 1},
+    {9, 115, 0, 1},
+    {2012, 116, 0, 1},
+    {58, 117, 0, 1},
+    {2011, 118, 0, 1},
+    {38, 119, 0, 0},
+    {9, 120, 0, 1},
+    {9, 121, 0, 1},
+    {2046, 122, 0, 1},
+    {2003, 123, 0, 0},
+    {2006, 124, 0, 1},
+    {2012, 125, 0, 1},
+    {66, 126, 0, 1},
+    {65, 127, 0, 1},
+    {44, 128, 0, 1},
+    {44, 129, 0, 1},
+    {40, 130, 0, 0},
+    {2012, 131, 0, 1},
+    {2011, 132, 0, 1},
+    {2011, 133, 0, 1},
+    {2011, 134, 0, 1},
+    {11, 135, 0, 1},
+    {2001, 136, 0, 1},
+    {2019, 137, 0, 1},
+    {2024, 138, 0, 0},
+    {65, 139, 0, 1},
+    {65, 140, 0, 1},
+    {64, 141, 0, 1},
+    {19, 142, 0, 1},
+    {19, 143, 0, 1},
+    {19, 144, 0, 1},
+    {19, 145, 0, 1},
+    {65, 146, 0, 1},
+    {65, 147, 0, 1},
+    {65, 148, 0, 1},
+    {65, 149, 0, 1},
+    {3004, 150, 0, 1},
+    {3004, 151, 0, 1},
+    {3004, 152, 0, 1},
+    {3004, 153, 0, 1},
+    {3004, 154, 0, 1},
+    {3004, 155, 0, 1},
+    {9, 156, 0, 1},
+    {9, 157, 0, 1},
+    {9, 158, 0, 1},
+    {2012, 159, 0, 1},
+    {3001, 160, 0, 1},
+    {3001, 161, 0, 1},
+    {3001, 162, 0, 1},
+    {3001, 163, 0, 1},
+    {3001, 164, 0, 1},
+    {3001, 165, 0, 1},
+    {2012, 166, 0, 1},
+    {2011, 167, 0, 1},
+    {2011, 168, 0, 1},
+    {2011, 169, 0, 1},
+    {65, 170, 0, 1},
+    {9, 171, 0, 1},
+    {65, 172, 0, 1},
+};
+
+
+static const ap_thing_info_t ap_doom2_thing_infos_e2m4[] = 
+{
+    {1, 0, 0, 1},
+    {2, 1, 0, 1},
+    {3, 2, 0, 1},
+    {4, 3, 0, 1},
+    {2023, 4, 0, 0},
+    {46, 5, 0, 1},
+    {46, 6, 0, 1},
+    {46, 7, 0, 1},
+    {46, 8, 0, 1},
+    {45, 9, 0, 1},
+    {45, 10, 0, 1},
+    {2003, 11, 0, 0},
+    {2046, 12, 0, 1},
+    {2001, 13, 0, 0},
+    {2024, 14, 0, 0},
+    {3001, 15, 0, 1},
+    {3001, 16, 0, 1},
+    {3001, 17, 0, 1},
+    {3001, 18, 0, 1},
+    {3001, 19, 0, 1},
+    {3001, 20, 0, 1},
+    {3001, 21, 0, 1},
+    {3001, 22, 0, 1},
+    {44, 23, 0, 1},
+    {8, 24, 0, 0},
+    {2046, 25, 0, 1},
+    {2008, 26, 0, 1},
+    {2008, 27, 0, 1},
+    {2008, 28, 0, 1},
+    {57, 29, 0, 1},
+    {57, 30, 0, 1},
+    {57, 31, 0, 1},
+    {46, 32, 0, 1},
+    {2012, 33, 0, 1},
+    {35, 34, 0, 1},
+    {35, 35, 0, 1},
+    {35, 36, 0, 1},
+    {35, 37, 0, 1},
+    {35, 38, 0, 1},
+    {35, 39, 0, 1},
+    {35, 40, 0, 1},
+    {35, 41, 0, 1},
+    {45, 42, 0, 1},
+    {45, 43, 0, 1},
+    {34, 44, 0, 1},
+    {34, 45, 0, 1},
+    {34, 46, 0, 1},
+    {34, 47, 0, 1},
+    {2006, 48, 0, 0},
+    {3003, 49, 0, 1},
+    {71, 50, 0, 1},
+    {71, 51, 0, 1},
+    {71, 52, 0, 1},
+    {3005, 53, 0, 1},
+    {3005, 54, 0, 1},
+    {2012, 55, 0, 1},
+    {2013, 56, 0, 0},
+    {2019, 57, 0, 0},
+    {2012, 58, 0, 1},
+    {2018, 59, 0, 0},
+    {2012, 60, 0, 1},
+    {2047, 61, 0, 1},
+    {2049, 62, 0, 1},
+    {2010, 63, 0, 1},
+    {11, 64, 0, 1},
+    {11, 65, 0, 1},
+    {11, 66, 0, 1},
+    {11, 67, 0, 1},
+    {11, 68, 0, 1},
+    {11, 69, 0, 1},
+    {11, 70, 0, 1},
+    {6, 71, 0, 0},
+    {14, 72, 0, 1},
+    {14, 73, 0, 1},
+    {2002, 74, 0, 0},
+    {2048, 75, 0, 1},
+    {14, 76, 0, 1},
+    {14, 77, 0, 1},
+    {69, 78, 0, 1},
+    {46, 79, 0, 1},
+    {46, 80, 0, 1},
+    {46, 81, 0, 1},
+    {46, 82, 0, 1},
+    {46, 83, 0, 1},
+    {46, 84, 0, 1},
+    {46, 85, 0, 1},
+    {2004, 86, 0, 0},
+    {2047, 87, 0, 1},
+    {2025, 88, 0, 1},
+    {17, 89, 0, 1},
+    {17, 90, 0, 1},
+    {2024, 91, 0, 0},
+    {69, 92, 0, 1},
+    {2026, 93, 0, 0},
+    {2022, 94, 0, 0},
+    {46, 95, 0, 1},
+    {46, 96, 0, 1},
+    {14, 97, 0, 1},
+    {14, 98, 0, 1},
+    {14, 99, 0, 1},
+    {13, 100, 0, 0},
+    {2012, 101, 0, 1},
+    {2049, 102, 0, 1},
+    {8, 103, 0, 0},
+    {55, 104, 0, 1},
+    {44, 105, 0, 1},
+    {44, 106, 0, 1},
+    {44, 107, 0, 1},
+    {24, 108, 0, 1},
+    {15, 109, 0, 1},
+    {19, 110, 0, 1},
+    {10, 111, 0, 1},
+    {14, 112, 0, 1},
+    {2005, 113, 0, 0},
+    {56, 114, 0, 1},
+    {56, 115, 0, 1},
+    {46, 116, 0, 1},
+    {46, 117, 0, 1},
+    {46, 118, 0, 1},
+    {46, 119, 0, 1},
+    {2012, 120, 0, 1},
+    {2012, 121, 0, 1},
+    {2012, 122, 0, 1},
+    {2046, 123, 0, 1},
+    {2049, 124, 0, 1},
+    {83, 125, 0, 0},
+    {3003, 126, 0, 1},
+    {3001, 127, 0, 1},
+    {3001, 128, 0, 1},
+    {3001, 129, 0, 1},
+    {3001, 130, 0, 1},
+    {3001, 131, 0, 1},
+    {3001, 132, 0, 1},
+    {3001, 133, 0, 1},
+    {3001, 134, 0, 1},
+    {3001, 135, 0, 1},
+    {3001, 136, 0, 1},
+    {3001, 137, 0, 1},
+    {3001, 138, 0, 1},
+    {3001, 139, 0, 1},
+    {3001, 140, 0, 1},
+    {3001, 141, 0, 1},
+    {69, 142, 0, 1},
+    {44, 143, 0, 1},
+    {44, 144, 0, 1},
+    {55, 145, 0, 1},
+    {3005, 146, 0, 1},
+    {3005, 147, 0, 1},
+    {3005, 148, 0, 1},
+    {3001, 149, 0, 1},
+    {3001, 150, 0, 1},
+    {3001, 151, 0, 1},
+    {3001, 152, 0, 1},
+    {3001, 153, 0, 1},
+    {3001, 154, 0, 1},
+    {65, 155, 0, 1},
+    {65, 156, 0, 1},
+    {3006, 157, 0, 1},
+    {3006, 158, 0, 1},
+    {3006, 159, 0, 1},
+    {3006, 160, 0, 1},
+    {3006, 161, 0, 1},
+    {3006, 162, 0, 1},
+    {3006, 163, 0, 1},
+    {9, 164, 0, 1},
+    {9, 165, 0, 1},
+    {9, 166, 0, 1},
+    {9, 167, 0, 1},
+    {9, 168, 0, 1},
+    {9, 169, 0, 1},
+    {65, 170, 0, 1},
+    {65, 171, 0, 1},
+    {65, 172, 0, 1},
+    {65, 173, 0, 1},
+    {65, 174, 0, 1},
+    {65, 175, 0, 1},
+    {2008, 176, 0, 1},
+    {2008, 177, 0, 1},
+    {2023, 178, 0, 0},
+    {3006, 179, 0, 1},
+    {3006, 180, 0, 1},
+    {65, 181, 0, 1},
+    {71, 182, 0, 1},
+    {9, 183, 0, 1},
+    {65, 184, 0, 1},
+    {3001, 185, 0, 1},
+    {3001, 186, 0, 1},
+    {3001, 187, 0, 1},
+    {3001, 188, 0, 1},
+    {2047, 189, 0, 1},
+    {2047, 190, 0, 1},
+    {2047, 191, 0, 1},
+    {2047, 192, 0, 1},
+    {2047, 193, 0, 1},
+    {2010, 194, 0, 1},
+    {2010, 195, 0, 1},
+    {2011, 196, 0, 1},
+    {2011, 197, 0, 1},
+    {2011, 198, 0, 1},
+    {2011, 199, 0, 1},
+    {2011, 200, 0, 1},
+    {2011, 201, 0, 1},
+    {2008, 202, 0, 1},
+    {2007, 203, 0, 1},
+    {2007, 204, 0, 1},
+    {68, 205, 0, 1},
+    {71, 206, 0, 1},
+    {2046, 207, 0, 1},
+    {2046, 208, 0, 1},
+    {46, 209, 0, 1},
+    {46, 210, 0, 1},
+    {46, 211, 0, 1},
+    {46, 212, 0, 1},
+    {2049, 213, 0, 1},
+    {3004, 214, 0, 1},
+    {3004, 215, 0, 1},
+    {3004, 216, 0, 1},
+    {3004, 217, 0, 1},
+    {3004, 218, 0, 1},
+    {3004, 219, 0, 1},
+    {3004, 220, 0, 1},
+    {3004, 221, 0, 1},
+    {3004, 222, 0, 1},
+    {3004, 223, 0, 1},
+    {3004, 224, 0, 1},
+    {3004, 225, 0, 1},
+    {3004, 226, 0, 1},
+    {3004, 227, 0, 1},
+    {3004, 228, 0, 1},
+    {3004, 229, 0, 1},
+    {3004, 230, 0, 1},
+    {3004, 231, 0, 1},
+    {3004, 232, 0, 1},
+    {3004, 233, 0, 1},
+    {3004, 234, 0, 1},
+    {3004, 235, 0, 1},
+    {3004, 236, 0, 1},
+    {3004, 237, 0, 1},
+    {3004, 238, 0, 1},
+    {3004, 239, 0, 1},
+    {3004, 240, 0, 1},
+    {3004, 241, 0, 1},
+    {3004, 242, 0, 1},
+    {3004, 243, 0, 1},
+    {3004, 244, 0, 1},
+    {3004, 245, 0, 1},
+    {3004, 246, 0, 1},
+    {3004, 247, 0, 1},
+    {3004, 248, 0, 1},
+    {3004, 249, 0, 1},
+    {3004, 250, 0, 1},
+    {3004, 251, 0, 1},
+    {3004, 252, 0, 1},
+    {3004, 253, 0, 1},
+    {3004, 254, 0, 1},
+    {3004, 255, 0, 1},
+    {3004, 256, 0, 1},
+    {9, 257, 0, 1},
+    {9, 258, 0, 1},
+    {9, 259, 0, 1},
+    {9, 260, 0, 1},
+    {9, 261, 0, 1},
+    {9, 262, 0, 1},
+    {9, 263, 0, 1},
+    {9, 264, 0, 1},
+    {9, 265, 0, 1},
+    {9, 266, 0, 1},
+    {9, 267, 0, 1},
+    {9, 268, 0, 1},
+    {9, 269, 0, 1},
+    {9, 270, 0, 1},
+    {9, 271, 0, 1},
+    {9, 272, 0, 1},
+    {9, 273, 0, 1},
+    {9, 274, 0, 1},
+    {9, 275, 0, 1},
+    {9, 276, 0, 1},
+    {9, 277, 0, 1},
+    {9, 278, 0, 1},
+    {9, 279, 0, 1},
+    {9, 280, 0, 1},
+    {9, 281, 0, 1},
+    {9, 282, 0, 1},
+    {9, 283, 0, 1},
+    {9, 284, 0, 1},
+    {9, 285, 0, 1},
+    {9, 286, 0, 1},
+    {9, 287, 0, 1},
+    {9, 288, 0, 1},
+    {9, 289, 0, 1},
+    {3001, 290, 0, 1},
+    {3001, 291, 0, 1},
+    {3001, 292, 0, 1},
+    {71, 293, 0, 1},
+    {9, 294, 0, 1},
+    {9, 295, 0, 1},
+    {3005, 296, 0, 1},
+    {65, 297, 0, 1},
+    {65, 298, 0, 1},
+    {65, 299, 0, 1},
+    {65, 300, 0, 1},
+    {65, 301, 0, 1},
+    {65, 302, 0, 1},
+    {3001, 303, 0, 1},
+    {3001, 304, 0, 1},
+    {3001, 305, 0, 1},
+    {3001, 306, 0, 1},
+    {9, 307, 0, 1},
+    {3005, 308, 0, 1},
+    {3005, 309, 0, 1},
+    {65, 310, 0, 1},
+    {2011, 311, 0, 1},
+    {2011, 312, 0, 1},
+    {2011, 313, 0, 1},
+    {2011, 314, 0, 1},
+    {2011, 315, 0, 1},
+    {2011, 316, 0, 1},
+    {2011, 317, 0, 1},
+    {2012, 318, 0, 1},
+    {2012, 319, 0, 1},
+    {2011, 320, 0, 1},
+    {2011, 321, 0, 1},
+    {2011, 322, 0, 1},
+    {2011, 323, 0, 1},
+    {2011, 324, 0, 1},
+    {2011, 325, 0, 1},
+    {2011, 326, 0, 1},
+    {2011, 327, 0, 1},
+    {2011, 328, 0, 1},
+    {2011, 329, 0, 1},
+    {2011, 330, 0, 1},
+    {2011, 331, 0, 1},
+    {2011, 332, 0, 1},
+    {2012, 333, 0, 1},
+    {2012, 334, 0, 1},
+    {2012, 335, 0, 1},
+    {2012, 336, 0, 1},
+    {5, 337, 0, 0},
+    {3001, 338, 0, 1},
+    {3001, 339, 0, 1},
+    {3005, 340, 0, 1},
+    {3005, 341, 0, 1},
+    {3005, 342, 0, 1},
+    {2012, 343, 0, 1},
+    {2012, 344, 0, 1},
+    {2012, 345, 0, 1},
+    {2008, 346, 0, 1},
+    {2008, 347, 0, 1},
+    {2008, 348, 0, 1},
+    {2008, 349, 0, 1},
+    {2008, 350, 0, 1},
+    {2008, 351, 0, 1},
+    {2008, 352, 0, 1},
+    {2008, 353, 0, 1},
+    {2008, 354, 0, 1},
+    {2008, 355, 0, 1},
+    {2045, 356, 0, 1},
+    {2012, 357, 0, 1},
+    {2012, 358, 0, 1},
+    {2012, 359, 0, 1},
+    {2025, 360, 0, 1},
+    {2019, 361, 0, 0},
+    {16, 362, 0, 1},
+    {11, 363, 0, 1},
+    {46, 364, 0, 1},
+    {2011, 365, 0, 1},
+    {2011, 366, 0, 1},
+    {2011, 367, 0, 1},
+    {2011, 368, 0, 1},
+    {2011, 369, 0, 1},
+    {2012, 370, 0, 1},
+    {2012, 371, 0, 1},
+    {2012, 372, 0, 1},
+    {2025, 373, 0, 1},
+    {14, 374, 0, 1},
+    {82, 375, 0, 1},
+};
+
+
+static const ap_thing_info_t ap_doom2_thing_infos_e2m5[] = 
+{
+    {56, 0, 0, 1},
+    {56, 1, 0, 1},
+    {1, 2, 0, 1},
+    {2, 3, 0, 1},
+    {3, 4, 0, 1},
+    {4, 5, 0, 1},
+    {11, 6, 0, 1},
+    {83, 7, 0, 0},
+    {41, 8, 0, 1},
+    {42, 9, 0, 1},
+    {57, 10, 0, 1},
+    {82, 11, 0, 0},
+    {2008, 12, 0, 1},
+    {2008, 13, 0, 1},
+    {2008, 14, 0, 1},
+    {2002, 15, 0, 0},
+    {2011, 16, 0, 1},
+    {2012, 17, 0, 1},
+    {2049, 18, 0, 1},
+    {3001, 19, 0, 1},
+    {3001, 20, 0, 1},
+    {3001, 21, 0, 1},
+    {3001, 22, 0, 1},
+    {3001, 23, 0, 1},
+    {3001, 24, 0, 1},
+    {3001, 25, 0, 1},
+    {3001, 26, 0, 1},
+    {3001, 27, 0, 1},
+    {3001, 28, 0, 1},
+    {3001, 29, 0, 1},
+    {3001, 30, 0, 1},
+    {3001, 31, 0, 1},
+    {3001, 32, 0, 1},
+    {3001, 33, 0, 1},
+    {3001, 34, 0, 1},
+    {3001, 35, 0, 1},
+    {3001, 36, 0, 1},
+    {3001, 37, 0, 1},
+    {3001, 38, 0, 1},
+    {3001, 39, 0, 1},
+    {3001, 40, 0, 1},
+    {3001, 41, 0, 1},
+    {3001, 42, 0, 1},
+    {3001, 43, 0, 1},
+    {3001, 44, 0, 1},
+    {3001, 45, 0, 1},
+    {3001, 46, 0, 1},
+    {3001, 47, 0, 1},
+    {3001, 48, 0, 1},
+    {3001, 49, 0, 1},
+    {3005, 50, 0, 1},
+    {2049, 51, 0, 1},
+    {2049, 52, 0, 1},
+    {8, 53, 0, 0},
+    {66, 54, 0, 1},
+    {64, 55, 0, 1},
+    {66, 56, 0, 1},
+    {2011, 57, 0, 1},
+    {2011, 58, 0, 1},
+    {2003, 59, 0, 0},
+    {2023, 60, 0, 0},
+    {66, 61, 0, 1},
+    {2004, 62, 0, 0},
+    {2004, 63, 0, 0},
+    {2004, 64, 0, 0},
+    {2004, 65, 0, 0},
+    {14, 66, 0, 1},
+    {14, 67, 0, 1},
+    {14, 68, 0, 1},
+    {14, 69, 0, 1},
+    {14, 70, 0, 1},
+    {3002, 71, 0, 1},
+    {3002, 72, 0, 1},
+    {3002, 73, 0, 1},
+    {3002, 74, 0, 1},
+    {58, 75, 0, 1},
+    {66, 76, 0, 1},
+    {2049, 77, 0, 1},
+    {2046, 78, 0, 1},
+    {2012, 79, 0, 1},
+    {2012, 80, 0, 1},
+    {2012, 81, 0, 1},
+    {2008, 82, 0, 1},
+    {2008, 83, 0, 1},
+    {2008, 84, 0, 1},
+    {2012, 85, 0, 1},
+    {2008, 86, 0, 1},
+    {3001, 87, 0, 1},
+    {3001, 88, 0, 1},
+    {3001, 89, 0, 1},
+    {3001, 90, 0, 1},
+    {3001, 91, 0, 1},
+    {3001, 92, 0, 1},
+    {3001, 93, 0, 1},
+    {3001, 94, 0, 1},
+    {3001, 95, 0, 1},
+    {3001, 96, 0, 1},
+    {3001, 97, 0, 1},
+    {3001, 98, 0, 1},
+    {3001, 99, 0, 1},
+    {3001, 100, 0, 1},
+    {3001, 101, 0, 1},
+    {3001, 102, 0, 1},
+    {3001, 103, 0, 1},
+    {3001, 104, 0, 1},
+    {3001, 105, 0, 1},
+    {3001, 106, 0, 1},
+    {3001, 107, 0, 1},
+    {3001, 108, 0, 1},
+    {3001, 109, 0, 1},
+    {3001, 110, 0, 1},
+    {3001, 111, 0, 1},
+    {3001, 112, 0, 1},
+    {3001, 113, 0, 1},
+    {3001, 114, 0, 1},
+    {3001, 115, 0, 1},
+    {3001, 116, 0, 1},
+    {3001, 117, 0, 1},
+    {3001, 118, 0, 1},
+    {3001, 119, 0, 1},
+    {3001, 120, 0, 1},
+    {3001, 121, 0, 1},
+    {3001, 122, 0, 1},
+    {3001, 123, 0, 1},
+    {3001, 124, 0, 1},
+    {3001, 125, 0, 1},
+    {3001, 126, 0, 1},
+    {3001, 127, 0, 1},
+    {3001, 128, 0, 1},
+    {3005, 129, 0, 1},
+    {3005, 130, 0, 1},
+    {3005, 131, 0, 1},
+    {3005, 132, 0, 1},
+    {3005, 133, 0, 1},
+    {3005, 134, 0, 1},
+    {3005, 135, 0, 1},
+    {3005, 136, 0, 1},
+    {3005, 137, 0, 1},
+    {3005, 138, 0, 1},
+    {3005, 139, 0, 1},
+    {3005, 140, 0, 1},
+    {3005, 141, 0, 1},
+    {3005, 142, 0, 1},
+    {3005, 143, 0, 1},
+    {3005, 144, 0, 1},
+    {3005, 145, 0, 1},
+    {3005, 146, 0, 1},
+    {67, 147, 0, 1},
+    {67, 148, 0, 1},
+    {67, 149, 0, 1},
+    {67, 150, 0, 1},
+    {67, 151, 0, 1},
+    {67, 152, 0, 1},
+    {67, 153, 0, 1},
+    {67, 154, 0, 1},
+    {67, 155, 0, 1},
+    {67, 156, 0, 1},
+    {67, 157, 0, 1},
+    {67, 158, 0, 1},
+    {2025, 159, 0, 1},
+    {14, 160, 0, 1},
+    {14, 161, 0, 1},
+    {14, 162, 0, 1},
+    {3001, 163, 0, 1},
+    {2046, 164, 0, 1},
+    {2046, 165, 0, 1},
+    {2046, 166, 0, 1},
+    {66, 167, 0, 1},
+    {66, 168, 0, 1},
+    {2006, 169, 0, 0},
+    {17, 170, 0, 1},
+    {17, 171, 0, 1},
+    {17, 172, 0, 1},
+    {66, 173, 0, 1},
+    {66, 174, 0, 1},
+    {3005, 175, 0, 1},
+    {3005, 176, 0, 1},
+    {3005, 177, 0, 1},
+    {66, 178, 0, 1},
+    {2049, 179, 0, 1},
+    {58, 180, 0, 1},
+    {67, 181, 0, 1},
+    {2001, 182, 0, 0},
+    {2049, 183, 0, 1},
+    {67, 184, 0, 1},
+    {2013, 185, 0, 0},
+    {40, 186, 0, 0},
+    {3001, 187, 0, 1},
+    {3001, 188, 0, 1},
+    {66, 189, 0, 1},
+    {66, 190, 0, 1},
+    {3001, 191, 0, 1},
+    {3001, 192, 0, 1},
+    {3001, 193, 0, 1},
+    {3001, 194, 0, 1},
+    {3001, 195, 0, 1},
+    {3001, 196, 0, 1},
+    {3001, 197, 0, 1},
+    {3001, 198, 0, 1},
+    {3001, 199, 0, 1},
+    {3001, 200, 0, 1},
+    {3001, 201, 0, 1},
+    {3001, 202, 0, 1},
+    {3001, 203, 0, 1},
+    {3001, 204, 0, 1},
+    {3001, 205, 0, 1},
+    {3001, 206, 0, 1},
+    {3001, 207, 0, 1},
+    {3001, 208, 0, 1},
+    {3001, 209, 0, 1},
+    {3001, 210, 0, 1},
+    {3001, 211, 0, 1},
+    {3001, 212, 0, 1},
+    {3001, 213, 0, 1},
+    {3001, 214, 0, 1},
+    {3005, 215, 0, 1},
+    {3005, 216, 0, 1},
+    {3005, 217, 0, 1},
+    {64, 218, 0, 1},
+    {58, 219, 0, 1},
+    {58, 220, 0, 1},
+    {2022, 221, 0, 0},
+    {2049, 222, 0, 1},
+    {2048, 223, 0, 1},
+    {2012, 224, 0, 1},
+    {66, 225, 0, 1},
+    {66, 226, 0, 1},
+    {66, 227, 0, 1},
+    {67, 228, 0, 1},
+    {2049, 229, 0, 1},
+    {2049, 230, 0, 1},
+    {2024, 231, 0, 0},
+    {2011, 232, 0, 1},
+    {2011, 233, 0, 1},
+    {2011, 234, 0, 1},
+    {2008, 235, 0, 1},
+    {38, 236, 0, 0},
+    {2008, 237, 0, 1},
+    {2007, 238, 0, 1},
+    {2007, 239, 0, 1},
+    {2011, 240, 0, 1},
+    {2011, 241, 0, 1},
+    {11, 242, 0, 1},
+    {11, 243, 0, 1},
+    {11, 244, 0, 1},
+    {11, 245, 0, 1},
+    {11, 246, 0, 1},
+    {11, 247, 0, 1},
+    {2012, 248, 0, 1},
+};
+
+
+static const ap_thing_info_t ap_doom2_thing_infos_e2m6[] = 
+{
+    {1, 0, 0, 1},
+    {2018, 1, 0, 0},
+    {2012, 2, 0, 1},
+    {2012, 3, 0, 1},
+    {2, 4, 0, 1},
+    {3, 5, 0, 1},
+    {4, 6, 0, 1},
+    {2013, 7, 0, 0},
+    {3001, 8, 0, 1},
+    {3001, 9, 0, 1},
+    {3001, 10, 0, 1},
+    {3001, 11, 0, 1},
+    {3001, 12, 0, 1},
+    {3001, 13, 0, 1},
+    {3001, 14, 0, 1},
+    {3001, 15, 0, 1},
+    {3001, 16, 0, 1},
+    {3001, 17, 0, 1},
+    {2001, 18, 0, 0},
+    {2008, 19, 0, 1},
+    {2008, 20, 0, 1},
+    {46, 21, 0, 1},
+    {46, 22, 0, 1},
+    {45, 23, 0, 1},
+    {45, 24, 0, 1},
+    {58, 25, 0, 1},
+    {58, 26, 0, 1},
+    {58, 27, 0, 1},
+    {58, 28, 0, 1},
+    {58, 29, 0, 1},
+    {69, 30, 0, 1},
+    {62, 31, 0, 1},
+    {2011, 32, 0, 1},
+    {2008, 33, 0, 1},
+    {13, 34, 0, 0},
+    {3004, 35, 0, 1},
+    {9, 36, 0, 1},
+    {9, 37, 0, 1},
+    {14, 38, 0, 1},
+    {9, 39, 0, 1},
+    {65, 40, 0, 1},
+    {3005, 41, 0, 1},
+    {3005, 42, 0, 1},
+    {3005, 43, 0, 1},
+    {9, 44, 0, 1},
+    {65, 45, 0, 1},
+    {3005, 46, 0, 1},
+    {3005, 47, 0, 1},
+    {3005, 48, 0, 1},
+    {3001, 49, 0, 1},
+    {3001, 50, 0, 1},
+    {3001, 51, 0, 1},
+    {3001, 52, 0, 1},
+    {3001, 53, 0, 1},
+    {14, 54, 0, 1},
+    {14, 55, 0, 1},
+    {46, 56, 0, 1},
+    {46, 57, 0, 1},
+    {2008, 58, 0, 1},
+    {2008, 59, 0, 1},
+    {2008, 60, 0, 1},
+    {2012, 61, 0, 1},
+    {2012, 62, 0, 1},
+    {2049, 63, 0, 1},
+    {44, 64, 0, 1},
+    {44, 65, 0, 1},
+    {44, 66, 0, 1},
+    {44, 67, 0, 1},
+    {46, 68, 0, 1},
+    {5, 69, 0, 0},
+    {2049, 70, 0, 1},
+    {2012, 71, 0, 1},
+    {2012, 72, 0, 1},
+    {2012, 73, 0, 1},
+    {2011, 74, 0, 1},
+    {2013, 75, 0, 0},
+    {39, 76, 0, 0},
+    {2003, 77, 0, 0},
+    {2046, 78, 0, 1},
+    {2010, 79, 0, 1},
+    {2010, 80, 0, 1},
+    {2024, 81, 0, 0},
+    {45, 82, 0, 1},
+    {45, 83, 0, 1},
+    {56, 84, 0, 1},
+    {56, 85, 0, 1},
+    {56, 86, 0, 1},
+    {57, 87, 0, 1},
+    {57, 88, 0, 1},
+    {57, 89, 0, 1},
+    {57, 90, 0, 1},
+    {36, 91, 0, 1},
+    {2002, 92, 0, 0},
+    {2005, 93, 0, 1},
+    {46, 94, 0, 1},
+    {30, 95, 0, 1},
+    {30, 96, 0, 1},
+    {46, 97, 0, 1},
+    {46, 98, 0, 1},
+    {30, 99, 0, 1},
+    {30, 100, 0, 1},
+    {46, 101, 0, 1},
+    {2006, 102, 0, 0},
+    {44, 103, 0, 1},
+    {46, 104, 0, 1},
+    {46, 105, 0, 1},
+    {46, 106, 0, 1},
+    {46, 107, 0, 1},
+    {46, 108, 0, 1},
+    {46, 109, 0, 1},
+    {46, 110, 0, 1},
+    {46, 111, 0, 1},
+    {45, 112, 0, 1},
+    {45, 113, 0, 1},
+    {2004, 114, 0, 0},
+    {19, 115, 0, 1},
+    {10, 116, 0, 1},
+    {2047, 117, 0, 1},
+    {2010, 118, 0, 1},
+    {2015, 119, 0, 1},
+    {2015, 120, 0, 1},
+    {2015, 121, 0, 1},
+    {2015, 122, 0, 1},
+    {2014, 123, 0, 1},
+    {2014, 124, 0, 1},
+    {2014, 125, 0, 1},
+    {2014, 126, 0, 1},
+    {58, 127, 0, 1},
+    {58, 128, 0, 1},
+    {58, 129, 0, 1},
+    {58, 130, 0, 1},
+    {58, 131, 0, 1},
+    {2012, 132, 0, 1},
+    {2012, 133, 0, 1},
+    {2012, 134, 0, 1},
+    {2012, 135, 0, 1},
+    {2025, 136, 0, 1},
+    {3005, 137, 0, 1},
+    {3005, 138, 0, 1},
+    {65, 139, 0, 1},
+    {65, 140, 0, 1},
+    {3005, 141, 0, 1},
+    {3005, 142, 0, 1},
+    {3001, 143, 0, 1},
+    {3001, 144, 0, 1},
+    {3001, 145, 0, 1},
+    {3001, 146, 0, 1},
+    {65, 147, 0, 1},
+    {9, 148, 0, 1},
+    {9, 149, 0, 1},
+    {9, 150, 0, 1},
+    {9, 151, 0, 1},
+    {9, 152, 0, 1},
+    {58, 153, 0, 1},
+    {71, 154, 0, 1},
+    {66, 155, 0, 1},
+    {2011, 156, 0, 1},
+    {2011, 157, 0, 1},
+    {2011, 158, 0, 1},
+    {2011, 159, 0, 1},
+    {2011, 160, 0, 1},
+    {2011, 161, 0, 1},
+    {2011, 162, 0, 1},
+    {2012, 163, 0, 1},
+    {2012, 164, 0, 1},
+    {2012, 165, 0, 1},
+    {2012, 166, 0, 1},
+    {2012, 167, 0, 1},
+    {2019, 168, 0, 0},
+    {9, 169, 0, 1},
+    {9, 170, 0, 1},
+    {9, 171, 0, 1},
+    {9, 172, 0, 1},
+    {9, 173, 0, 1},
+    {2035, 174, 0, 1},
+    {2035, 175, 0, 1},
+    {2035, 176, 0, 1},
+    {2035, 177, 0, 1},
+    {2035, 178, 0, 1},
+    {2018, 179, 0, 0},
+    {2048, 180, 0, 1},
+    {2008, 181, 0, 1},
+    {2008, 182, 0, 1},
+    {2008, 183, 0, 1},
+    {2048, 184, 0, 1},
+    {2048, 185, 0, 1},
+    {2048, 186, 0, 1},
+    {2015, 187, 0, 1},
+    {2015, 188, 0, 1},
+    {2015, 189, 0, 1},
+    {2015, 190, 0, 1},
+    {2014, 191, 0, 1},
+    {2014, 192, 0, 1},
+    {2014, 193, 0, 1},
+    {2014, 194, 0, 1},
+    {2014, 195, 0, 1},
+    {2014, 196, 0, 1},
+    {2014, 197, 0, 1},
+    {2014, 198, 0, 1},
+    {2015, 199, 0, 1},
+    {2015, 200, 0, 1},
+    {2015, 201, 0, 1},
+    {2015, 202, 0, 1},
+    {2015, 203, 0, 1},
+    {2015, 204, 0, 1},
+    {2015, 205, 0, 1},
+    {2015, 206, 0, 1},
+    {2015, 207, 0, 1},
+    {2015, 208, 0, 1},
+    {2015, 209, 0, 1},
+    {2015, 210, 0, 1},
+    {2015, 211, 0, 1},
+    {2014, 212, 0, 1},
+    {2014, 213, 0, 1},
+    {2014, 214, 0, 1},
+    {2035, 215, 0, 1},
+    {2035, 216, 0, 1},
+    {2035, 217, 0, 1},
+    {2023, 218, 0, 0},
+    {2012, 219, 0, 1},
+    {2012, 220, 0, 1},
+    {2012, 221, 0, 1},
+    {2035, 222, 0, 1},
+    {2035, 223, 0, 1},
+    {2035, 224, 0, 1},
+    {2035, 225, 0, 1},
+    {2035, 226, 0, 1},
+    {2035, 227, 0, 1},
+    {2035, 228, 0, 1},
+    {2035, 229, 0, 1},
+    {2049, 230, 0, 1},
+    {2049, 231, 0, 1},
+    {2049, 232, 0, 1},
+    {2048, 233, 0, 1},
+    {3001, 234, 0, 1},
+    {3001, 235, 0, 1},
+    {3001, 236, 0, 1},
+    {65, 237, 0, 1},
+    {68, 238, 0, 1},
+    {2049, 239, 0, 1},
+    {2048, 240, 0, 1},
+    {2048, 241, 0, 1},
+    {2015, 242, 0, 1},
+    {2015, 243, 0, 1},
+    {2015, 244, 0, 1},
+    {2015, 245, 0, 1},
+    {2015, 246, 0, 1},
+    {2015, 247, 0, 1},
+    {2015, 248, 0, 1},
+    {2015, 249, 0, 1},
+    {2015, 250, 0, 1},
+    {2015, 251, 0, 1},
+    {2015, 252, 0, 1},
+    {2015, 253, 0, 1},
+    {2015, 254, 0, 1},
+    {2015, 255, 0, 1},
+    {28, 256, 0, 1},
+    {2012, 257, 0, 1},
+    {2012, 258, 0, 1},
+    {2012, 259, 0, 1},
+    {2010, 260, 0, 1},
+    {8, 261, 0, 0},
+    {2011, 262, 0, 1},
+    {2014, 263, 0, 1},
+    {2014, 264, 0, 1},
+    {2014, 265, 0, 1},
+    {2014, 266, 0, 1},
+    {2014, 267, 0, 1},
+    {2014, 268, 0, 1},
+    {2014, 269, 0, 1},
+    {2014, 270, 0, 1},
+    {2014, 271, 0, 1},
+    {2014, 272, 0, 1},
+    {2014, 273, 0, 1},
+    {2014, 274, 0, 1},
+    {2014, 275, 0, 1},
+    {2014, 276, 0, 1},
+    {2014, 277, 0, 1},
+    {2014, 278, 0, 1},
+    {2014, 279, 0, 1},
+    {2014, 280, 0, 1},
+    {2014, 281, 0, 1},
+    {2014, 282, 0, 1},
+    {49, 283, 0, 1},
+    {52, 284, 0, 1},
+    {3005, 285, 0, 1},
+    {3004, 286, 0, 1},
+    {3004, 287, 0, 1},
+    {3004, 288, 0, 1},
+    {3004, 289, 0, 1},
+    {3004, 290, 0, 1},
+    {9, 291, 0, 1},
+    {3004, 292, 0, 1},
+    {3004, 293, 0, 1},
+    {3004, 294, 0, 1},
+    {65, 295, 0, 1},
+    {65, 296, 0, 1},
+    {65, 297, 0, 1},
+    {65, 298, 0, 1},
+    {9, 299, 0, 1},
+    {9, 300, 0, 1},
+    {9, 301, 0, 1},
+    {9, 302, 0, 1},
+    {2012, 303, 0, 1},
+    {2012, 304, 0, 1},
+    {2049, 305, 0, 1},
+    {71, 306, 0, 1},
+    {71, 307, 0, 1},
+    {65, 308, 0, 1},
+    {65, 309, 0, 1},
+    {65, 310, 0, 1},
+    {65, 311, 0, 1},
+    {3001, 312, 0, 1},
+    {3001, 313, 0, 1},
+    {3001, 314, 0, 1},
+    {3001, 315, 0, 1},
+    {3001, 316, 0, 1},
+    {3001, 317, 0, 1},
+    {66, 318, 0, 1},
+    {3005, 319, 0, 1},
+    {3005, 320, 0, 1},
+    {71, 321, 0, 1},
+    {2015, 322, 0, 1},
+    {2015, 323, 0, 1},
+    {2015, 324, 0, 1},
+    {2015, 325, 0, 1},
+    {2015, 326, 0, 1},
+    {2015, 327, 0, 1},
+    {2015, 328, 0, 1},
+    {2015, 329, 0, 1},
+    {2015, 330, 0, 1},
+    {2015, 331, 0, 1},
+    {2015, 332, 0, 1},
+    {2015, 333, 0, 1},
+    {2014, 334, 0, 1},
+    {2014, 335, 0, 1},
+    {2014, 336, 0, 1},
+    {2014, 337, 0, 1},
+    {2014, 338, 0, 1},
+    {2014, 339, 0, 1},
+    {2014, 340, 0, 1},
+    {2014, 341, 0, 1},
+    {2014, 342, 0, 1},
+    {2014, 343, 0, 1},
+    {2014, 344, 0, 1},
+    {2010, 345, 0, 1},
+    {2010, 346, 0, 1},
+    {2010, 347, 0, 1},
+    {2010, 348, 0, 1},
+    {2049, 349, 0, 1},
+    {2049, 350, 0, 1},
+    {3001, 351, 0, 1},
+    {3001, 352, 0, 1},
+    {3001, 353, 0, 1},
+    {3001, 354, 0, 1},
+    {3001, 355, 0, 1},
+    {64, 356, 0, 1},
+    {2012, 357, 0, 1},
+    {2012, 358, 0, 1},
+    {2012, 359, 0, 1},
+    {2012, 360, 0, 1},
+    {2012, 361, 0, 1},
+    {2012, 362, 0, 1},
+    {2012, 363, 0, 1},
+    {2012, 364, 0, 1},
+    {2049, 365, 0, 1},
+    {2015, 366, 0, 1},
+    {2015, 367, 0, 1},
+    {2015, 368, 0, 1},
+    {2015, 369, 0, 1},
+    {2015, 370, 0, 1},
+    {2015, 371, 0, 1},
+    {2015, 372, 0, 1},
+    {2015, 373, 0, 1},
+    {2015, 374, 0, 1},
+    {2015, 375, 0, 1},
+    {2015, 376, 0, 1},
+    {2015, 377, 0, 1},
+    {2015, 378, 0, 1},
+    {2015, 379, 0, 1},
+    {65, 380, 0, 1},
+    {65, 381, 0, 1},
+    {2046, 382, 0, 1},
+    {14, 383, 0, 1},
+    {44, 384, 0, 1},
+    {44, 385, 0, 1},
+    {44, 386, 0, 1},
+    {44, 387, 0, 1},
+    {17, 388, 0, 1},
+    {2047, 389, 0, 1},
+    {2047, 390, 0, 1},
+    {2047, 391, 0, 1},
+    {69, 392, 0, 1},
+    {68, 393, 0, 1},
+    {2047, 394, 0, 1},
+    {2047, 395, 0, 1},
+    {2047, 396, 0, 1},
+    {3001, 397, 0, 1},
+    {65, 398, 0, 1},
+    {65, 399, 0, 1},
+    {9, 400, 0, 1},
+    {9, 401, 0, 1},
+    {11, 402, 0, 1},
+    {11, 403, 0, 1},
+    {11, 404, 0, 1},
+    {11, 405, 0, 1},
+    {11, 406, 0, 1},
+    {11, 407, 0, 1},
+    {11, 408, 0, 1},
+    {14, 409, 0, 1},
+    {3001, 410, 0, 1},
+    {3001, 411, 0, 1},
+    {9, 412, 0, 1},
+    {9, 413, 0, 1},
+    {9, 414, 0, 1},
+    {65, 415, 0, 1},
+    {65, 416, 0, 1},
+    {65, 417, 0, 1},
+    {65, 418, 0, 1},
+    {83, 419, 0, 0},
+    {16, 420, 0, 1},
+};
+
+
+static const ap_thing_info_t ap_doom2_thing_infos_e2m7[] = 
+{
+    {1, 0, 0, 1},
+    {2, 1, 0, 1},
+    {3, 2, 0, 1},
+    {4, 3, 0, 1},
+    {11, 4, 0, 1},
+    {14, 5, 0, 1},
+    {3002, 6, 0, 1},
+    {3002, 7, 0, 1},
+    {3001, 8, 0, 1},
+    {3001, 9, 0, 1},
+    {3001, 10, 0, 1},
+    {69, 11, 0, 1},
+    {2001, 12, 0, 0},
+    {3001, 13, 0, 1},
+    {3001, 14, 0, 1},
+    {3001, 15, 0, 1},
+    {3001, 16, 0, 1},
+    {3001, 17, 0, 1},
+    {3001, 18, 0, 1},
+    {3001, 19, 0, 1},
+    {3001, 20, 0, 1},
+    {3001, 21, 0, 1},
+    {3001, 22, 0, 1},
+    {3004, 23, 0, 1},
+    {3001, 24, 0, 1},
+    {3001, 25, 0, 1},
+    {3001, 26, 0, 1},
+    {3001, 27, 0, 1},
+    {3001, 28, 0, 1},
+    {3002, 29, 0, 1},
+    {3002, 30, 0, 1},
+    {3002, 31, 0, 1},
+    {3001, 32, 0, 1},
+    {3001, 33, 0, 1},
+    {3001, 34, 0, 1},
+    {3001, 35, 0, 1},
+    {2004, 36, 0, 0},
+    {17, 37, 0, 1},
+    {17, 38, 0, 1},
+    {2008, 39, 0, 1},
+    {2008, 40, 0, 1},
+    {2008, 41, 0, 1},
+    {2008, 42, 0, 1},
+    {2008, 43, 0, 1},
+    {2008, 44, 0, 1},
+    {2008, 45, 0, 1},
+    {2008, 46, 0, 1},
+    {2008, 47, 0, 1},
+    {2018, 48, 0, 0},
+    {58, 49, 0, 1},
+    {58, 50, 0, 1},
+    {58, 51, 0, 1},
+    {2023, 52, 0, 0},
+    {9, 53, 0, 1},
+    {9, 54, 0, 1},
+    {9, 55, 0, 1},
+    {9, 56, 0, 1},
+    {9, 57, 0, 1},
+    {3002, 58, 0, 1},
+    {3002, 59, 0, 1},
+    {3002, 60, 0, 1},
+    {3002, 61, 0, 1},
+    {3002, 62, 0, 1},
+    {3002, 63, 0, 1},
+    {3002, 64, 0, 1},
+    {3002, 65, 0, 1},
+    {3002, 66, 0, 1},
+    {9, 67, 0, 1},
+    {9, 68, 0, 1},
+    {9, 69, 0, 1},
+    {9, 70, 0, 1},
+    {9, 71, 0, 1},
+    {9, 72, 0, 1},
+    {9, 73, 0, 1},
+    {9, 74, 0, 1},
+    {9, 75, 0, 1},
+    {9, 76, 0, 1},
+    {9, 77, 0, 1},
+    {9, 78, 0, 1},
+    {9, 79, 0, 1},
+    {9, 80, 0, 1},
+    {9, 81, 0, 1},
+    {14, 82, 0, 1},
+    {14, 83, 0, 1},
+    {58, 84, 0, 1},
+    {58, 85, 0, 1},
+    {58, 86, 0, 1},
+    {58, 87, 0, 1},
+    {58, 88, 0, 1},
+    {58, 89, 0, 1},
+    {58, 90, 0, 1},
+    {58, 91, 0, 1},
+    {2048, 92, 0, 1},
+    {2012, 93, 0, 1},
+    {2011, 94, 0, 1},
+    {2002, 95, 0, 0},
+    {2011, 96, 0, 1},
+    {2011, 97, 0, 1},
+    {2011, 98, 0, 1},
+    {2011, 99, 0, 1},
+    {2011, 100, 0, 1},
+    {9, 101, 0, 1},
+    {3002, 102, 0, 1},
+    {3002, 103, 0, 1},
+    {3002, 104, 0, 1},
+    {3002, 105, 0, 1},
+    {3002, 106, 0, 1},
+    {3002, 107, 0, 1},
+    {3002, 108, 0, 1},
+    {3002, 109, 0, 1},
+    {3002, 110, 0, 1},
+    {3002, 111, 0, 1},
+    {3002, 112, 0, 1},
+    {3002, 113, 0, 1},
+    {3002, 114, 0, 1},
+    {3002, 115, 0, 1},
+    {3002, 116, 0, 1},
+    {3002, 117, 0, 1},
+    {3002, 118, 0, 1},
+    {3002, 119, 0, 1},
+    {3002, 120, 0, 1},
+    {3002, 121, 0, 1},
+    {3001, 122, 0, 1},
+    {3001, 123, 0, 1},
+    {3001, 124, 0, 1},
+    {3001, 125, 0, 1},
+    {3001, 126, 0, 1},
+    {3001, 127, 0, 1},
+    {3001, 128, 0, 1},
+    {3001, 129, 0, 1},
+    {2003, 130, 0, 0},
+    {2011, 131, 0, 1},
+    {2011, 132, 0, 1},
+    {2011, 133, 0, 1},
+    {2011, 134, 0, 1},
+    {2011, 135, 0, 1},
+    {2011, 136, 0, 1},
+    {3001, 137, 0, 1},
+    {3001, 138, 0, 1},
+    {3001, 139, 0, 1},
+    {3001, 140, 0, 1},
+    {3001, 141, 0, 1},
+    {3001, 142, 0, 1},
+    {3001, 143, 0, 1},
+    {3001, 144, 0, 1},
+    {3001, 145, 0, 1},
+    {3001, 146, 0, 1},
+    {2010, 147, 0, 1},
+    {2010, 148, 0, 1},
+    {69, 149, 0, 1},
+    {2010, 150, 0, 1},
+    {2010, 151, 0, 1},
+    {2011, 152, 0, 1},
+    {2011, 153, 0, 1},
+    {2011, 154, 0, 1},
+    {2011, 155, 0, 1},
+    {2011, 156, 0, 1},
+    {2011, 157, 0, 1},
+    {66, 158, 0, 1},
+    {3001, 159, 0, 1},
+    {3001, 160, 0, 1},
+    {3001, 161, 0, 1},
+    {3001, 162, 0, 1},
+    {3001, 163, 0, 1},
+    {3001, 164, 0, 1},
+    {3001, 165, 0, 1},
+    {2010, 166, 0, 1},
+    {2010, 167, 0, 1},
+    {2011, 168, 0, 1},
+    {2011, 169, 0, 1},
+    {2024, 170, 0, 0},
+    {2024, 171, 0, 0},
+    {17, 172, 0, 1},
+    {69, 173, 0, 1},
+    {3005, 174, 0, 1},
+    {3005, 175, 0, 1},
+    {3005, 176, 0, 1},
+    {2048, 177, 0, 1},
+    {2049, 178, 0, 1},
+    {2046, 179, 0, 1},
+    {3005, 180, 0, 1},
+    {3005, 181, 0, 1},
+    {3005, 182, 0, 1},
+    {3005, 183, 0, 1},
+    {3005, 184, 0, 1},
+    {3005, 185, 0, 1},
+    {3005, 186, 0, 1},
+    {69, 187, 0, 1},
+    {2048, 188, 0, 1},
+    {2047, 189, 0, 1},
+    {58, 190, 0, 1},
+    {58, 191, 0, 1},
+    {58, 192, 0, 1},
+    {58, 193, 0, 1},
+    {58, 194, 0, 1},
+    {58, 195, 0, 1},
+    {3005, 196, 0, 1},
+    {3005, 197, 0, 1},
+    {8, 198, 0, 0},
+    {3001, 199, 0, 1},
+    {3001, 200, 0, 1},
+    {3001, 201, 0, 1},
+    {3001, 202, 0, 1},
+    {3001, 203, 0, 1},
+    {3001, 204, 0, 1},
+    {3001, 205, 0, 1},
+    {3001, 206, 0, 1},
+    {3002, 207, 0, 1},
+    {3002, 208, 0, 1},
+    {3002, 209, 0, 1},
+    {3002, 210, 0, 1},
+    {3002, 211, 0, 1},
+    {3002, 212, 0, 1},
+    {58, 213, 0, 1},
+    {58, 214, 0, 1},
+    {2012, 215, 0, 1},
+    {2012, 216, 0, 1},
+    {67, 217, 0, 1},
+    {2013, 218, 0, 0},
+    {3001, 219, 0, 1},
+    {3001, 220, 0, 1},
+    {3001, 221, 0, 1},
+    {3001, 222, 0, 1},
+    {3002, 223, 0, 1},
+    {3001, 224, 0, 1},
+    {3001, 225, 0, 1},
+    {3002, 226, 0, 1},
+    {2048, 227, 0, 1},
+    {2022, 228, 0, 0},
+    {2022, 229, 0, 0},
+    {2048, 230, 0, 1},
+    {2012, 231, 0, 1},
+    {2012, 232, 0, 1},
+    {2012, 233, 0, 1},
+    {2011, 234, 0, 1},
+    {2011, 235, 0, 1},
+    {2011, 236, 0, 1},
+    {2047, 237, 0, 1},
+    {2007, 238, 0, 1},
+    {2010, 239, 0, 1},
+    {2008, 240, 0, 1},
+    {2010, 241, 0, 1},
+    {2010, 242, 0, 1},
+    {2010, 243, 0, 1},
+    {9, 244, 0, 1},
+    {9, 245, 0, 1},
+    {9, 246, 0, 1},
+    {9, 247, 0, 1},
+    {9, 248, 0, 1},
+    {9, 249, 0, 1},
+    {9, 250, 0, 1},
+    {3002, 251, 0, 1},
+    {3001, 252, 0, 1},
+    {3001, 253, 0, 1},
+    {39, 254, 0, 0},
+    {3005, 255, 0, 1},
+    {3005, 256, 0, 1},
+    {3005, 257, 0, 1},
+    {3005, 258, 0, 1},
+    {3005, 259, 0, 1},
+    {3005, 260, 0, 1},
+    {3005, 261, 0, 1},
+    {58, 262, 0, 1},
+    {58, 263, 0, 1},
+    {58, 264, 0, 1},
+    {58, 265, 0, 1},
+    {14, 266, 0, 1},
+    {14, 267, 0, 1},
+    {40, 268, 0, 0},
+    {2048, 269, 0, 1},
+    {2048, 270, 0, 1},
+    {2011, 271, 0, 1},
+    {2011, 272, 0, 1},
+    {2011, 273, 0, 1},
+    {2015, 274, 0, 1},
+    {2015, 275, 0, 1},
+    {2015, 276, 0, 1},
+    {2015, 277, 0, 1},
+    {2015, 278, 0, 1},
+    {2015, 279, 0, 1},
+    {2015, 280, 0, 1},
+    {2015, 281, 0, 1},
+    {2015, 282, 0, 1},
+    {2015, 283, 0, 1},
+    {2015, 284, 0, 1},
+    {2014, 285, 0, 1},
+    {2014, 286, 0, 1},
+    {2014, 287, 0, 1},
+    {2014, 288, 0, 1},
+    {2014, 289, 0, 1},
+    {2014, 290, 0, 1},
+    {2014, 291, 0, 1},
+    {2014, 292, 0, 1},
+    {2014, 293, 0, 1},
+    {2014, 294, 0, 1},
+    {2014, 295, 0, 1},
+    {2014, 296, 0, 1},
+    {2015, 297, 0, 1},
+    {2015, 298, 0, 1},
+    {2015, 299, 0, 1},
+    {2015, 300, 0, 1},
+    {2015, 301, 0, 1},
+    {2015, 302, 0, 1},
+    {2015, 303, 0, 1},
+    {2015, 304, 0, 1},
+    {2015, 305, 0, 1},
+    {2015, 306, 0, 1},
+    {2015, 307, 0, 1},
+    {2015, 308, 0, 1},
+    {2015, 309, 0, 1},
+    {2014, 310, 0, 1},
+    {2014, 311, 0, 1},
+    {2014, 312, 0, 1},
+    {2014, 313, 0, 1},
+    {2014, 314, 0, 1},
+    {2014, 315, 0, 1},
+    {2014, 316, 0, 1},
+    {2014, 317, 0, 1},
+    {2014, 318, 0, 1},
+    {2014, 319, 0, 1},
+    {2014, 320, 0, 1},
+    {2014, 321, 0, 1},
+    {2014, 322, 0, 1},
+    {2014, 323, 0, 1},
+    {2014, 324, 0, 1},
+    {2014, 325, 0, 1},
+    {2014, 326, 0, 1},
+    {2014, 327, 0, 1},
+    {2014, 328, 0, 1},
+    {2014, 329, 0, 1},
+    {2014, 330, 0, 1},
+    {2014, 331, 0, 1},
+    {2014, 332, 0, 1},
+    {2014, 333, 0, 1},
+    {2014, 334, 0, 1},
+    {2014, 335, 0, 1},
+    {2014, 336, 0, 1},
+    {2014, 337, 0, 1},
+    {2014, 338, 0, 1},
+    {2014, 339, 0, 1},
+    {2014, 340, 0, 1},
+    {2014, 341, 0, 1},
+    {2014, 342, 0, 1},
+    {2014, 343, 0, 1},
+    {2014, 344, 0, 1},
+    {2014, 345, 0, 1},
+    {2014, 346, 0, 1},
+    {2014, 347, 0, 1},
+    {2014, 348, 0, 1},
+    {2014, 349, 0, 1},
+    {2014, 350, 0, 1},
+    {2014, 351, 0, 1},
+    {2014, 352, 0, 1},
+    {2014, 353, 0, 1},
+    {2014, 354, 0, 1},
+    {2014, 355, 0, 1},
+    {2014, 356, 0, 1},
+    {2014, 357, 0, 1},
+    {2014, 358, 0, 1},
+    {2014, 359, 0, 1},
+    {2014, 360, 0, 1},
+    {2014, 361, 0, 1},
+    {2014, 362, 0, 1},
+    {2014, 363, 0, 1},
+    {2014, 364, 0, 1},
+    {2014, 365, 0, 1},
+    {2014, 366, 0, 1},
+    {2014, 367, 0, 1},
+    {2014, 368, 0, 1},
+    {2014, 369, 0, 1},
+    {2014, 370, 0, 1},
+    {2014, 371, 0, 1},
+    {2014, 372, 0, 1},
+    {2014, 373, 0, 1},
+    {2014, 374, 0, 1},
+    {2014, 375, 0, 1},
+    {2014, 376, 0, 1},
+    {2014, 377, 0, 1},
+    {2014, 378, 0, 1},
+    {2014, 379, 0, 1},
+    {2014, 380, 0, 1},
+    {2014, 381, 0, 1},
+    {2014, 382, 0, 1},
+    {2014, 383, 0, 1},
+    {2014, 384, 0, 1},
+    {2014, 385, 0, 1},
+    {2014, 386, 0, 1},
+    {2014, 387, 0, 1},
+    {2014, 388, 0, 1},
+    {2014, 389, 0, 1},
+    {2014, 390, 0, 1},
+    {2014, 391, 0, 1},
+    {2014, 392, 0, 1},
+    {2014, 393, 0, 1},
+    {2014, 394, 0, 1},
+    {2014, 395, 0, 1},
+    {2014, 396, 0, 1},
+    {2014, 397, 0, 1},
+    {2014, 398, 0, 1},
+    {2014, 399, 0, 1},
+    {2006, 400, 0, 0},
+    {2046, 401, 0, 1},
+    {2046, 402, 0, 1},
+    {2015, 403, 0, 1},
+    {2015, 404, 0, 1},
+    {2015, 405, 0, 1},
+    {2015, 406, 0, 1},
+    {2015, 407, 0, 1},
+    {2015, 408, 0, 1},
+    {2015, 409, 0, 1},
+    {2015, 410, 0, 1},
+    {2015, 411, 0, 1},
+    {2015, 412, 0, 1},
+    {2015, 413, 0, 1},
+    {2015, 414, 0, 1},
+    {2015, 415, 0, 1},
+    {2015, 416, 0, 1},
+    {2015, 417, 0, 1},
+    {2015, 418, 0, 1},
+    {2015, 419, 0, 1},
+    {2015, 420, 0, 1},
+    {2015, 421, 0, 1},
+    {2015, 422, 0, 1},
+    {2015, 423, 0, 1},
+    {2015, 424, 0, 1},
+    {2015, 425, 0, 1},
+    {2015, 426, 0, 1},
+    {2014, 427, 0, 1},
+    {2014, 428, 0, 1},
+    {2014, 429, 0, 1},
+    {2014, 430, 0, 1},
+    {2014, 431, 0, 1},
+    {2014, 432, 0, 1},
+    {2014, 433, 0, 1},
+    {2014, 434, 0, 1},
+    {2014, 435, 0, 1},
+    {2014, 436, 0, 1},
+    {2014, 437, 0, 1},
+    {2014, 438, 0, 1},
+    {2014, 439, 0, 1},
+    {2014, 440, 0, 1},
+    {2014, 441, 0, 1},
+    {2014, 442, 0, 1},
+    {2014, 443, 0, 1},
+    {2014, 444, 0, 1},
+    {2014, 445, 0, 1},
+    {2014, 446, 0, 1},
+    {2014, 447, 0, 1},
+    {2014, 448, 0, 1},
+    {2014, 449, 0, 1},
+    {2014, 450, 0, 1},
+    {14, 451, 0, 1},
+    {14, 452, 0, 1},
+    {2046, 453, 0, 1},
+    {2046, 454, 0, 1},
+    {2012, 455, 0, 1},
+    {2012, 456, 0, 1},
+    {2012, 457, 0, 1},
+    {2026, 458, 0, 0},
+    {2012, 459, 0, 1},
+    {14, 460, 0, 1},
+    {82, 461, 0, 0},
+    {2008, 462, 0, 1},
+    {2008, 463, 0, 1},
+    {2008, 464, 0, 1},
+    {2008, 465, 0, 1},
+    {2008, 466, 0, 1},
+    {2008, 467, 0, 1},
+    {11, 468, 0, 1},
+    {11, 469, 0, 1},
+    {11, 470, 0, 1},
+    {11, 471, 0, 1},
+    {2019, 472, 0, 1},
+    {82, 473, 0, 1},
+    {2006, 474, 0, 1},
+    {2010, 475, 0, 1},
+    {2010, 476, 0, 1},
+    {2010, 477, 0, 1},
+    {2010, 478, 0, 1},
+    {2010, 479, 0, 1},
+    {2010, 480, 0, 1},
+    {2010, 481, 0, 1},
+    {2010, 482, 0, 1},
+    {2010, 483, 0, 1},
+    {2010, 484, 0, 1},
+    {2010, 485, 0, 1},
+    {17, 486, 0, 1},
+    {17, 487, 0, 1},
+    {83, 488, 0, 1},
+    {66, 489, 0, 1},
+    {69, 490, 0, 1},
+    {3001, 491, 0, 1},
+    {3001, 492, 0, 1},
+    {3001, 493, 0, 1},
+    {3001, 494, 0, 1},
+    {3001, 495, 0, 1},
+    {3001, 496, 0, 1},
+    {2014, 497, 0, 1},
+};
+
+
+static const ap_thing_info_t ap_doom2_thing_infos_e2m8[] = 
+{
+    {1, 0, 0, 1},
+    {2, 1, 0, 1},
+    {3, 2, 0, 1},
+    {4, 3, 0, 1},
+    {3001, 4, 0, 1},
+    {3001, 5, 0, 1},
+    {3001, 6, 0, 1},
+    {3001, 7, 0, 1},
+    {3001, 8, 0, 1},
+    {3001, 9, 0, 1},
+    {3001, 10, 0, 1},
+    {2008, 11, 0, 1},
+    {2011, 12, 0, 1},
+    {2011, 13, 0, 1},
+    {3001, 14, 0, 1},
+    {3001, 15, 0, 1},
+    {3001, 16, 0, 1},
+    {3001, 17, 0, 1},
+    {3001, 18, 0, 1},
+    {3001, 19, 0, 1},
+    {3001, 20, 0, 1},
+    {2001, 21, 0, 1},
+    {9, 22, 0, 1},
+    {9, 23, 0, 1},
+    {9, 24, 0, 1},
+    {2008, 25, 0, 1},
+    {2008, 26, 0, 1},
+    {2011, 27, 0, 1},
+    {2011, 28, 0, 1},
+    {2011, 29, 0, 1},
+    {2011, 30, 0, 1},
+    {2011, 31, 0, 1},
+    {2011, 32, 0, 1},
+    {2011, 33, 0, 1},
+    {58, 34, 0, 1},
+    {2011, 35, 0, 1},
+    {2011, 36, 0, 1},
+    {2011, 37, 0, 1},
+    {2011, 38, 0, 1},
+    {2011, 39, 0, 1},
+    {2011, 40, 0, 1},
+    {2011, 41, 0, 1},
+    {2011, 42, 0, 1},
+    {2011, 43, 0, 1},
+    {2011, 44, 0, 1},
+    {2011, 45, 0, 1},
+    {2011, 46, 0, 1},
+    {2011, 47, 0, 1},
+    {2011, 48, 0, 1},
+    {2011, 49, 0, 1},
+    {2011, 50, 0, 1},
+    {2011, 51, 0, 1},
+    {2008, 52, 0, 1},
+    {2008, 53, 0, 1},
+    {2008, 54, 0, 1},
+    {2008, 55, 0, 1},
+    {58, 56, 0, 1},
+    {2008, 57, 0, 1},
+    {2008, 58, 0, 1},
+    {2008, 59, 0, 1},
+    {2007, 60, 0, 1},
+    {58, 61, 0, 1},
+    {58, 62, 0, 1},
+    {2007, 63, 0, 1},
+    {2018, 64, 0, 0},
+    {58, 65, 0, 1},
+    {58, 66, 0, 1},
+    {58, 67, 0, 1},
+    {58, 68, 0, 1},
+    {58, 69, 0, 1},
+    {58, 70, 0, 1},
+    {58, 71, 0, 1},
+    {58, 72, 0, 1},
+    {58, 73, 0, 1},
+    {58, 74, 0, 1},
+    {58, 75, 0, 1},
+    {2011, 76, 0, 1},
+    {58, 77, 0, 1},
+    {58, 78, 0, 1},
+    {58, 79, 0, 1},
+    {58, 80, 0, 1},
+    {58, 81, 0, 1},
+    {58, 82, 0, 1},
+    {58, 83, 0, 1},
+    {58, 84, 0, 1},
+    {58, 85, 0, 1},
+    {2011, 86, 0, 1},
+    {58, 87, 0, 1},
+    {2011, 88, 0, 1},
+    {2048, 89, 0, 1},
+    {2007, 90, 0, 1},
+    {3001, 91, 0, 1},
+    {3001, 92, 0, 1},
+    {3001, 93, 0, 1},
+    {3001, 94, 0, 1},
+    {3001, 95, 0, 1},
+    {3001, 96, 0, 1},
+    {3001, 97, 0, 1},
+    {3001, 98, 0, 1},
+    {2002, 99, 0, 0},
+    {3002, 100, 0, 1},
+    {3002, 101, 0, 1},
+    {9, 102, 0, 1},
+    {9, 103, 0, 1},
+    {2012, 104, 0, 1},
+    {2007, 105, 0, 1},
+    {2048, 106, 0, 1},
+    {2011, 107, 0, 1},
+    {14, 108, 0, 1},
+    {58, 109, 0, 1},
+    {58, 110, 0, 1},
+    {3001, 111, 0, 1},
+    {14, 112, 0, 1},
+    {3001, 113, 0, 1},
+    {3001, 114, 0, 1},
+    {3001, 115, 0, 1},
+    {2023, 116, 0, 0},
+    {3001, 117, 0, 1},
+    {3001, 118, 0, 1},
+    {3001, 119, 0, 1},
+    {3001, 120, 0, 1},
+    {3001, 121, 0, 1},
+    {2011, 122, 0, 1},
+    {2007, 123, 0, 1},
+    {2007, 124, 0, 1},
+    {2007, 125, 0, 1},
+    {2049, 126, 0, 1},
+    {2019, 127, 0, 0},
+    {3001, 128, 0, 1},
+    {3001, 129, 0, 1},
+    {3001, 130, 0, 1},
+    {3001, 131, 0, 1},
+    {3001, 132, 0, 1},
+    {3001, 133, 0, 1},
+    {3001, 134, 0, 1},
+    {3001, 135, 0, 1},
+    {3001, 136, 0, 1},
+    {3001, 137, 0, 1},
+    {3001, 138, 0, 1},
+    {3001, 139, 0, 1},
+    {3001, 140, 0, 1},
+    {2014, 141, 0, 1},
+    {2014, 142, 0, 1},
+    {2014, 143, 0, 1},
+    {2014, 144, 0, 1},
+    {2014, 145, 0, 1},
+    {2014, 146, 0, 1},
+    {2014, 147, 0, 1},
+    {2014, 148, 0, 1},
+    {2014, 149, 0, 1},
+    {2014, 150, 0, 1},
+    {2014, 151, 0, 1},
+    {2014, 152, 0, 1},
+    {2014, 153, 0, 1},
+    {2014, 154, 0, 1},
+    {2014, 155, 0, 1},
+    {2014, 156, 0, 1},
+    {2014, 157, 0, 1},
+    {2014, 158, 0, 1},
+    {2014, 159, 0, 1},
+    {2014, 160, 0, 1},
+    {2014, 161, 0, 1},
+    {2014, 162, 0, 1},
+    {2014, 163, 0, 1},
+    {2014, 164, 0, 1},
+    {2014, 165, 0, 1},
+    {2014, 166, 0, 1},
+    {2014, 167, 0, 1},
+    {2014, 168, 0, 1},
+    {2014, 169, 0, 1},
+    {2014, 170, 0, 1},
+    {2014, 171, 0, 1},
+    {2014, 172, 0, 1},
+    {2014, 173, 0, 1},
+    {2013, 174, 0, 0},
+    {14, 175, 0, 1},
+    {2049, 176, 0, 1},
+    {2011, 177, 0, 1},
+    {2015, 178, 0, 1},
+    {2015, 179, 0, 1},
+    {2015, 180, 0, 1},
+    {2015, 181, 0, 1},
+    {2015, 182, 0, 1},
+    {2015, 183, 0, 1},
+    {2015, 184, 0, 1},
+    {2015, 185, 0, 1},
+    {2015, 186, 0, 1},
+    {2015, 187, 0, 1},
+    {31, 188, 0, 1},
+    {41, 189, 0, 1},
+    {41, 190, 0, 1},
+    {2008, 191, 0, 1},
+    {2048, 192, 0, 1},
+    {46, 193, 0, 1},
+    {46, 194, 0, 1},
+    {2008, 195, 0, 1},
+    {2008, 196, 0, 1},
+    {57, 197, 0, 1},
+    {57, 198, 0, 1},
+    {57, 199, 0, 1},
+    {57, 200, 0, 1},
+    {3001, 201, 0, 1},
+    {3001, 202, 0, 1},
+    {3001, 203, 0, 1},
+    {3001, 204, 0, 1},
+    {3001, 205, 0, 1},
+    {3001, 206, 0, 1},
+    {3001, 207, 0, 1},
+    {3001, 208, 0, 1},
+    {3001, 209, 0, 1},
+    {3001, 210, 0, 1},
+    {2008, 211, 0, 1},
+    {3002, 212, 0, 1},
+    {3002, 213, 0, 1},
+    {3002, 214, 0, 1},
+    {3002, 215, 0, 1},
+    {3001, 216, 0, 1},
+    {3001, 217, 0, 1},
+    {3001, 218, 0, 1},
+    {55, 219, 0, 1},
+    {55, 220, 0, 1},
+    {55, 221, 0, 1},
+    {55, 222, 0, 1},
+    {2018, 223, 0, 0},
+    {55, 224, 0, 1},
+    {3005, 225, 0, 1},
+    {68, 226, 0, 1},
+    {3005, 227, 0, 1},
+    {3002, 228, 0, 1},
+    {3002, 229, 0, 1},
+    {3002, 230, 0, 1},
+    {3002, 231, 0, 1},
+    {8, 232, 0, 0},
+    {2004, 233, 0, 1},
+    {2005, 234, 0, 1},
+    {3004, 235, 0, 1},
+    {3004, 236, 0, 1},
+    {3004, 237, 0, 1},
+    {3004, 238, 0, 1},
+    {3004, 239, 0, 1},
+    {3004, 240, 0, 1},
+    {3004, 241, 0, 1},
+    {3004, 242, 0, 1},
+    {3004, 243, 0, 1},
+    {3004, 244, 0, 1},
+    {3004, 245, 0, 1},
+    {3004, 246, 0, 1},
+    {3004, 247, 0, 1},
+    {3004, 248, 0, 1},
+    {3004, 249, 0, 1},
+    {3004, 250, 0, 1},
+    {2011, 251, 0, 1},
+    {2011, 252, 0, 1},
+    {2048, 253, 0, 1},
+    {3002, 254, 0, 1},
+    {3002, 255, 0, 1},
+    {3002, 256, 0, 1},
+    {3002, 257, 0, 1},
+    {3002, 258, 0, 1},
+    {2046, 259, 0, 1},
+    {14, 260, 0, 1},
+    {9, 261, 0, 1},
+    {2048, 262, 0, 1},
+    {2010, 263, 0, 1},
+    {9, 264, 0, 1},
+    {9, 265, 0, 1},
+    {9, 266, 0, 1},
+    {9, 267, 0, 1},
+    {45, 268, 0, 1},
+    {3005, 269, 0, 1},
+    {3001, 270, 0, 1},
+    {3001, 271, 0, 1},
+    {3001, 272, 0, 1},
+    {3001, 273, 0, 1},
+    {3001, 274, 0, 1},
+    {3001, 275, 0, 1},
+    {3001, 276, 0, 1},
+    {3001, 277, 0, 1},
+    {3001, 278, 0, 1},
+    {3001, 279, 0, 1},
+    {3001, 280, 0, 1},
+    {3001, 281, 0, 1},
+    {3001, 282, 0, 1},
+    {3001, 283, 0, 1},
+    {3001, 284, 0, 1},
+    {3001, 285, 0, 1},
+    {3001, 286, 0, 1},
+    {3001, 287, 0, 1},
+    {3001, 288, 0, 1},
+    {3001, 289, 0, 1},
+    {3001, 290, 0, 1},
+    {3001, 291, 0, 1},
+    {3001, 292, 0, 1},
+    {3001, 293, 0, 1},
+    {3001, 294, 0, 1},
+    {3001, 295, 0, 1},
+    {3001, 296, 0, 1},
+    {3001, 297, 0, 1},
+    {3001, 298, 0, 1},
+    {3001, 299, 0, 1},
+    {3001, 300, 0, 1},
+    {3001, 301, 0, 1},
+    {3001, 302, 0, 1},
+    {3001, 303, 0, 1},
+    {3001, 304, 0, 1},
+    {3001, 305, 0, 1},
+    {3001, 306, 0, 1},
+    {3001, 307, 0, 1},
+    {3001, 308, 0, 1},
+    {3001, 309, 0, 1},
+    {2010, 310, 0, 1},
+    {2010, 311, 0, 1},
+    {2049, 312, 0, 1},
+    {2012, 313, 0, 1},
+    {2012, 314, 0, 1},
+    {2022, 315, 0, 0},
+    {14, 316, 0, 1},
+    {14, 317, 0, 1},
+    {46, 318, 0, 1},
+    {46, 319, 0, 1},
+    {46, 320, 0, 1},
+    {3001, 321, 0, 1},
+    {3001, 322, 0, 1},
+    {3001, 323, 0, 1},
+    {3001, 324, 0, 1},
+    {46, 325, 0, 1},
+    {2014, 326, 0, 1},
+    {2014, 327, 0, 1},
+    {2014, 328, 0, 1},
+    {2014, 329, 0, 1},
+    {2014, 330, 0, 1},
+    {2014, 331, 0, 1},
+    {2014, 332, 0, 1},
+    {2014, 333, 0, 1},
+    {2014, 334, 0, 1},
+    {2014, 335, 0, 1},
+    {3002, 336, 0, 1},
+    {3002, 337, 0, 1},
+    {3002, 338, 0, 1},
+    {3002, 339, 0, 1},
+    {3002, 340, 0, 1},
+    {3002, 341, 0, 1},
+    {3002, 342, 0, 1},
+    {3002, 343, 0, 1},
+    {3002, 344, 0, 1},
+    {2007, 345, 0, 1},
+    {2007, 346, 0, 1},
+    {2008, 347, 0, 1},
+    {2008, 348, 0, 1},
+    {35, 349, 0, 1},
+    {3006, 350, 0, 1},
+    {3006, 351, 0, 1},
+    {3006, 352, 0, 1},
+    {3006, 353, 0, 1},
+    {3006, 354, 0, 1},
+    {3006, 355, 0, 1},
+    {3006, 356, 0, 1},
+    {3006, 357, 0, 1},
+    {3005, 358, 0, 1},
+    {3005, 359, 0, 1},
+    {3005, 360, 0, 1},
+    {2049, 361, 0, 1},
+    {2048, 362, 0, 1},
+    {2012, 363, 0, 1},
+    {2012, 364, 0, 1},
+    {2012, 365, 0, 1},
+    {2012, 366, 0, 1},
+    {2046, 367, 0, 1},
+    {2010, 368, 0, 1},
+    {2010, 369, 0, 1},
+    {40, 370, 0, 0},
+    {3002, 371, 0, 1},
+    {3002, 372, 0, 1},
+    {3002, 373, 0, 1},
+    {3002, 374, 0, 1},
+    {3002, 375, 0, 1},
+    {3002, 376, 0, 1},
+    {3002, 377, 0, 1},
+    {3002, 378, 0, 1},
+    {3002, 379, 0, 1},
+    {3002, 380, 0, 1},
+    {3002, 381, 0, 1},
+    {3002, 382, 0, 1},
+    {43, 383, 0, 1},
+    {43, 384, 0, 1},
+    {43, 385, 0, 1},
+    {43, 386, 0, 1},
+    {43, 387, 0, 1},
+    {54, 388, 0, 1},
+    {12, 389, 0, 1},
+    {12, 390, 0, 1},
+    {10, 391, 0, 1},
+    {10, 392, 0, 1},
+    {24, 393, 0, 1},
+    {24, 394, 0, 1},
+    {3006, 395, 0, 1},
+    {3006, 396, 0, 1},
+    {2012, 397, 0, 1},
+    {2012, 398, 0, 1},
+    {2012, 399, 0, 1},
+    {2012, 400, 0, 1},
+    {2012, 401, 0, 1},
+    {2012, 402, 0, 1},
+    {2024, 403, 0, 0},
+    {38, 404, 0, 0},
+    {39, 405, 0, 0},
+    {55, 406, 0, 1},
+    {55, 407, 0, 1},
+    {55, 408, 0, 1},
+    {55, 409, 0, 1},
+    {55, 410, 0, 1},
+    {55, 411, 0, 1},
+    {55, 412, 0, 1},
+    {55, 413, 0, 1},
+    {55, 414, 0, 1},
+    {2026, 415, 0, 0},
+    {2003, 416, 0, 0},
+    {11, 417, 0, 1},
+    {11, 418, 0, 1},
+    {11, 419, 0, 1},
+    {11, 420, 0, 1},
+    {11, 421, 0, 1},
+    {11, 422, 0, 1},
+    {2049, 423, 0, 1},
+    {2007, 424, 0, 1},
+    {2007, 425, 0, 1},
+    {2007, 426, 0, 1},
+    {2007, 427, 0, 1},
+    {2007, 428, 0, 1},
+    {2007, 429, 0, 1},
+    {2048, 430, 0, 1},
+    {82, 431, 0, 0},
+    {2006, 432, 0, 1},
+    {68, 433, 0, 1},
+    {17, 434, 0, 1},
+    {17, 435, 0, 1},
+    {16, 436, 0, 1},
+};
+
+
+static const ap_thing_info_t ap_doom2_thing_infos_e2m9[] = 
+{
+    {1, 0, 0, 1},
+    {2, 1, 0, 1},
+    {3, 2, 0, 1},
+    {4, 3, 0, 1},
+    {16, 4, 0, 1},
+    {44, 5, 0, 1},
+    {44, 6, 0, 1},
+    {44, 7, 0, 1},
+    {44, 8, 0, 1},
+    {2019, 9, 0, 0},
+    {2003, 10, 0, 0},
+    {2046, 11, 0, 1},
+    {2013, 12, 0, 0},
+    {45, 13, 0, 1},
+    {45, 14, 0, 1},
+    {45, 15, 0, 1},
+    {45, 16, 0, 1},
+    {7, 17, 0, 1},
+    {3003, 18, 0, 1},
+    {2046, 19, 0, 1},
+    {2046, 20, 0, 1},
+    {2046, 21, 0, 1},
+    {46, 22, 0, 1},
+    {46, 23, 0, 1},
+    {2012, 24, 0, 1},
+    {2012, 25, 0, 1},
+    {3005, 26, 0, 1},
+    {71, 27, 0, 1},
+    {3005, 28, 0, 1},
+    {57, 29, 0, 1},
+    {57, 30, 0, 1},
+    {65, 31, 0, 1},
+    {14, 32, 0, 1},
+    {2018, 33, 0, 0},
+    {65, 34, 0, 1},
+    {65, 35, 0, 1},
+    {65, 36, 0, 1},
+    {65, 37, 0, 1},
+    {2008, 38, 0, 1},
+    {2008, 39, 0, 1},
+    {14, 40, 0, 1},
+    {14, 41, 0, 1},
+    {14, 42, 0, 1},
+    {83, 43, 0, 0},
+    {2025, 44, 0, 1},
+    {17, 45, 0, 1},
+    {14, 46, 0, 1},
+    {2018, 47, 0, 0},
+    {2014, 48, 0, 1},
+    {2012, 49, 0, 1},
+    {2014, 50, 0, 1},
+    {2012, 51, 0, 1},
+    {45, 52, 0, 1},
+    {45, 53, 0, 1},
+    {82, 54, 0, 0},
+    {2008, 55, 0, 1},
+    {2008, 56, 0, 1},
+    {36, 57, 0, 1},
+    {2015, 58, 0, 1},
+    {2012, 59, 0, 1},
+    {46, 60, 0, 1},
+    {46, 61, 0, 1},
+    {41, 62, 0, 1},
+    {41, 63, 0, 1},
+    {71, 64, 0, 1},
+    {3005, 65, 0, 1},
+    {3005, 66, 0, 1},
+    {3005, 67, 0, 1},
+    {3005, 68, 0, 1},
+    {14, 69, 0, 1},
+    {2004, 70, 0, 0},
+    {2047, 71, 0, 1},
+    {2047, 72, 0, 1},
+    {2014, 73, 0, 1},
+    {2014, 74, 0, 1},
+    {2014, 75, 0, 1},
+    {2015, 76, 0, 1},
+    {2015, 77, 0, 1},
+    {2015, 78, 0, 1},
+    {2011, 79, 0, 1},
+    {17, 80, 0, 1},
+    {14, 81, 0, 1},
+    {44, 82, 0, 1},
+    {44, 83, 0, 1},
+    {2012, 84, 0, 1},
+    {9, 85, 0, 1},
+    {9, 86, 0, 1},
+    {9, 87, 0, 1},
+    {65, 88, 0, 1},
+    {2015, 89, 0, 1},
+    {2015, 90, 0, 1},
+    {2015, 91, 0, 1},
+    {2015, 92, 0, 1},
+    {42, 93, 0, 1},
+    {14, 94, 0, 1},
+    {45, 95, 0, 1},
+    {2019, 96, 0, 0},
+    {49, 97, 0, 1},
+    {2014, 98, 0, 1},
+    {2014, 99, 0, 1},
+    {2014, 100, 0, 1},
+    {2014, 101, 0, 1},
+    {71, 102, 0, 1},
+    {3005, 103, 0, 1},
+    {65, 104, 0, 1},
+    {3001, 105, 0, 1},
+    {3001, 106, 0, 1},
+    {3001, 107, 0, 1},
+    {3001, 108, 0, 1},
+    {2023, 109, 0, 0},
+    {2014, 110, 0, 1},
+    {2014, 111, 0, 1},
+    {2014, 112, 0, 1},
+    {2014, 113, 0, 1},
+    {2015, 114, 0, 1},
+    {2015, 115, 0, 1},
+    {2015, 116, 0, 1},
+    {46, 117, 0, 1},
+    {46, 118, 0, 1},
+    {2013, 119, 0, 0},
+    {2025, 120, 0, 1},
+    {2012, 121, 0, 1},
+    {2013, 122, 0, 0},
+    {65, 123, 0, 1},
+    {3001, 124, 0, 1},
+    {3006, 125, 0, 1},
+    {3006, 126, 0, 1},
+    {3006, 127, 0, 1},
+    {65, 128, 0, 1},
+    {2008, 129, 0, 1},
+    {2008, 130, 0, 1},
+    {2008, 131, 0, 1},
+    {2008, 132, 0, 1},
+    {11, 133, 0, 1},
+    {11, 134, 0, 1},
+    {11, 135, 0, 1},
+    {11, 136, 0, 1},
+    {11, 137, 0, 1},
+    {11, 138, 0, 1},
+    {11, 139, 0, 1},
+    {14, 140, 0, 1},
+    {14, 141, 0, 1},
+    {2006, 142, 0, 0},
+    {2047, 143, 0, 1},
+    {2047, 144, 0, 1},
+    {2013, 145, 0, 0},
+    {64, 146, 0, 1},
+    {2047, 147, 0, 1},
+    {11, 148, 0, 1},
+    {3001, 149, 0, 1},
+    {3001, 150, 0, 1},
+    {3001, 151, 0, 1},
+    {9, 152, 0, 1},
+    {9, 153, 0, 1},
+    {3006, 154, 0, 1},
+    {3006, 155, 0, 1},
+    {3006, 156, 0, 1},
+    {2012, 157, 0, 1},
+    {2011, 158, 0, 1},
+    {2011, 159, 0, 1},
+    {2015, 160, 0, 1},
+    {2015, 161, 0, 1},
+    {2015, 162, 0, 1},
+    {2015, 163, 0, 1},
+    {3001, 164, 0, 1},
+    {3001, 165, 0, 1},
+    {9, 166, 0, 1},
+    {9, 167, 0, 1},
+    {3001, 168, 0, 1},
+    {3001, 169, 0, 1},
+    {9, 170, 0, 1},
+    {9, 171, 0, 1},
+    {9, 172, 0, 1},
+    {65, 173, 0, 1},
+    {69, 174, 0, 1},
+    {9, 175, 0, 1},
+    {2008, 176, 0, 1},
+    {2008, 177, 0, 1},
+    {2008, 178, 0, 1},
+    {2012, 179, 0, 1},
+    {3001, 180, 0, 1},
+    {65, 181, 0, 1},
+    {9, 182, 0, 1},
+    {14, 183, 0, 1},
+    {44, 184, 0, 1},
+    {44, 185, 0, 1},
+    {46, 186, 0, 1},
+    {46, 187, 0, 1},
+    {56, 188, 0, 1},
+    {56, 189, 0, 1},
+    {2008, 190, 0, 1},
+    {2010, 191, 0, 1},
+    {2047, 192, 0, 1},
+    {2008, 193, 0, 1},
+    {2011, 194, 0, 1},
+    {2011, 195, 0, 1},
+    {2011, 196, 0, 1},
+    {2011, 197, 0, 1},
+    {3005, 198, 0, 1},
+    {3001, 199, 0, 1},
+    {3001, 200, 0, 1},
+    {3001, 201, 0, 1},
+    {3006, 202, 0, 1},
+    {3006, 203, 0, 1},
+    {66, 204, 0, 1},
+    {65, 205, 0, 1},
+    {3006, 206, 0, 1},
+    {66, 207, 0, 1},
+    {71, 208, 0, 1},
+    {3005, 209, 0, 1},
+    {3005, 210, 0, 1},
+    {3005, 211, 0, 1},
+    {2015, 212, 0, 1},
+    {2015, 213, 0, 1},
+    {2015, 214, 0, 1},
+    {2015, 215, 0, 1},
+    {2015, 216, 0, 1},
+    {2015, 217, 0, 1},
+    {2015, 218, 0, 1},
+    {2015, 219, 0, 1},
+    {2015, 220, 0, 1},
+    {2015, 221, 0, 1},
+    {2015, 222, 0, 1},
+    {2014, 223, 0, 1},
+    {2014, 224, 0, 1},
+    {2014, 225, 0, 1},
+    {2014, 226, 0, 1},
+    {2014, 227, 0, 1},
+    {2014, 228, 0, 1},
+    {41, 229, 0, 1},
+    {41, 230, 0, 1},
+    {3001, 231, 0, 1},
+    {3001, 232, 0, 1},
+    {11, 233, 0, 1},
+    {14, 234, 0, 1},
+    {2002, 235, 0, 1},
+    {2048, 236, 0, 1},
+    {2048, 237, 0, 1},
+    {71, 238, 0, 1},
+    {3001, 239, 0, 1},
+    {3001, 240, 0, 1},
+    {3001, 241, 0, 1},
+    {3001, 242, 0, 1},
+    {2048, 243, 0, 1},
+    {2048, 244, 0, 1},
+    {2048, 245, 0, 1},
+    {9, 246, 0, 1},
+    {64, 247, 0, 1},
+    {16, 248, 0, 1},
+    {2046, 249, 0, 1},
+    {2046, 250, 0, 1},
+    {2046, 251, 0, 1},
+    {2046, 252, 0, 1},
+    {2046, 253, 0, 1},
+    {2046, 254, 0, 1},
+    {2046, 255, 0, 1},
+};
+
+
+ap_level_info_t ap_doom2_level_infos_ep2[] = 
+{
+    {"The Factory (MAP12)", {true, true, false}, {0, 0, 0}, 15, 195, ap_doom2_thing_infos_e2m1},
+    {"Downtown (MAP13)", {true, true, true}, {0, 0, 0}, 21, 312, ap_doom2_thing_infos_e2m2},
+    {"The Inmost Dens (MAP14)", {true, false, true}, {1, 0, 1}, 10, 173, ap_doom2_thing_infos_e2m3},
+    {"Industrial Zone (MAP15)", {true, true, true}, {0, 0, 0}, 22, 376, ap_doom2_thing_infos_e2m4},
+    {"Suburbs (MAP16)", {true, false, true}, {1, 0, 1}, 17, 249, ap_doom2_thing_infos_e2m5},
+    {"Tenements (MAP17)", {true, true, true}, {0, 1, 0}, 17, 421, ap_doom2_thing_infos_e2m6},
+    {"The Courtyard (MAP18)", {true, true, false}, {1, 1, 0}, 17, 498, ap_doom2_thing_infos_e2m7},
+    {"The Citadel (MAP19)", {true, true, true}, {1, 1, 1}, 15, 437, ap_doom2_thing_infos_e2m8},
+    {"Gotcha! (MAP20)", {false, false, false}, {0, 0, 0}, 14, 256, ap_doom2_thing_infos_e2m9},
+};
+
+
+static const ap_thing_info_t ap_doom2_thing_infos_e3m1[] = 
+{
+    {11, 0, 0, 1},
+    {11, 1, 0, 1},
+    {11, 2, 0, 1},
+    {11, 3, 0, 1},
+    {1, 4, 0, 1},
+    {2, 5, 0, 1},
+    {3, 6, 0, 1},
+    {4, 7, 0, 1},
+    {11, 8, 0, 1},
+    {14, 9, 0, 1},
+    {14, 10, 0, 1},
+    {14, 11, 0, 1},
+    {14, 12, 0, 1},
+    {14, 13, 0, 1},
+    {14, 14, 0, 1},
+    {14, 15, 0, 1},
+    {14, 16, 0, 1},
+    {14, 17, 0, 1},
+    {14, 18, 0, 1},
+    {2001, 19, 0, 1},
+    {9, 20, 0, 1},
+    {9, 21, 0, 1},
+    {9, 22, 0, 1},
+    {9, 23, 0, 1},
+    {9, 24, 0, 1},
+    {9, 25, 0, 1},
+    {9, 26, 0, 1},
+    {9, 27, 0, 1},
+    {9, 28, 0, 1},
+    {9, 29, 0, 1},
+    {9, 30, 0, 1},
+    {9, 31, 0, 1},
+    {9, 32, 0, 1},
+    {58, 33, 0, 1},
+    {58, 34, 0, 1},
+    {58, 35, 0, 1},
+    {9, 36, 0, 1},
+    {9, 37, 0, 1},
+    {9, 38, 0, 1},
+    {9, 39, 0, 1},
+    {9, 40, 0, 1},
+    {9, 41, 0, 1},
+    {66, 42, 0, 1},
+    {66, 43, 0, 1},
+    {66, 44, 0, 1},
+    {66, 45, 0, 1},
+    {2049, 46, 0, 1},
+    {2049, 47, 0, 1},
+    {2049, 48, 0, 1},
+    {2049, 49, 0, 1},
+    {2012, 50, 0, 1},
+    {2012, 51, 0, 1},
+    {2012, 52, 0, 1},
+    {2012, 53, 0, 1},
+    {2012, 54, 0, 1},
+    {2012, 55, 0, 1},
+    {2012, 56, 0, 1},
+    {2012, 57, 0, 1},
+    {2012, 58, 0, 1},
+    {2012, 59, 0, 1},
+    {2012, 60, 0, 1},
+    {2012, 61, 0, 1},
+    {2012, 62, 0, 1},
+    {2012, 63, 0, 1},
+    {2012, 64, 0, 1},
+    {2012, 65, 0, 1},
+    {2012, 66, 0, 1},
+    {2012, 67, 0, 1},
+    {2012, 68, 0, 1},
+    {2012, 69, 0, 1},
+    {82, 70, 0, 0},
+    {3001, 71, 0, 1},
+    {3001, 72, 0, 1},
+    {3001, 73, 0, 1},
+    {73, 74, 0, 1},
+    {79, 75, 0, 1},
+    {2003, 76, 0, 0},
+    {3001, 77, 0, 1},
+    {3001, 78, 0, 1},
+    {3001, 79, 0, 1},
+    {3001, 80, 0, 1},
+    {3001, 81, 0, 1},
+    {3001, 82, 0, 1},
+    {3001, 83, 0, 1},
+    {3001, 84, 0, 1},
+    {3001, 85, 0, 1},
+    {67, 86, 0, 1},
+    {67, 87, 0, 1},
+    {3001, 88, 0, 1},
+    {3001, 89, 0, 1},
+    {3001, 90, 0, 1},
+    {3001, 91, 0, 1},
+    {3001, 92, 0, 1},
+    {3001, 93, 0, 1},
+    {3001, 94, 0, 1},
+    {3001, 95, 0, 1},
+    {3001, 96, 0, 1},
+    {3001, 97, 0, 1},
+    {3001, 98, 0, 1},
+    {3001, 99, 0, 1},
+    {3001, 100, 0, 1},
+    {3001, 101, 0, 1},
+    {3001, 102, 0, 1},
+    {3001, 103, 0, 1},
+    {3001, 104, 0, 1},
+    {3001, 105, 0, 1},
+    {3001, 106, 0, 1},
+    {3001, 107, 0, 1},
+    {39, 108, 0, 0},
+    {8, 109, 0, 0},
+    {71, 110, 0, 1},
+    {71, 111, 0, 1},
+    {83, 112, 0, 0},
+    {2014, 113, 0, 1},
+    {2014, 114, 0, 1},
+    {2014, 115, 0, 1},
+    {2014, 116, 0, 1},
+    {2014, 117, 0, 1},
+    {2014, 118, 0, 1},
+    {2014, 119, 0, 1},
+    {2014, 120, 0, 1},
+    {2014, 121, 0, 1},
+    {2014, 122, 0, 1},
+    {2014, 123, 0, 1},
+    {2014, 124, 0, 1},
+    {2014, 125, 0, 1},
+    {2014, 126, 0, 1},
+    {2014, 127, 0, 1},
+    {2014, 128, 0, 1},
+    {11, 129, 0, 1},
+    {3001, 130, 0, 1},
+    {3001, 131, 0, 1},
+    {3001, 132, 0, 1},
+    {3001, 133, 0, 1},
+    {3001, 134, 0, 1},
+    {3001, 135, 0, 1},
+    {3001, 136, 0, 1},
+    {3001, 137, 0, 1},
+    {3001, 138, 0, 1},
+    {3001, 139, 0, 1},
+    {3001, 140, 0, 1},
+    {69, 141, 0, 1},
+    {69, 142, 0, 1},
+    {69, 143, 0, 1},
+    {69, 144, 0, 1},
+    {3001, 145, 0, 1},
+    {3001, 146, 0, 1},
+    {3001, 147, 0, 1},
+    {3001, 148, 0, 1},
+    {3001, 149, 0, 1},
+    {3001, 150, 0, 1},
+    {3001, 151, 0, 1},
+    {67, 152, 0, 1},
+    {2035, 153, 0, 1},
+    {2035, 154, 0, 1},
+    {2035, 155, 0, 1},
+    {2035, 156, 0, 1},
+    {2035, 157, 0, 1},
+    {3001, 158, 0, 1},
+    {3001, 159, 0, 1},
+    {3001, 160, 0, 1},
+    {3001, 161, 0, 1},
+    {3001, 162, 0, 1},
+    {3001, 163, 0, 1},
+    {3001, 164, 0, 1},
+    {3001, 165, 0, 1},
+    {3001, 166, 0, 1},
+    {3001, 167, 0, 1},
+    {3001, 168, 0, 1},
+    {3001, 169, 0, 1},
+    {69, 170, 0, 1},
+    {3001, 171, 0, 1},
+    {3001, 172, 0, 1},
+    {3001, 173, 0, 1},
+    {3001, 174, 0, 1},
+    {3001, 175, 0, 1},
+    {69, 176, 0, 1},
+    {65, 177, 0, 1},
+    {65, 178, 0, 1},
+    {65, 179, 0, 1},
+    {65, 180, 0, 1},
+    {65, 181, 0, 1},
+    {65, 182, 0, 1},
+    {65, 183, 0, 1},
+    {65, 184, 0, 1},
+    {65, 185, 0, 1},
+    {65, 186, 0, 1},
+    {65, 187, 0, 1},
+    {2002, 188, 0, 1},
+    {2046, 189, 0, 1},
+    {2025, 190, 0, 1},
+    {2025, 191, 0, 1},
+    {2025, 192, 0, 1},
+    {2025, 193, 0, 1},
+    {2022, 194, 0, 0},
+    {2010, 195, 0, 1},
+    {2010, 196, 0, 1},
+    {2010, 197, 0, 1},
+    {2010, 198, 0, 1},
+    {40, 199, 0, 0},
+    {3001, 200, 0, 1},
+    {3001, 201, 0, 1},
+    {3001, 202, 0, 1},
+    {2035, 203, 0, 1},
+    {3001, 204, 0, 1},
+    {3001, 205, 0, 1},
+    {3001, 206, 0, 1},
+    {3001, 207, 0, 1},
+    {3001, 208, 0, 1},
+    {3001, 209, 0, 1},
+    {3001, 210, 0, 1},
+    {3001, 211, 0, 1},
+    {3001, 212, 0, 1},
+    {3001, 213, 0, 1},
+    {2010, 214, 0, 1},
+    {38, 215, 0, 0},
+    {2010, 216, 0, 1},
+};
+
+
+static const ap_thing_info_t ap_doom2_thing_infos_e3m2[] = 
+{
+    {2, 0, 0, 1},
+    {3, 1, 0, 1},
+    {4, 2, 0, 1},
+    {1, 3, 0, 1},
+    {2003, 4, 0, 0},
+    {40, 5, 0, 0},
+    {14, 6, 0, 1},
+    {46, 7, 0, 1},
+    {41, 8, 0, 1},
+    {65, 9, 0, 1},
+    {65, 10, 0, 1},
+    {3002, 11, 0, 1},
+    {38, 12, 0, 0},
+    {69, 13, 0, 1},
+    {2049, 14, 0, 1},
+    {2012, 15, 0, 1},
+    {3001, 16, 0, 1},
+    {3001, 17, 0, 1},
+    {3001, 18, 0, 1},
+    {3001, 19, 0, 1},
+    {3001, 20, 0, 1},
+    {3001, 21, 0, 1},
+    {65, 22, 0, 1},
+    {65, 23, 0, 1},
+    {2011, 24, 0, 1},
+    {2011, 25, 0, 1},
+    {65, 26, 0, 1},
+    {65, 27, 0, 1},
+    {2001, 28, 0, 0},
+    {32, 29, 0, 1},
+    {32, 30, 0, 1},
+    {2046, 31, 0, 1},
+    {2008, 32, 0, 1},
+    {3001, 33, 0, 1},
+    {2012, 34, 0, 1},
+    {14, 35, 0, 1},
+    {2012, 36, 0, 1},
+    {2012, 37, 0, 1},
+    {3001, 38, 0, 1},
+    {3001, 39, 0, 1},
+    {3001, 40, 0, 1},
+    {3001, 41, 0, 1},
+    {2048, 42, 0, 1},
+    {2008, 43, 0, 1},
+    {2008, 44, 0, 1},
+    {2023, 45, 0, 0},
+    {2025, 46, 0, 1},
+    {65, 47, 0, 1},
+    {65, 48, 0, 1},
+    {31, 49, 0, 1},
+    {2015, 50, 0, 1},
+    {2015, 51, 0, 1},
+    {2015, 52, 0, 1},
+    {2015, 53, 0, 1},
+    {2015, 54, 0, 1},
+    {32, 55, 0, 1},
+    {32, 56, 0, 1},
+    {46, 57, 0, 1},
+    {46, 58, 0, 1},
+    {45, 59, 0, 1},
+    {46, 60, 0, 1},
+    {46, 61, 0, 1},
+    {46, 62, 0, 1},
+    {46, 63, 0, 1},
+    {46, 64, 0, 1},
+    {46, 65, 0, 1},
+    {46, 66, 0, 1},
+    {46, 67, 0, 1},
+    {65, 68, 0, 1},
+    {65, 69, 0, 1},
+    {65, 70, 0, 1},
+    {65, 71, 0, 1},
+    {65, 72, 0, 1},
+    {14, 73, 0, 1},
+    {65, 74, 0, 1},
+    {65, 75, 0, 1},
+    {11, 76, 0, 1},
+    {11, 77, 0, 1},
+    {11, 78, 0, 1},
+    {11, 79, 0, 1},
+    {2003, 80, 0, 1},
+    {2013, 81, 0, 1},
+    {11, 82, 0, 1},
+    {2004, 83, 0, 0},
+    {3003, 84, 0, 1},
+    {3002, 85, 0, 1},
+    {3001, 86, 0, 1},
+    {3001, 87, 0, 1},
+    {3001, 88, 0, 1},
+    {3001, 89, 0, 1},
+    {2025, 90, 0, 1},
+    {65, 91, 0, 1},
+    {65, 92, 0, 1},
+    {65, 93, 0, 1},
+    {65, 94, 0, 1},
+    {3002, 95, 0, 1},
+    {65, 96, 0, 1},
+    {65, 97, 0, 1},
+    {3001, 98, 0, 1},
+    {65, 99, 0, 1},
+    {65, 100, 0, 1},
+    {65, 101, 0, 1},
+    {65, 102, 0, 1},
+    {3002, 103, 0, 1},
+    {58, 104, 0, 1},
+    {58, 105, 0, 1},
+    {58, 106, 0, 1},
+    {3001, 107, 0, 1},
+    {3001, 108, 0, 1},
+    {58, 109, 0, 1},
+    {58, 110, 0, 1},
+    {58, 111, 0, 1},
+    {58, 112, 0, 1},
+    {66, 113, 0, 1},
+    {66, 114, 0, 1},
+    {2049, 115, 0, 1},
+    {79, 116, 0, 1},
+    {79, 117, 0, 1},
+    {2013, 118, 0, 0},
+    {2018, 119, 0, 0},
+    {17, 120, 0, 1},
+};
+
+
+static const ap_thing_info_t ap_doom2_thing_infos_e3m3[] = 
+{
+    {1, 0, 0, 1},
+    {2, 1, 0, 1},
+    {3, 2, 0, 1},
+    {4, 3, 0, 1},
+    {2035, 4, 0, 1},
+    {2035, 5, 0, 1},
+    {2035, 6, 0, 1},
+    {2035, 7, 0, 1},
+    {2035, 8, 0, 1},
+    {2035, 9, 0, 1},
+    {2035, 10, 0, 1},
+    {2035, 11, 0, 1},
+    {2035, 12, 0, 1},
+    {2035, 13, 0, 1},
+    {2035, 14, 0, 1},
+    {2035, 15, 0, 1},
+    {2035, 16, 0, 1},
+    {2035, 17, 0, 1},
+    {2035, 18, 0, 1},
+    {2035, 19, 0, 1},
+    {2035, 20, 0, 1},
+    {2035, 21, 0, 1},
+    {2035, 22, 0, 1},
+    {2035, 23, 0, 1},
+    {2035, 24, 0, 1},
+    {2035, 25, 0, 1},
+    {2035, 26, 0, 1},
+    {2035, 27, 0, 1},
+    {2035, 28, 0, 1},
+    {2035, 29, 0, 1},
+    {2035, 30, 0, 1},
+    {2035, 31, 0, 1},
+    {2035, 32, 0, 1},
+    {2035, 33, 0, 1},
+    {2035, 34, 0, 1},
+    {2035, 35, 0, 1},
+    {2035, 36, 0, 1},
+    {2035, 37, 0, 1},
+    {2035, 38, 0, 1},
+    {2035, 39, 0, 1},
+    {2035, 40, 0, 1},
+    {2035, 41, 0, 1},
+    {2035, 42, 0, 1},
+    {2035, 43, 0, 1},
+    {2035, 44, 0, 1},
+    {2035, 45, 0, 1},
+    {2035, 46, 0, 1},
+    {2035, 47, 0, 1},
+    {2035, 48, 0, 1},
+    {2035, 49, 0, 1},
+    {2035, 50, 0, 1},
+    {2035, 51, 0, 1},
+    {67, 52, 0, 1},
+    {2035, 53, 0, 1},
+    {2035, 54, 0, 1},
+    {2035, 55, 0, 1},
+    {2035, 56, 0, 1},
+    {2035, 57, 0, 1},
+    {2035, 58, 0, 1},
+    {2035, 59, 0, 1},
+    {2035, 60, 0, 1},
+    {2035, 61, 0, 1},
+    {2035, 62, 0, 1},
+    {2035, 63, 0, 1},
+    {2035, 64, 0, 1},
+    {2035, 65, 0, 1},
+    {2035, 66, 0, 1},
+    {2035, 67, 0, 1},
+    {2035, 68, 0, 1},
+    {2035, 69, 0, 1},
+    {2035, 70, 0, 1},
+    {2035, 71, 0, 1},
+    {2035, 72, 0, 1},
+    {2035, 73, 0, 1},
+    {2035, 74, 0, 1},
+    {2035, 75, 0, 1},
+    {2035, 76, 0, 1},
+    {2035, 77, 0, 1},
+    {70, 78, 0, 1},
+    {2035, 79, 0, 1},
+    {2035, 80, 0, 1},
+    {2035, 81, 0, 1},
+    {2035, 82, 0, 1},
+    {2035, 83, 0, 1},
+    {2035, 84, 0, 1},
+    {2035, 85, 0, 1},
+    {2035, 86, 0, 1},
+    {2035, 87, 0, 1},
+    {2035, 88, 0, 1},
+    {2035, 89, 0, 1},
+    {2035, 90, 0, 1},
+    {2035, 91, 0, 1},
+    {2035, 92, 0, 1},
+    {2035, 93, 0, 1},
+    {2035, 94, 0, 1},
+    {65, 95, 0, 1},
+    {65, 96, 0, 1},
+    {65, 97, 0, 1},
+    {65, 98, 0, 1},
+    {65, 99, 0, 1},
+    {65, 100, 0, 1},
+    {65, 101, 0, 1},
+    {65, 102, 0, 1},
+    {65, 103, 0, 1},
+    {65, 104, 0, 1},
+    {65, 105, 0, 1},
+    {65, 106, 0, 1},
+    {2035, 107, 0, 1},
+    {2035, 108, 0, 1},
+    {2035, 109, 0, 1},
+    {2035, 110, 0, 1},
+    {2035, 111, 0, 1},
+    {2035, 112, 0, 1},
+    {2035, 113, 0, 1},
+    {2035, 114, 0, 1},
+    {2035, 115, 0, 1},
+    {2035, 116, 0, 1},
+    {2035, 117, 0, 1},
+    {2035, 118, 0, 1},
+    {2035, 119, 0, 1},
+    {2035, 120, 0, 1},
+    {2035, 121, 0, 1},
+    {2035, 122, 0, 1},
+    {2035, 123, 0, 1},
+    {2035, 124, 0, 1},
+    {2035, 125, 0, 1},
+    {2035, 126, 0, 1},
+    {2035, 127, 0, 1},
+    {2035, 128, 0, 1},
+    {2035, 129, 0, 1},
+    {2035, 130, 0, 1},
+    {2035, 131, 0, 1},
+    {2035, 132, 0, 1},
+    {14, 133, 0, 1},
+    {2035, 134, 0, 1},
+    {2035, 135, 0, 1},
+    {2001, 136, 0, 0},
+    {2035, 137, 0, 1},
+    {2035, 138, 0, 1},
+    {2035, 139, 0, 1},
+    {2035, 140, 0, 1},
+    {2008, 141, 0, 1},
+    {2008, 142, 0, 1},
+    {2008, 143, 0, 1},
+    {2008, 144, 0, 1},
+    {2008, 145, 0, 1},
+    {2008, 146, 0, 1},
+    {2008, 147, 0, 1},
+    {2008, 148, 0, 1},
+    {14, 149, 0, 1},
+    {70, 150, 0, 1},
+    {70, 151, 0, 1},
+    {70, 152, 0, 1},
+    {70, 153, 0, 1},
+    {70, 154, 0, 1},
+    {70, 155, 0, 1},
+    {70, 156, 0, 1},
+    {70, 157, 0, 1},
+    {70, 158, 0, 1},
+    {70, 159, 0, 1},
+    {2035, 160, 0, 1},
+    {2035, 161, 0, 1},
+    {2035, 162, 0, 1},
+    {2035, 163, 0, 1},
+    {2035, 164, 0, 1},
+    {2035, 165, 0, 1},
+    {2035, 166, 0, 1},
+    {2035, 167, 0, 1},
+    {2035, 168, 0, 1},
+    {71, 169, 0, 1},
+    {71, 170, 0, 1},
+    {71, 171, 0, 1},
+    {71, 172, 0, 1},
+    {71, 173, 0, 1},
+    {2035, 174, 0, 1},
+    {2035, 175, 0, 1},
+    {2035, 176, 0, 1},
+    {2035, 177, 0, 1},
+    {2035, 178, 0, 1},
+    {2035, 179, 0, 1},
+    {3001, 180, 0, 1},
+    {3001, 181, 0, 1},
+    {3001, 182, 0, 1},
+    {3001, 183, 0, 1},
+    {3001, 184, 0, 1},
+    {3001, 185, 0, 1},
+    {3001, 186, 0, 1},
+    {3001, 187, 0, 1},
+    {3001, 188, 0, 1},
+    {3001, 189, 0, 1},
+    {3001, 190, 0, 1},
+    {3001, 191, 0, 1},
+    {3001, 192, 0, 1},
+    {3001, 193, 0, 1},
+    {71, 194, 0, 1},
+    {69, 195, 0, 1},
+    {69, 196, 0, 1},
+    {2035, 197, 0, 1},
+    {2035, 198, 0, 1},
+    {2035, 199, 0, 1},
+    {2035, 200, 0, 1},
+    {2035, 201, 0, 1},
+    {2035, 202, 0, 1},
+    {2035, 203, 0, 1},
+    {2035, 204, 0, 1},
+    {2035, 205, 0, 1},
+    {69, 206, 0, 1},
+    {69, 207, 0, 1},
+    {69, 208, 0, 1},
+    {69, 209, 0, 1},
+    {69, 210, 0, 1},
+    {69, 211, 0, 1},
+    {69, 212, 0, 1},
+    {2035, 213, 0, 1},
+    {2035, 214, 0, 1},
+    {2035, 215, 0, 1},
+    {2035, 216, 0, 1},
+    {2035, 217, 0, 1},
+    {2035, 218, 0, 1},
+    {2035, 219, 0, 1},
+    {2035, 220, 0, 1},
+    {2002, 221, 0, 1},
+    {2023, 222, 0, 0},
+    {8, 223, 0, 0},
+    {2026, 224, 0, 0},
+    {42, 225, 0, 1},
+    {42, 226, 0, 1},
+    {55, 227, 0, 1},
+    {55, 228, 0, 1},
+    {3002, 229, 0, 1},
+    {3002, 230, 0, 1},
+    {3002, 231, 0, 1},
+    {3002, 232, 0, 1},
+    {3002, 233, 0, 1},
+    {3002, 234, 0, 1},
+    {3002, 235, 0, 1},
+    {3002, 236, 0, 1},
+    {3002, 237, 0, 1},
+    {3002, 238, 0, 1},
+    {3002, 239, 0, 1},
+    {3002, 240, 0, 1},
+    {3002, 241, 0, 1},
+    {3002, 242, 0, 1},
+    {3002, 243, 0, 1},
+    {3002, 244, 0, 1},
+    {2048, 245, 0, 1},
+    {2048, 246, 0, 1},
+    {2049, 247, 0, 1},
+    {2049, 248, 0, 1},
+    {2018, 249, 0, 0},
+    {2012, 250, 0, 1},
+    {2012, 251, 0, 1},
+    {64, 252, 0, 1},
+    {3001, 253, 0, 1},
+    {65, 254, 0, 1},
+    {65, 255, 0, 1},
+    {65, 256, 0, 1},
+    {3001, 257, 0, 1},
+    {3001, 258, 0, 1},
+    {3001, 259, 0, 1},
+    {14, 260, 0, 1},
+    {14, 261, 0, 1},
+    {2046, 262, 0, 1},
+    {2046, 263, 0, 1},
+    {2003, 264, 0, 0},
+    {2010, 265, 0, 1},
+    {83, 266, 0, 0},
+    {2046, 267, 0, 1},
+    {2046, 268, 0, 1},
+    {2046, 269, 0, 1},
+    {2046, 270, 0, 1},
+    {2046, 271, 0, 1},
+    {2046, 272, 0, 1},
+    {2046, 273, 0, 1},
+    {2046, 274, 0, 1},
+    {2012, 275, 0, 1},
+    {2012, 276, 0, 1},
+    {2013, 277, 0, 0},
+    {3001, 278, 0, 1},
+    {3001, 279, 0, 1},
+    {3001, 280, 0, 1},
+    {3001, 281, 0, 1},
+    {3001, 282, 0, 1},
+    {3001, 283, 0, 1},
+    {3001, 284, 0, 1},
+    {3001, 285, 0, 1},
+    {3001, 286, 0, 1},
+    {3001, 287, 0, 1},
+    {3001, 288, 0, 1},
+    {3001, 289, 0, 1},
+    {3001, 290, 0, 1},
+    {3001, 291, 0, 1},
+    {3001, 292, 0, 1},
+    {3001, 293, 0, 1},
+    {3001, 294, 0, 1},
+    {7, 295, 0, 1},
+    {68, 296, 0, 1},
+    {68, 297, 0, 1},
+    {68, 298, 0, 1},
+    {68, 299, 0, 1},
+    {68, 300, 0, 1},
+    {8, 301, 0, 0},
+    {2046, 302, 0, 1},
+    {2046, 303, 0, 1},
+    {2046, 304, 0, 1},
+    {2046, 305, 0, 1},
+    {2046, 306, 0, 1},
+    {39, 307, 0, 0},
+    {2011, 308, 0, 1},
+    {2011, 309, 0, 1},
+    {2011, 310, 0, 1},
+    {2011, 311, 0, 1},
+    {2011, 312, 0, 1},
+    {2011, 313, 0, 1},
+    {2011, 314, 0, 1},
+    {2011, 315, 0, 1},
+    {2011, 316, 0, 1},
+    {2011, 317, 0, 1},
+    {2011, 318, 0, 1},
+    {2011, 319, 0, 1},
+    {2011, 320, 0, 1},
+    {2011, 321, 0, 1},
+    {2011, 322, 0, 1},
+    {66, 323, 0, 1},
+    {64, 324, 0, 1},
+    {66, 325, 0, 1},
+    {66, 326, 0, 1},
+    {66, 327, 0, 1},
+    {3002, 328, 0, 1},
+    {3002, 329, 0, 1},
+    {3002, 330, 0, 1},
+    {3002, 331, 0, 1},
+    {3002, 332, 0, 1},
+    {3002, 333, 0, 1},
+    {3002, 334, 0, 1},
+    {3002, 335, 0, 1},
+    {3002, 336, 0, 1},
+    {3002, 337, 0, 1},
+    {3002, 338, 0, 1},
+    {3002, 339, 0, 1},
+    {68, 340, 0, 1},
+    {68, 341, 0, 1},
+    {2006, 342, 0, 0},
+    {2012, 343, 0, 1},
+    {2014, 344, 0, 1},
+    {2014, 345, 0, 1},
+    {2014, 346, 0, 1},
+    {2014, 347, 0, 1},
+    {2014, 348, 0, 1},
+    {2014, 349, 0, 1},
+    {2014, 350, 0, 1},
+    {2014, 351, 0, 1},
+    {2014, 352, 0, 1},
+    {2014, 353, 0, 1},
+    {2014, 354, 0, 1},
+    {2014, 355, 0, 1},
+    {2014, 356, 0, 1},
+    {2014, 357, 0, 1},
+    {2014, 358, 0, 1},
+    {2014, 359, 0, 1},
+    {2014, 360, 0, 1},
+    {2014, 361, 0, 1},
+    {2047, 362, 0, 1},
+    {65, 363, 0, 1},
+    {65, 364, 0, 1},
+    {2035, 365, 0, 1},
+    {2035, 366, 0, 1},
+    {2035, 367, 0, 1},
+    {2035, 368, 0, 1},
+    {2035, 369, 0, 1},
+    {2035, 370, 0, 1},
+    {2035, 371, 0, 1},
+    {2035, 372, 0, 1},
+    {2035, 373, 0, 1},
+    {2035, 374, 0, 1},
+    {2035, 375, 0, 1},
+    {2035, 376, 0, 1},
+    {2035, 377, 0, 1},
+    {2035, 378, 0, 1},
+    {2035, 379, 0, 1},
+    {2035, 380, 0, 1},
+    {2035, 381, 0, 1},
+    {2035, 382, 0, 1},
+    {2035, 383, 0, 1},
+    {2035, 384, 0, 1},
+    {2035, 385, 0, 1},
+    {2035, 386, 0, 1},
+    {2035, 387, 0, 1},
+    {2035, 388, 0, 1},
+    {2035, 389, 0, 1},
+    {14, 390, 0, 1},
+    {14, 391, 0, 1},
+    {2035, 392, 0, 1},
+    {2035, 393, 0, 1},
+    {2035, 394, 0, 1},
+    {2035, 395, 0, 1},
+    {2035, 396, 0, 1},
+    {2035, 397, 0, 1},
+    {2035, 398, 0, 1},
+    {2035, 399, 0, 1},
+    {2035, 400, 0, 1},
+    {2035, 401, 0, 1},
+    {2035, 402, 0, 1},
+    {2035, 403, 0, 1},
+    {2035, 404, 0, 1},
+    {2035, 405, 0, 1},
+    {2035, 406, 0, 1},
+    {2035, 407, 0, 1},
+    {2035, 408, 0, 1},
+    {2035, 409, 0, 1},
+    {2035, 410, 0, 1},
+    {2035, 411, 0, 1},
+    {2035, 412, 0, 1},
+    {2035, 413, 0, 1},
+    {2035, 414, 0, 1},
+    {2035, 415, 0, 1},
+    {11, 416, 0, 1},
+    {11, 417, 0, 1},
+    {11, 418, 0, 1},
+    {11, 419, 0, 1},
+    {11, 420, 0, 1},
+    {11, 421, 0, 1},
+    {11, 422, 0, 1},
+    {2046, 423, 0, 1},
+    {2035, 424, 0, 1},
+    {2035, 425, 0, 1},
+    {2035, 426, 0, 1},
+    {2035, 427, 0, 1},
+    {2035, 428, 0, 1},
+    {2035, 429, 0, 1},
+    {14, 430, 0, 1},
+};
+
+
+static const ap_thing_info_t ap_doom2_thing_infos_e3m4[] = 
+{
+    {1, 0, 0, 1},
+    {2, 1, 0, 1},
+    {3, 2, 0, 1},
+    {4, 3, 0, 1},
+    {11, 4, 0, 1},
+    {2004, 5, 0, 0},
+    {2001, 6, 0, 0},
+    {3005, 7, 0, 1},
+    {3005, 8, 0, 1},
+    {3005, 9, 0, 1},
+    {3005, 10, 0, 1},
+    {2010, 11, 0, 1},
+    {2022, 12, 0, 0},
+    {2012, 13, 0, 1},
+    {3001, 14, 0, 1},
+    {3001, 15, 0, 1},
+    {3001, 16, 0, 1},
+    {3001, 17, 0, 1},
+    {3001, 18, 0, 1},
+    {3001, 19, 0, 1},
+    {3001, 20, 0, 1},
+    {3001, 21, 0, 1},
+    {2003, 22, 0, 0},
+    {5, 23, 0, 0},
+    {2010, 24, 0, 1},
+    {2011, 25, 0, 1},
+    {2046, 26, 0, 1},
+    {2011, 27, 0, 1},
+    {2011, 28, 0, 1},
+    {2046, 29, 0, 1},
+    {2046, 30, 0, 1},
+    {8, 31, 0, 0},
+    {2012, 32, 0, 1},
+    {2012, 33, 0, 1},
+    {2046, 34, 0, 1},
+    {2010, 35, 0, 1},
+    {2010, 36, 0, 1},
+    {2010, 37, 0, 1},
+    {2010, 38, 0, 1},
+    {2010, 39, 0, 1},
+    {2007, 40, 0, 1},
+    {2011, 41, 0, 1},
+    {2011, 42, 0, 1},
+    {3001, 43, 0, 1},
+    {3001, 44, 0, 1},
+    {3005, 45, 0, 1},
+    {3001, 46, 0, 1},
+    {3001, 47, 0, 1},
+    {3001, 48, 0, 1},
+    {3001, 49, 0, 1},
+    {3001, 50, 0, 1},
+    {3001, 51, 0, 1},
+    {3001, 52, 0, 1},
+    {3001, 53, 0, 1},
+    {3001, 54, 0, 1},
+    {3001, 55, 0, 1},
+    {3001, 56, 0, 1},
+    {3001, 57, 0, 1},
+    {3001, 58, 0, 1},
+    {2008, 59, 0, 1},
+    {14, 60, 0, 1},
+    {2025, 61, 0, 1},
+    {69, 62, 0, 1},
+    {3005, 63, 0, 1},
+    {65, 64, 0, 1},
+    {65, 65, 0, 1},
+    {65, 66, 0, 1},
+    {65, 67, 0, 1},
+    {65, 68, 0, 1},
+    {65, 69, 0, 1},
+    {65, 70, 0, 1},
+    {65, 71, 0, 1},
+    {65, 72, 0, 1},
+    {65, 73, 0, 1},
+    {14, 74, 0, 1},
+    {14, 75, 0, 1},
+    {2011, 76, 0, 1},
+    {2010, 77, 0, 1},
+    {2049, 78, 0, 1},
+    {2023, 79, 0, 0},
+    {3002, 80, 0, 1},
+    {3002, 81, 0, 1},
+    {3002, 82, 0, 1},
+    {3002, 83, 0, 1},
+    {58, 84, 0, 1},
+    {3002, 85, 0, 1},
+    {3002, 86, 0, 1},
+    {58, 87, 0, 1},
+    {58, 88, 0, 1},
+    {58, 89, 0, 1},
+    {2011, 90, 0, 1},
+    {2011, 91, 0, 1},
+    {2011, 92, 0, 1},
+    {2011, 93, 0, 1},
+    {2011, 94, 0, 1},
+    {14, 95, 0, 1},
+    {3002, 96, 0, 1},
+    {3002, 97, 0, 1},
+    {3002, 98, 0, 1},
+    {3002, 99, 0, 1},
+    {3002, 100, 0, 1},
+    {3002, 101, 0, 1},
+    {3002, 102, 0, 1},
+    {3002, 103, 0, 1},
+    {3002, 104, 0, 1},
+    {3002, 105, 0, 1},
+    {3002, 106, 0, 1},
+    {3002, 107, 0, 1},
+    {3002, 108, 0, 1},
+    {2047, 109, 0, 1},
+    {2046, 110, 0, 1},
+    {2049, 111, 0, 1},
+    {2048, 112, 0, 1},
+    {2012, 113, 0, 1},
+    {2012, 114, 0, 1},
+    {2002, 115, 0, 1},
+    {51, 116, 0, 1},
+    {14, 117, 0, 1},
+    {2011, 118, 0, 1},
+    {3001, 119, 0, 1},
+    {3001, 120, 0, 1},
+    {3001, 121, 0, 1},
+    {3001, 122, 0, 1},
+    {3001, 123, 0, 1},
+    {3001, 124, 0, 1},
+    {3001, 125, 0, 1},
+    {3001, 126, 0, 1},
+    {3001, 127, 0, 1},
+    {3001, 128, 0, 1},
+    {3001, 129, 0, 1},
+    {3001, 130, 0, 1},
+    {3001, 131, 0, 1},
+    {3001, 132, 0, 1},
+    {3001, 133, 0, 1},
+    {3001, 134, 0, 1},
+    {3001, 135, 0, 1},
+    {3001, 136, 0, 1},
+    {3001, 137, 0, 1},
+    {3001, 138, 0, 1},
+    {3001, 139, 0, 1},
+    {3001, 140, 0, 1},
+    {3001, 141, 0, 1},
+    {65, 142, 0, 1},
+    {2002, 143, 0, 1},
+    {2048, 144, 0, 1},
+    {2046, 145, 0, 1},
+    {2046, 146, 0, 1},
+    {2008, 147, 0, 1},
+    {2008, 148, 0, 1},
+    {2012, 149, 0, 1},
+    {69, 150, 0, 1},
+    {69, 151, 0, 1},
+    {2049, 152, 0, 1},
+    {67, 153, 0, 1},
+    {67, 154, 0, 1},
+    {2023, 155, 0, 0},
+    {3002, 156, 0, 1},
+    {3002, 157, 0, 1},
+    {3002, 158, 0, 1},
+    {3002, 159, 0, 1},
+    {3002, 160, 0, 1},
+    {3002, 161, 0, 1},
+    {58, 162, 0, 1},
+    {58, 163, 0, 1},
+    {58, 164, 0, 1},
+    {58, 165, 0, 1},
+    {2010, 166, 0, 1},
+    {2010, 167, 0, 1},
+    {2010, 168, 0, 1},
+    {2018, 169, 0, 0},
+    {65, 170, 0, 1},
+    {65, 171, 0, 1},
+    {2014, 172, 0, 1},
+    {2014, 173, 0, 1},
+    {2014, 174, 0, 1},
+    {2014, 175, 0, 1},
+    {2014, 176, 0, 1},
+    {2014, 177, 0, 1},
+    {2014, 178, 0, 1},
+    {2014, 179, 0, 1},
+    {2014, 180, 0, 1},
+    {2014, 181, 0, 1},
+    {2014, 182, 0, 1},
+    {2014, 183, 0, 1},
+    {2015, 184, 0, 1},
+    {2015, 185, 0, 1},
+    {2015, 186, 0, 1},
+    {2015, 187, 0, 1},
+    {2015, 188, 0, 1},
+    {2015, 189, 0, 1},
+    {2012, 190, 0, 1},
+    {2012, 191, 0, 1},
+    {2012, 192, 0, 1},
+    {45, 193, 0, 1},
+    {45, 194, 0, 1},
+    {55, 195, 0, 1},
+    {2014, 196, 0, 1},
+    {2014, 197, 0, 1},
+    {2011, 198, 0, 1},
+    {2015, 199, 0, 1},
+    {2015, 200, 0, 1},
+    {2015, 201, 0, 1},
+    {2015, 202, 0, 1},
+    {2015, 203, 0, 1},
+    {2015, 204, 0, 1},
+    {2015, 205, 0, 1},
+    {2007, 206, 0, 1},
+    {2010, 207, 0, 1},
+    {2015, 208, 0, 1},
+    {2014, 209, 0, 1},
+    {65, 210, 0, 1},
+    {65, 211, 0, 1},
+    {65, 212, 0, 1},
+    {65, 213, 0, 1},
+    {65, 214, 0, 1},
+    {65, 215, 0, 1},
+    {2011, 216, 0, 1},
+    {2008, 217, 0, 1},
+    {2015, 218, 0, 1},
+    {2015, 219, 0, 1},
+    {65, 220, 0, 1},
+    {65, 221, 0, 1},
+    {2015, 222, 0, 1},
+    {65, 223, 0, 1},
+    {65, 224, 0, 1},
+    {2008, 225, 0, 1},
+    {65, 226, 0, 1},
+    {65, 227, 0, 1},
+    {2015, 228, 0, 1},
+    {69, 229, 0, 1},
+    {69, 230, 0, 1},
+    {2025, 231, 0, 1},
+    {2025, 232, 0, 1},
+    {2025, 233, 0, 1},
+    {3002, 234, 0, 1},
+    {3002, 235, 0, 1},
+    {3002, 236, 0, 1},
+    {3002, 237, 0, 1},
+    {3002, 238, 0, 1},
+    {3002, 239, 0, 1},
+    {69, 240, 0, 1},
+    {3005, 241, 0, 1},
+    {3005, 242, 0, 1},
+    {3005, 243, 0, 1},
+    {3006, 244, 0, 1},
+    {3006, 245, 0, 1},
+    {3006, 246, 0, 1},
+    {3006, 247, 0, 1},
+    {3006, 248, 0, 1},
+    {3006, 249, 0, 1},
+    {3006, 250, 0, 1},
+    {3006, 251, 0, 1},
+    {3006, 252, 0, 1},
+    {3006, 253, 0, 1},
+    {14, 254, 0, 1},
+    {3006, 255, 0, 1},
+    {3006, 256, 0, 1},
+    {3006, 257, 0, 1},
+    {3006, 258, 0, 1},
+    {3006, 259, 0, 1},
+    {3006, 260, 0, 1},
+    {13, 261, 0, 0},
+    {14, 262, 0, 1},
+    {14, 263, 0, 1},
+    {3002, 264, 0, 1},
+    {3002, 265, 0, 1},
+    {3002, 266, 0, 1},
+    {3002, 267, 0, 1},
+    {3002, 268, 0, 1},
+    {3002, 269, 0, 1},
+    {3002, 270, 0, 1},
+    {3002, 271, 0, 1},
+    {3002, 272, 0, 1},
+    {3002, 273, 0, 1},
+    {3002, 274, 0, 1},
+    {3002, 275, 0, 1},
+    {3002, 276, 0, 1},
+    {3002, 277, 0, 1},
+    {3002, 278, 0, 1},
+    {3002, 279, 0, 1},
+    {3002, 280, 0, 1},
+    {3002, 281, 0, 1},
+    {3002, 282, 0, 1},
+    {3002, 283, 0, 1},
+    {3002, 284, 0, 1},
+    {3002, 285, 0, 1},
+    {3002, 286, 0, 1},
+    {3002, 287, 0, 1},
+    {3002, 288, 0, 1},
+    {2007, 289, 0, 1},
+    {2012, 290, 0, 1},
+    {2012, 291, 0, 1},
+    {2008, 292, 0, 1},
+    {2048, 293, 0, 1},
+    {2049, 294, 0, 1},
+    {2006, 295, 0, 0},
+    {2049, 296, 0, 1},
+    {2046, 297, 0, 1},
+    {2014, 298, 0, 1},
+    {2014, 299, 0, 1},
+    {2014, 300, 0, 1},
+    {2014, 301, 0, 1},
+    {2014, 302, 0, 1},
+    {2014, 303, 0, 1},
+    {2014, 304, 0, 1},
+    {2014, 305, 0, 1},
+    {2014, 306, 0, 1},
+    {2014, 307, 0, 1},
+    {2010, 308, 0, 1},
+    {2007, 309, 0, 1},
+    {2007, 310, 0, 1},
+    {2046, 311, 0, 1},
+    {2047, 312, 0, 1},
+    {2008, 313, 0, 1},
+    {2010, 314, 0, 1},
+    {2008, 315, 0, 1},
+    {2008, 316, 0, 1},
+    {2008, 317, 0, 1},
+    {2008, 318, 0, 1},
+    {2008, 319, 0, 1},
+    {2010, 320, 0, 1},
+    {2010, 321, 0, 1},
+    {2007, 322, 0, 1},
+    {2010, 323, 0, 1},
+    {2010, 324, 0, 1},
+    {2008, 325, 0, 1},
+    {2011, 326, 0, 1},
+    {2011, 327, 0, 1},
+    {2011, 328, 0, 1},
+    {2007, 329, 0, 1},
+    {2008, 330, 0, 1},
+    {2010, 331, 0, 1},
+    {2010, 332, 0, 1},
+    {2011, 333, 0, 1},
+    {2007, 334, 0, 1},
+    {2007, 335, 0, 1},
+    {2010, 336, 0, 1},
+    {2025, 337, 0, 1},
+    {2011, 338, 0, 1},
+    {2007, 339, 0, 1},
+    {2025, 340, 0, 1},
+    {2047, 341, 0, 1},
+    {2010, 342, 0, 1},
+    {2010, 343, 0, 1},
+    {2008, 344, 0, 1},
+    {2010, 345, 0, 1},
+    {2025, 346, 0, 1},
+    {11, 347, 0, 1},
+    {11, 348, 0, 1},
+    {11, 349, 0, 1},
+    {11, 350, 0, 1},
+    {11, 351, 0, 1},
+    {2006, 352, 0, 1},
+    {82, 353, 0, 0},
+    {14, 354, 0, 1},
+    {83, 355, 0, 0},
+    {2010, 356, 0, 1},
+    {2010, 357, 0, 1},
+    {2010, 358, 0, 1},
+    {2010, 359, 0, 1},
+    {2048, 360, 0, 1},
+    {2048, 361, 0, 1},
+    {83, 362, 0, 0},
+    {2014, 363, 0, 1},
+};
+
+
+static const ap_thing_info_t ap_doom2_thing_infos_e3m5[] = 
+{
+    {46, 0, 0, 1},
+    {46, 1, 0, 1},
+    {46, 2, 0, 1},
+    {46, 3, 0, 1},
+    {71, 4, 0, 1},
+    {71, 5, 0, 1},
+    {82, 6, 0, 0},
+    {2024, 7, 0, 0},
+    {64, 8, 0, 1},
+    {65, 9, 0, 1},
+    {65, 10, 0, 1},
+    {65, 11, 0, 1},
+    {65, 12, 0, 1},
+    {3001, 13, 0, 1},
+    {3001, 14, 0, 1},
+    {3001, 15, 0, 1},
+    {3001, 16, 0, 1},
+    {3001, 17, 0, 1},
+    {3001, 18, 0, 1},
+    {45, 19, 0, 1},
+    {45, 20, 0, 1},
+    {45, 21, 0, 1},
+    {45, 22, 0, 1},
+    {83, 23, 0, 0},
+    {14, 24, 0, 1},
+    {1, 25, 0, 1},
+    {46, 26, 0, 1},
+    {46, 27, 0, 1},
+    {46, 28, 0, 1},
+    {46, 29, 0, 1},
+    {46, 30, 0, 1},
+    {46, 31, 0, 1},
+    {46, 32, 0, 1},
+    {46, 33, 0, 1},
+    {2006, 34, 0, 0},
+    {66, 35, 0, 1},
+    {65, 36, 0, 1},
+    {65, 37, 0, 1},
+    {65, 38, 0, 1},
+    {65, 39, 0, 1},
+    {3001, 40, 0, 1},
+    {3001, 41, 0, 1},
+    {3001, 42, 0, 1},
+    {3001, 43, 0, 1},
+    {3001, 44, 0, 1},
+    {3001, 45, 0, 1},
+    {3001, 46, 0, 1},
+    {3001, 47, 0, 1},
+    {9, 48, 0, 1},
+    {9, 49, 0, 1},
+    {9, 50, 0, 1},
+    {9, 51, 0, 1},
+    {9, 52, 0, 1},
+    {9, 53, 0, 1},
+    {34, 54, 0, 1},
+    {34, 55, 0, 1},
+    {34, 56, 0, 1},
+    {34, 57, 0, 1},
+    {34, 58, 0, 1},
+    {34, 59, 0, 1},
+    {34, 60, 0, 1},
+    {34, 61, 0, 1},
+    {17, 62, 0, 1},
+    {2003, 63, 0, 1},
+    {14, 64, 0, 1},
+    {46, 65, 0, 1},
+    {34, 66, 0, 1},
+    {34, 67, 0, 1},
+    {34, 68, 0, 1},
+    {34, 69, 0, 1},
+    {34, 70, 0, 1},
+    {34, 71, 0, 1},
+    {34, 72, 0, 1},
+    {34, 73, 0, 1},
+    {34, 74, 0, 1},
+    {34, 75, 0, 1},
+    {34, 76, 0, 1},
+    {34, 77, 0, 1},
+    {17, 78, 0, 1},
+    {17, 79, 0, 1},
+    {2035, 80, 0, 1},
+    {2035, 81, 0, 1},
+    {2035, 82, 0, 1},
+    {2035, 83, 0, 1},
+    {9, 84, 0, 1},
+    {9, 85, 0, 1},
+    {9, 86, 0, 1},
+    {9, 87, 0, 1},
+    {9, 88, 0, 1},
+    {9, 89, 0, 1},
+    {9, 90, 0, 1},
+    {9, 91, 0, 1},
+    {58, 92, 0, 1},
+    {58, 93, 0, 1},
+    {58, 94, 0, 1},
+    {58, 95, 0, 1},
+    {58, 96, 0, 1},
+    {58, 97, 0, 1},
+    {3006, 98, 0, 1},
+    {3006, 99, 0, 1},
+    {3006, 100, 0, 1},
+    {3006, 101, 0, 1},
+    {68, 102, 0, 1},
+    {2019, 103, 0, 0},
+    {2018, 104, 0, 0},
+    {14, 105, 0, 1},
+    {40, 106, 0, 0},
+    {2049, 107, 0, 1},
+    {2012, 108, 0, 1},
+    {2049, 109, 0, 1},
+    {2012, 110, 0, 1},
+    {2012, 111, 0, 1},
+    {2049, 112, 0, 1},
+    {2049, 113, 0, 1},
+    {2012, 114, 0, 1},
+    {2049, 115, 0, 1},
+    {2049, 116, 0, 1},
+    {2048, 117, 0, 1},
+    {2048, 118, 0, 1},
+    {2048, 119, 0, 1},
+    {2048, 120, 0, 1},
+    {80, 121, 0, 1},
+    {80, 122, 0, 1},
+    {80, 123, 0, 1},
+    {80, 124, 0, 1},
+    {80, 125, 0, 1},
+    {80, 126, 0, 1},
+    {79, 127, 0, 1},
+    {79, 128, 0, 1},
+    {79, 129, 0, 1},
+    {79, 130, 0, 1},
+    {3004, 131, 0, 1},
+    {3004, 132, 0, 1},
+    {3004, 133, 0, 1},
+    {3004, 134, 0, 1},
+    {9, 135, 0, 1},
+    {2011, 136, 0, 1},
+    {9, 137, 0, 1},
+    {9, 138, 0, 1},
+    {9, 139, 0, 1},
+    {2011, 140, 0, 1},
+    {2011, 141, 0, 1},
+    {2011, 142, 0, 1},
+    {2035, 143, 0, 1},
+    {2035, 144, 0, 1},
+    {2035, 145, 0, 1},
+    {2011, 146, 0, 1},
+    {2035, 147, 0, 1},
+    {2035, 148, 0, 1},
+    {2035, 149, 0, 1},
+    {2002, 150, 0, 0},
+    {46, 151, 0, 1},
+    {46, 152, 0, 1},
+    {46, 153, 0, 1},
+    {46, 154, 0, 1},
+    {46, 155, 0, 1},
+    {46, 156, 0, 1},
+    {46, 157, 0, 1},
+    {46, 158, 0, 1},
+    {46, 159, 0, 1},
+    {46, 160, 0, 1},
+    {46, 161, 0, 1},
+    {46, 162, 0, 1},
+    {46, 163, 0, 1},
+    {46, 164, 0, 1},
+    {46, 165, 0, 1},
+    {46, 166, 0, 1},
+    {46, 167, 0, 1},
+    {46, 168, 0, 1},
+    {2004, 169, 0, 0},
+    {69, 170, 0, 1},
+    {3001, 171, 0, 1},
+    {3001, 172, 0, 1},
+    {3001, 173, 0, 1},
+    {9, 174, 0, 1},
+    {9, 175, 0, 1},
+    {9, 176, 0, 1},
+    {9, 177, 0, 1},
+    {9, 178, 0, 1},
+    {9, 179, 0, 1},
+    {9, 180, 0, 1},
+    {65, 181, 0, 1},
+    {17, 182, 0, 1},
+    {2012, 183, 0, 1},
+    {2012, 184, 0, 1},
+    {2012, 185, 0, 1},
+    {2006, 186, 0, 0},
+    {2006, 187, 0, 1},
+    {71, 188, 0, 1},
+    {68, 189, 0, 1},
+    {2011, 190, 0, 1},
+    {67, 191, 0, 1},
+    {9, 192, 0, 1},
+    {9, 193, 0, 1},
+    {9, 194, 0, 1},
+    {9, 195, 0, 1},
+    {9, 196, 0, 1},
+    {9, 197, 0, 1},
+    {9, 198, 0, 1},
+    {9, 199, 0, 1},
+    {65, 200, 0, 1},
+    {3001, 201, 0, 1},
+    {3001, 202, 0, 1},
+    {3001, 203, 0, 1},
+    {3001, 204, 0, 1},
+    {3001, 205, 0, 1},
+    {3001, 206, 0, 1},
+    {3001, 207, 0, 1},
+    {3004, 208, 0, 1},
+    {3004, 209, 0, 1},
+    {3004, 210, 0, 1},
+    {3004, 211, 0, 1},
+    {3004, 212, 0, 1},
+    {3004, 213, 0, 1},
+    {3004, 214, 0, 1},
+    {3004, 215, 0, 1},
+    {3004, 216, 0, 1},
+    {2011, 217, 0, 1},
+    {2011, 218, 0, 1},
+    {2011, 219, 0, 1},
+    {2011, 220, 0, 1},
+    {2011, 221, 0, 1},
+    {2011, 222, 0, 1},
+    {2011, 223, 0, 1},
+    {2011, 224, 0, 1},
+    {2011, 225, 0, 1},
+    {2011, 226, 0, 1},
+    {11, 227, 0, 1},
+    {11, 228, 0, 1},
+    {11, 229, 0, 1},
+    {11, 230, 0, 1},
+    {2, 231, 0, 1},
+    {3, 232, 0, 1},
+    {4, 233, 0, 1},
+    {11, 234, 0, 1},
+    {11, 235, 0, 1},
+    {2003, 236, 0, 0},
+    {3004, 237, 0, 1},
+    {3004, 238, 0, 1},
+    {3004, 239, 0, 1},
+    {9, 240, 0, 1},
+    {9, 241, 0, 1},
+    {3004, 242, 0, 1},
+    {67, 243, 0, 1},
+    {17, 244, 0, 1},
+    {17, 245, 0, 1},
+    {69, 246, 0, 1},
+    {2008, 247, 0, 1},
+    {2008, 248, 0, 1},
+    {2008, 249, 0, 1},
+    {2008, 250, 0, 1},
+    {2008, 251, 0, 1},
+    {2008, 252, 0, 1},
+    {2008, 253, 0, 1},
+    {2008, 254, 0, 1},
+    {2008, 255, 0, 1},
+    {2008, 256, 0, 1},
+    {2008, 257, 0, 1},
+    {2008, 258, 0, 1},
+    {2008, 259, 0, 1},
+    {2008, 260, 0, 1},
+    {2008, 261, 0, 1},
+    {2008, 262, 0, 1},
+    {2008, 263, 0, 1},
+    {2008, 264, 0, 1},
+    {2008, 265, 0, 1},
+    {2008, 266, 0, 1},
+    {2008, 267, 0, 1},
+    {2008, 268, 0, 1},
+    {2008, 269, 0, 1},
+    {2047, 270, 0, 1},
+    {2047, 271, 0, 1},
+    {2047, 272, 0, 1},
+    {2047, 273, 0, 1},
+    {2047, 274, 0, 1},
+    {2047, 275, 0, 1},
+};
+
+
+static const ap_thing_info_t ap_doom2_thing_infos_e3m6[] = 
+{
+    {1, 0, 0, 1},
+    {2, 1, 0, 1},
+    {3, 2, 0, 1},
+    {4, 3, 0, 1},
+    {3001, 4, 0, 1},
+    {3001, 5, 0, 1},
+    {3001, 6, 0, 1},
+    {3001, 7, 0, 1},
+    {3001, 8, 0, 1},
+    {3006, 9, 0, 1},
+    {3006, 10, 0, 1},
+    {3006, 11, 0, 1},
+    {3006, 12, 0, 1},
+    {3005, 13, 0, 1},
+    {3005, 14, 0, 1},
+    {3005, 15, 0, 1},
+    {3005, 16, 0, 1},
+    {2012, 17, 0, 1},
+    {2012, 18, 0, 1},
+    {3003, 19, 0, 1},
+    {5, 20, 0, 0},
+    {82, 21, 0, 0},
+    {2008, 22, 0, 1},
+    {2049, 23, 0, 1},
+    {2049, 24, 0, 1},
+    {65, 25, 0, 1},
+    {65, 26, 0, 1},
+    {3001, 27, 0, 1},
+    {3001, 28, 0, 1},
+    {3006, 29, 0, 1},
+    {3006, 30, 0, 1},
+    {3006, 31, 0, 1},
+    {3006, 32, 0, 1},
+    {3006, 33, 0, 1},
+    {65, 34, 0, 1},
+    {65, 35, 0, 1},
+    {65, 36, 0, 1},
+    {65, 37, 0, 1},
+    {65, 38, 0, 1},
+    {65, 39, 0, 1},
+    {9, 40, 0, 1},
+    {65, 41, 0, 1},
+    {3001, 42, 0, 1},
+    {65, 43, 0, 1},
+    {14, 44, 0, 1},
+    {2012, 45, 0, 1},
+    {2012, 46, 0, 1},
+    {2012, 47, 0, 1},
+    {2012, 48, 0, 1},
+    {2003, 49, 0, 0},
+    {2010, 50, 0, 1},
+    {2010, 51, 0, 1},
+    {2010, 52, 0, 1},
+    {2046, 53, 0, 1},
+    {2049, 54, 0, 1},
+    {2008, 55, 0, 1},
+    {2014, 56, 0, 1},
+    {2014, 57, 0, 1},
+    {2014, 58, 0, 1},
+    {2015, 59, 0, 1},
+    {2015, 60, 0, 1},
+    {2015, 61, 0, 1},
+    {2014, 62, 0, 1},
+    {2014, 63, 0, 1},
+    {2014, 64, 0, 1},
+    {2014, 65, 0, 1},
+    {2014, 66, 0, 1},
+    {2015, 67, 0, 1},
+    {2015, 68, 0, 1},
+    {2015, 69, 0, 1},
+    {2015, 70, 0, 1},
+    {2015, 71, 0, 1},
+    {2015, 72, 0, 1},
+    {2014, 73, 0, 1},
+    {2014, 74, 0, 1},
+    {2014, 75, 0, 1},
+    {2014, 76, 0, 1},
+    {2014, 77, 0, 1},
+    {2014, 78, 0, 1},
+    {2015, 79, 0, 1},
+    {2014, 80, 0, 1},
+    {2014, 81, 0, 1},
+    {2014, 82, 0, 1},
+    {2014, 83, 0, 1},
+    {2035, 84, 0, 1},
+    {2035, 85, 0, 1},
+    {2035, 86, 0, 1},
+    {2035, 87, 0, 1},
+    {2035, 88, 0, 1},
+    {2035, 89, 0, 1},
+    {2035, 90, 0, 1},
+    {2035, 91, 0, 1},
+    {2008, 92, 0, 1},
+    {2008, 93, 0, 1},
+    {2008, 94, 0, 1},
+    {2019, 95, 0, 0},
+    {2011, 96, 0, 1},
+    {2011, 97, 0, 1},
+    {2011, 98, 0, 1},
+    {2011, 99, 0, 1},
+    {2011, 100, 0, 1},
+    {2011, 101, 0, 1},
+    {2025, 102, 0, 1},
+    {2008, 103, 0, 1},
+    {67, 104, 0, 1},
+    {14, 105, 0, 1},
+    {14, 106, 0, 1},
+    {2004, 107, 0, 0},
+    {17, 108, 0, 1},
+    {2047, 109, 0, 1},
+    {3006, 110, 0, 1},
+    {3006, 111, 0, 1},
+    {3006, 112, 0, 1},
+    {3006, 113, 0, 1},
+    {3006, 114, 0, 1},
+    {3006, 115, 0, 1},
+    {3006, 116, 0, 1},
+    {9, 117, 0, 1},
+    {65, 118, 0, 1},
+    {65, 119, 0, 1},
+    {65, 120, 0, 1},
+    {65, 121, 0, 1},
+    {58, 122, 0, 1},
+    {2035, 123, 0, 1},
+    {2035, 124, 0, 1},
+    {2035, 125, 0, 1},
+    {2014, 126, 0, 1},
+    {2014, 127, 0, 1},
+    {2014, 128, 0, 1},
+    {2014, 129, 0, 1},
+    {2015, 130, 0, 1},
+    {2015, 131, 0, 1},
+    {2015, 132, 0, 1},
+    {2015, 133, 0, 1},
+    {2014, 134, 0, 1},
+    {2014, 135, 0, 1},
+    {2014, 136, 0, 1},
+    {2025, 137, 0, 1},
+    {3005, 138, 0, 1},
+    {3005, 139, 0, 1},
+    {3005, 140, 0, 1},
+    {3005, 141, 0, 1},
+    {3005, 142, 0, 1},
+    {3005, 143, 0, 1},
+    {3006, 144, 0, 1},
+    {3006, 145, 0, 1},
+    {2012, 146, 0, 1},
+    {2012, 147, 0, 1},
+    {2012, 148, 0, 1},
+    {67, 149, 0, 1},
+    {3005, 150, 0, 1},
+    {3005, 151, 0, 1},
+    {3005, 152, 0, 1},
+    {14, 153, 0, 1},
+    {2013, 154, 0, 0},
+    {2002, 155, 0, 0},
+    {2048, 156, 0, 1},
+    {2048, 157, 0, 1},
+    {2048, 158, 0, 1},
+    {2024, 159, 0, 0},
+    {3001, 160, 0, 1},
+    {3001, 161, 0, 1},
+    {3001, 162, 0, 1},
+    {3001, 163, 0, 1},
+    {3001, 164, 0, 1},
+    {3001, 165, 0, 1},
+    {3001, 166, 0, 1},
+    {3001, 167, 0, 1},
+    {3001, 168, 0, 1},
+    {3001, 169, 0, 1},
+    {2018, 170, 0, 0},
+    {14, 171, 0, 1},
+    {2012, 172, 0, 1},
+    {2012, 173, 0, 1},
+    {2012, 174, 0, 1},
+    {2012, 175, 0, 1},
+    {2011, 176, 0, 1},
+    {2014, 177, 0, 1},
+    {2014, 178, 0, 1},
+    {2014, 179, 0, 1},
+    {2014, 180, 0, 1},
+    {2014, 181, 0, 1},
+    {13, 182, 0, 0},
+    {2008, 183, 0, 1},
+    {2014, 184, 0, 1},
+    {2014, 185, 0, 1},
+    {2014, 186, 0, 1},
+    {2014, 187, 0, 1},
+    {2014, 188, 0, 1},
+    {3001, 189, 0, 1},
+    {3001, 190, 0, 1},
+    {3001, 191, 0, 1},
+    {3001, 192, 0, 1},
+    {3001, 193, 0, 1},
+    {3001, 194, 0, 1},
+    {3001, 195, 0, 1},
+    {3001, 196, 0, 1},
+    {3001, 197, 0, 1},
+    {3006, 198, 0, 1},
+    {3006, 199, 0, 1},
+    {3006, 200, 0, 1},
+    {3006, 201, 0, 1},
+    {3006, 202, 0, 1},
+    {3005, 203, 0, 1},
+    {3005, 204, 0, 1},
+    {3005, 205, 0, 1},
+    {3005, 206, 0, 1},
+    {3005, 207, 0, 1},
+    {2011, 208, 0, 1},
+    {2011, 209, 0, 1},
+    {2011, 210, 0, 1},
+    {2008, 211, 0, 1},
+    {2008, 212, 0, 1},
+    {2049, 213, 0, 1},
+    {45, 214, 0, 1},
+    {45, 215, 0, 1},
+    {2012, 216, 0, 1},
+    {2012, 217, 0, 1},
+    {2049, 218, 0, 1},
+    {2049, 219, 0, 1},
+    {11, 220, 0, 1},
+    {11, 221, 0, 1},
+    {11, 222, 0, 1},
+    {11, 223, 0, 1},
+    {11, 224, 0, 1},
+    {11, 225, 0, 1},
+    {11, 226, 0, 1},
+    {2046, 227, 0, 1},
+    {67, 228, 0, 1},
+    {6, 229, 0, 0},
+    {2012, 230, 0, 1},
+    {2012, 231, 0, 1},
+    {2012, 232, 0, 1},
+    {2012, 233, 0, 1},
+    {3005, 234, 0, 1},
+    {3006, 235, 0, 1},
+    {3006, 236, 0, 1},
+    {3006, 237, 0, 1},
+    {3005, 238, 0, 1},
+    {3006, 239, 0, 1},
+    {3006, 240, 0, 1},
+    {3006, 241, 0, 1},
+    {2008, 242, 0, 1},
+    {2008, 243, 0, 1},
+    {2008, 244, 0, 1},
+    {2008, 245, 0, 1},
+    {2008, 246, 0, 1},
+    {2015, 247, 0, 1},
+    {2015, 248, 0, 1},
+    {2015, 249, 0, 1},
+    {2015, 250, 0, 1},
+    {2015, 251, 0, 1},
+    {2015, 252, 0, 1},
+    {2015, 253, 0, 1},
+    {8, 254, 0, 0},
+    {2049, 255, 0, 1},
+    {2008, 256, 0, 1},
+    {2008, 257, 0, 1},
+    {2008, 258, 0, 1},
+    {2008, 259, 0, 1},
+    {2008, 260, 0, 1},
+    {57, 261, 0, 1},
+    {57, 262, 0, 1},
+    {44, 263, 0, 1},
+    {44, 264, 0, 1},
+    {44, 265, 0, 1},
+    {44, 266, 0, 1},
+    {52, 267, 0, 1},
+    {51, 268, 0, 1},
+    {53, 269, 0, 1},
+    {61, 270, 0, 1},
+    {61, 271, 0, 1},
+    {62, 272, 0, 1},
+    {62, 273, 0, 1},
+    {59, 274, 0, 1},
+    {59, 275, 0, 1},
+    {61, 276, 0, 1},
+    {59, 277, 0, 1},
+    {62, 278, 0, 1},
+    {2006, 279, 0, 1},
+    {17, 280, 0, 1},
+    {2048, 281, 0, 1},
+    {2048, 282, 0, 1},
+    {2048, 283, 0, 1},
+    {2046, 284, 0, 1},
+    {2046, 285, 0, 1},
+    {3003, 286, 0, 1},
+    {3005, 287, 0, 1},
+    {3005, 288, 0, 1},
+    {3005, 289, 0, 1},
+    {3005, 290, 0, 1},
+    {3005, 291, 0, 1},
+    {2046, 292, 0, 1},
+    {2046, 293, 0, 1},
+    {14, 294, 0, 1},
+    {16, 295, 0, 1},
+};
+
+
+static const ap_thing_info_t ap_doom2_thing_infos_e3m7[] = 
+{
+    {1, 0, 0, 1},
+    {2, 1, 0, 1},
+    {3, 2, 0, 1},
+    {4, 3, 0, 1},
+    {2003, 4, 0, 0},
+    {31, 5, 0, 1},
+    {31, 6, 0, 1},
+    {44, 7, 0, 1},
+    {58, 8, 0, 1},
+    {58, 9, 0, 1},
+    {2048, 10, 0, 1},
+    {2048, 11, 0, 1},
+    {2011, 12, 0, 1},
+    {2002, 13, 0, 1},
+    {9, 14, 0, 1},
+    {9, 15, 0, 1},
+    {9, 16, 0, 1},
+    {9, 17, 0, 1},
+    {65, 18, 0, 1},
+    {65, 19, 0, 1},
+    {65, 20, 0, 1},
+    {2049, 21, 0, 1},
+    {9, 22, 0, 1},
+    {3004, 23, 0, 1},
+    {3004, 24, 0, 1},
+    {3004, 25, 0, 1},
+    {3004, 26, 0, 1},
+    {2012, 27, 0, 1},
+    {2012, 28, 0, 1},
+    {2011, 29, 0, 1},
+    {2011, 30, 0, 1},
+    {2010, 31, 0, 1},
+    {2008, 32, 0, 1},
+    {2011, 33, 0, 1},
+    {2008, 34, 0, 1},
+    {2007, 35, 0, 1},
+    {66, 36, 0, 1},
+    {69, 37, 0, 1},
+    {2049, 38, 0, 1},
+    {3002, 39, 0, 1},
+    {3001, 40, 0, 1},
+    {3001, 41, 0, 1},
+    {9, 42, 0, 1},
+    {65, 43, 0, 1},
+    {9, 44, 0, 1},
+    {3004, 45, 0, 1},
+    {3004, 46, 0, 1},
+    {3004, 47, 0, 1},
+    {3004, 48, 0, 1},
+    {2010, 49, 0, 1},
+    {2012, 50, 0, 1},
+    {2024, 51, 0, 0},
+    {2011, 52, 0, 1},
+    {69, 53, 0, 1},
+    {64, 54, 0, 1},
+    {69, 55, 0, 1},
+    {69, 56, 0, 1},
+    {69, 57, 0, 1},
+    {2004, 58, 0, 0},
+    {2046, 59, 0, 1},
+    {2022, 60, 0, 0},
+    {3002, 61, 0, 1},
+    {2010, 62, 0, 1},
+    {65, 63, 0, 1},
+    {58, 64, 0, 1},
+    {58, 65, 0, 1},
+    {2048, 66, 0, 1},
+    {2011, 67, 0, 1},
+    {3004, 68, 0, 1},
+    {3004, 69, 0, 1},
+    {3004, 70, 0, 1},
+    {3004, 71, 0, 1},
+    {3004, 72, 0, 1},
+    {3004, 73, 0, 1},
+    {3002, 74, 0, 1},
+    {3002, 75, 0, 1},
+    {3002, 76, 0, 1},
+    {3002, 77, 0, 1},
+    {9, 78, 0, 1},
+    {9, 79, 0, 1},
+    {9, 80, 0, 1},
+    {9, 81, 0, 1},
+    {2015, 82, 0, 1},
+    {2014, 83, 0, 1},
+    {2014, 84, 0, 1},
+    {2015, 85, 0, 1},
+    {2018, 86, 0, 0},
+    {2012, 87, 0, 1},
+    {69, 88, 0, 1},
+    {69, 89, 0, 1},
+    {69, 90, 0, 1},
+    {3001, 91, 0, 1},
+    {3001, 92, 0, 1},
+    {3001, 93, 0, 1},
+    {2047, 94, 0, 1},
+    {2047, 95, 0, 1},
+    {2014, 96, 0, 1},
+    {2014, 97, 0, 1},
+    {2014, 98, 0, 1},
+    {2046, 99, 0, 1},
+    {2047, 100, 0, 1},
+    {69, 101, 0, 1},
+    {2010, 102, 0, 1},
+    {2001, 103, 0, 1},
+    {2046, 104, 0, 1},
+    {8, 105, 0, 0},
+    {2045, 106, 0, 1},
+    {2022, 107, 0, 0},
+    {29, 108, 0, 1},
+    {29, 109, 0, 1},
+    {41, 110, 0, 1},
+    {9, 111, 0, 1},
+    {9, 112, 0, 1},
+    {9, 113, 0, 1},
+    {3002, 114, 0, 1},
+    {3002, 115, 0, 1},
+    {3002, 116, 0, 1},
+    {3004, 117, 0, 1},
+    {3004, 118, 0, 1},
+    {3004, 119, 0, 1},
+    {3004, 120, 0, 1},
+    {2045, 121, 0, 1},
+    {2024, 122, 0, 0},
+    {2047, 123, 0, 1},
+    {48, 124, 0, 1},
+    {42, 125, 0, 1},
+    {27, 126, 0, 1},
+    {59, 127, 0, 1},
+    {61, 128, 0, 1},
+    {59, 129, 0, 1},
+    {59, 130, 0, 1},
+    {59, 131, 0, 1},
+    {62, 132, 0, 1},
+    {59, 133, 0, 1},
+    {59, 134, 0, 1},
+    {63, 135, 0, 1},
+    {59, 136, 0, 1},
+    {59, 137, 0, 1},
+    {61, 138, 0, 1},
+    {25, 139, 0, 1},
+    {26, 140, 0, 1},
+    {59, 141, 0, 1},
+    {61, 142, 0, 1},
+    {25, 143, 0, 1},
+    {59, 144, 0, 1},
+    {62, 145, 0, 1},
+    {59, 146, 0, 1},
+    {59, 147, 0, 1},
+    {59, 148, 0, 1},
+    {25, 149, 0, 1},
+    {62, 150, 0, 1},
+    {59, 151, 0, 1},
+    {63, 152, 0, 1},
+    {59, 153, 0, 1},
+    {25, 154, 0, 1},
+    {59, 155, 0, 1},
+    {24, 156, 0, 1},
+    {24, 157, 0, 1},
+    {24, 158, 0, 1},
+    {24, 159, 0, 1},
+    {24, 160, 0, 1},
+    {24, 161, 0, 1},
+    {24, 162, 0, 1},
+    {24, 163, 0, 1},
+    {24, 164, 0, 1},
+    {2049, 165, 0, 1},
+    {68, 166, 0, 1},
+    {68, 167, 0, 1},
+    {68, 168, 0, 1},
+    {2012, 169, 0, 1},
+    {2015, 170, 0, 1},
+    {2015, 171, 0, 1},
+    {2015, 172, 0, 1},
+    {2015, 173, 0, 1},
+    {2015, 174, 0, 1},
+    {2015, 175, 0, 1},
+    {58, 176, 0, 1},
+    {58, 177, 0, 1},
+    {58, 178, 0, 1},
+    {58, 179, 0, 1},
+    {58, 180, 0, 1},
+    {2014, 181, 0, 1},
+    {2014, 182, 0, 1},
+    {2014, 183, 0, 1},
+    {2014, 184, 0, 1},
+    {2014, 185, 0, 1},
+    {2014, 186, 0, 1},
+    {2014, 187, 0, 1},
+    {2014, 188, 0, 1},
+    {68, 189, 0, 1},
+    {2007, 190, 0, 1},
+    {2012, 191, 0, 1},
+    {3001, 192, 0, 1},
+    {3001, 193, 0, 1},
+    {3001, 194, 0, 1},
+    {3001, 195, 0, 1},
+    {3001, 196, 0, 1},
+    {3001, 197, 0, 1},
+    {3001, 198, 0, 1},
+    {3001, 199, 0, 1},
+    {3001, 200, 0, 1},
+    {3001, 201, 0, 1},
+    {3001, 202, 0, 1},
+    {2048, 203, 0, 1},
+    {2010, 204, 0, 1},
+    {2010, 205, 0, 1},
+    {2049, 206, 0, 1},
+    {57, 207, 0, 1},
+    {57, 208, 0, 1},
+    {57, 209, 0, 1},
+    {2007, 210, 0, 1},
+    {57, 211, 0, 1},
+    {57, 212, 0, 1},
+    {57, 213, 0, 1},
+    {57, 214, 0, 1},
+    {25, 215, 0, 1},
+    {25, 216, 0, 1},
+    {62, 217, 0, 1},
+    {27, 218, 0, 1},
+    {60, 219, 0, 1},
+    {63, 220, 0, 1},
+    {69, 221, 0, 1},
+    {64, 222, 0, 1},
+    {3006, 223, 0, 1},
+    {3006, 224, 0, 1},
+    {3006, 225, 0, 1},
+    {3006, 226, 0, 1},
+    {3006, 227, 0, 1},
+    {3006, 228, 0, 1},
+    {3006, 229, 0, 1},
+    {2011, 230, 0, 1},
+    {2011, 231, 0, 1},
+    {2014, 232, 0, 1},
+    {2014, 233, 0, 1},
+    {2014, 234, 0, 1},
+    {2014, 235, 0, 1},
+    {2013, 236, 0, 0},
+    {2010, 237, 0, 1},
+    {2010, 238, 0, 1},
+    {2018, 239, 0, 0},
+    {2014, 240, 0, 1},
+    {2014, 241, 0, 1},
+    {2014, 242, 0, 1},
+    {24, 243, 0, 1},
+    {24, 244, 0, 1},
+    {24, 245, 0, 1},
+    {24, 246, 0, 1},
+    {24, 247, 0, 1},
+    {24, 248, 0, 1},
+    {57, 249, 0, 1},
+    {2049, 250, 0, 1},
+    {2002, 251, 0, 0},
+    {2010, 252, 0, 1},
+    {2010, 253, 0, 1},
+    {2008, 254, 0, 1},
+    {2008, 255, 0, 1},
+    {2007, 256, 0, 1},
+    {2007, 257, 0, 1},
+    {44, 258, 0, 1},
+    {44, 259, 0, 1},
+    {2014, 260, 0, 1},
+    {2014, 261, 0, 1},
+    {2014, 262, 0, 1},
+    {2014, 263, 0, 1},
+    {2014, 264, 0, 1},
+    {2014, 265, 0, 1},
+    {2014, 266, 0, 1},
+    {2014, 267, 0, 1},
+    {2015, 268, 0, 1},
+    {2015, 269, 0, 1},
+    {2015, 270, 0, 1},
+    {2015, 271, 0, 1},
+    {2015, 272, 0, 1},
+    {2015, 273, 0, 1},
+    {2015, 274, 0, 1},
+    {2015, 275, 0, 1},
+    {2015, 276, 0, 1},
+    {2015, 277, 0, 1},
+    {2015, 278, 0, 1},
+    {2006, 279, 0, 0},
+    {2048, 280, 0, 1},
+    {2049, 281, 0, 1},
+    {2010, 282, 0, 1},
+    {2010, 283, 0, 1},
+    {14, 284, 0, 1},
+    {8, 285, 0, 0},
+    {8, 286, 0, 0},
+    {8, 287, 0, 0},
+    {57, 288, 0, 1},
+    {2014, 289, 0, 1},
+    {2014, 290, 0, 1},
+    {2014, 291, 0, 1},
+    {2014, 292, 0, 1},
+    {2014, 293, 0, 1},
+    {2014, 294, 0, 1},
+    {2014, 295, 0, 1},
+    {2014, 296, 0, 1},
+    {2014, 297, 0, 1},
+    {2014, 298, 0, 1},
+    {2014, 299, 0, 1},
+    {2014, 300, 0, 1},
+    {2014, 301, 0, 1},
+    {2014, 302, 0, 1},
+    {2014, 303, 0, 1},
+    {2014, 304, 0, 1},
+    {2014, 305, 0, 1},
+    {2014, 306, 0, 1},
+    {2014, 307, 0, 1},
+    {2014, 308, 0, 1},
+    {2014, 309, 0, 1},
+    {39, 310, 0, 0},
+    {35, 311, 0, 1},
+    {35, 312, 0, 1},
+    {35, 313, 0, 1},
+    {35, 314, 0, 1},
+    {3002, 315, 0, 1},
+    {3002, 316, 0, 1},
+    {69, 317, 0, 1},
+    {69, 318, 0, 1},
+    {3001, 319, 0, 1},
+    {3001, 320, 0, 1},
+    {3001, 321, 0, 1},
+    {3001, 322, 0, 1},
+    {69, 323, 0, 1},
+    {3002, 324, 0, 1},
+    {3002, 325, 0, 1},
+    {2048, 326, 0, 1},
+    {2015, 327, 0, 1},
+    {2015, 328, 0, 1},
+    {2015, 329, 0, 1},
+    {2015, 330, 0, 1},
+    {2012, 331, 0, 1},
+    {2008, 332, 0, 1},
+    {2014, 333, 0, 1},
+    {2014, 334, 0, 1},
+    {2014, 335, 0, 1},
+    {2014, 336, 0, 1},
+    {2011, 337, 0, 1},
+    {2007, 338, 0, 1},
+    {3002, 339, 0, 1},
+    {3002, 340, 0, 1},
+    {3001, 341, 0, 1},
+    {3001, 342, 0, 1},
+    {3001, 343, 0, 1},
+    {3001, 344, 0, 1},
+    {2011, 345, 0, 1},
+    {2008, 346, 0, 1},
+    {2048, 347, 0, 1},
+    {2049, 348, 0, 1},
+    {2046, 349, 0, 1},
+    {2047, 350, 0, 1},
+    {2011, 351, 0, 1},
+    {2011, 352, 0, 1},
+    {2011, 353, 0, 1},
+    {2011, 354, 0, 1},
+    {69, 355, 0, 1},
+    {69, 356, 0, 1},
+    {69, 357, 0, 1},
+    {69, 358, 0, 1},
+    {69, 359, 0, 1},
+    {69, 360, 0, 1},
+    {69, 361, 0, 1},
+    {69, 362, 0, 1},
+    {3003, 363, 0, 1},
+    {38, 364, 0, 0},
+    {2013, 365, 0, 0},
+    {2048, 366, 0, 1},
+    {2046, 367, 0, 1},
+    {2008, 368, 0, 1},
+    {2008, 369, 0, 1},
+    {2008, 370, 0, 1},
+    {2008, 371, 0, 1},
+    {2010, 372, 0, 1},
+    {2047, 373, 0, 1},
+    {2007, 374, 0, 1},
+    {2007, 375, 0, 1},
+    {2007, 376, 0, 1},
+    {2008, 377, 0, 1},
+    {2008, 378, 0, 1},
+    {2010, 379, 0, 1},
+    {2010, 380, 0, 1},
+    {2047, 381, 0, 1},
+    {40, 382, 0, 0},
+    {67, 383, 0, 1},
+    {67, 384, 0, 1},
+    {67, 385, 0, 1},
+    {67, 386, 0, 1},
+    {67, 387, 0, 1},
+    {67, 388, 0, 1},
+    {66, 389, 0, 1},
+    {66, 390, 0, 1},
+    {66, 391, 0, 1},
+    {2013, 392, 0, 0},
+    {2026, 393, 0, 0},
+    {2023, 394, 0, 0},
+    {45, 395, 0, 1},
+    {45, 396, 0, 1},
+    {2047, 397, 0, 1},
+    {2047, 398, 0, 1},
+    {2047, 399, 0, 1},
+    {2047, 400, 0, 1},
+    {3002, 401, 0, 1},
+    {2047, 402, 0, 1},
+    {2046, 403, 0, 1},
+    {2048, 404, 0, 1},
+    {2012, 405, 0, 1},
+    {2007, 406, 0, 1},
+    {2007, 407, 0, 1},
+    {2007, 408, 0, 1},
+    {2008, 409, 0, 1},
+    {2008, 410, 0, 1},
+    {2010, 411, 0, 1},
+    {2010, 412, 0, 1},
+    {2047, 413, 0, 1},
+    {2013, 414, 0, 0},
+    {67, 415, 0, 1},
+    {67, 416, 0, 1},
+    {67, 417, 0, 1},
+    {67, 418, 0, 1},
+    {67, 419, 0, 1},
+    {67, 420, 0, 1},
+    {66, 421, 0, 1},
+    {66, 422, 0, 1},
+    {66, 423, 0, 1},
+    {2013, 424, 0, 0},
+    {2026, 425, 0, 0},
+    {2023, 426, 0, 0},
+    {2047, 427, 0, 1},
+    {2047, 428, 0, 1},
+    {2047, 429, 0, 1},
+    {2047, 430, 0, 1},
+    {14, 431, 0, 1},
+    {65, 432, 0, 1},
+    {65, 433, 0, 1},
+    {66, 434, 0, 1},
+    {67, 435, 0, 1},
+    {9, 436, 0, 1},
+    {9, 437, 0, 1},
+    {9, 438, 0, 1},
+    {9, 439, 0, 1},
+    {9, 440, 0, 1},
+    {9, 441, 0, 1},
+    {9, 442, 0, 1},
+    {9, 443, 0, 1},
+    {65, 444, 0, 1},
+    {66, 445, 0, 1},
+    {65, 446, 0, 1},
+    {65, 447, 0, 1},
+    {65, 448, 0, 1},
+    {2003, 449, 0, 1},
+    {2004, 450, 0, 1},
+    {2006, 451, 0, 1},
+    {2002, 452, 0, 1},
+    {2001, 453, 0, 1},
+    {2024, 454, 0, 0},
+    {2022, 455, 0, 0},
+    {17, 456, 0, 1},
+    {2048, 457, 0, 1},
+    {2046, 458, 0, 1},
+    {2049, 459, 0, 1},
+    {2005, 460, 0, 0},
+    {14, 461, 0, 1},
+    {11, 462, 0, 1},
+    {11, 463, 0, 1},
+    {11, 464, 0, 1},
+    {11, 465, 0, 1},
+    {11, 466, 0, 1},
+    {11, 467, 0, 1},
+    {11, 468, 0, 1},
+    {11, 469, 0, 1},
+    {82, 470, 0, 0},
+    {2048, 471, 0, 1},
+    {66, 472, 0, 1},
+    {66, 473, 0, 1},
+    {66, 474, 0, 1},
+    {66, 475, 0, 1},
+    {66, 476, 0, 1},
+    {66, 477, 0, 1},
+    {2010, 478, 0, 1},
+    {2010, 479, 0, 1},
+    {66, 480, 0, 1},
+    {66, 481, 0, 1},
+    {66, 482, 0, 1},
+    {66, 483, 0, 1},
+    {66, 484, 0, 1},
+    {66, 485, 0, 1},
+    {71, 486, 0, 1},
+    {71, 487, 0, 1},
+    {71, 488, 0, 1},
+    {71, 489, 0, 1},
+};
+
+
+static const ap_thing_info_t ap_doom2_thing_infos_e3m8[] = 
+{
+    {1, 0, 0, 1},
+    {2, 1, 0, 1},
+    {3, 2, 0, 1},
+    {4, 3, 0, 1},
+    {46, 4, 0, 1},
+    {46, 5, 0, 1},
+    {46, 6, 0, 1},
+    {46, 7, 0, 1},
+    {46, 8, 0, 1},
+    {46, 9, 0, 1},
+    {46, 10, 0, 1},
+    {46, 11, 0, 1},
+    {47, 12, 0, 1},
+    {47, 13, 0, 1},
+    {47, 14, 0, 1},
+    {47, 15, 0, 1},
+    {42, 16, 0, 1},
+    {47, 17, 0, 1},
+    {2048, 18, 0, 1},
+    {2018, 19, 0, 0},
+    {2049, 20, 0, 1},
+    {2012, 21, 0, 1},
+    {2011, 22, 0, 1},
+    {2011, 23, 0, 1},
+    {2007, 24, 0, 1},
+    {2007, 25, 0, 1},
+    {3002, 26, 0, 1},
+    {3002, 27, 0, 1},
+    {3002, 28, 0, 1},
+    {3002, 29, 0, 1},
+    {3001, 30, 0, 1},
+    {3001, 31, 0, 1},
+    {3001, 32, 0, 1},
+    {3002, 33, 0, 1},
+    {3002, 34, 0, 1},
+    {47, 35, 0, 1},
+    {47, 36, 0, 1},
+    {47, 37, 0, 1},
+    {47, 38, 0, 1},
+    {47, 39, 0, 1},
+    {56, 40, 0, 1},
+    {56, 41, 0, 1},
+    {56, 42, 0, 1},
+    {56, 43, 0, 1},
+    {56, 44, 0, 1},
+    {56, 45, 0, 1},
+    {3001, 46, 0, 1},
+    {3001, 47, 0, 1},
+    {3001, 48, 0, 1},
+    {3001, 49, 0, 1},
+    {3001, 50, 0, 1},
+    {3001, 51, 0, 1},
+    {3001, 52, 0, 1},
+    {58, 53, 0, 1},
+    {58, 54, 0, 1},
+    {58, 55, 0, 1},
+    {3001, 56, 0, 1},
+    {64, 57, 0, 1},
+    {3001, 58, 0, 1},
+    {3001, 59, 0, 1},
+    {3001, 60, 0, 1},
+    {3001, 61, 0, 1},
+    {3001, 62, 0, 1},
+    {2007, 63, 0, 1},
+    {2008, 64, 0, 1},
+    {2046, 65, 0, 1},
+    {2005, 66, 0, 0},
+    {2007, 67, 0, 1},
+    {2008, 68, 0, 1},
+    {2011, 69, 0, 1},
+    {2008, 70, 0, 1},
+    {69, 71, 0, 1},
+    {69, 72, 0, 1},
+    {69, 73, 0, 1},
+    {69, 74, 0, 1},
+    {64, 75, 0, 1},
+    {2022, 76, 0, 0},
+    {2010, 77, 0, 1},
+    {2010, 78, 0, 1},
+    {2010, 79, 0, 1},
+    {2010, 80, 0, 1},
+    {2046, 81, 0, 1},
+    {2047, 82, 0, 1},
+    {2049, 83, 0, 1},
+    {2047, 84, 0, 1},
+    {14, 85, 0, 1},
+    {11, 86, 0, 1},
+    {39, 87, 0, 0},
+    {3006, 88, 0, 1},
+    {3006, 89, 0, 1},
+    {66, 90, 0, 1},
+    {3001, 91, 0, 1},
+    {3001, 92, 0, 1},
+    {3006, 93, 0, 1},
+    {3001, 94, 0, 1},
+    {2013, 95, 0, 0},
+    {2002, 96, 0, 0},
+    {2048, 97, 0, 1},
+    {65, 98, 0, 1},
+    {9, 99, 0, 1},
+    {9, 100, 0, 1},
+    {9, 101, 0, 1},
+    {3005, 102, 0, 1},
+    {9, 103, 0, 1},
+    {3001, 104, 0, 1},
+    {3001, 105, 0, 1},
+    {3001, 106, 0, 1},
+    {3001, 107, 0, 1},
+    {3001, 108, 0, 1},
+    {66, 109, 0, 1},
+    {3006, 110, 0, 1},
+    {3006, 111, 0, 1},
+    {3006, 112, 0, 1},
+    {67, 113, 0, 1},
+    {2007, 114, 0, 1},
+    {2007, 115, 0, 1},
+    {67, 116, 0, 1},
+    {34, 117, 0, 1},
+    {34, 118, 0, 1},
+    {2003, 119, 0, 1},
+    {2035, 120, 0, 1},
+    {9, 121, 0, 1},
+    {69, 122, 0, 1},
+    {66, 123, 0, 1},
+    {2003, 124, 0, 0},
+    {2015, 125, 0, 1},
+    {2015, 126, 0, 1},
+    {2015, 127, 0, 1},
+    {2014, 128, 0, 1},
+    {2014, 129, 0, 1},
+    {2014, 130, 0, 1},
+    {2014, 131, 0, 1},
+    {66, 132, 0, 1},
+    {2047, 133, 0, 1},
+    {65, 134, 0, 1},
+    {65, 135, 0, 1},
+    {65, 136, 0, 1},
+    {65, 137, 0, 1},
+    {65, 138, 0, 1},
+    {3004, 139, 0, 1},
+    {3004, 140, 0, 1},
+    {3004, 141, 0, 1},
+    {2014, 142, 0, 1},
+    {2014, 143, 0, 1},
+    {2014, 144, 0, 1},
+    {2014, 145, 0, 1},
+    {11, 146, 0, 1},
+    {2008, 147, 0, 1},
+    {71, 148, 0, 1},
+    {71, 149, 0, 1},
+    {71, 150, 0, 1},
+    {3006, 151, 0, 1},
+    {3006, 152, 0, 1},
+    {3006, 153, 0, 1},
+    {66, 154, 0, 1},
+    {8, 155, 0, 0},
+    {8, 156, 0, 0},
+    {8, 157, 0, 0},
+    {8, 158, 0, 0},
+    {2023, 159, 0, 0},
+    {58, 160, 0, 1},
+    {58, 161, 0, 1},
+    {68, 162, 0, 1},
+    {2004, 163, 0, 0},
+    {2048, 164, 0, 1},
+    {2048, 165, 0, 1},
+    {68, 166, 0, 1},
+    {68, 167, 0, 1},
+    {68, 168, 0, 1},
+    {68, 169, 0, 1},
+    {68, 170, 0, 1},
+    {68, 171, 0, 1},
+    {68, 172, 0, 1},
+    {68, 173, 0, 1},
+    {68, 174, 0, 1},
+    {68, 175, 0, 1},
+    {68, 176, 0, 1},
+    {7, 177, 0, 1},
+    {7, 178, 0, 1},
+    {2022, 179, 0, 0},
+    {2022, 180, 0, 0},
+    {2006, 181, 0, 0},
+    {69, 182, 0, 1},
+    {83, 183, 0, 0},
+    {69, 184, 0, 1},
+    {83, 185, 0, 0},
+    {2022, 186, 0, 0},
+    {2011, 187, 0, 1},
+    {2011, 188, 0, 1},
+    {2011, 189, 0, 1},
+    {2011, 190, 0, 1},
+    {2011, 191, 0, 1},
+    {2011, 192, 0, 1},
+    {2011, 193, 0, 1},
+    {2011, 194, 0, 1},
+    {2022, 195, 0, 0},
+    {3006, 196, 0, 1},
+    {3006, 197, 0, 1},
+    {3006, 198, 0, 1},
+    {2002, 199, 0, 1},
+    {2007, 200, 0, 1},
+    {71, 201, 0, 1},
+    {71, 202, 0, 1},
+    {2007, 203, 0, 1},
+    {2008, 204, 0, 1},
+    {2008, 205, 0, 1},
+    {2008, 206, 0, 1},
+    {2012, 207, 0, 1},
+    {2012, 208, 0, 1},
+    {2012, 209, 0, 1},
+    {2011, 210, 0, 1},
+    {2011, 211, 0, 1},
+    {2011, 212, 0, 1},
+    {2012, 213, 0, 1},
+    {82, 214, 0, 0},
+    {66, 215, 0, 1},
+    {38, 216, 0, 0},
+    {66, 217, 0, 1},
+    {66, 218, 0, 1},
+    {58, 219, 0, 1},
+    {58, 220, 0, 1},
+    {58, 221, 0, 1},
+    {58, 222, 0, 1},
+    {58, 223, 0, 1},
+    {58, 224, 0, 1},
+    {58, 225, 0, 1},
+    {58, 226, 0, 1},
+    {58, 227, 0, 1},
+    {58, 228, 0, 1},
+    {58, 229, 0, 1},
+    {58, 230, 0, 1},
+    {66, 231, 0, 1},
+    {2049, 232, 0, 1},
+    {66, 233, 0, 1},
+    {66, 234, 0, 1},
+    {66, 235, 0, 1},
+    {66, 236, 0, 1},
+    {66, 237, 0, 1},
+    {66, 238, 0, 1},
+    {66, 239, 0, 1},
+    {66, 240, 0, 1},
+    {2012, 241, 0, 1},
+    {2012, 242, 0, 1},
+    {2004, 243, 0, 1},
+    {64, 244, 0, 1},
+    {64, 245, 0, 1},
+    {17, 246, 0, 1},
+    {2046, 247, 0, 1},
+    {2049, 248, 0, 1},
+    {2049, 249, 0, 1},
+    {2048, 250, 0, 1},
+    {2048, 251, 0, 1},
+    {2014, 252, 0, 1},
+    {2014, 253, 0, 1},
+    {2014, 254, 0, 1},
+    {2014, 255, 0, 1},
+    {2014, 256, 0, 1},
+    {17, 257, 0, 1},
+    {17, 258, 0, 1},
+    {17, 259, 0, 1},
+    {17, 260, 0, 1},
+    {17, 261, 0, 1},
+    {17, 262, 0, 1},
+    {11, 263, 0, 1},
+    {11, 264, 0, 1},
+    {11, 265, 0, 1},
+};
+
+
+static const ap_thing_info_t ap_doom2_thing_infos_e3m9[] = 
+{
+    {1, 0, 0, 1},
+    {2012, 1, 0, 1},
+    {57, 2, 0, 1},
+    {57, 3, 0, 1},
+    {57, 4, 0, 1},
+    {57, 5, 0, 1},
+    {46, 6, 0, 1},
+    {46, 7, 0, 1},
+    {46, 8, 0, 1},
+    {46, 9, 0, 1},
+    {56, 10, 0, 1},
+    {56, 11, 0, 1},
+    {46, 12, 0, 1},
+    {12, 13, 0, 1},
+    {15, 14, 0, 1},
+    {10, 15, 0, 1},
+    {18, 16, 0, 1},
+    {62, 17, 0, 1},
+    {59, 18, 0, 1},
+    {35, 19, 0, 1},
+    {35, 20, 0, 1},
+    {14, 21, 0, 1},
+    {14, 22, 0, 1},
+    {17, 23, 0, 1},
+    {17, 24, 0, 1},
+    {17, 25, 0, 1},
+    {17, 26, 0, 1},
+    {45, 27, 0, 1},
+    {45, 28, 0, 1},
+    {45, 29, 0, 1},
+    {45, 30, 0, 1},
+    {14, 31, 0, 1},
+    {56, 32, 0, 1},
+    {56, 33, 0, 1},
+    {56, 34, 0, 1},
+    {46, 35, 0, 1},
+    {46, 36, 0, 1},
+    {46, 37, 0, 1},
+    {46, 38, 0, 1},
+    {46, 39, 0, 1},
+    {46, 40, 0, 1},
+    {14, 41, 0, 1},
+    {57, 42, 0, 1},
+    {3001, 43, 0, 1},
+    {3001, 44, 0, 1},
+    {3005, 45, 0, 1},
+    {3005, 46, 0, 1},
+    {3005, 47, 0, 1},
+    {3005, 48, 0, 1},
+    {3005, 49, 0, 1},
+    {3005, 50, 0, 1},
+    {46, 51, 0, 1},
+    {46, 52, 0, 1},
+    {45, 53, 0, 1},
+    {45, 54, 0, 1},
+    {14, 55, 0, 1},
+    {14, 56, 0, 1},
+    {14, 57, 0, 1},
+    {3003, 58, 0, 1},
+    {46, 59, 0, 1},
+    {46, 60, 0, 1},
+    {46, 61, 0, 1},
+    {46, 62, 0, 1},
+    {44, 63, 0, 1},
+    {44, 64, 0, 1},
+    {45, 65, 0, 1},
+    {45, 66, 0, 1},
+    {46, 67, 0, 1},
+    {46, 68, 0, 1},
+    {46, 69, 0, 1},
+    {46, 70, 0, 1},
+    {46, 71, 0, 1},
+    {44, 72, 0, 1},
+    {44, 73, 0, 1},
+    {46, 74, 0, 1},
+    {46, 75, 0, 1},
+    {46, 76, 0, 1},
+    {46, 77, 0, 1},
+    {56, 78, 0, 1},
+    {56, 79, 0, 1},
+    {56, 80, 0, 1},
+    {56, 81, 0, 1},
+    {16, 82, 0, 1},
+    {14, 83, 0, 1},
+    {14, 84, 0, 1},
+    {2002, 85, 0, 0},
+    {2001, 86, 0, 1},
+    {3001, 87, 0, 1},
+    {9, 88, 0, 1},
+    {9, 89, 0, 1},
+    {65, 90, 0, 1},
+    {58, 91, 0, 1},
+    {9, 92, 0, 1},
+    {2012, 93, 0, 1},
+    {2049, 94, 0, 1},
+    {3001, 95, 0, 1},
+    {3001, 96, 0, 1},
+    {3001, 97, 0, 1},
+    {3001, 98, 0, 1},
+    {3001, 99, 0, 1},
+    {3001, 100, 0, 1},
+    {65, 101, 0, 1},
+    {65, 102, 0, 1},
+    {65, 103, 0, 1},
+    {65, 104, 0, 1},
+    {3001, 105, 0, 1},
+    {3005, 106, 0, 1},
+    {3005, 107, 0, 1},
+    {3005, 108, 0, 1},
+    {71, 109, 0, 1},
+    {71, 110, 0, 1},
+    {2049, 111, 0, 1},
+    {3001, 112, 0, 1},
+    {3001, 113, 0, 1},
+    {3001, 114, 0, 1},
+    {3005, 115, 0, 1},
+    {65, 116, 0, 1},
+    {65, 117, 0, 1},
+    {65, 118, 0, 1},
+    {65, 119, 0, 1},
+    {65, 120, 0, 1},
+    {65, 121, 0, 1},
+    {9, 122, 0, 1},
+    {9, 123, 0, 1},
+    {2004, 124, 0, 0},
+    {2048, 125, 0, 1},
+    {2014, 126, 0, 1},
+    {2014, 127, 0, 1},
+    {2014, 128, 0, 1},
+    {2015, 129, 0, 1},
+    {2015, 130, 0, 1},
+    {2015, 131, 0, 1},
+    {3001, 132, 0, 1},
+    {69, 133, 0, 1},
+    {69, 134, 0, 1},
+    {69, 135, 0, 1},
+    {66, 136, 0, 1},
+    {3001, 137, 0, 1},
+    {3001, 138, 0, 1},
+    {69, 139, 0, 1},
+    {64, 140, 0, 1},
+    {67, 141, 0, 1},
+    {66, 142, 0, 1},
+    {66, 143, 0, 1},
+    {66, 144, 0, 1},
+    {3003, 145, 0, 1},
+    {3003, 146, 0, 1},
+    {71, 147, 0, 1},
+    {9, 148, 0, 1},
+    {9, 149, 0, 1},
+    {9, 150, 0, 1},
+    {9, 151, 0, 1},
+    {9, 152, 0, 1},
+    {9, 153, 0, 1},
+    {9, 154, 0, 1},
+    {9, 155, 0, 1},
+    {9, 156, 0, 1},
+    {9, 157, 0, 1},
+    {2025, 158, 0, 1},
+    {67, 159, 0, 1},
+    {69, 160, 0, 1},
+    {3004, 161, 0, 1},
+    {3004, 162, 0, 1},
+    {3004, 163, 0, 1},
+    {3004, 164, 0, 1},
+    {3004, 165, 0, 1},
+    {3004, 166, 0, 1},
+    {3004, 167, 0, 1},
+    {3004, 168, 0, 1},
+    {3004, 169, 0, 1},
+    {3004, 170, 0, 1},
+    {3004, 171, 0, 1},
+    {3004, 172, 0, 1},
+    {3004, 173, 0, 1},
+    {2046, 174, 0, 1},
+    {17, 175, 0, 1},
+    {2049, 176, 0, 1},
+    {2049, 177, 0, 1},
+    {17, 178, 0, 1},
+    {8, 179, 0, 0},
+    {2048, 180, 0, 1},
+    {2008, 181, 0, 1},
+    {2008, 182, 0, 1},
+    {2008, 183, 0, 1},
+    {2008, 184, 0, 1},
+    {2012, 185, 0, 1},
+    {2012, 186, 0, 1},
+    {2012, 187, 0, 1},
+    {2012, 188, 0, 1},
+    {2012, 189, 0, 1},
+    {2011, 190, 0, 1},
+    {2011, 191, 0, 1},
+    {2012, 192, 0, 1},
+    {2011, 193, 0, 1},
+    {2011, 194, 0, 1},
+    {82, 195, 0, 0},
+    {2049, 196, 0, 1},
+    {2008, 197, 0, 1},
+    {2014, 198, 0, 1},
+    {2014, 199, 0, 1},
+    {2014, 200, 0, 1},
+    {2014, 201, 0, 1},
+    {2014, 202, 0, 1},
+    {2014, 203, 0, 1},
+    {2014, 204, 0, 1},
+    {2014, 205, 0, 1},
+    {2014, 206, 0, 1},
+    {2014, 207, 0, 1},
+    {2015, 208, 0, 1},
+    {2015, 209, 0, 1},
+    {2015, 210, 0, 1},
+    {2015, 211, 0, 1},
+    {2015, 212, 0, 1},
+    {2015, 213, 0, 1},
+    {2012, 214, 0, 1},
+    {2012, 215, 0, 1},
+    {2019, 216, 0, 0},
+    {3005, 217, 0, 1},
+    {3005, 218, 0, 1},
+    {3005, 219, 0, 1},
+    {3005, 220, 0, 1},
+    {3005, 221, 0, 1},
+    {71, 222, 0, 1},
+    {14, 223, 0, 1},
+    {2018, 224, 0, 0},
+    {2011, 225, 0, 1},
+    {2011, 226, 0, 1},
+    {2011, 227, 0, 1},
+    {2011, 228, 0, 1},
+    {2011, 229, 0, 1},
+    {2049, 230, 0, 1},
+    {2012, 231, 0, 1},
+    {2012, 232, 0, 1},
+    {2012, 233, 0, 1},
+    {2049, 234, 0, 1},
+    {8, 235, 0, 0},
+    {2048, 236, 0, 1},
+    {2013, 237, 0, 0},
+    {2025, 238, 0, 1},
+    {2048, 239, 0, 1},
+    {2049, 240, 0, 1},
+    {2023, 241, 0, 0},
+    {2048, 242, 0, 1},
+    {9, 243, 0, 1},
+    {9, 244, 0, 1},
+    {9, 245, 0, 1},
+    {9, 246, 0, 1},
+    {9, 247, 0, 1},
+    {66, 248, 0, 1},
+    {66, 249, 0, 1},
+    {67, 250, 0, 1},
+    {67, 251, 0, 1},
+    {2007, 252, 0, 1},
+    {2007, 253, 0, 1},
+    {2047, 254, 0, 1},
+    {2047, 255, 0, 1},
+    {3001, 256, 0, 1},
+    {3001, 257, 0, 1},
+    {3001, 258, 0, 1},
+    {3001, 259, 0, 1},
+    {3001, 260, 0, 1},
+    {9, 261, 0, 1},
+    {3001, 262, 0, 1},
+    {2023, 263, 0, 0},
+    {11, 264, 0, 1},
+    {11, 265, 0, 1},
+    {11, 266, 0, 1},
+    {11, 267, 0, 1},
+    {2012, 268, 0, 1},
+    {17, 269, 0, 1},
+    {2025, 270, 0, 1},
+    {2025, 271, 0, 1},
+    {67, 272, 0, 1},
+    {2, 273, 0, 1},
+    {3, 274, 0, 1},
+    {4, 275, 0, 1},
+};
+
+
+static const ap_thing_info_t ap_doom2_thing_infos_e3m10[] = 
+{
+    {88, 0, 0, 1},
+    {89, 1, 0, 1},
+    {87, 2, 0, 1},
+    {87, 3, 0, 1},
+    {87, 4, 0, 1},
+    {87, 5, 0, 1},
+    {87, 6, 0, 1},
+    {87, 7, 0, 1},
+    {87, 8, 0, 1},
+    {87, 9, 0, 1},
+    {87, 10, 0, 1},
+    {87, 11, 0, 1},
+    {87, 12, 0, 1},
+    {87, 13, 0, 1},
+    {66, 14, 0, 1},
+    {2046, 15, 0, 1},
+    {2046, 16, 0, 1},
+    {2046, 17, 0, 1},
+    {2046, 18, 0, 1},
+    {2046, 19, 0, 1},
+    {2046, 20, 0, 1},
+    {2046, 21, 0, 1},
+    {2046, 22, 0, 1},
+    {2046, 23, 0, 1},
+    {2046, 24, 0, 1},
+    {2013, 25, 0, 0},
+    {2013, 26, 0, 0},
+    {87, 27, 0, 1},
+    {2013, 28, 0, 0},
+    {2022, 29, 0, 0},
+    {2022, 30, 0, 0},
+    {2022, 31, 0, 0},
+    {2022, 32, 0, 0},
+    {14, 33, 0, 1},
+    {73, 34, 0, 1},
+    {74, 35, 0, 1},
+    {1, 36, 0, 1},
+    {2, 37, 0, 1},
+    {3, 38, 0, 1},
+    {4, 39, 0, 1},
+    {2006, 40, 0, 0},
+    {2002, 41, 0, 0},
+    {2005, 42, 0, 0},
+    {2004, 43, 0, 0},
+    {2003, 44, 0, 0},
+    {2001, 45, 0, 0},
+    {82, 46, 0, 0},
+    {8, 47, 0, 0},
+    {17, 48, 0, 1},
+    {2048, 49, 0, 1},
+    {2048, 50, 0, 1},
+    {2048, 51, 0, 1},
+    {2048, 52, 0, 1},
+    {2046, 53, 0, 1},
+    {2046, 54, 0, 1},
+    {2046, 55, 0, 1},
+    {2046, 56, 0, 1},
+    {2046, 57, 0, 1},
+    {2046, 58, 0, 1},
+    {2046, 59, 0, 1},
+    {2046, 60, 0, 1},
+    {2049, 61, 0, 1},
+    {2049, 62, 0, 1},
+    {2049, 63, 0, 1},
+    {83, 64, 0, 0},
+    {83, 65, 0, 1},
+    {83, 66, 0, 1},
+    {83, 67, 0, 1},
+    {79, 68, 0, 1},
+    {81, 69, 0, 1},
+    {2049, 70, 0, 1},
+    {2048, 71, 0, 1},
+    {2048, 72, 0, 1},
+    {2048, 73, 0, 1},
+    {11, 74, 0, 1},
+    {11, 75, 0, 1},
+    {11, 76, 0, 1},
+    {11, 77, 0, 1},
+    {11, 78, 0, 1},
+    {2006, 79, 0, 1},
+    {2002, 80, 0, 1},
+    {2004, 81, 0, 1},
+    {2003, 82, 0, 1},
+    {2001, 83, 0, 1},
+    {82, 84, 0, 1},
+    {83, 85, 0, 0},
+    {8, 86, 0, 1},
+    {8, 87, 0, 1},
+    {17, 88, 0, 1},
+    {17, 89, 0, 1},
+    {17, 90, 0, 1},
+    {17, 91, 0, 1},
+    {2025, 92, 0, 1},
+    {2025, 93, 0, 1},
+    {2023, 94, 0, 0},
+};
+
+
+ap_level_info_t ap_doom2_level_infos_ep3[] = 
+{
+    {"Nirvana (MAP21)", {true, true, true}, {1, 1, 1}, 8, 217, ap_doom2_thing_infos_e3m1},
+    {"The Catacombs (MAP22)", {true, false, true}, {1, 0, 1}, 8, 121, ap_doom2_thing_infos_e3m2},
+    {"Barrels o' Fun (MAP23)", {false, true, false}, {0, 1, 0}, 11, 431, ap_doom2_thing_infos_e3m3},
+    {"The Chasm (MAP24)", {true, false, true}, {0, 0, 0}, 14, 364, ap_doom2_thing_infos_e3m4},
+    {"Bloodfalls (MAP25)", {true, false, false}, {1, 0, 0}, 11, 276, ap_doom2_thing_infos_e3m5},
+    {"The Abandoned Mines (MAP26)", {true, true, true}, {0, 0, 0}, 12, 296, ap_doom2_thing_infos_e3m6},
+    {"Monster Condo (MAP27)", {true, true, true}, {1, 1, 1}, 30, 490, ap_doom2_thing_infos_e3m7},
+    {"The Spirit World (MAP28)", {false, true, true}, {0, 1, 1}, 22, 266, ap_doom2_thing_infos_e3m8},
+    {"The Living End (MAP29)", {false, false, false}, {0, 0, 0}, 10, 276, ap_doom2_thing_infos_e3m9},
+    {"Icon of Sin (MAP30)", {false, false, false}, {0, 0, 0}, 18, 95, ap_doom2_thing_infos_e3m10},
+};
+
+
+static const ap_thing_info_t ap_doom2_thing_infos_e4m1[] = 
+{
+    {15, 0, 0, 1},
+    {12, 1, 0, 1},
+    {10, 2, 0, 1},
+    {22, 3, 0, 1},
+    {84, 4, 0, 1},
+    {2011, 5, 0, 1},
+    {2011, 6, 0, 1},
+    {2011, 7, 0, 1},
+    {24, 8, 0, 1},
+    {24, 9, 0, 1},
+    {19, 10, 0, 1},
+    {1, 11, 0, 1},
+    {2, 12, 0, 1},
+    {3, 13, 0, 1},
+    {4, 14, 0, 1},
+    {11, 15, 0, 1},
+    {24, 16, 0, 1},
+    {12, 17, 0, 1},
+    {84, 18, 0, 1},
+    {84, 19, 0, 1},
+    {84, 20, 0, 1},
+    {54, 21, 0, 1},
+    {54, 22, 0, 1},
+    {54, 23, 0, 1},
+    {54, 24, 0, 1},
+    {54, 25, 0, 1},
+    {54, 26, 0, 1},
+    {3002, 27, 0, 1},
+    {3002, 28, 0, 1},
+    {3002, 29, 0, 1},
+    {3002, 30, 0, 1},
+    {28, 31, 0, 1},
+    {2014, 32, 0, 1},
+    {2014, 33, 0, 1},
+    {2014, 34, 0, 1},
+    {2014, 35, 0, 1},
+    {3002, 36, 0, 1},
+    {3002, 37, 0, 1},
+    {3002, 38, 0, 1},
+    {3002, 39, 0, 1},
+    {3002, 40, 0, 1},
+    {3002, 41, 0, 1},
+    {3002, 42, 0, 1},
+    {3002, 43, 0, 1},
+    {3002, 44, 0, 1},
+    {84, 45, 0, 1},
+    {84, 46, 0, 1},
+    {84, 47, 0, 1},
+    {84, 48, 0, 1},
+    {84, 49, 0, 1},
+    {84, 50, 0, 1},
+    {84, 51, 0, 1},
+    {84, 52, 0, 1},
+    {3002, 53, 0, 1},
+    {3002, 54, 0, 1},
+    {3002, 55, 0, 1},
+    {3002, 56, 0, 1},
+    {3002, 57, 0, 1},
+    {3002, 58, 0, 1},
+    {3002, 59, 0, 1},
+    {3002, 60, 0, 1},
+    {2035, 61, 0, 1},
+    {2035, 62, 0, 1},
+    {2035, 63, 0, 1},
+    {2035, 64, 0, 1},
+    {24, 65, 0, 1},
+    {84, 66, 0, 1},
+    {84, 67, 0, 1},
+    {84, 68, 0, 1},
+    {84, 69, 0, 1},
+    {84, 70, 0, 1},
+    {84, 71, 0, 1},
+    {84, 72, 0, 1},
+    {84, 73, 0, 1},
+    {2011, 74, 0, 1},
+    {2011, 75, 0, 1},
+    {30, 76, 0, 1},
+    {30, 77, 0, 1},
+    {70, 78, 0, 1},
+    {70, 79, 0, 1},
+    {70, 80, 0, 1},
+    {2011, 81, 0, 1},
+    {84, 82, 0, 1},
+    {84, 83, 0, 1},
+    {84, 84, 0, 1},
+    {84, 85, 0, 1},
+    {84, 86, 0, 1},
+    {84, 87, 0, 1},
+    {84, 88, 0, 1},
+    {84, 89, 0, 1},
+    {84, 90, 0, 1},
+    {84, 91, 0, 1},
+    {84, 92, 0, 1},
+    {84, 93, 0, 1},
+    {84, 94, 0, 1},
+    {84, 95, 0, 1},
+    {84, 96, 0, 1},
+    {84, 97, 0, 1},
+    {25, 98, 0, 1},
+    {84, 99, 0, 1},
+    {84, 100, 0, 1},
+    {84, 101, 0, 1},
+    {84, 102, 0, 1},
+    {2012, 103, 0, 1},
+    {2012, 104, 0, 1},
+    {2010, 105, 0, 1},
+    {2010, 106, 0, 1},
+    {2048, 107, 0, 1},
+    {2010, 108, 0, 1},
+    {2010, 109, 0, 1},
+    {2003, 110, 0, 0},
+    {31, 111, 0, 1},
+    {31, 112, 0, 1},
+    {32, 113, 0, 1},
+    {32, 114, 0, 1},
+    {32, 115, 0, 1},
+    {32, 116, 0, 1},
+    {84, 117, 0, 1},
+    {84, 118, 0, 1},
+    {84, 119, 0, 1},
+    {84, 120, 0, 1},
+    {84, 121, 0, 1},
+    {84, 122, 0, 1},
+    {84, 123, 0, 1},
+    {84, 124, 0, 1},
+    {84, 125, 0, 1},
+    {84, 126, 0, 1},
+    {84, 127, 0, 1},
+    {84, 128, 0, 1},
+    {84, 129, 0, 1},
+    {84, 130, 0, 1},
+    {84, 131, 0, 1},
+    {84, 132, 0, 1},
+    {2008, 133, 0, 1},
+    {2008, 134, 0, 1},
+    {2008, 135, 0, 1},
+    {2008, 136, 0, 1},
+    {2008, 137, 0, 1},
+    {2008, 138, 0, 1},
+    {2001, 139, 0, 0},
+    {84, 140, 0, 1},
+    {84, 141, 0, 1},
+    {84, 142, 0, 1},
+    {84, 143, 0, 1},
+    {84, 144, 0, 1},
+    {84, 145, 0, 1},
+    {84, 146, 0, 1},
+    {84, 147, 0, 1},
+    {2007, 148, 0, 1},
+    {2007, 149, 0, 1},
+    {2007, 150, 0, 1},
+    {2007, 151, 0, 1},
+    {2007, 152, 0, 1},
+    {2007, 153, 0, 1},
+    {2007, 154, 0, 1},
+    {2007, 155, 0, 1},
+    {2015, 156, 0, 1},
+    {2015, 157, 0, 1},
+    {2015, 158, 0, 1},
+    {2015, 159, 0, 1},
+    {2015, 160, 0, 1},
+    {2015, 161, 0, 1},
+    {2015, 162, 0, 1},
+    {2015, 163, 0, 1},
+    {2015, 164, 0, 1},
+    {2015, 165, 0, 1},
+    {2015, 166, 0, 1},
+    {2015, 167, 0, 1},
+    {2015, 168, 0, 1},
+    {2015, 169, 0, 1},
+    {2015, 170, 0, 1},
+    {2015, 171, 0, 1},
+    {2015, 172, 0, 1},
+    {2015, 173, 0, 1},
+    {2015, 174, 0, 1},
+    {2015, 175, 0, 1},
+    {2015, 176, 0, 1},
+    {2015, 177, 0, 1},
+    {2015, 178, 0, 1},
+    {2015, 179, 0, 1},
+    {2015, 180, 0, 1},
+    {2015, 181, 0, 1},
+    {2015, 182, 0, 1},
+    {2015, 183, 0, 1},
+    {84, 184, 0, 1},
+    {84, 185, 0, 1},
+    {84, 186, 0, 1},
+    {84, 187, 0, 1},
+    {84, 188, 0, 1},
+    {84, 189, 0, 1},
+    {84, 190, 0, 1},
+    {84, 191, 0, 1},
+    {84, 192, 0, 1},
+    {84, 193, 0, 1},
+    {84, 194, 0, 1},
+    {84, 195, 0, 1},
+    {84, 196, 0, 1},
+    {84, 197, 0, 1},
+    {84, 198, 0, 1},
+    {84, 199, 0, 1},
+    {84, 200, 0, 1},
+    {84, 201, 0, 1},
+    {84, 202, 0, 1},
+    {84, 203, 0, 1},
+    {2015, 204, 0, 1},
+    {2015, 205, 0, 1},
+    {2015, 206, 0, 1},
+    {2015, 207, 0, 1},
+    {2015, 208, 0, 1},
+    {2015, 209, 0, 1},
+    {2015, 210, 0, 1},
+    {2015, 211, 0, 1},
+    {2015, 212, 0, 1},
+    {2015, 213, 0, 1},
+    {2015, 214, 0, 1},
+    {2015, 215, 0, 1},
+    {2015, 216, 0, 1},
+    {2015, 217, 0, 1},
+    {2015, 218, 0, 1},
+    {2015, 219, 0, 1},
+    {2015, 220, 0, 1},
+    {2015, 221, 0, 1},
+    {2015, 222, 0, 1},
+    {2015, 223, 0, 1},
+    {2015, 224, 0, 1},
+    {2015, 225, 0, 1},
+    {2015, 226, 0, 1},
+    {2015, 227, 0, 1},
+    {2015, 228, 0, 1},
+    {2015, 229, 0, 1},
+    {2015, 230, 0, 1},
+    {2015, 231, 0, 1},
+    {43, 232, 0, 1},
+    {43, 233, 0, 1},
+    {45, 234, 0, 1},
+    {45, 235, 0, 1},
+    {45, 236, 0, 1},
+    {45, 237, 0, 1},
+    {30, 238, 0, 1},
+    {36, 239, 0, 1},
+    {36, 240, 0, 1},
+    {84, 241, 0, 1},
+    {84, 242, 0, 1},
+    {84, 243, 0, 1},
+    {84, 244, 0, 1},
+    {54, 245, 0, 1},
+    {54, 246, 0, 1},
+    {54, 247, 0, 1},
+    {54, 248, 0, 1},
+    {54, 249, 0, 1},
+    {84, 250, 0, 1},
+    {84, 251, 0, 1},
+    {84, 252, 0, 1},
+    {84, 253, 0, 1},
+    {84, 254, 0, 1},
+    {84, 255, 0, 1},
+    {84, 256, 0, 1},
+    {84, 257, 0, 1},
+    {84, 258, 0, 1},
+    {84, 259, 0, 1},
+    {84, 260, 0, 1},
+    {84, 261, 0, 1},
+    {2011, 262, 0, 1},
+    {2023, 263, 0, 0},
+    {84, 264, 0, 1},
+    {84, 265, 0, 1},
+    {84, 266, 0, 1},
+    {84, 267, 0, 1},
+    {2011, 268, 0, 1},
+    {2010, 269, 0, 1},
+    {84, 270, 0, 1},
+    {84, 271, 0, 1},
+    {84, 272, 0, 1},
+    {84, 273, 0, 1},
+    {2011, 274, 0, 1},
+    {2035, 275, 0, 1},
+    {2012, 276, 0, 1},
+    {2012, 277, 0, 1},
+    {2013, 278, 0, 0},
+    {84, 279, 0, 1},
+    {84, 280, 0, 1},
+    {84, 281, 0, 1},
+    {84, 282, 0, 1},
+    {84, 283, 0, 1},
+    {84, 284, 0, 1},
+    {84, 285, 0, 1},
+    {84, 286, 0, 1},
+    {84, 287, 0, 1},
+    {84, 288, 0, 1},
+    {84, 289, 0, 1},
+    {84, 290, 0, 1},
+    {84, 291, 0, 1},
+    {84, 292, 0, 1},
+    {84, 293, 0, 1},
+    {84, 294, 0, 1},
+    {84, 295, 0, 1},
+    {84, 296, 0, 1},
+    {84, 297, 0, 1},
+    {84, 298, 0, 1},
+    {11, 299, 0, 1},
+    {11, 300, 0, 1},
+    {11, 301, 0, 1},
+    {11, 302, 0, 1},
+    {63, 303, 0, 1},
+    {37, 304, 0, 1},
+    {2002, 305, 0, 0},
+    {11, 306, 0, 1},
+    {11, 307, 0, 1},
+    {82, 308, 0, 0},
+    {2024, 309, 0, 0},
+    {83, 310, 0, 0},
+    {8, 311, 0, 0},
+    {8, 312, 0, 0},
+    {8, 313, 0, 0},
+    {8, 314, 0, 0},
+    {2006, 315, 0, 0},
+    {2004, 316, 0, 0},
+};
+
+
+static const ap_thing_info_t ap_doom2_thing_infos_e4m2[] = 
+{
+    {54, 0, 0, 1},
+    {54, 1, 0, 1},
+    {44, 2, 0, 1},
+    {45, 3, 0, 1},
+    {45, 4, 0, 1},
+    {45, 5, 0, 1},
+    {44, 6, 0, 1},
+    {44, 7, 0, 1},
+    {45, 8, 0, 1},
+    {45, 9, 0, 1},
+    {45, 10, 0, 1},
+    {44, 11, 0, 1},
+    {30, 12, 0, 1},
+    {30, 13, 0, 1},
+    {30, 14, 0, 1},
+    {30, 15, 0, 1},
+    {30, 16, 0, 1},
+    {30, 17, 0, 1},
+    {77, 18, 0, 1},
+    {74, 19, 0, 1},
+    {73, 20, 0, 1},
+    {77, 21, 0, 1},
+    {74, 22, 0, 1},
+    {75, 23, 0, 1},
+    {72, 24, 0, 1},
+    {50, 25, 0, 1},
+    {76, 26, 0, 1},
+    {2012, 27, 0, 1},
+    {2012, 28, 0, 1},
+    {2012, 29, 0, 1},
+    {2012, 30, 0, 1},
+    {2012, 31, 0, 1},
+    {2012, 32, 0, 1},
+    {2004, 33, 0, 0},
+    {2047, 34, 0, 1},
+    {2047, 35, 0, 1},
+    {2047, 36, 0, 1},
+    {2047, 37, 0, 1},
+    {2047, 38, 0, 1},
+    {2047, 39, 0, 1},
+    {2047, 40, 0, 1},
+    {2047, 41, 0, 1},
+    {2047, 42, 0, 1},
+    {2047, 43, 0, 1},
+    {2047, 44, 0, 1},
+    {2047, 45, 0, 1},
+    {2047, 46, 0, 1},
+    {2047, 47, 0, 1},
+    {2047, 48, 0, 1},
+    {2047, 49, 0, 1},
+    {2047, 50, 0, 1},
+    {2047, 51, 0, 1},
+    {2047, 52, 0, 1},
+    {2047, 53, 0, 1},
+    {2047, 54, 0, 1},
+    {2047, 55, 0, 1},
+    {2047, 56, 0, 1},
+    {2003, 57, 0, 0},
+    {2046, 58, 0, 1},
+    {2046, 59, 0, 1},
+    {16, 60, 0, 1},
+    {1, 61, 0, 1},
+    {2, 62, 0, 1},
+    {3, 63, 0, 1},
+    {4, 64, 0, 1},
+    {11, 65, 0, 1},
+    {11, 66, 0, 1},
+    {11, 67, 0, 1},
+    {11, 68, 0, 1},
+    {11, 69, 0, 1},
+    {2022, 70, 0, 0},
+    {72, 71, 0, 1},
+    {72, 72, 0, 1},
+    {72, 73, 0, 1},
+    {82, 74, 0, 0},
+    {2006, 75, 0, 0},
+    {2049, 76, 0, 1},
+    {2049, 77, 0, 1},
+    {83, 78, 0, 0},
+    {2002, 79, 0, 0},
+    {2002, 80, 0, 0},
+    {2002, 81, 0, 0},
+    {2023, 82, 0, 0},
+    {84, 83, 0, 1},
+    {84, 84, 0, 1},
+    {84, 85, 0, 1},
+    {84, 86, 0, 1},
+    {84, 87, 0, 1},
+    {84, 88, 0, 1},
+    {84, 89, 0, 1},
+    {84, 90, 0, 1},
+    {84, 91, 0, 1},
+    {84, 92, 0, 1},
+    {84, 93, 0, 1},
+    {84, 94, 0, 1},
+    {84, 95, 0, 1},
+    {84, 96, 0, 1},
+    {84, 97, 0, 1},
+    {84, 98, 0, 1},
+    {84, 99, 0, 1},
+    {84, 100, 0, 1},
+    {84, 101, 0, 1},
+    {84, 102, 0, 1},
+    {84, 103, 0, 1},
+    {84, 104, 0, 1},
+    {84, 105, 0, 1},
+    {84, 106, 0, 1},
+    {84, 107, 0, 1},
+    {84, 108, 0, 1},
+    {84, 109, 0, 1},
+    {84, 110, 0, 1},
+};
+
+
+ap_level_info_t ap_doom2_level_infos_ep4[] = 
+{
+    {"Wolfenstein (MAP31)", {false, false, false}, {0, 0, 0}, 14, 317, ap_doom2_thing_infos_e4m1},
+    {"Grosse (MAP32)", {false, false, false}, {0, 0, 0}, 10, 111, ap_doom2_thing_infos_e4m2},
+};
+
+
+// Episode -> levels
+const ap_episode_info_t ap_doom2_level_infos[] = 
+{
+    {ap_doom2_level_infos_ep1, 11},
+    {ap_doom2_level_infos_ep2, 9},
+    {ap_doom2_level_infos_ep3, 10},
+    {ap_doom2_level_infos_ep4, 2},
+};
+
+
+// Doom type -> sprite. Sorted by doom type
+constexpr ap_type_sprite_t ap_doom2_type_sprites[] = {
+    {5, "BKEYB0"},
+    {6, "YKEYB0"},
+    {8, "BPAKA0"},
+    {13, "RKEYB0"},
+    {17, "CELPA0"},
+    {38, "RSKUB0"},
+    {39, "YSKUB0"},
+    {40, "BSKUB0"},
+    {82, "SGN2A0"},
+    {83, "MEGAD0"},
     {2001, "SHOTA0"},
+    {2002, "MGUNA0"},
     {2003, "LAUNA0"},
     {2004, "PLASA0"},
     {2005, "CSAWA0"},
-    {2002, "MGUNA0"},
     {2006, "BFUGA0"},
-    {82, "SGN2A0"},
+    {2012, "MEDIA0"},
+    {2013, "SOULA0"},
     {2018, "ARM1A0"},
     {2019, "ARM2A0"},
-    {2023, "PSTRA0"},
     {2022, "PINVA0"},
+    {2023, "PSTRA0"},
     {2024, "PINSA0"},
-    {2013, "SOULA0"},
-    {83, "MEGAD0"},
-    {2012, "MEDIA0"},
-    {2048, "AMMOA0"},
+    {2026, "PMAPA0"},
     {2046, "BROKA0"},
+    {2048, "AMMOA0"},
     {2049, "SBOXA0"},
-    {17, "CELPA0"},
-    {2026, "PMAPA0"},
-    {8, "BPAKA0"},
     {65001, "BPAKA0"},
     {65002, "BPAKA0"},
     {65003, "BPAKA0"},
     {65004, "BPAKA0"},
-    {5, "BKEYB0"},
-    {40, "BSKUB0"},
-    {6, "YKEYB0"},
-    {39, "YSKUB0"},
-    {13, "RKEYB0"},
-    {38, "RSKUB0"},
 };
@@ -1,10 +1,48 @@
 #pragma once
 
+#include "apdoom.h"
+#include <cstdint>
+
+
+enum class ap_game_t
+{
+	doom,
+	doom2,
+	heretic
+};
+
 
 // Map item id
 struct ap_item_t
 {
+    int64_t item_id;
     int doom_type;
     int ep; // If doom_type is a keycard
     int map; // If doom_type is a keycard
 };
+
+
+// Location id for a thing index in a level. Index -1 is the level exit
+struct ap_location_t
+{
+    int64_t loc_id;
+    int ep;
+    int map;
+    int index;
+};
+
+
+// Sprite shown in notification icons for a doom type
+struct ap_type_sprite_t
+{
+    int doom_type;
+    const char* sprite;
+};
+
+
+// Levels of an episode
+struct ap_episode_info_t
+{
+    ap_level_info_t* levels;
+    int level_count;
+};
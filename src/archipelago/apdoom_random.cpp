@@ -0,0 +1,631 @@
+//
+// Copyright(C) 2026 APDoom contributors
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+//
+// *Monster and item randomizer plans*
+//
+// A plan is the randomized type of every thing of a level. It only depends on
+// the seed, the level, the randomizer options and the skill, and it is drawn
+// from our own generator so a seed gives the same layout on every platform.
+// Fitting monsters needs the level geometry, so a plan is made the first time
+// its level is entered. It is then kept for the session and in the seed's save
+// directory, and every later load of the level only applies it.
+//
+
+#include "apdoom_random.h"
+#include <json/json.h>
+#include <stdio.h>
+#include <algorithm>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <utility>
+#include <vector>
+
+
+#define AP_RANDOM_PLAN_VERSION 1 // Bump when plans would come out differently
+
+
+static const int FRACUNIT = 1 << 16;
+
+
+enum random_monster_cat_t
+{
+	// Not size, but difficulty
+	rmc_small,
+	rmc_medium,
+	rmc_big,
+	rmc_boss,
+
+	NUM_RMC
+};
+
+
+struct random_monster_def_t
+{
+	int doom_type;
+	int hit_points;
+	int radius;
+	int height;
+	int frequency; // Globally in entire game. This is used for random balanced
+	random_monster_cat_t category;
+	int dont_shuffle;
+};
+
+
+static const random_monster_def_t doom_random_monster_defs[] =
+{
+	{ 3004, 20, 20*FRACUNIT, 56*FRACUNIT, 384, rmc_small }, // Former Human
+	{ 9, 30, 20*FRACUNIT, 56*FRACUNIT, 656, rmc_small }, // Former Human Sergeant
+	{ 3001, 60, 20*FRACUNIT, 56*FRACUNIT, 974, rmc_small }, // Imp
+
+	{ 3002, 150, 30*FRACUNIT, 56*FRACUNIT, 443, rmc_medium }, // Demon
+	{ 58, 150, 30*FRACUNIT, 56*FRACUNIT, 183, rmc_medium }, // SPECTRE
+	{ 3006, 100, 16*FRACUNIT, 56*FRACUNIT, 323, rmc_medium }, // Lost soul
+	{ 3005, 400, 31*FRACUNIT, 56*FRACUNIT, 193, rmc_medium }, // Cacodemon
+
+	{ 3003, 1000, 24*FRACUNIT, 64*FRACUNIT, 82, rmc_big }, // Baron of hell
+
+	{ 16, 4000, 40*FRACUNIT, 110*FRACUNIT, 5, rmc_boss, 1 }, // Cyberdemon
+	{ 7, 3000, 128*FRACUNIT, 100*FRACUNIT, 2, rmc_boss, 1 } // Spiderdemon
+};
+
+
+static const random_monster_def_t doom2_random_monster_defs[] =
+{
+	{ 3004, 20, 20*FRACUNIT, 56*FRACUNIT, 290, rmc_small }, // Former Human
+	{ 9, 30, 20*FRACUNIT, 56*FRACUNIT, 483, rmc_small }, // Former Human Sergeant
+	{ 3001, 60, 20*FRACUNIT, 56*FRACUNIT, 1223, rmc_small }, // Imp
+
+	{ 3002, 150, 30*FRACUNIT, 56*FRACUNIT, 331, rmc_medium }, // Demon
+	{ 58, 150, 30*FRACUNIT, 56*FRACUNIT, 175, rmc_medium }, // SPECTRE
+	{ 3006, 100, 16*FRACUNIT, 56*FRACUNIT, 197, rmc_medium }, // Lost soul
+	{ 3005, 400, 31*FRACUNIT, 56*FRACUNIT, 188, rmc_medium }, // Cacodemon
+
+	{ 3003, 1000, 24*FRACUNIT, 64*FRACUNIT, 31, rmc_big }, // Baron of hell
+
+	{ 16, 4000, 40*FRACUNIT, 110*FRACUNIT, 12, rmc_boss, 1 }, // Cyberdemon
+	{ 7, 3000, 128*FRACUNIT, 100*FRACUNIT, 6, rmc_boss, 1 }, // Spiderdemon
+
+	{ 84, 50, 20*FRACUNIT, 56*FRACUNIT, 156, rmc_small }, // Wolf SS
+	{ 65, 70, 20*FRACUNIT, 56*FRACUNIT, 273, rmc_small }, // Former Human Commando
+
+	{ 71, 400, 31*FRACUNIT, 56*FRACUNIT, 64, rmc_medium }, // Pain Elemental
+	{ 67, 600, 48*FRACUNIT, 64*FRACUNIT, 68, rmc_medium }, // Mancubus
+	{ 68, 500, 64*FRACUNIT, 64*FRACUNIT, 65, rmc_medium }, // Arachnotron
+	{ 66, 300, 20*FRACUNIT, 56*FRACUNIT, 90, rmc_medium }, // Revenant
+
+	{ 64, 700, 20*FRACUNIT, 56*FRACUNIT, 17, rmc_big }, // Archvile
+	{ 69, 500, 24*FRACUNIT, 64*FRACUNIT, 75, rmc_big } // Hell Knight
+};
+
+
+// I feel like these ratios should be per episode. Espideo 4-5 squewing things up a bit
+static const random_monster_def_t heretic_random_monster_defs[] =
+{
+	{ 66, 40, 16*FRACUNIT, 36*FRACUNIT, 1350, rmc_small }, // Gargoyle
+	{ 5, 80, 16*FRACUNIT, 36*FRACUNIT, 626, rmc_small }, // Fire gargoyle
+	{ 68, 80, 22*FRACUNIT, 62*FRACUNIT, 560, rmc_small }, // Golem
+	{ 69, 80, 22*FRACUNIT, 62*FRACUNIT, 137, rmc_small }, // Golem ghost
+	{ 45, 100, 22*FRACUNIT, 62*FRACUNIT, 292, rmc_small }, // Nitrogolem
+	{ 46, 100, 22*FRACUNIT, 62*FRACUNIT, 153, rmc_small }, // Nitrogolem ghost
+
+	{ 64, 200, 24*FRACUNIT, 78*FRACUNIT, 193, rmc_medium }, // Undead Warrior
+	{ 65, 200, 24*FRACUNIT, 78*FRACUNIT, 55, rmc_medium }, // Undead Warrior ghost
+	{ 15, 180, 16*FRACUNIT, 68*FRACUNIT, 476, rmc_medium }, // Disciple of D'Sparil
+	{ 90, 150, 20*FRACUNIT, 64*FRACUNIT, 652, rmc_medium }, // Sabreclaw
+	{ 70, 220, 32*FRACUNIT, 74*FRACUNIT, 248, rmc_medium }, // Weredragon
+	{ 92, 280, 22*FRACUNIT, 70*FRACUNIT, 284, rmc_medium }, // Ophidian
+
+	{ 6, 700, 50*FRACUNIT, 72*FRACUNIT, 108, rmc_big }, // Iron lich (Changed this radius from 40 -> 50 otherwise it gets stuck in stairs)
+
+	{ 9, 3000, 28*FRACUNIT, 100*FRACUNIT, 22, rmc_boss, 1 }, // Maulotaur
+	{ 7, 2000, 28*FRACUNIT, 100*FRACUNIT, 1, rmc_boss, 1 } // D'Sparil 28x100 [Boss, keep them there]
+};
+
+
+// Random balanced keeps the level's ratio of each tier, from least to most valuable
+static const std::vector<int> doom_item_tiers[3] =
+{
+	{ 2015, 2014 }, // armor bonus, health bonus
+	{ 2011, 2008, 2007, 2047, 2010 }, // Stimpack, 4 shotgun shells, clip, energy cell, rocket
+	{ 2048, 2046, 2049, 17, 2012 } // box of bullets, box of rockets, box of shotgun shells, energy cell pack, medikit
+};
+
+
+static const std::vector<int> heretic_item_tiers[3] =
+{
+	{ 81, 10, 18 }, // Crystal Vial, Wand Crystal, Ethereal Arrows
+	{ 54, 22, 20, 13 }, // Claw Orb, Flame Orb, Lesser Runes, Mace Spheres
+	{ 12, 55, 21, 23, 16, 19, 82 } // Crystal Geode, Energy Orb, Greater Runes, Inferno Orb, Pile of Mace Spheres, Quiver of Ethereal Arrows, Quartz Flask
+};
+
+
+// splitmix64. Unlike rand(), it gives the same numbers with every C library.
+class ap_random_t
+{
+public:
+	explicit ap_random_t(uint64_t seed) : m_state(seed) {}
+
+	int next(int range)
+	{
+		uint64_t z = (m_state += 0x9E3779B97F4A7C15ull);
+		z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+		z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+		z ^= z >> 31;
+		return (int)(z % (uint64_t)range);
+	}
+
+private:
+	uint64_t m_state;
+};
+
+
+struct monster_spawn_def_t
+{
+	int index;
+	const random_monster_def_t* og_monster;
+	const random_monster_def_t* monster;
+	int fit_radius;
+	int fit_height;
+};
+
+
+struct thing_plan_t
+{
+	int random_monsters;
+	int random_items;
+	int skill;
+	uint32_t things_hash; // Catches a different WAD
+	std::vector<int> remap;
+};
+
+
+static ap_game_t game;
+static std::string plans_filename;
+static unsigned long long plans_seed = 0;
+static std::map<std::pair<int, int>, thing_plan_t> plans;
+
+
+static void get_monster_defs(const random_monster_def_t*& defs, int& count)
+{
+	switch (game)
+	{
+		case ap_game_t::doom:
+			defs = doom_random_monster_defs;
+			count = sizeof(doom_random_monster_defs) / sizeof(random_monster_def_t);
+			break;
+		case ap_game_t::doom2:
+			defs = doom2_random_monster_defs;
+			count = sizeof(doom2_random_monster_defs) / sizeof(random_monster_def_t);
+			break;
+		case ap_game_t::heretic:
+			defs = heretic_random_monster_defs;
+			count = sizeof(heretic_random_monster_defs) / sizeof(random_monster_def_t);
+			break;
+	}
+}
+
+
+static const std::vector<int>* get_item_tiers()
+{
+	return game == ap_game_t::heretic ? heretic_item_tiers : doom_item_tiers;
+}
+
+
+static int get_item_tier(int doom_type)
+{
+	const std::vector<int>* tiers = get_item_tiers();
+	for (int i = 0; i < 3; ++i)
+		if (std::find(tiers[i].begin(), tiers[i].end(), doom_type) != tiers[i].end())
+			return i;
+	return -1;
+}
+
+
+// The monsters past the E1M8 cutoff are part of the boss fight
+static bool is_spawn_excluded(int ep, int map, const ap_mapthing_t& thing)
+{
+	if (ep != 1 || map != 8)
+		return false;
+	switch (game)
+	{
+		case ap_game_t::doom: return thing.y > 6176;
+		case ap_game_t::heretic: return thing.y < -1984;
+		default: return false;
+	}
+}
+
+
+// Boss levels need enough of a monster to end
+static int get_required_monster_count(int ep, int map, int& doom_type)
+{
+	switch (game)
+	{
+		case ap_game_t::doom:
+			doom_type = 3003; // Baron of hell
+			return (ep == 1 && map == 8) ? 2 : 0;
+		case ap_game_t::heretic:
+			doom_type = 6; // Iron lich
+			if (ep == 1 && map == 8) return 2;
+			if (ep == 4 && map == 8) return 1;
+			return 0;
+		default:
+			return 0;
+	}
+}
+
+
+static void plan_monsters(ap_random_t& rnd, int ep, int map, const ap_mapthing_t* things, int count, int bit, ap_fit_probe_t fit_probe, std::vector<int>& remap)
+{
+	const random_monster_def_t* defs = nullptr;
+	int def_count = 0;
+	get_monster_defs(defs, def_count);
+
+	std::vector<const random_monster_def_t*> monsters;
+	std::vector<monster_spawn_def_t> spawns;
+
+	// Collect spawn points
+	for (int i = 0; i < count; ++i)
+	{
+		const ap_mapthing_t& thing = things[i];
+		if (!(thing.options & bit))
+			continue;
+		if (is_spawn_excluded(ep, map, thing))
+			continue;
+
+		for (int j = 0; j < def_count; ++j)
+		{
+			if (defs[j].dont_shuffle)
+				continue;
+			if (defs[j].doom_type == thing.type)
+			{
+				monster_spawn_def_t spawn = {i, &defs[j], nullptr, 0, 0};
+				fit_probe(thing.x * FRACUNIT, thing.y * FRACUNIT, &spawn.fit_radius, &spawn.fit_height);
+				spawns.push_back(spawn);
+				break;
+			}
+		}
+	}
+
+	int spawn_count = (int)spawns.size();
+	if (spawn_count == 0)
+		return;
+
+	if (ap_state.random_monsters == 1) // Shuffle
+	{
+		for (const auto& spawn : spawns)
+			monsters.push_back(spawn.og_monster);
+	}
+	else if (ap_state.random_monsters == 2) // Random balanced
+	{
+		int ratios[NUM_RMC] = {0};
+		std::vector<const random_monster_def_t*> defs_by_rmc[NUM_RMC];
+		int rmc_ratios[NUM_RMC] = {0};
+		for (int i = 0; i < def_count; ++i)
+		{
+			defs_by_rmc[defs[i].category].push_back(&defs[i]);
+			rmc_ratios[defs[i].category] += defs[i].frequency;
+		}
+
+		for (const auto& spawn : spawns)
+			ratios[spawn.og_monster->category]++;
+
+		while ((int)monsters.size() < spawn_count)
+		{
+			int r = rnd.next(spawn_count);
+			for (int i = 0; i < NUM_RMC; ++i)
+			{
+				if (r < ratios[i])
+				{
+					r = rnd.next(rmc_ratios[i]);
+					for (const random_monster_def_t* monster : defs_by_rmc[i])
+					{
+						if (r < monster->frequency)
+						{
+							monsters.push_back(monster);
+							break;
+						}
+						r -= monster->frequency;
+					}
+					break;
+				}
+				r -= ratios[i];
+			}
+		}
+	}
+	else if (ap_state.random_monsters == 3) // Random chaotic
+	{
+		int total = 0;
+		for (int i = 0; i < def_count; ++i)
+			if (!defs[i].dont_shuffle)
+				total += defs[i].frequency;
+
+		while ((int)monsters.size() < spawn_count)
+		{
+			int r = rnd.next(total);
+			for (int i = 0; i < def_count; ++i)
+			{
+				if (defs[i].dont_shuffle) continue;
+				if (r < defs[i].frequency)
+				{
+					monsters.push_back(&defs[i]);
+					break;
+				}
+				r -= defs[i].frequency;
+			}
+		}
+	}
+
+	// Make sure the boss level has enough of its boss
+	int required_type = 0;
+	int required_count = std::min(get_required_monster_count(ep, map, required_type), spawn_count);
+	if (required_count > 0)
+	{
+		const random_monster_def_t* required_def = nullptr;
+		for (int i = 0; i < def_count; ++i)
+			if (defs[i].doom_type == required_type)
+				required_def = &defs[i];
+
+		int have = 0;
+		for (const random_monster_def_t* monster : monsters)
+			if (monster->doom_type == required_type)
+				have++;
+		while (have < required_count)
+		{
+			int i = rnd.next(spawn_count);
+			if (monsters[i]->doom_type != required_type)
+			{
+				monsters[i] = required_def;
+				have++;
+			}
+		}
+	}
+
+	// Randomly pick them until empty, and place them in different spots
+	for (auto& spawn : spawns)
+	{
+		int idx = rnd.next((int)monsters.size());
+		spawn.monster = monsters[idx];
+		monsters[idx] = monsters.back();
+		monsters.pop_back();
+	}
+
+	// Go through again, and make sure they fit
+	for (int i = 0; i < spawn_count; ++i)
+	{
+		monster_spawn_def_t& spawn1 = spawns[i];
+		if (spawn1.monster->height > spawn1.fit_height ||
+			spawn1.monster->radius > spawn1.fit_radius)
+		{
+			// He doesn't fit here, find another monster randomly that would fit here, then swap
+			int tries = 1000;
+			while (tries--)
+			{
+				int j = rnd.next(spawn_count);
+				if (j == i) continue;
+				monster_spawn_def_t& spawn2 = spawns[j];
+				if (spawn1.monster->height <= spawn2.fit_height &&
+					spawn1.monster->radius <= spawn2.fit_radius &&
+					spawn2.monster->height <= spawn1.fit_height &&
+					spawn2.monster->radius <= spawn1.fit_radius)
+				{
+					std::swap(spawn1.monster, spawn2.monster);
+					break;
+				}
+			}
+		}
+	}
+
+	for (const auto& spawn : spawns)
+		remap[spawn.index] = spawn.monster->doom_type;
+}
+
+
+static void plan_items(ap_random_t& rnd, const ap_mapthing_t* things, int count, int bit, std::vector<int>& remap)
+{
+	const std::vector<int>* tiers = get_item_tiers();
+
+	if (ap_state.random_items == 1) // Shuffle
+	{
+		std::vector<int> items;
+		std::vector<int> indices;
+
+		for (int i = 0; i < count; ++i)
+		{
+			if (things[i].options & 16)
+				continue; // Multiplayer item
+			if (!(things[i].options & bit))
+				continue;
+			if (get_item_tier(things[i].type) == -1)
+				continue;
+			items.push_back(things[i].type);
+			indices.push_back(i);
+		}
+
+		// Randomly pick them until empty, and place them in different spots
+		for (int index : indices)
+		{
+			int idx = rnd.next((int)items.size());
+			remap[index] = items[idx];
+			items[idx] = items.back();
+			items.pop_back();
+		}
+	}
+	else if (ap_state.random_items == 2) // Random balanced
+	{
+		int ratios[3] = {0, 0, 0};
+		int total = 0;
+
+		for (int i = 0; i < count; ++i)
+		{
+			if (things[i].options & 16)
+				continue; // Multiplayer item
+			int tier = get_item_tier(things[i].type);
+			if (tier == -1)
+				continue;
+			ratios[tier]++;
+			total++;
+		}
+
+		for (int i = 0; i < count; ++i)
+		{
+			if (get_item_tier(things[i].type) == -1)
+				continue;
+
+			int r = rnd.next(total);
+			int tier = r < ratios[0] ? 0 : r < ratios[0] + ratios[1] ? 1 : 2;
+			remap[i] = tiers[tier][rnd.next((int)tiers[tier].size())];
+		}
+	}
+}
+
+
+static uint32_t hash_things(const ap_mapthing_t* things, int count)
+{
+	uint32_t hash = 2166136261u; // FNV-1a
+	for (int i = 0; i < count; ++i)
+	{
+		const short fields[] = {things[i].x, things[i].y, things[i].angle, things[i].type, things[i].options};
+		for (short field : fields)
+		{
+			hash = (hash ^ (uint16_t)field) * 16777619u;
+		}
+	}
+	return hash;
+}
+
+
+static void save_plans()
+{
+	Json::Value json;
+	json["version"] = AP_RANDOM_PLAN_VERSION;
+
+	Json::Value json_levels(Json::arrayValue);
+	for (const auto& kv : plans)
+	{
+		const thing_plan_t& plan = kv.second;
+		Json::Value json_level;
+		json_level["ep"] = kv.first.first;
+		json_level["map"] = kv.first.second;
+		json_level["random_monsters"] = plan.random_monsters;
+		json_level["random_items"] = plan.random_items;
+		json_level["skill"] = plan.skill;
+		json_level["things_hash"] = plan.things_hash;
+		Json::Value json_remap(Json::arrayValue);
+		for (int type : plan.remap)
+			json_remap.append(type);
+		json_level["remap"] = json_remap;
+		json_levels.append(json_level);
+	}
+	json["levels"] = json_levels;
+
+	// Only a cache. A broken file is ignored and the plans are made again.
+	std::ostringstream ss;
+	ss << json;
+	if (!AP_WriteFileAtomic(plans_filename, ss.str()))
+		printf("APDOOM: Failed to save randomizer plans\n");
+}
+
+
+static void load_plans()
+{
+	std::ifstream f(plans_filename);
+	if (!f.is_open())
+		return; // Not entered any level yet
+
+	Json::Value json;
+	Json::CharReaderBuilder builder;
+	std::string errors;
+	if (!Json::parseFromStream(builder, f, &json, &errors) ||
+		json["version"].asInt() != AP_RANDOM_PLAN_VERSION)
+	{
+		printf("APDOOM: Ignoring randomizer plans: %s\n", errors.empty() ? "old version" : errors.c_str());
+		return;
+	}
+
+	for (const auto& json_level : json["levels"])
+	{
+		thing_plan_t plan;
+		plan.random_monsters = json_level["random_monsters"].asInt();
+		plan.random_items = json_level["random_items"].asInt();
+		plan.skill = json_level["skill"].asInt();
+		plan.things_hash = json_level["things_hash"].asUInt();
+		for (const auto& type : json_level["remap"])
+			plan.remap.push_back(type.asInt());
+
+		plans[{json_level["ep"].asInt(), json_level["map"].asInt()}] = std::move(plan);
+	}
+}
+
+
+void ap_random_init(ap_game_t in_game, const std::string& save_dir_name, unsigned long long seed)
+{
+	game = in_game;
+	plans_filename = save_dir_name + "/randomizer.json";
+	plans_seed = seed;
+	plans.clear();
+	load_plans();
+}
+
+
+const int* ap_get_thing_remap(ap_level_index_t idx, const ap_mapthing_t* things, int count, int skill, ap_fit_probe_t fit_probe)
+{
+	uint32_t things_hash = hash_things(things, count);
+
+	thing_plan_t& plan = plans[{idx.ep, idx.map}];
+	if (plan.random_monsters == ap_state.random_monsters &&
+		plan.random_items == ap_state.random_items &&
+		plan.skill == skill &&
+		plan.things_hash == things_hash &&
+		(int)plan.remap.size() == count)
+	{
+		return plan.remap.data();
+	}
+
+	int ep = ap_index_to_ep(idx);
+	int map = ap_index_to_map(idx);
+
+	// Unique sequence from ap seed + level
+	ap_random_t rnd(plans_seed + ep * 9 + map);
+
+	plan.random_monsters = ap_state.random_monsters;
+	plan.random_items = ap_state.random_items;
+	plan.skill = skill;
+	plan.things_hash = things_hash;
+	plan.remap.resize(count);
+	for (int i = 0; i < count; ++i)
+		plan.remap[i] = things[i].type;
+
+	// Make sure at the right difficulty level
+	int bit;
+	if (skill == 0) // sk_baby
+		bit = 1;
+	else if (skill == 4) // sk_nightmare
+		bit = 4;
+	else
+		bit = 1 << (skill - 1);
+
+	int do_random_monsters = ap_state.random_monsters;
+	if (game == ap_game_t::doom2 && map == 7) do_random_monsters = 0; // Dead simple needs its mancubi and arachnotrons
+
+	if (do_random_monsters > 0)
+		plan_monsters(rnd, ep, map, things, count, bit, fit_probe, plan.remap);
+	if (ap_state.random_items > 0)
+		plan_items(rnd, things, count, bit, plan.remap);
+
+	// Nothing to keep without randomization, the plan is the level as is
+	if (do_random_monsters > 0 || ap_state.random_items > 0)
+		save_plans();
+	return plan.remap.data();
+}
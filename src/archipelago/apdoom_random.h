@@ -0,0 +1,28 @@
+//
+// Copyright(C) 2026 APDoom contributors
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+//
+// *Monster and item randomizer plans*
+//
+
+#pragma once
+
+#include "apdoom_def_types.h"
+#include <string>
+
+
+// Defined in apdoom.cpp. Writes filename through a temporary file, false on failure
+bool AP_WriteFileAtomic(const std::string& filename, const std::string& data);
+
+// Forget the plans of the previous seed and load the ones saved in its directory
+void ap_random_init(ap_game_t game, const std::string& save_dir_name, unsigned long long seed);
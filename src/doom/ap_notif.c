@@ -9,38 +9,25 @@
 #include "hu_lib.h"
 
 
-typedef struct cached_icon_s
-{
-    patch_t* patch;
-    pixel_t* pixels;
-    struct cached_icon_s* next;
-} cached_icon_t;
-
-static cached_icon_t* cached_icon_start = 0;
-static cached_icon_t* cached_icon_end = 0;
-
 #define ICON_BLOCK_SIZE (AP_NOTIF_SIZE - 4)
+#define ICON_CACHE_SIZE 256 // Must be a power of two, and more than the sprites AP can show
 
 
-cached_icon_t* get_cached_icon(patch_t* patch)
+// Downscaled sprites, hashed by lump number
+typedef struct
 {
-    cached_icon_t* cached_icon = cached_icon_start;
-    while (cached_icon)
-    {
-        if (cached_icon->patch == patch) return cached_icon;
-        cached_icon = cached_icon->next;
-    }
+    int lump; // -1 when the slot is free
+    pixel_t pixels[ICON_BLOCK_SIZE * ICON_BLOCK_SIZE];
+} cached_icon_t;
 
-    // Not cached yet, cache a new one
-    cached_icon = (cached_icon_t*)malloc(sizeof(cached_icon_t));
-    if (cached_icon_end) cached_icon_end->next = cached_icon;
-    cached_icon_end = cached_icon;
-    if (!cached_icon_start) cached_icon_start = cached_icon;
-    cached_icon->patch = patch;
-    cached_icon->pixels = malloc(ICON_BLOCK_SIZE * ICON_BLOCK_SIZE);
-    cached_icon->next = 0;
+static cached_icon_t cached_icons[ICON_CACHE_SIZE];
+static int cached_icons_initialized = 0;
+static cached_icon_t* sprite_icons[ICON_CACHE_SIZE]; // By ap_get_notification_sprite() index
+static patch_t* notif_bg = 0;
 
 
+static void build_icon(cached_icon_t* cached_icon, patch_t* patch)
+{
     pixel_t* raw = malloc(patch->width * patch->height);
     memset(raw, 0, patch->width * patch->height);
 
@@ -90,29 +77,72 @@ cached_icon_t* get_cached_icon(patch_t* patch)
     }
 
     free(raw);
-    return cached_icon;
+}
+
+
+static cached_icon_t* get_cached_icon(int lump)
+{
+    if (!cached_icons_initialized)
+    {
+        for (int i = 0; i < ICON_CACHE_SIZE; ++i)
+            cached_icons[i].lump = -1;
+        cached_icons_initialized = 1;
+    }
+
+    unsigned int slot = ((unsigned int)lump * 2654435761u) & (ICON_CACHE_SIZE - 1);
+    for (int i = 0; i < ICON_CACHE_SIZE; ++i)
+    {
+        cached_icon_t* cached_icon = &cached_icons[slot];
+        if (cached_icon->lump == lump) return cached_icon;
+        if (cached_icon->lump == -1)
+        {
+            // Not cached yet, cache a new one
+            cached_icon->lump = lump;
+            build_icon(cached_icon, W_CacheLumpNum(lump, PU_CACHE));
+            return cached_icon;
+        }
+        slot = (slot + 1) & (ICON_CACHE_SIZE - 1);
+    }
+
+    return 0; // Full
+}
+
+
+// Cache every icon up front, so none get built mid game
+void ap_notif_init(void)
+{
+    const char* sprite;
+
+    notif_bg = W_CacheLumpName("NOTIFBG", PU_STATIC);
+    for (int i = 0; i < ICON_CACHE_SIZE && (sprite = ap_get_notification_sprite(i)); ++i)
+    {
+        int lump = W_CheckNumForName(sprite);
+        if (lump >= 0) sprite_icons[i] = get_cached_icon(lump);
+    }
 }
 
 
 void ap_notif_draw(void)
 {
+    int notif_first;
     int notif_count;
-    const ap_notification_icon_t* notifs = ap_get_notification_icons(&notif_count);
+    const ap_notification_icon_t* notifs = ap_get_notification_icons(&notif_first, &notif_count);
 
     for (int i = 0; i < notif_count; ++i)
     {
-        const ap_notification_icon_t* notif = notifs + i;
-        if (notif->state == AP_NOTIF_STATE_PENDING) continue;
+        const ap_notification_icon_t* notif = notifs + ((notif_first + i) & (AP_NOTIF_MAX - 1));
+        if (notif->state == AP_NOTIF_STATE_PENDING ||
+            notif->state == AP_NOTIF_STATE_REMOVED) continue;
 
-        patch_t* patch = W_CacheLumpName(notif->sprite, PU_CACHE);
-        if (!patch) continue;
-        cached_icon_t* cached_icon = get_cached_icon(patch);
+        if (notif->sprite_index < 0 || notif->sprite_index >= ICON_CACHE_SIZE) continue;
+        cached_icon_t* cached_icon = sprite_icons[notif->sprite_index];
+        if (!cached_icon) continue;
 
         int center_y = 172 + notif->y;
 
         V_DrawPatch(notif->x - AP_NOTIF_SIZE / 2 - WIDESCREENDELTA, 
                     center_y - AP_NOTIF_SIZE / 2, 
-                    W_CacheLumpName("NOTIFBG", PU_CACHE));
+                    notif_bg);
         V_DrawScaledBlockTransparency(
             notif->x - ICON_BLOCK_SIZE / 2 - WIDESCREENDELTA,
             center_y - ICON_BLOCK_SIZE / 2,
@@ -50,6 +50,8 @@
 #include "m_config.h"
 #include "m_controls.h"
 #include "m_misc.h"
+#include "m_profile.h" // [AP] -benchmark
+#include "m_snapshot.h" // [AP] compress_savegames
 #include "m_menu.h"
 #include "p_saveg.h"
 
@@ -675,6 +677,7 @@ void D_BindVariables(void)
     // [crispy] unconditionally disable savegame and demo limits
 //  M_BindIntVariable("vanilla_savegame_limit", &vanilla_savegame_limit);
 //  M_BindIntVariable("vanilla_demo_limit",     &vanilla_demo_limit);
+    M_BindIntVariable("compress_savegames",     &compress_savegames); // [AP]
     M_BindIntVariable("a11y_sector_lighting",   &a11y_sector_lighting);
     M_BindIntVariable("a11y_extra_lighting",    &a11y_extra_lighting);
     M_BindIntVariable("a11y_weapon_flash",      &a11y_weapon_flash);
@@ -1776,6 +1779,10 @@ void D_DoomMain (void)
         ap_settings.reset_level_on_death = atoi(myargv[reset_level_on_death_id + 1]) ? 1 : 0;
     }
 
+    int items_per_tic_id = M_CheckParmWithArgs("-apitemspertic", 1);
+    if (items_per_tic_id)
+        ap_settings.items_per_tic = atoi(myargv[items_per_tic_id + 1]);
+
     
     // Grab parameters for AP
     int apserver_arg_id = M_CheckParmWithArgs("-apserver", 1);
@@ -2755,6 +2762,8 @@ void D_DoomMain (void)
     DEH_printf("ST_Init: Init status bar.\n");
     ST_Init ();
 
+    ap_notif_init();
+
     // If Doom II without a MAP01 lump, this is a store demo.
     // Moved this here so that MAP01 isn't constantly looked up
     // in the main loop.
@@ -2784,6 +2793,8 @@ void D_DoomMain (void)
 	autostart = true;
     }
 
+    M_ProfileInit(); // [AP] -benchmark
+
     p = M_CheckParmWithArgs("-playdemo", 1);
     if (p)
     {
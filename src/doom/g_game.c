@@ -35,7 +35,9 @@
 #include "m_controls.h"
 #include "m_misc.h"
 #include "m_menu.h"
+#include "m_profile.h" // [AP] -benchmark
 #include "m_random.h"
+#include "m_snapshot.h" // [AP] level savegames cache
 #include "i_joystick.h"
 #include "i_system.h"
 #include "i_timer.h"
@@ -1514,7 +1516,9 @@ void G_Ticker (void)
     switch (gamestate) 
     { 
       case GS_LEVEL: 
-	P_Ticker (); 
+	M_ProfileStart(PROF_TICKER); // [AP] -benchmark
+	P_Ticker ();
+	M_ProfileStop(PROF_TICKER);
 	ST_Ticker (); 
 	AM_Ticker (); 
 	HU_Ticker ();
@@ -2406,6 +2410,9 @@ extern mobj_t *just_loaded_hub;
 int savedleveltime = 0; // [crispy] moved here for level time logging
 void G_DoLoadGame (void) 
 { 
+    byte *savedata;
+    size_t savelength;
+
     leveltimesinceload = 0;
     just_loaded_hub = 0;
 	 
@@ -2420,13 +2427,16 @@ void G_DoLoadGame (void)
     }
     gameaction = ga_nothing; 
 	 
-    save_stream = M_fopen(savename, "rb");
+    // [AP] recently played levels come straight from memory
+    savedata = M_SnapshotLoad(savename, &savelength);
 
-    if (save_stream == NULL)
+    if (savedata == NULL)
     {
         I_Error("Could not load savegame %s", savename);
     }
 
+    M_SaveBufOpen(&save_stream, savedata, savelength);
+
     // [crispy] read extended savegame data,
     //          first pass: read "savewadfilename"
     P_ReadExtendedSaveGameData(0);
@@ -2440,7 +2450,7 @@ void G_DoLoadGame (void)
             strcasecmp(savewadfilename, W_WadNameForLump(savemaplumpinfo)))
         {
             M_ForceLoadGame();
-            fclose(save_stream);
+            M_SaveBufFree(&save_stream);
             return;
         }
         else
@@ -2459,7 +2469,7 @@ void G_DoLoadGame (void)
         // [crispy] indicate game version mismatch
         extern void M_LoadGameVerMismatch ();
         M_LoadGameVerMismatch();
-        fclose(save_stream);
+        M_SaveBufFree(&save_stream);
         return;
     }
 
@@ -2486,7 +2496,7 @@ void G_DoLoadGame (void)
     // [crispy] read more extended savegame data
     P_ReadExtendedSaveGameData(1);
 
-    fclose(save_stream);
+    M_SaveBufFree(&save_stream);
     
     if (setsizeneeded)
 	R_ExecuteSetViewSize ();
@@ -2565,31 +2575,15 @@ void G_DoSaveGame (void)
         snprintf(filename, 260, "%s/save_MAP%02i.dsg", apdoom_get_seed(), gamemap);
 
     char *savegame_file;
-    char *temp_savegame_file;
-    char *recovery_savegame_file;
+    byte *savedata;
+    size_t savelength;
 
-    recovery_savegame_file = NULL;
-    temp_savegame_file = P_TempSaveGameFile();
     savegame_file = filename;//P_SaveGameFile(savegameslot);
 
-    // Open the savegame file for writing.  We write to a temporary file
-    // and then rename it at the end if it was successfully written.
-    // This prevents an existing savegame from being overwritten by
-    // a corrupted one, or if a savegame buffer overrun occurs.
-    save_stream = M_fopen(temp_savegame_file, "wb");
-
-    if (save_stream == NULL)
-    {
-        // Failed to save the game, so we're going to have to abort. But
-        // to be nice, save to somewhere else before we call I_Error().
-        recovery_savegame_file = M_TempFile("recovery.dsg");
-        save_stream = M_fopen(recovery_savegame_file, "wb");
-        if (save_stream == NULL)
-        {
-            I_Error("Failed to open either '%s' or '%s' to write savegame.",
-                    temp_savegame_file, recovery_savegame_file);
-        }
-    }
+    // [AP] Serialize to memory. The snapshot cache keeps the level for a
+    // quick return and writes it out in the background, to a temporary
+    // file which is renamed over the savegame once complete.
+    M_SaveBufCreate(&save_stream);
 
     savegame_error = false;
 
@@ -2627,25 +2621,8 @@ void G_DoSaveGame (void)
     }
     */
 
-    // Finish up, close the savegame file.
-
-    fclose(save_stream);
-
-    if (recovery_savegame_file != NULL)
-    {
-        // We failed to save to the normal location, but we wrote a
-        // recovery file to the temp directory. Now we can bomb out
-        // with an error.
-        I_Error("Failed to open savegame file '%s' for writing.\n"
-                "But your game has been saved to '%s' for recovery.",
-                temp_savegame_file, recovery_savegame_file);
-    }
-
-    // Now rename the temporary savegame file to the actual savegame
-    // file, overwriting the old savegame if there was one there.
-
-    M_remove(savegame_file);
-    M_rename(temp_savegame_file, savegame_file);
+    savedata = M_SaveBufDetach(&save_stream, &savelength);
+    M_SnapshotStore(savegame_file, savedata, savelength);
 
     gameaction = ga_nothing;
     M_StringCopy(savedescription, "", sizeof(savedescription));
@@ -28,6 +28,7 @@
 #include "i_video.h"
 #include "g_game.h"
 #include "m_misc.h"
+#include "m_snapshot.h"
 #include "hu_lib.h"
 #include "hu_stuff.h"
 #include <math.h>
@@ -230,7 +231,7 @@ void play_level(int ep, int lvl)
     else
         snprintf(filename, 260, "%s/save_MAP%02i.dsg", apdoom_get_seed(), lvl);
 
-    if (M_FileExists(filename))
+    if (M_SnapshotExists(filename)) // [AP] may still be queued for writing
     {
         // We load
         extern char savename[256];
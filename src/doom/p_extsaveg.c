@@ -40,7 +40,7 @@ static char *line, *string;
 static void P_WritePackageTarname (const char *key)
 {
 	M_snprintf(line, MAX_LINE_LEN, "%s %s\n", key, PACKAGE_VERSION);
-	fputs(line, save_stream);
+	M_SaveBufPuts(&save_stream, line);
 }
 
 // maplumpinfo->wad_file->basename
@@ -50,7 +50,7 @@ char *savewadfilename = NULL;
 static void P_WriteWadFileName (const char *key)
 {
 	M_snprintf(line, MAX_LINE_LEN, "%s %s\n", key, W_WadNameForLump(maplumpinfo));
-	fputs(line, save_stream);
+	M_SaveBufPuts(&save_stream, line);
 }
 
 static void P_ReadWadFileName (const char *key)
@@ -78,7 +78,7 @@ static void P_WriteExtraKills (const char *key)
 	if (extrakills)
 	{
 		M_snprintf(line, MAX_LINE_LEN, "%s %d\n", key, extrakills);
-		fputs(line, save_stream);
+		M_SaveBufPuts(&save_stream, line);
 	}
 }
 
@@ -100,7 +100,7 @@ static void P_WriteTotalLevelTimes (const char *key)
 	if (totalleveltimes)
 	{
 		M_snprintf(line, MAX_LINE_LEN, "%s %d\n", key, totalleveltimes);
-		fputs(line, save_stream);
+		M_SaveBufPuts(&save_stream, line);
 	}
 }
 
@@ -135,7 +135,7 @@ static void P_WriteFireFlicker (const char *key)
 			           (int)flick->count,
 			           (int)flick->maxlight,
 			           (int)flick->minlight);
-			fputs(line, save_stream);
+			M_SaveBufPuts(&save_stream, line);
 		}
 	}
 }
@@ -182,7 +182,7 @@ static void P_WriteSoundTarget (const char *key)
 			           key,
 			           i,
 			           P_ThinkerToIndex((thinker_t *) sector->soundtarget));
-			fputs(line, save_stream);
+			M_SaveBufPuts(&save_stream, line);
 		}
 	}
 }
@@ -216,7 +216,7 @@ static void P_WriteOldSpecial (const char *key)
 			           key,
 			           i,
 			           sector->oldspecial);
-			fputs(line, save_stream);
+			M_SaveBufPuts(&save_stream, line);
 		}
 	}
 }
@@ -250,7 +250,7 @@ static void P_WriteRLightlevel (const char *key)
 			           key,
 			           i,
 			           (int)sector->rlightlevel);
-			fputs(line, save_stream);
+			M_SaveBufPuts(&save_stream, line);
 		}
 	}
 }
@@ -289,7 +289,7 @@ static void P_WriteButton (const char *key)
 			           (int)button->where,
 			           (int)button->btexture,
 			           (int)button->btimer);
-			fputs(line, save_stream);
+			M_SaveBufPuts(&save_stream, line);
 		}
 	}
 }
@@ -330,7 +330,7 @@ static void P_WriteBrainTarget (const char *key)
 				           key,
 				           numbraintargets,
 				           braintargeton);
-				fputs(line, save_stream);
+				M_SaveBufPuts(&save_stream, line);
 
 				// [crispy] return after the first brain spitter is found
 				return;
@@ -371,7 +371,7 @@ static void P_WriteMarkPoints (const char *key)
 		           p[5], p[6], p[7], p[8], p[9],
 		           p[10], p[11], p[12], p[13], p[14],
 		           p[15], p[16], p[17], p[18], p[19]);
-		fputs(line, save_stream);
+		M_SaveBufPuts(&save_stream, line);
 	}
 }
 
@@ -403,7 +403,7 @@ static void P_WritePlayersLookdir (const char *key)
 		if (playeringame[i] && players[i].lookdir)
 		{
 			M_snprintf(line, MAX_LINE_LEN, "%s %d %d\n", key, i, players[i].lookdir);
-			fputs(line, save_stream);
+			M_SaveBufPuts(&save_stream, line);
 		}
 	}
 }
@@ -433,7 +433,7 @@ static void P_WriteMusInfo (const char *key)
 		strncpy(orig, lumpinfo[musinfo.items[0]]->name, 8);
 
 		M_snprintf(line, MAX_LINE_LEN, "%s %s %s\n", key, lump, orig);
-		fputs(line, save_stream);
+		M_SaveBufPuts(&save_stream, line);
 	}
 }
 
@@ -507,7 +507,7 @@ void P_WriteExtendedSaveGameData (void)
 
 static void P_ReadKeyValuePairs (int pass)
 {
-	while (fgets(line, MAX_LINE_LEN, save_stream))
+	while (M_SaveBufGets(&save_stream, line, MAX_LINE_LEN))
 	{
 		if (sscanf(line, "%s", string) == 1)
 		{
@@ -549,12 +549,12 @@ void P_ReadExtendedSaveGameData (int pass)
 		return;
 	}
 
-	curpos = ftell(save_stream);
+	curpos = M_SaveBufTell(&save_stream);
 
 	// [crispy] check which map we would want to load
-	fseek(save_stream, SAVESTRINGSIZE + VERSIONSIZE + 1, SEEK_SET); // [crispy] + 1 for "gameskill"
-	if (fread(&episode, 1, 1, save_stream) == 1 &&
-	    fread(&map, 1, 1, save_stream) == 1)
+	M_SaveBufSeek(&save_stream, SAVESTRINGSIZE + VERSIONSIZE + 1, SEEK_SET); // [crispy] + 1 for "gameskill"
+	if (M_SaveBufRead(&save_stream, &episode, 1) == 1 &&
+	    M_SaveBufRead(&save_stream, &map, 1) == 1)
 	{
 		lumpnum = P_GetNumForMap ((int) episode, (int) map, false);
 	}
@@ -570,23 +570,23 @@ void P_ReadExtendedSaveGameData (int pass)
 	}
 
 	// [crispy] read key/value pairs past the end of the regular savegame data
-	fseek(save_stream, 0, SEEK_END);
-	endpos = ftell(save_stream);
+	M_SaveBufSeek(&save_stream, 0, SEEK_END);
+	endpos = M_SaveBufTell(&save_stream);
 
 	for (p = endpos - 1; p > 0; p--)
 	{
 		byte curbyte;
 
-		fseek(save_stream, p, SEEK_SET);
+		M_SaveBufSeek(&save_stream, p, SEEK_SET);
 
-		if (fread(&curbyte, 1, 1, save_stream) < 1)
+		if (M_SaveBufRead(&save_stream, &curbyte, 1) < 1)
 		{
 			break;
 		}
 
 		if (curbyte == SAVEGAME_EOF)
 		{
-			if (!fgets(line, MAX_LINE_LEN, save_stream))
+			if (!M_SaveBufGets(&save_stream, line, MAX_LINE_LEN))
 			{
 				continue;
 			}
@@ -604,5 +604,5 @@ void P_ReadExtendedSaveGameData (int pass)
 	free(string);
 
 	// [crispy] back to where we started
-	fseek(save_stream, curpos, SEEK_SET);
+	M_SaveBufSeek(&save_stream, curpos, SEEK_SET);
 }
@@ -20,7 +20,7 @@
 #ifndef __P_SAVEG__
 #define __P_SAVEG__
 
-#include <stdio.h>
+#include "m_savebuf.h"
 
 #define SAVEGAME_EOF 0x1d
 #define VERSIONSIZE 16
@@ -59,7 +59,7 @@ void P_ArchiveSpecials (void);
 void P_UnArchiveSpecials (void);
 void P_RestoreTargets (void);
 
-extern FILE *save_stream;
+extern savebuf_t save_stream;
 extern boolean savegame_error;
 
 
@@ -139,22 +139,22 @@ fixed_t GetOffset(vertex_t *v1, vertex_t *v2)
 //
 void P_LoadVertexes (int lump)
 {
-    byte*		data;
+    lumpview_t		view;
     int			i;
-    mapvertex_t*	ml;
+    const mapvertex_t*	ml;
     vertex_t*		li;
 
+    // [AP] Read straight from the WAD.
+    W_OpenLumpView(lump, WAD_ADVICE_SEQUENTIAL, &view);
+
     // Determine number of lumps:
     //  total lump length / vertex record length.
-    numvertexes = W_LumpLength (lump) / sizeof(mapvertex_t);
+    numvertexes = view.length / sizeof(mapvertex_t);
 
     // Allocate zone memory for buffer.
     vertexes = Z_Malloc (numvertexes*sizeof(vertex_t),PU_LEVEL,0);	
 
-    // Load data into cache.
-    data = W_CacheLumpNum (lump, PU_STATIC);
-	
-    ml = (mapvertex_t *)data;
+    ml = (const mapvertex_t *)view.data;
     li = vertexes;
 
     // Copy and convert vertex coordinates,
@@ -170,8 +170,7 @@ void P_LoadVertexes (int lump)
 	li->moved = false;
     }
 
-    // Free buffer memory.
-    W_ReleaseLumpNum(lump);
+    W_CloseLumpView(&view);
 }
 
 //
@@ -198,21 +197,21 @@ sector_t* GetSectorAtNullAddress(void)
 //
 void P_LoadSegs (int lump)
 {
-    byte*		data;
+    lumpview_t		view;
     int			i;
-    mapseg_t*		ml;
+    const mapseg_t*	ml;
     seg_t*		li;
     line_t*		ldef;
     int			linedef;
     int			side;
     int                 sidenum;
 	
-    numsegs = W_LumpLength (lump) / sizeof(mapseg_t);
+    W_OpenLumpView(lump, WAD_ADVICE_SEQUENTIAL, &view); // [AP]
+    numsegs = view.length / sizeof(mapseg_t);
     segs = Z_Malloc (numsegs*sizeof(seg_t),PU_LEVEL,0);	
     memset (segs, 0, numsegs*sizeof(seg_t));
-    data = W_CacheLumpNum (lump,PU_STATIC);
 	
-    ml = (mapseg_t *)data;
+    ml = (const mapseg_t *)view.data;
     li = segs;
     for (i=0 ; i<numsegs ; i++, li++, ml++)
     {
@@ -277,7 +276,7 @@ void P_LoadSegs (int lump)
         }
     }
 	
-    W_ReleaseLumpNum(lump);
+    W_CloseLumpView(&view);
 }
 
 // [crispy] fix long wall wobble
@@ -377,35 +376,25 @@ void P_LoadSubsectors (int lump)
 //
 void P_LoadSectors (int lump)
 {
-    byte*		data;
+    lumpview_t		view;
     int			i;
-    mapsector_t*	ms;
+    const mapsector_t*	ms;
     sector_t*		ss;
 	
     // [crispy] fail on missing sectors
     if (lump >= numlumps)
 	I_Error("P_LoadSectors: No sectors in map!");
 
-    numsectors = W_LumpLength (lump) / sizeof(mapsector_t);
+    W_OpenLumpView(lump, WAD_ADVICE_SEQUENTIAL, &view); // [AP]
+    numsectors = view.length / sizeof(mapsector_t);
     sectors = Z_Malloc (numsectors*sizeof(sector_t),PU_LEVEL,0);	
     memset (sectors, 0, numsectors*sizeof(sector_t));
-    data = W_CacheLumpNum (lump,PU_STATIC);
 	
     // [crispy] fail on missing sectors
-    if (!data || !numsectors)
+    if (!numsectors)
 	I_Error("P_LoadSectors: No sectors in map!");
 
-    ms = (mapsector_t *)data;
-
-    if (gamemode == commercial)
-    {
-        // Doom II
-        if (gamemap == 12)
-        {
-            ms[132].tag = 42;
-            sprintf(ms[132].floorpic, "STEP1");
-        }
-    }
+    ms = (const mapsector_t *)view.data;
 
     ss = sectors;
     for (i=0 ; i<numsectors ; i++, ss++, ms++)
@@ -433,8 +422,19 @@ void P_LoadSectors (int lump)
         // [crispy] inhibit sector interpolation during the 0th gametic
         ss->oldgametic = -1;
     }
+
+    // [AP] Fixes are applied to the loaded sectors, the view is read-only.
+    if (gamemode == commercial)
+    {
+        // Doom II
+        if (gamemap == 12 && numsectors > 132)
+        {
+            sectors[132].tag = 42;
+            sectors[132].floorpic = R_FlatNumForName("STEP1");
+        }
+    }
 	
-    W_ReleaseLumpNum(lump);
+    W_CloseLumpView(&view);
 }
 
 
@@ -500,181 +500,75 @@ void P_LoadNodes (int lump)
 }
 
 
-static unsigned long long hash_seed(unsigned char *str)
-{
-    unsigned long long hash = 5381;
-    int c;
-
-    while (c = *str++)
-        hash = ((hash << 5) + hash) + c; /* hash * 33 + c */
-
-    return hash;
-}
-
-
-typedef enum
-{
-    // Not size, but difficulty
-    rmc_small,
-    rmc_medium,
-    rmc_big,
-    rmc_boss,
-
-    NUM_RMC
-} random_monster_cat_t;
-
-
-typedef struct
-{
-    int doom_type;
-    int hit_points;
-    int radius;
-    int height;
-    int frequency; // Globally in entire game. This is used for random balanced
-    random_monster_cat_t category;
-    int dont_shuffle;
-} random_monster_def_t;
-
-
-static random_monster_def_t doom_random_monster_defs[] =
-{
-    { 3004, 20, 20*FRACUNIT, 56*FRACUNIT, 384, rmc_small }, // Former Human
-    { 9, 30, 20*FRACUNIT, 56*FRACUNIT, 656, rmc_small }, // Former Human Sergeant
-    { 3001, 60, 20*FRACUNIT, 56*FRACUNIT, 974, rmc_small }, // Imp
-
-    { 3002, 150, 30*FRACUNIT, 56*FRACUNIT, 443, rmc_medium }, // Demon
-    { 58, 150, 30*FRACUNIT, 56*FRACUNIT, 183, rmc_medium }, // SPECTRE
-    { 3006, 100, 16*FRACUNIT, 56*FRACUNIT, 323, rmc_medium }, // Lost soul
-    { 3005, 400, 31*FRACUNIT, 56*FRACUNIT, 193, rmc_medium }, // Cacodemon
-
-    { 3003, 1000, 24*FRACUNIT, 64*FRACUNIT, 82, rmc_big }, // Baron of hell
+//
+// [AP] Fit probing for random monster placement. The lines that can keep a
+// monster from standing at a spawn are gathered once for the largest radius,
+// then every smaller radius only tests those.
+//
 
-    { 16, 4000, 40*FRACUNIT, 110*FRACUNIT, 5, rmc_boss, 1 }, // Cyberdemon
-    { 7, 3000, 128*FRACUNIT, 100*FRACUNIT, 2, rmc_boss, 1 } // Spiderdemon
+static const fixed_t fit_radii[] = {
+    128*FRACUNIT,
+    64*FRACUNIT,
+    48*FRACUNIT,
+    40*FRACUNIT,
+    31*FRACUNIT,
+    30*FRACUNIT,
+    24*FRACUNIT,
+    20*FRACUNIT,
+    16*FRACUNIT
 };
 
-
-static random_monster_def_t doom2_random_monster_defs[] =
-{
-    { 3004, 20, 20*FRACUNIT, 56*FRACUNIT, 290, rmc_small }, // Former Human
-    { 9, 30, 20*FRACUNIT, 56*FRACUNIT, 483, rmc_small }, // Former Human Sergeant
-    { 3001, 60, 20*FRACUNIT, 56*FRACUNIT, 1223, rmc_small }, // Imp
-
-    { 3002, 150, 30*FRACUNIT, 56*FRACUNIT, 331, rmc_medium }, // Demon
-    { 58, 150, 30*FRACUNIT, 56*FRACUNIT, 175, rmc_medium }, // SPECTRE
-    { 3006, 100, 16*FRACUNIT, 56*FRACUNIT, 197, rmc_medium }, // Lost soul
-    { 3005, 400, 31*FRACUNIT, 56*FRACUNIT, 188, rmc_medium }, // Cacodemon
-
-    { 3003, 1000, 24*FRACUNIT, 64*FRACUNIT, 31, rmc_big }, // Baron of hell
-
-    { 16, 4000, 40*FRACUNIT, 110*FRACUNIT, 12, rmc_boss, 1 }, // Cyberdemon
-    { 7, 3000, 128*FRACUNIT, 100*FRACUNIT, 6, rmc_boss, 1 }, // Spiderdemon
-
-    { 84, 50, 20*FRACUNIT, 56*FRACUNIT, 156, rmc_small }, // Wolf SS
-    { 65, 70, 20*FRACUNIT, 56*FRACUNIT, 273, rmc_small }, // Former Human Commando
-
-    { 71, 400, 31*FRACUNIT, 56*FRACUNIT, 64, rmc_medium }, // Pain Elemental
-    { 67, 600, 48*FRACUNIT, 64*FRACUNIT, 68, rmc_medium }, // Mancubus
-    { 68, 500, 64*FRACUNIT, 64*FRACUNIT, 65, rmc_medium }, // Arachnotron
-    { 66, 300, 20*FRACUNIT, 56*FRACUNIT, 90, rmc_medium }, // Revenant
-
-    { 64, 700, 20*FRACUNIT, 56*FRACUNIT, 17, rmc_big }, // Archvile
-    { 69, 500, 24*FRACUNIT, 64*FRACUNIT, 75, rmc_big } // Hell Knight
+static const fixed_t fit_heights[] = {
+    110*FRACUNIT,
+    100*FRACUNIT,
+    64*FRACUNIT,
+    56*FRACUNIT
 };
 
+static fixed_t fit_bbox[4];
+static line_t **fit_lines;
+static int fit_lines_count;
+static int fit_lines_max;
 
-typedef struct
-{
-    int index;
-    random_monster_def_t* og_monster;
-    random_monster_def_t* monster;
-    fixed_t fit_radius;
-    fixed_t fit_height;
-} monster_spawn_def_t;
-
-
-
-extern fixed_t tmbbox[4];
-extern int tmflags;
-extern fixed_t tmx;
-extern fixed_t tmy;
-fixed_t tmradius;
 
-
-boolean PIT_CheckLine_NoFlags(line_t* ld)
+static void SetFitBox(fixed_t x, fixed_t y, fixed_t radius)
 {
-    if (tmbbox[BOXRIGHT] <= ld->bbox[BOXLEFT]
-     || tmbbox[BOXLEFT] >= ld->bbox[BOXRIGHT]
-     || tmbbox[BOXTOP] <= ld->bbox[BOXBOTTOM]
-     || tmbbox[BOXBOTTOM] >= ld->bbox[BOXTOP])
-        return true;
-
-    if (P_BoxOnLineSide (tmbbox, ld) != -1)
-        return true;
-		
-    // A line has been hit
-    
-    // The moving thing's destination position will cross
-    // the given line.
-    // If this should not be allowed, return false.
-    // If the line is special, keep track of it
-    // to process later if the move is proven ok.
-    // NOTE: specials are NOT sorted by order,
-    // so two special lines that are only 8 pixels apart
-    // could be crossed in either order.
-    
-    if (!ld->backsector)
-	    return false;		// one sided line
-		
-	if (ld->flags & ML_BLOCKING)
-	    return false;	// explicitly blocking everything
+    fit_bbox[BOXTOP] = y + radius;
+    fit_bbox[BOXBOTTOM] = y - radius;
+    fit_bbox[BOXRIGHT] = x + radius;
+    fit_bbox[BOXLEFT] = x - radius;
+}
 
-	if (ld->flags & ML_BLOCKMONSTERS)
-	    return false;	// block monsters only
 
-    if (tmradius <= 20)
-        return true; // Smallest unit
+static boolean FitBoxTouches(line_t *ld)
+{
+    if (fit_bbox[BOXRIGHT] <= ld->bbox[BOXLEFT]
+     || fit_bbox[BOXLEFT] >= ld->bbox[BOXRIGHT]
+     || fit_bbox[BOXTOP] <= ld->bbox[BOXBOTTOM]
+     || fit_bbox[BOXBOTTOM] >= ld->bbox[BOXTOP])
+        return false;
 
-    // Check if the back sector can step up/down
-    float floor = ld->frontsector->floorheight;
-    float back_floor = ld->backsector->floorheight;
-    
-    return abs(floor - back_floor) <= 20 * FRACUNIT;
+    return P_BoxOnLineSide(fit_bbox, ld) == -1;
 }
 
 
-boolean check_position(fixed_t x, fixed_t y, fixed_t radius)
+static boolean PIT_GatherFitLine(line_t *ld)
 {
-    int			xl;
-    int			xh;
-    int			yl;
-    int			yh;
-    int			bx;
-    int			by;
-    subsector_t*	newsubsec;
-	
-    tmx = x;
-    tmy = y;
-    tmradius = radius;
-	
-    tmbbox[BOXTOP] = y + radius;
-    tmbbox[BOXBOTTOM] = y - radius;
-    tmbbox[BOXRIGHT] = x + radius;
-    tmbbox[BOXLEFT] = x - radius;
+    if (!FitBoxTouches(ld))
+        return true;
 
-    newsubsec = R_PointInSubsector(x, y);
-    validcount++;
-    
-    // check lines
-    xl = (tmbbox[BOXLEFT] - bmaporgx)>>MAPBLOCKSHIFT;
-    xh = (tmbbox[BOXRIGHT] - bmaporgx)>>MAPBLOCKSHIFT;
-    yl = (tmbbox[BOXBOTTOM] - bmaporgy)>>MAPBLOCKSHIFT;
-    yh = (tmbbox[BOXTOP] - bmaporgy)>>MAPBLOCKSHIFT;
+    // Monsters can cross two sided lines they could step over
+    if (ld->backsector
+     && !(ld->flags & (ML_BLOCKING | ML_BLOCKMONSTERS))
+     && abs(ld->frontsector->floorheight - ld->backsector->floorheight) <= 20 * FRACUNIT)
+        return true;
 
-    for (bx=xl ; bx<=xh ; bx++)
-        for (by=yl ; by<=yh ; by++)
-            if (!P_BlockLinesIterator(bx, by, PIT_CheckLine_NoFlags))
-                return false;
+    if (fit_lines_count == fit_lines_max)
+    {
+        fit_lines_max = fit_lines_max ? fit_lines_max * 2 : 64;
+        fit_lines = I_Realloc(fit_lines, fit_lines_max * sizeof(*fit_lines));
+    }
+    fit_lines[fit_lines_count++] = ld;
 
     return true;
 }
@@ -682,45 +576,42 @@ boolean check_position(fixed_t x, fixed_t y, fixed_t radius)
 
 void get_fit_dimensions(fixed_t x, fixed_t y, fixed_t* fit_radius, fixed_t* fit_height)
 {
-    static const fixed_t radius_checks[] = {
-        128*FRACUNIT,
-        64*FRACUNIT,
-        48*FRACUNIT,
-        40*FRACUNIT,
-        31*FRACUNIT,
-        30*FRACUNIT,
-        24*FRACUNIT,
-        20*FRACUNIT,
-        16*FRACUNIT
-    };
+    sector_t *sector = R_PointInSubsector(x, y)->sector;
+    fixed_t sector_height = sector->ceilingheight - sector->floorheight;
+    int bx, by;
+    int i, j;
 
-    static const fixed_t height_checks[] = {
-        110*FRACUNIT,
-        100*FRACUNIT,
-        64*FRACUNIT,
-        56*FRACUNIT
-    };
-
-    subsector_t* ss = R_PointInSubsector(x, y);
-
-    for (int i = 0, len = sizeof(height_checks) / sizeof(fixed_t); i < len; ++i)
+    for (i = 0; i < arrlen(fit_heights); ++i)
     {
-        fixed_t sector_height = ss->sector->ceilingheight - ss->sector->floorheight;
-        if (sector_height >= height_checks[i] || i == len - 1)
+        if (sector_height >= fit_heights[i] || i == arrlen(fit_heights) - 1)
         {
-            *fit_height = height_checks[i];
+            *fit_height = fit_heights[i];
             break;
         }
     }
 
-    for (int i = 0, len = sizeof(radius_checks) / sizeof(fixed_t); i < len; ++i)
+    fit_lines_count = 0;
+    SetFitBox(x, y, fit_radii[0]);
+    validcount++;
+
+    for (bx = (fit_bbox[BOXLEFT] - bmaporgx) >> MAPBLOCKSHIFT;
+         bx <= (fit_bbox[BOXRIGHT] - bmaporgx) >> MAPBLOCKSHIFT; bx++)
+        for (by = (fit_bbox[BOXBOTTOM] - bmaporgy) >> MAPBLOCKSHIFT;
+             by <= (fit_bbox[BOXTOP] - bmaporgy) >> MAPBLOCKSHIFT; by++)
+            P_BlockLinesIterator(bx, by, PIT_GatherFitLine);
+
+    // A smaller box only touches lines the largest one touched
+    for (i = 0; i < arrlen(fit_radii) - 1; ++i)
     {
-        if (check_position(x, y, radius_checks[i]) || i == len - 1)
-        {
-            *fit_radius = radius_checks[i];
+        SetFitBox(x, y, fit_radii[i]);
+        for (j = 0; j < fit_lines_count; ++j)
+            if (FitBoxTouches(fit_lines[j]))
+                break;
+        if (j == fit_lines_count)
             break;
-        }
     }
+
+    *fit_radius = fit_radii[i];
 }
 
 
@@ -730,386 +621,22 @@ void get_fit_dimensions(fixed_t x, fixed_t y, fixed_t* fit_radius, fixed_t* fit_
 void P_LoadThings (int lump)
 {
     byte               *data;
-    int			i, j;
+    int			i;
     mapthing_t         *mt;
     mapthing_t          spawnthing;
     mapthing_t  spawnthing_player1_start;
     int			numthings;
     boolean		spawn;
-    int bit;
+    const int *remap;
 
     data = W_CacheLumpNum (lump,PU_STATIC);
     numthings = W_LumpLength (lump) / sizeof(mapthing_t);
 
-    // Generate unique random seed from ap seed + level
-    const char* ap_seed = apdoom_get_seed();
-    unsigned long long seed = hash_seed(ap_seed);
-    seed += gameepisode * 9 + gamemap;
-    srand(seed);
-
-    int things_type_remap[1024] = {0};
-
-    mt = (mapthing_t *)data;
-    for (i = 0; i < numthings; i++, mt++)
-    {
-        things_type_remap[i] = mt->type;
-    }
-
-#define E1M8_CUTOFF_OFFSET 6176
-
-    int do_random_monsters = ap_state.random_monsters;
-    if (gamemode == commercial && gamemap == 7) do_random_monsters = 0;
-
-    if (do_random_monsters > 0)
-    {
-        random_monster_def_t* random_monster_defs = gamemode == commercial ? doom2_random_monster_defs : doom_random_monster_defs;
-        int monster_def_count = gamemode == commercial ?
-            sizeof(doom2_random_monster_defs) / sizeof(random_monster_def_t) : 
-            sizeof(doom_random_monster_defs) / sizeof(random_monster_def_t);
-
-        // Make sure at the right difficulty level
-        if (gameskill == sk_baby)
-            bit = 1;
-        else if (gameskill == sk_nightmare)
-            bit = 4;
-        else
-            bit = 1<<(gameskill-1);
-
-        random_monster_def_t* monsters[1024] = {0};
-        int monster_count = 0;
-        monster_spawn_def_t spawns[1024] = {0};
-        int spawn_count = 0;
-
-        // Collect spawn points
-        mt = (mapthing_t *)data;
-        for (i = 0; i < numthings; i++, mt++)
-        {
-            if (!(mt->options & bit))
-                continue;
-
-            if (gameepisode == 1 && gamemap == 8 && gamemode != commercial)
-                if (mt->y > E1M8_CUTOFF_OFFSET)
-                    continue;
-
-            for (int j = 0; j < monster_def_count; ++j)
-            {
-                if (random_monster_defs[j].dont_shuffle)
-                    continue;
-                if (random_monster_defs[j].doom_type == mt->type)
-                {
-                    get_fit_dimensions(mt->x * FRACUNIT, mt->y * FRACUNIT, &spawns[spawn_count].fit_radius, &spawns[spawn_count].fit_height);
-                    spawns[spawn_count].og_monster = &random_monster_defs[j];
-                    spawns[spawn_count++].index = i;
-                    break;
-                }
-            }
-        }
-
-        if (ap_state.random_monsters == 1) // Shuffle
-        {
-            // Collect monsters
-            for (int i = 0; i < spawn_count; ++i)
-            {
-                monster_spawn_def_t* spawn = &spawns[i];
-                monsters[monster_count++] = spawn->og_monster;
-            }
-        }
-        else if (ap_state.random_monsters == 2) // Random balanced
-        {
-            int ratios[NUM_RMC] = {0};
-            random_monster_def_t* defs_by_rmc[NUM_RMC][20];
-            int defs_by_rmc_count[NUM_RMC] = {0};
-            int rmc_ratios[NUM_RMC] = {0};
-            for (int i = 0; i < monster_def_count; ++i)
-            {
-                random_monster_def_t* monster = &random_monster_defs[i];
-                defs_by_rmc[monster->category][defs_by_rmc_count[monster->category]++] = monster;
-                rmc_ratios[monster->category] += monster->frequency;
-            }
-
-            int total = 0;
-            for (int i = 0; i < spawn_count; ++i)
-            {
-                ratios[spawns[i].og_monster->category]++;
-                total++;
-            }
+    // [AP] Randomized monsters and items
+    remap = ap_get_thing_remap(ap_make_level_index(gameepisode, gamemap),
+                               (const ap_mapthing_t *)data, numthings,
+                               gameskill, get_fit_dimensions);
 
-            while (monster_count < spawn_count)
-            {
-                int rnd = rand() % total;
-                for (int i = 0; i < NUM_RMC; ++i)
-                {
-                    if (rnd < ratios[i])
-                    {
-                        rnd = rand() % rmc_ratios[i];
-                        for (int j = 0; j < defs_by_rmc_count[i]; ++j)
-                        {
-                            if (rnd < defs_by_rmc[i][j]->frequency)
-                            {
-                                monsters[monster_count++] = defs_by_rmc[i][j];
-                                break;
-                            }
-                            rnd -= defs_by_rmc[i][j]->frequency;
-                        }
-                        break;
-                    }
-                    rnd -= ratios[i];
-                }
-            }
-        }
-        else if (ap_state.random_monsters == 3) // Random chaotic
-        {
-            int total = 0;
-            for (int i = 0; i < monster_def_count; ++i)
-            {
-                random_monster_def_t* monster = &random_monster_defs[i];
-                if (monster->dont_shuffle) continue;
-                total += monster->frequency;
-            }
-
-            while (monster_count < spawn_count)
-            {
-                int rnd = rand() % total;
-                for (int i = 0; i < monster_def_count; ++i)
-                {
-                    random_monster_def_t* monster = &random_monster_defs[i];
-                    if (monster->dont_shuffle) continue;
-                    if (rnd < monster->frequency)
-                    {
-                        monsters[monster_count++] = monster;
-                        break;
-                    }
-                    rnd -= monster->frequency;
-                }
-            }
-        }
-
-        // Make sure we have at least 2 baron of hell in first episode boss level
-        if (gameepisode == 1 && gamemap == 8 && gamemode != commercial)
-        {
-            int baron_count = 0;
-            for (int i = 0; i < monster_count; ++i)
-                if (monsters[i]->doom_type == 3003)
-                    baron_count++;
-            while (baron_count < 2)
-            {
-                int i = rand() % monster_count;
-                if (monsters[i]->doom_type != 3003)
-                {
-                    monsters[i] = &random_monster_defs[7];
-                    baron_count++;
-                }
-            }
-        }
-        
-        // Randomly pick them until empty, and place them in different spots
-        for (i = 0; i < spawn_count; i++)
-        {
-            int idx = rand() % monster_count;
-            spawns[i].monster = monsters[idx];
-            monsters[idx] = monsters[monster_count - 1];
-            monster_count--;
-        }
-
-        // Go through again, and make sure they fit
-        for (i = 0; i < spawn_count; i++)
-        {
-            monster_spawn_def_t* spawn1 = &spawns[i];
-            if (spawn1->monster->height > spawn1->fit_height ||
-                spawn1->monster->radius > spawn1->fit_radius)
-            {
-                // He doesn't fit here, find another monster randomly that would fit here, then swap
-                int tries = 1000;
-                while (tries--)
-                {
-                    int j = rand() % spawn_count;
-                    if (j == i) continue;
-                    monster_spawn_def_t* spawn2 = &spawns[j];
-                    if (spawn1->monster->height <= spawn2->fit_height &&
-                        spawn1->monster->radius <= spawn2->fit_radius &&
-                        spawn2->monster->height <= spawn1->fit_height &&
-                        spawn2->monster->radius <= spawn1->fit_radius)
-                    {
-                        random_monster_def_t* tmp = spawn1->monster;
-                        spawn1->monster = spawn2->monster;
-                        spawn2->monster = tmp;
-                        break;
-                    }
-                }
-            }
-        }
-
-        // Do the final remapping
-        for (i = 0; i < spawn_count; i++)
-        {
-            monster_spawn_def_t* spawn = &spawns[i];
-            things_type_remap[spawn->index] = spawn->monster->doom_type;
-        }
-    }
-
-    if (ap_state.random_items > 0)
-    {
-        // Make sure at the right difficulty level
-        if (gameskill == sk_baby)
-            bit = 1;
-        else if (gameskill == sk_nightmare)
-            bit = 4;
-        else
-            bit = 1<<(gameskill-1);
-
-        if (ap_state.random_items == 1) // Shuffle
-        {
-            int items[1024];
-            int item_count = 0;
-            int indices[1024];
-            int index_count = 0;
-
-            // Collect all items
-            mt = (mapthing_t *)data;
-            for (i = 0; i < numthings; i++, mt++)
-            {
-                if (mt->options & 16)
-                    continue; // Multiplayer item
-                if (!(mt->options & bit))
-                    continue;
-
-                switch (mt->type)
-                {
-                    case 2008: // 4 shotgun shells
-                    case 2048: // box of bullets
-                    case 2046: // box of rockets
-                    case 2049: // box of shotgun shells
-                    case 2007: // clip
-                    case 2047: // energy cell
-                    case 17: // energy cell pack
-                    case 2010: // rocket
-                    case 2015: // armor bonus
-                    case 2014: // health bonus
-                    case 2012: // medikit
-                    case 2011: // Stimpack
-                    {
-                        items[item_count++] = mt->type;
-                        indices[index_count++] = i;
-                        break;
-                    }
-                }
-            }
-
-            // Randomly pick them until empty, and place them in different spots
-            mt = (mapthing_t *)data;
-            for (i = 0; i < index_count; i++)
-            {
-                int idx = rand() % item_count;
-                things_type_remap[indices[i]] = items[idx];
-                items[idx] = items[item_count - 1];
-                item_count--;
-            }
-        }
-        else if (ap_state.random_items == 2) // Random balanced
-        {
-            int ratios[3] = {0, 0, 0};
-            int total = 0;
-
-            // Make sure at the right difficulty level
-            if (gameskill == sk_baby)
-                bit = 1;
-            else if (gameskill == sk_nightmare)
-                bit = 4;
-            else
-                bit = 1<<(gameskill-1);
-
-            // Calculate ratios
-            mt = (mapthing_t *)data;
-            for (i = 0; i < numthings; i++, mt++)
-            {
-                if (mt->options & 16)
-                    continue; // Multiplayer item
-
-                switch (mt->type)
-                {
-                    case 2015: // armor bonus
-                    case 2014: // health bonus
-                        ratios[0]++;
-                        total++;
-                        break;
-
-                    case 2011: // Stimpack
-                    case 2008: // 4 shotgun shells
-                    case 2007: // clip
-                    case 2047: // energy cell
-                    case 2010: // rocket
-                        ratios[1]++;
-                        total++;
-                        break;
-
-                    case 2048: // box of bullets
-                    case 2046: // box of rockets
-                    case 2049: // box of shotgun shells
-                    case 17: // energy cell pack
-                    case 2012: // medikit
-                        ratios[2]++;
-                        total++;
-                        break;
-                }
-            }
-
-            // Randomly pick items based on ratio
-            mt = (mapthing_t *)data;
-            for (i = 0; i < numthings; i++, mt++)
-            {
-                switch (mt->type)
-                {
-                    case 2008: // 4 shotgun shells
-                    case 2048: // box of bullets
-                    case 2046: // box of rockets
-                    case 2049: // box of shotgun shells
-                    case 2007: // clip
-                    case 2047: // energy cell
-                    case 17: // energy cell pack
-                    case 2010: // rocket
-                    case 2015: // armor bonus
-                    case 2014: // health bonus
-                    case 2012: // medikit
-                    case 2011: // Stimpack
-                    {
-                        int rnd = rand() % total;
-                        if (rnd < ratios[0])
-                        {
-                            switch (rand()%2)
-                            {
-                                case 0: things_type_remap[i] = 2015; break; // armor bonus
-                                case 1: things_type_remap[i] = 2014; break; // health bonus
-                            }
-                        }
-                        else if (rnd < ratios[0] + ratios[1])
-                        {
-                            switch (rand()%5)
-                            {
-                                case 0: things_type_remap[i] = 2011; break; // Stimpack
-                                case 1: things_type_remap[i] = 2008; break; // 4 shotgun shells
-                                case 2: things_type_remap[i] = 2007; break; // clip
-                                case 3: things_type_remap[i] = 2047; break; // energy cell
-                                case 4: things_type_remap[i] = 2010; break; // rocket
-                            }
-                        }
-                        else
-                        {
-                            switch (rand()%5)
-                            {
-                                case 0: things_type_remap[i] = 2048; break; // box of bullets
-                                case 1: things_type_remap[i] = 2046; break; // box of rockets
-                                case 2: things_type_remap[i] = 2049; break; // box of shotgun shells
-                                case 3: things_type_remap[i] = 17; break; // energy cell pack
-                                case 4: things_type_remap[i] = 2012; break; // medikit
-                            }
-                        }
-                        break;
-                    }
-                }
-            }
-        }
-    }
-	
     mt = (mapthing_t *)data;
     for (i=0 ; i<numthings ; i++, mt++)
     {
@@ -1141,7 +668,7 @@ void P_LoadThings (int lump)
 	spawnthing.x = SHORT(mt->x);
 	spawnthing.y = SHORT(mt->y);
 	spawnthing.angle = SHORT(mt->angle);
-	spawnthing.type = SHORT(things_type_remap[i]);
+	spawnthing.type = SHORT(remap[i]);
 	spawnthing.options = SHORT(mt->options);
 	
     //auto type_before = spawnthing.type;
@@ -1166,17 +693,7 @@ void P_LoadThings (int lump)
                     spawnthing.type = 20001;
                 else
                     spawnthing.type = 20000;
-                int skip = 0;
-                ap_level_state_t* level_state = ap_get_level_state(ap_make_level_index(gameepisode, gamemap));
-                for (j = 0; j < level_state->check_count; ++j)
-                {
-                    if (level_state->checks[j] == i)
-                    {
-                        skip = 1;
-                        break;
-                    }
-                }
-                if (skip)
+                if (ap_is_location_checked(ap_make_level_index(gameepisode, gamemap), i))
                     continue;
             }
         }
@@ -1210,69 +727,74 @@ void P_LoadThings (int lump)
 
 
 //
-// P_LoadLineDefs
-// Also counts secret lines for intermissions.
+// [AP] P_FixLineDefs
+// Patch up loaded lines for the randomizer.
 //
-void P_LoadLineDefs (int lump)
+static void P_FixLineDefs (void)
 {
-    byte*		data;
-    int			i;
-    maplinedef_t*	mld;
-    line_t*		ld;
-    vertex_t*		v1;
-    vertex_t*		v2;
-    int warn, warn2; // [crispy] warn about invalid linedefs
-	
-    numlines = W_LumpLength (lump) / sizeof(maplinedef_t);
-    lines = Z_Malloc (numlines*sizeof(line_t),PU_LEVEL,0);	
-    memset (lines, 0, numlines*sizeof(line_t));
-    data = W_CacheLumpNum (lump,PU_STATIC);
-	
-    mld = (maplinedef_t *)data;
-    ld = lines;
-    warn = warn2 = 0; // [crispy] warn about invalid linedefs
-
-
+    int i;
 
     // [AP] If the multiworld was generacted with 2 way keydoors, we need to fix those doors to be 2 ways
     if (gamemode == commercial)
     {
         // Doom II
-        if (gamemap == 2)
+        if (gamemap == 2 && numlines > 390)
         {
-            mld[390].special = 1;
+            lines[390].special = 1;
         }
-        else if (gamemap == 12)
+        else if (gamemap == 12 && numlines > 271)
         {
-            mld[271].special = 62;
-            mld[271].tag = 42;
-            mld[271].flags &= ~0x0010; // LINE_FLAGS_LOWER_UNPEGGED;
+            lines[271].special = 62;
+            lines[271].tag = 42;
+            lines[271].flags &= ~ML_DONTPEGBOTTOM;
         }
     }
     else
     {
         // Ultimate Doom
-        if (gameepisode == 2 && gamemap == 6 && ap_state.two_ways_keydoors)
-            mld[620].special = 27; // Yellow keycard
-        else if (gameepisode == 3 && gamemap == 9 && ap_state.two_ways_keydoors)
-            mld[195].special = 32; // Blue keycard
+        if (gameepisode == 2 && gamemap == 6 && ap_state.two_ways_keydoors && numlines > 620)
+            lines[620].special = 27; // Yellow keycard
+        else if (gameepisode == 3 && gamemap == 9 && ap_state.two_ways_keydoors && numlines > 195)
+            lines[195].special = 32; // Blue keycard
 
         // [AP] Can be softlocked if coming back to that level after boss is dead, make sure to disable it's triggers that closes the doors
-        else if (gameepisode == 2 && gamemap == 8)
+        else if (gameepisode == 2 && gamemap == 8 && numlines > 143)
         {
             for (i = 140; i <= 143; ++i)
             {
-                mld[i].special = 0;
-                mld[i].tag = 0;
+                lines[i].special = 0;
+                lines[i].tag = 0;
             }
         }
 
         // [AP] We can get stuck and not able to come back to the HUB. Make sure the entrance door can be re-openned from the other side
-        else if (gameepisode == 4 && gamemap == 8)
-            mld[96].special = 61; // Stay open
+        else if (gameepisode == 4 && gamemap == 8 && numlines > 96)
+            lines[96].special = 61; // Stay open
     }
+}
 
-
+//
+// P_LoadLineDefs
+// Also counts secret lines for intermissions.
+//
+void P_LoadLineDefs (int lump)
+{
+    lumpview_t		view;
+    int			i;
+    const maplinedef_t*	mld;
+    line_t*		ld;
+    vertex_t*		v1;
+    vertex_t*		v2;
+    int warn, warn2; // [crispy] warn about invalid linedefs
+	
+    W_OpenLumpView(lump, WAD_ADVICE_SEQUENTIAL, &view); // [AP]
+    numlines = view.length / sizeof(maplinedef_t);
+    lines = Z_Malloc (numlines*sizeof(line_t),PU_LEVEL,0);	
+    memset (lines, 0, numlines*sizeof(line_t));
+	
+    mld = (const maplinedef_t *)view.data;
+    ld = lines;
+    warn = warn2 = 0; // [crispy] warn about invalid linedefs
 
     for (i=0 ; i<numlines ; i++, mld++, ld++)
     {
@@ -1394,7 +916,9 @@ void P_LoadLineDefs (int lump)
 	fprintf(stderr, "THIS MAP MAY NOT WORK AS EXPECTED!\n");
     }
 
-    W_ReleaseLumpNum(lump);
+    W_CloseLumpView(&view);
+
+    P_FixLineDefs();
 }
 
 
@@ -1455,7 +979,8 @@ boolean P_LoadBlockMap (int lump)
     int i;
     int count;
     int lumplen;
-    short *wadblockmaplump;
+    lumpview_t view;
+    const short *wadblockmaplump;
 
     // [crispy] (re-)create BLOCKMAP if necessary
     if (M_CheckParm("-blockmap") ||
@@ -1468,8 +993,9 @@ boolean P_LoadBlockMap (int lump)
 	
     // [crispy] remove BLOCKMAP limit
     // adapted from boom202s/P_SETUP.C:1025-1076
-    wadblockmaplump = Z_Malloc(lumplen, PU_LEVEL, NULL);
-    W_ReadLump(lump, wadblockmaplump);
+    // [AP] Swap straight out of the WAD rather than a copy of it.
+    W_OpenLumpView(lump, WAD_ADVICE_SEQUENTIAL, &view);
+    wadblockmaplump = (const short *) view.data;
     blockmaplump = Z_Malloc(sizeof(*blockmaplump) * count, PU_LEVEL, NULL);
     blockmap = blockmaplump + 4;
 
@@ -1486,7 +1012,7 @@ boolean P_LoadBlockMap (int lump)
 	blockmaplump[i] = (t == -1) ? -1l : (int32_t) t & 0xffff;
     }
 
-    Z_Free(wadblockmaplump);
+    W_CloseLumpView(&view);
 		
     // Read the header
 
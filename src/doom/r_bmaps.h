@@ -31,4 +31,7 @@ extern const byte *(*R_BrightmapForState) (const int state);
 
 extern const byte **texturebrightmap;
 
+// [AP] All zero, lets the drawers skip the brightmap lookup
+extern const byte nobrightmap[256];
+
 #endif
@@ -29,6 +29,7 @@
 #include "w_wad.h"
 
 #include "doomdef.h"
+#include "m_config.h" // [AP] configdir
 #include "m_misc.h"
 #include "r_local.h"
 #include "p_local.h"
@@ -1074,9 +1075,30 @@ static void R_InitTranMap()
     {
 	// Compose a default transparent filter map based on PLAYPAL.
 	unsigned char *playpal = W_CacheLumpName("PLAYPAL", PU_STATIC);
+	char *fname = M_StringJoin(configdir, "tranmap.dat", NULL);
+	FILE *cachefp;
+
+	// [AP] Building the map takes a while, it's cached between runs
+	struct {
+	    unsigned char pct;
+	    unsigned char playpal[256*3];
+	} cache;
 
 	tranmap = Z_Malloc(256*256, PU_STATIC, 0);
+
+	// [AP] Use the cached map if it was built from the same palette
+	cachefp = M_fopen(fname, "rb");
+	if (cachefp &&
+	    fread(&cache, 1, sizeof(cache), cachefp) == sizeof(cache) &&
+	    cache.pct == tran_filter_pct &&
+	    memcmp(cache.playpal, playpal, sizeof(cache.playpal)) == 0 &&
+	    fread(tranmap, 256, 256, cachefp) == 256)
+	{
+	    printf(":");
+	}
+	else
 	{
+	    palette_lookup_t *lookup = V_NewPaletteLookup(playpal);
 	    byte *fg, *bg, blend[3], *tp = tranmap;
 	    int i, j, btmp;
 
@@ -1105,12 +1127,40 @@ static void R_InitTranMap()
 		    blend[g] = (tran_filter_pct * fg[g] + (100 - tran_filter_pct) * bg[g]) / (100 + btmp);
 		    blend[b] = (tran_filter_pct * fg[b] + (100 - tran_filter_pct) * bg[b]) / 100;
 
-		    *tp++ = V_GetPaletteIndex(playpal, blend[r], blend[g], blend[b]);
+		    *tp++ = V_LookupPaletteIndex(lookup, blend[r], blend[g], blend[b]);
 		}
 	    }
+
+	    V_FreePaletteLookup(lookup);
+
+	    if (cachefp)
+	    {
+		fclose(cachefp);
+	    }
+
+	    // [AP] Write out the map for next time
+	    cache.pct = tran_filter_pct;
+	    memcpy(cache.playpal, playpal, sizeof(cache.playpal));
+	    cachefp = M_fopen(fname, "wb");
+	    if (cachefp)
+	    {
+		if (fwrite(&cache, 1, sizeof(cache), cachefp) != sizeof(cache) ||
+		    fwrite(tranmap, 256, 256, cachefp) != 256)
+		{
+		    fclose(cachefp);
+		    cachefp = NULL;
+		    M_remove(fname);
+		}
+	    }
+
+	    printf(".");
 	}
 
-	printf(".");
+	if (cachefp)
+	{
+	    fclose(cachefp);
+	}
+	free(fname);
 
 	W_ReleaseLumpName("PLAYPAL");
     }
@@ -479,6 +479,12 @@ typedef struct
   int			lightlevel;
   int			minx;
   int			maxx;
+  int			next; // [AP] next plane in R_FindPlane's hash chain
+
+  // [AP] Flat to draw, looked up before the spans are drawn on worker threads
+  byte*			source;
+  const byte*		brightmap;
+  lighttable_t**	zlight;
   
   // leave pads for [minx-1]/[maxx+1]
   
@@ -25,10 +25,12 @@
 #include "deh_main.h"
 
 #include "i_system.h"
+#include "m_argv.h" // [AP] -transpose
 #include "z_zone.h"
 #include "w_wad.h"
 
 #include "r_local.h"
+#include "r_bmaps.h" // [AP] nobrightmap
 
 // Needs access to LFB (guess what).
 #include "v_video.h"
@@ -64,6 +66,17 @@ int		viewwindowy;
 pixel_t*		ylookup[MAXHEIGHT];
 int		columnofs[MAXWIDTH]; 
 
+// [AP] With -transpose the view is drawn column by column into a buffer
+// of its own, so that column drawers step through memory one pixel at a
+// time. R_TransposeView copies it out to the screen when it is done.
+// dc_pitch is the distance from one row of the view to the next.
+boolean		transposedview;
+int		dc_pitch;
+static pixel_t*	transposed_buffer = NULL;
+static pixel_t*	viewdest;
+static int	transposedwidth;
+static int	transposedheight;
+
 // Color tables for different players,
 //  translate a limited part to another
 //  (color ramps used for  suit colors).
@@ -157,11 +170,28 @@ void R_DrawColumn (void)
 	const byte source = dc_source[frac>>FRACBITS];
 	*dest = dc_colormap[dc_brightmap[source]][source];
 
-	dest += SCREENWIDTH;
+	dest += dc_pitch;
 	if ((frac += fracstep) >= heightmask)
 	    frac -= heightmask;
     } while (count--);
   }
+  else if (dc_brightmap == nobrightmap || dc_colormap[0] == dc_colormap[1])
+  {
+    // [AP] Every pixel uses the same colormap, skip the brightmap. The
+    // state is copied to locals so it can stay in registers across the
+    // stores to dest.
+    const lighttable_t *const colormap = dc_colormap[0];
+    const byte *const source = dc_source;
+    const int pitch = dc_pitch;
+
+    do
+    {
+	*dest = colormap[source[(frac>>FRACBITS)&heightmask]];
+
+	dest += pitch;
+	frac += fracstep;
+    } while (count--);
+  }
   else // texture height is a power of 2 -- killough
   {
     do 
@@ -172,7 +202,7 @@ void R_DrawColumn (void)
 	const byte source = dc_source[(frac>>FRACBITS)&heightmask];
 	*dest = dc_colormap[dc_brightmap[source]][source];
 	
-	dest += SCREENWIDTH; 
+	dest += dc_pitch; 
 	frac += fracstep;
 	
     } while (count--); 
@@ -293,13 +323,29 @@ void R_DrawColumnLow (void)
 	const byte source = dc_source[frac>>FRACBITS];
 	*dest2 = *dest = dc_colormap[dc_brightmap[source]][source];
 
-	dest += SCREENWIDTH;
-	dest2 += SCREENWIDTH;
+	dest += dc_pitch;
+	dest2 += dc_pitch;
 
 	if ((frac += fracstep) >= heightmask)
 	    frac -= heightmask;
     } while (count--);
   }
+  else if (dc_brightmap == nobrightmap || dc_colormap[0] == dc_colormap[1])
+  {
+    // [AP] One colormap, as in R_DrawColumn
+    const lighttable_t *const colormap = dc_colormap[0];
+    const byte *const source = dc_source;
+    const int pitch = dc_pitch;
+
+    do
+    {
+	*dest2 = *dest = colormap[source[(frac>>FRACBITS)&heightmask]];
+
+	dest += pitch;
+	dest2 += pitch;
+	frac += fracstep;
+    } while (count--);
+  }
   else // texture height is a power of 2 -- killough
   {
     do 
@@ -308,8 +354,8 @@ void R_DrawColumnLow (void)
 	// [crispy] brightmaps
 	const byte source = dc_source[(frac>>FRACBITS)&heightmask];
 	*dest2 = *dest = dc_colormap[dc_brightmap[source]][source];
-	dest += SCREENWIDTH;
-	dest2 += SCREENWIDTH;
+	dest += dc_pitch;
+	dest2 += dc_pitch;
 
 	frac += fracstep; 
 
@@ -406,16 +452,16 @@ void R_DrawFuzzColumn (void)
 	//  left or right of the current one.
 	// Add index from colormap to index.
 #ifndef CRISPY_TRUECOLOR
-	*dest = colormaps[6*256+dest[SCREENWIDTH*fuzzoffset[fuzzpos]]]; 
+	*dest = colormaps[6*256+dest[dc_pitch*fuzzoffset[fuzzpos]]]; 
 #else
-	*dest = I_BlendDark(dest[SCREENWIDTH*fuzzoffset[fuzzpos]], 0xD3);
+	*dest = I_BlendDarkPacked(dest[dc_pitch*fuzzoffset[fuzzpos]], 0xD3);
 #endif
 
 	// Clamp table lookup index.
 	if (++fuzzpos == FUZZTABLE) 
 	    fuzzpos = 0;
 	
-	dest += SCREENWIDTH;
+	dest += dc_pitch;
     } while (count--); 
 
     // [crispy] if the line at the bottom had to be cut off,
@@ -423,9 +469,9 @@ void R_DrawFuzzColumn (void)
     if (cutoff)
     {
 #ifndef CRISPY_TRUECOLOR
-	*dest = colormaps[6*256+dest[SCREENWIDTH*(fuzzoffset[fuzzpos]-FUZZOFF)/2]];
+	*dest = colormaps[6*256+dest[dc_pitch*(fuzzoffset[fuzzpos]-FUZZOFF)/2]];
 #else
-	*dest = I_BlendDark(dest[SCREENWIDTH*(fuzzoffset[fuzzpos]-FUZZOFF)/2], 0xD3);
+	*dest = I_BlendDarkPacked(dest[dc_pitch*(fuzzoffset[fuzzpos]-FUZZOFF)/2], 0xD3);
 #endif
     }
 } 
@@ -483,19 +529,19 @@ void R_DrawFuzzColumnLow (void)
 	//  left or right of the current one.
 	// Add index from colormap to index.
 #ifndef CRISPY_TRUECOLOR
-	*dest = colormaps[6*256+dest[SCREENWIDTH*fuzzoffset[fuzzpos]]];
-	*dest2 = colormaps[6*256+dest2[SCREENWIDTH*fuzzoffset[fuzzpos]]];
+	*dest = colormaps[6*256+dest[dc_pitch*fuzzoffset[fuzzpos]]];
+	*dest2 = colormaps[6*256+dest2[dc_pitch*fuzzoffset[fuzzpos]]];
 #else
-	*dest = I_BlendDark(dest[SCREENWIDTH*fuzzoffset[fuzzpos]], 0xD3);
-	*dest2 = I_BlendDark(dest2[SCREENWIDTH*fuzzoffset[fuzzpos]], 0xD3);
+	*dest = I_BlendDarkPacked(dest[dc_pitch*fuzzoffset[fuzzpos]], 0xD3);
+	*dest2 = I_BlendDarkPacked(dest2[dc_pitch*fuzzoffset[fuzzpos]], 0xD3);
 #endif
 
 	// Clamp table lookup index.
 	if (++fuzzpos == FUZZTABLE) 
 	    fuzzpos = 0;
 	
-	dest += SCREENWIDTH;
-	dest2 += SCREENWIDTH;
+	dest += dc_pitch;
+	dest2 += dc_pitch;
     } while (count--); 
 
     // [crispy] if the line at the bottom had to be cut off,
@@ -503,11 +549,11 @@ void R_DrawFuzzColumnLow (void)
     if (cutoff)
     {
 #ifndef CRISPY_TRUECOLOR
-	*dest = colormaps[6*256+dest[SCREENWIDTH*(fuzzoffset[fuzzpos]-FUZZOFF)/2]];
-	*dest2 = colormaps[6*256+dest2[SCREENWIDTH*(fuzzoffset[fuzzpos]-FUZZOFF)/2]];
+	*dest = colormaps[6*256+dest[dc_pitch*(fuzzoffset[fuzzpos]-FUZZOFF)/2]];
+	*dest2 = colormaps[6*256+dest2[dc_pitch*(fuzzoffset[fuzzpos]-FUZZOFF)/2]];
 #else
-	*dest = I_BlendDark(dest[SCREENWIDTH*(fuzzoffset[fuzzpos]-FUZZOFF)/2], 0xD3);
-	*dest2 = I_BlendDark(dest2[SCREENWIDTH*(fuzzoffset[fuzzpos]-FUZZOFF)/2], 0xD3);
+	*dest = I_BlendDarkPacked(dest[dc_pitch*(fuzzoffset[fuzzpos]-FUZZOFF)/2], 0xD3);
+	*dest2 = I_BlendDarkPacked(dest2[dc_pitch*(fuzzoffset[fuzzpos]-FUZZOFF)/2], 0xD3);
 #endif
     }
 } 
@@ -566,7 +612,7 @@ void R_DrawTranslatedColumn (void)
 	// Thus the "green" ramp of the player 0 sprite
 	//  is mapped to gray, red, black/indigo. 
 	*dest = dc_colormap[0][dc_translation[dc_source[frac>>FRACBITS]]];
-	dest += SCREENWIDTH;
+	dest += dc_pitch;
 	
 	frac += fracstep; 
     } while (count--); 
@@ -617,19 +663,53 @@ void R_DrawTranslatedColumnLow (void)
 	//  is mapped to gray, red, black/indigo. 
 	*dest = dc_colormap[0][dc_translation[dc_source[frac>>FRACBITS]]];
 	*dest2 = dc_colormap[0][dc_translation[dc_source[frac>>FRACBITS]]];
-	dest += SCREENWIDTH;
-	dest2 += SCREENWIDTH;
+	dest += dc_pitch;
+	dest2 += dc_pitch;
 	
 	frac += fracstep; 
     } while (count--); 
 } 
 
+#ifdef CRISPY_TRUECOLOR
+//
+// [AP] R_BlendColumn
+// The translucent column loop. It is inlined once for each blend passed
+// as a constant, so that blend is inlined as well rather than called
+// through blendfunc for every pixel.
+//
+static inline void R_BlendColumn (pixel_t *dest, int count,
+                                  fixed_t frac, fixed_t fracstep,
+                                  const pixel_t (*const blend)(const pixel_t bg, const pixel_t fg))
+{
+    const lighttable_t *const colormap = dc_colormap[0];
+    const byte *const source = dc_source;
+    const int pitch = dc_pitch;
+
+    do
+    {
+        const pixel_t destrgb = colormap[source[frac>>FRACBITS]];
+        *dest = blend(*dest, destrgb);
+	dest += pitch;
+
+	frac += fracstep;
+    } while (count--);
+}
+#endif
+
 void R_DrawTLColumn (void)
 {
     int			count;
     pixel_t*		dest;
     fixed_t		frac;
     fixed_t		fracstep;
+#ifndef CRISPY_TRUECOLOR
+    // [AP] Keep the state in locals, the stores to dest would make the
+    // compiler reload every global once per pixel
+    const lighttable_t *const colormap = dc_colormap[0];
+    const byte *const source = dc_source;
+    const int pitch = dc_pitch;
+    const byte *const map = tranmap;
+#endif
 
     count = dc_yh - dc_yl;
     if (count < 0)
@@ -650,20 +730,48 @@ void R_DrawTLColumn (void)
     fracstep = dc_iscale;
     frac = dc_texturemid + (dc_yl-centery)*fracstep;
 
+#ifndef CRISPY_TRUECOLOR
     do
     {
-#ifndef CRISPY_TRUECOLOR
         // actual translucency map lookup taken from boom202s/R_DRAW.C:255
-        *dest = tranmap[(*dest<<8)+dc_colormap[0][dc_source[frac>>FRACBITS]]];
+        *dest = map[(*dest<<8)+colormap[source[frac>>FRACBITS]]];
+	dest += pitch;
+
+	frac += fracstep;
+    } while (count--);
 #else
-        const pixel_t destrgb = dc_colormap[0][dc_source[frac>>FRACBITS]];
-        *dest = blendfunc(*dest, destrgb);
+    // [AP] Sprites only ever use these two
+    if (blend_packed && blendfunc == I_BlendOver)
+	R_BlendColumn(dest, count, frac, fracstep, I_BlendOverPacked);
+    else if (blend_packed && blendfunc == I_BlendAdd)
+	R_BlendColumn(dest, count, frac, fracstep, I_BlendAddPacked);
+    else
+	R_BlendColumn(dest, count, frac, fracstep, blendfunc);
 #endif
-	dest += SCREENWIDTH;
+}
+
+#ifdef CRISPY_TRUECOLOR
+// [AP] R_BlendColumn for low detail, drawing every pixel twice
+static inline void R_BlendColumnLow (pixel_t *dest, pixel_t *dest2, int count,
+                                     fixed_t frac, fixed_t fracstep,
+                                     const pixel_t (*const blend)(const pixel_t bg, const pixel_t fg))
+{
+    const lighttable_t *const colormap = dc_colormap[0];
+    const byte *const source = dc_source;
+    const int pitch = dc_pitch;
+
+    do
+    {
+	const pixel_t destrgb = colormap[source[frac>>FRACBITS]];
+	*dest = blend(*dest, destrgb);
+	*dest2 = blend(*dest2, destrgb);
+	dest += pitch;
+	dest2 += pitch;
 
 	frac += fracstep;
     } while (count--);
 }
+#endif
 
 // [crispy] draw translucent column, low-resolution version
 void R_DrawTLColumnLow (void)
@@ -674,6 +782,13 @@ void R_DrawTLColumnLow (void)
     fixed_t		frac;
     fixed_t		fracstep;
     int                 x;
+#ifndef CRISPY_TRUECOLOR
+    // [AP] Locals, as in R_DrawTLColumn
+    const lighttable_t *const colormap = dc_colormap[0];
+    const byte *const source = dc_source;
+    const int pitch = dc_pitch;
+    const byte *const map = tranmap;
+#endif
 
     count = dc_yh - dc_yl;
     if (count < 0)
@@ -697,21 +812,25 @@ void R_DrawTLColumnLow (void)
     fracstep = dc_iscale;
     frac = dc_texturemid + (dc_yl-centery)*fracstep;
 
+#ifndef CRISPY_TRUECOLOR
     do
     {
-#ifndef CRISPY_TRUECOLOR
-	*dest = tranmap[(*dest<<8)+dc_colormap[0][dc_source[frac>>FRACBITS]]];
-	*dest2 = tranmap[(*dest2<<8)+dc_colormap[0][dc_source[frac>>FRACBITS]]];
-#else
-	const pixel_t destrgb = dc_colormap[0][dc_source[frac>>FRACBITS]];
-	*dest = blendfunc(*dest, destrgb);
-	*dest2 = blendfunc(*dest2, destrgb);
-#endif
-	dest += SCREENWIDTH;
-	dest2 += SCREENWIDTH;
+	const byte fg = colormap[source[frac>>FRACBITS]];
+	*dest = map[(*dest<<8)+fg];
+	*dest2 = map[(*dest2<<8)+fg];
+	dest += pitch;
+	dest2 += pitch;
 
 	frac += fracstep;
     } while (count--);
+#else
+    if (blend_packed && blendfunc == I_BlendOver)
+	R_BlendColumnLow(dest, dest2, count, frac, fracstep, I_BlendOverPacked);
+    else if (blend_packed && blendfunc == I_BlendAdd)
+	R_BlendColumnLow(dest, dest2, count, frac, fracstep, I_BlendAddPacked);
+    else
+	R_BlendColumnLow(dest, dest2, count, frac, fracstep, blendfunc);
+#endif
 }
 
 //
@@ -760,35 +879,54 @@ void R_InitTranslationTables (void)
 //  the texture at an angle in all but a few cases.
 // In consequence, flats are not stored by column (like walls),
 //  and the inner loop has to step in texture space u and v.
+// [AP] One copy per thread, spans can be drawn by several threads.
 //
-int			ds_y; 
-int			ds_x1; 
-int			ds_x2;
+THREADLOCAL int			ds_y; 
+THREADLOCAL int			ds_x1; 
+THREADLOCAL int			ds_x2;
 
-lighttable_t*		ds_colormap[2];
-const byte*			ds_brightmap;
+THREADLOCAL lighttable_t*		ds_colormap[2];
+THREADLOCAL const byte*			ds_brightmap;
 
-fixed_t			ds_xfrac; 
-fixed_t			ds_yfrac; 
-fixed_t			ds_xstep; 
-fixed_t			ds_ystep;
+THREADLOCAL fixed_t			ds_xfrac; 
+THREADLOCAL fixed_t			ds_yfrac; 
+THREADLOCAL fixed_t			ds_xstep; 
+THREADLOCAL fixed_t			ds_ystep;
 
 // start of a 64*64 tile image 
-byte*			ds_source;	
+THREADLOCAL byte*			ds_source;	
 
 // just for profiling
 int			dscount;
 
 
+//
+// [AP] R_SpanSpot
+// Index of the flat texel at a span position.
+//
+static inline int R_SpanSpot (fixed_t xfrac, fixed_t yfrac)
+{
+    // [crispy] fix flats getting more distorted the closer they are to the right
+    return ((yfrac >> 10) & 0x0fc0) | ((xfrac >> 16) & 0x3f);
+}
+
 //
 // Draws the actual span.
 void R_DrawSpan (void) 
 { 
 //  unsigned int position, step;
-    pixel_t *dest;
+    // [AP] The span state is thread-local, copy it to locals so it stays
+    // in registers. The row is the same for the whole span.
+    pixel_t *const row = ylookup[ds_y];
+    const byte *const source = ds_source;
+    lighttable_t *const colormap[2] = {ds_colormap[0], ds_colormap[1]};
+    const byte *const brightmap = ds_brightmap;
+    const fixed_t xstep = ds_xstep;
+    const fixed_t ystep = ds_ystep;
+    fixed_t xfrac = ds_xfrac;
+    fixed_t yfrac = ds_yfrac;
+    int x = ds_x1;
     int count;
-    int spot;
-    unsigned int xtemp, ytemp;
 
 #ifdef RANGECHECK
     if (ds_x2 < ds_x1
@@ -802,47 +940,56 @@ void R_DrawSpan (void)
 //	dscount++;
 #endif
 
-    // Pack position and step variables into a single 32-bit integer,
-    // with x in the top 16 bits and y in the bottom 16 bits.  For
-    // each 16-bit part, the top 6 bits are the integer part and the
-    // bottom 10 bits are the fractional part of the pixel position.
+    // We do not check for zero spans here?
+    count = ds_x2 - ds_x1;
 
-/*
-    position = ((ds_xfrac << 10) & 0xffff0000)
-             | ((ds_yfrac >> 6)  & 0x0000ffff);
-    step = ((ds_xstep << 10) & 0xffff0000)
-         | ((ds_ystep >> 6)  & 0x0000ffff);
-*/
+    if (brightmap == nobrightmap || colormap[0] == colormap[1])
+    {
+	// [AP] One colormap for the whole span. Four pixels at a time, so
+	// their texel and colormap loads can overlap.
+	const lighttable_t *const cm = colormap[0];
 
-//  dest = ylookup[ds_y] + columnofs[ds_x1];
+	while (count >= 3)
+	{
+	    const byte s0 = source[R_SpanSpot(xfrac, yfrac)];
+	    const byte s1 = source[R_SpanSpot(xfrac + xstep, yfrac + ystep)];
+	    const byte s2 = source[R_SpanSpot(xfrac + 2*xstep, yfrac + 2*ystep)];
+	    const byte s3 = source[R_SpanSpot(xfrac + 3*xstep, yfrac + 3*ystep)];
+
+	    row[columnofs[flipviewwidth[x]]] = cm[s0];
+	    row[columnofs[flipviewwidth[x+1]]] = cm[s1];
+	    row[columnofs[flipviewwidth[x+2]]] = cm[s2];
+	    row[columnofs[flipviewwidth[x+3]]] = cm[s3];
+
+	    x += 4;
+	    xfrac += 4*xstep;
+	    yfrac += 4*ystep;
+	    count -= 4;
+	}
 
-    // We do not check for zero spans here?
-    count = ds_x2 - ds_x1;
+	while (count-- >= 0)
+	{
+	    row[columnofs[flipviewwidth[x++]]] = cm[source[R_SpanSpot(xfrac, yfrac)]];
+	    xfrac += xstep;
+	    yfrac += ystep;
+	}
+
+	return;
+    }
 
     do
     {
-	byte source;
-	// Calculate current texture index in u,v.
-        // [crispy] fix flats getting more distorted the closer they are to the right
-        ytemp = (ds_yfrac >> 10) & 0x0fc0;
-        xtemp = (ds_xfrac >> 16) & 0x3f;
-        spot = xtemp | ytemp;
-
 	// Lookup pixel from flat texture tile,
 	//  re-index using light/colormap.
-	source = ds_source[spot];
-	dest = ylookup[ds_y] + columnofs[flipviewwidth[ds_x1++]];
-	*dest = ds_colormap[ds_brightmap[source]][source];
+	const byte texel = source[R_SpanSpot(xfrac, yfrac)];
+	row[columnofs[flipviewwidth[x++]]] = colormap[brightmap[texel]][texel];
 
-//      position += step;
-        ds_xfrac += ds_xstep;
-        ds_yfrac += ds_ystep;
+        xfrac += xstep;
+        yfrac += ystep;
 
     } while (count--);
 }
 
-
-
 // UNUSED.
 // Loop unrolled by 4.
 #if 0
@@ -922,10 +1069,17 @@ void R_DrawSpan (void)
 void R_DrawSpanLow (void)
 {
 //  unsigned int position, step;
-    unsigned int xtemp, ytemp;
-    pixel_t *dest;
+    // [AP] Locals, as in R_DrawSpan
+    pixel_t *const row = ylookup[ds_y];
+    const byte *const source = ds_source;
+    lighttable_t *const colormap[2] = {ds_colormap[0], ds_colormap[1]};
+    const byte *const brightmap = ds_brightmap;
+    const fixed_t xstep = ds_xstep;
+    const fixed_t ystep = ds_ystep;
+    fixed_t xfrac = ds_xfrac;
+    fixed_t yfrac = ds_yfrac;
+    int x;
     int count;
-    int spot;
 
 #ifdef RANGECHECK
     if (ds_x2 < ds_x1
@@ -949,32 +1103,37 @@ void R_DrawSpanLow (void)
     count = (ds_x2 - ds_x1);
 
     // Blocky mode, need to multiply by 2.
-    ds_x1 <<= 1;
-    ds_x2 <<= 1;
+    x = ds_x1 << 1;
 
-//  dest = ylookup[ds_y] + columnofs[ds_x1];
+    if (brightmap == nobrightmap || colormap[0] == colormap[1])
+    {
+	// [AP] One colormap for the whole span
+	const lighttable_t *const cm = colormap[0];
+
+	do
+	{
+	    const pixel_t pixel = cm[source[R_SpanSpot(xfrac, yfrac)]];
+	    row[columnofs[flipviewwidth[x++]]] = pixel;
+	    row[columnofs[flipviewwidth[x++]]] = pixel;
+
+	    xfrac += xstep;
+	    yfrac += ystep;
+	} while (count--);
+
+	return;
+    }
 
     do
     {
-	byte source;
-	// Calculate current texture index in u,v.
-        // [crispy] fix flats getting more distorted the closer they are to the right
-        ytemp = (ds_yfrac >> 10) & 0x0fc0;
-        xtemp = (ds_xfrac >> 16) & 0x3f;
-        spot = xtemp | ytemp;
-
 	// Lowres/blocky mode does it twice,
 	//  while scale is adjusted appropriately.
-	source = ds_source[spot];
-	dest = ylookup[ds_y] + columnofs[flipviewwidth[ds_x1++]];
-	*dest = ds_colormap[ds_brightmap[source]][source];
-	dest = ylookup[ds_y] + columnofs[flipviewwidth[ds_x1++]];
-	*dest = ds_colormap[ds_brightmap[source]][source];
-
-//	position += step;
-	ds_xfrac += ds_xstep;
-	ds_yfrac += ds_ystep;
+	const byte texel = source[R_SpanSpot(xfrac, yfrac)];
+	const pixel_t pixel = colormap[brightmap[texel]][texel];
+	row[columnofs[flipviewwidth[x++]]] = pixel;
+	row[columnofs[flipviewwidth[x++]]] = pixel;
 
+	xfrac += xstep;
+	yfrac += ystep;
 
     } while (count--);
 }
@@ -1066,10 +1225,101 @@ R_InitBuffer
     else 
 	viewwindowy = (SCREENHEIGHT-SBARHEIGHT-height) >> 1; 
 
+    //!
+    // @category video
+    //
+    // Draw the 3D view into a column-major buffer and copy it to the
+    // screen afterwards. Walls and sprites touch less memory this way
+    // at high resolutions.
+    //
+
+    transposedview = M_ParmExists("-transpose");
+
+    if (transposedview)
+    {
+	if (transposed_buffer == NULL)
+	{
+	    transposed_buffer = Z_Malloc(MAXWIDTH * MAXHEIGHT * sizeof(*transposed_buffer),
+	                                 PU_STATIC, NULL);
+	}
+
+	// [AP] A column after the other, each one height pixels long
+	for (i=0 ; i<width ; i++) 
+	    columnofs[i] = i * height;
+
+	for (i=0 ; i<height ; i++) 
+	    ylookup[i] = transposed_buffer + i;
+
+	dc_pitch = 1;
+	viewdest = I_VideoBuffer + viewwindowy*SCREENWIDTH + viewwindowx;
+	transposedwidth = width;
+	transposedheight = height;
+	return;
+    }
+
     // Preclaculate all row offsets.
     for (i=0 ; i<height ; i++) 
 	ylookup[i] = I_VideoBuffer + (i+viewwindowy)*SCREENWIDTH; 
+
+    dc_pitch = SCREENWIDTH; // [AP]
 } 
+
+
+//
+// [AP] R_TransposeView
+// Copies the view drawn with -transpose to the screen. It goes in square
+// blocks, so that both the reads and the writes stay within a few cache
+// lines at a time.
+//
+#define TRANSPOSEBLOCK 16
+
+void R_TransposeView (void)
+{
+    const int w = transposedwidth;
+    const int h = transposedheight;
+    int bx, by;
+    int x, y;
+
+    for (bx = 0; bx < w; bx += TRANSPOSEBLOCK)
+    {
+	const int x2 = bx + TRANSPOSEBLOCK < w ? bx + TRANSPOSEBLOCK : w;
+
+	for (by = 0; by < h; by += TRANSPOSEBLOCK)
+	{
+	    const int y2 = by + TRANSPOSEBLOCK < h ? by + TRANSPOSEBLOCK : h;
+
+	    for (y = by; y < y2; y++)
+	    {
+		const pixel_t *src = transposed_buffer + bx * h + y;
+		pixel_t *dest = viewdest + y * SCREENWIDTH + bx;
+
+		for (x = bx; x < x2; x++, src += h)
+		    *dest++ = *src;
+	    }
+	}
+    }
+}
+
+
+//
+// [AP] R_FillView
+// Fills the whole view with one color before it is drawn.
+//
+void R_FillView (pixel_t color)
+{
+    if (transposedview)
+    {
+	const int count = transposedwidth * transposedheight;
+	int i;
+
+	for (i = 0; i < count; i++)
+	    transposed_buffer[i] = color;
+    }
+    else
+    {
+	V_DrawFilledBox(viewwindowx, viewwindowy, scaledviewwidth, viewheight, color);
+    }
+}
  
  
 
@@ -32,6 +32,10 @@ extern fixed_t		dc_texturemid;
 extern int		dc_texheight;
 extern const byte*		dc_brightmap;
 
+// [AP] Distance between rows of the view buffer, see -transpose
+extern boolean		transposedview;
+extern int		dc_pitch;
+
 // first pixel in a column
 extern byte*		dc_source;		
 
@@ -64,20 +68,20 @@ R_VideoErase
 ( unsigned	ofs,
   int		count );
 
-extern int		ds_y;
-extern int		ds_x1;
-extern int		ds_x2;
+extern THREADLOCAL int		ds_y;
+extern THREADLOCAL int		ds_x1;
+extern THREADLOCAL int		ds_x2;
 
-extern lighttable_t*	ds_colormap[2];
-extern const byte*		ds_brightmap;
+extern THREADLOCAL lighttable_t*	ds_colormap[2];
+extern THREADLOCAL const byte*		ds_brightmap;
 
-extern fixed_t		ds_xfrac;
-extern fixed_t		ds_yfrac;
-extern fixed_t		ds_xstep;
-extern fixed_t		ds_ystep;
+extern THREADLOCAL fixed_t		ds_xfrac;
+extern THREADLOCAL fixed_t		ds_yfrac;
+extern THREADLOCAL fixed_t		ds_xstep;
+extern THREADLOCAL fixed_t		ds_ystep;
 
 // start of a 64*64 tile image
-extern byte*		ds_source;		
+extern THREADLOCAL byte*		ds_source;		
 
 extern byte*		translationtables;
 extern byte*		dc_translation;
@@ -101,6 +105,12 @@ R_InitBuffer
 ( int		width,
   int		height );
 
+// [AP] Copy a view drawn with -transpose to the screen.
+void R_TransposeView (void);
+
+// [AP] Fill the view with a color, in whichever buffer it is drawn to.
+void R_FillView (pixel_t color);
+
 
 // Initialize color translation tables,
 //  for player rendering etc.
@@ -32,6 +32,7 @@
 
 #include "m_bbox.h"
 #include "m_menu.h"
+#include "m_profile.h" // [AP] -benchmark
 
 #include "i_system.h" // [crispy] I_Realloc()
 #include "p_local.h" // [crispy] MLOOKUNIT
@@ -1105,8 +1106,6 @@ void R_SetupFrame (player_t* player)
 //
 void R_RenderPlayerView (player_t* player)
 {	
-    extern void V_DrawFilledBox (int x, int y, int w, int h, int c);
-
     R_SetupFrame (player);
 
     // Clear buffers.
@@ -1123,8 +1122,7 @@ void R_RenderPlayerView (player_t* player)
     // [crispy] flashing HOM indicator
     if (crispy->flashinghom)
     {
-        V_DrawFilledBox(viewwindowx, viewwindowy,
-            scaledviewwidth, viewheight,
+        R_FillView( // [AP] -transpose
 #ifndef CRISPY_TRUECOLOR
             176 + (gametic % 16));
 #else
@@ -1138,19 +1136,33 @@ void R_RenderPlayerView (player_t* player)
     // [crispy] smooth texture scrolling
     R_InterpolateTextureOffsets();
     // The head node is the last node output.
+    M_ProfileStart(PROF_BSP); // [AP] -benchmark
     R_RenderBSPNode (numnodes-1);
+    M_ProfileStop(PROF_BSP);
     
     // Check for new console commands.
     NetUpdate ();
     
+    M_ProfileStart(PROF_PLANES);
     R_DrawPlanes ();
+    M_ProfileStop(PROF_PLANES);
     
     // Check for new console commands.
     NetUpdate ();
     
     // [crispy] draw fuzz effect independent of rendering frame rate
     R_SetFuzzPosDraw();
+    M_ProfileStart(PROF_MASKED);
     R_DrawMasked ();
+    M_ProfileStop(PROF_MASKED);
+
+    // [AP] -transpose
+    if (transposedview)
+    {
+	M_ProfileStart(PROF_TRANSPOSE);
+	R_TransposeView ();
+	M_ProfileStop(PROF_TRANSPOSE);
+    }
 
     // Check for new console commands.
     NetUpdate ();				
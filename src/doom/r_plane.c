@@ -23,6 +23,8 @@
 #include <stdlib.h>
 
 #include "i_system.h"
+#include "i_thread.h" // [AP] I_RunOnThreads()
+#include "m_argv.h" // [AP] -rthreads
 #include "z_zone.h"
 #include "w_wad.h"
 
@@ -51,6 +53,11 @@ visplane_t*		floorplane;
 visplane_t*		ceilingplane;
 static int		numvisplanes;
 
+// [AP] Planes made by R_FindPlane are chained by height, flat and light,
+// so finding one does not scan every plane in the frame.
+#define VISPLANEHASHSIZE	512
+static int		visplanehash[VISPLANEHASHSIZE];
+
 // ?
 #define MAXOPENINGS	MAXWIDTH*64*4
 int			openings[MAXOPENINGS]; // [crispy] 32-bit integer math
@@ -68,15 +75,15 @@ int			ceilingclip[MAXWIDTH]; // [crispy] 32-bit integer math
 //
 // spanstart holds the start of a plane span
 // initialized to 0 at start
+// [AP] Span state is per thread, planes can be drawn by several threads
 //
-int			spanstart[MAXHEIGHT];
-int			spanstop[MAXHEIGHT];
+THREADLOCAL int		spanstart[MAXHEIGHT];
 
 //
 // texture mapping
 //
-lighttable_t**		planezlight;
-fixed_t			planeheight;
+THREADLOCAL lighttable_t**	planezlight;
+THREADLOCAL fixed_t		planeheight;
 
 fixed_t*			yslope;
 fixed_t			yslopes[LOOKDIRS][MAXHEIGHT];
@@ -84,10 +91,10 @@ fixed_t			distscale[MAXWIDTH];
 fixed_t			basexscale;
 fixed_t			baseyscale;
 
-fixed_t			cachedheight[MAXHEIGHT];
-fixed_t			cacheddistance[MAXHEIGHT];
-fixed_t			cachedxstep[MAXHEIGHT];
-fixed_t			cachedystep[MAXHEIGHT];
+THREADLOCAL fixed_t	cachedheight[MAXHEIGHT];
+THREADLOCAL fixed_t	cacheddistance[MAXHEIGHT];
+THREADLOCAL fixed_t	cachedxstep[MAXHEIGHT];
+THREADLOCAL fixed_t	cachedystep[MAXHEIGHT];
 
 
 
@@ -97,7 +104,21 @@ fixed_t			cachedystep[MAXHEIGHT];
 //
 void R_InitPlanes (void)
 {
-  // Doh!
+    int p;
+
+    //!
+    // @arg <n>
+    // @category video
+    //
+    // Draw floors and ceilings with n threads.
+    //
+
+    p = M_CheckParmWithArgs("-rthreads", 1);
+
+    if (p)
+    {
+        I_InitThreads(atoi(myargv[p + 1]));
+    }
 }
 
 
@@ -204,6 +225,7 @@ void R_ClearPlanes (void)
 
     lastvisplane = visplanes;
     lastopening = openings;
+    memset (visplanehash, 0xff, sizeof(visplanehash)); // [AP] all -1
     
     // texture calculation
     memset (cachedheight, 0, sizeof(cachedheight));
@@ -243,6 +265,30 @@ static void R_RaiseVisplanes (visplane_t** vp)
     }
 }
 
+//
+// [AP] R_VisplaneHash
+//
+static inline unsigned int R_VisplaneHash (fixed_t height, int picnum, int lightlevel)
+{
+    return ((unsigned int) (height >> FRACBITS) * 7
+	  + (unsigned int) picnum * 3
+	  + (unsigned int) lightlevel) & (VISPLANEHASHSIZE - 1);
+}
+
+
+//
+// [AP] R_ClearPlaneTop
+// Marks columns x1 to x2 of a plane as empty. Only the columns between
+// minx and maxx are ever read, so they are cleared as the plane grows
+// rather than all at once when it is made.
+//
+static void R_ClearPlaneTop (visplane_t *pl, int x1, int x2)
+{
+    if (x1 <= x2)
+	memset (pl->top + x1, 0xff, (x2 - x1 + 1) * sizeof(*pl->top));
+}
+
+
 //
 // R_FindPlane
 //
@@ -253,6 +299,8 @@ R_FindPlane
   int		lightlevel )
 {
     visplane_t*	check;
+    unsigned int	hash;
+    int		i;
 	
     // [crispy] add support for MBF sky tranfers
     if (picnum == skyflatnum || picnum & PL_SKYFLAT)
@@ -260,21 +308,24 @@ R_FindPlane
 	height = 0;			// all skys map together
 	lightlevel = 0;
     }
-	
-    for (check=visplanes; check<lastvisplane; check++)
+
+    // [AP] Planes split off by R_CheckPlane are not chained, the first
+    // plane made for the same height, flat and light is always found.
+    hash = R_VisplaneHash(height, picnum, lightlevel);
+
+    for (i = visplanehash[hash]; i != -1; i = check->next)
     {
+	check = &visplanes[i];
+
 	if (height == check->height
 	    && picnum == check->picnum
 	    && lightlevel == check->lightlevel)
 	{
-	    break;
+	    return check;
 	}
     }
-    
-			
-    if (check < lastvisplane)
-	return check;
 		
+    check = lastvisplane;
     R_RaiseVisplanes(&check); // [crispy] remove VISPLANES limit
     if (lastvisplane - visplanes == MAXVISPLANES && false)
 	I_Error ("R_FindPlane: no more visplanes");
@@ -286,8 +337,9 @@ R_FindPlane
     check->lightlevel = lightlevel;
     check->minx = SCREENWIDTH;
     check->maxx = -1;
-    
-    memset (check->top,0xff,sizeof(check->top));
+
+    check->next = visplanehash[hash];
+    visplanehash[hash] = check - visplanes;
 		
     return check;
 }
@@ -340,6 +392,17 @@ R_CheckPlane
   {
     if (x > intrh)
     {
+	// [AP] Columns the plane grows over must read as empty
+	if (pl->minx > pl->maxx)
+	{
+	    R_ClearPlaneTop(pl, unionl, unionh);
+	}
+	else
+	{
+	    R_ClearPlaneTop(pl, unionl, pl->minx - 1);
+	    R_ClearPlaneTop(pl, pl->maxx + 1, unionh);
+	}
+
 	pl->minx = unionl;
 	pl->maxx = unionh;
 
@@ -361,7 +424,7 @@ R_CheckPlane
     pl->minx = start;
     pl->maxx = stop;
 
-    memset (pl->top,0xff,sizeof(pl->top));
+    R_ClearPlaneTop(pl, start, stop); // [AP]
 		
     return pl;
 }
@@ -403,6 +466,118 @@ R_MakeSpans
 
 
 
+//
+// [AP] R_DrawPlaneColumns
+// Draws the part of a flat visplane between columns x1 and x2.
+// Columns outside of that count as empty, so spans get cut at the edges.
+// The spans step linearly from the view center, so a cut span draws the
+// same pixels as a whole one.
+//
+static void R_DrawPlaneColumns (visplane_t *pl, int x1, int x2)
+{
+    int x;
+
+    if (x1 < pl->minx)
+	x1 = pl->minx;
+    if (x2 > pl->maxx)
+	x2 = pl->maxx;
+    if (x1 > x2)
+	return;
+
+    ds_source = pl->source;
+    ds_brightmap = pl->brightmap;
+    planeheight = abs(pl->height-viewz);
+    planezlight = pl->zlight;
+
+    for (x=x1 ; x<= x2 + 1 ; x++)
+    {
+	R_MakeSpans(x, x > x1 ? pl->top[x-1] : 0xffffffffu,
+		    x > x1 ? pl->bottom[x-1] : 0,
+		    x <= x2 ? pl->top[x] : 0xffffffffu,
+		    x <= x2 ? pl->bottom[x] : 0);
+    }
+}
+
+
+//
+// [AP] R_DrawPlanesJob
+// Each worker draws the flats in its own strip of the screen.
+//
+static void R_DrawPlanesJob (int worker, int num_workers, void *data)
+{
+    const int x1 = viewwidth * worker / num_workers;
+    const int x2 = viewwidth * (worker + 1) / num_workers - 1;
+    visplane_t* pl;
+
+    // texture calculation, per thread
+    memset (cachedheight, 0, sizeof(cachedheight));
+
+    for (pl = visplanes ; pl < lastvisplane ; pl++)
+    {
+	if (pl->source)
+	    R_DrawPlaneColumns(pl, x1, x2);
+    }
+}
+
+
+//
+// [AP] R_DrawSkyPlane
+//
+static void R_DrawSkyPlane (visplane_t *pl)
+{
+    int texture;
+    int x;
+    int angle;
+    angle_t an = viewangle, flip;
+    if (pl->picnum & PL_SKYFLAT)
+    {
+	const line_t *l = &lines[pl->picnum & ~PL_SKYFLAT];
+	const side_t *s = *l->sidenum + sides;
+	texture = texturetranslation[s->toptexture];
+	dc_texturemid = s->rowoffset - 28*FRACUNIT;
+	// [crispy] stretch sky
+	if (crispy->stretchsky)
+	{
+	    dc_texturemid = dc_texturemid * (textureheight[texture]>>FRACBITS) / SKYSTRETCH_HEIGHT;
+	}
+	flip = (l->special == 272) ? 0u : ~0u;
+	an += s->textureoffset;
+    }
+    else
+    {
+	texture = skytexture;
+	dc_texturemid = skytexturemid;
+	flip = 0;
+    }
+    dc_iscale = pspriteiscale>>detailshift;
+    
+    // Sky is allways drawn full bright,
+    //  i.e. colormaps[0] is used.
+    // Because of this hack, sky is not affected
+    //  by INVUL inverse mapping.
+    // [crispy] no brightmaps for sky
+    dc_colormap[0] = dc_colormap[1] = colormaps;
+//  dc_texturemid = skytexturemid;
+    dc_texheight = textureheight[texture]>>FRACBITS; // [crispy] Tutti-Frutti fix
+    // [crispy] stretch sky
+    if (crispy->stretchsky)
+        dc_iscale = dc_iscale * dc_texheight / SKYSTRETCH_HEIGHT;
+    for (x=pl->minx ; x <= pl->maxx ; x++)
+    {
+	dc_yl = pl->top[x];
+	dc_yh = pl->bottom[x];
+
+	if ((unsigned) dc_yl <= dc_yh) // [crispy] 32-bit integer math
+	{
+	    angle = ((an + xtoviewangle[x])^flip)>>ANGLETOSKYSHIFT;
+	    dc_x = x;
+	    dc_source = R_GetColumn(texture, angle);
+	    colfunc ();
+	}
+    }
+}
+
+
 //
 // R_DrawPlanes
 // At the end of each frame.
@@ -411,9 +586,6 @@ void R_DrawPlanes (void)
 {
     visplane_t*		pl;
     int			light;
-    int			x;
-    int			stop;
-    int			angle;
     int                 lumpnum;
 				
 #ifdef RANGECHECK
@@ -430,77 +602,33 @@ void R_DrawPlanes (void)
 		 lastopening - openings);
 #endif
 
+    // [AP] Draw the skies and look up the flats. Caching lumps can
+    // allocate, so it all happens here before the worker threads start.
     for (pl = visplanes ; pl < lastvisplane ; pl++)
     {
-	boolean swirling;
+	pl->source = NULL;
 
 	if (pl->minx > pl->maxx)
 	    continue;
 
-	
 	// sky flat
 	// [crispy] add support for MBF sky tranfers
 	if (pl->picnum == skyflatnum || pl->picnum & PL_SKYFLAT)
 	{
-	    int texture;
-	    angle_t an = viewangle, flip;
-	    if (pl->picnum & PL_SKYFLAT)
-	    {
-		const line_t *l = &lines[pl->picnum & ~PL_SKYFLAT];
-		const side_t *s = *l->sidenum + sides;
-		texture = texturetranslation[s->toptexture];
-		dc_texturemid = s->rowoffset - 28*FRACUNIT;
-		// [crispy] stretch sky
-		if (crispy->stretchsky)
-		{
-		    dc_texturemid = dc_texturemid * (textureheight[texture]>>FRACBITS) / SKYSTRETCH_HEIGHT;
-		}
-		flip = (l->special == 272) ? 0u : ~0u;
-		an += s->textureoffset;
-	    }
-	    else
-	    {
-		texture = skytexture;
-		dc_texturemid = skytexturemid;
-		flip = 0;
-	    }
-	    dc_iscale = pspriteiscale>>detailshift;
-	    
-	    // Sky is allways drawn full bright,
-	    //  i.e. colormaps[0] is used.
-	    // Because of this hack, sky is not affected
-	    //  by INVUL inverse mapping.
-	    // [crispy] no brightmaps for sky
-	    dc_colormap[0] = dc_colormap[1] = colormaps;
-//	    dc_texturemid = skytexturemid;
-	    dc_texheight = textureheight[texture]>>FRACBITS; // [crispy] Tutti-Frutti fix
-	    // [crispy] stretch sky
-	    if (crispy->stretchsky)
-	        dc_iscale = dc_iscale * dc_texheight / SKYSTRETCH_HEIGHT;
-	    for (x=pl->minx ; x <= pl->maxx ; x++)
-	    {
-		dc_yl = pl->top[x];
-		dc_yh = pl->bottom[x];
-
-		if ((unsigned) dc_yl <= dc_yh) // [crispy] 32-bit integer math
-		{
-		    angle = ((an + xtoviewangle[x])^flip)>>ANGLETOSKYSHIFT;
-		    dc_x = x;
-		    dc_source = R_GetColumn(texture, angle);
-		    colfunc ();
-		}
-	    }
+	    R_DrawSkyPlane(pl);
 	    continue;
 	}
-	
-	swirling = (flattranslation[pl->picnum] == -1);
-	// regular flat
-        lumpnum = firstflat + (swirling ? pl->picnum : flattranslation[pl->picnum]);
+
 	// [crispy] add support for SMMU swirling flats
-	ds_source = swirling ? R_DistortedFlat(lumpnum) : W_CacheLumpNum(lumpnum, PU_STATIC);
-	ds_brightmap = R_BrightmapForFlatNum(lumpnum-firstflat);
+	// [AP] Those share one buffer, they are drawn one at a time below
+	if (flattranslation[pl->picnum] == -1)
+	    continue;
+
+	// regular flat
+        lumpnum = firstflat + flattranslation[pl->picnum];
+	pl->source = W_CacheLumpNum(lumpnum, PU_STATIC);
+	pl->brightmap = R_BrightmapForFlatNum(lumpnum-firstflat);
 	
-	planeheight = abs(pl->height-viewz);
 	light = (pl->lightlevel >> LIGHTSEGSHIFT)+(extralight * LIGHTBRIGHT);
 
 	if (light >= LIGHTLEVELS)
@@ -509,21 +637,41 @@ void R_DrawPlanes (void)
 	if (light < 0)
 	    light = 0;
 
-	planezlight = zlight[light];
+	pl->zlight = zlight[light];
+    }
 
-	pl->top[pl->maxx+1] = 0xffffffffu; // [crispy] hires / 32-bit integer math
-	pl->top[pl->minx-1] = 0xffffffffu; // [crispy] hires / 32-bit integer math
-		
-	stop = pl->maxx + 1;
+    // [AP] Regular flats, split in strips across the worker threads
+    I_RunOnThreads(R_DrawPlanesJob, NULL);
 
-	for (x=pl->minx ; x<= stop ; x++)
+    for (pl = visplanes ; pl < lastvisplane ; pl++)
+    {
+	if (pl->source)
 	{
-	    R_MakeSpans(x,pl->top[x-1],
-			pl->bottom[x-1],
-			pl->top[x],
-			pl->bottom[x]);
+	    W_ReleaseLumpNum(firstflat + flattranslation[pl->picnum]);
+	    continue;
 	}
-	
-        W_ReleaseLumpNum(lumpnum);
+
+	if (pl->minx > pl->maxx
+	 || pl->picnum == skyflatnum || pl->picnum & PL_SKYFLAT
+	 || flattranslation[pl->picnum] != -1)
+	    continue;
+
+	// [crispy] add support for SMMU swirling flats
+        lumpnum = firstflat + pl->picnum;
+	pl->source = (byte *) R_DistortedFlat(lumpnum);
+	pl->brightmap = R_BrightmapForFlatNum(lumpnum-firstflat);
+
+	light = (pl->lightlevel >> LIGHTSEGSHIFT)+(extralight * LIGHTBRIGHT);
+
+	if (light >= LIGHTLEVELS)
+	    light = LIGHTLEVELS-1;
+
+	if (light < 0)
+	    light = 0;
+
+	pl->zlight = zlight[light];
+
+	R_DrawPlaneColumns(pl, pl->minx, pl->maxx);
+	pl->source = NULL;
     }
 }
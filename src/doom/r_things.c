@@ -19,6 +19,7 @@
 
 
 
+#include <stddef.h>
 #include <stdio.h>
 #include <stdlib.h>
 
@@ -28,6 +29,7 @@
 
 #include "i_swap.h"
 #include "i_system.h"
+#include "m_sort.h"
 #include "z_zone.h"
 #include "w_wad.h"
 
@@ -1172,37 +1174,6 @@ void R_DrawPlayerSprites (void)
 //
 // R_SortVisSprites
 //
-#ifdef HAVE_QSORT
-// [crispy] use stdlib's qsort() function for sorting the vissprites[] array
-static inline int cmp_vissprites (const void *a, const void *b)
-{
-    const vissprite_t *vsa = (const vissprite_t *) a;
-    const vissprite_t *vsb = (const vissprite_t *) b;
-
-    const int ret = vsa->scale - vsb->scale;
-
-    return ret ? ret : vsa->next - vsb->next;
-}
-
-void R_SortVisSprites (void)
-{
-    int count;
-    vissprite_t *ds;
-
-    count = vissprite_p - vissprites;
-
-    if (!count)
-	return;
-
-    // [crispy] maintain a stable sort for deliberately overlaid sprites
-    for (ds = vissprites; ds < vissprite_p; ds++)
-    {
-	ds->next = ds + 1;
-    }
-
-    qsort(vissprites, count, sizeof(*vissprites), cmp_vissprites);
-}
-#else
 vissprite_t	vsprsortedhead;
 
 
@@ -1210,53 +1181,29 @@ void R_SortVisSprites (void)
 {
     int			i;
     int			count;
+    const int*		order;
     vissprite_t*	ds;
-    vissprite_t*	best;
-    vissprite_t		unsorted;
-    fixed_t		bestscale;
 
     count = vissprite_p - vissprites;
-	
-    unsorted.next = unsorted.prev = &unsorted;
 
     if (!count)
 	return;
-		
-    for (ds=vissprites ; ds<vissprite_p ; ds++)
-    {
-	ds->next = ds+1;
-	ds->prev = ds-1;
-    }
-    
-    vissprites[0].prev = &unsorted;
-    unsorted.next = &vissprites[0];
-    (vissprite_p-1)->next = &unsorted;
-    unsorted.prev = vissprite_p-1;
-    
-    // pull the vissprites out by scale
+
+    // [AP] sort on scale and link the vissprites up in that order;
+    // sprites at the same scale stay in the order they were added
+    order = M_SortByIntKey(vissprites, count, sizeof(*vissprites),
+                           offsetof(vissprite_t, scale));
 
     vsprsortedhead.next = vsprsortedhead.prev = &vsprsortedhead;
     for (i=0 ; i<count ; i++)
     {
-	bestscale = INT_MAX;
-        best = unsorted.next;
-	for (ds=unsorted.next ; ds!= &unsorted ; ds=ds->next)
-	{
-	    if (ds->scale < bestscale)
-	    {
-		bestscale = ds->scale;
-		best = ds;
-	    }
-	}
-	best->next->prev = best->prev;
-	best->prev->next = best->next;
-	best->next = &vsprsortedhead;
-	best->prev = vsprsortedhead.prev;
-	vsprsortedhead.prev->next = best;
-	vsprsortedhead.prev = best;
+	ds = &vissprites[order[i]];
+	ds->next = &vsprsortedhead;
+	ds->prev = vsprsortedhead.prev;
+	vsprsortedhead.prev->next = ds;
+	vsprsortedhead.prev = ds;
     }
 }
-#endif
 
 
 
@@ -1389,15 +1336,9 @@ void R_DrawMasked (void)
     if (vissprite_p > vissprites)
     {
 	// draw all vissprites back to front
-#ifdef HAVE_QSORT
-	for (spr = vissprites;
-	     spr < vissprite_p;
-	     spr++)
-#else
 	for (spr = vsprsortedhead.next ;
 	     spr != &vsprsortedhead ;
 	     spr=spr->next)
-#endif
 	{
 	    
 	    R_DrawSprite (spr);
@@ -90,6 +90,15 @@
 
 #define PACKED_STRUCT(...) PACKEDPREFIX struct __VA_ARGS__ PACKEDATTR
 
+// [AP] Globals with one copy per thread, for state used by renderer
+// worker threads.
+
+#if defined(_MSC_VER)
+#define THREADLOCAL __declspec(thread)
+#else
+#define THREADLOCAL __thread
+#endif
+
 // C99 integer types; with gcc we just use this.  Other compilers
 // should add conditional statements that define the C99 types.
 
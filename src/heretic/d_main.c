@@ -41,6 +41,8 @@
 #include "m_config.h"
 #include "m_controls.h"
 #include "m_misc.h"
+#include "m_profile.h" // [AP] -benchmark
+#include "m_snapshot.h" // [AP] compress_savegames
 #include "p_local.h"
 #include "s_sound.h"
 #include "w_main.h"
@@ -1087,6 +1089,7 @@ void D_BindVariables(void)
     M_BindIntVariable("snd_channels",           &snd_Channels);
     M_BindIntVariable("vanilla_savegame_limit", &vanilla_savegame_limit);
     M_BindIntVariable("vanilla_demo_limit",     &vanilla_demo_limit);
+    M_BindIntVariable("compress_savegames",     &compress_savegames); // [AP]
     M_BindIntVariable("show_endoom",            &show_endoom);
     M_BindIntVariable("graphical_startup",      &graphical_startup);
 
@@ -1400,6 +1403,10 @@ void D_DoomMain(void)
         ap_settings.reset_level_on_death = atoi(myargv[reset_level_on_death_id + 1]) ? 1 : 0;
     }
 
+    int items_per_tic_id = M_CheckParmWithArgs("-apitemspertic", 1);
+    if (items_per_tic_id)
+        ap_settings.items_per_tic = atoi(myargv[items_per_tic_id + 1]);
+
     // Initialize AP
     ap_settings.ip = myargv[apserver_arg_id + 1];
     if (mission == heretic)
@@ -1747,12 +1754,15 @@ void D_DoomMain(void)
 
     tprintf(DEH_String("SB_Init: Loading patches.\n"), 1);
     SB_Init();
+    ap_notif_init();
     IncThermo();
 
 //
 // start the appropriate game based on params
 //
 
+    M_ProfileInit(); // [AP] -benchmark, before any demo starts
+
     D_CheckRecordFrom();
 
     //!
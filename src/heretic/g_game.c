@@ -29,6 +29,7 @@
 #include "m_argv.h"
 #include "m_controls.h"
 #include "m_misc.h"
+#include "m_profile.h" // [AP] -benchmark
 #include "m_random.h"
 #include "p_local.h"
 #include "s_sound.h"
@@ -1500,7 +1501,9 @@ void G_Ticker(void)
     switch (gamestate)
     {
         case GS_LEVEL:
+            M_ProfileStart(PROF_TICKER); // [AP] -benchmark
             P_Ticker();
+            M_ProfileStop(PROF_TICKER);
             SB_Ticker();
             AM_Ticker();
             CT_Ticker();
@@ -24,6 +24,7 @@
 #include "apdoom.h"
 #include "i_video.h"
 #include "m_misc.h"
+#include "m_snapshot.h"
 #include "ap_msg.h"
 #include "m_controls.h"
 #include "i_timer.h"
@@ -206,7 +207,7 @@ void play_level(int ep, int lvl)
     // Check if level has a save file first
     char filename[260];
     snprintf(filename, 260, "%s/save_E%iM%i.dsg", apdoom_get_seed(), ep + 1, lvl + 1);
-    if (M_FileExists(filename))
+    if (M_SnapshotExists(filename)) // [AP] may still be queued for writing
     {
         // We load
         extern char savename[256];
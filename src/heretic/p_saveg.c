@@ -22,12 +22,14 @@
 #include "i_swap.h"
 #include "i_system.h"
 #include "m_misc.h"
+#include "m_savebuf.h"
+#include "m_snapshot.h"
 #include "p_local.h"
 #include "v_video.h"
 
 #include "apdoom.h"
 
-static FILE *SaveGameFP;
+static savebuf_t SaveGameBuf; // [AP] serialized in memory, see m_snapshot.c
 
 int vanilla_savegame_limit = 1;
 
@@ -66,17 +68,23 @@ char *SV_Filename(int slot)
 
 void SV_Open(char *fileName)
 {
-    SaveGameFP = M_fopen(fileName, "wb");
+    M_SaveBufCreate(&SaveGameBuf);
 }
 
 void SV_OpenRead(char *filename)
 {
-    SaveGameFP = M_fopen(filename, "rb");
+    byte *data;
+    size_t length;
 
-    if (SaveGameFP == NULL)
+    // [AP] recently played levels come straight from memory
+    data = M_SnapshotLoad(filename, &length);
+
+    if (data == NULL)
     {
         I_Error("Could not load savegame %s", filename);
     }
+
+    M_SaveBufOpen(&SaveGameBuf, data, length);
 }
 
 //==========================================================================
@@ -87,16 +95,21 @@ void SV_OpenRead(char *filename)
 
 void SV_Close(char *fileName)
 {
+    byte *data;
+    size_t length;
+
     SV_WriteByte(SAVE_GAME_TERMINATOR);
 
     // Enforce the same savegame size limit as in Vanilla Heretic
 
-    if (vanilla_savegame_limit && ftell(SaveGameFP) > SAVEGAMESIZE)
+    if (vanilla_savegame_limit && M_SaveBufTell(&SaveGameBuf) > SAVEGAMESIZE)
     {
         I_Error("Savegame buffer overrun");
     }
 
-    fclose(SaveGameFP);
+    // [AP] kept in the snapshot cache and written in the background
+    data = M_SaveBufDetach(&SaveGameBuf, &length);
+    M_SnapshotStore(fileName, data, length);
 }
 
 //==========================================================================
@@ -107,12 +120,12 @@ void SV_Close(char *fileName)
 
 void SV_Write(void *buffer, int size)
 {
-    fwrite(buffer, size, 1, SaveGameFP);
+    M_SaveBufWrite(&SaveGameBuf, buffer, size);
 }
 
 void SV_WriteByte(byte val)
 {
-    SV_Write(&val, sizeof(byte));
+    M_SaveBufWrite8(&SaveGameBuf, val);
 }
 
 void SV_WriteWord(unsigned short val)
@@ -142,7 +155,7 @@ void SV_WritePtr(const void *ptr)
 
 void SV_Read(void *buffer, int size)
 {
-    int retval = fread(buffer, 1, size, SaveGameFP);
+    int retval = M_SaveBufRead(&SaveGameBuf, buffer, size);
     if (retval != size)
     {
         I_Error("Incomplete read in SV_Read: Expected %d, got %d bytes",
@@ -153,7 +166,10 @@ void SV_Read(void *buffer, int size)
 byte SV_ReadByte(void)
 {
     byte result;
-    SV_Read(&result, sizeof(byte));
+    if (!M_SaveBufRead8(&SaveGameBuf, &result))
+    {
+        I_Error("Incomplete read in SV_Read: Expected 1, got 0 bytes");
+    }
     return result;
 }
 
@@ -81,17 +81,6 @@ fixed_t GetOffset(vertex_t *v1, vertex_t *v2)
 }
 
 
-unsigned long long hash_seed(unsigned char *str)
-{
-    unsigned long long hash = 5381;
-    int c;
-
-    while (c = *str++)
-        hash = ((hash << 5) + hash) + c; /* hash * 33 + c */
-
-    return hash;
-}
-
 /*
 =================
 =
@@ -102,16 +91,16 @@ unsigned long long hash_seed(unsigned char *str)
 
 void P_LoadVertexes(int lump)
 {
-    byte *data;
+    lumpview_t view;
     int i;
-    mapvertex_t *ml;
+    const mapvertex_t *ml;
     vertex_t *li;
 
-    numvertexes = W_LumpLength(lump) / sizeof(mapvertex_t);
+    W_OpenLumpView(lump, WAD_ADVICE_SEQUENTIAL, &view); // [AP]
+    numvertexes = view.length / sizeof(mapvertex_t);
     vertexes = Z_Malloc(numvertexes * sizeof(vertex_t), PU_LEVEL, 0);
-    data = W_CacheLumpNum(lump, PU_STATIC);
 
-    ml = (mapvertex_t *) data;
+    ml = (const mapvertex_t *) view.data;
     li = vertexes;
     for (i = 0; i < numvertexes; i++, li++, ml++)
     {
@@ -124,7 +113,7 @@ void P_LoadVertexes(int lump)
         li->moved = false;
     }
 
-    W_ReleaseLumpNum(lump);
+    W_CloseLumpView(&view);
 }
 
 
@@ -138,19 +127,19 @@ void P_LoadVertexes(int lump)
 
 void P_LoadSegs(int lump)
 {
-    byte *data;
+    lumpview_t view;
     int i;
-    mapseg_t *ml;
+    const mapseg_t *ml;
     seg_t *li;
     line_t *ldef;
     int linedef, side;
 
-    numsegs = W_LumpLength(lump) / sizeof(mapseg_t);
+    W_OpenLumpView(lump, WAD_ADVICE_SEQUENTIAL, &view); // [AP]
+    numsegs = view.length / sizeof(mapseg_t);
     segs = Z_Malloc(numsegs * sizeof(seg_t), PU_LEVEL, 0);
     memset(segs, 0, numsegs * sizeof(seg_t));
-    data = W_CacheLumpNum(lump, PU_STATIC);
 
-    ml = (mapseg_t *) data;
+    ml = (const mapseg_t *) view.data;
     li = segs;
     for (i = 0; i < numsegs; i++, li++, ml++)
     {
@@ -173,7 +162,7 @@ void P_LoadSegs(int lump)
             li->backsector = 0;
     }
 
-    W_ReleaseLumpNum(lump);
+    W_CloseLumpView(&view);
 }
 
 // [crispy] fix long wall wobble
@@ -258,23 +247,17 @@ void P_LoadSubsectors(int lump)
 
 void P_LoadSectors(int lump)
 {
-    byte *data;
+    lumpview_t view;
     int i;
-    mapsector_t *ms;
+    const mapsector_t *ms;
     sector_t *ss;
 
-    numsectors = W_LumpLength(lump) / sizeof(mapsector_t);
+    W_OpenLumpView(lump, WAD_ADVICE_SEQUENTIAL, &view); // [AP]
+    numsectors = view.length / sizeof(mapsector_t);
     sectors = Z_Malloc(numsectors * sizeof(sector_t), PU_LEVEL, 0);
     memset(sectors, 0, numsectors * sizeof(sector_t));
-    data = W_CacheLumpNum(lump, PU_STATIC);
 
-    ms = (mapsector_t *) data;
-
-    if (gameepisode == 1 && gamemap == 7)
-    {
-        ms[74].tag = 3333;
-        sprintf(ms[74].floorpic, "FLOOR28");
-    }
+    ms = (const mapsector_t *) view.data;
 
     ss = sectors;
     for (i = 0; i < numsectors; i++, ss++, ms++)
@@ -302,7 +285,14 @@ void P_LoadSectors(int lump)
         ss->oldgametic = -1;
     }
 
-    W_ReleaseLumpNum(lump);
+    // [AP] Fixes are applied to the loaded sectors, the view is read-only.
+    if (gameepisode == 1 && gamemap == 7 && numsectors > 74)
+    {
+        sectors[74].tag = 3333;
+        sectors[74].floorpic = R_FlatNumForName("FLOOR28");
+    }
+
+    W_CloseLumpView(&view);
 }
 
 
@@ -361,150 +351,75 @@ void P_LoadNodes(int lump)
 }
 
 
-typedef enum
-{
-    // Not size, but difficulty
-    rmc_small,
-    rmc_medium,
-    rmc_big,
-    rmc_boss,
-
-    NUM_RMC
-} random_monster_cat_t;
-
+//
+// [AP] Fit probing for random monster placement. The lines that can keep a
+// monster from standing at a spawn are gathered once for the largest radius,
+// then every smaller radius only tests those.
+//
 
-typedef struct
-{
-    int doom_type;
-    int hit_points;
-    int radius;
-    int height;
-    int frequency; // Globally in entire game. This is used for random balanced
-    random_monster_cat_t category;
-    int dont_shuffle;
-} random_monster_def_t;
-
-
-// I feel like these ratios should be per episode. Espideo 4-5 squewing things up a bit
-static random_monster_def_t random_monster_defs[] =
-{
-    { 66, 40, 16*FRACUNIT, 36*FRACUNIT, 1350, rmc_small }, // Gargoyle
-    { 5, 80, 16*FRACUNIT, 36*FRACUNIT, 626, rmc_small }, // Fire gargoyle
-    { 68, 80, 22*FRACUNIT, 62*FRACUNIT, 560, rmc_small }, // Golem
-    { 69, 80, 22*FRACUNIT, 62*FRACUNIT, 137, rmc_small }, // Golem ghost
-    { 45, 100, 22*FRACUNIT, 62*FRACUNIT, 292, rmc_small }, // Nitrogolem
-    { 46, 100, 22*FRACUNIT, 62*FRACUNIT, 153, rmc_small }, // Nitrogolem ghost
-
-    { 64, 200, 24*FRACUNIT, 78*FRACUNIT, 193, rmc_medium }, // Undead Warrior
-    { 65, 200, 24*FRACUNIT, 78*FRACUNIT, 55, rmc_medium }, // Undead Warrior ghost
-    { 15, 180, 16*FRACUNIT, 68*FRACUNIT, 476, rmc_medium }, // Disciple of D'Sparil
-    { 90, 150, 20*FRACUNIT, 64*FRACUNIT, 652, rmc_medium }, // Sabreclaw
-    { 70, 220, 32*FRACUNIT, 74*FRACUNIT, 248, rmc_medium }, // Weredragon
-    { 92, 280, 22*FRACUNIT, 70*FRACUNIT, 284, rmc_medium }, // Ophidian
-
-    { 6, 700, 50*FRACUNIT, 72*FRACUNIT, 108, rmc_big }, // Iron lich (Changed this radius from 40 -> 50 otherwise it gets stuck in stairs)
-
-    { 9, 3000, 28*FRACUNIT, 100*FRACUNIT, 22, rmc_boss, 1 }, // Maulotaur
-    { 7, 2000, 28*FRACUNIT, 100*FRACUNIT, 1, rmc_boss, 1 } // D'Sparil 28x100 [Boss, keep them there]
+static const fixed_t fit_radii[] = {
+    128*FRACUNIT,
+    64*FRACUNIT,
+    48*FRACUNIT,
+    40*FRACUNIT,
+    31*FRACUNIT,
+    30*FRACUNIT,
+    24*FRACUNIT,
+    20*FRACUNIT,
+    16*FRACUNIT
 };
-static const int monster_def_count = sizeof(random_monster_defs) / sizeof(random_monster_def_t);
-
-
-typedef struct
-{
-    int index;
-    random_monster_def_t* og_monster;
-    random_monster_def_t* monster;
-    fixed_t fit_radius;
-    fixed_t fit_height;
-} monster_spawn_def_t;
 
+static const fixed_t fit_heights[] = {
+    110*FRACUNIT,
+    100*FRACUNIT,
+    64*FRACUNIT,
+    56*FRACUNIT
+};
 
-extern fixed_t tmbbox[4];
-extern int tmflags;
-extern fixed_t tmx;
-extern fixed_t tmy;
-fixed_t tmradius;
-int tmtype;
+static fixed_t fit_bbox[4];
+static line_t **fit_lines;
+static int fit_lines_count;
+static int fit_lines_max;
 
 
-boolean PIT_CheckLine_NoFlags(line_t* ld)
+static void SetFitBox(fixed_t x, fixed_t y, fixed_t radius)
 {
-    if (tmbbox[BOXRIGHT] <= ld->bbox[BOXLEFT]
-     || tmbbox[BOXLEFT] >= ld->bbox[BOXRIGHT]
-     || tmbbox[BOXTOP] <= ld->bbox[BOXBOTTOM]
-     || tmbbox[BOXBOTTOM] >= ld->bbox[BOXTOP])
-        return true;
-
-    if (P_BoxOnLineSide (tmbbox, ld) != -1)
-        return true;
-		
-    // A line has been hit
-    
-    // The moving thing's destination position will cross
-    // the given line.
-    // If this should not be allowed, return false.
-    // If the line is special, keep track of it
-    // to process later if the move is proven ok.
-    // NOTE: specials are NOT sorted by order,
-    // so two special lines that are only 8 pixels apart
-    // could be crossed in either order.
-
-    //if (tmtype == 6)
-    //    return false; // Iron lich are too big
-    
-    if (!ld->backsector)
-	    return false;		// one sided line
-		
-	if (ld->flags & ML_BLOCKING)
-	    return false;	// explicitly blocking everything
+    fit_bbox[BOXTOP] = y + radius;
+    fit_bbox[BOXBOTTOM] = y - radius;
+    fit_bbox[BOXRIGHT] = x + radius;
+    fit_bbox[BOXLEFT] = x - radius;
+}
 
-	if (ld->flags & ML_BLOCKMONSTERS)
-	    return false;	// block monsters only
 
-    if (tmradius <= 20)
-        return true; // Smallest unit
+static boolean FitBoxTouches(line_t *ld)
+{
+    if (fit_bbox[BOXRIGHT] <= ld->bbox[BOXLEFT]
+     || fit_bbox[BOXLEFT] >= ld->bbox[BOXRIGHT]
+     || fit_bbox[BOXTOP] <= ld->bbox[BOXBOTTOM]
+     || fit_bbox[BOXBOTTOM] >= ld->bbox[BOXTOP])
+        return false;
 
-    // Check if the back sector can step up/down
-    float floor = ld->frontsector->floorheight;
-    float back_floor = ld->backsector->floorheight;
-    
-    return abs(floor - back_floor) <= 20 * FRACUNIT;
+    return P_BoxOnLineSide(fit_bbox, ld) == -1;
 }
 
 
-boolean check_position(fixed_t x, fixed_t y, fixed_t radius)
+static boolean PIT_GatherFitLine(line_t *ld)
 {
-    int			xl;
-    int			xh;
-    int			yl;
-    int			yh;
-    int			bx;
-    int			by;
-    subsector_t*	newsubsec;
-	
-    tmx = x;
-    tmy = y;
-    tmradius = radius;
-	
-    tmbbox[BOXTOP] = y + radius;
-    tmbbox[BOXBOTTOM] = y - radius;
-    tmbbox[BOXRIGHT] = x + radius;
-    tmbbox[BOXLEFT] = x - radius;
-
-    newsubsec = R_PointInSubsector(x, y);
-    validcount++;
-    
-    // check lines
-    xl = (tmbbox[BOXLEFT] - bmaporgx)>>MAPBLOCKSHIFT;
-    xh = (tmbbox[BOXRIGHT] - bmaporgx)>>MAPBLOCKSHIFT;
-    yl = (tmbbox[BOXBOTTOM] - bmaporgy)>>MAPBLOCKSHIFT;
-    yh = (tmbbox[BOXTOP] - bmaporgy)>>MAPBLOCKSHIFT;
+    if (!FitBoxTouches(ld))
+        return true;
+
+    // Monsters can cross two sided lines they could step over
+    if (ld->backsector
+     && !(ld->flags & (ML_BLOCKING | ML_BLOCKMONSTERS))
+     && abs(ld->frontsector->floorheight - ld->backsector->floorheight) <= 20 * FRACUNIT)
+        return true;
 
-    for (bx=xl ; bx<=xh ; bx++)
-        for (by=yl ; by<=yh ; by++)
-            if (!P_BlockLinesIterator(bx, by, PIT_CheckLine_NoFlags))
-                return false;
+    if (fit_lines_count == fit_lines_max)
+    {
+        fit_lines_max = fit_lines_max ? fit_lines_max * 2 : 64;
+        fit_lines = I_Realloc(fit_lines, fit_lines_max * sizeof(*fit_lines));
+    }
+    fit_lines[fit_lines_count++] = ld;
 
     return true;
 }
@@ -512,45 +427,42 @@ boolean check_position(fixed_t x, fixed_t y, fixed_t radius)
 
 void get_fit_dimensions(fixed_t x, fixed_t y, fixed_t* fit_radius, fixed_t* fit_height)
 {
-    static const fixed_t radius_checks[] = {
-        128*FRACUNIT,
-        64*FRACUNIT,
-        48*FRACUNIT,
-        40*FRACUNIT,
-        31*FRACUNIT,
-        30*FRACUNIT,
-        24*FRACUNIT,
-        20*FRACUNIT,
-        16*FRACUNIT
-    };
-
-    static const fixed_t height_checks[] = {
-        110*FRACUNIT,
-        100*FRACUNIT,
-        64*FRACUNIT,
-        56*FRACUNIT
-    };
-
-    subsector_t* ss = R_PointInSubsector(x, y);
-
-    for (int i = 0, len = sizeof(height_checks) / sizeof(fixed_t); i < len; ++i)
+    sector_t *sector = R_PointInSubsector(x, y)->sector;
+    fixed_t sector_height = sector->ceilingheight - sector->floorheight;
+    int bx, by;
+    int i, j;
+
+    for (i = 0; i < arrlen(fit_heights); ++i)
     {
-        fixed_t sector_height = ss->sector->ceilingheight - ss->sector->floorheight;
-        if (sector_height >= height_checks[i] || i == len - 1)
+        if (sector_height >= fit_heights[i] || i == arrlen(fit_heights) - 1)
         {
-            *fit_height = height_checks[i];
+            *fit_height = fit_heights[i];
             break;
         }
     }
 
-    for (int i = 0, len = sizeof(radius_checks) / sizeof(fixed_t); i < len; ++i)
+    fit_lines_count = 0;
+    SetFitBox(x, y, fit_radii[0]);
+    validcount++;
+
+    for (bx = (fit_bbox[BOXLEFT] - bmaporgx) >> MAPBLOCKSHIFT;
+         bx <= (fit_bbox[BOXRIGHT] - bmaporgx) >> MAPBLOCKSHIFT; bx++)
+        for (by = (fit_bbox[BOXBOTTOM] - bmaporgy) >> MAPBLOCKSHIFT;
+             by <= (fit_bbox[BOXTOP] - bmaporgy) >> MAPBLOCKSHIFT; by++)
+            P_BlockLinesIterator(bx, by, PIT_GatherFitLine);
+
+    // A smaller box only touches lines the largest one touched
+    for (i = 0; i < arrlen(fit_radii) - 1; ++i)
     {
-        if (check_position(x, y, radius_checks[i]) || i == len - 1)
-        {
-            *fit_radius = radius_checks[i];
+        SetFitBox(x, y, fit_radii[i]);
+        for (j = 0; j < fit_lines_count; ++j)
+            if (FitBoxTouches(fit_lines[j]))
+                break;
+        if (j == fit_lines_count)
             break;
-        }
     }
+
+    *fit_radius = fit_radii[i];
 }
 
 
@@ -565,409 +477,20 @@ void get_fit_dimensions(fixed_t x, fixed_t y, fixed_t* fit_radius, fixed_t* fit_
 void P_LoadThings(int lump)
 {
     byte *data;
-    int i, j;
+    int i;
     mapthing_t spawnthing;
     mapthing_t spawnthing_player1_start;
     mapthing_t *mt;
     int numthings;
-    int bit;
+    const int *remap;
 
     data = W_CacheLumpNum(lump, PU_STATIC);
     numthings = W_LumpLength(lump) / sizeof(mapthing_t);
 
-    // Generate unique random seed from ap seed + level
-    const char* ap_seed = apdoom_get_seed();
-    unsigned long long seed = hash_seed(ap_seed);
-    seed += gameepisode * 9 + gamemap;
-    srand(seed);
-
-    int things_type_remap[1024] = {0};
-
-    mt = (mapthing_t *)data;
-    for (i = 0; i < numthings; i++, mt++)
-    {
-        things_type_remap[i] = mt->type;
-    }
-    
-#define E1M8_CUTOFF_OFFSET -1984
-
-    int do_random_monsters = ap_state.random_monsters;
-    if (do_random_monsters > 0)
-    {
-        // Make sure at the right difficulty level
-        if (gameskill == sk_baby)
-            bit = 1;
-        else if (gameskill == sk_nightmare)
-            bit = 4;
-        else
-            bit = 1<<(gameskill-1);
-
-        random_monster_def_t* monsters[1024] = {0};
-        int monster_count = 0;
-        monster_spawn_def_t spawns[1024] = {0};
-        int spawn_count = 0;
-
-        // Collect spawn points
-        mt = (mapthing_t *)data;
-        for (i = 0; i < numthings; i++, mt++)
-        {
-            if (!(mt->options & bit))
-                continue;
-
-            for (int j = 0; j < monster_def_count; ++j)
-            {
-                if (random_monster_defs[j].dont_shuffle)
-                    continue;
-
-                if (gameepisode == 1 && gamemap == 8)
-                    if (mt->y < E1M8_CUTOFF_OFFSET)
-                        continue;
-
-                if (random_monster_defs[j].doom_type == mt->type)
-                {
-                    tmtype = mt->type;
-                    get_fit_dimensions(mt->x * FRACUNIT, mt->y * FRACUNIT, &spawns[spawn_count].fit_radius, &spawns[spawn_count].fit_height);
-                    spawns[spawn_count].og_monster = &random_monster_defs[j];
-                    spawns[spawn_count++].index = i;
-                    break;
-                }
-            }
-        }
-
-        if (ap_state.random_monsters == 1) // Shuffle
-        {
-            // Collect monsters
-            for (int i = 0; i < spawn_count; ++i)
-            {
-                monster_spawn_def_t* spawn = &spawns[i];
-                monsters[monster_count++] = spawn->og_monster;
-            }
-        }
-        else if (ap_state.random_monsters == 2) // Random balanced
-        {
-            int ratios[NUM_RMC] = {0};
-            random_monster_def_t* defs_by_rmc[NUM_RMC][20];
-            int defs_by_rmc_count[NUM_RMC] = {0};
-            int rmc_ratios[NUM_RMC] = {0};
-            for (int i = 0; i < monster_def_count; ++i)
-            {
-                random_monster_def_t* monster = &random_monster_defs[i];
-                defs_by_rmc[monster->category][defs_by_rmc_count[monster->category]++] = monster;
-                rmc_ratios[monster->category] += monster->frequency;
-            }
-
-            int total = 0;
-            for (int i = 0; i < spawn_count; ++i)
-            {
-                ratios[spawns[i].og_monster->category]++;
-                total++;
-            }
-
-            while (monster_count < spawn_count)
-            {
-                int rnd = rand() % total;
-                for (int i = 0; i < NUM_RMC; ++i)
-                {
-                    if (rnd < ratios[i])
-                    {
-                        rnd = rand() % rmc_ratios[i];
-                        for (int j = 0; j < defs_by_rmc_count[i]; ++j)
-                        {
-                            if (rnd < defs_by_rmc[i][j]->frequency)
-                            {
-                                monsters[monster_count++] = defs_by_rmc[i][j];
-                                break;
-                            }
-                            rnd -= defs_by_rmc[i][j]->frequency;
-                        }
-                        break;
-                    }
-                    rnd -= ratios[i];
-                }
-            }
-        }
-        else if (ap_state.random_monsters == 3) // Random chaotic
-        {
-            int total = 0;
-            for (int i = 0; i < monster_def_count; ++i)
-            {
-                random_monster_def_t* monster = &random_monster_defs[i];
-                if (monster->dont_shuffle) continue;
-                total += monster->frequency;
-            }
-
-            while (monster_count < spawn_count)
-            {
-                int rnd = rand() % total;
-                for (int i = 0; i < monster_def_count; ++i)
-                {
-                    random_monster_def_t* monster = &random_monster_defs[i];
-                    if (monster->dont_shuffle) continue;
-                    if (rnd < monster->frequency)
-                    {
-                        monsters[monster_count++] = monster;
-                        break;
-                    }
-                    rnd -= monster->frequency;
-                }
-            }
-        }
-
-        // Make sure we have at least 2 iron lynch in first episode boss level
-        if (gameepisode == 1 && gamemap == 8)
-        {
-            int iron_lynch_count = 0;
-            for (int i = 0; i < monster_count; ++i)
-                if (monsters[i]->doom_type == 6)
-                    iron_lynch_count++;
-            while (iron_lynch_count < 2)
-            {
-                int i = rand() % monster_count;
-                if (monsters[i]->doom_type != 6)
-                {
-                    monsters[i] = &random_monster_defs[12];
-                    iron_lynch_count++;
-                }
-            }
-        }
-
-        // Make sure we have at least 1 iron lynch in E4M8
-        if (gameepisode == 4 && gamemap == 8)
-        {
-            int iron_lynch_count = 0;
-            for (int i = 0; i < monster_count; ++i)
-                if (monsters[i]->doom_type == 6)
-                    iron_lynch_count++;
-            while (iron_lynch_count < 1)
-            {
-                int i = rand() % monster_count;
-                if (monsters[i]->doom_type != 6)
-                {
-                    monsters[i] = &random_monster_defs[12];
-                    iron_lynch_count++;
-                }
-            }
-        }
-        
-        // Randomly pick them until empty, and place them in different spots
-        for (i = 0; i < spawn_count; i++)
-        {
-            int idx = rand() % monster_count;
-            spawns[i].monster = monsters[idx];
-            monsters[idx] = monsters[monster_count - 1];
-            monster_count--;
-        }
-
-        // Go through again, and make sure they fit
-        for (i = 0; i < spawn_count; i++)
-        {
-            monster_spawn_def_t* spawn1 = &spawns[i];
-            if (spawn1->monster->height > spawn1->fit_height ||
-                spawn1->monster->radius > spawn1->fit_radius)
-            {
-                // He doesn't fit here, find another monster randomly that would fit here, then swap
-                int tries = 1000;
-                while (tries--)
-                {
-                    int j = rand() % spawn_count;
-                    if (j == i) continue;
-                    monster_spawn_def_t* spawn2 = &spawns[j];
-                    if (spawn1->monster->height <= spawn2->fit_height &&
-                        spawn1->monster->radius <= spawn2->fit_radius &&
-                        spawn2->monster->height <= spawn1->fit_height &&
-                        spawn2->monster->radius <= spawn1->fit_radius)
-                    {
-                        random_monster_def_t* tmp = spawn1->monster;
-                        spawn1->monster = spawn2->monster;
-                        spawn2->monster = tmp;
-                        break;
-                    }
-                }
-            }
-        }
-
-        // Do the final remapping
-        for (i = 0; i < spawn_count; i++)
-        {
-            monster_spawn_def_t* spawn = &spawns[i];
-            things_type_remap[spawn->index] = spawn->monster->doom_type;
-        }
-    }
-
-    if (ap_state.random_items > 0)
-    {
-        // Make sure at the right difficulty level
-        if (gameskill == sk_baby)
-            bit = 1;
-        else if (gameskill == sk_nightmare)
-            bit = 4;
-        else
-            bit = 1<<(gameskill-1);
-
-        if (ap_state.random_items == 1) // Shuffle
-        {
-            int items[1024];
-            int item_count = 0;
-            int indices[1024];
-            int index_count = 0;
-
-            // Collect all items
-            mt = (mapthing_t *)data;
-            for (i = 0; i < numthings; i++, mt++)
-            {
-                if (mt->options & 16)
-                    continue; // Multiplayer item
-                if (!(mt->options & bit))
-                    continue;
-
-                switch (mt->type)
-                {
-                    case 54: // Claw Orb
-                    case 12: // Crystal Geode
-                    case 55: // Energy Orb
-                    case 18: // Ethereal Arrows
-                    case 22: // Flame Orb
-                    case 21: // Greater Runes
-                    case 23: // Inferno Orb
-                    case 20: // Lesser Runes
-                    case 13: // Mace Spheres
-                    case 16: // Pile of Mace Spheres
-                    case 19: // Quiver of Ethereal Arrows
-                    case 10: // Wand Crystal
-                    case 81: // Crystal Vial
-                    case 82: // Quartz Flask
-                    {
-                        items[item_count++] = mt->type;
-                        indices[index_count++] = i;
-                        break;
-                    }
-                }
-            }
-
-            // Randomly pick them until empty, and place them in different spots
-            mt = (mapthing_t *)data;
-            for (i = 0; i < index_count; i++)
-            {
-                int idx = rand() % item_count;
-                things_type_remap[indices[i]] = items[idx];
-                items[idx] = items[item_count - 1];
-                item_count--;
-            }
-        }
-        else if (ap_state.random_items == 2) // Random balanced
-        {
-            int ratios[3] = {0, 0, 0};
-            int total = 0;
-
-            // Make sure at the right difficulty level
-            if (gameskill == sk_baby)
-                bit = 1;
-            else if (gameskill == sk_nightmare)
-                bit = 4;
-            else
-                bit = 1<<(gameskill-1);
-
-            // Calculate ratios
-            mt = (mapthing_t *)data;
-            for (i = 0; i < numthings; i++, mt++)
-            {
-                if (mt->options & 16)
-                    continue; // Multiplayer item
-
-                switch (mt->type)
-                {
-                    // Tiny
-                    case 81: // Crystal Vial
-                    case 10: // Wand Crystal
-                    case 18: // Ethereal Arrows
-                        ratios[0]++;
-                        total++;
-                        break;
-
-                    // Small
-                    case 54: // Claw Orb
-                    case 22: // Flame Orb
-                    case 20: // Lesser Runes
-                    case 13: // Mace Spheres
-                        ratios[1]++;
-                        total++;
-                        break;
-
-                    // Big
-                    case 12: // Crystal Geode
-                    case 55: // Energy Orb
-                    case 21: // Greater Runes
-                    case 23: // Inferno Orb
-                    case 16: // Pile of Mace Spheres
-                    case 19: // Quiver of Ethereal Arrows
-                    case 82: // Quartz Flask
-                        ratios[2]++;
-                        total++;
-                        break;
-                }
-            }
-
-            // Randomly pick items based on ratio
-            mt = (mapthing_t *)data;
-            for (i = 0; i < numthings; i++, mt++)
-            {
-                switch (mt->type)
-                {
-                    case 54: // Claw Orb
-                    case 12: // Crystal Geode
-                    case 55: // Energy Orb
-                    case 18: // Ethereal Arrows
-                    case 22: // Flame Orb
-                    case 21: // Greater Runes
-                    case 23: // Inferno Orb
-                    case 20: // Lesser Runes
-                    case 13: // Mace Spheres
-                    case 16: // Pile of Mace Spheres
-                    case 19: // Quiver of Ethereal Arrows
-                    case 10: // Wand Crystal
-                    case 81: // Crystal Vial
-                    case 82: // Quartz Flask
-                    {
-                        int rnd = rand() % total;
-                        if (rnd < ratios[0])
-                        {
-                            switch (rand()%3)
-                            {
-                                case 0: things_type_remap[i] = 81; break; // Crystal Vial
-                                case 1: things_type_remap[i] = 10; break; // Wand Crystal
-                                case 2: things_type_remap[i] = 18; break; // Ethereal Arrows
-                            }
-                        }
-                        else if (rnd < ratios[0] + ratios[1])
-                        {
-                            switch (rand()%4)
-                            {
-                                case 0: things_type_remap[i] = 54; break; // Claw Orb
-                                case 1: things_type_remap[i] = 22; break; // Flame Orb
-                                case 2: things_type_remap[i] = 20; break; // Lesser Runes
-                                case 3: things_type_remap[i] = 13; break; // Mace Spheres
-                            }
-                        }
-                        else
-                        {
-                            switch (rand()%7)
-                            {
-                                case 0: things_type_remap[i] = 12; break; // Crystal Geode
-                                case 1: things_type_remap[i] = 55; break; // Energy Orb
-                                case 2: things_type_remap[i] = 21; break; // Greater Runes
-                                case 3: things_type_remap[i] = 23; break; // Inferno Orb
-                                case 4: things_type_remap[i] = 16; break; // Pile of Mace Spheres
-                                case 5: things_type_remap[i] = 19; break; // Quiver of Ethereal Arrows
-                                case 6: things_type_remap[i] = 82; break; // Quartz Flask
-                            }
-                        }
-                        break;
-                    }
-                }
-            }
-        }
-    }
-
+    // [AP] Randomized monsters and items
+    remap = ap_get_thing_remap(ap_make_level_index(gameepisode, gamemap),
+                               (const ap_mapthing_t *)data, numthings,
+                               gameskill, get_fit_dimensions);
 
     mt = (mapthing_t *) data;
     for (i = 0; i < numthings; i++, mt++)
@@ -975,7 +498,7 @@ void P_LoadThings(int lump)
         spawnthing.x = SHORT(mt->x);
         spawnthing.y = SHORT(mt->y);
         spawnthing.angle = SHORT(mt->angle);
-        spawnthing.type = SHORT(things_type_remap[i]);
+        spawnthing.type = SHORT(remap[i]);
         spawnthing.options = SHORT(mt->options);
 
         // [AP] Rarely, but sometimes we need to move the spawning at the bottom of a clift.
@@ -1003,17 +526,7 @@ void P_LoadThings(int lump)
                     spawnthing.type = 20001;
                 else
                     spawnthing.type = 20000;
-                int skip = 0;
-                ap_level_state_t* level_state = ap_get_level_state(ap_make_level_index(gameepisode, gamemap));
-                for (j = 0; j < level_state->check_count; ++j)
-                {
-                    if (level_state->checks[j] == i)
-                    {
-                        skip = 1;
-                        break;
-                    }
-                }
-                if (skip)
+                if (ap_is_location_checked(ap_make_level_index(gameepisode, gamemap), i))
                     continue;
             }
         }
@@ -1057,30 +570,20 @@ void P_LoadThings(int lump)
 
 void P_LoadLineDefs(int lump)
 {
-    byte *data;
+    lumpview_t view;
     int i;
-    maplinedef_t *mld;
+    const maplinedef_t *mld;
     line_t *ld;
     vertex_t *v1, *v2;
 
-    numlines = W_LumpLength(lump) / sizeof(maplinedef_t);
+    W_OpenLumpView(lump, WAD_ADVICE_SEQUENTIAL, &view); // [AP]
+    numlines = view.length / sizeof(maplinedef_t);
     lines = Z_Malloc(numlines * sizeof(line_t), PU_LEVEL, 0);
     memset(lines, 0, numlines * sizeof(line_t));
-    data = W_CacheLumpNum(lump, PU_STATIC);
 
-    mld = (maplinedef_t *) data;
+    mld = (const maplinedef_t *) view.data;
     ld = lines;
 
-
-    // [AP] Add special line changes
-    if (gameepisode == 1 && gamemap == 7)
-    {
-        mld[779].special = 62;
-        mld[779].tag = 3333;
-        mld[779].flags &= ~0x0010; // LINE_FLAGS_LOWER_UNPEGGED;
-    }
-
-
     for (i = 0; i < numlines; i++, mld++, ld++)
     {
         ld->flags = (unsigned short)SHORT(mld->flags); // [crispy] extended nodes
@@ -1134,7 +637,15 @@ void P_LoadLineDefs(int lump)
             ld->backsector = 0;
     }
 
-    W_ReleaseLumpNum(lump);
+    W_CloseLumpView(&view);
+
+    // [AP] Add special line changes
+    if (gameepisode == 1 && gamemap == 7 && numlines > 779)
+    {
+        lines[779].special = 62;
+        lines[779].tag = 3333;
+        lines[779].flags &= ~ML_DONTPEGBOTTOM;
+    }
 }
 
 
@@ -1197,15 +708,17 @@ void P_LoadBlockMap(int lump)
 {
     int i, count;
     int lumplen;
-    short *wadblockmaplump;
+    lumpview_t view;
+    const short *wadblockmaplump;
 
-    lumplen = W_LumpLength(lump);
+    // [AP] Swap straight out of the WAD rather than a copy of it.
+    W_OpenLumpView(lump, WAD_ADVICE_SEQUENTIAL, &view);
+    wadblockmaplump = (const short *) view.data;
+    lumplen = view.length;
 
     count = lumplen / 2; // [crispy] remove BLOCKMAP limit
 
     // [crispy] remove BLOCKMAP limit
-    wadblockmaplump = Z_Malloc(lumplen, PU_LEVEL, NULL);
-    W_ReadLump(lump, wadblockmaplump);
     blockmaplump = Z_Malloc(sizeof(*blockmaplump) * count, PU_LEVEL, NULL);
     blockmap = blockmaplump + 4;
 
@@ -1223,7 +736,7 @@ void P_LoadBlockMap(int lump)
         blockmaplump[i] = (t == -1) ? -1l : (int32_t) t & 0xffff;
     }
 
-    Z_Free(wadblockmaplump);
+    W_CloseLumpView(&view);
 
     bmaporgx = blockmaplump[0] << FRACBITS;
     bmaporgy = blockmaplump[1] << FRACBITS;
@@ -199,6 +199,7 @@ typedef struct
     int lightlevel;
     int special;
     int minx, maxx;
+    int next;                             // [AP] R_FindPlane hash chain
     unsigned int pad1;                    // [crispy] hires / 32-bit integer math
     unsigned int top[MAXWIDTH];        // [crispy] hires / 32-bit integer math
     unsigned int pad2;                    // [crispy] hires / 32-bit integer math
@@ -19,6 +19,7 @@
 #include <math.h>
 #include "doomdef.h"
 #include "m_bbox.h"
+#include "m_profile.h" // [AP] -benchmark
 #include "r_local.h"
 #include "tables.h"
 #include "v_video.h" // [crispy] V_DrawFilledBox for HOM detector
@@ -947,10 +948,16 @@ void R_RenderPlayerView(player_t * player)
 
     NetUpdate();                // check for new console commands
     R_InterpolateTextureOffsets(); // [crispy] smooth texture scrolling
+    M_ProfileStart(PROF_BSP); // [AP] -benchmark
     R_RenderBSPNode(numnodes - 1);      // the head node is the last node output
+    M_ProfileStop(PROF_BSP);
     NetUpdate();                // check for new console commands
+    M_ProfileStart(PROF_PLANES);
     R_DrawPlanes();
+    M_ProfileStop(PROF_PLANES);
     NetUpdate();                // check for new console commands
+    M_ProfileStart(PROF_MASKED);
     R_DrawMasked();
+    M_ProfileStop(PROF_MASKED);
     NetUpdate();                // check for new console commands
 }
@@ -41,6 +41,11 @@ visplane_t *visplanes = NULL, *lastvisplane;
 visplane_t *floorplane, *ceilingplane;
 static int numvisplanes;
 
+// [AP] Planes made by R_FindPlane are chained by height, flat, light and
+// special, so finding one does not scan every plane in the frame.
+#define VISPLANEHASHSIZE 512
+static int visplanehash[VISPLANEHASHSIZE];
+
 int openings[MAXOPENINGS], *lastopening; // [crispy] 32-bit integer math
 
 //
@@ -208,6 +213,7 @@ void R_ClearPlanes(void)
 
     lastvisplane = visplanes;
     lastopening = openings;
+    memset(visplanehash, 0xff, sizeof(visplanehash)); // [AP] all -1
 
 //
 // texture calculation
@@ -246,6 +252,34 @@ static void R_RaiseVisplanes (visplane_t** vp)
     }
 }
 
+// [AP]
+static inline unsigned int R_VisplaneHash(fixed_t height, int picnum,
+                                          int lightlevel, int special)
+{
+    return ((unsigned int) (height >> FRACBITS) * 7
+            + (unsigned int) picnum * 3
+            + (unsigned int) lightlevel
+            + (unsigned int) special * 5) & (VISPLANEHASHSIZE - 1);
+}
+
+/*
+===============
+=
+= R_ClearPlaneTop
+=
+= [AP] Marks columns x1 to x2 of a plane as empty. Only the columns
+= between minx and maxx are ever read, so they are cleared as the plane
+= grows rather than all at once when it is made.
+=
+===============
+*/
+
+static void R_ClearPlaneTop(visplane_t *pl, int x1, int x2)
+{
+    if (x1 <= x2)
+        memset(pl->top + x1, 0xff, (x2 - x1 + 1) * sizeof(*pl->top));
+}
+
 /*
 ===============
 =
@@ -258,6 +292,8 @@ visplane_t *R_FindPlane(fixed_t height, int picnum,
                         int lightlevel, int special)
 {
     visplane_t *check;
+    unsigned int hash;
+    int i;
 
     if (picnum == skyflatnum)
     {
@@ -266,19 +302,23 @@ visplane_t *R_FindPlane(fixed_t height, int picnum,
         lightlevel = 0;
     }
 
-    for (check = visplanes; check < lastvisplane; check++)
+    // [AP] Planes split off by R_CheckPlane are not chained, the first
+    // plane made with the same keys is always found.
+    hash = R_VisplaneHash(height, picnum, lightlevel, special);
+
+    for (i = visplanehash[hash]; i != -1; i = check->next)
     {
+        check = &visplanes[i];
+
         if (height == check->height
             && picnum == check->picnum
             && lightlevel == check->lightlevel && special == check->special)
-            break;
-    }
-
-    if (check < lastvisplane)
-    {
-        return (check);
+        {
+            return (check);
+        }
     }
 
+    check = lastvisplane;
     R_RaiseVisplanes(&check);
 
     lastvisplane++;
@@ -288,7 +328,8 @@ visplane_t *R_FindPlane(fixed_t height, int picnum,
     check->special = special;
     check->minx = SCREENWIDTH;
     check->maxx = -1;
-    memset(check->top, 0xff, sizeof(check->top));
+    check->next = visplanehash[hash];
+    visplanehash[hash] = check - visplanes;
     return (check);
 }
 
@@ -334,6 +375,17 @@ visplane_t *R_CheckPlane(visplane_t * pl, int start, int stop)
 
     if (x > intrh)
     {
+        // [AP] Columns the plane grows over must read as empty
+        if (pl->minx > pl->maxx)
+        {
+            R_ClearPlaneTop(pl, unionl, unionh);
+        }
+        else
+        {
+            R_ClearPlaneTop(pl, unionl, pl->minx - 1);
+            R_ClearPlaneTop(pl, pl->maxx + 1, unionh);
+        }
+
         pl->minx = unionl;
         pl->maxx = unionh;
         return pl;              // use the same one
@@ -349,7 +401,7 @@ visplane_t *R_CheckPlane(visplane_t * pl, int start, int stop)
     pl = lastvisplane++;
     pl->minx = start;
     pl->maxx = stop;
-    memset(pl->top, 0xff, sizeof(pl->top));
+    R_ClearPlaneTop(pl, start, stop); // [AP]
 
     return pl;
 }
@@ -38,6 +38,7 @@
 #include "m_argv.h"
 #include "m_config.h"
 #include "m_controls.h"
+#include "m_profile.h" // [AP] -benchmark
 #include "net_client.h"
 #include "p_local.h"
 #include "v_video.h"
@@ -575,6 +576,8 @@ void D_DoomMain(void)
                    WarpMap, P_GetMapName(startmap), startmap, startskill + 1);
     }
 
+    M_ProfileInit(); // [AP] -benchmark, before any demo starts
+
     CheckRecordFrom();
 
     //!
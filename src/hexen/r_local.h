@@ -243,6 +243,7 @@ typedef struct
     int lightlevel;
     int special;
     int minx, maxx;
+    int next;                           // [AP] R_FindPlane hash chain
 	// leave pads for [minx-1]/[maxx+1]
     unsigned int pad1;                  // [crispy] 32-bit integer math
     unsigned int top[MAXWIDTH];			// [crispy] 32-bit integer math
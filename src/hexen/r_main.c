@@ -19,6 +19,7 @@
 #include "m_random.h"
 #include "h2def.h"
 #include "m_bbox.h"
+#include "m_profile.h" // [AP] -benchmark
 #include "r_local.h"
 
 int viewangleoffset;
@@ -922,6 +923,8 @@ void R_RenderPlayerView(player_t * player)
     PO_InterpolatePolyObjects(); // [crispy] Interpolate polyobjects here
     R_InterpolateTextureOffsets(); // [crispy] Smooth texture scrolling
 
+    M_ProfileStart(PROF_BSP); // [AP] -benchmark
+
     // Make displayed player invisible locally
     if (localQuakeHappening[displayplayer] && gamestate == GS_LEVEL)
     {
@@ -934,9 +937,14 @@ void R_RenderPlayerView(player_t * player)
         R_RenderBSPNode(numnodes - 1);  // head node is the last node output
     }
 
+    M_ProfileStop(PROF_BSP);
     NetUpdate();                // check for new console commands
+    M_ProfileStart(PROF_PLANES);
     R_DrawPlanes();
+    M_ProfileStop(PROF_PLANES);
     NetUpdate();                // check for new console commands
+    M_ProfileStart(PROF_MASKED);
     R_DrawMasked();
+    M_ProfileStop(PROF_MASKED);
     NetUpdate();                // check for new console commands
 }
@@ -52,6 +52,11 @@ visplane_t visplanes[MAXVISPLANES], *lastvisplane;
 visplane_t *floorplane, *ceilingplane;
 int openings[MAXOPENINGS], *lastopening; // [crispy] 32-bit integer math
 
+// [AP] Planes made by R_FindPlane are chained by height, flat, light and
+// special, so finding one does not scan every plane in the frame.
+#define VISPLANEHASHSIZE 512
+static int visplanehash[VISPLANEHASHSIZE];
+
 // Clip values are the solid pixel bounding the range.
 // floorclip start out SCREENHEIGHT
 // ceilingclip starts out -1
@@ -221,6 +226,7 @@ void R_ClearPlanes(void)
 
     lastvisplane = visplanes;
     lastopening = openings;
+    memset(visplanehash, 0xff, sizeof(visplanehash)); // [AP] all -1
 
     // Texture calculation
     memset(cachedheight, 0, sizeof(cachedheight));
@@ -230,6 +236,41 @@ void R_ClearPlanes(void)
     baseyscale = -FixedDiv(finesine[angle], centerxfrac);
 }
 
+//==========================================================================
+//
+// R_VisplaneHash
+//
+// [AP]
+//
+//==========================================================================
+
+static inline unsigned int R_VisplaneHash(fixed_t height, int picnum,
+                                          int lightlevel, int special)
+{
+    return ((unsigned int) (height >> FRACBITS) * 7
+            + (unsigned int) picnum * 3
+            + (unsigned int) lightlevel
+            + (unsigned int) special * 5) & (VISPLANEHASHSIZE - 1);
+}
+
+//==========================================================================
+//
+// R_ClearPlaneTop
+//
+// [AP] Marks columns x1 to x2 of a plane as empty. Only the columns
+// between minx and maxx are ever read, so they are cleared as the plane
+// grows rather than all at once when it is made.
+//
+//==========================================================================
+
+static void R_ClearPlaneTop(visplane_t *pl, int x1, int x2)
+{
+    if (x1 <= x2)
+    {
+        memset(pl->top + x1, 0xff, (x2 - x1 + 1) * sizeof(*pl->top));
+    }
+}
+
 //==========================================================================
 //
 // R_FindPlane
@@ -240,6 +281,8 @@ visplane_t *R_FindPlane(fixed_t height, int picnum,
                         int lightlevel, int special)
 {
     visplane_t *check;
+    unsigned int hash;
+    int i;
 
     if (special < 150)
     {                           // Don't let low specials affect search
@@ -252,17 +295,20 @@ visplane_t *R_FindPlane(fixed_t height, int picnum,
         lightlevel = 0;
     }
 
-    for (check = visplanes; check < lastvisplane; check++)
+    // [AP] Planes split off by R_CheckPlane are not chained, the first
+    // plane made with the same keys is always found.
+    hash = R_VisplaneHash(height, picnum, lightlevel, special);
+
+    for (i = visplanehash[hash]; i != -1; i = check->next)
     {
+        check = &visplanes[i];
+
         if (height == check->height
             && picnum == check->picnum
             && lightlevel == check->lightlevel && special == check->special)
-            break;
-    }
-
-    if (check < lastvisplane)
-    {
-        return (check);
+        {
+            return (check);
+        }
     }
 
     if (lastvisplane - visplanes == MAXVISPLANES)
@@ -270,14 +316,15 @@ visplane_t *R_FindPlane(fixed_t height, int picnum,
         I_Error("R_FindPlane: no more visplanes");
     }
 
-    lastvisplane++;
+    check = lastvisplane++;
     check->height = height;
     check->picnum = picnum;
     check->lightlevel = lightlevel;
     check->special = special;
     check->minx = SCREENWIDTH;
     check->maxx = -1;
-    memset(check->top, 0xff, sizeof(check->top));
+    check->next = visplanehash[hash];
+    visplanehash[hash] = check - visplanes;
     return (check);
 }
 
@@ -324,6 +371,17 @@ visplane_t *R_CheckPlane(visplane_t * pl, int start, int stop)
 
     if (x > intrh)
     {
+        // [AP] Columns the plane grows over must read as empty
+        if (pl->minx > pl->maxx)
+        {
+            R_ClearPlaneTop(pl, unionl, unionh);
+        }
+        else
+        {
+            R_ClearPlaneTop(pl, unionl, pl->minx - 1);
+            R_ClearPlaneTop(pl, pl->maxx + 1, unionh);
+        }
+
         pl->minx = unionl;
         pl->maxx = unionh;
         return pl;              // use the same visplane
@@ -337,7 +395,7 @@ visplane_t *R_CheckPlane(visplane_t * pl, int start, int stop)
     pl = lastvisplane++;
     pl->minx = start;
     pl->maxx = stop;
-    memset(pl->top, 0xff, sizeof(pl->top));
+    R_ClearPlaneTop(pl, start, stop); // [AP]
 
     return pl;
 }
@@ -15,11 +15,13 @@
 //
 
 
+#include <stddef.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include "h2def.h"
 #include "i_system.h"
 #include "i_swap.h"
+#include "m_sort.h"
 #include "r_bmaps.h"
 #include "r_local.h"
 
@@ -936,48 +938,27 @@ vissprite_t vsprsortedhead;
 void R_SortVisSprites(void)
 {
     int i, count;
-    vissprite_t *ds, *best;
-    vissprite_t unsorted;
-    fixed_t bestscale;
+    const int *order;
+    vissprite_t *ds;
 
     count = vissprite_p - vissprites;
 
-    unsorted.next = unsorted.prev = &unsorted;
     if (!count)
         return;
 
-    for (ds = vissprites; ds < vissprite_p; ds++)
-    {
-        ds->next = ds + 1;
-        ds->prev = ds - 1;
-    }
-    vissprites[0].prev = &unsorted;
-    unsorted.next = &vissprites[0];
-    (vissprite_p - 1)->next = &unsorted;
-    unsorted.prev = vissprite_p - 1;
+    // [AP] Sort on scale and link the vissprites up in that order;
+    // sprites at the same scale stay in the order they were added.
+    order = M_SortByIntKey(vissprites, count, sizeof(*vissprites),
+                           offsetof(vissprite_t, scale));
 
-//
-// pull the vissprites out by scale
-//
-    best = 0;                   // shut up the compiler warning
     vsprsortedhead.next = vsprsortedhead.prev = &vsprsortedhead;
     for (i = 0; i < count; i++)
     {
-        bestscale = INT_MAX;
-        for (ds = unsorted.next; ds != &unsorted; ds = ds->next)
-        {
-            if (ds->scale < bestscale)
-            {
-                bestscale = ds->scale;
-                best = ds;
-            }
-        }
-        best->next->prev = best->prev;
-        best->prev->next = best->next;
-        best->next = &vsprsortedhead;
-        best->prev = vsprsortedhead.prev;
-        vsprsortedhead.prev->next = best;
-        vsprsortedhead.prev = best;
+        ds = &vissprites[order[i]];
+        ds->next = &vsprsortedhead;
+        ds->prev = vsprsortedhead.prev;
+        vsprsortedhead.prev->next = ds;
+        vsprsortedhead.prev = ds;
     }
 }
 
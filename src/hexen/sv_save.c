@@ -20,6 +20,7 @@
 #include "h2def.h"
 #include "i_system.h"
 #include "m_misc.h"
+#include "m_savebuf.h"
 #include "i_swap.h"
 #include "p_local.h"
 
@@ -152,7 +153,8 @@ static mobj_t **MobjList;
 static mobj_t ***TargetPlayerAddrs;
 static int TargetPlayerCount;
 static boolean SavingPlayers;
-static FILE *SavingFP;
+static savebuf_t SavingBuf;
+static char *SavingFileName;
 
 // CODE --------------------------------------------------------------------
 
@@ -2109,7 +2111,7 @@ void SV_LoadGame(int slot)
     SV_OpenRead(fileName);
 
     // Set the save pointer and skip the description field
-    fseek(SavingFP, HXS_DESCRIPTION_LENGTH, SEEK_CUR);
+    M_SaveBufSeek(&SavingBuf, HXS_DESCRIPTION_LENGTH, SEEK_CUR);
 
     // Check the version text
 
@@ -3428,10 +3430,8 @@ static boolean ExistingFile(char *name)
 
 static void SV_OpenRead(char *fileName)
 {
-    SavingFP = M_fopen(fileName, "rb");
-
     // Should never happen, only if hex6.hxs cannot ever be created.
-    if (SavingFP == NULL)
+    if (!M_SaveBufReadFile(&SavingBuf, fileName))
     {
         I_Error("Could not load savegame %s", fileName);
     }
@@ -3439,7 +3439,9 @@ static void SV_OpenRead(char *fileName)
 
 static void SV_OpenWrite(char *fileName)
 {
-    SavingFP = M_fopen(fileName, "wb");
+    // Serialized in memory, written out by SV_Close
+    M_SaveBufCreate(&SavingBuf);
+    SavingFileName = M_StringDuplicate(fileName);
 }
 
 //==========================================================================
@@ -3450,10 +3452,14 @@ static void SV_OpenWrite(char *fileName)
 
 static void SV_Close(void)
 {
-    if (SavingFP)
+    if (SavingFileName != NULL)
     {
-        fclose(SavingFP);
+        M_SaveBufWriteFile(&SavingBuf, SavingFileName);
+        free(SavingFileName);
+        SavingFileName = NULL;
     }
+
+    M_SaveBufFree(&SavingBuf);
 }
 
 //==========================================================================
@@ -3464,7 +3470,7 @@ static void SV_Close(void)
 
 static void SV_Read(void *buffer, int size)
 {
-    int retval = fread(buffer, 1, size, SavingFP);
+    int retval = M_SaveBufRead(&SavingBuf, buffer, size);
     if (retval != size)
     {
         I_Error("Incomplete read in SV_Read: Expected %d, got %d bytes",
@@ -3475,7 +3481,10 @@ static void SV_Read(void *buffer, int size)
 static byte SV_ReadByte(void)
 {
     byte result;
-    SV_Read(&result, sizeof(byte));
+    if (!M_SaveBufRead8(&SavingBuf, &result))
+    {
+        I_Error("Incomplete read in SV_Read: Expected 1, got 0 bytes");
+    }
     return result;
 }
 
@@ -3506,24 +3515,24 @@ static void *SV_ReadPtr(void)
 
 static void SV_Write(const void *buffer, int size)
 {
-    fwrite(buffer, size, 1, SavingFP);
+    M_SaveBufWrite(&SavingBuf, buffer, size);
 }
 
 static void SV_WriteByte(byte val)
 {
-    fwrite(&val, sizeof(byte), 1, SavingFP);
+    M_SaveBufWrite8(&SavingBuf, val);
 }
 
 static void SV_WriteWord(unsigned short val)
 {
     val = SHORT(val);
-    fwrite(&val, sizeof(unsigned short), 1, SavingFP);
+    M_SaveBufWrite(&SavingBuf, &val, sizeof(unsigned short));
 }
 
 static void SV_WriteLong(unsigned int val)
 {
     val = LONG(val);
-    fwrite(&val, sizeof(int), 1, SavingFP);
+    M_SaveBufWrite(&SavingBuf, &val, sizeof(int));
 }
 
 static void SV_WritePtr(void *val)
@@ -0,0 +1,655 @@
+//
+// Copyright(C) 2026 APDoom contributors
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// DESCRIPTION:
+//      Disk cache of OPL music rendered to PCM.
+//
+//      OPL music is deterministic, so there is no need to emulate the
+//      chip every time a song comes around again. The first time a
+//      song plays through to its loop point, the emulator output is
+//      recorded; a writer thread then saves it as a WAV file. From
+//      then on the song is played by SDL_mixer from that file while
+//      the emulator is bypassed.
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#include "SDL.h"
+#include "SDL_mixer.h"
+
+#include "config.h"
+#include "doomtype.h"
+
+#include "i_glob.h"
+#include "i_oplcache.h"
+#include "i_swap.h"
+#include "i_system.h"
+#include "m_config.h"
+#include "m_misc.h"
+#include "opl.h"
+
+
+int opl_render_cache = 0;
+int opl_render_cache_mb = 512;
+
+#ifndef DISABLE_SDL2MIXER
+
+// Change this when recordings of the same song would come out
+// differently, so that the old ones are not played.
+#define RENDER_VERSION "1"
+
+// Recordings are kept in blocks of this many samples until written.
+#define BLOCK_SAMPLES 65536
+
+typedef struct block_s
+{
+    struct block_s *next;
+    unsigned int length;
+    int16_t samples[BLOCK_SAMPLES * 2];
+} block_t;
+
+typedef struct
+{
+    char *path;
+    block_t *first, *last;
+    size_t length;
+} recording_t;
+
+typedef enum
+{
+    CAPTURE_IDLE,
+    CAPTURE_ARMED,      // The song has not started yet.
+    CAPTURE_RECORDING,
+} capture_state_t;
+
+static char *cache_dir = NULL;
+static int cache_freq;
+
+// The recording is made on the mixing thread.
+static SDL_mutex *capture_lock;
+static capture_state_t capture_state = CAPTURE_IDLE;
+static recording_t *recording = NULL;
+
+static SDL_Thread *writer_thread;
+static SDL_sem *writer_wake;
+static SDL_atomic_t writer_busy;
+static recording_t *writer_job;
+static boolean writer_quit;
+
+// Recording being played, and the music volume it was made at.
+static Mix_Music *cached_music = NULL;
+static int cached_volume;
+
+typedef struct
+{
+    char *path;
+    off_t size;
+    time_t mtime;
+} cache_file_t;
+
+static char *CachePath(const char *key)
+{
+    return M_StringJoin(cache_dir, "v" RENDER_VERSION "-", key, ".wav", NULL);
+}
+
+static void FreeRecording(recording_t *rec)
+{
+    block_t *block, *next;
+
+    for (block = rec->first; block != NULL; block = next)
+    {
+        next = block->next;
+        free(block);
+    }
+
+    free(rec->path);
+    free(rec);
+}
+
+static void DropRecording(void)
+{
+    if (recording != NULL)
+    {
+        FreeRecording(recording);
+        recording = NULL;
+    }
+
+    capture_state = CAPTURE_IDLE;
+}
+
+static void AppendSamples(const int16_t *samples, unsigned int nsamples)
+{
+    block_t *block;
+    unsigned int n;
+
+    // A song that would not fit in the cache is not worth keeping.
+    if ((recording->length + nsamples) * 4
+      > ((size_t) opl_render_cache_mb << 20))
+    {
+        DropRecording();
+        return;
+    }
+
+    while (nsamples > 0)
+    {
+        block = recording->last;
+
+        if (block == NULL || block->length == BLOCK_SAMPLES)
+        {
+            block = malloc(sizeof(*block));
+            if (block == NULL)
+            {
+                DropRecording();
+                return;
+            }
+
+            block->next = NULL;
+            block->length = 0;
+
+            if (recording->last != NULL)
+            {
+                recording->last->next = block;
+            }
+            else
+            {
+                recording->first = block;
+            }
+            recording->last = block;
+        }
+
+        n = BLOCK_SAMPLES - block->length;
+        if (n > nsamples)
+        {
+            n = nsamples;
+        }
+
+        memcpy(&block->samples[block->length * 2], samples, n * 4);
+        block->length += n;
+        recording->length += n;
+        samples += n * 2;
+        nsamples -= n;
+    }
+}
+
+static void CaptureOutput(const int16_t *samples, unsigned int nsamples)
+{
+    SDL_LockMutex(capture_lock);
+    if (capture_state == CAPTURE_RECORDING)
+    {
+        AppendSamples(samples, nsamples);
+    }
+    SDL_UnlockMutex(capture_lock);
+}
+
+static void PutLong(byte *p, unsigned int value)
+{
+    p[0] = value & 0xff;
+    p[1] = (value >> 8) & 0xff;
+    p[2] = (value >> 16) & 0xff;
+    p[3] = (value >> 24) & 0xff;
+}
+
+static void PutShort(byte *p, unsigned int value)
+{
+    p[0] = value & 0xff;
+    p[1] = (value >> 8) & 0xff;
+}
+
+static boolean WriteRecording(recording_t *rec)
+{
+    byte header[44];
+    unsigned int data_len = rec->length * 4;
+    block_t *block;
+    unsigned int i;
+    char *temp;
+    FILE *fstream;
+    boolean ok;
+
+    memcpy(header, "RIFF", 4);
+    PutLong(header + 4, 36 + data_len);
+    memcpy(header + 8, "WAVEfmt ", 8);
+    PutLong(header + 16, 16);
+    PutShort(header + 20, 1);               // PCM
+    PutShort(header + 22, 2);               // Stereo
+    PutLong(header + 24, cache_freq);
+    PutLong(header + 28, cache_freq * 4);
+    PutShort(header + 32, 4);
+    PutShort(header + 34, 16);
+    memcpy(header + 36, "data", 4);
+    PutLong(header + 40, data_len);
+
+    temp = M_StringJoin(rec->path, ".tmp", NULL);
+    fstream = M_fopen(temp, "wb");
+
+    if (fstream == NULL)
+    {
+        free(temp);
+        return false;
+    }
+
+    ok = fwrite(header, 1, sizeof(header), fstream) == sizeof(header);
+
+    for (block = rec->first; ok && block != NULL; block = block->next)
+    {
+        // WAV files are little endian.
+        for (i = 0; i < block->length * 2; ++i)
+        {
+            block->samples[i] = SHORT(block->samples[i]);
+        }
+
+        ok = fwrite(block->samples, 4, block->length, fstream)
+          == block->length;
+    }
+
+    ok = (fclose(fstream) == 0) && ok;
+
+    if (ok)
+    {
+        M_remove(rec->path);
+        ok = M_rename(temp, rec->path) == 0;
+    }
+    else
+    {
+        M_remove(temp);
+    }
+
+    free(temp);
+
+    return ok;
+}
+
+static int CompareAge(const void *a, const void *b)
+{
+    const cache_file_t *fa = a, *fb = b;
+
+    if (fa->mtime != fb->mtime)
+    {
+        return fa->mtime < fb->mtime ? -1 : 1;
+    }
+
+    return 0;
+}
+
+// Delete the oldest recordings until the cache is within its limit.
+
+static void TrimCache(void)
+{
+    cache_file_t *files = NULL;
+    int num_files = 0, max_files = 0;
+    uint64_t total = 0;
+    uint64_t limit = (uint64_t) opl_render_cache_mb << 20;
+    const char *path;
+    struct stat st;
+    glob_t *glob;
+    int i;
+
+    glob = I_StartGlob(cache_dir, "*.wav", 0);
+    for (;;)
+    {
+        path = I_NextGlob(glob);
+        if (path == NULL)
+        {
+            break;
+        }
+        if (M_stat(path, &st) != 0)
+        {
+            continue;
+        }
+
+        if (num_files == max_files)
+        {
+            max_files = max_files ? max_files * 2 : 64;
+            files = I_Realloc(files, max_files * sizeof(*files));
+        }
+
+        files[num_files].path = M_StringDuplicate(path);
+        files[num_files].size = st.st_size;
+        files[num_files].mtime = st.st_mtime;
+        total += st.st_size;
+        ++num_files;
+    }
+    I_EndGlob(glob);
+
+    qsort(files, num_files, sizeof(*files), CompareAge);
+
+    for (i = 0; i < num_files; ++i)
+    {
+        if (total > limit)
+        {
+            M_remove(files[i].path);
+            total -= files[i].size;
+        }
+        free(files[i].path);
+    }
+
+    free(files);
+}
+
+static int WriterMain(void *unused)
+{
+    recording_t *rec;
+
+    while (true)
+    {
+        SDL_SemWait(writer_wake);
+
+        rec = writer_job;
+        writer_job = NULL;
+
+        if (rec != NULL)
+        {
+            if (WriteRecording(rec))
+            {
+                TrimCache();
+            }
+            else
+            {
+                fprintf(stderr, "I_OPLCache: Failed to write '%s'\n",
+                        rec->path);
+            }
+
+            FreeRecording(rec);
+            SDL_AtomicSet(&writer_busy, 0);
+        }
+
+        if (writer_quit)
+        {
+            break;
+        }
+    }
+
+    return 0;
+}
+
+boolean I_OPLCache_Init(void)
+{
+    if (!opl_render_cache || opl_render_cache_mb <= 0)
+    {
+        return false;
+    }
+
+    if (!Mix_QuerySpec(&cache_freq, NULL, NULL))
+    {
+        return false;
+    }
+
+    writer_quit = false;
+    writer_job = NULL;
+    SDL_AtomicSet(&writer_busy, 0);
+    writer_wake = SDL_CreateSemaphore(0);
+    writer_thread = SDL_CreateThread(WriterMain, "OPL cache writer", NULL);
+
+    if (writer_thread == NULL)
+    {
+        fprintf(stderr, "I_OPLCache_Init: Failed to start writer "
+                        "thread: %s\n", SDL_GetError());
+        SDL_DestroySemaphore(writer_wake);
+        return false;
+    }
+
+    cache_dir = M_StringJoin(configdir, "oplcache", DIR_SEPARATOR_S, NULL);
+    M_MakeDirectory(cache_dir);
+
+    capture_lock = SDL_CreateMutex();
+
+    OPL_SetCapture(CaptureOutput);
+
+    return true;
+}
+
+void I_OPLCache_Shutdown(void)
+{
+    if (cache_dir == NULL)
+    {
+        return;
+    }
+
+    I_OPLCache_Stop();
+    OPL_SetCapture(NULL);
+    I_OPLCache_Abort();
+
+    // Let the writer finish the song it is on.
+    writer_quit = true;
+    SDL_SemPost(writer_wake);
+    SDL_WaitThread(writer_thread, NULL);
+    writer_thread = NULL;
+    SDL_DestroySemaphore(writer_wake);
+    SDL_DestroyMutex(capture_lock);
+
+    free(cache_dir);
+    cache_dir = NULL;
+}
+
+void I_OPLCache_Arm(const char *key)
+{
+    recording_t *rec;
+
+    if (cache_dir == NULL)
+    {
+        return;
+    }
+
+    rec = calloc(1, sizeof(*rec));
+    rec->path = CachePath(key);
+
+    SDL_LockMutex(capture_lock);
+    DropRecording();
+    recording = rec;
+    capture_state = CAPTURE_ARMED;
+    SDL_UnlockMutex(capture_lock);
+}
+
+void I_OPLCache_SongStart(void)
+{
+    if (cache_dir == NULL)
+    {
+        return;
+    }
+
+    SDL_LockMutex(capture_lock);
+    if (capture_state == CAPTURE_ARMED)
+    {
+        capture_state = CAPTURE_RECORDING;
+    }
+    SDL_UnlockMutex(capture_lock);
+}
+
+void I_OPLCache_SongLoop(void)
+{
+    if (cache_dir == NULL)
+    {
+        return;
+    }
+
+    SDL_LockMutex(capture_lock);
+
+    if (capture_state == CAPTURE_RECORDING)
+    {
+        // If the writer is still on the last song, record this one the
+        // next time it plays rather than hold up the mixing thread.
+        if (recording->length > 0 && SDL_AtomicCAS(&writer_busy, 0, 1))
+        {
+            writer_job = recording;
+            recording = NULL;
+            capture_state = CAPTURE_IDLE;
+            SDL_SemPost(writer_wake);
+        }
+        else
+        {
+            DropRecording();
+        }
+    }
+
+    SDL_UnlockMutex(capture_lock);
+}
+
+void I_OPLCache_Abort(void)
+{
+    if (cache_dir == NULL)
+    {
+        return;
+    }
+
+    SDL_LockMutex(capture_lock);
+    DropRecording();
+    SDL_UnlockMutex(capture_lock);
+}
+
+boolean I_OPLCache_Play(const char *key, int volume, boolean looping)
+{
+    Mix_Music *music = NULL;
+    char *path;
+
+    if (cache_dir == NULL)
+    {
+        return false;
+    }
+
+    path = CachePath(key);
+    if (M_FileExists(path))
+    {
+        music = Mix_LoadMUS(path);
+    }
+    free(path);
+
+    if (music == NULL)
+    {
+        return false;
+    }
+
+    Mix_VolumeMusic(MIX_MAX_VOLUME);
+
+    if (Mix_PlayMusic(music, looping ? -1 : 1) == -1)
+    {
+        fprintf(stderr, "I_OPLCache_Play: Error starting track: %s\n",
+                Mix_GetError());
+        Mix_FreeMusic(music);
+        return false;
+    }
+
+    cached_music = music;
+    cached_volume = volume;
+    OPL_SetBypass(1);
+
+    return true;
+}
+
+void I_OPLCache_Stop(void)
+{
+    if (cached_music == NULL)
+    {
+        return;
+    }
+
+    Mix_HaltMusic();
+    Mix_FreeMusic(cached_music);
+    cached_music = NULL;
+    OPL_SetBypass(0);
+}
+
+void I_OPLCache_Pause(boolean paused)
+{
+    if (cached_music == NULL)
+    {
+        return;
+    }
+
+    if (paused)
+    {
+        Mix_PauseMusic();
+    }
+    else
+    {
+        Mix_ResumeMusic();
+    }
+}
+
+// The volume is part of the recording, as the OPL music code sets it
+// in the chip registers. Scale to follow changes until the next song.
+
+void I_OPLCache_SetVolume(int volume)
+{
+    int mix_volume;
+
+    if (cached_music == NULL || cached_volume <= 0)
+    {
+        return;
+    }
+
+    mix_volume = (volume * MIX_MAX_VOLUME) / cached_volume;
+    if (mix_volume > MIX_MAX_VOLUME)
+    {
+        mix_volume = MIX_MAX_VOLUME;
+    }
+
+    Mix_VolumeMusic(mix_volume);
+}
+
+boolean I_OPLCache_IsPlaying(void)
+{
+    return cached_music != NULL && Mix_PlayingMusic();
+}
+
+#else // DISABLE_SDL2MIXER
+
+boolean I_OPLCache_Init(void)
+{
+    return false;
+}
+
+void I_OPLCache_Shutdown(void)
+{
+}
+
+void I_OPLCache_Arm(const char *key)
+{
+}
+
+void I_OPLCache_SongStart(void)
+{
+}
+
+void I_OPLCache_SongLoop(void)
+{
+}
+
+void I_OPLCache_Abort(void)
+{
+}
+
+boolean I_OPLCache_Play(const char *key, int volume, boolean looping)
+{
+    return false;
+}
+
+void I_OPLCache_Stop(void)
+{
+}
+
+void I_OPLCache_Pause(boolean paused)
+{
+}
+
+void I_OPLCache_SetVolume(int volume)
+{
+}
+
+boolean I_OPLCache_IsPlaying(void)
+{
+    return false;
+}
+
+#endif // DISABLE_SDL2MIXER
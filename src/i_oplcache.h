@@ -0,0 +1,54 @@
+//
+// Copyright(C) 2026 APDoom contributors
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// DESCRIPTION:
+//      Disk cache of OPL music rendered to PCM.
+//
+
+#ifndef __I_OPLCACHE__
+#define __I_OPLCACHE__
+
+#include "doomtype.h"
+
+// If non-zero, OPL songs are recorded the first time they play through
+// and played back from the recording after that.
+extern int opl_render_cache;
+
+// Limit on the size of the cache directory, in megabytes.
+extern int opl_render_cache_mb;
+
+// Start recording emulator output. Returns false if there is no cache.
+boolean I_OPLCache_Init(void);
+void I_OPLCache_Shutdown(void);
+
+// Prepare to record the song that is about to start. The key names
+// the song and every setting that changes how it sounds.
+void I_OPLCache_Arm(const char *key);
+
+// Called from the OPL callbacks when the armed song starts playing and
+// when it loops, which completes the recording.
+void I_OPLCache_SongStart(void);
+void I_OPLCache_SongLoop(void);
+
+// Throw away the recording in progress.
+void I_OPLCache_Abort(void);
+
+// Play the recording of a song, if there is one. volume is the music
+// volume it should play at, which was part of its key.
+boolean I_OPLCache_Play(const char *key, int volume, boolean looping);
+void I_OPLCache_Stop(void);
+void I_OPLCache_Pause(boolean paused);
+void I_OPLCache_SetVolume(int volume);
+boolean I_OPLCache_IsPlaying(void);
+
+#endif
@@ -25,9 +25,11 @@
 #include "mus2mid.h"
 
 #include "deh_main.h"
+#include "i_oplcache.h" // [AP]
 #include "i_sound.h"
 #include "i_swap.h"
 #include "m_misc.h"
+#include "sha1.h" // [AP]
 #include "w_wad.h"
 #include "z_zone.h"
 
@@ -46,6 +48,13 @@
 
 #define PERCUSSION_LOG_LEN 16
 
+// [AP] Registered song, with the lump hash that keys its recording.
+typedef struct
+{
+    midi_file_t *file;
+    sha1_digest_t hash;
+} opl_song_t;
+
 typedef PACKED_STRUCT (
 {
     byte tremolo;
@@ -336,6 +345,9 @@ static unsigned int num_tracks = 0;
 static unsigned int running_tracks = 0;
 static boolean song_looping;
 
+// [AP] The current song plays from the render cache.
+static boolean playing_cached;
+
 // Tempo control variables
 
 static unsigned int ticks_per_beat;
@@ -358,13 +370,24 @@ int opl_io_port = 0x388;
 
 static boolean opl_stereo_correct = false;
 
+// [AP] Hash of the GENMIDI lump, as recordings depend on the instruments.
+
+static sha1_digest_t genmidi_hash;
+
 // Load instrument table from GENMIDI lump:
 
 static boolean LoadInstrumentTable(void)
 {
+    sha1_context_t context;
     byte *lump;
+    int lumpnum;
+
+    lumpnum = W_GetNumForName(DEH_String("genmidi"));
+    lump = W_CacheLumpNum(lumpnum, PU_STATIC);
 
-    lump = W_CacheLumpName(DEH_String("genmidi"), PU_STATIC);
+    SHA1_Init(&context);
+    SHA1_Update(&context, lump, W_LumpLength(lumpnum));
+    SHA1_Final(genmidi_hash, &context);
 
     // DMX does not check header
 
@@ -647,6 +670,14 @@ static void I_OPL_SetMusicVolume(int volume)
 
     current_music_volume = volume;
 
+    // [AP] The volume is in the recording.
+    if (playing_cached)
+    {
+        I_OPLCache_SetVolume(volume);
+        return;
+    }
+    I_OPLCache_Abort();
+
     // Update the volume of all voices.
 
     for (i = 0; i < MIDI_CHANNELS_PER_TRACK; ++i)
@@ -1364,6 +1395,8 @@ static void RestartSong(void *unused)
 {
     unsigned int i;
 
+    I_OPLCache_SongLoop(); // [AP]
+
     running_tracks = num_tracks;
 
     start_music_volume = current_music_volume;
@@ -1471,11 +1504,47 @@ static void StartTrack(midi_file_t *file, unsigned int track_num)
     ScheduleTrack(track);
 }
 
+// [AP] Write len bytes of a hash as hex, hex holds len * 2 + 1 chars.
+
+static void HashToHex(const byte *hash, unsigned int len, char *hex)
+{
+    unsigned int i;
+
+    for (i = 0; i < len; ++i)
+    {
+        M_snprintf(hex + i * 2, 3, "%02x", hash[i]);
+    }
+}
+
+// [AP] Name the recording of a song after its lump, the instruments
+// and every setting that changes how it sounds. The first half of the
+// instrument hash is plenty to tell banks apart.
+
+static void GetRenderKey(opl_song_t *song, char *key, size_t key_len)
+{
+    char song_hex[sizeof(sha1_digest_t) * 2 + 1];
+    char genmidi_hex[sizeof(sha1_digest_t) + 1];
+
+    HashToHex(song->hash, sizeof(sha1_digest_t), song_hex);
+    HashToHex(genmidi_hash, sizeof(sha1_digest_t) / 2, genmidi_hex);
+
+    M_snprintf(key, key_len, "%s-%s-%d%d%d-%d-%d", song_hex, genmidi_hex,
+               opl_drv_ver, opl_opl3mode, opl_stereo_correct,
+               snd_samplerate, current_music_volume);
+}
+
+static void StartRecording(void *unused)
+{
+    I_OPLCache_SongStart();
+}
+
 // Start playing a mid
 
 static void I_OPL_PlaySong(void *handle, boolean looping)
 {
+    opl_song_t *song;
     midi_file_t *file;
+    char key[96];
     unsigned int i;
 
     if (!music_initialized || handle == NULL)
@@ -1483,7 +1552,27 @@ static void I_OPL_PlaySong(void *handle, boolean looping)
         return;
     }
 
-    file = handle;
+    song = handle;
+    file = song->file;
+
+    // [AP] Play the recording of this song if there is one, or make one
+    // as it plays through to its loop point.
+    if (opl_render_cache)
+    {
+        GetRenderKey(song, key, sizeof(key));
+
+        if (I_OPLCache_Play(key, current_music_volume, looping))
+        {
+            playing_cached = true;
+            return;
+        }
+
+        if (looping && current_music_volume > 0)
+        {
+            I_OPLCache_Arm(key);
+            OPL_SetCallback(0, StartRecording, NULL);
+        }
+    }
 
     // Allocate track data.
 
@@ -1528,6 +1617,14 @@ static void I_OPL_PauseSong(void)
         return;
     }
 
+    // [AP] Keying off the voices would end up in the recording.
+    if (playing_cached)
+    {
+        I_OPLCache_Pause(true);
+        return;
+    }
+    I_OPLCache_Abort();
+
     // Pause OPL callbacks.
 
     OPL_SetPaused(1);
@@ -1552,6 +1649,12 @@ static void I_OPL_ResumeSong(void)
         return;
     }
 
+    if (playing_cached) // [AP]
+    {
+        I_OPLCache_Pause(false);
+        return;
+    }
+
     OPL_SetPaused(0);
 }
 
@@ -1564,6 +1667,15 @@ static void I_OPL_StopSong(void)
         return;
     }
 
+    // [AP]
+    if (playing_cached)
+    {
+        I_OPLCache_Stop();
+        playing_cached = false;
+        return;
+    }
+    I_OPLCache_Abort();
+
     OPL_Lock();
 
     // Stop all playback.
@@ -1594,14 +1706,17 @@ static void I_OPL_StopSong(void)
 
 static void I_OPL_UnRegisterSong(void *handle)
 {
+    opl_song_t *song = handle;
+
     if (!music_initialized)
     {
         return;
     }
 
-    if (handle != NULL)
+    if (song != NULL)
     {
-        MIDI_FreeFile(handle);
+        MIDI_FreeFile(song->file);
+        free(song);
     }
 }
 
@@ -1634,6 +1749,8 @@ static boolean ConvertMus(byte *musdata, int len, char *filename)
 static void *I_OPL_RegisterSong(void *data, int len)
 {
     midi_file_t *result;
+    opl_song_t *song = NULL;
+    sha1_context_t context;
     char *filename;
 
     if (!music_initialized)
@@ -1664,13 +1781,21 @@ static void *I_OPL_RegisterSong(void *data, int len)
     {
         fprintf(stderr, "I_OPL_RegisterSong: Failed to load MID.\n");
     }
+    else
+    {
+        song = malloc(sizeof(*song));
+        song->file = result;
+        SHA1_Init(&context);
+        SHA1_Update(&context, data, len);
+        SHA1_Final(song->hash, &context);
+    }
 
     // remove file now
 
     M_remove(filename);
     free(filename);
 
-    return result;
+    return song;
 }
 
 // Is the song playing?
@@ -1682,6 +1807,11 @@ static boolean I_OPL_MusicIsPlaying(void)
         return false;
     }
 
+    if (playing_cached) // [AP]
+    {
+        return I_OPLCache_IsPlaying();
+    }
+
     return num_tracks > 0;
 }
 
@@ -1695,6 +1825,8 @@ static void I_OPL_ShutdownMusic(void)
 
         I_OPL_StopSong();
 
+        I_OPLCache_Shutdown(); // [AP]
+
         OPL_Shutdown();
 
         // Release GENMIDI lump
@@ -1762,6 +1894,8 @@ static boolean I_OPL_InitMusic(void)
     num_tracks = 0;
     music_initialized = true;
 
+    I_OPLCache_Init(); // [AP]
+
     return true;
 }
 
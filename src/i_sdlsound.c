@@ -36,6 +36,7 @@
 #include "i_swap.h"
 #include "m_argv.h"
 #include "m_misc.h"
+#include "m_profile.h" // [AP] sound cache counters
 #include "w_wad.h"
 #include "z_zone.h"
 
@@ -72,6 +73,7 @@ struct allocated_sound_s
     int use_count;
     int pitch;
     allocated_sound_t *prev, *next;
+    allocated_sound_t *hash_next; // [AP]
 };
 
 static boolean sound_initialized = false;
@@ -96,6 +98,40 @@ static allocated_sound_t *allocated_sounds_head = NULL;
 static allocated_sound_t *allocated_sounds_tail = NULL;
 static int allocated_sounds_size = 0;
 
+// [AP] Allocated sounds are also hashed by sfxinfo and pitch, so finding
+// a pitch variant doesn't walk the whole list.
+
+#define SOUND_HASH_SIZE 512
+
+static allocated_sound_t *allocated_sounds_hash[SOUND_HASH_SIZE];
+
+static allocated_sound_t **SoundHashBucket(sfxinfo_t *sfxinfo, int pitch)
+{
+    uintptr_t key = (uintptr_t) sfxinfo / sizeof(sfxinfo_t);
+
+    return &allocated_sounds_hash[(key * 37 + pitch) & (SOUND_HASH_SIZE - 1)];
+}
+
+static void AllocatedSoundHash(allocated_sound_t *snd)
+{
+    allocated_sound_t **bucket = SoundHashBucket(snd->sfxinfo, snd->pitch);
+
+    snd->hash_next = *bucket;
+    *bucket = snd;
+}
+
+static void AllocatedSoundUnhash(allocated_sound_t *snd)
+{
+    allocated_sound_t **p = SoundHashBucket(snd->sfxinfo, snd->pitch);
+
+    while (*p != snd)
+    {
+        p = &(*p)->hash_next;
+    }
+
+    *p = snd->hash_next;
+}
+
 
 // Hook a sound into the linked list at the head.
 
@@ -144,6 +180,7 @@ static void FreeAllocatedSound(allocated_sound_t *snd)
     // Unlink from linked list.
 
     AllocatedSoundUnlink(snd);
+    AllocatedSoundUnhash(snd);
 
     // Keep track of the amount of allocated sound data:
 
@@ -205,7 +242,8 @@ static void ReserveCacheSpace(size_t len)
 
 // Allocate a block for a new sound effect.
 
-static allocated_sound_t *AllocateSound(sfxinfo_t *sfxinfo, size_t len)
+static allocated_sound_t *AllocateSound(sfxinfo_t *sfxinfo, int pitch,
+                                        size_t len)
 {
     allocated_sound_t *snd;
 
@@ -236,7 +274,7 @@ static allocated_sound_t *AllocateSound(sfxinfo_t *sfxinfo, size_t len)
     snd->chunk.alen = len;
     snd->chunk.allocated = 1;
     snd->chunk.volume = MIX_MAX_VOLUME;
-    snd->pitch = NORM_PITCH;
+    snd->pitch = pitch;
 
     snd->sfxinfo = sfxinfo;
     snd->use_count = 0;
@@ -246,6 +284,7 @@ static allocated_sound_t *AllocateSound(sfxinfo_t *sfxinfo, size_t len)
     allocated_sounds_size += len;
 
     AllocatedSoundLink(snd);
+    AllocatedSoundHash(snd);
 
     return snd;
 }
@@ -281,12 +320,12 @@ static void UnlockAllocatedSound(allocated_sound_t *snd)
     //printf("-- %s: Use count=%i\n", snd->sfxinfo->name, snd->use_count);
 }
 
-// Search through the list of allocated sounds and return the one that matches
-// the supplied sfxinfo entry and pitch level.
+// Return the allocated sound that matches the supplied sfxinfo entry and
+// pitch level.
 
 static allocated_sound_t * GetAllocatedSoundBySfxInfoAndPitch(sfxinfo_t *sfxinfo, int pitch)
 {
-    allocated_sound_t * p = allocated_sounds_head;
+    allocated_sound_t * p = *SoundHashBucket(sfxinfo, pitch);
 
     while (p != NULL)
     {
@@ -294,7 +333,7 @@ static allocated_sound_t * GetAllocatedSoundBySfxInfoAndPitch(sfxinfo_t *sfxinfo
         {
             return p;
         }
-        p = p->next;
+        p = p->hash_next;
     }
 
     return NULL;
@@ -306,9 +345,10 @@ static allocated_sound_t * GetAllocatedSoundBySfxInfoAndPitch(sfxinfo_t *sfxinfo
 static allocated_sound_t * PitchShift(allocated_sound_t *insnd, int pitch)
 {
     allocated_sound_t * outsnd;
-    Sint16 *inp, *outp;
+    Sint16 *outp;
     Sint16 *srcbuf, *dstbuf;
     Uint32 srclen, dstlen;
+    uint64_t pos, step;
 
     srcbuf = (Sint16 *)insnd->chunk.abuf;
     srclen = insnd->chunk.alen;
@@ -323,21 +363,25 @@ static allocated_sound_t * PitchShift(allocated_sound_t *insnd, int pitch)
         dstlen++;
     }
 
-    outsnd = AllocateSound(insnd->sfxinfo, dstlen);
+    outsnd = AllocateSound(insnd->sfxinfo, pitch, dstlen);
 
     if (!outsnd)
     {
         return NULL;
     }
 
-    outsnd->pitch = pitch;
     dstbuf = (Sint16 *)outsnd->chunk.abuf;
 
-    // loop over output buffer. find corresponding input cell, copy over
+    // loop over output buffer. find corresponding input cell, copy over.
+    // [AP] Step through the input in 32.32 fixed point, srclen / dstlen
+    // rounded up so that exact cells aren't missed by one.
+    step = (((uint64_t) srclen << 32) + dstlen - 1) / dstlen;
+    pos = 0;
+
     for (outp = dstbuf; outp < dstbuf + dstlen/2; ++outp)
     {
-        inp = srcbuf + (int)((float)(outp - dstbuf) / dstlen * srclen);
-        *outp = *inp;
+        *outp = srcbuf[pos >> 32];
+        pos += step;
     }
 
     return outsnd;
@@ -463,7 +507,7 @@ static boolean ExpandSoundData_SRC(sfxinfo_t *sfxinfo,
 
 //    alen = src_data.output_frames_gen * 4;
 
-    snd = AllocateSound(sfxinfo, src_data.output_frames_gen * 4);
+    snd = AllocateSound(sfxinfo, NORM_PITCH, src_data.output_frames_gen * 4);
 
     if (snd == NULL)
     {
@@ -639,7 +683,7 @@ static boolean ExpandSoundData_SDL(sfxinfo_t *sfxinfo,
 
     // Allocate a chunk in which to expand the sound
 
-    snd = AllocateSound(sfxinfo, expanded_length);
+    snd = AllocateSound(sfxinfo, NORM_PITCH, expanded_length);
 
     if (snd == NULL)
     {
@@ -1014,6 +1058,7 @@ static int I_SDL_StartSound(sfxinfo_t *sfxinfo, int channel, int vol, int sep, i
 
         if (snd_pitchshift)
         {
+            M_ProfileCount(PROF_SFX_PITCH_MISS);
             newsnd = PitchShift(snd, pitch);
 
             if (newsnd)
@@ -1026,6 +1071,7 @@ static int I_SDL_StartSound(sfxinfo_t *sfxinfo, int channel, int vol, int sep, i
     }
     else
     {
+        M_ProfileCount(PROF_SFX_PITCH_HIT);
         LockAllocatedSound(snd);
     }
 
@@ -24,6 +24,7 @@
 #include "doomtype.h"
 
 #include "gusconf.h"
+#include "i_oplcache.h" // [AP]
 #include "i_sound.h"
 #include "i_video.h"
 #include "m_argv.h"
@@ -547,6 +548,8 @@ void I_BindSoundVariables(void)
     M_BindIntVariable("snd_samplerate",          &snd_samplerate);
     M_BindIntVariable("snd_cachesize",           &snd_cachesize);
     M_BindIntVariable("opl_io_port",             &opl_io_port);
+    M_BindIntVariable("opl_render_cache",        &opl_render_cache); // [AP]
+    M_BindIntVariable("opl_render_cache_mb",     &opl_render_cache_mb); // [AP]
     M_BindIntVariable("snd_pitchshift",          &snd_pitchshift);
 
     M_BindStringVariable("music_pack_path",      &music_pack_path);
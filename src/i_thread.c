@@ -0,0 +1,161 @@
+//
+// Copyright(C) 2026 APDoom contributors
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// DESCRIPTION:
+//      Worker thread pool, for splitting a job across cores.
+//
+
+#include <stdio.h>
+
+#include "SDL.h"
+
+#include "doomtype.h"
+#include "i_system.h"
+#include "i_thread.h"
+
+typedef struct
+{
+    SDL_Thread *thread;
+    SDL_sem *start;
+    int index;
+} worker_t;
+
+static worker_t workers[MAX_THREAD_WORKERS];
+static int num_workers = 1;
+static SDL_sem *workers_done;
+
+static thread_job_t current_job;
+static void *current_data;
+static boolean quitting;
+
+static int WorkerMain(void *data)
+{
+    worker_t *worker = data;
+
+    while (true)
+    {
+        SDL_SemWait(worker->start);
+
+        if (quitting)
+        {
+            break;
+        }
+
+        current_job(worker->index, num_workers, current_data);
+        SDL_SemPost(workers_done);
+    }
+
+    return 0;
+}
+
+static void I_ShutdownThreads(void)
+{
+    int i;
+
+    quitting = true;
+
+    for (i = 1; i < num_workers; ++i)
+    {
+        SDL_SemPost(workers[i].start);
+        SDL_WaitThread(workers[i].thread, NULL);
+        SDL_DestroySemaphore(workers[i].start);
+    }
+
+    SDL_DestroySemaphore(workers_done);
+    workers_done = NULL;
+    num_workers = 1;
+}
+
+void I_InitThreads(int count)
+{
+    int i;
+
+    if (num_workers > 1 || count <= 1)
+    {
+        return;
+    }
+
+    if (count > MAX_THREAD_WORKERS)
+    {
+        count = MAX_THREAD_WORKERS;
+    }
+
+    quitting = false;
+    workers_done = SDL_CreateSemaphore(0);
+
+    for (i = 1; i < count && workers_done != NULL; ++i)
+    {
+        workers[i].index = i;
+        workers[i].start = SDL_CreateSemaphore(0);
+        workers[i].thread = NULL;
+
+        if (workers[i].start != NULL)
+        {
+            workers[i].thread = SDL_CreateThread(WorkerMain, "worker", &workers[i]);
+        }
+
+        if (workers[i].thread == NULL)
+        {
+            if (workers[i].start != NULL)
+            {
+                SDL_DestroySemaphore(workers[i].start);
+            }
+            fprintf(stderr, "I_InitThreads: Failed to start thread: %s\n",
+                    SDL_GetError());
+            break;
+        }
+
+        num_workers = i + 1;
+    }
+
+    // Not a single worker, so free what was made and stay on one thread
+    if (num_workers == 1)
+    {
+        if (workers_done == NULL)
+        {
+            fprintf(stderr, "I_InitThreads: Failed to create semaphore: %s\n",
+                    SDL_GetError());
+        }
+
+        I_ShutdownThreads();
+        return;
+    }
+
+    I_AtExit(I_ShutdownThreads, true);
+}
+
+int I_NumThreadWorkers(void)
+{
+    return num_workers;
+}
+
+void I_RunOnThreads(thread_job_t job, void *data)
+{
+    int i;
+
+    current_job = job;
+    current_data = data;
+
+    for (i = 1; i < num_workers; ++i)
+    {
+        SDL_SemPost(workers[i].start);
+    }
+
+    // The calling thread takes the first share of the work
+    job(0, num_workers, data);
+
+    for (i = 1; i < num_workers; ++i)
+    {
+        SDL_SemWait(workers_done);
+    }
+}
@@ -0,0 +1,36 @@
+//
+// Copyright(C) 2026 APDoom contributors
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// DESCRIPTION:
+//      Worker thread pool, for splitting a job across cores.
+//
+
+
+#ifndef __I_THREAD__
+#define __I_THREAD__
+
+#define MAX_THREAD_WORKERS 16
+
+// Called on every worker with its number, 0 being the calling thread.
+typedef void (*thread_job_t)(int worker, int num_workers, void *data);
+
+// Start the pool. The count includes the calling thread, so 1 starts
+// no thread at all.
+void I_InitThreads(int num_workers);
+
+int I_NumThreadWorkers(void);
+
+// Run a job on every worker, returns once they are all done.
+void I_RunOnThreads(thread_job_t job, void *data);
+
+#endif
@@ -44,8 +44,10 @@
 #include "m_argv.h"
 #include "m_config.h"
 #include "m_misc.h"
+#include "m_profile.h" // [AP] -benchmark
 #include "tables.h"
 #include "v_diskicon.h"
+#include "v_trans.h" // [AP] packed blends
 #include "v_video.h"
 #include "w_wad.h"
 #include "z_zone.h"
@@ -98,7 +100,17 @@ static SDL_Texture *yelpane = NULL;
 static SDL_Texture *grnpane = NULL;
 static int pane_alpha;
 static unsigned int rmask, gmask, bmask, amask; // [crispy] moved up here
-static const uint8_t blend_alpha = 0xa8;
+static const uint8_t blend_alpha = I_BLEND_ALPHA;
+boolean blend_packed; // [AP]
+uint32_t blend_amask;
+
+// [AP] Decide whether the packed blends in v_trans.h fit the masks
+static void I_SetBlendMasks (void)
+{
+    blend_packed = (rmask | bmask) == 0x00ff00ff && gmask == 0x0000ff00;
+    blend_amask = amask;
+    V_SetBlendPacked(blend_packed);
+}
 extern pixel_t* colormaps; // [crispy] evil hack to get FPS dots working as in Vanilla
 #else
 static SDL_Color palette[256];
@@ -746,7 +758,7 @@ fixed_t fractionaltic;
 //
 // I_FinishUpdate
 //
-void I_FinishUpdate (void)
+static void FinishUpdate (void)
 {
     static int lasttic;
     int tics;
@@ -939,6 +951,15 @@ void I_FinishUpdate (void)
     V_RestoreDiskBackground();
 }
 
+// [AP] Timed for -benchmark, it also marks the end of a frame
+void I_FinishUpdate (void)
+{
+    M_ProfileStart(PROF_FINISHUPDATE);
+    FinishUpdate();
+    M_ProfileStop(PROF_FINISHUPDATE);
+    M_ProfileEndFrame();
+}
+
 
 //
 // I_ReadScreen
@@ -1565,6 +1586,7 @@ static void SetVideoMode(void)
                                           SCREENWIDTH, SCREENHEIGHT, bpp,
                                           rmask, gmask, bmask, amask);
 #ifdef CRISPY_TRUECOLOR
+        I_SetBlendMasks(); // [AP]
         SDL_FillRect(argbbuffer, NULL, I_MapRGB(0xff, 0x0, 0x0));
         redpane = SDL_CreateTextureFromSurface(renderer, argbbuffer);
         SDL_SetTextureBlendMode(redpane, SDL_BLENDMODE_BLEND);
@@ -1822,6 +1844,9 @@ void I_ReInitGraphics (int reinit)
 		argbbuffer = SDL_CreateRGBSurface(0,
 		                                  SCREENWIDTH, SCREENHEIGHT, 32,
 		                                  rmask, gmask, bmask, amask);
+#ifdef CRISPY_TRUECOLOR
+		I_SetBlendMasks(); // [AP]
+#endif
 #ifndef CRISPY_TRUECOLOR
 		// [crispy] re-set the framebuffer pointer
 		I_VideoBuffer = screenbuffer->pixels;
@@ -2018,6 +2043,9 @@ const pixel_t I_BlendAdd (const pixel_t bg, const pixel_t fg)
 {
 	uint32_t r, g, b;
 
+	if (blend_packed) // [AP]
+		return I_BlendAddPacked(bg, fg);
+
 	if ((r = (fg & rmask) + (bg & rmask)) > rmask) r = rmask;
 	if ((g = (fg & gmask) + (bg & gmask)) > gmask) g = gmask;
 	if ((b = (fg & bmask) + (bg & bmask)) > bmask) b = bmask;
@@ -2028,20 +2056,14 @@ const pixel_t I_BlendAdd (const pixel_t bg, const pixel_t fg)
 // [crispy] http://stereopsis.com/doubleblend.html
 const pixel_t I_BlendDark (const pixel_t bg, const int d)
 {
-	const uint32_t ag = (bg & 0xff00ff00) >> 8;
-	const uint32_t rb =  bg & 0x00ff00ff;
-
-	uint32_t sag = d * ag;
-	uint32_t srb = d * rb;
-
-	sag = sag & 0xff00ff00;
-	srb = (srb >> 8) & 0x00ff00ff;
-
-	return amask | sag | srb;
+	return I_BlendDarkPacked(bg, d); // [AP] moved to v_trans.h
 }
 
 const pixel_t I_BlendOver (const pixel_t bg, const pixel_t fg)
 {
+	if (blend_packed) // [AP]
+		return I_BlendOverPacked(bg, fg);
+
 	const uint32_t r = ((blend_alpha * (fg & rmask) + (0xff - blend_alpha) * (bg & rmask)) >> 8) & rmask;
 	const uint32_t g = ((blend_alpha * (fg & gmask) + (0xff - blend_alpha) * (bg & gmask)) >> 8) & gmask;
 	const uint32_t b = ((blend_alpha * (fg & bmask) + (0xff - blend_alpha) * (bg & bmask)) >> 8) & bmask;
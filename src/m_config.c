@@ -966,6 +966,22 @@ static default_t extra_defaults_list[] =
 
     CONFIG_VARIABLE_INT_HEX(opl_io_port),
 
+    //!
+    // [AP] If non-zero, OPL music is recorded the first time each song
+    // plays through, and played back from the recording after that
+    // instead of emulating the OPL chip again.  Recordings are kept in
+    // the oplcache directory in the configuration directory.
+    //
+
+    CONFIG_VARIABLE_INT(opl_render_cache),
+
+    //!
+    // [AP] Limit on the size of the OPL music recordings, in megabytes.
+    // The oldest recordings are deleted to stay under it.
+    //
+
+    CONFIG_VARIABLE_INT(opl_render_cache_mb),
+
     //!
     // Controls whether libsamplerate support is used for performing
     // sample rate conversions of sound effects.  Support for this
@@ -1169,6 +1185,16 @@ static default_t extra_defaults_list[] =
 
     CONFIG_VARIABLE_INT(vanilla_savegame_limit),
 
+    //!
+    // @game doom heretic
+    //
+    // [AP] If non-zero, level savegames are written compressed with
+    // zlib.  Compressed and uncompressed savegames are both loaded,
+    // whatever this is set to.
+    //
+
+    CONFIG_VARIABLE_INT(compress_savegames),
+
     //!
     // @game doom strife
     //
@@ -0,0 +1,281 @@
+//
+// Copyright(C) 2026 APDoom contributors
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// DESCRIPTION:
+//      Per-frame timing of the main engine phases (-benchmark).
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "d_loop.h"
+#include "i_system.h"
+#include "i_timer.h"
+#include "m_argv.h"
+#include "m_misc.h"
+#include "m_profile.h"
+
+typedef struct
+{
+    int gametic;
+    uint32_t phase_us[NUMPROFPHASES];
+    uint32_t frame_us;
+} profframe_t;
+
+static const char *phase_names[NUMPROFPHASES] =
+{
+    "bsp",
+    "planes",
+    "masked",
+    "transpose",
+    "ticker",
+    "finishupdate",
+};
+
+static const char *counter_names[NUMPROFCOUNTERS] =
+{
+    "sfx_pitch_hit",
+    "sfx_pitch_miss",
+};
+
+boolean profiling = false;
+
+static const char *profile_filename;
+static profframe_t *frames;
+static int numframes;
+static int maxframes;
+
+static uint64_t phase_start[NUMPROFPHASES];
+static uint32_t phase_us[NUMPROFPHASES];
+static uint64_t frame_start;
+static uint64_t counters[NUMPROFCOUNTERS];
+
+void M_ProfileStart(profphase_t phase)
+{
+    if (profiling)
+    {
+        phase_start[phase] = I_GetTimeUS();
+    }
+}
+
+void M_ProfileStop(profphase_t phase)
+{
+    if (profiling)
+    {
+        phase_us[phase] += (uint32_t) (I_GetTimeUS() - phase_start[phase]);
+    }
+}
+
+void M_ProfileCount(profcounter_t counter)
+{
+    if (profiling)
+    {
+        ++counters[counter];
+    }
+}
+
+void M_ProfileEndFrame(void)
+{
+    uint64_t now;
+    profframe_t *frame;
+
+    if (!profiling)
+    {
+        return;
+    }
+
+    now = I_GetTimeUS();
+
+    if (numframes == maxframes)
+    {
+        maxframes = maxframes ? maxframes * 2 : 4096;
+        frames = I_Realloc(frames, maxframes * sizeof(*frames));
+    }
+
+    frame = &frames[numframes++];
+    frame->gametic = gametic;
+    memcpy(frame->phase_us, phase_us, sizeof(phase_us));
+    frame->frame_us = frame_start ? (uint32_t) (now - frame_start) : 0;
+
+    memset(phase_us, 0, sizeof(phase_us));
+    frame_start = now;
+}
+
+static int CompareUInt(const void *a, const void *b)
+{
+    const uint32_t x = *(const uint32_t *) a;
+    const uint32_t y = *(const uint32_t *) b;
+
+    return (x > y) - (x < y);
+}
+
+// Mean and percentiles of one column, phase NUMPROFPHASES is the whole frame
+static void GetStats(int phase, double *mean, uint32_t *p50, uint32_t *p99,
+                     uint32_t *max)
+{
+    uint32_t *values = malloc(numframes * sizeof(*values));
+    double sum = 0;
+    int i;
+
+    for (i = 0; i < numframes; ++i)
+    {
+        values[i] = phase < NUMPROFPHASES ? frames[i].phase_us[phase]
+                                          : frames[i].frame_us;
+        sum += values[i];
+    }
+
+    qsort(values, numframes, sizeof(*values), CompareUInt);
+
+    *mean = sum / numframes;
+    *p50 = values[numframes / 2];
+    *p99 = values[(numframes * 99) / 100];
+    *max = values[numframes - 1];
+
+    free(values);
+}
+
+static void WriteCSV(FILE *f)
+{
+    int i, j;
+
+    fprintf(f, "frame,gametic");
+    for (j = 0; j < NUMPROFPHASES; ++j)
+    {
+        fprintf(f, ",%s_us", phase_names[j]);
+    }
+    fprintf(f, ",frame_us\n");
+
+    for (i = 0; i < numframes; ++i)
+    {
+        fprintf(f, "%d,%d", i, frames[i].gametic);
+        for (j = 0; j < NUMPROFPHASES; ++j)
+        {
+            fprintf(f, ",%u", frames[i].phase_us[j]);
+        }
+        fprintf(f, ",%u\n", frames[i].frame_us);
+    }
+}
+
+static void WriteJSON(FILE *f)
+{
+    double mean;
+    uint32_t p50, p99, max;
+    int i, j;
+
+    fprintf(f, "{\n  \"summary\": {\n");
+    for (j = 0; j <= NUMPROFPHASES; ++j)
+    {
+        GetStats(j, &mean, &p50, &p99, &max);
+        fprintf(f, "    \"%s_us\": {\"mean\": %.1f, \"p50\": %u, \"p99\": %u, "
+                   "\"max\": %u}%s\n",
+                j < NUMPROFPHASES ? phase_names[j] : "frame",
+                mean, p50, p99, max, j < NUMPROFPHASES ? "," : "");
+    }
+    fprintf(f, "  },\n  \"counters\": {\n");
+    for (j = 0; j < NUMPROFCOUNTERS; ++j)
+    {
+        fprintf(f, "    \"%s\": %llu%s\n", counter_names[j],
+                (unsigned long long) counters[j],
+                j < NUMPROFCOUNTERS - 1 ? "," : "");
+    }
+    fprintf(f, "  },\n  \"frames\": [\n");
+
+    for (i = 0; i < numframes; ++i)
+    {
+        fprintf(f, "    {\"gametic\": %d", frames[i].gametic);
+        for (j = 0; j < NUMPROFPHASES; ++j)
+        {
+            fprintf(f, ", \"%s_us\": %u", phase_names[j], frames[i].phase_us[j]);
+        }
+        fprintf(f, ", \"frame_us\": %u}%s\n", frames[i].frame_us,
+                i < numframes - 1 ? "," : "");
+    }
+    fprintf(f, "  ]\n}\n");
+}
+
+static void M_ProfileWrite(void)
+{
+    double mean;
+    uint32_t p50, p99, max;
+    FILE *f;
+    int j;
+
+    if (!profiling || numframes == 0)
+    {
+        return;
+    }
+
+    profiling = false;
+
+    printf("Benchmark: %d frames\n", numframes);
+    for (j = 0; j <= NUMPROFPHASES; ++j)
+    {
+        GetStats(j, &mean, &p50, &p99, &max);
+        printf("  %-12s mean %8.1f us, p50 %6u us, p99 %6u us, max %6u us\n",
+               j < NUMPROFPHASES ? phase_names[j] : "frame",
+               mean, p50, p99, max);
+    }
+    for (j = 0; j < NUMPROFCOUNTERS; ++j)
+    {
+        printf("  %-12s %llu\n", counter_names[j],
+               (unsigned long long) counters[j]);
+    }
+
+    f = M_fopen(profile_filename, "w");
+    if (f == NULL)
+    {
+        fprintf(stderr, "M_ProfileWrite: Failed to open %s\n",
+                profile_filename);
+        return;
+    }
+
+    if (M_StringEndsWith(profile_filename, ".json"))
+    {
+        WriteJSON(f);
+    }
+    else
+    {
+        WriteCSV(f);
+    }
+
+    fclose(f);
+    printf("Benchmark results written to %s\n", profile_filename);
+}
+
+void M_ProfileInit(void)
+{
+    int p;
+
+    //!
+    // @arg <file>
+    // @category demo
+    //
+    // Record how long each frame spends in the BSP, planes, masked,
+    // transpose, ticker and screen update phases, and count sound cache
+    // hits. The results are written to file on exit, as JSON if its name
+    // ends in .json or CSV otherwise.
+    // Combine with -timedemo and -noblit for a headless benchmark. Doom
+    // and Heretic cannot play demos back, since pickups would be sent as
+    // checks, so there the profile covers live play.
+    //
+
+    p = M_CheckParmWithArgs("-benchmark", 1);
+
+    if (p)
+    {
+        profiling = true;
+        profile_filename = myargv[p + 1];
+        I_AtExit(M_ProfileWrite, true);
+    }
+}
@@ -0,0 +1,59 @@
+//
+// Copyright(C) 2026 APDoom contributors
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// DESCRIPTION:
+//      Per-frame timing of the main engine phases (-benchmark).
+//
+
+
+#ifndef __M_PROFILE__
+#define __M_PROFILE__
+
+#include "doomtype.h"
+
+typedef enum
+{
+    PROF_BSP,           // R_RenderBSPNode
+    PROF_PLANES,        // R_DrawPlanes
+    PROF_MASKED,        // R_DrawMasked
+    PROF_TRANSPOSE,     // R_TransposeView (doom -transpose)
+    PROF_TICKER,        // P_Ticker
+    PROF_FINISHUPDATE,  // I_FinishUpdate
+    NUMPROFPHASES
+} profphase_t;
+
+// Event counts, reported as totals.
+typedef enum
+{
+    PROF_SFX_PITCH_HIT,     // Pitch variant found in the sound cache
+    PROF_SFX_PITCH_MISS,    // Pitch variant resampled
+    NUMPROFCOUNTERS
+} profcounter_t;
+
+extern boolean profiling;
+
+// Check for -benchmark, the results are written out on exit.
+void M_ProfileInit(void);
+
+// Time spent between these is added to the current frame. They do
+// nothing unless profiling.
+void M_ProfileStart(profphase_t phase);
+void M_ProfileStop(profphase_t phase);
+
+// Count one event. Does nothing unless profiling.
+void M_ProfileCount(profcounter_t counter);
+
+// Called once per displayed frame.
+void M_ProfileEndFrame(void);
+
+#endif
@@ -0,0 +1,310 @@
+//
+// Copyright(C) 2026 APDoom contributors
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// DESCRIPTION:
+//      Memory stream that savegames are serialized to and from.
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "config.h"
+#ifdef HAVE_LIBZ
+#include <zlib.h>
+#endif
+
+#include "i_system.h"
+#include "m_misc.h"
+#include "m_savebuf.h"
+
+#define SAVEBUF_INITIAL_SIZE (64 * 1024)
+
+// A compressed savegame is this magic, the uncompressed length as 32-bit
+// little endian and a zlib stream. Savegames all start with a text
+// description, so 0x89 tells the two apart.
+#define COMPRESSED_MAGIC "\x89" "APZ"
+#define COMPRESSED_HEADER_SIZE 8
+
+static boolean Decompress(savebuf_t *buf)
+{
+#ifdef HAVE_LIBZ
+    byte *data;
+    uLongf length;
+
+    length = buf->data[4] | (buf->data[5] << 8)
+           | (buf->data[6] << 16) | ((uLongf) buf->data[7] << 24);
+    data = I_Realloc(NULL, length > 0 ? length : 1);
+
+    if (uncompress(data, &length, buf->data + COMPRESSED_HEADER_SIZE,
+                   buf->length - COMPRESSED_HEADER_SIZE) != Z_OK)
+    {
+        free(data);
+        return false;
+    }
+
+    free(buf->data);
+    buf->data = data;
+    buf->length = length;
+    buf->alloced = length > 0 ? length : 1;
+    buf->pos = 0;
+
+    return true;
+#else
+    fprintf(stderr, "Decompress: Compressed savegames need zlib support\n");
+    return false;
+#endif
+}
+
+void M_SaveBufCreate(savebuf_t *buf)
+{
+    buf->alloced = SAVEBUF_INITIAL_SIZE;
+    buf->data = I_Realloc(NULL, buf->alloced);
+    buf->length = 0;
+    buf->pos = 0;
+}
+
+void M_SaveBufOpen(savebuf_t *buf, byte *data, size_t length)
+{
+    buf->data = data;
+    buf->length = length;
+    buf->alloced = 0;
+    buf->pos = 0;
+}
+
+void M_SaveBufFree(savebuf_t *buf)
+{
+    if (buf->alloced > 0)
+    {
+        free(buf->data);
+    }
+
+    buf->data = NULL;
+    buf->length = buf->alloced = buf->pos = 0;
+}
+
+byte *M_SaveBufDetach(savebuf_t *buf, size_t *length)
+{
+    byte *data = buf->data;
+
+    *length = buf->length;
+    buf->data = NULL;
+    buf->length = buf->alloced = buf->pos = 0;
+
+    return data;
+}
+
+boolean M_SaveBufReadFile(savebuf_t *buf, const char *path)
+{
+    FILE *file;
+    long size;
+
+    file = M_fopen(path, "rb");
+
+    if (file == NULL)
+    {
+        return false;
+    }
+
+    fseek(file, 0, SEEK_END);
+    size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+
+    if (size < 0)
+    {
+        fclose(file);
+        return false;
+    }
+
+    buf->alloced = size > 0 ? size : 1;
+    buf->data = I_Realloc(NULL, buf->alloced);
+    buf->length = fread(buf->data, 1, size, file);
+    buf->pos = 0;
+
+    fclose(file);
+
+    if (buf->length != (size_t) size)
+    {
+        M_SaveBufFree(buf);
+        return false;
+    }
+
+    if (buf->length >= COMPRESSED_HEADER_SIZE
+     && !memcmp(buf->data, COMPRESSED_MAGIC, 4) && !Decompress(buf))
+    {
+        M_SaveBufFree(buf);
+        return false;
+    }
+
+    return true;
+}
+
+boolean M_SaveBufWriteFile(savebuf_t *buf, const char *path)
+{
+    FILE *file;
+    boolean ok;
+
+    file = M_fopen(path, "wb");
+
+    if (file == NULL)
+    {
+        return false;
+    }
+
+    ok = fwrite(buf->data, 1, buf->length, file) == buf->length;
+    ok = fclose(file) == 0 && ok;
+
+    return ok;
+}
+
+boolean M_SaveBufCompress(savebuf_t *in, savebuf_t *out)
+{
+#ifdef HAVE_LIBZ
+    uLongf length = compressBound(in->length);
+
+    out->alloced = COMPRESSED_HEADER_SIZE + length;
+    out->data = I_Realloc(NULL, out->alloced);
+    out->pos = 0;
+
+    memcpy(out->data, COMPRESSED_MAGIC, 4);
+    out->data[4] = in->length & 0xff;
+    out->data[5] = (in->length >> 8) & 0xff;
+    out->data[6] = (in->length >> 16) & 0xff;
+    out->data[7] = (in->length >> 24) & 0xff;
+
+    if (compress2(out->data + COMPRESSED_HEADER_SIZE, &length,
+                  in->data, in->length, Z_BEST_SPEED) != Z_OK)
+    {
+        M_SaveBufFree(out);
+        return false;
+    }
+
+    out->length = COMPRESSED_HEADER_SIZE + length;
+
+    return true;
+#else
+    return false;
+#endif
+}
+
+size_t M_SaveBufRead(savebuf_t *buf, void *ptr, size_t size)
+{
+    if (buf->pos >= buf->length)
+    {
+        return 0;
+    }
+
+    if (size > buf->length - buf->pos)
+    {
+        size = buf->length - buf->pos;
+    }
+
+    memcpy(ptr, buf->data + buf->pos, size);
+    buf->pos += size;
+
+    return size;
+}
+
+size_t M_SaveBufWrite(savebuf_t *buf, const void *ptr, size_t size)
+{
+    if (buf->pos + size > buf->alloced)
+    {
+        size_t alloced = buf->alloced;
+
+        if (alloced == 0)
+        {
+            I_Error("M_SaveBufWrite: Buffer is read-only");
+        }
+
+        while (buf->pos + size > alloced)
+        {
+            alloced *= 2;
+        }
+
+        buf->data = I_Realloc(buf->data, alloced);
+        buf->alloced = alloced;
+    }
+
+    memcpy(buf->data + buf->pos, ptr, size);
+    buf->pos += size;
+
+    if (buf->pos > buf->length)
+    {
+        buf->length = buf->pos;
+    }
+
+    return size;
+}
+
+char *M_SaveBufGets(savebuf_t *buf, char *s, int n)
+{
+    int i = 0;
+
+    if (buf->pos >= buf->length || n <= 0)
+    {
+        return NULL;
+    }
+
+    while (i < n - 1 && buf->pos < buf->length)
+    {
+        s[i] = buf->data[buf->pos++];
+
+        if (s[i++] == '\n')
+        {
+            break;
+        }
+    }
+
+    s[i] = '\0';
+
+    return s;
+}
+
+int M_SaveBufPuts(savebuf_t *buf, const char *s)
+{
+    M_SaveBufWrite(buf, s, strlen(s));
+
+    return 0;
+}
+
+long M_SaveBufTell(savebuf_t *buf)
+{
+    return (long) buf->pos;
+}
+
+int M_SaveBufSeek(savebuf_t *buf, long offset, int whence)
+{
+    long base;
+
+    switch (whence)
+    {
+        case SEEK_CUR:
+            base = (long) buf->pos;
+            break;
+        case SEEK_END:
+            base = (long) buf->length;
+            break;
+        default:
+            base = 0;
+            break;
+    }
+
+    if (base + offset < 0)
+    {
+        return -1;
+    }
+
+    buf->pos = base + offset;
+
+    return 0;
+}
@@ -0,0 +1,96 @@
+//
+// Copyright(C) 2026 APDoom contributors
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// DESCRIPTION:
+//      Memory stream that savegames are serialized to and from.
+//
+
+
+#ifndef __M_SAVEBUF__
+#define __M_SAVEBUF__
+
+#include <stddef.h>
+
+#include "doomtype.h"
+
+typedef struct
+{
+    byte *data;
+    size_t length;      // bytes of valid data
+    size_t alloced;
+    size_t pos;         // read/write cursor
+} savebuf_t;
+
+// Start an empty, growable buffer for writing.
+void M_SaveBufCreate(savebuf_t *buf);
+
+// Read from existing data. The buffer does not take ownership and
+// cannot be written to.
+void M_SaveBufOpen(savebuf_t *buf, byte *data, size_t length);
+
+// Free the data of a buffer made with M_SaveBufCreate.
+void M_SaveBufFree(savebuf_t *buf);
+
+// Hand the written data over to the caller, leaving the buffer empty.
+byte *M_SaveBufDetach(savebuf_t *buf, size_t *length);
+
+// Read a whole file into a new buffer, decompressing it if needed.
+// Returns false if it can't be read.
+boolean M_SaveBufReadFile(savebuf_t *buf, const char *path);
+
+// Write the buffer contents out to a file in one go.
+boolean M_SaveBufWriteFile(savebuf_t *buf, const char *path);
+
+// Compress into a new buffer, to be written with M_SaveBufWriteFile.
+// Returns false if the game was built without zlib.
+boolean M_SaveBufCompress(savebuf_t *in, savebuf_t *out);
+
+// stdio-like accessors, with the same return values.
+size_t M_SaveBufRead(savebuf_t *buf, void *ptr, size_t size);
+size_t M_SaveBufWrite(savebuf_t *buf, const void *ptr, size_t size);
+char *M_SaveBufGets(savebuf_t *buf, char *s, int n);
+int M_SaveBufPuts(savebuf_t *buf, const char *s);
+long M_SaveBufTell(savebuf_t *buf);
+int M_SaveBufSeek(savebuf_t *buf, long offset, int whence);
+
+// Single bytes make up most of a savegame, so these skip the call.
+
+static inline boolean M_SaveBufRead8(savebuf_t *buf, byte *value)
+{
+    if (buf->pos < buf->length)
+    {
+        *value = buf->data[buf->pos++];
+        return true;
+    }
+
+    return false;
+}
+
+static inline void M_SaveBufWrite8(savebuf_t *buf, byte value)
+{
+    if (buf->pos < buf->alloced)
+    {
+        buf->data[buf->pos++] = value;
+
+        if (buf->pos > buf->length)
+        {
+            buf->length = buf->pos;
+        }
+    }
+    else
+    {
+        M_SaveBufWrite(buf, &value, 1);
+    }
+}
+
+#endif
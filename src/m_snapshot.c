@@ -0,0 +1,356 @@
+//
+// Copyright(C) 2026 APDoom contributors
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// DESCRIPTION:
+//      In-memory cache of level savegames, written to disk in the
+//      background.
+//
+//      Every level exit saves the level and every level select entry
+//      loads one back. Recently used levels are kept in memory, so
+//      hopping between them does not touch the disk. The disk copy is
+//      written by a writer thread to a temporary file which is renamed
+//      over the savegame once complete, as G_DoSaveGame used to do.
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "SDL.h"
+
+#include "i_system.h"
+#include "m_misc.h"
+#include "m_savebuf.h"
+#include "m_snapshot.h"
+
+typedef struct snapshot_s
+{
+    char *path;
+    byte *data;
+    size_t length;
+    int refcount;       // cache slot + queued writes
+    boolean superseded; // a newer snapshot of path was stored
+    struct snapshot_s *next_write;
+} snapshot_t;
+
+// Most recently used first. Only touched by the main thread.
+static snapshot_t *cache[SNAPSHOT_CACHE_SIZE];
+static int cache_count;
+
+static SDL_Thread *writer_thread;
+static SDL_mutex *writer_lock;
+static SDL_sem *writer_wake;
+static SDL_sem *writer_flushed;
+static snapshot_t *write_head, *write_tail;
+static boolean writer_quit;
+
+// Queued in place of a snapshot to find out when the writer got there.
+static snapshot_t flush_marker;
+
+// Compress level savegames on the writer thread.
+int compress_savegames = 0;
+
+static void ReleaseSnapshot(snapshot_t *snap, boolean superseded)
+{
+    int refcount;
+
+    if (writer_lock != NULL)
+    {
+        SDL_LockMutex(writer_lock);
+    }
+
+    snap->superseded |= superseded;
+    refcount = --snap->refcount;
+
+    if (writer_lock != NULL)
+    {
+        SDL_UnlockMutex(writer_lock);
+    }
+
+    if (refcount == 0)
+    {
+        free(snap->path);
+        free(snap->data);
+        free(snap);
+    }
+}
+
+static boolean WriteSnapshot(snapshot_t *snap)
+{
+    savebuf_t buf, packed;
+    char *temp;
+    boolean ok;
+
+    M_SaveBufOpen(&buf, snap->data, snap->length);
+    temp = M_StringJoin(snap->path, ".tmp", NULL);
+
+    if (compress_savegames && M_SaveBufCompress(&buf, &packed))
+    {
+        ok = M_SaveBufWriteFile(&packed, temp);
+        M_SaveBufFree(&packed);
+    }
+    else
+    {
+        ok = M_SaveBufWriteFile(&buf, temp);
+    }
+
+    if (ok)
+    {
+        M_remove(snap->path);
+        ok = M_rename(temp, snap->path) == 0;
+    }
+    else
+    {
+        M_remove(temp);
+    }
+
+    free(temp);
+
+    return ok;
+}
+
+static int WriterMain(void *unused)
+{
+    snapshot_t *snap;
+    boolean superseded;
+
+    while (true)
+    {
+        SDL_SemWait(writer_wake);
+
+        SDL_LockMutex(writer_lock);
+        snap = write_head;
+        if (snap != NULL)
+        {
+            write_head = snap->next_write;
+            if (write_head == NULL)
+            {
+                write_tail = NULL;
+            }
+        }
+        SDL_UnlockMutex(writer_lock);
+
+        if (snap == &flush_marker)
+        {
+            SDL_SemPost(writer_flushed);
+            continue;
+        }
+
+        if (snap == NULL)
+        {
+            if (writer_quit)
+            {
+                break;
+            }
+            continue;
+        }
+
+        // Skip it if a newer snapshot of this file is queued behind us.
+        SDL_LockMutex(writer_lock);
+        superseded = snap->superseded;
+        SDL_UnlockMutex(writer_lock);
+
+        if (!superseded && !WriteSnapshot(snap))
+        {
+            // The level is still in the cache, so only a restart loses it.
+            fprintf(stderr, "M_SnapshotStore: Failed to write '%s'\n",
+                    snap->path);
+        }
+
+        ReleaseSnapshot(snap, false);
+    }
+
+    return 0;
+}
+
+static void QueueWrite(snapshot_t *snap)
+{
+    SDL_LockMutex(writer_lock);
+    snap->next_write = NULL;
+    if (write_tail != NULL)
+    {
+        write_tail->next_write = snap;
+    }
+    else
+    {
+        write_head = snap;
+    }
+    write_tail = snap;
+    SDL_UnlockMutex(writer_lock);
+
+    SDL_SemPost(writer_wake);
+}
+
+static void ShutdownWriter(void)
+{
+    M_SnapshotFlush();
+
+    writer_quit = true;
+    SDL_SemPost(writer_wake);
+    SDL_WaitThread(writer_thread, NULL);
+    writer_thread = NULL;
+
+    SDL_DestroySemaphore(writer_wake);
+    SDL_DestroySemaphore(writer_flushed);
+}
+
+static void StartWriter(void)
+{
+    writer_lock = SDL_CreateMutex();
+    writer_wake = SDL_CreateSemaphore(0);
+    writer_flushed = SDL_CreateSemaphore(0);
+    writer_thread = SDL_CreateThread(WriterMain, "snapshot writer", NULL);
+
+    if (writer_thread == NULL)
+    {
+        fprintf(stderr, "M_SnapshotStore: Failed to start writer "
+                        "thread: %s\n", SDL_GetError());
+        return;
+    }
+
+    I_AtExit(ShutdownWriter, true);
+}
+
+static int FindCached(const char *path)
+{
+    int i;
+
+    for (i = 0; i < cache_count; ++i)
+    {
+        if (!strcmp(cache[i]->path, path))
+        {
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+static void MoveToFront(int i)
+{
+    snapshot_t *snap = cache[i];
+
+    memmove(&cache[1], &cache[0], i * sizeof(*cache));
+    cache[0] = snap;
+}
+
+static void InsertCached(snapshot_t *snap)
+{
+    int i = FindCached(snap->path);
+
+    if (i >= 0)
+    {
+        ReleaseSnapshot(cache[i], true);
+        cache[i] = snap;
+        MoveToFront(i);
+        return;
+    }
+
+    if (cache_count == SNAPSHOT_CACHE_SIZE)
+    {
+        ReleaseSnapshot(cache[--cache_count], false);
+    }
+
+    cache[cache_count++] = snap;
+    MoveToFront(cache_count - 1);
+}
+
+static snapshot_t *NewSnapshot(const char *path, byte *data, size_t length)
+{
+    snapshot_t *snap = malloc(sizeof(*snap));
+
+    snap->path = M_StringDuplicate(path);
+    snap->data = data;
+    snap->length = length;
+    snap->refcount = 1;
+    snap->superseded = false;
+    snap->next_write = NULL;
+
+    return snap;
+}
+
+void M_SnapshotStore(const char *path, byte *data, size_t length)
+{
+    snapshot_t *snap = NewSnapshot(path, data, length);
+
+    if (writer_lock == NULL)
+    {
+        StartWriter();
+    }
+
+    if (writer_thread == NULL)
+    {
+        if (!WriteSnapshot(snap))
+        {
+            I_Error("Failed to write savegame '%s'.", path);
+        }
+        InsertCached(snap);
+        return;
+    }
+
+    // One reference for the cache, one for the writer.
+    snap->refcount = 2;
+    InsertCached(snap);
+    QueueWrite(snap);
+}
+
+byte *M_SnapshotLoad(const char *path, size_t *length)
+{
+    snapshot_t *snap;
+    savebuf_t file;
+    int i = FindCached(path);
+
+    if (i >= 0)
+    {
+        MoveToFront(i);
+        *length = cache[0]->length;
+        return cache[0]->data;
+    }
+
+    // It may have dropped out of the cache while still queued.
+    M_SnapshotFlush();
+
+    if (!M_SaveBufReadFile(&file, path))
+    {
+        return NULL;
+    }
+
+    snap = NewSnapshot(path, file.data, file.length);
+    InsertCached(snap);
+
+    *length = snap->length;
+    return snap->data;
+}
+
+boolean M_SnapshotExists(const char *path)
+{
+    if (FindCached(path) >= 0)
+    {
+        return true;
+    }
+
+    M_SnapshotFlush();
+
+    return M_FileExists(path);
+}
+
+void M_SnapshotFlush(void)
+{
+    if (writer_thread == NULL)
+    {
+        return;
+    }
+
+    QueueWrite(&flush_marker);
+    SDL_SemWait(writer_flushed);
+}
@@ -0,0 +1,47 @@
+//
+// Copyright(C) 2026 APDoom contributors
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// DESCRIPTION:
+//      In-memory cache of level savegames, written to disk in the
+//      background.
+//
+
+
+#ifndef __M_SNAPSHOT__
+#define __M_SNAPSHOT__
+
+#include <stddef.h>
+
+#include "doomtype.h"
+
+// Number of snapshots kept in memory, least recently used go first.
+#define SNAPSHOT_CACHE_SIZE 32
+
+// If set, snapshots are written compressed. Loading detects either.
+extern int compress_savegames;
+
+// Keep a savegame in memory and queue it to be written to path.
+// Takes ownership of data, which must come from malloc.
+void M_SnapshotStore(const char *path, byte *data, size_t length);
+
+// Get the savegame for path, from memory when it was recently used and
+// from disk otherwise. Returns NULL if there is none. The data belongs
+// to the cache and stays valid until the next store or load.
+byte *M_SnapshotLoad(const char *path, size_t *length);
+
+boolean M_SnapshotExists(const char *path);
+
+// Wait until every queued snapshot is on disk.
+void M_SnapshotFlush(void);
+
+#endif
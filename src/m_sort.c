@@ -0,0 +1,166 @@
+//
+// Copyright(C) 2026 APDoom contributors
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// DESCRIPTION:
+//      Stable sort of structures by an integer member. Short lists
+//      get an insertion sort; longer ones a radix sort, one byte of
+//      the key per pass. The buffers are kept between calls, so the
+//      renderer sorting its sprites every frame does not allocate.
+//
+
+#include <string.h>
+
+#include "doomtype.h"
+
+#include "i_system.h"
+#include "m_sort.h"
+
+// Below this many keys, an insertion sort beats the radix passes.
+#define INSERTION_CUTOFF 64
+
+typedef struct
+{
+    uint32_t key;
+    int index;
+} sortkey_t;
+
+static sortkey_t *keys, *scratch;
+static int *order;
+static int numkeys;
+
+static void GrowBuffers(int count)
+{
+    if (count <= numkeys)
+    {
+        return;
+    }
+
+    while (numkeys < count)
+    {
+        numkeys = numkeys ? numkeys * 2 : 128;
+    }
+
+    keys = I_Realloc(keys, numkeys * sizeof(*keys));
+    scratch = I_Realloc(scratch, numkeys * sizeof(*scratch));
+    order = I_Realloc(order, numkeys * sizeof(*order));
+}
+
+static void InsertionSort(sortkey_t *a, int count)
+{
+    int i, j;
+
+    for (i = 1; i < count; i++)
+    {
+        sortkey_t k = a[i];
+
+        // Strictly greater, so that equal keys keep their order.
+        for (j = i; j > 0 && a[j - 1].key > k.key; j--)
+        {
+            a[j] = a[j - 1];
+        }
+
+        a[j] = k;
+    }
+}
+
+// Returns the array holding the sorted keys, which is either keys[]
+// or scratch[] depending on how many passes were made.
+static sortkey_t *RadixSort(int count)
+{
+    int counts[4][256];
+    sortkey_t *src = keys, *dst = scratch, *tmp;
+    int pass, i;
+
+    memset(counts, 0, sizeof(counts));
+
+    for (i = 0; i < count; i++)
+    {
+        uint32_t k = keys[i].key;
+
+        counts[0][k & 0xff]++;
+        counts[1][(k >> 8) & 0xff]++;
+        counts[2][(k >> 16) & 0xff]++;
+        counts[3][k >> 24]++;
+    }
+
+    for (pass = 0; pass < 4; pass++)
+    {
+        int *c = counts[pass];
+        int shift = pass * 8;
+        int sum = 0;
+
+        // Every key has the same byte here (usually the top one, as
+        // scales are small), so this pass would not change anything.
+        if (c[(src[0].key >> shift) & 0xff] == count)
+        {
+            continue;
+        }
+
+        for (i = 0; i < 256; i++)
+        {
+            int n = c[i];
+            c[i] = sum;
+            sum += n;
+        }
+
+        for (i = 0; i < count; i++)
+        {
+            dst[c[(src[i].key >> shift) & 0xff]++] = src[i];
+        }
+
+        tmp = src;
+        src = dst;
+        dst = tmp;
+    }
+
+    return src;
+}
+
+const int *M_SortByIntKey(const void *base, int count, size_t size,
+                          size_t keyoffset)
+{
+    const byte *p = (const byte *) base + keyoffset;
+    sortkey_t *sorted;
+    int i;
+
+    GrowBuffers(count);
+
+    for (i = 0; i < count; i++, p += size)
+    {
+        int k;
+
+        memcpy(&k, p, sizeof(k));
+
+        // Flip the sign bit so that negative keys order below
+        // positive ones when compared unsigned.
+        keys[i].key = (uint32_t) k ^ 0x80000000u;
+        keys[i].index = i;
+    }
+
+    if (count < INSERTION_CUTOFF)
+    {
+        InsertionSort(keys, count);
+        sorted = keys;
+    }
+    else
+    {
+        sorted = RadixSort(count);
+    }
+
+    for (i = 0; i < count; i++)
+    {
+        order[i] = sorted[i].index;
+    }
+
+    return order;
+}
@@ -0,0 +1,32 @@
+//
+// Copyright(C) 2026 APDoom contributors
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// DESCRIPTION:
+//      Stable sort of structures by an integer member.
+//
+
+#ifndef __M_SORT__
+#define __M_SORT__
+
+#include <stddef.h>
+
+// Sort count structures of the given size, starting at base, by the
+// int found at keyoffset within each of them (use offsetof()). The
+// structures themselves are not moved: the result is the list of
+// their indices in ascending order of key, with equal keys left in
+// their original order. The returned array belongs to the sorter and
+// is reused by the next call.
+const int *M_SortByIntKey(const void *base, int count, size_t size,
+                          size_t keyoffset);
+
+#endif
@@ -1881,10 +1881,8 @@ void G_DoLoadGame (boolean userload)
 
     gameaction = ga_nothing;
 
-    save_stream = M_fopen(loadpath, "rb");
-
     // [STRIFE] If the file does not exist, G_DoLoadLevel is called.
-    if (save_stream == NULL)
+    if (!M_SaveBufReadFile(&save_stream, loadpath))
     {
         G_DoLoadLevel();
         return;
@@ -1897,7 +1895,7 @@ void G_DoLoadGame (boolean userload)
 
     if (!P_ReadSaveGameHeader())
     {
-        fclose(save_stream);
+        M_SaveBufFree(&save_stream);
         return;
     }
 
@@ -1932,7 +1930,7 @@ void G_DoLoadGame (boolean userload)
     if (!P_ReadSaveGameEOF())
         I_Error ("Bad savegame");
 
-    fclose(save_stream);
+    M_SaveBufFree(&save_stream);
     
     if (setsizeneeded)
         R_ExecuteSetViewSize ();
@@ -2035,12 +2033,7 @@ void G_DoSaveGame (char *path)
     // This prevents an existing savegame from being overwritten by 
     // a corrupted one, or if a savegame buffer overrun occurs.
 
-    save_stream = M_fopen(temp_savegame_file, "wb");
-
-    if (save_stream == NULL)
-    {
-        return;
-    }
+    M_SaveBufCreate(&save_stream);
 
     savegame_error = false;
 
@@ -2065,9 +2058,16 @@ void G_DoSaveGame (char *path)
     }
     */
     
-    // Finish up, close the savegame file.
+    // Finish up, write out the savegame file.
+
+    if (!M_SaveBufWriteFile(&save_stream, temp_savegame_file))
+    {
+        M_SaveBufFree(&save_stream);
+        Z_Free(savegame_file);
+        return;
+    }
 
-    fclose(save_stream);
+    M_SaveBufFree(&save_stream);
 
     // Now rename the temporary savegame file to the actual savegame
     // file, overwriting the old savegame if there was one there.
@@ -37,7 +37,7 @@
 // haleyjd 09/28/10: [STRIFE] VERSIONSIZE == 8
 #define VERSIONSIZE 8 
 
-FILE *save_stream;
+savebuf_t save_stream;
 int savegamelength;
 boolean savegame_error;
 static int restoretargets_fail; // [crispy]
@@ -85,7 +85,7 @@ static byte saveg_read8(void)
 {
     byte result;
 
-    if (fread(&result, 1, 1, save_stream) < 1)
+    if (!M_SaveBufRead8(&save_stream, &result))
     {
         if (!savegame_error)
         {
@@ -101,15 +101,8 @@ static byte saveg_read8(void)
 
 static void saveg_write8(byte value)
 {
-    if (fwrite(&value, 1, 1, save_stream) < 1)
-    {
-        if (!savegame_error)
-        {
-            fprintf(stderr, "saveg_write8: Error while writing save game\n");
-
-            savegame_error = true;
-        }
-    }
+    // The memory stream grows as needed and can't fail
+    M_SaveBufWrite8(&save_stream, value);
 }
 
 static short saveg_read16(void)
@@ -156,7 +149,7 @@ static void saveg_read_pad(void)
     int padding;
     int i;
 
-    pos = ftell(save_stream);
+    pos = M_SaveBufTell(&save_stream);
 
     padding = (4 - (pos & 3)) & 3;
 
@@ -172,7 +165,7 @@ static void saveg_write_pad(void)
     int padding;
     int i;
 
-    pos = ftell(save_stream);
+    pos = M_SaveBufTell(&save_stream);
 
     padding = (4 - (pos & 3)) & 3;
 
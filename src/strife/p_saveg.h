@@ -20,7 +20,7 @@
 #ifndef __P_SAVEG__
 #define __P_SAVEG__
 
-#include <stdio.h>
+#include "m_savebuf.h"
 
 // maximum size of a savegame description
 
@@ -56,7 +56,7 @@ void P_ArchiveSpecials (void);
 void P_UnArchiveSpecials (void);
 void P_RestoreTargets (void); // [crispy]
 
-extern FILE *save_stream;
+extern savebuf_t save_stream;
 extern boolean savegame_error;
 
 
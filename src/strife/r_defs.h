@@ -465,6 +465,7 @@ typedef struct
   int			lightlevel;
   int			minx;
   int			maxx;
+  int			next; // [AP] next plane in R_FindPlane's hash chain
   
   // leave pads for [minx-1]/[maxx+1]
   
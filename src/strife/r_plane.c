@@ -49,6 +49,11 @@ visplane_t*		lastvisplane;
 visplane_t*		floorplane;
 visplane_t*		ceilingplane;
 
+// [AP] Planes made by R_FindPlane are chained by height, flat and light,
+// so finding one does not scan every plane in the frame.
+#define VISPLANEHASHSIZE	512
+static int		visplanehash[VISPLANEHASHSIZE];
+
 // ?
 #define MAXOPENINGS	MAXWIDTH*64*4
 int			openings[MAXOPENINGS]; // [crispy] 32-bit integer math
@@ -198,6 +203,7 @@ void R_ClearPlanes (void)
 
     lastvisplane = visplanes;
     lastopening = openings;
+    memset (visplanehash, 0xff, sizeof(visplanehash)); // [AP] all -1
     
     // texture calculation
     memset (cachedheight, 0, sizeof(cachedheight));
@@ -213,6 +219,30 @@ void R_ClearPlanes (void)
 
 
 
+//
+// [AP] R_VisplaneHash
+//
+static inline unsigned int R_VisplaneHash (fixed_t height, int picnum, int lightlevel)
+{
+    return ((unsigned int) (height >> FRACBITS) * 7
+	  + (unsigned int) picnum * 3
+	  + (unsigned int) lightlevel) & (VISPLANEHASHSIZE - 1);
+}
+
+
+//
+// [AP] R_ClearPlaneTop
+// Marks columns x1 to x2 of a plane as empty. Only the columns between
+// minx and maxx are ever read, so they are cleared as the plane grows
+// rather than all at once when it is made.
+//
+static void R_ClearPlaneTop (visplane_t *pl, int x1, int x2)
+{
+    if (x1 <= x2)
+	memset (pl->top + x1, 0xff, (x2 - x1 + 1) * sizeof(*pl->top));
+}
+
+
 //
 // R_FindPlane
 //
@@ -223,39 +253,44 @@ R_FindPlane
   int		lightlevel )
 {
     visplane_t*	check;
+    unsigned int	hash;
+    int		i;
 	
     if (picnum == skyflatnum)
     {
 	height = 0;			// all skys map together
 	lightlevel = 0;
     }
-	
-    for (check=visplanes; check<lastvisplane; check++)
+
+    // [AP] Planes split off by R_CheckPlane are not chained, the first
+    // plane made for the same height, flat and light is always found.
+    hash = R_VisplaneHash(height, picnum, lightlevel);
+
+    for (i = visplanehash[hash]; i != -1; i = check->next)
     {
+	check = &visplanes[i];
+
 	if (height == check->height
 	    && picnum == check->picnum
 	    && lightlevel == check->lightlevel)
 	{
-	    break;
+	    return check;
 	}
     }
-    
-			
-    if (check < lastvisplane)
-	return check;
 		
     if (lastvisplane - visplanes == MAXVISPLANES)
 	I_Error ("R_FindPlane: no more visplanes");
 		
-    lastvisplane++;
+    check = lastvisplane++;
 
     check->height = height;
     check->picnum = picnum;
     check->lightlevel = lightlevel;
     check->minx = SCREENWIDTH;
     check->maxx = -1;
-    
-    memset (check->top,0xff,sizeof(check->top));
+
+    check->next = visplanehash[hash];
+    visplanehash[hash] = check - visplanes;
 		
     return check;
 }
@@ -304,6 +339,17 @@ R_CheckPlane
 
     if (x > intrh)
     {
+	// [AP] Columns the plane grows over must read as empty
+	if (pl->minx > pl->maxx)
+	{
+	    R_ClearPlaneTop(pl, unionl, unionh);
+	}
+	else
+	{
+	    R_ClearPlaneTop(pl, unionl, pl->minx - 1);
+	    R_ClearPlaneTop(pl, pl->maxx + 1, unionh);
+	}
+
 	pl->minx = unionl;
 	pl->maxx = unionh;
 
@@ -320,7 +366,7 @@ R_CheckPlane
     pl->minx = start;
     pl->maxx = stop;
 
-    memset (pl->top,0xff,sizeof(pl->top));
+    R_ClearPlaneTop(pl, start, stop); // [AP]
 		
     return pl;
 }
@@ -16,8 +16,12 @@
 // Color translation tables
 //
 
+#include <limits.h>
 #include <math.h>
+#include <stdlib.h>
+#include <string.h>
 
+#include "crispy.h" // [AP] MIN, MAX, BETWEEN
 #include "doomtype.h"
 #include "v_trans.h"
 
@@ -260,6 +264,127 @@ int V_GetPaletteIndex(byte *palette, int r, int g, int b)
     return best;
 }
 
+// [AP] Nearest color search that doesn't scan the whole palette.
+// RGB space is split into cells, each listing the only palette colors
+// that can be nearest to some color in that cell.
+
+#define LOOKUP_CELL_BITS 5
+#define LOOKUP_CELLS (256 >> LOOKUP_CELL_BITS) // Per axis
+#define LOOKUP_CELL_SIZE (1 << LOOKUP_CELL_BITS)
+
+struct palette_lookup_s
+{
+    byte palette[256 * 3];
+    int first[LOOKUP_CELLS * LOOKUP_CELLS * LOOKUP_CELLS + 1]; // Into candidates
+    byte *candidates; // In palette order, so ties resolve like V_GetPaletteIndex
+};
+
+static int AxisMinDist(int c, int lo, int hi)
+{
+    return c < lo ? lo - c : c > hi ? c - hi : 0;
+}
+
+static int AxisMaxDist(int c, int lo, int hi)
+{
+    return MAX(abs(c - lo), abs(c - hi));
+}
+
+palette_lookup_t *V_NewPaletteLookup(byte *palette)
+{
+    palette_lookup_t *lookup = malloc(sizeof(*lookup));
+    byte *candidates = malloc(LOOKUP_CELLS * LOOKUP_CELLS * LOOKUP_CELLS * 256);
+    int mindist[256];
+    int count = 0;
+    int cell = 0;
+    int cr, cg, cb, i;
+
+    memcpy(lookup->palette, palette, sizeof(lookup->palette));
+
+    for (cr = 0; cr < LOOKUP_CELLS; ++cr)
+    for (cg = 0; cg < LOOKUP_CELLS; ++cg)
+    for (cb = 0; cb < LOOKUP_CELLS; ++cb)
+    {
+        const int lo[3] = {cr * LOOKUP_CELL_SIZE, cg * LOOKUP_CELL_SIZE, cb * LOOKUP_CELL_SIZE};
+        int bound = INT_MAX;
+
+        // No color in the cell is further than this from its nearest palette color
+        for (i = 0; i < 256; ++i)
+        {
+            int d, maxdist = 0;
+            int k;
+
+            mindist[i] = 0;
+            for (k = 0; k < 3; ++k)
+            {
+                d = AxisMinDist(palette[3 * i + k], lo[k], lo[k] + LOOKUP_CELL_SIZE - 1);
+                mindist[i] += d * d;
+                d = AxisMaxDist(palette[3 * i + k], lo[k], lo[k] + LOOKUP_CELL_SIZE - 1);
+                maxdist += d * d;
+            }
+            bound = MIN(bound, maxdist);
+        }
+
+        lookup->first[cell++] = count;
+        for (i = 0; i < 256; ++i)
+        {
+            if (mindist[i] <= bound)
+            {
+                candidates[count++] = i;
+            }
+        }
+    }
+    lookup->first[cell] = count;
+
+    lookup->candidates = realloc(candidates, count);
+
+    return lookup;
+}
+
+void V_FreePaletteLookup(palette_lookup_t *lookup)
+{
+    free(lookup->candidates);
+    free(lookup);
+}
+
+int V_LookupPaletteIndex(palette_lookup_t *lookup, int r, int g, int b)
+{
+    const byte *palette = lookup->palette;
+    int best, best_diff, diff;
+    int cell, i;
+
+    r = BETWEEN(0, 255, r);
+    g = BETWEEN(0, 255, g);
+    b = BETWEEN(0, 255, b);
+
+    cell = ((r >> LOOKUP_CELL_BITS) * LOOKUP_CELLS + (g >> LOOKUP_CELL_BITS)) * LOOKUP_CELLS
+         + (b >> LOOKUP_CELL_BITS);
+
+    best = 0; best_diff = INT_MAX;
+
+    for (i = lookup->first[cell]; i < lookup->first[cell + 1]; ++i)
+    {
+        const int c = lookup->candidates[i];
+        const byte *rgb = palette + 3 * c;
+
+        diff = (r - rgb[0]) * (r - rgb[0])
+             + (g - rgb[1]) * (g - rgb[1])
+             + (b - rgb[2]) * (b - rgb[2]);
+
+        if (diff < best_diff)
+        {
+            best = c;
+            best_diff = diff;
+        }
+
+        if (diff == 0)
+        {
+            break;
+        }
+    }
+
+    return best;
+}
+
 byte V_Colorize (byte *playpal, int cr, byte source, boolean keepgray109)
 {
     vect rgb, hsv;
@@ -64,9 +64,66 @@ extern const pixel_t (*blendfunc) (const pixel_t fg, const pixel_t bg);
 extern const pixel_t I_BlendAdd (const pixel_t bg, const pixel_t fg);
 extern const pixel_t I_BlendDark (const pixel_t bg, const int d);
 extern const pixel_t I_BlendOver (const pixel_t bg, const pixel_t fg);
+
+// [AP] Opacity of I_BlendOver, out of 0xff
+#define I_BLEND_ALPHA 0xa8
+
+// [AP] Set when the screen has 8-bit channels with red and blue 16 bits
+// apart, as in (A|X)RGB8888 and (A|X)BGR8888. The packed blends below
+// give the same results as I_BlendOver and I_BlendAdd then, and can be
+// inlined into drawing loops. blend_amask holds the alpha bits.
+extern boolean blend_packed;
+extern uint32_t blend_amask;
+
+static const inline pixel_t I_BlendOverPacked (const pixel_t bg, const pixel_t fg)
+{
+    // red and blue share a multiply without carrying into each other
+    const uint32_t rb = ((I_BLEND_ALPHA * (fg & 0x00ff00ff) + (0xff - I_BLEND_ALPHA) * (bg & 0x00ff00ff)) >> 8) & 0x00ff00ff;
+    const uint32_t g = ((I_BLEND_ALPHA * (fg & 0x0000ff00) + (0xff - I_BLEND_ALPHA) * (bg & 0x0000ff00)) >> 8) & 0x0000ff00;
+
+    return blend_amask | rb | g;
+}
+
+static const inline pixel_t I_BlendAddPacked (const pixel_t bg, const pixel_t fg)
+{
+    uint32_t rb = (fg & 0x00ff00ff) + (bg & 0x00ff00ff);
+    uint32_t g = (fg & 0x0000ff00) + (bg & 0x0000ff00);
+    // a carry out of red or blue saturates that channel
+    const uint32_t carry = rb & 0x01000100;
+
+    rb = (rb | (carry - (carry >> 8))) & 0x00ff00ff;
+
+    if (g > 0x0000ff00)
+        g = 0x0000ff00;
+
+    return blend_amask | rb | g;
+}
+
+// [AP] I_BlendDark, inlinable. Every channel is scaled the same way, so
+// unlike the blends above this one does not depend on blend_packed.
+// [crispy] http://stereopsis.com/doubleblend.html
+static const inline pixel_t I_BlendDarkPacked (const pixel_t bg, const int d)
+{
+    const uint32_t ag = (bg & 0xff00ff00) >> 8;
+    const uint32_t rb =  bg & 0x00ff00ff;
+
+    uint32_t sag = d * ag;
+    uint32_t srb = d * rb;
+
+    sag = sag & 0xff00ff00;
+    srb = (srb >> 8) & 0x00ff00ff;
+
+    return blend_amask | sag | srb;
+}
 #endif
 
 int V_GetPaletteIndex(byte *palette, int r, int g, int b);
+
+// [AP] Faster V_GetPaletteIndex for many lookups into the same palette
+typedef struct palette_lookup_s palette_lookup_t;
+palette_lookup_t *V_NewPaletteLookup(byte *palette);
+void V_FreePaletteLookup(palette_lookup_t *lookup);
+int V_LookupPaletteIndex(palette_lookup_t *lookup, int r, int g, int b);
 byte V_Colorize (byte *playpal, int cr, byte source, boolean keepgray109);
 
 #endif // __V_TRANS__
@@ -193,9 +193,27 @@ static const inline pixel_t drawpatchpx11 (const pixel_t dest, const pixel_t sou
 #else
 {return I_BlendOver(dest, colormaps[dp_translation[source]]);}
 #endif
+#ifdef CRISPY_TRUECOLOR
+// [AP] (3) and (4) with the packed blend inlined, see V_SetBlendPacked
+static const inline pixel_t drawpatchpx10_packed (const pixel_t dest, const pixel_t source)
+{return I_BlendOverPacked(dest, colormaps[source]);}
+static const inline pixel_t drawpatchpx11_packed (const pixel_t dest, const pixel_t source)
+{return I_BlendOverPacked(dest, colormaps[dp_translation[source]]);}
+#endif
 // [crispy] array of function pointers holding the different rendering functions
 typedef const pixel_t drawpatchpx_t (const pixel_t dest, const pixel_t source);
+#ifndef CRISPY_TRUECOLOR
 static drawpatchpx_t *const drawpatchpx_a[2][2] = {{drawpatchpx11, drawpatchpx10}, {drawpatchpx01, drawpatchpx00}};
+#else
+static drawpatchpx_t *drawpatchpx_a[2][2] = {{drawpatchpx11, drawpatchpx10}, {drawpatchpx01, drawpatchpx00}};
+
+// [AP] Called by the video code when the screen format is known
+void V_SetBlendPacked (boolean packed)
+{
+    drawpatchpx_a[0][0] = packed ? drawpatchpx11_packed : drawpatchpx11;
+    drawpatchpx_a[0][1] = packed ? drawpatchpx10_packed : drawpatchpx10;
+}
+#endif
 
 static fixed_t dx, dxi, dy, dyi;
 
@@ -75,6 +75,11 @@ void V_DrawScaledBlockTransparency(int x, int y, int width, int height, pixel_t
 
 void V_MarkRect(int x, int y, int width, int height);
 
+#ifdef CRISPY_TRUECOLOR
+// [AP] Choose the patch drawers for the packed blends in v_trans.h
+void V_SetBlendPacked (boolean packed);
+#endif
+
 void V_DrawFilledBox(int x, int y, int w, int h, int c);
 void V_DrawHorizLine(int x, int y, int w, int c);
 void V_DrawVertLine(int x, int y, int h, int c);
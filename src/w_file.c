@@ -42,6 +42,19 @@ wad_file_t *W_OpenFile(const char *path)
     wad_file_t *result;
     int i;
 
+#ifdef HAVE_MMAP
+    //!
+    // @category obscure
+    //
+    // [AP] Read WAD files instead of mapping them into memory, which
+    // is otherwise done wherever mmap() is available.
+    //
+
+    if (M_CheckParm("-nommap"))
+    {
+        return stdc_wad_file.OpenFile(path);
+    }
+#else
     //!
     // @category obscure
     //
@@ -53,6 +66,7 @@ wad_file_t *W_OpenFile(const char *path)
     {
         return stdc_wad_file.OpenFile(path);
     }
+#endif
 
     // Try all classes in order until we find one that works
 
@@ -82,3 +96,12 @@ size_t W_Read(wad_file_t *wad, unsigned int offset,
     return wad->file_class->Read(wad, offset, buffer, buffer_len);
 }
 
+void W_Advise(wad_file_t *wad, unsigned int offset, size_t length,
+              wad_advice_t advice)
+{
+    if (wad->mapped != NULL && wad->file_class->Advise != NULL)
+    {
+        wad->file_class->Advise(wad, offset, length, advice);
+    }
+}
+
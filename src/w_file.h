@@ -25,6 +25,15 @@
 
 typedef struct _wad_file_s wad_file_t;
 
+// [AP] How a range of a mapped file is about to be used.
+typedef enum
+{
+    WAD_ADVICE_NORMAL,
+    WAD_ADVICE_SEQUENTIAL,      // Read through once, as level data is.
+    WAD_ADVICE_WILLNEED,        // Read soon and more than once.
+    WAD_ADVICE_DONTNEED,        // Done with for now.
+} wad_advice_t;
+
 typedef struct
 {
     // Open a file for reading.
@@ -37,6 +46,10 @@ typedef struct
     // provided buffer.  Returns the number of bytes read.
     size_t (*Read)(wad_file_t *file, unsigned int offset,
                    void *buffer, size_t buffer_len);
+
+    // [AP] Pass on a hint about a range of a mapped file. Optional.
+    void (*Advise)(wad_file_t *file, unsigned int offset, size_t length,
+                   wad_advice_t advice);
 } wad_file_class_t;
 
 
@@ -83,4 +96,10 @@ void W_CloseFile(wad_file_t *wad);
 size_t W_Read(wad_file_t *wad, unsigned int offset,
               void *buffer, size_t buffer_len);
 
+// [AP] Tell the OS how a range of a mapped file is about to be used.
+// Does nothing for files that are not mapped.
+
+void W_Advise(wad_file_t *wad, unsigned int offset, size_t length,
+              wad_advice_t advice);
+
 #endif /* #ifndef __W_FILE__ */
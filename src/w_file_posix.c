@@ -163,12 +163,77 @@ size_t W_POSIX_Read(wad_file_t *wad, unsigned int offset,
     return bytes_read;
 }
 
+// [AP] Hints are passed on with posix_madvise(), except DONTNEED: glibc
+// ignores POSIX_MADV_DONTNEED, so madvise() is used to really drop the
+// pages. On a private mapping that also throws away anything written to
+// them, so only pages lying wholly inside the range are dropped, never
+// ones shared with a neighbouring lump.
+
+static void W_POSIX_Advise(wad_file_t *wad, unsigned int offset,
+                           size_t length, wad_advice_t advice)
+{
+#ifdef POSIX_MADV_NORMAL
+    static uintptr_t page_mask = 0;
+    uintptr_t start, end;
+    int posix_advice;
+
+    if (page_mask == 0)
+    {
+        page_mask = (uintptr_t) sysconf(_SC_PAGESIZE) - 1;
+    }
+
+    start = (uintptr_t) (wad->mapped + offset);
+    end = (uintptr_t) (wad->mapped + offset + length);
+
+#ifdef MADV_DONTNEED
+    if (advice == WAD_ADVICE_DONTNEED)
+    {
+        start = (start + page_mask) & ~page_mask;
+        end &= ~page_mask;
+
+        if (start < end)
+        {
+            madvise((void *) start, end - start, MADV_DONTNEED);
+        }
+
+        return;
+    }
+#endif
+
+    switch (advice)
+    {
+        case WAD_ADVICE_SEQUENTIAL:
+            posix_advice = POSIX_MADV_SEQUENTIAL;
+            break;
+
+        case WAD_ADVICE_WILLNEED:
+            posix_advice = POSIX_MADV_WILLNEED;
+            break;
+
+        case WAD_ADVICE_DONTNEED:
+            posix_advice = POSIX_MADV_DONTNEED;
+            break;
+
+        default:
+            posix_advice = POSIX_MADV_NORMAL;
+            break;
+    }
+
+    // The range has to start on a page boundary.
+
+    start &= ~page_mask;
+
+    posix_madvise((void *) start, end - start, posix_advice);
+#endif
+}
+
 
 wad_file_class_t posix_wad_file = 
 {
     W_POSIX_OpenFile,
     W_POSIX_CloseFile,
     W_POSIX_Read,
+    W_POSIX_Advise,
 };
 
 
@@ -400,6 +400,17 @@ void W_ReadLump(lumpindex_t lump, void *dest)
 }
 
 
+//
+// [AP] Lumps are only used straight from a mapped WAD when they are aligned.
+// Their data is read through short and int pointers, so a lump at an odd
+// offset is loaded into the zone like on an unmapped WAD.
+//
+
+static boolean LumpIsMapped(const lumpinfo_t *lump)
+{
+    return lump->wad_file->mapped != NULL
+        && (lump->position & (sizeof(int) - 1)) == 0;
+}
 
 
 //
@@ -431,7 +442,7 @@ void *W_CacheLumpNum(lumpindex_t lumpnum, int tag)
     // region.  If the lump is in an ordinary file, we may already
     // have it cached; otherwise, load it into memory.
 
-    if (lump->wad_file->mapped != NULL)
+    if (LumpIsMapped(lump)) // [AP]
     {
         // Memory mapped file, return from the mmapped region.
 
@@ -440,9 +451,13 @@ void *W_CacheLumpNum(lumpindex_t lumpnum, int tag)
     else if (lump->cache != NULL)
     {
         // Already cached, so just switch the zone tag.
+        // [AP] Open views keep it static.
 
         result = lump->cache;
-        Z_ChangeTag(lump->cache, tag);
+        if (lump->views == 0)
+        {
+            Z_ChangeTag(lump->cache, tag);
+        }
     }
     else
     {
@@ -487,11 +502,11 @@ void W_ReleaseLumpNum(lumpindex_t lumpnum)
 
     lump = lumpinfo[lumpnum];
 
-    if (lump->wad_file->mapped != NULL)
+    if (LumpIsMapped(lump)) // [AP]
     {
         // Memory-mapped file, so nothing needs to be done here.
     }
-    else
+    else if (lump->views == 0) // [AP]
     {
         Z_ChangeTag(lump->cache, PU_CACHE);
     }
@@ -502,6 +517,71 @@ void W_ReleaseLumpName(const char *name)
     W_ReleaseLumpNum(W_GetNumForName(name));
 }
 
+//
+// [AP] W_OpenLumpView
+//
+// Get at the data of a lump without copying it out of a mapped WAD.
+//
+
+void W_OpenLumpView(lumpindex_t lumpnum, wad_advice_t advice, lumpview_t *view)
+{
+    lumpinfo_t *lump;
+
+    if ((unsigned)lumpnum >= numlumps)
+    {
+        I_Error("W_OpenLumpView: %i >= numlumps", lumpnum);
+    }
+
+    lump = lumpinfo[lumpnum];
+
+    if (LumpIsMapped(lump))
+    {
+        W_Advise(lump->wad_file, lump->position, lump->size, advice);
+        view->data = lump->wad_file->mapped + lump->position;
+    }
+    else
+    {
+        view->data = W_CacheLumpNum(lumpnum, PU_STATIC);
+    }
+
+    ++lump->views;
+
+    view->length = lump->size;
+    view->lump = lumpnum;
+    view->advice = advice;
+}
+
+void W_CloseLumpView(lumpview_t *view)
+{
+    lumpinfo_t *lump;
+
+    if (view->data == NULL)
+    {
+        return;
+    }
+
+    lump = lumpinfo[view->lump];
+
+    if (--lump->views == 0)
+    {
+        if (LumpIsMapped(lump))
+        {
+            // Level data is not looked at again until the level is.
+            if (view->advice == WAD_ADVICE_SEQUENTIAL)
+            {
+                W_Advise(lump->wad_file, lump->position, lump->size,
+                         WAD_ADVICE_DONTNEED);
+            }
+        }
+        else
+        {
+            Z_ChangeTag(lump->cache, PU_CACHE);
+        }
+    }
+
+    view->data = NULL;
+}
+
 #if 0
 
 //
@@ -47,8 +47,20 @@ struct lumpinfo_s
 
     // Used for hash table lookups
     lumpindex_t next;
+
+    // [AP] Open views, which keep the cache from being purged
+    int         views;
 };
 
+// [AP] Read-only view of the data of a lump.
+typedef struct
+{
+    const byte *data;
+    int length;
+    lumpindex_t lump;
+    wad_advice_t advice;
+} lumpview_t;
+
 
 extern lumpinfo_t **lumpinfo;
 extern unsigned int numlumps;
@@ -73,6 +85,12 @@ extern unsigned int W_LumpNameHash(const char *s);
 void W_ReleaseLumpNum(lumpindex_t lump);
 void W_ReleaseLumpName(const char *name);
 
+// [AP] A view of a mapped WAD points straight into the mapping, with
+// the advice passed on to the OS. Other lumps are cached in the zone
+// and stay there until their last view is closed.
+void W_OpenLumpView(lumpindex_t lump, wad_advice_t advice, lumpview_t *view);
+void W_CloseLumpView(lumpview_t *view);
+
 const char *W_WadNameForLump(const lumpinfo_t *lump);
 boolean W_IsIWADLump(const lumpinfo_t *lump);
 